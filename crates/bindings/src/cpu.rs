@@ -5,17 +5,28 @@
 //! wrapper layer.
 
 use crate::conversion::py_dict_to_config;
+use crate::history::PyPipelineHistory;
 use crate::instruction::PyInstruction;
 use crate::snapshot::PyPipelineSnapshot;
-use crate::stats::PyStats;
+use crate::stats::stats_dict;
 use crate::views::{Csrs, Memory, Registers, VirtualMemory};
 use pyo3::exceptions::PyRuntimeError;
 use pyo3::prelude::*;
 use rvsim_core::Simulator;
+use rvsim_core::common::SimError;
 use rvsim_core::core::arch::mode::PrivilegeMode;
+use rvsim_core::sim::interval_stats::IntervalStatsWriter;
 use rvsim_core::sim::loader;
+use rvsim_core::sim::simpoint::pick_simpoints;
+use rvsim_core::sim::simulator::{BatchExit, ExecMode, RunLimits};
+use std::io::BufWriter;
 use std::io::Write;
-use std::io::{BufReader, BufWriter, Read};
+use std::sync::Arc;
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// Cycles simulated per GIL release. Bounds Ctrl-C latency; between slices
+/// the loop reacquires the GIL only to check signals.
+const GIL_SLICE_CYCLES: u64 = 100_000;
 
 // ── Formatting helper ────────────────────────────────────────────────────────
 
@@ -33,12 +44,43 @@ fn fmt_commas(n: u64) -> String {
     result
 }
 
+/// Exit code of a finished run, or `None` if it stopped at a limit or interrupt.
+const fn exit_code(exit: BatchExit) -> Option<u64> {
+    match exit {
+        BatchExit::Exited(code) => Some(code),
+        BatchExit::Limit | BatchExit::Stopped => None,
+    }
+}
+
 // ── Cpu ──────────────────────────────────────────────────────────────────────
 
 /// The simulation CPU. Created by `Simulator.build()`.
 #[pyclass(name = "Cpu")]
 pub struct PyCpu {
     pub inner: Simulator,
+    /// Stop flag polled by the native run loop; shared with `InterruptHandle`s.
+    stop: Arc<AtomicBool>,
+}
+
+// ── InterruptHandle ──────────────────────────────────────────────────────────
+
+/// Stops a running `Cpu` from another thread. Created by `Cpu.interrupt_handle()`.
+///
+/// The handle does not borrow the CPU, so it can be used while `run()` is
+/// executing with the GIL released (e.g. from a Jupyter widget callback).
+#[pyclass(name = "InterruptHandle", frozen)]
+pub struct PyInterruptHandle {
+    stop: Arc<AtomicBool>,
+}
+
+#[pymethods]
+impl PyInterruptHandle {
+    /// Ask the CPU to stop; the current `run*()` call returns ``None`` within
+    /// a few thousand cycles. If no run is in progress, the next one stops
+    /// immediately.
+    fn interrupt(&self) {
+        self.stop.store(true, Ordering::Relaxed);
+    }
 }
 
 // ── Private Rust helpers (not exposed to Python) ─────────────────────────────
@@ -85,36 +127,61 @@ impl PyCpu {
         }
     }
 
-    /// Core run loop. Runs for up to `limit` cycles (or forever if `None`),
-    /// checking Python signals every 10 000 cycles.
+    /// Core run loop. Runs for up to `limit` cycles (or forever if `None`).
     fn run_inner(&mut self, py: Python<'_>, limit: Option<u64>) -> PyResult<Option<u64>> {
-        let start = self.inner.cpu.stats.cycles;
+        self.run_loop(py, limit, None).map(exit_code)
+    }
+
+    /// Native run loop with an optional stop after `insts` retired instructions.
+    ///
+    /// Simulates in slices of [`GIL_SLICE_CYCLES`] with the GIL released, so
+    /// other Python threads (and other `Cpu`s) run meanwhile. Signals are
+    /// checked and stdout flushed once per slice. A raised stop flag ends the
+    /// run with [`BatchExit::Stopped`] and is cleared.
+    fn run_loop(
+        &mut self,
+        py: Python<'_>,
+        limit: Option<u64>,
+        insts: Option<u64>,
+    ) -> PyResult<BatchExit> {
+        let stop = Arc::clone(&self.stop);
+        let target_insts =
+            insts.map(|n| self.inner.cpu.stats.instructions_retired.saturating_add(n));
+        let mut cycles_left = limit;
         loop {
-            if let Some(max) = limit
-                && self.inner.cpu.stats.cycles.saturating_sub(start) >= max
-            {
-                let _ = std::io::stdout().flush();
-                return Ok(None);
-            }
-            if self.inner.cpu.stats.cycles.is_multiple_of(10_000) {
-                py.check_signals()?;
-                let _ = std::io::stdout().flush();
+            let slice = cycles_left.map_or(GIL_SLICE_CYCLES, |c| c.min(GIL_SLICE_CYCLES));
+            let limits = RunLimits {
+                cycles: Some(slice),
+                instructions: target_insts
+                    .map(|t| t.saturating_sub(self.inner.cpu.stats.instructions_retired)),
+            };
+            let sim = &mut self.inner;
+            let result = py.allow_threads(|| sim.run_batch(limits, &stop));
+            let _ = std::io::stdout().flush();
+            py.check_signals()?;
+            match result.map_err(|e| PyRuntimeError::new_err(e.to_string()))? {
+                BatchExit::Limit => {}
+                BatchExit::Stopped => {
+                    stop.store(false, Ordering::Relaxed);
+                    return Ok(BatchExit::Stopped);
+                }
+                exit @ BatchExit::Exited(_) => return Ok(exit),
             }
-            match self.inner.tick() {
-                Ok(()) => {
-                    if let Some(code) = self.inner.take_exit() {
-                        let _ = std::io::stdout().flush();
-                        return Ok(Some(code));
-                    }
+            if let Some(left) = cycles_left.as_mut() {
+                *left -= slice;
+                if *left == 0 {
+                    return Ok(BatchExit::Limit);
                 }
-                Err(e) => return Err(PyRuntimeError::new_err(e.to_string())),
+            }
+            if target_insts.is_some_and(|t| self.inner.cpu.stats.instructions_retired >= t) {
+                return Ok(BatchExit::Limit);
             }
         }
     }
 
     /// Run for exactly `cycles` cycles. Used by `run_until` and `sample`.
-    fn run_for_cycles(&mut self, py: Python<'_>, cycles: u64) -> PyResult<Option<u64>> {
-        self.run_inner(py, Some(cycles))
+    fn run_for_cycles(&mut self, py: Python<'_>, cycles: u64) -> PyResult<BatchExit> {
+        self.run_loop(py, Some(cycles), None)
     }
 
     /// Run with stderr progress reporting every `progress` cycles.
@@ -141,10 +208,10 @@ impl PyCpu {
             let exit = self.run_for_cycles(py, chunk)?;
             cycles_run += chunk;
 
-            if let Some(code) = exit {
+            if exit != BatchExit::Limit {
                 eprint!("\r\x1b[2K");
                 let _ = std::io::stderr().flush();
-                return Ok(Some(code));
+                return Ok(exit_code(exit));
             }
 
             let s = &self.inner.cpu.stats;
@@ -229,7 +296,7 @@ impl PyCpu {
         // into the O3 PRF. Must happen after all register initialization.
         sim.sync_arch_regs();
 
-        Ok(Self { inner: sim })
+        Ok(Self { inner: sim, stop: Arc::new(AtomicBool::new(false)) })
     }
 
     // ── Properties ───────────────────────────────────────────────────────────
@@ -265,8 +332,7 @@ impl PyCpu {
     /// Performance statistics as a dict (read-only).
     #[getter]
     fn stats(&self, py: Python<'_>) -> PyResult<PyObject> {
-        let s = PyStats::from(self.inner.cpu.stats.clone());
-        Ok(s.to_dict(py)?.into_bound(py).into_any().unbind())
+        Ok(stats_dict(py, &self.inner.stats())?.into_bound(py).into_any().unbind())
     }
 
     /// Register file — ``cpu.regs[10]``, ``cpu.regs[10] = v``.
@@ -326,6 +392,11 @@ impl PyCpu {
         self.inner.cpu.open_commit_log(path).map_err(|e| PyRuntimeError::new_err(e.to_string()))
     }
 
+    /// Handle that stops a ``run*()`` call in progress from another thread.
+    fn interrupt_handle(&self) -> PyInterruptHandle {
+        PyInterruptHandle { stop: Arc::clone(&self.stop) }
+    }
+
     /// Execute until one instruction commits.
     ///
     /// Returns an :class:`Instruction` or ``None`` if the simulation exited
@@ -392,17 +463,83 @@ impl PyCpu {
         };
 
         if let Some(sections) = stats_sections {
-            let s = PyStats::from(self.inner.cpu.stats.clone());
             if sections.is_empty() {
-                s.print();
+                self.inner.stats().print();
             } else {
-                s.print_sections(sections);
+                self.inner.stats().print_sections(&sections);
             }
         }
 
         Ok(exit)
     }
 
+    /// Run until `count` more instructions retire, the program exits, or
+    /// *limit* cycles elapse.
+    ///
+    /// Used by the sampled-simulation driver to fast-forward to, warm up,
+    /// and measure a single `SimPoint` interval.
+    ///
+    /// Returns:
+    ///     Exit code or ``None`` if the instruction count or *limit* was reached.
+    #[pyo3(signature = (count, limit=None))]
+    fn run_instructions(
+        &mut self,
+        py: Python<'_>,
+        count: u64,
+        limit: Option<u64>,
+    ) -> PyResult<Option<u64>> {
+        self.run_loop(py, limit, Some(count)).map(exit_code)
+    }
+
+    /// Execution engine currently driving the simulation:
+    /// ``"functional"`` while fast-forwarding, ``"detailed"`` otherwise.
+    #[getter]
+    const fn mode(&self) -> &'static str {
+        match self.inner.mode {
+            ExecMode::Functional => "functional",
+            ExecMode::Detailed => "detailed",
+        }
+    }
+
+    /// Write the basic-block vectors collected while fast-forwarding to a
+    /// `SimPoint` ``.bb`` file.
+    ///
+    /// Requires ``bbv_interval`` to be set in the config. The open (partial)
+    /// interval is closed first.
+    fn write_bbv(&mut self, path: &str) -> PyResult<()> {
+        let bbv = self.inner.bbv.as_mut().ok_or_else(|| {
+            PyRuntimeError::new_err("BBV profiling is not enabled (set bbv_interval)")
+        })?;
+        bbv.flush();
+        let file = std::fs::File::create(path)
+            .map_err(|e| PyRuntimeError::new_err(format!("cannot create BBV file: {e}")))?;
+        let mut w = BufWriter::new(file);
+        bbv.write_to(&mut w).map_err(|e| PyRuntimeError::new_err(format!("write error: {e}")))?;
+        std::io::Write::flush(&mut w)
+            .map_err(|e| PyRuntimeError::new_err(format!("flush error: {e}")))?;
+        Ok(())
+    }
+
+    /// Choose simulation points from the collected basic-block vectors.
+    ///
+    /// Args:
+    ///     `max_k`: Maximum number of clusters (simulation points).
+    ///     seed: Seed for the random projection and k-means initialization.
+    ///
+    /// Returns:
+    ///     List of ``(interval_index, weight)`` tuples sorted by interval.
+    #[pyo3(signature = (max_k=30, seed=42))]
+    fn simpoints(&mut self, max_k: usize, seed: u64) -> PyResult<Vec<(usize, f64)>> {
+        let bbv = self.inner.bbv.as_mut().ok_or_else(|| {
+            PyRuntimeError::new_err("BBV profiling is not enabled (set bbv_interval)")
+        })?;
+        bbv.flush();
+        Ok(pick_simpoints(bbv.intervals(), max_k, seed)
+            .into_iter()
+            .map(|p| (p.interval, p.weight))
+            .collect())
+    }
+
     /// Run with periodic stats snapshots.
     ///
     /// Args:
@@ -436,10 +573,9 @@ impl PyCpu {
             let exit = self.run_for_cycles(py, chunk)?;
             cycles_run += chunk;
 
-            let s = PyStats::from(self.inner.cpu.stats.clone());
-            snapshots.push(s.to_dict(py)?.into_bound(py).into_any().unbind());
+            snapshots.push(stats_dict(py, &self.inner.stats())?.into_bound(py).into_any().unbind());
 
-            if exit.is_some() {
+            if exit != BatchExit::Limit {
                 break;
             }
         }
@@ -447,6 +583,61 @@ impl PyCpu {
         Ok(snapshots)
     }
 
+    /// Run, streaming per-interval counter deltas to a file.
+    ///
+    /// Unlike :meth:`sample`, no stats dict is built per interval: each
+    /// interval appends one fixed-width row to *path*, which
+    /// :class:`IntervalStats` maps without copying.
+    ///
+    /// Args:
+    ///     path: Output file (overwritten).
+    ///     every: Record a row every N cycles.
+    ///     limit: Maximum total cycles. ``None`` runs until program exits.
+    ///
+    /// Returns:
+    ///     Number of rows written.
+    #[pyo3(signature = (path, every, limit=None))]
+    fn record_intervals(
+        &mut self,
+        py: Python<'_>,
+        path: &str,
+        every: u64,
+        limit: Option<u64>,
+    ) -> PyResult<u64> {
+        let io_err = |source| {
+            PyRuntimeError::new_err(
+                SimError::IntervalStatsIo { path: path.to_owned(), source }.to_string(),
+            )
+        };
+        let mut writer = IntervalStatsWriter::create(path, &self.inner.stats()).map_err(io_err)?;
+        let mut cycles_run = 0u64;
+
+        loop {
+            let chunk = if let Some(max) = limit {
+                let remaining = max.saturating_sub(cycles_run);
+                if remaining == 0 {
+                    break;
+                }
+                every.min(remaining)
+            } else {
+                every
+            };
+
+            let exit = self.run_for_cycles(py, chunk)?;
+            cycles_run += chunk;
+
+            writer.record(&self.inner.stats()).map_err(io_err)?;
+
+            if exit != BatchExit::Limit {
+                break;
+            }
+        }
+
+        let rows = writer.rows();
+        let _ = writer.finish().map_err(io_err)?;
+        Ok(rows)
+    }
+
     /// Run until a predicate is satisfied or the simulation exits.
     ///
     /// Args:
@@ -493,8 +684,8 @@ impl PyCpu {
             let exit = slf_py.borrow_mut(py).run_for_cycles(py, c)?;
             cycles_run += c;
 
-            if let Some(code) = exit {
-                return Ok(Some(code));
+            if exit != BatchExit::Limit {
+                return Ok(exit_code(exit));
             }
 
             // Check simple predicates with an immutable borrow.
@@ -514,8 +705,6 @@ impl PyCpu {
                     return Ok(None);
                 }
             }
-
-            py.check_signals()?;
         }
     }
 
@@ -591,202 +780,83 @@ impl PyCpu {
         PyPipelineSnapshot::new(self.inner.pipeline.snapshot(width))
     }
 
-    /// Save a checkpoint of the full simulation state to a file.
+    /// Start keeping the pipeline state of the last *cycles* detailed cycles.
     ///
-    /// The checkpoint includes PC, registers, CSRs, privilege mode, and RAM.
-    fn save(&self, path: &str) -> PyResult<()> {
-        let cpu = &self.inner.cpu;
-        let file = std::fs::File::create(path)
-            .map_err(|e| PyRuntimeError::new_err(format!("cannot create checkpoint file: {e}")))?;
-        let mut w = BufWriter::new(file);
-
-        let mut header = serde_json::Map::new();
-        let _ = header.insert("magic".into(), serde_json::Value::from("rvsim-checkpoint"));
-        let _ = header.insert("version".into(), serde_json::Value::from(1u64));
-        let _ = header.insert("pc".into(), serde_json::Value::from(cpu.pc));
-        let _ = header.insert("privilege".into(), serde_json::Value::from(cpu.privilege.to_u8()));
-        let _ = header.insert("direct_mode".into(), serde_json::Value::from(cpu.direct_mode));
-        let _ = header.insert("trace".into(), serde_json::Value::from(cpu.trace));
-        let _ = header.insert("wfi_waiting".into(), serde_json::Value::from(cpu.wfi_waiting));
-        let _ = header.insert("wfi_pc".into(), serde_json::Value::from(cpu.wfi_pc));
-        let _ = header.insert("ram_start".into(), serde_json::Value::from(cpu.ram_start));
-        let _ = header.insert("ram_end".into(), serde_json::Value::from(cpu.ram_end));
-
-        let gprs: Vec<serde_json::Value> = (0u8..32)
-            .map(|i| serde_json::Value::from(cpu.regs.read(rvsim_core::common::RegIdx::new(i))))
-            .collect();
-        let _ = header.insert("gpr".into(), serde_json::Value::Array(gprs));
-
-        let fprs: Vec<serde_json::Value> = (0u8..32)
-            .map(|i| serde_json::Value::from(cpu.regs.read_f(rvsim_core::common::RegIdx::new(i))))
-            .collect();
-        let _ = header.insert("fpr".into(), serde_json::Value::Array(fprs));
-
-        let c = &cpu.csrs;
-        let mut csrs = serde_json::Map::new();
-        let _ = csrs.insert("mstatus".into(), c.mstatus.into());
-        let _ = csrs.insert("misa".into(), c.misa.into());
-        let _ = csrs.insert("medeleg".into(), c.medeleg.into());
-        let _ = csrs.insert("mideleg".into(), c.mideleg.into());
-        let _ = csrs.insert("mie".into(), c.mie.into());
-        let _ = csrs.insert("mtvec".into(), c.mtvec.into());
-        let _ = csrs.insert("mscratch".into(), c.mscratch.into());
-        let _ = csrs.insert("mepc".into(), c.mepc.into());
-        let _ = csrs.insert("mcause".into(), c.mcause.into());
-        let _ = csrs.insert("mtval".into(), c.mtval.into());
-        let _ = csrs.insert("mip".into(), c.mip.into());
-        let _ = csrs.insert("sstatus".into(), c.sstatus.into());
-        let _ = csrs.insert("sie".into(), c.sie.into());
-        let _ = csrs.insert("stvec".into(), c.stvec.into());
-        let _ = csrs.insert("sscratch".into(), c.sscratch.into());
-        let _ = csrs.insert("sepc".into(), c.sepc.into());
-        let _ = csrs.insert("scause".into(), c.scause.into());
-        let _ = csrs.insert("stval".into(), c.stval.into());
-        let _ = csrs.insert("sip".into(), c.sip.into());
-        let _ = csrs.insert("satp".into(), c.satp.into());
-        let _ = csrs.insert("cycle".into(), c.cycle.into());
-        let _ = csrs.insert("time".into(), c.time.into());
-        let _ = csrs.insert("instret".into(), c.instret.into());
-        let _ = csrs.insert("mcycle".into(), c.mcycle.into());
-        let _ = csrs.insert("minstret".into(), c.minstret.into());
-        let _ = csrs.insert("stimecmp".into(), c.stimecmp.into());
-        let _ = csrs.insert("fflags".into(), c.fflags.into());
-        let _ = csrs.insert("frm".into(), c.frm.into());
-        let _ = csrs.insert("mcounteren".into(), c.mcounteren.into());
-        let _ = csrs.insert("scounteren".into(), c.scounteren.into());
-        let _ = header.insert("csrs".into(), serde_json::Value::Object(csrs));
-
-        let header_bytes = serde_json::to_vec(&serde_json::Value::Object(header))
-            .map_err(|e| PyRuntimeError::new_err(format!("serialization error: {e}")))?;
-        let header_len = header_bytes.len() as u64;
-        std::io::Write::write_all(&mut w, &header_len.to_le_bytes())
-            .map_err(|e| PyRuntimeError::new_err(format!("write error: {e}")))?;
-        std::io::Write::write_all(&mut w, &header_bytes)
-            .map_err(|e| PyRuntimeError::new_err(format!("write error: {e}")))?;
-
-        let ram_size = (cpu.ram_end - cpu.ram_start) as usize;
-        if !cpu.ram_ptr.is_null() && ram_size > 0 {
-            let ram_slice = unsafe { std::slice::from_raw_parts(cpu.ram_ptr, ram_size) };
-            std::io::Write::write_all(&mut w, ram_slice)
-                .map_err(|e| PyRuntimeError::new_err(format!("write error: {e}")))?;
-        }
-
-        std::io::Write::flush(&mut w)
-            .map_err(|e| PyRuntimeError::new_err(format!("flush error: {e}")))?;
-        Ok(())
+    /// The ring is allocated here (about ``cycles × width × 128`` bytes) and
+    /// each later cycle overwrites the oldest record in place, so recording
+    /// allocates nothing. Replaces any earlier history. Read it back with
+    /// :meth:`pipeline_history`.
+    ///
+    /// Args:
+    ///     cycles: Number of most recent cycles to keep.
+    #[pyo3(signature = (cycles=100_000))]
+    fn record_pipeline_history(&mut self, cycles: usize) {
+        self.inner.record_history(cycles);
     }
 
-    /// Restore simulation state from a checkpoint file.
+    /// Live view of the recorded pipeline history.
     ///
-    /// The CPU must have been created with compatible RAM size.
-    fn restore(&mut self, path: &str) -> PyResult<()> {
-        let file = std::fs::File::open(path)
-            .map_err(|e| PyRuntimeError::new_err(format!("cannot open checkpoint file: {e}")))?;
-        let mut r = BufReader::new(file);
-
-        let mut len_buf = [0u8; 8];
-        Read::read_exact(&mut r, &mut len_buf)
-            .map_err(|e| PyRuntimeError::new_err(format!("read error: {e}")))?;
-        let header_len = u64::from_le_bytes(len_buf) as usize;
-
-        let mut header_bytes = vec![0u8; header_len];
-        Read::read_exact(&mut r, &mut header_bytes)
-            .map_err(|e| PyRuntimeError::new_err(format!("read error: {e}")))?;
-        let header: serde_json::Value = serde_json::from_slice(&header_bytes)
-            .map_err(|e| PyRuntimeError::new_err(format!("invalid checkpoint header: {e}")))?;
-
-        let magic = header.get("magic").and_then(|v| v.as_str()).unwrap_or("");
-        if magic != "rvsim-checkpoint" {
-            return Err(PyRuntimeError::new_err("not a valid rvsim checkpoint file"));
-        }
-
-        let cpu = &mut self.inner.cpu;
-
-        cpu.pc = header["pc"].as_u64().unwrap_or(0);
-        cpu.privilege = PrivilegeMode::from_u8(header["privilege"].as_u64().unwrap_or(3) as u8);
-        cpu.direct_mode = header["direct_mode"].as_bool().unwrap_or(false);
-        cpu.trace = header["trace"].as_bool().unwrap_or(false);
-        cpu.wfi_waiting = header["wfi_waiting"].as_bool().unwrap_or(false);
-        cpu.wfi_pc = header["wfi_pc"].as_u64().unwrap_or(0);
-
-        if let Some(gprs) = header["gpr"].as_array() {
-            for (i, v) in gprs.iter().enumerate().take(32) {
-                cpu.regs.write(rvsim_core::common::RegIdx::new(i as u8), v.as_u64().unwrap_or(0));
-            }
-        }
-
-        if let Some(fprs) = header["fpr"].as_array() {
-            for (i, v) in fprs.iter().enumerate().take(32) {
-                cpu.regs.write_f(rvsim_core::common::RegIdx::new(i as u8), v.as_u64().unwrap_or(0));
-            }
+    /// Returns a :class:`PipelineHistory`, or ``None`` unless
+    /// :meth:`record_pipeline_history` was called. Nothing is copied until a
+    /// cycle is indexed.
+    fn pipeline_history(slf: Bound<'_, Self>) -> Option<PyPipelineHistory> {
+        if slf.borrow().inner.history.is_none() {
+            return None;
         }
+        Some(PyPipelineHistory { cpu: slf.unbind() })
+    }
 
-        if let Some(csrs) = header.get("csrs") {
-            let c = &mut cpu.csrs;
-            macro_rules! restore_csr {
-                ($field:ident) => {
-                    if let Some(v) = csrs.get(stringify!($field)).and_then(|v| v.as_u64()) {
-                        c.$field = v;
-                    }
-                };
-            }
-            restore_csr!(mstatus);
-            restore_csr!(misa);
-            restore_csr!(medeleg);
-            restore_csr!(mideleg);
-            restore_csr!(mie);
-            restore_csr!(mtvec);
-            restore_csr!(mscratch);
-            restore_csr!(mepc);
-            restore_csr!(mcause);
-            restore_csr!(mtval);
-            restore_csr!(mip);
-            restore_csr!(sstatus);
-            restore_csr!(sie);
-            restore_csr!(stvec);
-            restore_csr!(sscratch);
-            restore_csr!(sepc);
-            restore_csr!(scause);
-            restore_csr!(stval);
-            restore_csr!(sip);
-            restore_csr!(satp);
-            restore_csr!(cycle);
-            restore_csr!(time);
-            restore_csr!(instret);
-            restore_csr!(mcycle);
-            restore_csr!(minstret);
-            restore_csr!(stimecmp);
-            restore_csr!(fflags);
-            restore_csr!(frm);
-            restore_csr!(mcounteren);
-            restore_csr!(scounteren);
-        }
+    /// Save a checkpoint of the architectural state to a file.
+    ///
+    /// The checkpoint is a versioned binary file: a small header with PC,
+    /// registers, CSRs, privilege mode and the CLINT timer, followed by every
+    /// non-zero RAM page at a page-aligned offset. Raises ``RuntimeError`` for
+    /// a multi-hart system or one whose guest has configured the PLIC, UART or
+    /// VirtIO disk, whose state is not saved.
+    fn save(&mut self, path: &str) -> PyResult<()> {
+        self.inner
+            .save_checkpoint(std::path::Path::new(path))
+            .map_err(|e| PyRuntimeError::new_err(e.to_string()))
+    }
 
-        let ckpt_ram_start = header["ram_start"].as_u64().unwrap_or(0);
-        let ckpt_ram_end = header["ram_end"].as_u64().unwrap_or(0);
-        let ckpt_ram_size = (ckpt_ram_end - ckpt_ram_start) as usize;
-        let cpu_ram_size = (cpu.ram_end - cpu.ram_start) as usize;
+    /// Start recording every cache-hierarchy access to a memory trace file.
+    ///
+    /// The trace replays through :func:`replay_mem_trace` under any cache
+    /// geometry. Any trace already open is finished first.
+    fn open_mem_trace(&mut self, path: &str) -> PyResult<()> {
+        self.inner.cpu.open_mem_trace(path).map_err(|e| PyRuntimeError::new_err(e.to_string()))
+    }
 
-        if ckpt_ram_size != cpu_ram_size {
-            return Err(PyRuntimeError::new_err(format!(
-                "RAM size mismatch: checkpoint has {ckpt_ram_size} bytes, CPU has {cpu_ram_size} bytes"
-            )));
-        }
+    /// Stop recording and flush the memory trace.
+    ///
+    /// Returns the number of records written (0 if no trace was open).
+    fn close_mem_trace(&mut self) -> PyResult<u64> {
+        self.inner.cpu.close_mem_trace().map_err(|e| PyRuntimeError::new_err(e.to_string()))
+    }
 
-        if !cpu.ram_ptr.is_null() && ckpt_ram_size > 0 {
-            let ram_slice = unsafe { std::slice::from_raw_parts_mut(cpu.ram_ptr, ckpt_ram_size) };
-            Read::read_exact(&mut r, ram_slice)
-                .map_err(|e| PyRuntimeError::new_err(format!("read error restoring RAM: {e}")))?;
-        }
+    /// Start recording every retired branch and jump to a branch trace file.
+    ///
+    /// The trace replays through :func:`replay_branch_trace` against any
+    /// branch predictor. Any trace already open is finished first.
+    fn open_branch_trace(&mut self, path: &str) -> PyResult<()> {
+        self.inner.cpu.open_branch_trace(path).map_err(|e| PyRuntimeError::new_err(e.to_string()))
+    }
 
-        let _ = cpu.l1_i_cache.flush();
-        let _ = cpu.l1_d_cache.flush();
-        let _ = cpu.l2_cache.flush();
-        let _ = cpu.l3_cache.flush();
-        cpu.mmu.dtlb.flush();
-        cpu.mmu.itlb.flush();
-        cpu.mmu.l2_tlb.flush();
+    /// Stop recording and flush the branch trace.
+    ///
+    /// Returns the number of records written (0 if no trace was open).
+    fn close_branch_trace(&mut self) -> PyResult<u64> {
+        self.inner.cpu.close_branch_trace().map_err(|e| PyRuntimeError::new_err(e.to_string()))
+    }
 
-        Ok(())
+    /// Restore simulation state from a checkpoint file.
+    ///
+    /// The CPU must have been created with the same RAM base and size; the
+    /// microarchitecture may differ. RAM is mapped copy-on-write from the
+    /// file, so restore time does not depend on RAM size.
+    fn restore(&mut self, path: &str) -> PyResult<()> {
+        self.inner
+            .restore_checkpoint(std::path::Path::new(path))
+            .map_err(|e| PyRuntimeError::new_err(e.to_string()))
     }
 }
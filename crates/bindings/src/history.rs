@@ -0,0 +1,274 @@
+//! Pipeline history Python bindings.
+//!
+//! `PipelineHistory` is a live view of the simulator's history ring: it holds
+//! a `Py<PyCpu>` back-reference, like the register and memory views, and
+//! copies nothing until a cycle is indexed. Indexing yields a
+//! `PipelineFrame`, a small owned copy of that one cycle that renders like a
+//! `PipelineSnapshot`.
+
+use pyo3::exceptions::PyIndexError;
+use pyo3::prelude::*;
+use pyo3::types::PyList;
+use rvsim_core::core::pipeline::history::{
+    HistoryFrame, HistoryRecord, HistorySlot, Latch, PipelineHistory,
+};
+use rvsim_core::isa::disasm::disassemble;
+
+use crate::cpu::PyCpu;
+use crate::snapshot::{
+    cell, column, issue_cell, render_columns, slot_dict, stall_notes, tail_columns,
+};
+
+/// The last N detailed cycles of pipeline state, oldest first.
+///
+/// Obtained via ``cpu.pipeline_history()`` after
+/// ``cpu.record_pipeline_history(cycles)``. The view is live: it always
+/// covers the cycles held *now*, so ``history[-1]`` is the latest cycle.
+/// ``history.at(cycle)`` finds a cycle by its ``stats["cycles"]`` value.
+#[pyclass(name = "PipelineHistory")]
+pub struct PyPipelineHistory {
+    pub cpu: Py<PyCpu>,
+}
+
+impl PyPipelineHistory {
+    /// Runs `f` on the simulator's history, if it still has one (building a
+    /// new simulator, as a reset does, drops it).
+    fn with<R>(&self, py: Python<'_>, f: impl FnOnce(&PipelineHistory) -> R) -> Option<R> {
+        self.cpu.borrow(py).inner.history.as_ref().map(f)
+    }
+}
+
+#[pymethods]
+impl PyPipelineHistory {
+    fn __len__(&self, py: Python<'_>) -> usize {
+        self.with(py, PipelineHistory::len).unwrap_or(0)
+    }
+
+    /// Maximum number of cycles held.
+    #[getter]
+    fn capacity(&self, py: Python<'_>) -> usize {
+        self.with(py, PipelineHistory::capacity).unwrap_or(0)
+    }
+
+    /// Cycle *i*, counting from the oldest held (negative from the latest).
+    fn __getitem__(&self, py: Python<'_>, i: isize) -> PyResult<PyPipelineFrame> {
+        self.with(py, |h| {
+            let index = if i < 0 { i + h.len() as isize } else { i };
+            let record = usize::try_from(index).ok().and_then(|i| h.get(i))?;
+            Some(PyPipelineFrame::new(&record, h.width()))
+        })
+        .flatten()
+        .ok_or_else(|| PyIndexError::new_err(format!("history index {i} out of range")))
+    }
+
+    /// The record of *cycle* (a ``stats["cycles"]`` value), or ``None`` if it
+    /// is no longer held or was not recorded.
+    fn at(&self, py: Python<'_>, cycle: u64) -> Option<PyPipelineFrame> {
+        self.with(py, |h| h.find(cycle).map(|r| PyPipelineFrame::new(&r, h.width()))).flatten()
+    }
+
+    fn __repr__(&self, py: Python<'_>) -> String {
+        self.with(py, |h| {
+            let span = match (h.get(0), h.len().checked_sub(1).and_then(|i| h.get(i))) {
+                (Some(first), Some(last)) => {
+                    format!("cycles {}..={}", first.frame.cycle, last.frame.cycle)
+                }
+                _ => "empty".to_string(),
+            };
+            format!("PipelineHistory({} of {} cycles, {span})", h.len(), h.capacity())
+        })
+        .unwrap_or_else(|| "PipelineHistory(not recording)".to_string())
+    }
+}
+
+/// One recorded cycle of pipeline state.
+///
+/// Each latch attribute is a list of slot dicts, as on
+/// :class:`PipelineSnapshot`, holding only what the history records:
+/// ``{pc, raw, asm}``, plus ``rob_tag`` from ``rename_issue`` on and
+/// ``ready`` in ``issue_queue``. ``issue_queue`` lists the ``width`` oldest
+/// entries; ``issue_queue_len`` is the full occupancy.
+#[pyclass(name = "PipelineFrame")]
+pub struct PyPipelineFrame {
+    frame: HistoryFrame,
+    latches: Vec<Vec<HistorySlot>>,
+    waiting: Vec<bool>,
+    width: usize,
+}
+
+impl PyPipelineFrame {
+    /// Copies `record` out of the history ring.
+    fn new(record: &HistoryRecord<'_>, width: usize) -> Self {
+        let latches: Vec<Vec<HistorySlot>> =
+            Latch::ALL.iter().map(|&l| record.latch(l).to_vec()).collect();
+        let waiting = (0..latches[Latch::IssueQueue as usize].len())
+            .map(|i| record.issue_waiting(i))
+            .collect();
+        Self { frame: *record.frame, latches, waiting, width }
+    }
+
+    fn slots(&self, latch: Latch) -> &[HistorySlot] {
+        &self.latches[latch as usize]
+    }
+
+    /// Latch `latch` as a list of slot dicts.
+    fn slot_list(&self, py: Python<'_>, latch: Latch) -> PyResult<Py<PyList>> {
+        let renamed = latch as usize >= Latch::RenameIssue as usize;
+        let items: Vec<_> = self
+            .slots(latch)
+            .iter()
+            .enumerate()
+            .map(|(i, s)| -> PyResult<_> {
+                let d = slot_dict(py, s.pc, s.inst)?;
+                if renamed {
+                    d.set_item("rob_tag", s.rob_tag)?;
+                }
+                if latch == Latch::IssueQueue {
+                    d.set_item("ready", !self.waiting[i])?;
+                }
+                Ok(d.into_any().unbind())
+            })
+            .collect::<PyResult<_>>()?;
+        Ok(PyList::new(py, items)?.unbind())
+    }
+
+    fn render_inner(&self) -> String {
+        let w = self.width;
+        let f = &self.frame;
+        let asm = |s: &HistorySlot| cell(&disassemble(s.inst));
+        let issue = self.slots(Latch::IssueQueue);
+        let waiting: Vec<(u32, bool)> =
+            issue.iter().zip(&self.waiting).map(|(s, &wait)| (s.inst, wait)).collect();
+
+        let mut cols = vec![
+            column(
+                "F1",
+                w,
+                self.slots(Latch::Fetch1Fetch2),
+                |s| format!("{:#010x}", s.pc),
+                f.fetch1_stall,
+            ),
+            column("F2", w, self.slots(Latch::Fetch2Decode), asm, f.fetch2_stall),
+            column("DE", w, self.slots(Latch::DecodeRename), asm, 0),
+            column("RN", w, self.slots(Latch::RenameIssue), asm, 0),
+            column("IS", w, &waiting, |&(inst, wait)| issue_cell(inst, wait), 0),
+            column("EX", w, self.slots(Latch::ExecuteMem1), asm, 0),
+            column("M1", w, self.slots(Latch::Mem1Mem2), asm, f.mem1_stall),
+            column("M2", w, self.slots(Latch::Mem2Wb), asm, 0),
+        ];
+        cols.extend(tail_columns(w));
+        let stalls = stall_notes(f.fetch1_stall, f.fetch2_stall, f.mem1_stall);
+        format!("Cycle {}  width={w}\n{}", f.cycle, render_columns(w, &cols, &[], &stalls))
+    }
+}
+
+#[pymethods]
+impl PyPipelineFrame {
+    /// Value of ``stats["cycles"]`` after this cycle.
+    #[getter]
+    const fn cycle(&self) -> u64 {
+        self.frame.cycle
+    }
+
+    /// Pipeline width (superscalar degree).
+    #[getter]
+    const fn width(&self) -> usize {
+        self.width
+    }
+
+    /// Fetch1 → Fetch2 latch.
+    #[getter]
+    fn fetch1_fetch2(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::Fetch1Fetch2)
+    }
+
+    /// Fetch2 → Decode latch.
+    #[getter]
+    fn fetch2_decode(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::Fetch2Decode)
+    }
+
+    /// Decode → Rename latch.
+    #[getter]
+    fn decode_rename(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::DecodeRename)
+    }
+
+    /// Rename → Issue latch.
+    #[getter]
+    fn rename_issue(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::RenameIssue)
+    }
+
+    /// Oldest ``width`` issue queue entries, oldest first.
+    #[getter]
+    fn issue_queue(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::IssueQueue)
+    }
+
+    /// Execute → Memory1 latch.
+    #[getter]
+    fn execute_mem1(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::ExecuteMem1)
+    }
+
+    /// Memory1 → Memory2 latch.
+    #[getter]
+    fn mem1_mem2(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::Mem1Mem2)
+    }
+
+    /// Memory2 → Writeback latch.
+    #[getter]
+    fn mem2_wb(&self, py: Python<'_>) -> PyResult<Py<PyList>> {
+        self.slot_list(py, Latch::Mem2Wb)
+    }
+
+    /// Issue queue occupancy, including entries not listed in ``issue_queue``.
+    #[getter]
+    const fn issue_queue_len(&self) -> u32 {
+        self.frame.issue_queue_len
+    }
+
+    /// Fetch1 stall cycles remaining (I-TLB latency).
+    #[getter]
+    const fn fetch1_stall(&self) -> u64 {
+        self.frame.fetch1_stall
+    }
+
+    /// Fetch2 stall cycles remaining (I-cache latency).
+    #[getter]
+    const fn fetch2_stall(&self) -> u64 {
+        self.frame.fetch2_stall
+    }
+
+    /// Memory1 stall cycles remaining (D-TLB / D-cache latency).
+    #[getter]
+    const fn mem1_stall(&self) -> u64 {
+        self.frame.mem1_stall
+    }
+
+    /// Return the pipeline diagram of this cycle as a string.
+    fn render(&self) -> String {
+        self.render_inner()
+    }
+
+    /// Print the pipeline diagram of this cycle to stdout.
+    fn visualize(&self) {
+        println!("{}", self.render_inner());
+    }
+
+    fn __repr__(&self) -> String {
+        let summary: Vec<String> = Latch::ALL
+            .iter()
+            .filter(|&&l| !self.slots(l).is_empty())
+            .map(|&l| format!("{}={}", l.name(), self.slots(l).len()))
+            .collect();
+        format!(
+            "PipelineFrame(cycle={}, width={}, {})",
+            self.frame.cycle,
+            self.width,
+            if summary.is_empty() { "idle".to_string() } else { summary.join(", ") }
+        )
+    }
+}
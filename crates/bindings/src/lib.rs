@@ -3,7 +3,8 @@
 //! This crate exposes the simulator to Python via `PyO3`. It provides:
 //! 1. **CPU:** `Cpu` — the sole public entry point for simulation.
 //! 2. **Views:** `Instruction`, `Registers`, `Csrs`, `Memory` for CPU introspection.
-//! 3. **Utilities:** `version()` and `disassemble()`.
+//! 3. **Utilities:** `version()`, `disassemble()`, `replay_mem_trace()`, and
+//!    `replay_branch_trace()`.
 
 // PyO3 bindings — relax documentation and pedantic lints for binding-layer code.
 #![allow(
@@ -26,6 +27,8 @@ use pyo3::prelude::*;
 pub mod conversion;
 /// CPU binding (`PyCpu` exposed as `Cpu`).
 pub mod cpu;
+/// Pipeline history bindings (`PipelineHistory` and `PipelineFrame`).
+pub mod history;
 /// Instruction binding (`PyInstruction` exposed as `Instruction`).
 pub mod instruction;
 /// Pipeline snapshot binding (`PyPipelineSnapshot` exposed as `PipelineSnapshot`).
@@ -40,9 +43,12 @@ pub mod views;
 /// Registers all public classes and functions onto the Python module.
 pub fn register_emulator_module(m: &Bound<'_, PyModule>) -> PyResult<()> {
     m.add_class::<cpu::PyCpu>()?;
+    m.add_class::<cpu::PyInterruptHandle>()?;
 
     m.add_class::<instruction::PyInstruction>()?;
     m.add_class::<snapshot::PyPipelineSnapshot>()?;
+    m.add_class::<history::PyPipelineHistory>()?;
+    m.add_class::<history::PyPipelineFrame>()?;
     m.add_class::<views::Registers>()?;
     m.add_class::<views::Csrs>()?;
     m.add_class::<views::Memory>()?;
@@ -50,6 +56,9 @@ pub fn register_emulator_module(m: &Bound<'_, PyModule>) -> PyResult<()> {
 
     m.add_function(wrap_pyfunction!(utils::version, m)?)?;
     m.add_function(wrap_pyfunction!(utils::disassemble, m)?)?;
+    m.add_function(wrap_pyfunction!(utils::replay_mem_trace, m)?)?;
+    m.add_function(wrap_pyfunction!(utils::replay_branch_trace, m)?)?;
+    m.add_function(wrap_pyfunction!(utils::run_suite, m)?)?;
 
     Ok(())
 }
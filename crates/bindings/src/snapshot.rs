@@ -24,7 +24,7 @@ fn reg_name(idx: RegIdx) -> &'static str {
 
 // ── Slot dict helpers ─────────────────────────────────────────────────────────
 
-fn slot_dict(py: Python<'_>, pc: u64, raw: u32) -> PyResult<Bound<'_, PyDict>> {
+pub(crate) fn slot_dict(py: Python<'_>, pc: u64, raw: u32) -> PyResult<Bound<'_, PyDict>> {
     let d = PyDict::new(py);
     d.set_item("pc", pc)?;
     d.set_item("raw", raw)?;
@@ -57,7 +57,7 @@ fn trunc(s: &str, w: usize) -> String {
 }
 
 /// One cell: mnemonic + first operand, truncated to `COL_W`.
-fn cell(asm: &str) -> String {
+pub(crate) fn cell(asm: &str) -> String {
     trunc(asm, COL_W)
 }
 
@@ -66,104 +66,60 @@ fn empty_cell(stall: u64) -> String {
     if stall > 0 { trunc(&format!("~{stall}"), COL_W) } else { "─".to_string() }
 }
 
-fn render_inner(snap: &PipelineSnapshot) -> String {
-    let w = snap.width;
+/// One diagram column: a cell per slot (`None` when empty) and the stage's
+/// remaining stall cycles.
+pub(crate) struct StageCol {
+    hdr: &'static str,
+    cells: Vec<Option<String>>,
+    stall: u64,
+}
 
-    // Stage definitions: (header label, per-slot cell content, stall cycles).
-    // Each is a Vec<Option<String>> of length w — None means empty/stalled.
-    #[allow(clippy::items_after_statements)]
-    struct StageCol {
-        hdr: &'static str,
-        cells: Vec<Option<String>>, // length == w
-        stall: u64,
+/// Builds a column of `w` cells from a latch, one cell per entry.
+pub(crate) fn column<T>(
+    hdr: &'static str,
+    w: usize,
+    entries: &[T],
+    f: impl Fn(&T) -> String,
+    stall: u64,
+) -> StageCol {
+    let mut cells: Vec<Option<String>> = vec![None; w];
+    for (c, e) in cells.iter_mut().zip(entries) {
+        *c = Some(f(e));
     }
+    StageCol { hdr, cells, stall }
+}
 
-    let mut cols: Vec<StageCol> = Vec::new();
+/// WB and CM columns: WB writes results and CM retires from the ROB head;
+/// neither has an outbound latch to inspect, so both show empty.
+pub(crate) fn tail_columns(w: usize) -> [StageCol; 2] {
+    [
+        StageCol { hdr: "WB", cells: vec![None; w], stall: 0 },
+        StageCol { hdr: "CM", cells: vec![None; w], stall: 0 },
+    ]
+}
 
-    // Helper: build a StageCol from a latch vec using a closure.
-    macro_rules! stage {
-        ($hdr:expr, $entries:expr, $cell_fn:expr, $stall:expr) => {{
-            let mut cells: Vec<Option<String>> = vec![None; w];
-            for (i, e) in $entries.iter().enumerate() {
-                if i < w {
-                    cells[i] = Some($cell_fn(e));
-                }
-            }
-            cols.push(StageCol { hdr: $hdr, cells, stall: $stall });
-        }};
-    }
+/// Issue queue cell, marked with `⋯` while an operand is outstanding.
+pub(crate) fn issue_cell(inst: u32, waiting: bool) -> String {
+    let asm = disassemble(inst);
+    if waiting { trunc(&format!("⋯{}", cell(&asm)), COL_W) } else { cell(&asm) }
+}
 
-    stage!(
-        "F1",
-        snap.fetch1_fetch2,
-        |e: &rvsim_core::core::pipeline::latches::Fetch1Fetch2Entry| { format!("{:#010x}", e.pc) },
-        snap.fetch1_stall
-    );
-
-    stage!(
-        "F2",
-        snap.fetch2_decode,
-        |e: &rvsim_core::core::pipeline::latches::IfIdEntry| { cell(&disassemble(e.inst)) },
-        snap.fetch2_stall
-    );
-
-    stage!(
-        "DE",
-        snap.decode_rename,
-        |e: &rvsim_core::core::pipeline::latches::IdExEntry| { cell(&disassemble(e.inst)) },
-        0u64
-    );
-
-    stage!(
-        "RN",
-        snap.rename_issue,
-        |e: &rvsim_core::core::pipeline::latches::RenameIssueEntry| { cell(&disassemble(e.inst)) },
-        0u64
-    );
-
-    stage!(
-        "IS",
-        snap.issue_queue,
-        |e: &rvsim_core::core::pipeline::latches::RenameIssueEntry| {
-            let asm = disassemble(e.inst);
-            let stalled = e.rs1_tag.is_some() || e.rs2_tag.is_some();
-            if stalled { trunc(&format!("⋯{}", cell(&asm)), COL_W) } else { cell(&asm) }
-        },
-        0u64
-    );
-
-    stage!(
-        "EX",
-        snap.execute_mem1,
-        |e: &rvsim_core::core::pipeline::latches::ExMem1Entry| { cell(&disassemble(e.inst)) },
-        0u64
-    );
-
-    stage!(
-        "M1",
-        snap.mem1_mem2,
-        |e: &rvsim_core::core::pipeline::latches::Mem1Mem2Entry| { cell(&disassemble(e.inst)) },
-        snap.mem1_stall
-    );
-
-    stage!(
-        "M2",
-        snap.mem2_wb,
-        |e: &rvsim_core::core::pipeline::latches::Mem2WbEntry| { cell(&disassemble(e.inst)) },
-        0u64
-    );
-
-    // WB and CM: WB writes results; CM retires from ROB head.
-    // Neither has an outbound latch we can inspect, so both show empty.
-    {
-        let cells = vec![None; w];
-        cols.push(StageCol { hdr: "WB", cells, stall: 0 });
-    }
-    {
-        let cells = vec![None; w];
-        cols.push(StageCol { hdr: "CM", cells, stall: 0 });
-    }
+/// Names the stages with stall cycles remaining.
+pub(crate) fn stall_notes(fetch1: u64, fetch2: u64, mem1: u64) -> Vec<String> {
+    [("F1", fetch1), ("F2", fetch2), ("M1", mem1)]
+        .into_iter()
+        .filter(|&(_, n)| n > 0)
+        .map(|(stage, n)| format!("{stage}={n}"))
+        .collect()
+}
 
+/// Lays out `cols` as one row per slot, then the annotation line.
+pub(crate) fn render_columns(
+    w: usize,
+    cols: &[StageCol],
+    notes: &[String],
+    stall_notes: &[String],
+) -> String {
     // ── header ────────────────────────────────────────────────────────────────
     let hdr_cells: Vec<String> = cols.iter().map(|c| format!("{:^COL_W$}", c.hdr)).collect();
     let hdr_line = format!("{:SLOT_W$} {}", "", hdr_cells.join(" "));
@@ -184,30 +140,6 @@ fn render_inner(snap: &PipelineSnapshot) -> String {
         rows.push(format!("[{slot}]  {}", row_cells.join(" ")));
     }
 
-    // ── forwarding / stall annotation line ────────────────────────────────────
-    let mut notes: Vec<String> = Vec::new();
-    for e in &snap.execute_mem1 {
-        if !e.rd.is_zero() {
-            notes.push(format!("{}←{:#x}", reg_name(e.rd), e.alu));
-        }
-    }
-    for e in &snap.mem2_wb {
-        if !e.rd.is_zero() {
-            let v = if e.load_data != 0 { e.load_data } else { e.alu };
-            notes.push(format!("{}←{:#x}", reg_name(e.rd), v));
-        }
-    }
-    let mut stall_notes: Vec<String> = Vec::new();
-    if snap.fetch1_stall > 0 {
-        stall_notes.push(format!("F1={}", snap.fetch1_stall));
-    }
-    if snap.fetch2_stall > 0 {
-        stall_notes.push(format!("F2={}", snap.fetch2_stall));
-    }
-    if snap.mem1_stall > 0 {
-        stall_notes.push(format!("M1={}", snap.mem1_stall));
-    }
-
     // ── assemble ──────────────────────────────────────────────────────────────
     let mut out: Vec<String> = Vec::new();
     out.push(rule.clone());
@@ -233,6 +165,45 @@ fn render_inner(snap: &PipelineSnapshot) -> String {
     out.join("\n")
 }
 
+fn render_inner(snap: &PipelineSnapshot) -> String {
+    let w = snap.width;
+    let asm = |inst: u32| cell(&disassemble(inst));
+
+    let mut cols = vec![
+        column("F1", w, &snap.fetch1_fetch2, |e| format!("{:#010x}", e.pc), snap.fetch1_stall),
+        column("F2", w, &snap.fetch2_decode, |e| asm(e.inst), snap.fetch2_stall),
+        column("DE", w, &snap.decode_rename, |e| asm(e.inst), 0),
+        column("RN", w, &snap.rename_issue, |e| asm(e.inst), 0),
+        column(
+            "IS",
+            w,
+            &snap.issue_queue,
+            |e| issue_cell(e.inst, e.rs1_tag.is_some() || e.rs2_tag.is_some()),
+            0,
+        ),
+        column("EX", w, &snap.execute_mem1, |e| asm(e.inst), 0),
+        column("M1", w, &snap.mem1_mem2, |e| asm(e.inst), snap.mem1_stall),
+        column("M2", w, &snap.mem2_wb, |e| asm(e.inst), 0),
+    ];
+    cols.extend(tail_columns(w));
+
+    // ── forwarding annotations ────────────────────────────────────────────────
+    let mut notes: Vec<String> = Vec::new();
+    for e in &snap.execute_mem1 {
+        if !e.rd.is_zero() {
+            notes.push(format!("{}←{:#x}", reg_name(e.rd), e.alu));
+        }
+    }
+    for e in &snap.mem2_wb {
+        if !e.rd.is_zero() {
+            let v = if e.load_data != 0 { e.load_data } else { e.alu };
+            notes.push(format!("{}←{:#x}", reg_name(e.rd), v));
+        }
+    }
+    let stalls = stall_notes(snap.fetch1_stall, snap.fetch2_stall, snap.mem1_stall);
+    render_columns(w, &cols, &notes, &stalls)
+}
+
 // ── PipelineSnapshot ──────────────────────────────────────────────────────────
 
 /// Point-in-time snapshot of all pipeline inter-stage latches.
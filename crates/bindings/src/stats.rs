@@ -5,7 +5,7 @@
 //! output; `to_dict` for JSON-serializable export (multisim, scripting).
 
 use pyo3::prelude::*;
-use rvsim_core::stats::SimStats;
+use rvsim_core::stats::{SimStats, Stage};
 
 /// Internal statistics wrapper — not exposed to Python.
 #[derive(Clone)]
@@ -26,89 +26,173 @@ impl PyStats {
 
     /// Export all stats as a Python dict (JSON-serializable).
     pub fn to_dict(&self, py: Python<'_>) -> pyo3::PyResult<pyo3::Py<pyo3::types::PyDict>> {
-        let d = pyo3::types::PyDict::new(py);
-        let s = &self.inner;
-        d.set_item("cycles", s.cycles)?;
-        d.set_item("instructions_retired", s.instructions_retired)?;
-        d.set_item("icache_hits", s.icache_hits)?;
-        d.set_item("icache_misses", s.icache_misses)?;
-        d.set_item("dcache_hits", s.dcache_hits)?;
-        d.set_item("dcache_misses", s.dcache_misses)?;
-        d.set_item("l2_hits", s.l2_hits)?;
-        d.set_item("l2_misses", s.l2_misses)?;
-        d.set_item("l3_hits", s.l3_hits)?;
-        d.set_item("l3_misses", s.l3_misses)?;
-        d.set_item("stalls_mem", s.stalls_mem)?;
-        d.set_item("stalls_control", s.stalls_control)?;
-        d.set_item("stalls_data", s.stalls_data)?;
-        d.set_item("stalls_fu_structural", s.stalls_fu_structural)?;
-        d.set_item("stalls_backpressure", s.stalls_backpressure)?;
-        d.set_item("misprediction_penalty", s.misprediction_penalty)?;
-        d.set_item("pipeline_flushes", s.pipeline_flushes)?;
-        d.set_item("flushes_branch", s.flushes_branch)?;
-        d.set_item("flushes_system", s.flushes_system)?;
-        d.set_item("mem_ordering_violations", s.mem_ordering_violations)?;
-        d.set_item("stalls_dispatch", s.stalls_dispatch)?;
-        d.set_item("stalls_checkpoint", s.stalls_checkpoint)?;
-        d.set_item("stalls_squash", s.stalls_squash)?;
-        d.set_item("stalls_rename_rebuild", s.stalls_rename_rebuild)?;
-        d.set_item("stalls_mshr_full", s.stalls_mshr_full)?;
-
-        d.set_item("cycles_user", s.cycles_user)?;
-        d.set_item("cycles_kernel", s.cycles_kernel)?;
-        d.set_item("cycles_machine", s.cycles_machine)?;
-        d.set_item("traps_taken", s.traps_taken)?;
-
-        d.set_item("branch_predictions", s.committed_branch_predictions)?;
-        d.set_item("branch_mispredictions", s.committed_branch_mispredictions)?;
-        d.set_item("speculative_branch_predictions", s.speculative_branch_predictions)?;
-        d.set_item("speculative_branch_mispredictions", s.speculative_branch_mispredictions)?;
-
-        let total_bp = s.committed_branch_predictions + s.committed_branch_mispredictions;
-        let bp_acc = if total_bp > 0 {
-            100.0 * (s.committed_branch_predictions as f64 / total_bp as f64)
-        } else {
-            0.0
-        };
-        d.set_item("branch_accuracy_pct", bp_acc)?;
-
-        let spec_total = s.speculative_branch_predictions + s.speculative_branch_mispredictions;
-        let spec_acc = if spec_total > 0 {
-            100.0 * (s.speculative_branch_predictions as f64 / spec_total as f64)
-        } else {
-            0.0
-        };
-        d.set_item("speculative_branch_accuracy_pct", spec_acc)?;
-        let ipc = if s.cycles > 0 { s.instructions_retired as f64 / s.cycles as f64 } else { 0.0 };
-        d.set_item("ipc", ipc)?;
-
-        d.set_item("inst_load", s.inst_load)?;
-        d.set_item("inst_store", s.inst_store)?;
-        d.set_item("inst_branch", s.inst_branch)?;
-        d.set_item("inst_alu", s.inst_alu)?;
-        d.set_item("inst_system", s.inst_system)?;
-        d.set_item("inst_fp_load", s.inst_fp_load)?;
-        d.set_item("inst_fp_store", s.inst_fp_store)?;
-        d.set_item("inst_fp_arith", s.inst_fp_arith)?;
-        d.set_item("inst_fp_fma", s.inst_fp_fma)?;
-        d.set_item("inst_fp_div_sqrt", s.inst_fp_div_sqrt)?;
-
-        d.set_item("pf_dedup_l1", s.pf_dedup_l1)?;
-        d.set_item("pf_dedup_l2", s.pf_dedup_l2)?;
-        d.set_item("pf_dedup_l3", s.pf_dedup_l3)?;
-        d.set_item("mshr_allocations", s.mshr_allocations)?;
-        d.set_item("mshr_coalesces", s.mshr_coalesces)?;
-        d.set_item("load_replays", s.load_replays)?;
-
-        d.set_item("mdp_predictions_bypass", s.mdp_predictions_bypass)?;
-        d.set_item("mdp_predictions_wait_all", s.mdp_predictions_wait_all)?;
-        d.set_item("mdp_predictions_wait_for", s.mdp_predictions_wait_for)?;
-        d.set_item("mdp_violations", s.mdp_violations)?;
-
-        Ok(d.into())
+        stats_dict(py, &self.inner)
     }
 }
 
+/// Export `s` as a Python dict without copying the counters first.
+pub fn stats_dict(py: Python<'_>, s: &SimStats) -> pyo3::PyResult<pyo3::Py<pyo3::types::PyDict>> {
+    let d = pyo3::types::PyDict::new(py);
+    d.set_item("cycles", s.cycles)?;
+    d.set_item("instructions_retired", s.instructions_retired)?;
+    d.set_item("icache_hits", s.icache_hits)?;
+    d.set_item("icache_misses", s.icache_misses)?;
+    d.set_item("ftq_occupancy", s.ftq_occupancy)?;
+    d.set_item("stalls_ftq_full", s.stalls_ftq_full)?;
+    d.set_item("fdip_prefetches", s.fdip_prefetches)?;
+    d.set_item("fdip_useful", s.fdip_useful)?;
+    d.set_item("fdip_late", s.fdip_late)?;
+    d.set_item("dcache_hits", s.dcache_hits)?;
+    d.set_item("dcache_misses", s.dcache_misses)?;
+    d.set_item("l2_hits", s.l2_hits)?;
+    d.set_item("l2_misses", s.l2_misses)?;
+    d.set_item("l3_hits", s.l3_hits)?;
+    d.set_item("l3_misses", s.l3_misses)?;
+    d.set_item("stalls_mem", s.stalls_mem)?;
+    d.set_item("stalls_control", s.stalls_control)?;
+    d.set_item("stalls_data", s.stalls_data)?;
+    d.set_item("tma_slots", s.tma_slots)?;
+    d.set_item("tma_retiring", s.tma_retiring)?;
+    d.set_item("tma_bad_speculation", s.tma_bad_speculation)?;
+    d.set_item("tma_bad_spec_squashed", s.tma_bad_spec_squashed)?;
+    d.set_item("tma_bad_spec_recovery", s.tma_bad_spec_recovery)?;
+    d.set_item("tma_frontend_bound", s.tma_frontend_bound)?;
+    d.set_item("tma_fe_icache", s.tma_fe_icache)?;
+    d.set_item("tma_fe_itlb", s.tma_fe_itlb)?;
+    d.set_item("tma_fe_resteer", s.tma_fe_resteer)?;
+    d.set_item("tma_fe_bandwidth", s.tma_fe_bandwidth)?;
+    d.set_item("tma_backend_bound", s.tma_backend_bound)?;
+    d.set_item("tma_be_memory", s.tma_be_memory)?;
+    d.set_item("tma_be_mem_l1", s.tma_be_mem_l1)?;
+    d.set_item("tma_be_mem_l2", s.tma_be_mem_l2)?;
+    d.set_item("tma_be_mem_l3", s.tma_be_mem_l3)?;
+    d.set_item("tma_be_mem_dram", s.tma_be_mem_dram)?;
+    d.set_item("tma_be_core", s.tma_be_core)?;
+    d.set_item("tma_be_core_fu", s.tma_be_core_fu)?;
+    d.set_item("tma_be_core_other", s.tma_be_core_other)?;
+    d.set_item("stalls_fu_structural", s.stalls_fu_structural)?;
+    d.set_item("stalls_backpressure", s.stalls_backpressure)?;
+    d.set_item("misprediction_penalty", s.misprediction_penalty)?;
+    d.set_item("pipeline_flushes", s.pipeline_flushes)?;
+    d.set_item("flushes_branch", s.flushes_branch)?;
+    d.set_item("flushes_system", s.flushes_system)?;
+    d.set_item("mem_ordering_violations", s.mem_ordering_violations)?;
+    d.set_item("stalls_dispatch", s.stalls_dispatch)?;
+    d.set_item("stalls_checkpoint", s.stalls_checkpoint)?;
+    d.set_item("stalls_squash", s.stalls_squash)?;
+    d.set_item("stalls_rename_rebuild", s.stalls_rename_rebuild)?;
+    d.set_item("stalls_vector", s.stalls_vector)?;
+    d.set_item("stalls_mshr_full", s.stalls_mshr_full)?;
+
+    d.set_item("cycles_user", s.cycles_user)?;
+    d.set_item("cycles_kernel", s.cycles_kernel)?;
+    d.set_item("cycles_machine", s.cycles_machine)?;
+    d.set_item("traps_taken", s.traps_taken)?;
+
+    d.set_item("branch_predictions", s.committed_branch_predictions)?;
+    d.set_item("branch_mispredictions", s.committed_branch_mispredictions)?;
+    d.set_item("speculative_branch_predictions", s.speculative_branch_predictions)?;
+    d.set_item("speculative_branch_mispredictions", s.speculative_branch_mispredictions)?;
+
+    let total_bp = s.committed_branch_predictions + s.committed_branch_mispredictions;
+    let bp_acc = if total_bp > 0 {
+        100.0 * (s.committed_branch_predictions as f64 / total_bp as f64)
+    } else {
+        0.0
+    };
+    d.set_item("branch_accuracy_pct", bp_acc)?;
+
+    let spec_total = s.speculative_branch_predictions + s.speculative_branch_mispredictions;
+    let spec_acc = if spec_total > 0 {
+        100.0 * (s.speculative_branch_predictions as f64 / spec_total as f64)
+    } else {
+        0.0
+    };
+    d.set_item("speculative_branch_accuracy_pct", spec_acc)?;
+    let ipc = if s.cycles > 0 { s.instructions_retired as f64 / s.cycles as f64 } else { 0.0 };
+    d.set_item("ipc", ipc)?;
+
+    d.set_item("inst_load", s.inst_load)?;
+    d.set_item("inst_store", s.inst_store)?;
+    d.set_item("inst_branch", s.inst_branch)?;
+    d.set_item("inst_alu", s.inst_alu)?;
+    d.set_item("inst_system", s.inst_system)?;
+    d.set_item("inst_fp_load", s.inst_fp_load)?;
+    d.set_item("inst_fp_store", s.inst_fp_store)?;
+    d.set_item("inst_fp_arith", s.inst_fp_arith)?;
+    d.set_item("inst_fp_fma", s.inst_fp_fma)?;
+    d.set_item("inst_fp_div_sqrt", s.inst_fp_div_sqrt)?;
+    d.set_item("inst_vector", s.inst_vector)?;
+    d.set_item("vector_elements", s.vector_elements)?;
+    d.set_item("vector_mem_lines", s.vector_mem_lines)?;
+
+    d.set_item("pf_dedup_l1", s.pf_dedup_l1)?;
+    d.set_item("pf_dedup_l2", s.pf_dedup_l2)?;
+    d.set_item("pf_dedup_l3", s.pf_dedup_l3)?;
+    d.set_item("mshr_allocations", s.mshr_allocations)?;
+    d.set_item("mshr_coalesces", s.mshr_coalesces)?;
+    d.set_item("mshr_occupancy", s.mshr_occupancy)?;
+    d.set_item("l2_mshr_allocations", s.l2_mshr_allocations)?;
+    d.set_item("l2_mshr_coalesces", s.l2_mshr_coalesces)?;
+    d.set_item("stalls_l2_mshr_full", s.stalls_l2_mshr_full)?;
+    d.set_item("l2_mshr_occupancy", s.l2_mshr_occupancy)?;
+    d.set_item("l3_mshr_allocations", s.l3_mshr_allocations)?;
+    d.set_item("l3_mshr_coalesces", s.l3_mshr_coalesces)?;
+    d.set_item("stalls_l3_mshr_full", s.stalls_l3_mshr_full)?;
+    d.set_item("l3_mshr_occupancy", s.l3_mshr_occupancy)?;
+    d.set_item("load_replays", s.load_replays)?;
+
+    d.set_item("coherence_misses", s.coherence_misses)?;
+    d.set_item("coherence_upgrades", s.coherence_upgrades)?;
+    d.set_item("coherence_invalidations_sent", s.coherence_invalidations_sent)?;
+    d.set_item("coherence_invalidations_received", s.coherence_invalidations_received)?;
+    d.set_item("coherence_transfers", s.coherence_transfers)?;
+    d.set_item("coherence_stall_cycles", s.coherence_stall_cycles)?;
+    d.set_item("coherence_sharers_0", s.coherence_sharers[0])?;
+    d.set_item("coherence_sharers_1", s.coherence_sharers[1])?;
+    d.set_item("coherence_sharers_2", s.coherence_sharers[2])?;
+    d.set_item("coherence_sharers_3plus", s.coherence_sharers[3])?;
+
+    d.set_item("itlb_hits", s.itlb_hits)?;
+    d.set_item("itlb_misses", s.itlb_misses)?;
+    d.set_item("dtlb_hits", s.dtlb_hits)?;
+    d.set_item("dtlb_misses", s.dtlb_misses)?;
+    d.set_item("l2_tlb_hits", s.l2_tlb_hits)?;
+    d.set_item("l2_tlb_misses", s.l2_tlb_misses)?;
+    d.set_item("tlb_superpage_hits", s.tlb_superpage_hits)?;
+    d.set_item("page_walks", s.page_walks)?;
+    d.set_item("ptw_pte_reads", s.ptw_pte_reads)?;
+    d.set_item("pwc_hits", s.pwc_hits)?;
+    d.set_item("pwc_misses", s.pwc_misses)?;
+
+    d.set_item("mdp_predictions_bypass", s.mdp_predictions_bypass)?;
+    d.set_item("mdp_predictions_wait_all", s.mdp_predictions_wait_all)?;
+    d.set_item("mdp_predictions_wait_for", s.mdp_predictions_wait_for)?;
+    d.set_item("mdp_violations", s.mdp_violations)?;
+
+    let sd = &s.stack_distance;
+    if !sd.is_empty() {
+        let profile = pyo3::types::PyDict::new(py);
+        profile.set_item("line_bytes", sd.line_bytes)?;
+        profile.set_item("ways", sd.ways)?;
+        profile.set_item("sets", &sd.sets)?;
+        profile.set_item("accesses", &sd.accesses)?;
+        let hits: Vec<&[u64]> = sd.hits.chunks(sd.ways).collect();
+        profile.set_item("hits", hits)?;
+        d.set_item("stack_distance", profile)?;
+    }
+
+    let times = &s.stage_times;
+    if !times.is_empty() {
+        for stage in Stage::ALL {
+            d.set_item(format!("host_ns_{}", stage.name()), times.ns[stage as usize])?;
+            d.set_item(format!("host_calls_{}", stage.name()), times.calls[stage as usize])?;
+        }
+    }
+
+    Ok(d.into())
+}
+
 impl From<SimStats> for PyStats {
     fn from(inner: SimStats) -> Self {
         Self { inner }
@@ -2,7 +2,12 @@
 //!
 //! Provides version and other helpers for the `rvsim` module.
 
+use crate::conversion::py_dict_to_config;
+use crate::stats::stats_dict;
+use pyo3::exceptions::PyRuntimeError;
 use pyo3::prelude::*;
+use pyo3::types::{PyBytes, PyDict};
+use rvsim_core::sim::simulator::{BatchExit, RunLimits};
 
 /// Returns the emulator version string (e.g., for scripting or diagnostics).
 ///
@@ -34,3 +39,116 @@ pub fn version() -> String {
 pub fn disassemble(inst: u32) -> String {
     rvsim_core::isa::disasm::disassemble(inst)
 }
+
+/// Replay a memory trace through a cache hierarchy built from a config.
+///
+/// Only the caches, prefetchers, MSHRs, and DRAM controller run, so this is
+/// far faster than re-running the program. The GIL is released meanwhile.
+///
+/// # Arguments
+///
+/// * `config_dict` - Configuration dict, as for `Cpu`.
+/// * `path` - Trace written by `Cpu.open_mem_trace`.
+///
+/// # Returns
+///
+/// The replay's statistics dict (cache counters; nothing is executed).
+#[pyfunction]
+pub fn replay_mem_trace(
+    py: Python<'_>,
+    config_dict: &Bound<'_, PyAny>,
+    path: &str,
+) -> PyResult<PyObject> {
+    let config = py_dict_to_config(py, config_dict)?;
+    let stats = py
+        .allow_threads(|| rvsim_core::sim::replay::replay_mem_trace(&config, path))
+        .map_err(|e| PyRuntimeError::new_err(e.to_string()))?;
+    Ok(stats_dict(py, &stats)?.into_bound(py).into_any().unbind())
+}
+
+/// Score the branch predictor of several configs on one branch trace.
+///
+/// Only a predictor per config runs, each on its own host thread, so a whole
+/// predictor sweep costs about one pass over the trace. The GIL is released
+/// meanwhile.
+///
+/// # Arguments
+///
+/// * `config_dicts` - Configuration dicts, as for `Cpu`.
+/// * `path` - Trace written by `Cpu.open_branch_trace`.
+///
+/// # Returns
+///
+/// One statistics dict per config, in order (`inst_branch` and the
+/// committed branch counters; nothing is executed).
+#[pyfunction]
+pub fn replay_branch_trace(
+    py: Python<'_>,
+    config_dicts: Vec<Bound<'_, PyAny>>,
+    path: &str,
+) -> PyResult<Vec<PyObject>> {
+    let configs = config_dicts
+        .iter()
+        .map(|config| py_dict_to_config(py, config))
+        .collect::<PyResult<Vec<_>>>()?;
+    let stats = py
+        .allow_threads(|| rvsim_core::sim::replay::replay_branch_trace(&configs, path))
+        .map_err(|e| PyRuntimeError::new_err(e.to_string()))?;
+    stats.iter().map(|s| Ok(stats_dict(py, s)?.into_bound(py).into_any().unbind())).collect()
+}
+
+/// Run bare-metal test ELFs under several configs, all in this process.
+///
+/// Every image runs under every config on a pool of host threads; each
+/// thread reuses one simulator, reset between tests. The GIL is released
+/// meanwhile.
+///
+/// # Arguments
+///
+/// * `config_dicts` - Configuration dicts, as for `Cpu`.
+/// * `binaries` - Raw bytes of each test ELF.
+/// * `limit` - Cycle limit per test (`None` for no limit).
+/// * `threads` - Host threads (0 for one per available CPU).
+///
+/// # Returns
+///
+/// One dict per (config, test) pair, ordered by config then test, with
+/// `config`, `test`, `exit_code` (`None` if the limit was reached),
+/// `error`, `cycles`, `instructions`, and `signature` (the bytes between
+/// the `begin_signature` and `end_signature` symbols, or `None`).
+#[pyfunction]
+#[pyo3(signature = (config_dicts, binaries, limit=None, threads=0))]
+pub fn run_suite(
+    py: Python<'_>,
+    config_dicts: Vec<Bound<'_, PyAny>>,
+    binaries: Vec<Vec<u8>>,
+    limit: Option<u64>,
+    threads: usize,
+) -> PyResult<Vec<PyObject>> {
+    let configs = config_dicts
+        .iter()
+        .map(|config| py_dict_to_config(py, config))
+        .collect::<PyResult<Vec<_>>>()?;
+    let limits = RunLimits { cycles: limit, instructions: None };
+    let outcomes = py
+        .allow_threads(|| rvsim_core::sim::suite::run_suite(&configs, &binaries, limits, threads));
+    outcomes
+        .into_iter()
+        .map(|outcome| {
+            let d = PyDict::new(py);
+            d.set_item("config", outcome.config)?;
+            d.set_item("test", outcome.test)?;
+            let (exit_code, error) = match outcome.result {
+                Ok(BatchExit::Exited(code)) => (Some(code), None),
+                Ok(BatchExit::Limit | BatchExit::Stopped) => (None, None),
+                Err(e) => (None, Some(e.to_string())),
+            };
+            d.set_item("exit_code", exit_code)?;
+            d.set_item("error", error)?;
+            d.set_item("cycles", outcome.cycles)?;
+            d.set_item("instructions", outcome.instructions)?;
+            d.set_item("signature", outcome.signature.map(|sig| PyBytes::new(py, &sig)))?;
+            Ok(d.into_any().unbind())
+        })
+        .collect()
+}
@@ -0,0 +1,327 @@
+//! # Host-Throughput Benchmarks
+//!
+//! Measures how fast the simulator itself runs: a fixed set of example ELFs
+//! on the in-order and out-of-order backends at several widths, reporting
+//! simulated KIPS, host nanoseconds per simulated cycle, and heap
+//! allocations per simulated cycle (the hot path should not allocate).
+//!
+//! ```text
+//! cargo bench -p rvsim-core --bench throughput                    # all cases
+//! cargo bench -p rvsim-core --bench throughput -- qsort           # filter by name
+//! cargo bench -p rvsim-core --bench throughput -- --save-baseline base.json
+//! cargo bench -p rvsim-core --bench throughput -- --baseline base.json
+//! ```
+//!
+//! The ELFs come from `software/bin/benchmarks` (`make software`); missing
+//! ones are skipped. Each case runs `--samples` times (default 3) for at most
+//! `RVSIM_BENCH_CYCLES` cycles (default 2,000,000) and keeps the fastest
+//! sample. Against a `--baseline`, a case whose ns/cycle or allocations per
+//! cycle grew by more than `--threshold` percent (default 10) is reported as
+//! a regression and the bench exits with status 1.
+
+#![allow(clippy::print_stdout, clippy::print_stderr, missing_docs)]
+
+use rvsim_core::config::Config;
+use rvsim_core::core::arch::mode::PrivilegeMode;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::sim::loader;
+use rvsim_core::{Simulator, System};
+use serde_json::{Value, json};
+use std::alloc::{GlobalAlloc, Layout, System as SystemAlloc};
+use std::path::{Path, PathBuf};
+use std::process::ExitCode;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::time::Instant;
+
+/// Example programs, from `examples/benchmarks`: microbenchmarks first, then
+/// kernels and complete programs.
+const PROGRAMS: &[&str] = &[
+    "alu_int_mul",
+    "bp_pattern_alt",
+    "pipe_load_use",
+    "mix_matrix_mul",
+    "qsort",
+    "aes_bench",
+    "lz77_bench",
+];
+
+/// Backends and widths each program runs on.
+const CORES: &[(BackendType, &str, usize)] = &[
+    (BackendType::InOrder, "inorder", 1),
+    (BackendType::InOrder, "inorder", 2),
+    (BackendType::OutOfOrder, "o3", 1),
+    (BackendType::OutOfOrder, "o3", 2),
+    (BackendType::OutOfOrder, "o3", 4),
+];
+
+/// Default per-run cycle budget.
+const DEFAULT_CYCLES: u64 = 2_000_000;
+
+/// Heap allocations made by the process, counted by [`CountingAlloc`].
+static ALLOCATIONS: AtomicU64 = AtomicU64::new(0);
+
+/// The system allocator, counting every allocation and reallocation.
+struct CountingAlloc;
+
+// SAFETY: every call is forwarded unchanged to the system allocator, which
+// upholds the `GlobalAlloc` contract; the counter has no effect on memory.
+unsafe impl GlobalAlloc for CountingAlloc {
+    unsafe fn alloc(&self, layout: Layout) -> *mut u8 {
+        let _ = ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        // SAFETY: the caller's layout contract is passed through.
+        unsafe { SystemAlloc.alloc(layout) }
+    }
+
+    unsafe fn alloc_zeroed(&self, layout: Layout) -> *mut u8 {
+        let _ = ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        // SAFETY: the caller's layout contract is passed through.
+        unsafe { SystemAlloc.alloc_zeroed(layout) }
+    }
+
+    unsafe fn realloc(&self, ptr: *mut u8, layout: Layout, new_size: usize) -> *mut u8 {
+        let _ = ALLOCATIONS.fetch_add(1, Ordering::Relaxed);
+        // SAFETY: `ptr` was allocated by this allocator with `layout`.
+        unsafe { SystemAlloc.realloc(ptr, layout, new_size) }
+    }
+
+    unsafe fn dealloc(&self, ptr: *mut u8, layout: Layout) {
+        // SAFETY: `ptr` was allocated by this allocator with `layout`.
+        unsafe { SystemAlloc.dealloc(ptr, layout) }
+    }
+}
+
+#[global_allocator]
+static GLOBAL: CountingAlloc = CountingAlloc;
+
+/// Command-line options.
+#[derive(Debug)]
+struct Options {
+    filter: Vec<String>,
+    samples: usize,
+    cycles: u64,
+    threshold: f64,
+    save_baseline: Option<PathBuf>,
+    baseline: Option<PathBuf>,
+}
+
+impl Options {
+    fn parse() -> Result<Self, String> {
+        let mut opts = Self {
+            filter: Vec::new(),
+            samples: 3,
+            cycles: match std::env::var("RVSIM_BENCH_CYCLES") {
+                Ok(v) => v.parse().map_err(|_| format!("bad RVSIM_BENCH_CYCLES '{v}'"))?,
+                Err(_) => DEFAULT_CYCLES,
+            },
+            threshold: 10.0,
+            save_baseline: None,
+            baseline: None,
+        };
+        let mut args = std::env::args().skip(1);
+        while let Some(arg) = args.next() {
+            let mut value = |name: &str| args.next().ok_or_else(|| format!("{name} needs a value"));
+            match arg.as_str() {
+                // Passed by `cargo bench`.
+                "--bench" => {}
+                "--samples" => {
+                    opts.samples = value("--samples")?.parse().map_err(|e| format!("{e}"))?;
+                }
+                "--threshold" => {
+                    opts.threshold = value("--threshold")?.parse().map_err(|e| format!("{e}"))?;
+                }
+                "--save-baseline" => opts.save_baseline = Some(value("--save-baseline")?.into()),
+                "--baseline" => opts.baseline = Some(value("--baseline")?.into()),
+                flag if flag.starts_with("--") => return Err(format!("unknown option '{flag}'")),
+                name => opts.filter.push(name.to_owned()),
+            }
+        }
+        opts.samples = opts.samples.max(1);
+        Ok(opts)
+    }
+}
+
+/// One benchmark case's best sample.
+#[derive(Debug)]
+struct Measurement {
+    name: String,
+    cycles: u64,
+    instructions: u64,
+    host_ns: u64,
+    allocations: u64,
+}
+
+impl Measurement {
+    fn kips(&self) -> f64 {
+        self.instructions as f64 / (self.host_ns.max(1) as f64 * 1e-9) / 1e3
+    }
+
+    fn ns_per_cycle(&self) -> f64 {
+        self.host_ns as f64 / self.cycles.max(1) as f64
+    }
+
+    fn allocs_per_cycle(&self) -> f64 {
+        self.allocations as f64 / self.cycles.max(1) as f64
+    }
+
+    fn to_json(&self) -> Value {
+        json!({
+            "name": self.name,
+            "cycles": self.cycles,
+            "instructions": self.instructions,
+            "host_ns": self.host_ns,
+            "kips": self.kips(),
+            "ns_per_cycle": self.ns_per_cycle(),
+            "allocs_per_cycle": self.allocs_per_cycle(),
+        })
+    }
+}
+
+/// Builds a bare-metal simulator for `elf`, as the Python `Cpu` does.
+fn build(config: &Config, elf: &[u8]) -> Result<Simulator, String> {
+    let mut system = System::new(config, "");
+    let loaded = loader::try_load_elf(elf, &mut system.bus).ok_or("not a valid ELF file")?;
+    if let Some(tohost) = loaded.tohost_addr {
+        system.add_htif(tohost);
+    }
+    let mut sim = Simulator::new(system, config);
+    sim.cpu.pc = loaded.entry;
+    if let Some(tohost) = loaded.tohost_addr {
+        sim.cpu.direct_mode = false;
+        sim.cpu.privilege = PrivilegeMode::Machine;
+        sim.cpu.htif_range = Some((tohost, tohost + 16));
+    }
+    sim.sync_arch_regs();
+    Ok(sim)
+}
+
+/// Runs `elf` under `config` `samples` times and keeps the fastest sample.
+fn measure(name: &str, config: &Config, elf: &[u8], opts: &Options) -> Result<Measurement, String> {
+    let mut best: Option<Measurement> = None;
+    for _ in 0..opts.samples {
+        let mut sim = build(config, elf)?;
+        let allocs = ALLOCATIONS.load(Ordering::Relaxed);
+        let start = Instant::now();
+        let _ = sim.run(opts.cycles).map_err(|e| e.to_string())?;
+        let host_ns = start.elapsed().as_nanos() as u64;
+        let allocations = ALLOCATIONS.load(Ordering::Relaxed) - allocs;
+        if best.as_ref().is_none_or(|b| host_ns < b.host_ns) {
+            best = Some(Measurement {
+                name: name.to_owned(),
+                cycles: sim.cpu.stats.cycles,
+                instructions: sim.cpu.stats.instructions_retired,
+                host_ns,
+                allocations,
+            });
+        }
+    }
+    best.ok_or_else(|| "no samples".to_owned())
+}
+
+/// Reads a baseline saved with `--save-baseline`, keyed by case name.
+fn load_baseline(path: &Path) -> Result<Vec<(String, f64, f64)>, String> {
+    let text = std::fs::read_to_string(path).map_err(|e| format!("{}: {e}", path.display()))?;
+    let doc: Value = serde_json::from_str(&text).map_err(|e| format!("{}: {e}", path.display()))?;
+    let cases = doc["results"].as_array().ok_or("baseline has no results")?;
+    Ok(cases
+        .iter()
+        .filter_map(|c| {
+            Some((
+                c["name"].as_str()?.to_owned(),
+                c["ns_per_cycle"].as_f64()?,
+                c["allocs_per_cycle"].as_f64()?,
+            ))
+        })
+        .collect())
+}
+
+/// Percentage change from `base` to `now`.
+fn change(base: f64, now: f64) -> f64 {
+    if base == 0.0 {
+        if now == 0.0 { 0.0 } else { f64::INFINITY }
+    } else {
+        100.0 * (now - base) / base
+    }
+}
+
+fn run(opts: &Options) -> Result<bool, String> {
+    let bin_dir = Path::new(env!("CARGO_MANIFEST_DIR")).join("../../software/bin/benchmarks");
+    let baseline = opts.baseline.as_deref().map(load_baseline).transpose()?;
+
+    println!(
+        "{:<28} {:>11} {:>11} {:>10} {:>10} {:>11}",
+        "case", "cycles", "insts", "KIPS", "ns/cycle", "allocs/cyc"
+    );
+    let mut results = Vec::new();
+    let mut regressed = false;
+    for program in PROGRAMS {
+        let path = bin_dir.join(format!("{program}.elf"));
+        let Ok(elf) = std::fs::read(&path) else {
+            eprintln!("skipping {program}: {} not found (run `make software`)", path.display());
+            continue;
+        };
+        for &(backend, label, width) in CORES {
+            let name = format!("{program}/{label}-w{width}");
+            if !opts.filter.is_empty() && !opts.filter.iter().any(|f| name.contains(f.as_str())) {
+                continue;
+            }
+            let mut config = Config::default();
+            config.system.uart_quiet = true;
+            config.pipeline.backend = backend;
+            config.pipeline.width = width;
+
+            let m = measure(&name, &config, &elf, opts)?;
+            print!(
+                "{:<28} {:>11} {:>11} {:>10.0} {:>10.1} {:>11.4}",
+                m.name,
+                m.cycles,
+                m.instructions,
+                m.kips(),
+                m.ns_per_cycle(),
+                m.allocs_per_cycle()
+            );
+            if let Some((_, ns, allocs)) =
+                baseline.as_ref().and_then(|b| b.iter().find(|(n, ..)| *n == m.name))
+            {
+                let ns_change = change(*ns, m.ns_per_cycle());
+                let alloc_change = change(*allocs, m.allocs_per_cycle());
+                print!("  {ns_change:+6.1}% ns/cycle");
+                if ns_change > opts.threshold || alloc_change > opts.threshold {
+                    regressed = true;
+                    print!("  REGRESSED");
+                    if alloc_change > opts.threshold {
+                        print!(" (allocs/cycle {alloc_change:+.1}%)");
+                    }
+                }
+            }
+            println!();
+            results.push(m);
+        }
+    }
+
+    if let Some(path) = &opts.save_baseline {
+        let doc = json!({
+            "cycle_budget": opts.cycles,
+            "samples": opts.samples,
+            "results": results.iter().map(Measurement::to_json).collect::<Vec<_>>(),
+        });
+        let text = serde_json::to_string_pretty(&doc).map_err(|e| e.to_string())?;
+        std::fs::write(path, text + "\n").map_err(|e| format!("{}: {e}", path.display()))?;
+        println!("baseline saved to {}", path.display());
+    }
+    Ok(!regressed)
+}
+
+fn main() -> ExitCode {
+    let result = Options::parse().and_then(|opts| run(&opts));
+    match result {
+        Ok(true) => ExitCode::SUCCESS,
+        Ok(false) => {
+            eprintln!("throughput regressed against the baseline");
+            ExitCode::FAILURE
+        }
+        Err(e) => {
+            eprintln!("error: {e}");
+            ExitCode::FAILURE
+        }
+    }
+}
@@ -308,6 +308,8 @@ pub enum LrScRecord {
     Lr {
         /// Physical address to reserve.
         paddr: crate::common::PhysAddr,
+        /// Value the LR read (validated by an SMP store-conditional).
+        value: u64,
     },
     /// SC: check the reservation at commit.  If valid, clear it and
     /// let the store drain.  If invalid, the speculative SC result (0)
@@ -315,6 +317,19 @@ pub enum LrScRecord {
     Sc {
         /// Physical address to check reservation against.
         paddr: crate::common::PhysAddr,
+        /// Store data (an SMP SC writes it at commit under the atomic-domain lock).
+        data: u64,
+    },
+    /// AMO in an SMP system: redo the read-modify-write atomically at
+    /// commit.  If memory changed since Memory2 read `old`, the result is
+    /// corrected and younger instructions are flushed.
+    Amo {
+        /// Physical address of the operand.
+        paddr: crate::common::PhysAddr,
+        /// Register operand (rs2).
+        operand: u64,
+        /// Old value Memory2 read and forwarded speculatively.
+        old: u64,
     },
 }
 
@@ -41,6 +41,68 @@ pub enum SimError {
         cycle_count: u64,
     },
 
+    /// A checkpoint file could not be written or read.
+    #[error("checkpoint I/O error on '{path}': {source}")]
+    CheckpointIo {
+        /// Checkpoint path.
+        path: String,
+        /// Underlying I/O error.
+        source: std::io::Error,
+    },
+
+    /// A checkpoint file is malformed or does not match this simulator.
+    ///
+    /// Checkpoints must be restored into a simulator with the same RAM layout.
+    #[error("invalid checkpoint '{path}': {reason}")]
+    InvalidCheckpoint {
+        /// Checkpoint path.
+        path: String,
+        /// What did not match.
+        reason: String,
+    },
+
+    /// The system holds state that checkpoints do not capture.
+    ///
+    /// Checkpoints cover a single hart, RAM, and the CLINT timer; multi-hart
+    /// systems and guests that have configured the PLIC, UART, or `VirtIO`
+    /// disk cannot be checkpointed.
+    #[error("cannot checkpoint this system: {reason}")]
+    CheckpointUnsupported {
+        /// What would be lost.
+        reason: String,
+    },
+
+    /// A memory-access trace could not be written or read, or is malformed.
+    #[error("memory trace I/O error on '{path}': {source}")]
+    MemTraceIo {
+        /// Trace path.
+        path: String,
+        /// Underlying I/O error.
+        source: std::io::Error,
+    },
+
+    /// A branch trace could not be written or read, or is malformed.
+    #[error("branch trace I/O error on '{path}': {source}")]
+    BranchTraceIo {
+        /// Trace path.
+        path: String,
+        /// Underlying I/O error.
+        source: std::io::Error,
+    },
+
+    /// An interval statistics file could not be written or read.
+    #[error("interval statistics I/O error on '{path}': {source}")]
+    IntervalStatsIo {
+        /// File path.
+        path: String,
+        /// Underlying I/O error.
+        source: std::io::Error,
+    },
+
+    /// A program image is not an ELF file the loader can parse.
+    #[error("not a valid ELF file")]
+    InvalidElf,
+
     /// A kernel panic was detected via the `tohost`/panic sentinel mechanism.
     ///
     /// The guest OS crashed. Inspect the serial output for the panic message.
@@ -12,6 +12,12 @@ use crate::core::pipeline::backend::o3::fu_pool::FuConfig;
 use crate::core::pipeline::engine::BackendType;
 use serde::Deserialize;
 
+/// Largest supported hart count.
+///
+/// Bounded by the CLINT/PLIC contexts the DTB describes and by the per-hart
+/// reservation table.
+pub const MAX_HARTS: usize = 16;
+
 /// Default configuration constants for the simulator.
 ///
 /// These values define the baseline hardware configuration when not
@@ -41,6 +47,9 @@ mod defaults {
     /// Base address of `VirtIO` block device MMIO region.
     pub const DISK_BASE: u64 = 0x9000_0000;
 
+    /// `VirtIO` disk requests serviced concurrently.
+    pub const DISK_QUEUE_DEPTH: usize = 1;
+
     /// Base address of CLINT (Core Local Interruptor) timer MMIO region.
     pub const CLINT_BASE: u64 = 0x0200_0000;
 
@@ -62,6 +71,24 @@ mod defaults {
     /// Divides the simulation cycle counter to produce the machine timer value.
     pub const CLINT_DIVIDER: u64 = 10;
 
+    /// Number of harts (hardware threads) in the system.
+    pub const HARTS: usize = 1;
+
+    /// Cycles each hart runs on its own host thread between SMP barriers.
+    ///
+    /// Interrupt lines and device time are only synchronized at quantum
+    /// boundaries, so this bounds the timer/IPI delivery latency.
+    pub const SMP_QUANTUM: u64 = 1000;
+
+    /// Directory round trip for an S→M upgrade with no other sharers, in cycles.
+    pub const COHERENCE_UPGRADE_LATENCY: u64 = 10;
+
+    /// Cycles to invalidate peer copies and collect acknowledgements.
+    pub const COHERENCE_INVALIDATION_LATENCY: u64 = 20;
+
+    /// Cycles for a cache-to-cache transfer from the owning hart.
+    pub const COHERENCE_TRANSFER_LATENCY: u64 = 40;
+
     /// CAS (Column Access Strobe) latency in DRAM cycles.
     ///
     /// Time from column address assertion to data availability for reads.
@@ -105,6 +132,30 @@ mod defaults {
     /// are unavailable.
     pub const T_RFC: u64 = 350;
 
+    /// DRAM channels (FR-FCFS controller).
+    pub const CHANNELS: usize = 1;
+
+    /// Ranks per channel (FR-FCFS controller).
+    pub const RANKS: usize = 1;
+
+    /// Read queue entries per channel.
+    pub const READ_QUEUE_SIZE: usize = 32;
+
+    /// Write queue entries per channel.
+    pub const WRITE_QUEUE_SIZE: usize = 32;
+
+    /// Write-queue occupancy that starts a write drain.
+    pub const WRITE_HIGH_WATERMARK: usize = 24;
+
+    /// Write-queue occupancy at which a write drain stops.
+    pub const WRITE_LOW_WATERMARK: usize = 8;
+
+    /// Data-bus cycles per 64-byte burst (BL8 on a DDR bus at 1 GHz core clock).
+    pub const T_BURST: u64 = 4;
+
+    /// Write-to-read bus turnaround in cycles.
+    pub const T_WTR: u64 = 8;
+
     /// Translation Lookaside Buffer entry count (L1).
     ///
     /// Number of virtual-to-physical address translations cached in each L1 TLB.
@@ -119,6 +170,15 @@ mod defaults {
     /// L2 TLB hit latency in cycles.
     pub const L2_TLB_LATENCY: u64 = 4;
 
+    /// Superpage (2 MiB / 1 GiB) entries in each L1 TLB.
+    pub const TLB_SUPERPAGE_ENTRIES: usize = 8;
+
+    /// Superpage (2 MiB / 1 GiB) entries in the L2 TLB.
+    pub const L2_TLB_SUPERPAGE_ENTRIES: usize = 16;
+
+    /// Page-walk cache entries (cached non-leaf PTEs).
+    pub const PAGE_WALK_CACHE_SIZE: usize = 16;
+
     /// Default cache size in bytes (4 KiB).
     pub const CACHE_SIZE: usize = 4096;
 
@@ -142,6 +202,16 @@ mod defaults {
     /// Default MSHR count for L1D cache (0 = blocking cache).
     pub const L1D_MSHR_COUNT: usize = 0;
 
+    /// Default largest set count profiled for stack distances (16 Ki sets,
+    /// 16 MiB at 16 ways of 64 bytes).
+    pub const STACK_DISTANCE_MAX_SETS: usize = 16384;
+
+    /// Default largest associativity profiled for stack distances.
+    pub const STACK_DISTANCE_MAX_WAYS: usize = 16;
+
+    /// Default sets tracked per profiled set count (exact up to 1 Ki sets).
+    pub const STACK_DISTANCE_SAMPLED_SETS: usize = 1024;
+
     /// Default pipeline width (1 instruction per cycle).
     pub const PIPELINE_WIDTH: usize = 1;
 
@@ -208,6 +278,54 @@ mod defaults {
 
     /// Default Tournament predictor local prediction table size (log2, 1024 entries).
     pub const TOURNAMENT_LOCAL_PRED_BITS: usize = 10;
+
+    /// Default vector register length (VLEN) in bits.
+    pub const VECTOR_VLEN: usize = 128;
+
+    /// Default number of 64-bit vector datapath lanes.
+    pub const VECTOR_LANES: usize = 2;
+
+    /// Default vector integer ALU latency (cycles).
+    pub const VECTOR_ALU_LATENCY: u64 = 2;
+
+    /// Default vector integer multiply latency (cycles).
+    pub const VECTOR_MUL_LATENCY: u64 = 4;
+
+    /// Default vector floating-point latency (cycles).
+    pub const VECTOR_FP_LATENCY: u64 = 4;
+
+    /// Default vector divide and square-root latency (cycles).
+    pub const VECTOR_DIV_LATENCY: u64 = 20;
+
+    /// Default vector instruction queue depth.
+    pub const VECTOR_QUEUE_DEPTH: usize = 8;
+
+    /// Default physical vector register count (32 = no renaming).
+    pub const VECTOR_PHYS_REGS: usize = 32;
+
+    /// Default fetch target queue depth in fetch blocks (0 = coupled frontend).
+    pub const FTQ_DEPTH: usize = 0;
+}
+
+/// Host page size backing guest RAM.
+///
+/// Huge pages cut host TLB misses for guests that touch RAM at random. They
+/// are a host-side performance hint only: simulated behaviour and timing are
+/// unaffected, and unsupported settings fall back silently.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default, Deserialize)]
+#[serde(rename_all = "lowercase")]
+pub enum HugePages {
+    /// Regular host pages.
+    #[default]
+    #[serde(alias = "Off")]
+    Off,
+    /// Transparent huge pages (`madvise(MADV_HUGEPAGE)`).
+    #[serde(alias = "Transparent", alias = "thp")]
+    Transparent,
+    /// Explicit 2 MiB huge pages from the host's reserved pool
+    /// (`MAP_HUGETLB`), falling back to transparent ones when none are reserved.
+    #[serde(alias = "Explicit", alias = "hugetlb")]
+    Explicit,
 }
 
 /// Memory controller implementation types.
@@ -229,6 +347,12 @@ pub enum MemoryController {
     /// and row buffer hit/miss penalties for more accurate timing.
     #[serde(alias = "DRAM")]
     Dram,
+    /// Transaction-queue DRAM controller with FR-FCFS scheduling.
+    ///
+    /// Uses the same DRAM timing plus per-channel read/write queues,
+    /// write-drain watermarks, and channel/rank address interleaving.
+    #[serde(alias = "FRFCFS", alias = "FR-FCFS")]
+    FrFcfs,
 }
 
 /// Cache replacement policy algorithms.
@@ -505,6 +629,18 @@ pub struct GeneralConfig {
     /// Initial stack pointer (only used when `direct_mode` is true). Defaults to `ram_base` + 16MiB if not set.
     #[serde(default)]
     pub initial_sp: Option<u64>,
+
+    /// Functional fast-forward before switching to the detailed pipeline
+    #[serde(default)]
+    pub fast_forward: FastForwardConfig,
+
+    /// Account WFI idle time up to the next device event in one step instead of ticking through it
+    #[serde(default = "GeneralConfig::default_idle_skip")]
+    pub idle_skip: bool,
+
+    /// Region-of-interest handling for the guest's `roi_begin`/`roi_end` markers
+    #[serde(default)]
+    pub roi: RoiConfig,
 }
 
 impl GeneralConfig {
@@ -517,6 +653,11 @@ impl GeneralConfig {
     const fn default_direct_mode() -> bool {
         true
     }
+
+    /// Idle skipping is exact, so it is on by default.
+    const fn default_idle_skip() -> bool {
+        true
+    }
 }
 
 impl Default for GeneralConfig {
@@ -526,10 +667,79 @@ impl Default for GeneralConfig {
             start_pc: defaults::RAM_BASE,
             direct_mode: true,
             initial_sp: None,
+            fast_forward: FastForwardConfig::default(),
+            idle_skip: true,
+            roi: RoiConfig::default(),
         }
     }
 }
 
+/// Functional fast-forward settings.
+///
+/// When enabled, the simulator starts in the functional (atomic) engine and
+/// switches to the detailed pipeline at the first trigger that fires. With
+/// no trigger set, the whole run stays functional.
+#[derive(Debug, Clone, Copy, Default, Deserialize)]
+#[allow(clippy::struct_excessive_bools)]
+pub struct FastForwardConfig {
+    /// Start in functional mode
+    #[serde(default)]
+    pub enabled: bool,
+
+    /// Switch to the detailed pipeline when the PC reaches this address
+    #[serde(default)]
+    pub until_pc: Option<u64>,
+
+    /// Switch to the detailed pipeline after this many retired instructions
+    #[serde(default)]
+    pub until_instructions: Option<u64>,
+
+    /// Switch to the detailed pipeline when the guest writes the marker CSR (0x8FE)
+    #[serde(default)]
+    pub until_marker: bool,
+
+    /// Functional warming: train caches and branch predictor while fast-forwarding
+    #[serde(default)]
+    pub warm: bool,
+
+    /// Collect `SimPoint` basic-block vectors every N instructions while fast-forwarding
+    #[serde(default)]
+    pub bbv_interval: Option<u64>,
+
+    /// Run hot basic blocks from the translated-block tier while fast-forwarding
+    #[serde(default)]
+    pub dbt: bool,
+}
+
+/// Region-of-interest (ROI) settings.
+///
+/// Guest code delimits its region of interest by writing
+/// [`SIM_MARKER_ROI_BEGIN`](crate::core::arch::csr::SIM_MARKER_ROI_BEGIN) and
+/// [`SIM_MARKER_ROI_END`](crate::core::arch::csr::SIM_MARKER_ROI_END) to the
+/// marker CSR (`roi_begin()`/`roi_end()` in `software/libc/bench.h`). Each
+/// hart acts on its own markers; with every option off they are ignored.
+#[derive(Debug, Clone, Default, Deserialize)]
+pub struct RoiConfig {
+    /// Report statistics counted from the ROI begin and frozen at its end
+    #[serde(default)]
+    pub stats: bool,
+
+    /// Run the ROI in the detailed pipeline and the rest in the functional engine
+    #[serde(default)]
+    pub detailed: bool,
+
+    /// Save a checkpoint to this path when the ROI begins in the functional engine
+    #[serde(default)]
+    pub checkpoint: Option<String>,
+}
+
+impl RoiConfig {
+    /// Returns true if any ROI option is set, so the markers need handling.
+    pub const fn is_enabled(&self) -> bool {
+        self.stats || self.detailed || self.checkpoint.is_some()
+    }
+}
+
 /// System memory map and bus configuration.
 ///
 /// Defines memory-mapped I/O base addresses, RAM configuration,
@@ -572,6 +782,14 @@ pub struct SystemConfig {
     #[serde(default = "SystemConfig::default_clint_divider")]
     pub clint_divider: u64,
 
+    /// Number of harts (1 = uniprocessor, up to `MAX_HARTS`)
+    #[serde(default = "SystemConfig::default_harts")]
+    pub harts: usize,
+
+    /// SMP synchronization quantum in cycles (harts run in parallel between barriers)
+    #[serde(default = "SystemConfig::default_smp_quantum")]
+    pub smp_quantum: u64,
+
     /// When true, UART output goes to stderr (for visibility when run from Python).
     #[serde(default)]
     pub uart_to_stderr: bool,
@@ -584,6 +802,23 @@ pub struct SystemConfig {
     /// registered at this address to intercept riscv-tests pass/fail writes.
     #[serde(default)]
     pub tohost_addr: u64,
+
+    /// When true, guest disk writes go through to the image file; otherwise the
+    /// file is mapped copy-on-write and never modified.
+    #[serde(default)]
+    pub disk_write_through: bool,
+
+    /// Fixed `VirtIO` disk service latency per request in cycles (0 = complete on notify).
+    #[serde(default)]
+    pub disk_latency: u64,
+
+    /// `VirtIO` disk transfer bandwidth in bytes per cycle (0 = unlimited).
+    #[serde(default)]
+    pub disk_bytes_per_cycle: u64,
+
+    /// Disk requests serviced concurrently.
+    #[serde(default = "SystemConfig::default_disk_queue_depth")]
+    pub disk_queue_depth: usize,
 }
 
 impl SystemConfig {
@@ -631,6 +866,21 @@ impl SystemConfig {
     const fn default_clint_divider() -> u64 {
         defaults::CLINT_DIVIDER
     }
+
+    /// Returns the default hart count.
+    const fn default_harts() -> usize {
+        defaults::HARTS
+    }
+
+    /// Returns the default SMP synchronization quantum.
+    const fn default_smp_quantum() -> u64 {
+        defaults::SMP_QUANTUM
+    }
+
+    /// Returns the default disk queue depth.
+    const fn default_disk_queue_depth() -> usize {
+        defaults::DISK_QUEUE_DEPTH
+    }
 }
 
 impl Default for SystemConfig {
@@ -649,9 +899,15 @@ impl Default for SystemConfig {
             bus_width: defaults::BUS_WIDTH,
             bus_latency: defaults::BUS_LATENCY,
             clint_divider: defaults::CLINT_DIVIDER,
+            harts: defaults::HARTS,
+            smp_quantum: defaults::SMP_QUANTUM,
             uart_to_stderr: false,
             uart_quiet: false,
             tohost_addr: 0,
+            disk_write_through: false,
+            disk_latency: 0,
+            disk_bytes_per_cycle: 0,
+            disk_queue_depth: defaults::DISK_QUEUE_DEPTH,
         }
     }
 }
@@ -706,6 +962,38 @@ pub struct MemoryConfig {
     #[serde(default = "MemoryConfig::default_t_rfc")]
     pub t_rfc: u64,
 
+    /// DRAM channels, interleaved per cache line (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_channels")]
+    pub channels: usize,
+
+    /// Ranks per channel (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_ranks")]
+    pub ranks: usize,
+
+    /// Read queue entries per channel (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_read_queue_size")]
+    pub read_queue_size: usize,
+
+    /// Write queue entries per channel (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_write_queue_size")]
+    pub write_queue_size: usize,
+
+    /// Write-queue occupancy that starts a write drain (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_write_high_watermark")]
+    pub write_high_watermark: usize,
+
+    /// Write-queue occupancy at which a drain stops (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_write_low_watermark")]
+    pub write_low_watermark: usize,
+
+    /// Data-bus cycles per 64-byte burst (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_t_burst")]
+    pub t_burst: u64,
+
+    /// Write-to-read bus turnaround in cycles (FR-FCFS controller)
+    #[serde(default = "MemoryConfig::default_t_wtr")]
+    pub t_wtr: u64,
+
     /// L1 TLB entry count
     #[serde(default = "MemoryConfig::default_tlb_size")]
     pub tlb_size: usize,
@@ -722,6 +1010,20 @@ pub struct MemoryConfig {
     #[serde(default = "MemoryConfig::default_l2_tlb_latency")]
     pub l2_tlb_latency: u64,
 
+    /// Fully-associative 2 MiB / 1 GiB entries in each L1 TLB (0 caches
+    /// superpages one 4 KiB page at a time)
+    #[serde(default = "MemoryConfig::default_tlb_superpage_entries")]
+    pub tlb_superpage_entries: usize,
+
+    /// Fully-associative 2 MiB / 1 GiB entries in the L2 TLB
+    #[serde(default = "MemoryConfig::default_l2_tlb_superpage_entries")]
+    pub l2_tlb_superpage_entries: usize,
+
+    /// Page-walk cache entries (non-leaf PTEs; 0 disables it, so every
+    /// walk starts at the root)
+    #[serde(default = "MemoryConfig::default_page_walk_cache_size")]
+    pub page_walk_cache_size: usize,
+
     /// Use software-managed A/D bits (fault on A=0 or D=0).
     /// When true, the PTW raises a page fault instead of auto-setting the
     /// Accessed/Dirty bits, matching spike's behavior and what Linux expects.
@@ -729,6 +1031,15 @@ pub struct MemoryConfig {
     #[serde(default = "MemoryConfig::default_software_ad_bits")]
     pub software_ad_bits: bool,
 
+    /// Host huge pages for the RAM buffer (Linux only)
+    #[serde(default)]
+    pub huge_pages: HugePages,
+
+    /// Allocate the RAM buffer on the NUMA node of the thread that builds the
+    /// system (Linux only)
+    #[serde(default)]
+    pub numa_local: bool,
+
     /// Trap on misaligned memory accesses instead of handling them natively.
     /// When true, misaligned loads/stores raise `LoadAddressMisaligned` /
     /// `StoreAddressMisaligned` exceptions (matching spike's default behavior).
@@ -789,6 +1100,46 @@ impl MemoryConfig {
         defaults::T_RFC
     }
 
+    /// Returns the default DRAM channel count.
+    const fn default_channels() -> usize {
+        defaults::CHANNELS
+    }
+
+    /// Returns the default rank count per channel.
+    const fn default_ranks() -> usize {
+        defaults::RANKS
+    }
+
+    /// Returns the default per-channel read queue size.
+    const fn default_read_queue_size() -> usize {
+        defaults::READ_QUEUE_SIZE
+    }
+
+    /// Returns the default per-channel write queue size.
+    const fn default_write_queue_size() -> usize {
+        defaults::WRITE_QUEUE_SIZE
+    }
+
+    /// Returns the default write-drain high watermark.
+    const fn default_write_high_watermark() -> usize {
+        defaults::WRITE_HIGH_WATERMARK
+    }
+
+    /// Returns the default write-drain low watermark.
+    const fn default_write_low_watermark() -> usize {
+        defaults::WRITE_LOW_WATERMARK
+    }
+
+    /// Returns the default burst length in cycles.
+    const fn default_t_burst() -> u64 {
+        defaults::T_BURST
+    }
+
+    /// Returns the default write-to-read turnaround in cycles.
+    const fn default_t_wtr() -> u64 {
+        defaults::T_WTR
+    }
+
     /// Returns the default TLB entry count.
     const fn default_tlb_size() -> usize {
         defaults::TLB_SIZE
@@ -809,6 +1160,21 @@ impl MemoryConfig {
         defaults::L2_TLB_LATENCY
     }
 
+    /// Returns the default L1 TLB superpage entry count.
+    const fn default_tlb_superpage_entries() -> usize {
+        defaults::TLB_SUPERPAGE_ENTRIES
+    }
+
+    /// Returns the default L2 TLB superpage entry count.
+    const fn default_l2_tlb_superpage_entries() -> usize {
+        defaults::L2_TLB_SUPERPAGE_ENTRIES
+    }
+
+    /// Returns the default page-walk cache entry count.
+    const fn default_page_walk_cache_size() -> usize {
+        defaults::PAGE_WALK_CACHE_SIZE
+    }
+
     /// Returns the default value for software-managed A/D bits.
     const fn default_software_ad_bits() -> bool {
         true
@@ -844,12 +1210,25 @@ impl Default for MemoryConfig {
             row_size_bytes: defaults::ROW_SIZE_BYTES,
             t_refi: defaults::T_REFI,
             t_rfc: defaults::T_RFC,
+            channels: defaults::CHANNELS,
+            ranks: defaults::RANKS,
+            read_queue_size: defaults::READ_QUEUE_SIZE,
+            write_queue_size: defaults::WRITE_QUEUE_SIZE,
+            write_high_watermark: defaults::WRITE_HIGH_WATERMARK,
+            write_low_watermark: defaults::WRITE_LOW_WATERMARK,
+            t_burst: defaults::T_BURST,
+            t_wtr: defaults::T_WTR,
             tlb_size: defaults::TLB_SIZE,
             l2_tlb_size: defaults::L2_TLB_SIZE,
             l2_tlb_ways: defaults::L2_TLB_WAYS,
             l2_tlb_latency: defaults::L2_TLB_LATENCY,
+            tlb_superpage_entries: defaults::TLB_SUPERPAGE_ENTRIES,
+            l2_tlb_superpage_entries: defaults::L2_TLB_SUPERPAGE_ENTRIES,
+            page_walk_cache_size: defaults::PAGE_WALK_CACHE_SIZE,
             software_ad_bits: true,
             misaligned_access_trap: true,
+            huge_pages: HugePages::Off,
+            numa_local: false,
         }
     }
 }
@@ -871,6 +1250,134 @@ pub struct CacheHierarchyConfig {
     /// Number of Write Combining Buffer entries (0 = disabled)
     #[serde(default)]
     pub wcb_entries: usize,
+    /// Coherence directory between the harts' private caches (multi-hart only)
+    #[serde(default)]
+    pub coherence: CoherenceConfig,
+    /// LRU stack-distance profiling of the L1-D access stream
+    #[serde(default)]
+    pub stack_distance: StackDistanceConfig,
+}
+
+/// Coherence protocol kept by the directory at the shared level.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default, Deserialize)]
+#[serde(rename_all = "UPPERCASE")]
+pub enum CoherenceProtocol {
+    /// MESI: a read of a line another hart owns downgrades the owner to
+    /// Shared (writing dirty data back to the shared level).
+    #[default]
+    #[serde(alias = "Mesi")]
+    Mesi,
+    /// MOESI: the owner of a dirty line keeps it in Owned and keeps
+    /// supplying readers cache-to-cache.
+    #[serde(alias = "Moesi")]
+    Moesi,
+}
+
+/// Coherence directory configuration.
+///
+/// Only used when `system.harts > 1`. L1-D and L2 are private per hart;
+/// the directory at the shared level tracks which harts hold each line.
+#[derive(Debug, Clone, Copy, Deserialize)]
+pub struct CoherenceConfig {
+    /// Protocol (MESI or MOESI)
+    #[serde(default)]
+    pub protocol: CoherenceProtocol,
+    /// Cycles for an S→M upgrade that invalidates no other copy
+    #[serde(default = "CoherenceConfig::default_upgrade_latency")]
+    pub upgrade_latency: u64,
+    /// Cycles to invalidate other harts' copies before a write
+    #[serde(default = "CoherenceConfig::default_invalidation_latency")]
+    pub invalidation_latency: u64,
+    /// Cycles for a cache-to-cache transfer from another hart
+    #[serde(default = "CoherenceConfig::default_transfer_latency")]
+    pub transfer_latency: u64,
+}
+
+impl CoherenceConfig {
+    /// Returns the default upgrade latency.
+    const fn default_upgrade_latency() -> u64 {
+        defaults::COHERENCE_UPGRADE_LATENCY
+    }
+
+    /// Returns the default invalidation latency.
+    const fn default_invalidation_latency() -> u64 {
+        defaults::COHERENCE_INVALIDATION_LATENCY
+    }
+
+    /// Returns the default cache-to-cache transfer latency.
+    const fn default_transfer_latency() -> u64 {
+        defaults::COHERENCE_TRANSFER_LATENCY
+    }
+}
+
+impl Default for CoherenceConfig {
+    fn default() -> Self {
+        Self {
+            protocol: CoherenceProtocol::default(),
+            upgrade_latency: defaults::COHERENCE_UPGRADE_LATENCY,
+            invalidation_latency: defaults::COHERENCE_INVALIDATION_LATENCY,
+            transfer_latency: defaults::COHERENCE_TRANSFER_LATENCY,
+        }
+    }
+}
+
+/// Stack-distance profiler configuration.
+///
+/// Profiles the data accesses presented to the L1-D (whether or not it is
+/// enabled) under LRU for every power-of-two set count up to `max_sets` and
+/// every associativity up to `max_ways`, giving a miss-ratio curve from one
+/// run (see [`crate::core::units::cache::stack_distance`]).
+#[derive(Debug, Clone, Copy, Deserialize)]
+pub struct StackDistanceConfig {
+    /// Enable the profiler
+    #[serde(default)]
+    pub enabled: bool,
+    /// Line size in bytes
+    #[serde(default = "StackDistanceConfig::default_line_bytes")]
+    pub line_bytes: usize,
+    /// Largest set count profiled
+    #[serde(default = "StackDistanceConfig::default_max_sets")]
+    pub max_sets: usize,
+    /// Largest associativity profiled
+    #[serde(default = "StackDistanceConfig::default_max_ways")]
+    pub max_ways: usize,
+    /// Sets tracked per set count; larger set counts are sampled
+    #[serde(default = "StackDistanceConfig::default_sampled_sets")]
+    pub sampled_sets: usize,
+}
+
+impl StackDistanceConfig {
+    /// Returns the default profiled line size in bytes.
+    const fn default_line_bytes() -> usize {
+        defaults::CACHE_LINE
+    }
+
+    /// Returns the default largest profiled set count.
+    const fn default_max_sets() -> usize {
+        defaults::STACK_DISTANCE_MAX_SETS
+    }
+
+    /// Returns the default largest profiled associativity.
+    const fn default_max_ways() -> usize {
+        defaults::STACK_DISTANCE_MAX_WAYS
+    }
+
+    /// Returns the default number of sets tracked per set count.
+    const fn default_sampled_sets() -> usize {
+        defaults::STACK_DISTANCE_SAMPLED_SETS
+    }
+}
+
+impl Default for StackDistanceConfig {
+    fn default() -> Self {
+        Self {
+            enabled: false,
+            line_bytes: defaults::CACHE_LINE,
+            max_sets: defaults::STACK_DISTANCE_MAX_SETS,
+            max_ways: defaults::STACK_DISTANCE_MAX_WAYS,
+            sampled_sets: defaults::STACK_DISTANCE_SAMPLED_SETS,
+        }
+    }
 }
 
 /// Individual cache level configuration.
@@ -1070,6 +1577,14 @@ pub struct PipelineConfig {
     /// Store-set predictor configuration
     #[serde(default)]
     pub store_set: StoreSetConfig,
+
+    /// Vector unit (RVV) configuration
+    #[serde(default)]
+    pub vector: VectorConfig,
+
+    /// Fetch target queue and fetch-directed prefetch configuration
+    #[serde(default)]
+    pub ftq: FtqConfig,
 }
 
 impl PipelineConfig {
@@ -1170,6 +1685,8 @@ impl Default for PipelineConfig {
             checkpoint_count: defaults::CHECKPOINT_COUNT,
             mem_dep_predictor: MemDepPredictor::default(),
             store_set: StoreSetConfig::default(),
+            vector: VectorConfig::default(),
+            ftq: FtqConfig::default(),
         }
     }
 }
@@ -1467,6 +1984,146 @@ impl TournamentConfig {
     }
 }
 
+/// Vector unit (RVV 1.0) configuration.
+///
+/// Vector instructions execute in program order when they commit; the vector
+/// unit models their latency with a queue of in-flight operations, per-lane
+/// throughput, and optional vector register renaming.
+#[derive(Debug, Clone, Deserialize)]
+pub struct VectorConfig {
+    /// Implement the V extension (sets `misa.V`; otherwise vector
+    /// instructions are illegal).
+    #[serde(default)]
+    pub enabled: bool,
+
+    /// Bits per vector register (VLEN): a power of two from 64 to 65536.
+    #[serde(default = "VectorConfig::default_vlen")]
+    pub vlen: usize,
+
+    /// Number of 64-bit datapath lanes; an instruction occupies its unit
+    /// for `ceil(vl·SEW / (64·lanes))` cycles.
+    #[serde(default = "VectorConfig::default_lanes")]
+    pub lanes: usize,
+
+    /// Integer ALU, permutation, and mask operation latency (cycles).
+    #[serde(default = "VectorConfig::default_alu_latency")]
+    pub alu_latency: u64,
+
+    /// Integer multiply and multiply-accumulate latency (cycles).
+    #[serde(default = "VectorConfig::default_mul_latency")]
+    pub mul_latency: u64,
+
+    /// Floating-point operation latency (cycles).
+    #[serde(default = "VectorConfig::default_fp_latency")]
+    pub fp_latency: u64,
+
+    /// Integer divide and floating-point divide/square-root latency (cycles).
+    #[serde(default = "VectorConfig::default_div_latency")]
+    pub div_latency: u64,
+
+    /// In-flight vector operations before commit stalls.
+    #[serde(default = "VectorConfig::default_queue_depth")]
+    pub queue_depth: usize,
+
+    /// Physical vector registers. Values above 32 rename architectural
+    /// registers and remove write-after-read/write-after-write stalls.
+    #[serde(default = "VectorConfig::default_phys_regs")]
+    pub phys_regs: usize,
+}
+
+impl Default for VectorConfig {
+    fn default() -> Self {
+        Self {
+            enabled: false,
+            vlen: Self::default_vlen(),
+            lanes: Self::default_lanes(),
+            alu_latency: Self::default_alu_latency(),
+            mul_latency: Self::default_mul_latency(),
+            fp_latency: Self::default_fp_latency(),
+            div_latency: Self::default_div_latency(),
+            queue_depth: Self::default_queue_depth(),
+            phys_regs: Self::default_phys_regs(),
+        }
+    }
+}
+
+impl VectorConfig {
+    /// Returns the default VLEN in bits.
+    const fn default_vlen() -> usize {
+        defaults::VECTOR_VLEN
+    }
+
+    /// Returns the default lane count.
+    const fn default_lanes() -> usize {
+        defaults::VECTOR_LANES
+    }
+
+    /// Returns the default integer ALU latency.
+    const fn default_alu_latency() -> u64 {
+        defaults::VECTOR_ALU_LATENCY
+    }
+
+    /// Returns the default integer multiply latency.
+    const fn default_mul_latency() -> u64 {
+        defaults::VECTOR_MUL_LATENCY
+    }
+
+    /// Returns the default floating-point latency.
+    const fn default_fp_latency() -> u64 {
+        defaults::VECTOR_FP_LATENCY
+    }
+
+    /// Returns the default divide latency.
+    const fn default_div_latency() -> u64 {
+        defaults::VECTOR_DIV_LATENCY
+    }
+
+    /// Returns the default queue depth.
+    const fn default_queue_depth() -> usize {
+        defaults::VECTOR_QUEUE_DEPTH
+    }
+
+    /// Returns the default physical register count.
+    const fn default_phys_regs() -> usize {
+        defaults::VECTOR_PHYS_REGS
+    }
+}
+
+/// Fetch target queue (FTQ) configuration.
+///
+/// A nonzero depth decouples branch prediction from the I-cache: the
+/// predictor runs ahead of fetch and queues predicted fetch blocks, and
+/// fetch-directed prefetching (FDIP) brings their lines into the L1I.
+#[derive(Debug, Clone, Deserialize)]
+pub struct FtqConfig {
+    /// Fetch blocks the predictor may run ahead of fetch (0 = coupled
+    /// frontend, prediction stalls with the I-cache).
+    #[serde(default = "FtqConfig::default_depth")]
+    pub depth: usize,
+
+    /// Prefetch the line of each queued fetch block into the L1I.
+    #[serde(default = "FtqConfig::default_fdip")]
+    pub fdip: bool,
+}
+
+impl Default for FtqConfig {
+    fn default() -> Self {
+        Self { depth: Self::default_depth(), fdip: Self::default_fdip() }
+    }
+}
+
+impl FtqConfig {
+    /// Returns the default FTQ depth.
+    const fn default_depth() -> usize {
+        defaults::FTQ_DEPTH
+    }
+
+    /// Returns the default FDIP setting (enabled whenever the FTQ is).
+    const fn default_fdip() -> bool {
+        true
+    }
+}
+
 /// Store-set memory dependence predictor configuration.
 #[derive(Debug, Clone, Deserialize)]
 pub struct StoreSetConfig {
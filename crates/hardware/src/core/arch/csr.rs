@@ -17,6 +17,27 @@ pub const FRM: CsrAddr = CsrAddr::from_u32(0x002);
 /// Floating-point control and status register CSR address.
 pub const FCSR: CsrAddr = CsrAddr::from_u32(0x003);
 
+/// Vector start element index CSR address.
+pub const VSTART: CsrAddr = CsrAddr::from_u32(0x008);
+
+/// Vector fixed-point saturation flag CSR address.
+pub const VXSAT: CsrAddr = CsrAddr::from_u32(0x009);
+
+/// Vector fixed-point rounding mode CSR address.
+pub const VXRM: CsrAddr = CsrAddr::from_u32(0x00A);
+
+/// Vector control and status register CSR address (`vxrm` and `vxsat`).
+pub const VCSR: CsrAddr = CsrAddr::from_u32(0x00F);
+
+/// Vector length CSR address (read-only).
+pub const VL: CsrAddr = CsrAddr::from_u32(0xC20);
+
+/// Vector data type CSR address (read-only).
+pub const VTYPE: CsrAddr = CsrAddr::from_u32(0xC21);
+
+/// Vector register length in bytes CSR address (read-only).
+pub const VLENB: CsrAddr = CsrAddr::from_u32(0xC22);
+
 /// Machine vendor ID CSR address.
 pub const MVENDORID: CsrAddr = CsrAddr::from_u32(0xF11);
 
@@ -185,6 +206,18 @@ pub const MIP_MEIP: u64 = 1 << 11;
 /// Simulation panic CSR address (custom, for debugging).
 pub const CSR_SIM_PANIC: CsrAddr = CsrAddr::from_u32(0x8FF);
 
+/// Simulation marker CSR address (custom, user-writable).
+///
+/// Guest code writes this CSR to signal the simulator (e.g. to end
+/// fast-forward); the written value is latched in `Cpu::sim_marker`.
+pub const CSR_SIM_MARKER: CsrAddr = CsrAddr::from_u32(0x8FE);
+
+/// Marker value that begins the guest's region of interest (see [`RoiConfig`](crate::config::RoiConfig)).
+pub const SIM_MARKER_ROI_BEGIN: u64 = 1;
+
+/// Marker value that ends the guest's region of interest (see [`RoiConfig`](crate::config::RoiConfig)).
+pub const SIM_MARKER_ROI_END: u64 = 2;
+
 /// Supervisor previous interrupt enable bit in `mstatus` register.
 pub const MSTATUS_SPIE: u64 = 1 << 5;
 
@@ -194,6 +227,15 @@ pub const MSTATUS_MPIE: u64 = 1 << 7;
 /// Supervisor previous privilege mode bit in `mstatus` register.
 pub const MSTATUS_SPP: u64 = 1 << 8;
 
+/// Vector state field mask in `mstatus` register.
+pub const MSTATUS_VS: u64 = 3 << 9;
+
+/// Vector state: initial (vector state is initial).
+pub const MSTATUS_VS_INIT: u64 = 1 << 9;
+
+/// Vector state: dirty (vector state has been modified).
+pub const MSTATUS_VS_DIRTY: u64 = 3 << 9;
+
 /// Machine previous privilege mode field mask in `mstatus` register.
 pub const MSTATUS_MPP: u64 = 3 << 11;
 
@@ -295,6 +337,9 @@ pub const MISA_EXT_S: u64 = 1 << 18;
 /// MISA extension bit for user mode (U extension).
 pub const MISA_EXT_U: u64 = 1 << 20;
 
+/// MISA extension bit for vector operations (V extension).
+pub const MISA_EXT_V: u64 = 1 << 21;
+
 /// MISA XLEN field value for 32-bit architecture.
 pub const MISA_XLEN_32: u64 = 1 << 62;
 
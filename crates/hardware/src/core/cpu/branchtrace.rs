@@ -0,0 +1,408 @@
+//! Retired branch trace capture.
+//!
+//! Records every retired control-transfer instruction so that
+//! [`crate::sim::replay::replay_branch_trace`] can score branch predictor
+//! configurations without simulating the program. It performs the following:
+//! 1. **Records:** PC, kind (conditional, jump, call, return, and their
+//!    indirect forms, classified by the RISC-V link-register hints), taken
+//!    target, and whether the instruction was compressed.
+//! 2. **Training:** [`BranchRecord::train`] is the functional-warming update
+//!    of the predictor, shared by the functional engine and the replay.
+//! 3. **Encoding:** One tag byte (kind in bits 0-2, taken in bit 3,
+//!    compressed in bit 4), a zigzag LEB128 delta of the PC from the
+//!    previous record's next PC, then for taken records a zigzag LEB128
+//!    delta of the target from the PC. Loops cost 2-3 bytes per branch.
+//!
+//! The file starts with an 8-byte magic and a little-endian `u32` version.
+
+use super::memtrace::{invalid, put_varint, read_varint, unzigzag, zigzag};
+use crate::core::units::bru::BranchPredictor;
+use crate::isa::abi;
+use crate::isa::instruction::InstructionBits;
+use crate::isa::rv64i::opcodes;
+use std::fs::File;
+use std::io::{self, BufReader, BufWriter, Read, Write};
+
+/// File magic identifying an rvsim branch trace.
+pub const MAGIC: [u8; 8] = *b"RVSIMBTR";
+
+/// Current trace format version.
+pub const VERSION: u32 = 1;
+
+/// Control-transfer class of a retired instruction.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+#[repr(u8)]
+pub enum BranchKind {
+    /// Conditional branch (`beq`, `bne`, ...).
+    Conditional = 0,
+    /// `jal` without a link register.
+    Jump = 1,
+    /// `jalr` that neither links nor returns.
+    IndirectJump = 2,
+    /// `jal` writing a link register.
+    Call = 3,
+    /// `jalr` writing a link register.
+    IndirectCall = 4,
+    /// `jalr` through a link register (pops the RAS).
+    Return = 5,
+    /// `jalr` through one link register writing the other (coroutine swap:
+    /// pops, then pushes the RAS).
+    CallReturn = 6,
+}
+
+impl BranchKind {
+    /// Classifies an (expanded) instruction, or `None` if it does not
+    /// transfer control.
+    ///
+    /// Per RISC-V spec Table 2.1, both `x1` and `x5` are link registers.
+    pub fn classify(inst: u32) -> Option<Self> {
+        let is_link = |reg| reg == abi::REG_RA || reg == abi::REG_T0;
+        let (rd, rs1) = (inst.rd(), inst.rs1());
+        Some(match inst.opcode() {
+            opcodes::OP_BRANCH => Self::Conditional,
+            opcodes::OP_JAL if is_link(rd) => Self::Call,
+            opcodes::OP_JAL => Self::Jump,
+            opcodes::OP_JALR => match (is_link(rd), is_link(rs1)) {
+                (true, true) if rd != rs1 => Self::CallReturn,
+                (true, _) => Self::IndirectCall,
+                (false, true) => Self::Return,
+                (false, false) => Self::IndirectJump,
+            },
+            _ => return None,
+        })
+    }
+
+    /// Returns `true` if the fetch stage predicts the target from the RAS.
+    pub const fn uses_ras(self) -> bool {
+        matches!(self, Self::Return | Self::CallReturn)
+    }
+
+    /// Decodes the kind bits of a tag byte.
+    const fn from_bits(bits: u8) -> Option<Self> {
+        Some(match bits {
+            0 => Self::Conditional,
+            1 => Self::Jump,
+            2 => Self::IndirectJump,
+            3 => Self::Call,
+            4 => Self::IndirectCall,
+            5 => Self::Return,
+            6 => Self::CallReturn,
+            _ => return None,
+        })
+    }
+}
+
+/// One retired control-transfer instruction.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct BranchRecord {
+    /// Control-transfer class.
+    pub kind: BranchKind,
+    /// PC of the instruction.
+    pub pc: u64,
+    /// Target if taken (always `Some` for jumps), `None` if it fell through.
+    pub target: Option<u64>,
+    /// Whether the instruction was 16 bits wide.
+    pub compressed: bool,
+}
+
+impl BranchRecord {
+    /// Address of the following instruction.
+    pub const fn fallthrough(&self) -> u64 {
+        self.pc.wrapping_add(if self.compressed { 2 } else { 4 })
+    }
+
+    /// PC the instruction transferred control to.
+    pub fn next_pc(&self) -> u64 {
+        self.target.unwrap_or_else(|| self.fallthrough())
+    }
+
+    /// Trains `bp` on this retired outcome, as functional warming does.
+    ///
+    /// For a conditional branch the history is advanced with the actual
+    /// direction (what the detailed pipeline reaches after any repair) and
+    /// the predictor is trained against the pre-branch history snapshot;
+    /// jumps train the BTB and RAS.
+    pub fn train(&self, bp: &mut impl BranchPredictor) {
+        let target = self.next_pc();
+        match self.kind {
+            BranchKind::Conditional => {
+                let taken = self.target.is_some();
+                let ghr = bp.snapshot_history();
+                bp.speculate(self.pc, taken);
+                bp.update_branch(self.pc, taken, self.target, &ghr);
+            }
+            BranchKind::Jump | BranchKind::IndirectJump => bp.update_btb(self.pc, target),
+            BranchKind::Call | BranchKind::IndirectCall => {
+                bp.on_call(self.pc, self.fallthrough(), target);
+            }
+            BranchKind::Return => {
+                bp.update_btb(self.pc, target);
+                bp.on_return();
+            }
+            BranchKind::CallReturn => {
+                bp.on_return();
+                bp.on_call(self.pc, self.fallthrough(), target);
+            }
+        }
+    }
+
+    /// Returns `true` if the fetch stage, with `bp`'s current state, would
+    /// have fetched the wrong next PC after this instruction.
+    pub fn mispredicted_by(&self, bp: &impl BranchPredictor) -> bool {
+        let predicted = match self.kind {
+            BranchKind::Conditional => match bp.predict_branch(self.pc) {
+                (true, Some(target)) => Some(target),
+                _ => None,
+            },
+            kind if kind.uses_ras() => bp.predict_return(),
+            _ => bp.predict_btb(self.pc),
+        };
+        predicted.unwrap_or_else(|| self.fallthrough()) != self.next_pc()
+    }
+}
+
+/// Tag bit marking a taken record (a target follows).
+const TAG_TAKEN: u8 = 0x08;
+/// Tag bit marking a compressed instruction.
+const TAG_COMPRESSED: u8 = 0x10;
+/// Mask of the kind field in the tag byte.
+const TAG_KIND_MASK: u8 = 0x07;
+
+/// Streaming trace encoder.
+#[derive(Debug)]
+pub struct BranchTraceWriter<W: Write = BufWriter<File>> {
+    out: W,
+    /// Path the trace is written to (empty for in-memory writers).
+    path: String,
+    /// Next PC of the previous record, which PC deltas are taken from.
+    prev_next_pc: u64,
+    records: u64,
+    /// First write error; recording stops once set.
+    error: Option<io::Error>,
+}
+
+impl BranchTraceWriter {
+    /// Creates the trace file at `path` and writes the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be created or written.
+    pub fn create(path: &str) -> io::Result<Self> {
+        let file = File::create(path)?;
+        let mut writer = Self::new(BufWriter::with_capacity(1 << 20, file))?;
+        path.clone_into(&mut writer.path);
+        Ok(writer)
+    }
+}
+
+impl<W: Write> BranchTraceWriter<W> {
+    /// Wraps `out` and writes the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the preamble cannot be written.
+    pub fn new(mut out: W) -> io::Result<Self> {
+        out.write_all(&MAGIC)?;
+        out.write_all(&VERSION.to_le_bytes())?;
+        Ok(Self { out, path: String::new(), prev_next_pc: 0, records: 0, error: None })
+    }
+
+    /// Path the trace is written to.
+    pub fn path(&self) -> &str {
+        &self.path
+    }
+
+    /// Records written so far.
+    pub const fn records(&self) -> u64 {
+        self.records
+    }
+
+    /// Appends one record.
+    pub fn record(&mut self, rec: &BranchRecord) {
+        if self.error.is_some() {
+            return;
+        }
+        let mut buf = [0u8; 1 + 2 * 10];
+        buf[0] = rec.kind as u8
+            | if rec.target.is_some() { TAG_TAKEN } else { 0 }
+            | if rec.compressed { TAG_COMPRESSED } else { 0 };
+        let mut len = 1;
+        len += put_varint(&mut buf[len..], zigzag(rec.pc.wrapping_sub(self.prev_next_pc)));
+        if let Some(target) = rec.target {
+            len += put_varint(&mut buf[len..], zigzag(target.wrapping_sub(rec.pc)));
+        }
+        self.prev_next_pc = rec.next_pc();
+        match self.out.write_all(&buf[..len]) {
+            Ok(()) => self.records += 1,
+            Err(e) => self.error = Some(e),
+        }
+    }
+
+    /// Flushes the trace and returns the underlying writer.
+    ///
+    /// # Errors
+    ///
+    /// Returns the first error hit while recording, or the flush error.
+    pub fn finish(mut self) -> io::Result<W> {
+        if let Some(e) = self.error.take() {
+            return Err(e);
+        }
+        self.out.flush()?;
+        Ok(self.out)
+    }
+}
+
+/// Streaming trace decoder.
+#[derive(Debug)]
+pub struct BranchTraceReader<R: Read = BufReader<File>> {
+    input: R,
+    prev_next_pc: u64,
+}
+
+impl BranchTraceReader {
+    /// Opens the trace file at `path` and checks its preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be read, or
+    /// [`io::ErrorKind::InvalidData`] if it is not a supported trace.
+    pub fn open(path: &str) -> io::Result<Self> {
+        Self::new(BufReader::with_capacity(1 << 20, File::open(path)?))
+    }
+}
+
+impl<R: Read> BranchTraceReader<R> {
+    /// Wraps `input` and checks the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the preamble cannot be read, or
+    /// [`io::ErrorKind::InvalidData`] if it is not a supported trace.
+    pub fn new(mut input: R) -> io::Result<Self> {
+        let mut preamble = [0u8; 12];
+        input.read_exact(&mut preamble)?;
+        if preamble[..8] != MAGIC {
+            return Err(invalid("not an rvsim branch trace"));
+        }
+        let version = u32::from_le_bytes([preamble[8], preamble[9], preamble[10], preamble[11]]);
+        if version != VERSION {
+            return Err(invalid("unsupported branch trace version"));
+        }
+        Ok(Self { input, prev_next_pc: 0 })
+    }
+
+    /// Decodes the next record, or `None` at the end of the trace.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error, or [`io::ErrorKind::InvalidData`] for a
+    /// malformed or truncated record.
+    pub fn next_record(&mut self) -> io::Result<Option<BranchRecord>> {
+        let mut tag = [0u8; 1];
+        if self.input.read(&mut tag)? == 0 {
+            return Ok(None);
+        }
+        let tag = tag[0];
+        let kind = BranchKind::from_bits(tag & TAG_KIND_MASK)
+            .ok_or_else(|| invalid("unknown branch trace record kind"))?;
+        let pc = self.prev_next_pc.wrapping_add(unzigzag(self.varint()?));
+        let target = if tag & TAG_TAKEN == 0 {
+            None
+        } else {
+            Some(pc.wrapping_add(unzigzag(self.varint()?)))
+        };
+        let rec = BranchRecord { kind, pc, target, compressed: tag & TAG_COMPRESSED != 0 };
+        self.prev_next_pc = rec.next_pc();
+        Ok(Some(rec))
+    }
+
+    /// Reads one LEB128 value of the current record.
+    fn varint(&mut self) -> io::Result<u64> {
+        read_varint(&mut self.input, "truncated branch trace record")
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    fn encode(records: &[BranchRecord]) -> Vec<u8> {
+        let mut writer = BranchTraceWriter::new(Vec::new()).unwrap();
+        for r in records {
+            writer.record(r);
+        }
+        assert_eq!(writer.records(), records.len() as u64);
+        writer.finish().unwrap()
+    }
+
+    fn decode(bytes: &[u8]) -> Vec<BranchRecord> {
+        let mut reader = BranchTraceReader::new(bytes).unwrap();
+        let mut out = Vec::new();
+        while let Some(r) = reader.next_record().unwrap() {
+            out.push(r);
+        }
+        out
+    }
+
+    #[test]
+    fn records_round_trip() {
+        let rec = |kind, pc, target, compressed| BranchRecord { kind, pc, target, compressed };
+        let records = [
+            rec(BranchKind::Call, 0x8000_0000, Some(0x8000_4000), false),
+            rec(BranchKind::Conditional, 0x8000_4010, None, true),
+            rec(BranchKind::Conditional, 0x8000_4020, Some(0x8000_4000), false),
+            rec(BranchKind::IndirectJump, 0x8000_4024, Some(u64::MAX - 1), false),
+            rec(BranchKind::Return, 0x10, Some(0x8000_0004), true),
+            rec(BranchKind::CallReturn, 0x8000_0004, Some(0x8000_0100), false),
+        ];
+        assert_eq!(decode(&encode(&records)), records);
+    }
+
+    #[test]
+    fn loop_branches_are_compact() {
+        let body = BranchRecord {
+            kind: BranchKind::Conditional,
+            pc: 0x8000_0100,
+            target: Some(0x8000_00f0),
+            compressed: false,
+        };
+        let bytes = encode(&vec![body; 1000]);
+        assert!(bytes.len() < 12 + 1000 * 3 + 8, "{} bytes", bytes.len());
+    }
+
+    #[test]
+    fn classifies_link_register_hints() {
+        // jal ra, 0; jal x0, 0; jalr x0, 0(ra); jalr ra, 0(a5); jalr t0, 0(ra); beq x0, x0, 0
+        let cases = [
+            (0x0000_00EF, Some(BranchKind::Call)),
+            (0x0000_006F, Some(BranchKind::Jump)),
+            (0x0000_8067, Some(BranchKind::Return)),
+            (0x0007_80E7, Some(BranchKind::IndirectCall)),
+            (0x0000_82E7, Some(BranchKind::CallReturn)),
+            (0x0007_8067, Some(BranchKind::IndirectJump)),
+            (0x0000_0063, Some(BranchKind::Conditional)),
+            (0x0000_0013, None),
+        ];
+        for (inst, kind) in cases {
+            assert_eq!(BranchKind::classify(inst), kind, "{inst:#010x}");
+        }
+    }
+
+    #[test]
+    fn rejects_foreign_and_truncated_files() {
+        let err = BranchTraceReader::new(&b"RVSIMMTR\x01\0\0\0"[..]).unwrap_err();
+        assert_eq!(err.kind(), io::ErrorKind::InvalidData);
+
+        let rec = BranchRecord {
+            kind: BranchKind::Jump,
+            pc: 0x8000_0000,
+            target: Some(0x8010_0000),
+            compressed: false,
+        };
+        let mut bytes = encode(&[rec]);
+        let _ = bytes.pop();
+        let mut reader = BranchTraceReader::new(bytes.as_slice()).unwrap();
+        assert_eq!(reader.next_record().unwrap_err().kind(), io::ErrorKind::InvalidData);
+    }
+}
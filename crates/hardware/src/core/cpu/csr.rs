@@ -28,16 +28,25 @@ impl Cpu {
             x if x == csr::FCSR.as_u32() => {
                 ((self.csrs.frm & 0x7) << 5) | (self.csrs.fflags & 0x1F)
             }
+            x if self.vector.enabled && x == csr::VSTART.as_u32() => self.vector.vstart,
+            x if self.vector.enabled && x == csr::VXSAT.as_u32() => self.vector.vxsat as u64,
+            x if self.vector.enabled && x == csr::VXRM.as_u32() => self.vector.vxrm as u64,
+            x if self.vector.enabled && x == csr::VCSR.as_u32() => self.vector.vcsr(),
+            x if self.vector.enabled && x == csr::VL.as_u32() => self.vector.vl,
+            x if self.vector.enabled && x == csr::VTYPE.as_u32() => self.vector.vtype.bits(),
+            x if self.vector.enabled && x == csr::VLENB.as_u32() => self.vector.vlenb() as u64,
             x if x == csr::MVENDORID.as_u32()
                 || x == csr::MARCHID.as_u32()
-                || x == csr::MIMPID.as_u32()
-                || x == csr::MHARTID.as_u32() =>
+                || x == csr::MIMPID.as_u32() =>
             {
                 0
             }
+            x if x == csr::MHARTID.as_u32() => self.hart_id as u64,
             x if x == csr::MSTATUS.as_u32() => {
                 let val = self.csrs.mstatus & !csr::MSTATUS_SD;
-                if val & csr::MSTATUS_FS == csr::MSTATUS_FS_DIRTY {
+                if val & csr::MSTATUS_FS == csr::MSTATUS_FS_DIRTY
+                    || val & csr::MSTATUS_VS == csr::MSTATUS_VS_DIRTY
+                {
                     val | csr::MSTATUS_SD
                 } else {
                     val
@@ -55,7 +64,9 @@ impl Cpu {
             x if x == csr::MIP.as_u32() => self.csrs.mip,
             x if x == csr::SSTATUS.as_u32() => {
                 let val = self.csrs.sstatus & !csr::MSTATUS_SD;
-                if val & csr::MSTATUS_FS == csr::MSTATUS_FS_DIRTY {
+                if val & csr::MSTATUS_FS == csr::MSTATUS_FS_DIRTY
+                    || val & csr::MSTATUS_VS == csr::MSTATUS_VS_DIRTY
+                {
                     val | csr::MSTATUS_SD
                 } else {
                     val
@@ -128,9 +139,27 @@ impl Cpu {
                 self.csrs.mstatus = (self.csrs.mstatus & !csr::MSTATUS_FS) | csr::MSTATUS_FS_DIRTY;
                 self.csrs.sstatus = (self.csrs.sstatus & !csr::MSTATUS_FS) | csr::MSTATUS_FS_DIRTY;
             }
+            x if self.vector.enabled && x == csr::VSTART.as_u32() => {
+                // vstart holds element indices below the largest VLMAX (VLEN).
+                self.vector.vstart = val & (self.vector.vlen() as u64 - 1);
+                self.mark_vs_dirty();
+            }
+            x if self.vector.enabled && x == csr::VXSAT.as_u32() => {
+                self.vector.vxsat = val & 1 != 0;
+                self.mark_vs_dirty();
+            }
+            x if self.vector.enabled && x == csr::VXRM.as_u32() => {
+                self.vector.vxrm = (val & 0x3) as u8;
+                self.mark_vs_dirty();
+            }
+            x if self.vector.enabled && x == csr::VCSR.as_u32() => {
+                self.vector.set_vcsr(val);
+                self.mark_vs_dirty();
+            }
             x if x == csr::CSR_SIM_PANIC.as_u32() => {
                 self.trap(&Trap::RequestedTrap(val), self.pc);
             }
+            x if x == csr::CSR_SIM_MARKER.as_u32() => self.sim_marker = Some(val),
             x if x == csr::MSTATUS.as_u32() => {
                 // WARL: only defined writable bits are accepted; WPRI/SD/UXL/SXL ignored.
                 const MSTATUS_WRITABLE: u64 = csr::MSTATUS_SIE
@@ -146,9 +175,12 @@ impl Cpu {
                     | csr::MSTATUS_TVM
                     | csr::MSTATUS_TW
                     | csr::MSTATUS_TSR;
+                // VS exists only with the V extension.
+                let vs = if self.vector.enabled { csr::MSTATUS_VS } else { 0 };
+                let writable = MSTATUS_WRITABLE | vs;
                 // UXL and SXL are hardwired to 2 (RV64)
                 let preserved = self.csrs.mstatus & (csr::MSTATUS_UXL | csr::MSTATUS_SXL);
-                self.csrs.mstatus = (val & MSTATUS_WRITABLE) | preserved;
+                self.csrs.mstatus = (val & writable) | preserved;
 
                 // WARL: MPP must encode a supported privilege mode (0=U, 1=S, 3=M).
                 // Value 2 is reserved; clamp to 0 (User) to prevent privilege escalation.
@@ -161,6 +193,7 @@ impl Cpu {
                     | csr::MSTATUS_SPIE
                     | csr::MSTATUS_SPP
                     | csr::MSTATUS_FS
+                    | vs
                     | csr::MSTATUS_SUM
                     | csr::MSTATUS_MXR
                     | csr::MSTATUS_UXL;
@@ -206,10 +239,12 @@ impl Cpu {
             }
             x if x == csr::SSTATUS.as_u32() => {
                 // UXL is read-only in sstatus (always reflects mstatus UXL)
+                let vs = if self.vector.enabled { csr::MSTATUS_VS } else { 0 };
                 let writable_mask = csr::MSTATUS_SIE
                     | csr::MSTATUS_SPIE
                     | csr::MSTATUS_SPP
                     | csr::MSTATUS_FS
+                    | vs
                     | csr::MSTATUS_SUM
                     | csr::MSTATUS_MXR;
                 let read_mask = writable_mask | csr::MSTATUS_UXL;
@@ -275,12 +310,9 @@ impl Cpu {
                 self.csrs.satp = new_val;
 
                 // Flush BOTH instruction and data caches
-                let _ = self.l1_i_cache.invalidate_all();
-                let _ = self.l1_d_cache.flush();
+                self.flush_l1_caches();
 
-                self.mmu.dtlb.flush();
-                self.mmu.itlb.flush();
-                self.mmu.l2_tlb.flush();
+                self.mmu.flush_all();
             }
             _ => {}
         }
@@ -330,4 +362,21 @@ mod tests {
         assert_eq!(cpu.csr_read(csr::FFLAGS), 0x1F);
         assert_eq!(cpu.csr_read(csr::FRM), 0x7);
     }
+
+    #[test]
+    fn test_cpu_csr_vector_state() {
+        let mut config = Config::default();
+        config.pipeline.vector.enabled = true;
+        let system = crate::soc::builder::System::new(&config, "");
+        let mut cpu = Cpu::new(system, &config);
+
+        assert_eq!(cpu.csr_read(csr::VLENB), 16);
+        assert_eq!(cpu.csr_read(csr::VTYPE), crate::isa::rvv::vtype::VILL);
+
+        cpu.csr_write(csr::VCSR, 0b101);
+        assert_eq!(cpu.csr_read(csr::VXRM), 0b10);
+        assert_eq!(cpu.csr_read(csr::VXSAT), 1);
+        assert_eq!(cpu.csr_read(csr::MSTATUS) & csr::MSTATUS_VS, csr::MSTATUS_VS_DIRTY);
+        assert_ne!(cpu.csr_read(csr::SSTATUS) & csr::MSTATUS_SD, 0);
+    }
 }
@@ -0,0 +1,605 @@
+//! Translated-Block Tier.
+//!
+//! A second tier for the functional engine that runs hot guest basic blocks
+//! from a cache of pre-decoded operations instead of fetching, translating,
+//! and decoding every instruction again. It performs the following:
+//! 1. **Translation:** A physical PC entered [`HOT_THRESHOLD`] times becomes a
+//!    block that runs up to the first branch or jump (inclusive), system or
+//!    CSR instruction (exclusive), undecodable instruction, or page
+//!    boundary. Each instruction is decoded once into a [`BlockOp`] carrying
+//!    a handler picked at translation time (threaded code).
+//! 2. **Lookup:** Blocks are keyed by physical PC. Entering one still performs
+//!    the fetch translation through [`Cpu::translate`] and the TLBs, so
+//!    remappings and fetch faults behave as in the interpreter; the rest of
+//!    the block lies in the same page and shares that translation. Loads and
+//!    stores take the interpreter's path (translation, A/D updates, devices).
+//! 3. **Invalidation:** `fence.i` and `sfence.vma` flush every block, and a
+//!    store into a 64-byte granule holding translated code drops the blocks
+//!    overlapping it, ending the running block if it was one of them (data
+//!    elsewhere in a code page does not count). Device DMA is not
+//!    tracked; as the ISA requires, software makes it visible to instruction
+//!    fetch with `fence.i`.
+//!
+//! Every instruction still costs one simulated cycle with a full
+//! [`Cpu::pre_tick`]/[`Cpu::post_tick`] around it, and the tier hands back to
+//! [`Cpu::step_functional`] as soon as an enabled interrupt is pending, so
+//! architectural state, device time, and the retire counters match the
+//! interpreter cycle for cycle. Only the I-TLB counters differ: one fetch
+//! translation is done per block rather than per instruction.
+
+use super::Cpu;
+use super::functional::{INSTRUCTION_NOP, Retired};
+use crate::common::constants::{
+    COMPRESSED_INSTRUCTION_MASK, COMPRESSED_INSTRUCTION_VALUE, PAGE_OFFSET_MASK,
+};
+use crate::common::{AccessType, InstSize, PhysAddr, SimError, Trap};
+use crate::core::arch::csr;
+use crate::core::pipeline::backend::inorder::execute::compute_alu;
+use crate::core::pipeline::frontend::decode::decode_instruction;
+use crate::core::pipeline::signals::{
+    ControlFlow, ControlSignals, CsrOp, OpASrc, OpBSrc, SystemOp, VectorOp,
+};
+use crate::isa::decode::decode as instruction_decode;
+use crate::isa::instruction::Decoded;
+use crate::isa::rvc::expand::expand;
+use std::collections::HashMap;
+use std::hash::{BuildHasherDefault, Hasher};
+use std::sync::Arc;
+
+/// Maximum number of instructions in one translated block.
+pub const BLOCK_MAX_OPS: usize = 64;
+
+/// Entries into an untranslated block head before it is translated.
+pub const HOT_THRESHOLD: u16 = 8;
+
+/// Entries of the direct-mapped block-head heat table (power of two).
+const HEAT_ENTRIES: usize = 4096;
+
+/// Log2 of the granule in which stores are checked against translated code.
+const CODE_GRANULE_SHIFT: u64 = 6;
+
+/// Tag of an empty heat-table entry (block heads are always halfword-aligned).
+const INVALID_PC: u64 = u64::MAX;
+
+/// Executes one pre-decoded operation at virtual `pc`.
+type OpFn = fn(&mut Cpu, &BlockOp, u64) -> Result<Retired, Trap>;
+
+/// One pre-decoded instruction of a translated block.
+#[derive(Clone, Copy, Debug)]
+pub struct BlockOp {
+    /// Handler specialized for the instruction class.
+    handler: OpFn,
+    /// Instruction bits (expanded if compressed).
+    inst: u32,
+    /// Encoded size, for the fall-through PC.
+    size: InstSize,
+    /// Decoded operand fields.
+    decoded: Decoded,
+    /// Decoded control signals.
+    ctrl: ControlSignals,
+}
+
+impl BlockOp {
+    /// Decodes `inst`, or returns `None` if it must run in the interpreter.
+    fn translate(inst: u32, size: InstSize) -> Option<Self> {
+        if inst == INSTRUCTION_NOP {
+            return Some(Self {
+                handler: exec_nop,
+                inst,
+                size,
+                decoded: Decoded::default(),
+                ctrl: ControlSignals::default(),
+            });
+        }
+        let decoded = instruction_decode(inst);
+        // The PC only feeds the `ebreak` trap, which is never translated.
+        let ctrl = decode_instruction(inst, 0, &decoded).ok()?;
+        if !matches!(ctrl.system_op, SystemOp::None | SystemOp::Fence) || ctrl.csr_op != CsrOp::None
+        {
+            return None;
+        }
+        let int_alu = !ctrl.mem_read
+            && !ctrl.mem_write
+            && ctrl.control_flow == ControlFlow::Sequential
+            && ctrl.system_op == SystemOp::None
+            && ctrl.vector == VectorOp::None
+            && !(ctrl.fp_reg_write || ctrl.rs1_fp || ctrl.rs2_fp || ctrl.rs3_fp);
+        let handler: OpFn = if int_alu { exec_int_alu } else { exec_decoded };
+        Some(Self { handler, inst, size, decoded, ctrl })
+    }
+}
+
+/// A translated basic block.
+#[derive(Debug)]
+pub struct Block {
+    /// Physical address of the first instruction.
+    paddr: u64,
+    /// Operations in program order (empty when the head is not translatable).
+    ops: Box<[BlockOp]>,
+    /// Whether any operation is a compressed instruction.
+    compressed: bool,
+}
+
+/// Hasher for physical PCs and granule indices (Fibonacci hashing; not DoS-resistant).
+#[derive(Clone, Copy, Debug, Default)]
+struct PcHasher(u64);
+
+impl Hasher for PcHasher {
+    fn finish(&self) -> u64 {
+        let h = self.0.wrapping_mul(0x9E37_79B9_7F4A_7C15);
+        h ^ (h >> 32)
+    }
+
+    fn write(&mut self, bytes: &[u8]) {
+        for &b in bytes {
+            self.0 = self.0.rotate_left(8) ^ u64::from(b);
+        }
+    }
+
+    fn write_u64(&mut self, n: u64) {
+        self.0 ^= n;
+    }
+}
+
+/// Map keyed by physical PC or code granule index.
+type PcMap<V> = HashMap<u64, V, BuildHasherDefault<PcHasher>>;
+
+/// Cache of translated blocks for one hart (host-side; no timing effect).
+#[derive(Debug)]
+pub struct BlockCache {
+    /// Whether the tier runs at all (`fast_forward.dbt`).
+    enabled: bool,
+    /// Translated blocks by physical start PC.
+    blocks: PcMap<Arc<Block>>,
+    /// Start PCs of the blocks overlapping each code granule (index relative to `ram_start`).
+    granule_blocks: PcMap<Vec<u64>>,
+    /// Direct-mapped entry counts of untranslated block heads: `(paddr, count)`.
+    heat: Box<[(u64, u16)]>,
+    /// Bitmap of code granules holding translated code.
+    code_granules: Vec<u64>,
+    /// Physical address where RAM starts.
+    ram_start: u64,
+    /// Bumped whenever blocks are dropped, so a running block notices.
+    generation: u64,
+    /// Blocks translated so far.
+    translated: u64,
+}
+
+impl BlockCache {
+    /// Creates an empty cache for RAM at `ram_start..ram_end`; a disabled
+    /// cache allocates nothing.
+    pub fn new(enabled: bool, ram_start: u64, ram_end: u64) -> Self {
+        let granules = if enabled {
+            (ram_end.saturating_sub(ram_start) >> CODE_GRANULE_SHIFT) as usize + 1
+        } else {
+            0
+        };
+        let heat = if enabled { HEAT_ENTRIES } else { 0 };
+        Self {
+            enabled,
+            blocks: PcMap::default(),
+            granule_blocks: PcMap::default(),
+            heat: vec![(INVALID_PC, 0); heat].into_boxed_slice(),
+            code_granules: vec![0; granules.div_ceil(64)],
+            ram_start,
+            generation: 0,
+            translated: 0,
+        }
+    }
+
+    /// Returns `true` if the tier is enabled.
+    pub const fn is_enabled(&self) -> bool {
+        self.enabled
+    }
+
+    /// Number of blocks translated since the cache was created.
+    pub const fn translated(&self) -> u64 {
+        self.translated
+    }
+
+    /// Number of blocks currently cached.
+    pub fn block_count(&self) -> usize {
+        self.blocks.len()
+    }
+
+    /// Counts an entry into the untranslated head at `paddr`; returns `true`
+    /// once it is hot.
+    fn heat_up(&mut self, paddr: u64) -> bool {
+        let entry = &mut self.heat[((paddr >> 1) as usize) & (HEAT_ENTRIES - 1)];
+        if entry.0 != paddr {
+            *entry = (paddr, 0);
+        }
+        entry.1 += 1;
+        entry.1 >= HOT_THRESHOLD
+    }
+
+    /// Caches `block` and marks the granules it covers as holding code.
+    fn insert(&mut self, block: Block) -> Arc<Block> {
+        let len: u64 = block.ops.iter().map(|op| op.size.as_u64()).sum();
+        let first = (block.paddr - self.ram_start) >> CODE_GRANULE_SHIFT;
+        let last = (block.paddr + len.max(1) - 1 - self.ram_start) >> CODE_GRANULE_SHIFT;
+        for granule in first..=last {
+            self.code_granules[(granule / 64) as usize] |= 1 << (granule % 64);
+            let starts = self.granule_blocks.entry(granule).or_default();
+            if !starts.contains(&block.paddr) {
+                starts.push(block.paddr);
+            }
+        }
+        self.translated += 1;
+        let block = Arc::new(block);
+        let _ = self.blocks.insert(block.paddr, Arc::clone(&block));
+        block
+    }
+
+    /// Drops the blocks overlapping a `bytes`-byte RAM store at `paddr`.
+    #[inline]
+    pub fn note_store(&mut self, paddr: u64, bytes: u64) {
+        if self.code_granules.is_empty() || paddr < self.ram_start {
+            return;
+        }
+        let first = (paddr - self.ram_start) >> CODE_GRANULE_SHIFT;
+        let last = (paddr + bytes.max(1) - 1 - self.ram_start) >> CODE_GRANULE_SHIFT;
+        for granule in first..=last {
+            let word = (granule / 64) as usize;
+            let bit = 1 << (granule % 64);
+            if self.code_granules.get(word).is_some_and(|w| w & bit != 0) {
+                self.code_granules[word] &= !bit;
+                for pc in self.granule_blocks.remove(&granule).unwrap_or_default() {
+                    let _ = self.blocks.remove(&pc);
+                }
+                self.generation += 1;
+            }
+        }
+    }
+
+    /// Drops every translated block.
+    pub fn flush(&mut self) {
+        if self.blocks.is_empty() {
+            return;
+        }
+        self.blocks.clear();
+        self.granule_blocks.clear();
+        self.code_granules.fill(0);
+        self.generation += 1;
+    }
+}
+
+/// Bounds on a [`Cpu::run_blocks`] call besides its cycle budget.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct BlockLimits {
+    /// Stop before executing the instruction at this PC.
+    pub stop_pc: Option<u64>,
+    /// Stop once `stats.instructions_retired` reaches this count.
+    pub max_instructions: Option<u64>,
+}
+
+impl BlockLimits {
+    /// Returns `true` if the next instruction must not run from a block.
+    fn reached(&self, cpu: &Cpu) -> bool {
+        self.stop_pc == Some(cpu.pc)
+            || self.max_instructions.is_some_and(|n| cpu.stats.instructions_retired >= n)
+    }
+}
+
+impl Cpu {
+    /// Runs translated blocks for up to `max` cycles and returns the cycles run.
+    ///
+    /// Each cycle is a complete tick ([`Self::pre_tick`], one instruction,
+    /// [`Self::post_tick`]), chained from block to block. Returns as soon as
+    /// the interpreter is needed again: at a cold or untranslatable PC, a
+    /// system instruction, a pending enabled interrupt, WFI, a `limits`
+    /// bound, or an exit. Returns 0 when the tier is disabled or tracing is on.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::KernelPanic`] from [`Self::pre_tick`].
+    pub fn run_blocks(&mut self, max: u64, limits: BlockLimits) -> Result<u64, SimError> {
+        let mut ran = 0;
+        while ran < max && self.blocks_runnable(&limits) {
+            let Some(block) = self.enter_block() else {
+                break;
+            };
+            let cycles = self.exec_block(&block, max - ran, &limits)?;
+            if cycles == 0 {
+                break;
+            }
+            ran += cycles;
+        }
+        Ok(ran)
+    }
+
+    /// Returns `true` if the next instruction may run from a translated block.
+    fn blocks_runnable(&self, limits: &BlockLimits) -> bool {
+        #[cfg(feature = "commit-log")]
+        if self.commit_log.is_some() {
+            return false;
+        }
+        self.blocks.is_enabled()
+            && !self.trace
+            && !self.wfi_waiting
+            && self.exit_code.is_none()
+            && (self.csrs.mip & self.csrs.mie) == 0
+            && !limits.reached(self)
+    }
+
+    /// Translates the fetch PC and returns its block, translating it once hot.
+    fn enter_block(&mut self) -> Option<Arc<Block>> {
+        let pc = self.pc;
+        // With RVC disabled, the interpreter traps on 2-byte-aligned PCs.
+        let rvc = (self.csrs.misa & csr::MISA_EXT_C) != 0;
+        if (pc & if rvc { 1 } else { 3 }) != 0 {
+            return None;
+        }
+        let paddr = self.translate_functional(pc, AccessType::Fetch, 4).ok()?.val();
+        if paddr < self.ram_start || paddr >= self.ram_end {
+            return None;
+        }
+        let block = if let Some(block) = self.blocks.blocks.get(&paddr) {
+            Arc::clone(block)
+        } else if self.blocks.heat_up(paddr) {
+            let block = self.translate_block(paddr);
+            self.blocks.insert(block)
+        } else {
+            return None;
+        };
+        // Blocks are shared across MISA writes; leave compressed code to the
+        // interpreter while RVC is disabled.
+        (!block.ops.is_empty() && (rvc || !block.compressed)).then_some(block)
+    }
+
+    /// Decodes the block starting at RAM address `paddr`.
+    fn translate_block(&mut self, paddr: u64) -> Block {
+        let end = ((paddr | PAGE_OFFSET_MASK) + 1).min(self.ram_end);
+        let mut ops = Vec::new();
+        let mut addr = paddr;
+        while ops.len() < BLOCK_MAX_OPS && addr + 2 <= end {
+            let low = self.read_phys_u16(PhysAddr::new(addr));
+            let (inst, size) =
+                if (low & COMPRESSED_INSTRUCTION_MASK) != COMPRESSED_INSTRUCTION_VALUE {
+                    (expand(low), InstSize::Compressed)
+                } else if addr + 4 <= end {
+                    let high = self.read_phys_u16(PhysAddr::new(addr + 2));
+                    (u32::from(high) << 16 | u32::from(low), InstSize::Standard)
+                } else {
+                    break;
+                };
+            let Some(op) = (inst != 0).then(|| BlockOp::translate(inst, size)).flatten() else {
+                break;
+            };
+            ops.push(op);
+            addr += size.as_u64();
+            if op.ctrl.control_flow != ControlFlow::Sequential {
+                break;
+            }
+        }
+        let compressed = ops.iter().any(|op| op.size == InstSize::Compressed);
+        Block { paddr, ops: ops.into_boxed_slice(), compressed }
+    }
+
+    /// Runs `block` from its first instruction for at most `max` cycles.
+    fn exec_block(
+        &mut self,
+        block: &Block,
+        max: u64,
+        limits: &BlockLimits,
+    ) -> Result<u64, SimError> {
+        let generation = self.blocks.generation;
+        let mut ran = 0;
+        let mut quiet = 0;
+        let mut paddr = block.paddr;
+        for op in &block.ops {
+            if ran == max || (ran > 0 && limits.reached(self)) {
+                break;
+            }
+            let prev_priv = self.privilege;
+            ran += 1;
+            if quiet > 0 && self.quiet_tick() {
+                quiet -= 1;
+            } else {
+                if self.pre_tick()? {
+                    self.post_tick(prev_priv);
+                    break;
+                }
+                quiet = self.quiet_cycles();
+            }
+            if (self.csrs.mip & self.csrs.mie) != 0 {
+                // The interpreter decides whether the interrupt is taken.
+                self.step_functional();
+                self.post_tick(prev_priv);
+                break;
+            }
+
+            if self.functional_warming {
+                self.warm_fetch(PhysAddr::new(paddr));
+                if op.size == InstSize::Standard {
+                    self.warm_fetch(PhysAddr::new(paddr + 2));
+                }
+            }
+            paddr += op.size.as_u64();
+
+            let pc = self.pc;
+            match (op.handler)(self, op, pc) {
+                Ok(retired) => {
+                    self.retire_functional(pc, op.inst, &retired);
+                    self.pc = retired.next_pc;
+                    self.committed_next_pc = self.pc;
+                }
+                Err(trap) => {
+                    self.trap(&trap, pc);
+                    self.committed_next_pc = self.pc;
+                    self.post_tick(prev_priv);
+                    break;
+                }
+            }
+            self.post_tick(prev_priv);
+            if op.ctrl.mem_read
+                || op.ctrl.mem_write
+                || matches!(op.ctrl.vector, VectorOp::Load | VectorOp::Store)
+            {
+                // An MMIO access makes the bus re-evaluate its devices.
+                quiet = quiet.min(self.quiet_cycles());
+            }
+            if self.blocks.generation != generation {
+                break;
+            }
+        }
+        Ok(ran)
+    }
+}
+
+/// Canonical NOP: retires without counting, like the interpreter.
+#[allow(clippy::unnecessary_wraps)] // Signature fixed by `OpFn`.
+const fn exec_nop(_cpu: &mut Cpu, op: &BlockOp, pc: u64) -> Result<Retired, Trap> {
+    Ok(Retired { ctrl: op.ctrl, rd_write: None, next_pc: pc.wrapping_add(op.size.as_u64()) })
+}
+
+/// Integer ALU instruction with no memory, control-flow, or FP side effects.
+#[allow(clippy::unnecessary_wraps)] // Signature fixed by `OpFn`.
+fn exec_int_alu(cpu: &mut Cpu, op: &BlockOp, pc: u64) -> Result<Retired, Trap> {
+    let (d, ctrl) = (&op.decoded, &op.ctrl);
+    let op_a = match ctrl.a_src {
+        OpASrc::Reg1 => cpu.regs.read(d.rs1),
+        OpASrc::Pc => pc,
+        OpASrc::Zero => 0,
+    };
+    let op_b = match ctrl.b_src {
+        OpBSrc::Reg2 => cpu.regs.read(d.rs2),
+        OpBSrc::Imm => d.imm as u64,
+        OpBSrc::Zero => 0,
+    };
+    let (result, fp_flags) = compute_alu(ctrl.alu, op_a, op_b, 0, ctrl.is_rv32);
+    let rd_write = if ctrl.reg_write && !d.rd.is_zero() {
+        cpu.regs.write(d.rd, result);
+        Some((d.rd, result))
+    } else {
+        None
+    };
+    if fp_flags != 0 {
+        cpu.csrs.fflags |= fp_flags as u64;
+        cpu.mark_fs_dirty();
+    }
+    Ok(Retired { ctrl: op.ctrl, rd_write, next_pc: pc.wrapping_add(op.size.as_u64()) })
+}
+
+/// Any other translated instruction, through the interpreter's execute path.
+fn exec_decoded(cpu: &mut Cpu, op: &BlockOp, pc: u64) -> Result<Retired, Trap> {
+    let next_pc = pc.wrapping_add(op.size.as_u64());
+    cpu.execute_decoded(pc, op.inst, next_pc, &op.decoded, &op.ctrl)
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used, unused_results)]
+mod tests {
+    use super::*;
+    use crate::common::RegIdx;
+    use crate::config::Config;
+    use crate::soc::builder::System;
+
+    /// `addi x1, x1, 1`
+    const ADDI: u32 = 0x0010_8093;
+    /// `beq x0, x0, 0`
+    const BEQ_SELF: u32 = 0x0000_0063;
+    /// `csrrs x2, mstatus, x0`
+    const CSRR: u32 = 0x3000_2173;
+
+    fn cpu_with_program(program: &[u32]) -> Cpu {
+        let mut config = Config::default();
+        config.general.fast_forward.enabled = true;
+        config.general.fast_forward.dbt = true;
+        let mut cpu = Cpu::new(System::new(&config, ""), &config);
+        let base = cpu.pc;
+        for (i, inst) in program.iter().enumerate() {
+            cpu.bus.bus.write_u32(PhysAddr::new(base + (i as u64) * 4), *inst);
+        }
+        cpu
+    }
+
+    #[test]
+    fn test_block_ends_after_branch_and_before_system_op() {
+        let mut cpu = cpu_with_program(&[ADDI, ADDI, BEQ_SELF, ADDI, CSRR]);
+        let base = cpu.pc;
+        let block = cpu.translate_block(base);
+        assert_eq!(block.ops.len(), 3, "branch ends the block");
+        assert_eq!(cpu.translate_block(base + 12).ops.len(), 1, "CSR access is left out");
+        assert!(cpu.translate_block(base + 16).ops.is_empty());
+    }
+
+    #[test]
+    fn test_block_stops_at_page_boundary() {
+        let mut cpu = cpu_with_program(&[]);
+        let last = (cpu.pc | PAGE_OFFSET_MASK) - 3;
+        cpu.bus.bus.write_u32(PhysAddr::new(last), ADDI);
+        cpu.bus.bus.write_u32(PhysAddr::new(last + 4), ADDI);
+        assert_eq!(cpu.translate_block(last).ops.len(), 1);
+    }
+
+    #[test]
+    fn test_head_is_translated_once_hot() {
+        let mut cpu = cpu_with_program(&[ADDI, BEQ_SELF]);
+        for _ in 1..HOT_THRESHOLD {
+            assert!(cpu.enter_block().is_none());
+        }
+        assert_eq!(cpu.enter_block().unwrap().ops.len(), 2);
+        assert_eq!(cpu.blocks.translated(), 1);
+        assert!(cpu.enter_block().is_some());
+        assert_eq!(cpu.blocks.translated(), 1, "later entries hit the cache");
+    }
+
+    #[test]
+    fn test_blocks_run_with_rvc_disabled() {
+        let mut cpu = cpu_with_program(&[ADDI, ADDI, BEQ_SELF]);
+        cpu.csrs.misa &= !csr::MISA_EXT_C;
+        let base = cpu.pc;
+        for _ in 1..HOT_THRESHOLD {
+            assert!(cpu.enter_block().is_none());
+        }
+        assert_eq!(cpu.run_blocks(3, BlockLimits::default()).unwrap(), 3);
+        assert_eq!(cpu.regs.read(RegIdx::new(1)), 2);
+
+        // A 2-byte-aligned PC traps in the interpreter.
+        cpu.pc = base + 2;
+        assert!(cpu.enter_block().is_none());
+
+        // `c.addi x1, 1` is left to the interpreter while RVC is disabled.
+        // followed by `beq x0, x0, 0` at +0x42
+        cpu.bus.bus.write_u32(PhysAddr::new(base + 0x40), 0x0063_0085);
+        let block = cpu.translate_block(base + 0x40);
+        cpu.blocks.insert(block);
+        cpu.pc = base + 0x40;
+        assert!(cpu.enter_block().is_none());
+        cpu.csrs.misa |= csr::MISA_EXT_C;
+        assert_eq!(cpu.enter_block().unwrap().ops.len(), 2);
+    }
+
+    #[test]
+    fn test_code_store_drops_only_overlapping_blocks() {
+        let mut cpu = cpu_with_program(&[ADDI, BEQ_SELF]);
+        let base = cpu.pc;
+        // A block straddling the granules at +0x40 and +0x80.
+        let other = base + 0x7C;
+        cpu.bus.bus.write_u32(PhysAddr::new(other), ADDI);
+        cpu.bus.bus.write_u32(PhysAddr::new(other + 4), BEQ_SELF);
+        let a = cpu.translate_block(base);
+        cpu.blocks.insert(a);
+        let b = cpu.translate_block(other);
+        cpu.blocks.insert(b);
+
+        cpu.blocks.note_store(base + 0x100, 8);
+        assert_eq!(cpu.blocks.block_count(), 2, "data stores elsewhere are ignored");
+        cpu.blocks.note_store(base + 0x80, 4);
+        assert_eq!(cpu.blocks.block_count(), 1);
+        assert!(cpu.blocks.blocks.contains_key(&base));
+
+        cpu.blocks.flush();
+        assert_eq!(cpu.blocks.block_count(), 0);
+    }
+
+    #[test]
+    fn test_disabled_cache_runs_nothing() {
+        let config = Config::default();
+        let mut cpu = Cpu::new(System::new(&config, ""), &config);
+        assert!(!cpu.blocks.is_enabled());
+        assert_eq!(cpu.run_blocks(100, BlockLimits::default()).unwrap(), 0);
+        cpu.blocks.note_store(cpu.pc, 4);
+    }
+}
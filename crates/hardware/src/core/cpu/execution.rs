@@ -15,6 +15,7 @@ use crate::common::{Asid, SimError, Vpn};
 use crate::core::arch::csr;
 use crate::core::arch::mode::PrivilegeMode;
 use crate::isa::abi;
+use crate::stats::{Stage, StageTimer};
 use crate::trace_trap;
 
 impl Cpu {
@@ -39,6 +40,8 @@ impl Cpu {
             }
         }
 
+        self.drain_coherence_probes();
+
         if self.pc == self.last_pc {
             self.same_pc_count += 1;
             if self.same_pc_count == HANG_DETECTION_THRESHOLD {
@@ -83,7 +86,9 @@ impl Cpu {
             self.same_pc_count = 0;
         }
 
+        let timer = StageTimer::start();
         let (timer_irq, msip, meip, seip) = self.bus.tick();
+        timer.stop(&mut self.stats.stage_times, Stage::Bus);
 
         let mut mip = self.csrs.mip;
 
@@ -162,6 +167,87 @@ impl Cpu {
         }
     }
 
+    /// Number of upcoming cycles that are pure WFI idle time.
+    ///
+    /// While the hart waits in WFI with no enabled interrupt pending, each
+    /// [`Self::pre_tick`] only advances the clocks until some device deadline
+    /// (CLINT `mtimecmp`, the UART stdin poll) or the Sstc `stimecmp` compare
+    /// is due. This returns how many such cycles lie ahead, so they can be
+    /// accounted in one [`Self::advance_idle`] call instead. Returns 0 when
+    /// the hart is busy, tracing, or exiting; the pipeline's own idleness is
+    /// checked by the caller.
+    pub fn idle_cycles(&self) -> u64 {
+        if !self.wfi_waiting
+            || (self.csrs.mip & self.csrs.mie) != 0
+            || self.redirect_pending
+            || self.trace
+            || self.exit_code.is_some()
+            || self.bus.check_exit().is_some()
+            || self.pc != self.last_pc
+        {
+            return 0;
+        }
+        self.quiet_cycles()
+    }
+
+    /// Number of upcoming cycles whose [`Self::pre_tick`] only advances the clocks.
+    ///
+    /// No device event or Sstc compare is due, no kernel-panic countdown is
+    /// running, and no coherence probes can arrive, so `mip` cannot change
+    /// and each such pre-tick is a [`Self::quiet_tick`]. An MMIO access ends
+    /// the window early (the bus re-evaluates its devices).
+    pub fn quiet_cycles(&self) -> u64 {
+        if self.panic_detected_at_cycle.is_some() || self.coherence.is_some() {
+            return 0;
+        }
+        let mut cycles = self.bus.quiet_cycles();
+        if (self.csrs.menvcfg & csr::MENVCFG_STCE) != 0 {
+            let deadline = self.csrs.stimecmp.saturating_mul(self.clint_divider);
+            if self.stats.cycles < deadline {
+                cycles = cycles.min(deadline - self.stats.cycles);
+            }
+        }
+        cycles
+    }
+
+    /// Runs [`Self::pre_tick`] for a cycle known to be quiet (see [`Self::quiet_cycles`]).
+    ///
+    /// Only the clocks and the hang detector advance. Returns `false`
+    /// without doing anything when the hang detector is about to fire; the
+    /// caller then runs the full [`Self::pre_tick`].
+    #[inline]
+    pub fn quiet_tick(&mut self) -> bool {
+        if self.pc == self.last_pc {
+            if self.same_pc_count + 1 == HANG_DETECTION_THRESHOLD {
+                return false;
+            }
+            self.same_pc_count += 1;
+        } else {
+            self.last_pc = self.pc;
+            self.same_pc_count = 0;
+        }
+        self.bus.advance_quiet(1);
+        self.stats.cycles += 1;
+        self.track_mode_cycles();
+        true
+    }
+
+    /// Accounts `cycles` WFI idle cycles (at most [`Self::idle_cycles`]) in one step.
+    ///
+    /// Produces the same counters, device time, and `mtime` as ticking
+    /// through them; the detailed engine's retire histogram is left to the caller.
+    pub fn advance_idle(&mut self, cycles: u64) {
+        self.bus.advance_quiet(cycles);
+        self.same_pc_count = self.same_pc_count.saturating_add(cycles);
+        self.stats.cycles += cycles;
+        self.stats.cycles_wfi += cycles;
+        match self.privilege {
+            PrivilegeMode::User => self.stats.cycles_user += cycles,
+            PrivilegeMode::Supervisor => self.stats.cycles_kernel += cycles,
+            PrivilegeMode::Machine => self.stats.cycles_machine += cycles,
+        }
+    }
+
     /// Tracks cycles spent in each privilege mode for statistics.
     const fn track_mode_cycles(&mut self) {
         match self.privilege {
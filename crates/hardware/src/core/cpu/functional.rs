@@ -0,0 +1,906 @@
+//! Functional (Atomic) Execution.
+//!
+//! This module implements an instruction-at-a-time execution model that works
+//! directly on the architectural state held in `Cpu`. It performs the following:
+//! 1. **Fetch/Decode:** Translates the PC, reads (and expands) the instruction, and
+//!    decodes it with the same decoder the pipeline frontend uses.
+//! 2. **Execute:** Reuses the pipeline's ALU/FPU and atomic units; loads and stores
+//!    go straight to RAM or the bus with no store buffer, cache, or predictor.
+//! 3. **Retire:** Applies register, CSR, and privilege updates immediately, and takes
+//!    traps and interrupts precisely at instruction boundaries.
+//!
+//! The `Simulator` uses this engine to fast-forward through uninteresting code
+//! (firmware, kernel boot, workload initialization) before handing the same
+//! architectural state to the detailed pipeline. With functional warming
+//! enabled, fetches and data accesses also update the cache hierarchy and
+//! retired branches train the branch predictor, so the detailed window
+//! starts warm.
+
+use super::branchtrace::{BranchKind, BranchRecord};
+use super::{Cpu, PC_TRACE_MAX};
+use crate::common::constants::{
+    COMPRESSED_INSTRUCTION_MASK, COMPRESSED_INSTRUCTION_VALUE, OPCODE_MASK, PAGE_OFFSET_MASK,
+    PAGE_SIZE,
+};
+use crate::common::{
+    AccessType, InstSize, PhysAddr, RegIdx, SfenceVmaInfo, TranslationResult, Trap, VirtAddr,
+};
+use crate::core::arch::csr;
+use crate::core::arch::mode::PrivilegeMode;
+use crate::core::pipeline::backend::inorder::execute::compute_alu;
+use crate::core::pipeline::backend::shared::commit::{
+    check_interrupts, sfence_vma_commit, update_instruction_stats, write_store_to_memory,
+};
+use crate::core::pipeline::signals::{
+    AtomicOp, ControlFlow, ControlSignals, CsrOp, MemWidth, OpASrc, OpBSrc, SystemOp, VectorOp,
+};
+use crate::core::units::lsu::{Lsu, unaligned};
+use crate::isa::instruction::{Decoded, InstructionBits};
+use crate::isa::privileged::opcodes as sys_ops;
+use crate::isa::rv64i::{funct3, opcodes};
+use crate::isa::rvc::expand::expand;
+use crate::{trace_commit, trace_trap};
+
+/// ADDI x0, x0, 0 instruction encoding (canonical NOP).
+pub(super) const INSTRUCTION_NOP: u32 = 0x0000_0013;
+
+const FUNCT3_SHIFT: u32 = 12;
+const FUNCT3_MASK: u32 = 0x7;
+const JALR_ALIGNMENT_MASK: u64 = !1;
+
+/// Upper 32 bits set for NaN-boxing single-precision values in 64-bit FP registers.
+const NAN_BOX_MASK: u64 = 0xFFFF_FFFF_0000_0000;
+
+/// Bit positions of `mstatus` trap-virtualization controls.
+const MSTATUS_TVM_SHIFT: u32 = 20;
+const MSTATUS_TW_SHIFT: u32 = 21;
+const MSTATUS_TSR_SHIFT: u32 = 22;
+
+/// Result of functionally executing a single instruction.
+pub(super) struct Retired {
+    /// Decoded control signals (default for a skipped NOP).
+    pub(super) ctrl: ControlSignals,
+    /// Destination register and value written (integer or FP), if any.
+    pub(super) rd_write: Option<(RegIdx, u64)>,
+    /// Architectural PC of the next instruction.
+    pub(super) next_pc: u64,
+}
+
+impl Cpu {
+    /// Executes one instruction functionally against the architectural state.
+    ///
+    /// Interrupts are checked first, exactly as the commit stage does, and a
+    /// pending WFI either wakes or idles for this step. Otherwise the
+    /// instruction at `pc` is fetched, decoded, executed, and retired in a
+    /// single call; synchronous exceptions are delivered through
+    /// [`Cpu::trap`]. No timing (MSHRs, DRAM, store buffer) is modeled, so
+    /// each step costs one simulated cycle; caches and the branch predictor
+    /// are only touched when `functional_warming` is set.
+    pub fn step_functional(&mut self) {
+        let epc = if self.wfi_waiting { self.wfi_pc } else { self.pc };
+        if let Some(interrupt) = check_interrupts(self) {
+            self.wfi_waiting = false;
+            trace_trap!(self.trace;
+                event      = "interrupt",
+                epc        = %crate::trace::Hex(epc),
+                cause      = ?interrupt,
+                mip        = %crate::trace::Hex(self.csrs.mip),
+                mie        = %crate::trace::Hex(self.csrs.mie),
+                priv_mode  = ?self.privilege,
+                "FN: interrupt taken"
+            );
+            self.trap(&interrupt, epc);
+            self.committed_next_pc = self.pc;
+            return;
+        }
+
+        if self.wfi_waiting {
+            if (self.csrs.mip & self.csrs.mie) == 0 {
+                self.stats.cycles_wfi += 1;
+                return;
+            }
+            // Non-trap wakeup (interrupt pending but not taken): resume after WFI.
+            self.wfi_waiting = false;
+            self.pc = self.wfi_pc;
+        }
+
+        let pc = self.pc;
+        let result = match self.fetch_functional(pc) {
+            Ok((inst, inst_size)) => {
+                let result = self.execute_functional(pc, inst, inst_size);
+                if let Ok(ref retired) = result {
+                    self.retire_functional(pc, inst, retired);
+                }
+                // Spike-compatible commit log. Fetch faults have no valid
+                // instruction bits and are not logged (matching the commit stage).
+                #[cfg(feature = "commit-log")]
+                if inst != INSTRUCTION_NOP
+                    && let Some(ref mut log) = self.commit_log
+                {
+                    use std::io::Write;
+                    let rd_write = result.as_ref().ok().and_then(|r| r.rd_write);
+                    let _ = if let Some((rd, val)) = rd_write {
+                        let rd = rd.as_usize();
+                        writeln!(log, "core   0: 0x{pc:016x} (0x{inst:08x}) x{rd} 0x{val:016x}")
+                    } else {
+                        writeln!(log, "core   0: 0x{pc:016x} (0x{inst:08x})")
+                    };
+                }
+                result
+            }
+            Err(trap) => Err(trap),
+        };
+
+        match result {
+            Ok(retired) => self.pc = retired.next_pc,
+            Err(trap) => {
+                trace_trap!(self.trace;
+                    event     = "sync-exception",
+                    pc        = %crate::trace::Hex(pc),
+                    cause     = ?trap,
+                    priv_mode = ?self.privilege,
+                    "FN: synchronous exception"
+                );
+                self.trap(&trap, pc);
+            }
+        }
+        self.committed_next_pc = self.pc;
+    }
+
+    /// Fetches the instruction at `pc`, expanding compressed encodings.
+    fn fetch_functional(&mut self, pc: u64) -> Result<(u32, InstSize), Trap> {
+        // When MISA[C]=0, compressed instructions are disabled; require 4-byte alignment.
+        let align_mask: u64 = if (self.csrs.misa & csr::MISA_EXT_C) != 0 { 1 } else { 3 };
+        if (pc & align_mask) != 0 {
+            return Err(Trap::InstructionAddressMisaligned(pc));
+        }
+
+        let lower = self.translate_functional(pc, AccessType::Fetch, 4)?;
+        if self.functional_warming {
+            self.warm_fetch(lower);
+        }
+        let half_word = self.read_phys_u16(lower);
+
+        if (half_word & COMPRESSED_INSTRUCTION_MASK) != COMPRESSED_INSTRUCTION_VALUE {
+            let expanded = expand(half_word);
+            if expanded == 0 {
+                return Err(Trap::IllegalInstruction(half_word as u32));
+            }
+            return Ok((expanded, InstSize::Compressed));
+        }
+
+        let upper_va = pc.wrapping_add(2);
+        let upper = if (pc >> 12) == (upper_va >> 12) {
+            PhysAddr::new(lower.val() + 2)
+        } else {
+            self.translate_functional(upper_va, AccessType::Fetch, 2)?
+        };
+        if self.functional_warming {
+            self.warm_fetch(upper);
+        }
+        let upper_half = self.read_phys_u16(upper);
+        Ok(((upper_half as u32) << 16 | (half_word as u32), InstSize::Standard))
+    }
+
+    /// Translates `vaddr`, applying any A/D-bit update immediately.
+    ///
+    /// The detailed pipeline defers PTE updates to commit; in the functional
+    /// model every access is non-speculative, so they are written at once.
+    pub(super) fn translate_functional(
+        &mut self,
+        vaddr: u64,
+        access: AccessType,
+        size: u64,
+    ) -> Result<PhysAddr, Trap> {
+        let TranslationResult { paddr, trap, pte_update, .. } =
+            self.translate(VirtAddr::new(vaddr), access, size);
+        if let Some(trap) = trap {
+            return Err(trap);
+        }
+        if let Some(upd) = pte_update {
+            write_store_to_memory(self, upd.pte_addr, upd.pte_value, MemWidth::Double);
+        }
+        Ok(paddr)
+    }
+
+    /// Reads a half-word from physical memory (RAM fast-path or bus).
+    pub(super) fn read_phys_u16(&mut self, paddr: PhysAddr) -> u16 {
+        if let Some(offset) = self.ram_offset(paddr.val(), 2) {
+            // SAFETY: `ram_offset` checked that both bytes lie in RAM.
+            unsafe { (self.ram_ptr.add(offset) as *const u16).read_unaligned() }
+        } else {
+            self.bus.bus.read_u16(paddr)
+        }
+    }
+
+    /// Reads a load value from physical memory with sign extension.
+    ///
+    /// An access that runs past the end of RAM takes the bus path.
+    pub(super) fn read_phys_load(&mut self, paddr: PhysAddr, width: MemWidth, signed: bool) -> u64 {
+        if let Some(offset) = self.ram_offset(paddr.val(), unaligned::width_to_bytes(width)) {
+            let ptr = self.ram_ptr;
+            // SAFETY: `ram_offset` checked that every byte lies in RAM.
+            unsafe {
+                match (width, signed) {
+                    (MemWidth::Byte, true) => (*ptr.add(offset) as i8) as i64 as u64,
+                    (MemWidth::Half, true) => {
+                        ((ptr.add(offset) as *const u16).read_unaligned() as i16) as i64 as u64
+                    }
+                    (MemWidth::Word, true) => {
+                        ((ptr.add(offset) as *const u32).read_unaligned() as i32) as i64 as u64
+                    }
+                    (MemWidth::Byte, false) => *ptr.add(offset) as u64,
+                    (MemWidth::Half, false) => {
+                        (ptr.add(offset) as *const u16).read_unaligned() as u64
+                    }
+                    (MemWidth::Word, false) => {
+                        (ptr.add(offset) as *const u32).read_unaligned() as u64
+                    }
+                    (MemWidth::Double, _) => (ptr.add(offset) as *const u64).read_unaligned(),
+                    (MemWidth::Nop, _) => 0,
+                }
+            }
+        } else {
+            match (width, signed) {
+                (MemWidth::Byte, true) => (self.bus.bus.read_u8(paddr) as i8) as i64 as u64,
+                (MemWidth::Half, true) => (self.bus.bus.read_u16(paddr) as i16) as i64 as u64,
+                (MemWidth::Word, true) => (self.bus.bus.read_u32(paddr) as i32) as i64 as u64,
+                (MemWidth::Byte, false) => self.bus.bus.read_u8(paddr) as u64,
+                (MemWidth::Half, false) => self.bus.bus.read_u16(paddr) as u64,
+                (MemWidth::Word, false) => self.bus.bus.read_u32(paddr) as u64,
+                (MemWidth::Double, _) => self.bus.bus.read_u64(paddr),
+                (MemWidth::Nop, _) => 0,
+            }
+        }
+    }
+
+    /// Decodes and executes one instruction, updating architectural state.
+    ///
+    /// Returns the value written to `rd` and the next PC, or the synchronous
+    /// exception raised by the instruction (no state is modified in that case).
+    fn execute_functional(
+        &mut self,
+        pc: u64,
+        inst: u32,
+        inst_size: InstSize,
+    ) -> Result<Retired, Trap> {
+        let next_pc = pc.wrapping_add(inst_size.as_u64());
+        if inst == INSTRUCTION_NOP {
+            return Ok(Retired { ctrl: ControlSignals::default(), rd_write: None, next_pc });
+        }
+
+        let (d, ctrl) = self.decode_cache.decode(pc, inst)?;
+        self.execute_decoded(pc, inst, next_pc, &d, &ctrl)
+    }
+
+    /// Executes an already-decoded instruction; see [`Self::execute_functional`].
+    ///
+    /// Shared with the translated-block tier, which decodes once per block.
+    pub(super) fn execute_decoded(
+        &mut self,
+        pc: u64,
+        inst: u32,
+        next_pc: u64,
+        d: &Decoded,
+        ctrl: &ControlSignals,
+    ) -> Result<Retired, Trap> {
+        let rv1 = if ctrl.rs1_fp { self.regs.read_f(d.rs1) } else { self.regs.read(d.rs1) };
+        let rv2 = if ctrl.rs2_fp { self.regs.read_f(d.rs2) } else { self.regs.read(d.rs2) };
+        let rv3 = if ctrl.rs3_fp { self.regs.read_f(inst.rs3()) } else { 0 };
+
+        if !matches!(ctrl.system_op, SystemOp::None | SystemOp::Fence)
+            && let Some(retired) =
+                self.execute_system_functional(inst, next_pc, d, ctrl, rv1, rv2)?
+        {
+            return Ok(retired);
+        }
+
+        // When mstatus.FS == OFF, all FP instructions trap as illegal.
+        let fs = (self.csrs.mstatus & csr::MSTATUS_FS) >> 13;
+        if fs == 0 && (ctrl.fp_reg_write || ctrl.rs1_fp || ctrl.rs2_fp || ctrl.rs3_fp) {
+            return Err(Trap::IllegalInstruction(inst));
+        }
+
+        if ctrl.vector != VectorOp::None {
+            let rd_write = match self.execute_vector(pc, inst, ctrl.vector, false)? {
+                Some(val) if ctrl.fp_reg_write => {
+                    self.regs.write_f(d.rd, val);
+                    self.mark_fs_dirty();
+                    Some((d.rd, val))
+                }
+                Some(val) if ctrl.reg_write && !d.rd.is_zero() => {
+                    self.regs.write(d.rd, val);
+                    Some((d.rd, val))
+                }
+                _ => None,
+            };
+            return Ok(Retired { ctrl: *ctrl, rd_write, next_pc });
+        }
+
+        let op_a = match ctrl.a_src {
+            OpASrc::Reg1 => rv1,
+            OpASrc::Pc => pc,
+            OpASrc::Zero => 0,
+        };
+        let op_b = match ctrl.b_src {
+            OpBSrc::Reg2 => rv2,
+            OpBSrc::Imm => d.imm as u64,
+            OpBSrc::Zero => 0,
+        };
+        let (alu_out, fp_flags) = compute_alu(ctrl.alu, op_a, op_b, rv3, ctrl.is_rv32);
+
+        let mut target = next_pc;
+        let mut result = alu_out;
+        match ctrl.control_flow {
+            ControlFlow::Branch => {
+                let taken = match (inst >> FUNCT3_SHIFT) & FUNCT3_MASK {
+                    funct3::BEQ => op_a == op_b,
+                    funct3::BNE => op_a != op_b,
+                    funct3::BLT => (op_a as i64) < (op_b as i64),
+                    funct3::BGE => (op_a as i64) >= (op_b as i64),
+                    funct3::BLTU => op_a < op_b,
+                    funct3::BGEU => op_a >= op_b,
+                    _ => false,
+                };
+                if taken {
+                    target = pc.wrapping_add(d.imm as u64);
+                }
+                self.retire_control_transfer(pc, inst, next_pc, taken.then_some(target));
+            }
+            ControlFlow::Jump => {
+                let is_jalr = (inst & OPCODE_MASK) == opcodes::OP_JALR;
+                target = if is_jalr {
+                    rv1.wrapping_add(d.imm as u64) & JALR_ALIGNMENT_MASK
+                } else {
+                    pc.wrapping_add(d.imm as u64)
+                };
+                result = next_pc;
+                self.retire_control_transfer(pc, inst, next_pc, Some(target));
+            }
+            ControlFlow::Sequential => {}
+        }
+
+        if ctrl.mem_read || ctrl.mem_write {
+            result = self.access_memory_functional(ctrl, alu_out, rv2)?;
+        }
+
+        let rd_write = if ctrl.fp_reg_write {
+            self.regs.write_f(d.rd, result);
+            self.mark_fs_dirty();
+            Some((d.rd, result))
+        } else if ctrl.reg_write && !d.rd.is_zero() {
+            self.regs.write(d.rd, result);
+            Some((d.rd, result))
+        } else {
+            None
+        };
+
+        if fp_flags != 0 {
+            self.csrs.fflags |= fp_flags as u64;
+            self.mark_fs_dirty();
+        }
+
+        if ctrl.system_op == SystemOp::FenceI {
+            self.invalidate_l1i();
+            self.warm_fetch_line = None;
+            self.blocks.flush();
+        }
+
+        Ok(Retired { ctrl: *ctrl, rd_write, next_pc: target })
+    }
+
+    /// Executes a privileged/system instruction (MRET, SRET, WFI, SFENCE.VMA,
+    /// FENCE.I, ECALL, CSR access).
+    ///
+    /// Applies the same privilege and trap-virtualization checks as the
+    /// detailed execute stages. Returns `Ok(None)` when the instruction is not
+    /// fully handled here and should continue down the regular ALU path.
+    fn execute_system_functional(
+        &mut self,
+        inst: u32,
+        next_pc: u64,
+        d: &Decoded,
+        ctrl: &ControlSignals,
+        rv1: u64,
+        rv2: u64,
+    ) -> Result<Option<Retired>, Trap> {
+        let mstatus = self.csrs.mstatus;
+        let tvm = (mstatus >> MSTATUS_TVM_SHIFT) & 1 != 0;
+        let tw = (mstatus >> MSTATUS_TW_SHIFT) & 1 != 0;
+        let tsr = (mstatus >> MSTATUS_TSR_SHIFT) & 1 != 0;
+        let illegal = Trap::IllegalInstruction(inst);
+
+        match ctrl.system_op {
+            SystemOp::Mret => {
+                if self.privilege != PrivilegeMode::Machine {
+                    return Err(illegal);
+                }
+                self.do_mret();
+                Ok(Some(Retired { ctrl: *ctrl, rd_write: None, next_pc: self.pc }))
+            }
+            SystemOp::Sret => {
+                if self.privilege == PrivilegeMode::User
+                    || (self.privilege == PrivilegeMode::Supervisor && tsr)
+                {
+                    return Err(illegal);
+                }
+                self.do_sret();
+                Ok(Some(Retired { ctrl: *ctrl, rd_write: None, next_pc: self.pc }))
+            }
+            SystemOp::Wfi => {
+                if self.privilege == PrivilegeMode::User
+                    || (self.privilege == PrivilegeMode::Supervisor && tw)
+                {
+                    return Err(illegal);
+                }
+                // With nothing enabled or pending, WFI is a NOP (avoids deadlock
+                // in early firmware); otherwise idle until an interrupt arrives.
+                if self.csrs.mie != 0 || self.csrs.mip != 0 {
+                    self.wfi_waiting = true;
+                    self.wfi_pc = next_pc;
+                }
+                Ok(Some(Retired { ctrl: *ctrl, rd_write: None, next_pc }))
+            }
+            SystemOp::SfenceVma => {
+                if self.privilege == PrivilegeMode::Supervisor && tvm {
+                    return Err(illegal);
+                }
+                sfence_vma_commit(
+                    self,
+                    &SfenceVmaInfo { rs1_idx: d.rs1, rs2_idx: d.rs2, rs1_val: rv1, rs2_val: rv2 },
+                );
+                self.clear_reservation();
+                self.blocks.flush();
+                Ok(Some(Retired { ctrl: *ctrl, rd_write: None, next_pc }))
+            }
+            _ if inst == sys_ops::ECALL => Err(match self.privilege {
+                PrivilegeMode::User => Trap::EnvironmentCallFromUMode,
+                PrivilegeMode::Supervisor => Trap::EnvironmentCallFromSMode,
+                PrivilegeMode::Machine => Trap::EnvironmentCallFromMMode,
+            }),
+            _ if ctrl.csr_op != CsrOp::None => {
+                self.execute_csr_functional(inst, d, ctrl, rv1).map(|old| {
+                    let rd_write = if ctrl.reg_write && !d.rd.is_zero() {
+                        self.regs.write(d.rd, old);
+                        Some((d.rd, old))
+                    } else {
+                        None
+                    };
+                    Some(Retired { ctrl: *ctrl, rd_write, next_pc })
+                })
+            }
+            _ => Ok(None),
+        }
+    }
+
+    /// Performs a CSR read-modify-write and returns the old CSR value.
+    fn execute_csr_functional(
+        &mut self,
+        inst: u32,
+        d: &Decoded,
+        ctrl: &ControlSignals,
+        rv1: u64,
+    ) -> Result<u64, Trap> {
+        let illegal = Trap::IllegalInstruction(inst);
+        let addr = ctrl.csr_addr;
+
+        // In S-mode, SATP access is illegal if mstatus.TVM=1.
+        if addr == csr::SATP
+            && self.privilege == PrivilegeMode::Supervisor
+            && ((self.csrs.mstatus >> MSTATUS_TVM_SHIFT) & 1) != 0
+        {
+            return Err(illegal);
+        }
+
+        // Counter-enable check for CYCLE/TIME/INSTRET.
+        let counter_bit = if addr == csr::CYCLE {
+            Some(0)
+        } else if addr == csr::TIME {
+            Some(1)
+        } else if addr == csr::INSTRET {
+            Some(2)
+        } else {
+            None
+        };
+        if let Some(bit) = counter_bit {
+            let mask = 1u64 << bit;
+            let denied = match self.privilege {
+                PrivilegeMode::Supervisor => (self.csrs.mcounteren & mask) == 0,
+                PrivilegeMode::User => {
+                    (self.csrs.mcounteren & mask) == 0 || (self.csrs.scounteren & mask) == 0
+                }
+                PrivilegeMode::Machine => false,
+            };
+            if denied {
+                return Err(illegal);
+            }
+        }
+
+        // Privilege check: CSR bits [9:8] encode minimum privilege level.
+        if (self.privilege.to_u8() as u32) < addr.privilege_level() as u32 {
+            return Err(illegal);
+        }
+
+        // CSRRS/CSRRC with rs1=x0 and CSRRSI/CSRRCI with uimm=0 are pure reads
+        // and must not trigger write side effects (spec §2.8).
+        let would_write = match ctrl.csr_op {
+            CsrOp::Rw | CsrOp::Rwi => true,
+            CsrOp::Rs | CsrOp::Rc => !d.rs1.is_zero(),
+            CsrOp::Rsi | CsrOp::Rci => (d.rs1.as_u8() & 0x1f) != 0,
+            CsrOp::None => false,
+        };
+        if would_write && addr.is_read_only() {
+            return Err(illegal);
+        }
+
+        let old = self.csr_read(addr);
+        if would_write {
+            let src = match ctrl.csr_op {
+                CsrOp::Rwi | CsrOp::Rsi | CsrOp::Rci => d.rs1.as_usize() as u64 & 0x1f,
+                _ => rv1,
+            };
+            let new = match ctrl.csr_op {
+                CsrOp::Rw | CsrOp::Rwi => src,
+                CsrOp::Rs | CsrOp::Rsi => old | src,
+                CsrOp::Rc | CsrOp::Rci => old & !src,
+                CsrOp::None => old,
+            };
+            self.csr_write(addr, new);
+        }
+        Ok(old)
+    }
+
+    /// Performs a load, store, or atomic access and returns the value for `rd`.
+    fn access_memory_functional(
+        &mut self,
+        ctrl: &ControlSignals,
+        vaddr: u64,
+        store_data: u64,
+    ) -> Result<u64, Trap> {
+        // RISC-V spec Section 8.4: atomic operations (LR/SC/AMO) ALWAYS
+        // require natural alignment.
+        let size = unaligned::width_to_bytes(ctrl.width);
+        let is_atomic = ctrl.atomic_op != AtomicOp::None;
+        if !unaligned::is_aligned(vaddr, size) && (self.misaligned_access_trap || is_atomic) {
+            return Err(if ctrl.mem_write {
+                unaligned::store_misaligned_trap(vaddr)
+            } else {
+                unaligned::load_misaligned_trap(vaddr)
+            });
+        }
+
+        let access = if ctrl.mem_write { AccessType::Write } else { AccessType::Read };
+        let paddr = self.translate_functional(vaddr, access, size)?;
+        self.check_phys_access(vaddr, paddr, access)?;
+
+        // A misaligned access that runs into the next page translates that
+        // page on its own, as a fetch straddling a page does. If the two pages
+        // are not physically contiguous, the access is split into bytes.
+        let first = PAGE_SIZE - (vaddr & PAGE_OFFSET_MASK);
+        let mut split = None;
+        if first < size {
+            let upper_va = vaddr.wrapping_add(first);
+            let upper = self.translate_functional(upper_va, access, size - first)?;
+            if upper.val() != paddr.val().wrapping_add(first) {
+                self.check_phys_access(upper_va, upper, access)?;
+                split = Some((upper, first));
+            }
+        }
+
+        let read_atomic = |cpu: &mut Self| match ctrl.width {
+            MemWidth::Word => (cpu.bus.bus.read_u32(paddr) as i32) as i64 as u64,
+            MemWidth::Double => cpu.bus.bus.read_u64(paddr),
+            _ => 0,
+        };
+
+        match ctrl.atomic_op {
+            AtomicOp::Lr => {
+                let val = read_atomic(self);
+                if self.is_smp() {
+                    self.smp_load_reserved(paddr, val);
+                } else {
+                    self.set_reservation(paddr);
+                }
+                Ok(val)
+            }
+            AtomicOp::Sc if self.is_smp() => {
+                Ok(u64::from(!self.smp_store_conditional(paddr, store_data, ctrl.width)))
+            }
+            AtomicOp::Sc => {
+                if self.check_reservation(paddr) {
+                    self.clear_reservation();
+                    write_store_to_memory(self, paddr, store_data, ctrl.width);
+                    Ok(0)
+                } else {
+                    Ok(1)
+                }
+            }
+            AtomicOp::None if !ctrl.mem_write => {
+                let mut ld = match split {
+                    Some((upper, first)) => {
+                        let raw = unaligned::split_load(0, size, |i| {
+                            let pa = split_byte(paddr, upper, first, i);
+                            self.read_phys_load(pa, MemWidth::Byte, false) as u8
+                        });
+                        match (ctrl.width, ctrl.signed_load) {
+                            (MemWidth::Half, true) => (raw as i16) as i64 as u64,
+                            (MemWidth::Word, true) => (raw as i32) as i64 as u64,
+                            _ => raw,
+                        }
+                    }
+                    None => self.read_phys_load(paddr, ctrl.width, ctrl.signed_load),
+                };
+                if ctrl.fp_reg_write && matches!(ctrl.width, MemWidth::Word) {
+                    ld |= NAN_BOX_MASK;
+                }
+                Ok(ld)
+            }
+            op if op != AtomicOp::None && self.is_smp() => {
+                Ok(self.smp_amo(op, paddr, store_data, ctrl.width))
+            }
+            op => {
+                // Regular store or AMO: a write to the reservation granule
+                // between a paired LR and SC must cause the SC to fail.
+                let (old, data) = if op == AtomicOp::None {
+                    (0, store_data)
+                } else {
+                    let old = read_atomic(self);
+                    (old, Lsu::atomic_alu(op, old, store_data, ctrl.width))
+                };
+                if let Some((upper, first)) = split {
+                    if self.check_reservation(paddr) || self.check_reservation(upper) {
+                        self.clear_reservation();
+                    }
+                    unaligned::split_store(0, size, data, |i, byte| {
+                        let pa = split_byte(paddr, upper, first, i);
+                        write_store_to_memory(self, pa, u64::from(byte), MemWidth::Byte);
+                    });
+                    return Ok(old);
+                }
+                if self.check_reservation(paddr) {
+                    self.clear_reservation();
+                }
+                write_store_to_memory(self, paddr, data, ctrl.width);
+                Ok(old)
+            }
+        }
+    }
+
+    /// Faults an S/U-mode access to an unmapped physical address (M-mode
+    /// probes read the bus default), then warms the caches with it.
+    fn check_phys_access(
+        &mut self,
+        vaddr: u64,
+        paddr: PhysAddr,
+        access: AccessType,
+    ) -> Result<(), Trap> {
+        if self.privilege != PrivilegeMode::Machine && !self.bus.bus.is_valid_address(paddr) {
+            return Err(if access == AccessType::Write {
+                Trap::StoreAccessFault(vaddr)
+            } else {
+                Trap::LoadAccessFault(vaddr)
+            });
+        }
+        if self.functional_warming && paddr.val() >= self.cache_base {
+            self.warm_memory_access(paddr, access);
+        }
+        Ok(())
+    }
+
+    /// Warms the L1I (and lower levels) with the line containing `paddr`.
+    pub(super) fn warm_fetch(&mut self, paddr: PhysAddr) {
+        let line = paddr.val() & !(self.i_cache_line_bytes as u64 - 1);
+        if paddr.val() >= self.cache_base && self.warm_fetch_line != Some(line) {
+            self.warm_fetch_line = Some(line);
+            self.warm_memory_access(paddr, AccessType::Fetch);
+        }
+    }
+
+    /// Trains the predictor on a retired branch or jump (functional
+    /// warming) and appends it to the branch trace, if one is open.
+    fn retire_control_transfer(&mut self, pc: u64, inst: u32, next_pc: u64, target: Option<u64>) {
+        if !self.functional_warming && self.branch_trace.is_none() {
+            return;
+        }
+        let Some(kind) = BranchKind::classify(inst) else { return };
+        let rec = BranchRecord { kind, pc, target, compressed: next_pc.wrapping_sub(pc) == 2 };
+        if self.functional_warming {
+            rec.train(&mut self.branch_predictor);
+        }
+        if let Some(trace) = self.branch_trace.as_deref_mut() {
+            trace.record(&rec);
+        }
+    }
+
+    /// Retirement bookkeeping mirrored from the commit stage (PC trace, stats).
+    pub(super) fn retire_functional(&mut self, pc: u64, inst: u32, retired: &Retired) {
+        if inst == INSTRUCTION_NOP {
+            return;
+        }
+        self.pc_trace.push((pc, inst));
+        if self.pc_trace.len() > PC_TRACE_MAX {
+            let _ = self.pc_trace.remove(0);
+        }
+        if inst != 0 {
+            self.stats.instructions_retired += 1;
+            update_instruction_stats(self, &retired.ctrl);
+        }
+        let (rd, value) = retired.rd_write.map_or((0, 0), |(rd, v)| (rd.as_usize(), v));
+        trace_commit!(self.trace;
+            pc       = %crate::trace::Hex(pc),
+            inst     = %crate::trace::Hex32(inst),
+            rd       = rd,
+            value    = %crate::trace::Hex(value),
+            next_pc  = %crate::trace::Hex(retired.next_pc),
+            "FN: instruction retired"
+        );
+    }
+
+    /// Sets `mstatus.FS`/`sstatus.FS` to DIRTY after an FP state change.
+    pub(super) const fn mark_fs_dirty(&mut self) {
+        self.csrs.mstatus = (self.csrs.mstatus & !csr::MSTATUS_FS) | csr::MSTATUS_FS_DIRTY;
+        self.csrs.sstatus = (self.csrs.sstatus & !csr::MSTATUS_FS) | csr::MSTATUS_FS_DIRTY;
+    }
+}
+
+/// Physical address of byte `i` of an access split across two pages: the
+/// first `first` bytes are at `lower`, the rest at `upper`.
+const fn split_byte(lower: PhysAddr, upper: PhysAddr, first: u64, i: u64) -> PhysAddr {
+    if i < first { PhysAddr::new(lower.val() + i) } else { PhysAddr::new(upper.val() + i - first) }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used, unused_results)]
+mod tests {
+    use super::*;
+    use crate::config::Config;
+    use crate::soc::builder::System;
+
+    fn cpu_with_program(program: &[u32]) -> Cpu {
+        let config = Config::default();
+        let system = System::new(&config, "");
+        let mut cpu = Cpu::new(system, &config);
+        let base = cpu.pc;
+        for (i, inst) in program.iter().enumerate() {
+            cpu.bus.bus.write_u32(PhysAddr::new(base + (i as u64) * 4), *inst);
+        }
+        cpu
+    }
+
+    #[test]
+    fn test_step_functional_addi() {
+        // addi x1, x0, 42
+        let mut cpu = cpu_with_program(&[0x02A0_0093]);
+        let pc = cpu.pc;
+        cpu.step_functional();
+        assert_eq!(cpu.regs.read(RegIdx::new(1)), 42);
+        assert_eq!(cpu.pc, pc + 4);
+        assert_eq!(cpu.committed_next_pc, pc + 4);
+        assert_eq!(cpu.stats.instructions_retired, 1);
+    }
+
+    #[test]
+    fn test_step_functional_compressed() {
+        // c.li x1, 7 ; padding
+        let mut cpu = cpu_with_program(&[0x0000_409D]);
+        let pc = cpu.pc;
+        cpu.step_functional();
+        assert_eq!(cpu.regs.read(RegIdx::new(1)), 7);
+        assert_eq!(cpu.pc, pc + 2);
+    }
+
+    #[test]
+    fn test_step_functional_nop_not_counted() {
+        let mut cpu = cpu_with_program(&[INSTRUCTION_NOP]);
+        let pc = cpu.pc;
+        cpu.step_functional();
+        assert_eq!(cpu.pc, pc + 4);
+        assert_eq!(cpu.stats.instructions_retired, 0);
+    }
+
+    #[test]
+    fn test_step_functional_misaligned_pc_traps() {
+        let mut cpu = cpu_with_program(&[]);
+        cpu.csrs.misa &= !csr::MISA_EXT_C;
+        cpu.pc += 2;
+        cpu.step_functional();
+        // Direct mode: non-ecall traps are fatal.
+        assert!(cpu.exit_code.is_some());
+        assert_eq!(cpu.stats.instructions_retired, 0);
+    }
+
+    #[test]
+    fn test_step_functional_ecall_exit() {
+        // addi a7, x0, 93 ; addi a0, x0, 3 ; ecall
+        let mut cpu = cpu_with_program(&[0x05D0_0893, 0x0030_0513, sys_ops::ECALL]);
+        for _ in 0..3 {
+            cpu.step_functional();
+        }
+        assert_eq!(cpu.exit_code, Some(3));
+    }
+
+    #[test]
+    fn test_step_functional_wfi_idles() {
+        let mut cpu = cpu_with_program(&[sys_ops::WFI]);
+        cpu.csrs.mie = csr::MIE_MTIE;
+        cpu.step_functional();
+        assert!(cpu.wfi_waiting);
+        let retired = cpu.stats.instructions_retired;
+        cpu.step_functional();
+        assert!(cpu.wfi_waiting);
+        assert_eq!(cpu.stats.instructions_retired, retired);
+        assert_eq!(cpu.stats.cycles_wfi, 1);
+    }
+
+    /// S-mode Sv39 CPU with virtual pages 1 and 2 mapped to the physically
+    /// discontiguous RAM pages at `+0x20000` and `+0x30000`.
+    fn cpu_with_split_pages() -> Cpu {
+        let mut config = Config::default();
+        config.memory.misaligned_access_trap = false;
+        let mut cpu = Cpu::new(System::new(&config, ""), &config);
+        let ram = cpu.ram_start;
+        let (root, mid, leaf) = (ram + 0x1_0000, ram + 0x1_1000, ram + 0x1_2000);
+        let table = |next: u64| ((next >> 12) << 10) | 1;
+        // V | R | W | A | D
+        let page = |pa: u64| ((pa >> 12) << 10) | 0xC7;
+        cpu.bus.bus.write_u64(PhysAddr::new(root), table(mid));
+        cpu.bus.bus.write_u64(PhysAddr::new(mid), table(leaf));
+        cpu.bus.bus.write_u64(PhysAddr::new(leaf + 8), page(ram + 0x2_0000));
+        cpu.bus.bus.write_u64(PhysAddr::new(leaf + 16), page(ram + 0x3_0000));
+        // PMP entry 0: NAPOT over all memory, RWX.
+        cpu.pmp.set_addr(0, u64::MAX >> 10);
+        cpu.pmp.set_cfg(0, 0x1F);
+        cpu.direct_mode = false;
+        cpu.privilege = PrivilegeMode::Supervisor;
+        cpu.csrs.satp = (8 << 60) | (root >> 12);
+        cpu
+    }
+
+    #[test]
+    fn test_misaligned_access_splits_across_pages() {
+        let mut cpu = cpu_with_split_pages();
+        let (lower, upper) = (cpu.ram_start + 0x2_0FFC, cpu.ram_start + 0x3_0000);
+        cpu.bus.bus.write_u32(PhysAddr::new(lower), 0x0403_0201);
+        cpu.bus.bus.write_u32(PhysAddr::new(upper), 0x0807_06F5);
+
+        let load = |width, signed_load| ControlSignals {
+            mem_read: true,
+            width,
+            signed_load,
+            ..ControlSignals::default()
+        };
+        let mut access = |ctrl, vaddr, data| cpu.access_memory_functional(&ctrl, vaddr, data);
+        assert_eq!(access(load(MemWidth::Double, false), 0x1FFC, 0), Ok(0x0807_06F5_0403_0201));
+        assert_eq!(access(load(MemWidth::Word, true), 0x1FFE, 0), Ok(0x06F5_0403));
+        assert_eq!(access(load(MemWidth::Half, true), 0x1FFF, 0), Ok(0xFFFF_FFFF_FFFF_F504));
+
+        let store = ControlSignals {
+            mem_write: true,
+            width: MemWidth::Double,
+            ..ControlSignals::default()
+        };
+        assert_eq!(access(store, 0x1FFA, 0x1122_3344_5566_7788), Ok(0));
+        assert_eq!(cpu.bus.bus.read_u16(PhysAddr::new(lower - 2)), 0x7788);
+        assert_eq!(cpu.bus.bus.read_u32(PhysAddr::new(lower)), 0x3344_5566);
+        assert_eq!(cpu.bus.bus.read_u32(PhysAddr::new(upper)), 0x0807_1122);
+    }
+
+    #[test]
+    fn test_ram_fast_path_requires_the_whole_access_in_ram() {
+        let cpu = cpu_with_program(&[]);
+        let end = cpu.ram_end;
+        assert_eq!(cpu.ram_offset(end - 8, 8), Some((end - 8 - cpu.ram_start) as usize));
+        assert_eq!(cpu.ram_offset(end - 4, 8), None);
+        assert_eq!(cpu.ram_offset(end, 1), None);
+        assert_eq!(cpu.ram_offset(cpu.ram_start - 1, 2), None);
+        assert_eq!(cpu.ram_offset(u64::MAX, 8), None);
+    }
+
+    #[test]
+    fn test_step_functional_marker_csr() {
+        // csrrwi x0, 0x8FE, 5
+        let mut cpu = cpu_with_program(&[(0x8FE << 20) | (5 << 15) | (0b101 << 12) | 0x73]);
+        cpu.step_functional();
+        assert_eq!(cpu.sim_marker, Some(5));
+    }
+}
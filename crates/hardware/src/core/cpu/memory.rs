@@ -7,9 +7,92 @@
 //! 3. **Latency Modeling:** Calculates timing penalties for cache hits, misses, and bus transit.
 
 use super::Cpu;
+use super::memtrace::MemTraceKind;
 use crate::common::{AccessType, PhysAddr, TranslationResult, Trap, VirtAddr};
 use crate::config::InclusionPolicy;
+use crate::core::pipeline::tma::MemLevel;
+use crate::core::units::cache::AccessBuffers;
+use crate::core::units::cache::mshr::{CacheResponse, MshrCompletion, MshrFile, MshrWaiter};
 use crate::core::units::mmu::pmp::PmpResult;
+use crate::soc::uncore::lock;
+use crate::stats::{Stage, StageTimer};
+
+/// Outcome of a non-blocking L1D access (see [`Cpu::access_l1d_nonblocking`]).
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub enum L1dAccess {
+    /// The line was present.
+    Hit {
+        /// L1D latency plus any coherence penalty.
+        latency: u64,
+    },
+    /// The line was absent and was handed to the MSHR file.
+    Miss {
+        /// L1D latency plus the L2/L3/DRAM miss latency.
+        latency: u64,
+        /// What the MSHR file did with the miss.
+        response: CacheResponse,
+    },
+}
+
+/// Where an L1D miss went below the L1D, for the L2/L3 MSHR model.
+#[derive(Clone, Copy, Debug, Default)]
+struct MissPath {
+    /// Offset from the start of the miss at which it reached the L2.
+    l2_at: Option<u64>,
+    /// Offset from the start of the miss at which it reached the L3.
+    l3_at: Option<u64>,
+    /// Whether the L2 tags missed.
+    l2_miss: bool,
+    /// Whether the L3 tags missed.
+    l3_miss: bool,
+}
+
+impl MissPath {
+    /// Level that served the miss.
+    const fn served_by(&self) -> MemLevel {
+        match (self.l2_at, self.l2_miss, self.l3_at, self.l3_miss) {
+            (Some(_), false, _, _) => MemLevel::L2,
+            (_, _, Some(_), false) => MemLevel::L3,
+            _ => MemLevel::Dram,
+        }
+    }
+}
+
+/// What a lower-level MSHR file does with a miss arriving from above.
+enum LowerMshr {
+    /// No MSHR is involved (the level hit, or has no MSHRs).
+    Bypass,
+    /// The line already has a fill in flight, arriving at this cycle.
+    Merged(u64),
+    /// The miss needs an MSHR, free after waiting this many cycles.
+    Queued(u64),
+}
+
+/// Presents a miss to `addr` (`missed` if the level's tags missed) to
+/// `mshrs` at cycle `arrive`, first retiring the fills that have arrived.
+///
+/// A miss finding every MSHR busy waits for the earliest fill and takes its
+/// slot.
+fn present_miss(mshrs: &mut MshrFile, addr: u64, arrive: u64, missed: bool) -> LowerMshr {
+    if mshrs.capacity() == 0 {
+        return LowerMshr::Bypass;
+    }
+    mshrs.retire_through(arrive);
+    if let Some(fill) = mshrs.pending_fill(addr) {
+        return LowerMshr::Merged(fill);
+    }
+    if !missed {
+        return LowerMshr::Bypass;
+    }
+    if !mshrs.is_full() {
+        return LowerMshr::Queued(0);
+    }
+    // Take over the slot of the earliest fill; later arrivals may still
+    // see the others busy.
+    let free_at = mshrs.next_completion().unwrap_or(arrive);
+    let _ = mshrs.pop_completed(free_at);
+    LowerMshr::Queued(free_at - arrive)
+}
 
 impl Cpu {
     /// Translates a virtual address to a physical address using the MMU.
@@ -61,6 +144,7 @@ impl Cpu {
             &mut self.bus.bus,
             Some(&self.pmp),
         );
+        self.mmu.stats.copy_to(&mut self.stats);
 
         // PMP check on the translated physical address.
         // PMP applies to all privilege modes: M-mode with no matching entry gets Allow,
@@ -92,8 +176,11 @@ impl Cpu {
     /// Computes the total latency for an L1D miss, walking L2 → L3 → DRAM.
     ///
     /// Does NOT modify the L1D cache. The caller (MSHR) is responsible for
-    /// installing the L1D line when the miss completes. L2/L3 accesses are
-    /// synchronous (blocking) — only L1D gets MSHRs.
+    /// installing the L1D line when the miss completes. Tag state below the
+    /// L1D is updated at once; with `mshr_count` set on the L2 or L3, the
+    /// miss also holds one of that level's MSHRs until its fill returns,
+    /// waiting for a free one or merging with an in-flight fill of the same
+    /// line (see [`Self::queue_below_l1d`]).
     ///
     /// # Memory model (matches gem5 classic cache)
     ///
@@ -103,28 +190,135 @@ impl Cpu {
     /// - The DRAM controller is only consulted when all caches miss, so its
     ///   stateful bank/row-buffer/refresh tracking reflects real traffic only.
     pub fn simulate_l1d_miss_latency(&mut self, addr: PhysAddr, access: AccessType) -> u64 {
+        let mut buf = std::mem::take(&mut self.cache_buffers);
+        let mut path = MissPath::default();
+        let penalty = self.l1d_miss_latency(addr, access, &mut buf, &mut path);
+        self.cache_buffers = buf;
+        let latency = if self.l1d_mshrs.pending_fill(addr.val()).is_some() {
+            // Merges with the outstanding L1D miss; nothing new goes below.
+            penalty
+        } else {
+            self.queue_below_l1d(addr.val(), access == AccessType::Write, penalty, path)
+        };
+        self.tma_misses.note(path.served_by(), self.stats.cycles + latency);
+        latency
+    }
+
+    /// Applies the L2 and L3 MSHR limits to an L1D miss issued at the
+    /// current machine cycle whose walk took `latency` cycles, returning its
+    /// latency including any wait.
+    ///
+    /// The miss queues for a free MSHR at each level it missed (delaying
+    /// everything after it), or takes the completion of an in-flight fill
+    /// of the same line at a level that has one. Each MSHR it allocates is
+    /// held until the fill returns to the L1D.
+    fn queue_below_l1d(&mut self, addr: u64, is_write: bool, latency: u64, path: MissPath) -> u64 {
+        let start = self.stats.cycles;
+        let mut delay = 0;
+        let mut merged = None;
+        let mut l2_from = None;
+        let mut l3_from = None;
+
+        if let Some(at) = path.l2_at {
+            let arrive = start + at;
+            match present_miss(&mut self.l2_mshrs, addr, arrive, path.l2_miss) {
+                LowerMshr::Bypass => {}
+                LowerMshr::Merged(fill) => {
+                    self.stats.l2_mshr_coalesces += 1;
+                    merged = Some(fill);
+                }
+                LowerMshr::Queued(wait) => {
+                    self.stats.stalls_l2_mshr_full += wait;
+                    delay += wait;
+                    l2_from = Some(arrive + wait);
+                }
+            }
+        }
+        if let (None, Some(at)) = (merged, path.l3_at) {
+            let arrive = start + at + delay;
+            match present_miss(&mut self.l3_mshrs, addr, arrive, path.l3_miss) {
+                LowerMshr::Bypass => {}
+                LowerMshr::Merged(fill) => {
+                    self.stats.l3_mshr_coalesces += 1;
+                    merged = Some(fill);
+                }
+                LowerMshr::Queued(wait) => {
+                    self.stats.stalls_l3_mshr_full += wait;
+                    delay += wait;
+                    l3_from = Some(arrive + wait);
+                }
+            }
+        }
+
+        let done = merged.unwrap_or(start + latency + delay);
+        if let Some(from) = l2_from {
+            let _ = self.l2_mshrs.reserve(addr, is_write, done);
+            self.stats.l2_mshr_allocations += 1;
+            self.stats.l2_mshr_occupancy += done - from;
+        }
+        if let Some(from) = l3_from {
+            let _ = self.l3_mshrs.reserve(addr, is_write, done);
+            self.stats.l3_mshr_allocations += 1;
+            self.stats.l3_mshr_occupancy += done - from;
+        }
+        done - start
+    }
+
+    /// Probes the L3 (the hart-shared one in an SMP system) and installs its
+    /// filtered prefetch candidates. Returns whether the access hit.
+    fn access_l3(&mut self, raw_addr: u64, is_write: bool, buf: &mut AccessBuffers) -> bool {
+        // Writebacks are fire-and-forget, as for the other levels.
+        const WB_LAT: u64 = 0;
+        let mut guard = self.shared_l3.as_deref().map(lock);
+        let l3 = guard.as_deref_mut().unwrap_or(&mut self.l3_cache);
+        let (hit, _pen) = l3.access_tracked_split(raw_addr, is_write, WB_LAT, buf);
+
+        // Filter and install L3 prefetch candidates
+        self.prefetch_filter.filter_and_record(&mut buf.prefetches, &mut self.stats.pf_dedup_l3);
+        l3.install_prefetches(&buf.prefetches, WB_LAT, &mut buf.evictions);
+        drop(guard);
+        hit
+    }
+
+    /// Queues the dirty lines in `buf` (evicted from the last-level cache) as
+    /// DRAM write-backs.
+    fn write_back_to_dram(&mut self, buf: &AccessBuffers) {
+        for ev in buf.evictions.iter().filter(|ev| ev.dirty) {
+            self.bus.mem_controller.write_back(ev.addr, self.stats.cycles);
+        }
+    }
+
+    /// Body of [`Self::simulate_l1d_miss_latency`], using `buf` as scratch.
+    fn l1d_miss_latency(
+        &mut self,
+        addr: PhysAddr,
+        access: AccessType,
+        buf: &mut AccessBuffers,
+        path: &mut MissPath,
+    ) -> u64 {
         // Dirty writebacks are fire-and-forget into write buffers (gem5 WriteBuffer
         // queue model). They do not block the demand miss, so we pass 0 as the
         // next-level-latency used for dirty victim writeback costing.
         const WB_LAT: u64 = 0;
-        let mut total_penalty = 0;
         let raw_addr = addr.val();
         let is_write = matches!(access, AccessType::Write);
         let inclusion = self.inclusion_policy;
+        let mut total_penalty = self.coherence_access(raw_addr, is_write);
 
         if self.l2_cache.enabled {
+            path.l2_at = Some(total_penalty);
             total_penalty += self.l2_cache.latency;
-            let (l2_hit, _l2_pen, l2_evictions, l2_prefetches) =
-                self.l2_cache.access_tracked_split(raw_addr, is_write, WB_LAT);
+            let (l2_hit, _l2_pen) =
+                self.l2_cache.access_tracked_split(raw_addr, is_write, WB_LAT, buf);
 
             // Filter and install L2 prefetch candidates through the shared filter
-            let filtered =
-                self.prefetch_filter.filter_and_record(l2_prefetches, &mut self.stats.pf_dedup_l2);
-            let pf_evictions = self.l2_cache.install_prefetches(&filtered, WB_LAT);
+            self.prefetch_filter
+                .filter_and_record(&mut buf.prefetches, &mut self.stats.pf_dedup_l2);
+            self.l2_cache.install_prefetches(&buf.prefetches, WB_LAT, &mut buf.evictions);
 
             // Inclusive policy: L2 eviction → back-invalidate matching L1D/L1I lines
             if inclusion == InclusionPolicy::Inclusive {
-                for ev in l2_evictions.iter().chain(pf_evictions.iter()) {
+                for ev in &buf.evictions {
                     if self.l1_d_cache.invalidate_line(ev.addr) {
                         self.stats.inclusion_back_invalidations += 1;
                     }
@@ -133,27 +327,28 @@ impl Cpu {
                     }
                 }
             }
+            self.note_private_evictions(buf);
+
+            if !self.l3_cache.enabled {
+                self.write_back_to_dram(buf);
+            }
 
             if l2_hit {
                 self.stats.l2_hits += 1;
                 return total_penalty;
             }
             self.stats.l2_misses += 1;
+            path.l2_miss = true;
         }
 
         if self.l3_cache.enabled {
+            path.l3_at = Some(total_penalty);
             total_penalty += self.l3_cache.latency;
-            let (l3_hit, _l3_pen, l3_evictions, l3_prefetches) =
-                self.l3_cache.access_tracked_split(raw_addr, is_write, WB_LAT);
-
-            // Filter and install L3 prefetch candidates
-            let filtered =
-                self.prefetch_filter.filter_and_record(l3_prefetches, &mut self.stats.pf_dedup_l3);
-            let pf_evictions = self.l3_cache.install_prefetches(&filtered, WB_LAT);
+            let l3_hit = self.access_l3(raw_addr, is_write, buf);
 
             // Inclusive policy: L3 eviction → back-invalidate L2, L1D, L1I
             if inclusion == InclusionPolicy::Inclusive {
-                for ev in l3_evictions.iter().chain(pf_evictions.iter()) {
+                for ev in &buf.evictions {
                     let _ = self.l2_cache.invalidate_line(ev.addr);
                     if self.l1_d_cache.invalidate_line(ev.addr) {
                         self.stats.inclusion_back_invalidations += 1;
@@ -164,11 +359,14 @@ impl Cpu {
                 }
             }
 
+            self.write_back_to_dram(buf);
+
             if l3_hit {
                 self.stats.l3_hits += 1;
                 return total_penalty;
             }
             self.stats.l3_misses += 1;
+            path.l3_miss = true;
         }
 
         // All caches missed — now query the DRAM controller (stateful).
@@ -193,6 +391,176 @@ impl Cpu {
     /// - The DRAM controller is only consulted when the request misses all
     ///   caches, keeping its stateful bank/refresh tracking accurate.
     pub fn simulate_memory_access(&mut self, addr: PhysAddr, access: AccessType) -> u64 {
+        self.trace_access(MemTraceKind::timed(access), addr.val(), 0, None);
+        self.access_hierarchy(addr, access, true)
+    }
+
+    /// [`Self::simulate_memory_access`] for an access whose PC and size in
+    /// bytes are known, so a memory-access trace can record them.
+    pub fn simulate_memory_access_at(
+        &mut self,
+        addr: PhysAddr,
+        access: AccessType,
+        pc: u64,
+        size: u64,
+    ) -> u64 {
+        self.trace_access(MemTraceKind::timed(access), addr.val(), size, Some(pc));
+        self.access_hierarchy(addr, access, true)
+    }
+
+    /// Updates cache state for an access without modeling its timing.
+    ///
+    /// Used by functional warming during fast-forward: L1/L2/L3 tags,
+    /// replacement state, and prefetchers are trained exactly as for a
+    /// detailed access, but the stateful DRAM controller is never consulted
+    /// so its bank/row-buffer state is not perturbed by untimed traffic.
+    pub fn warm_memory_access(&mut self, addr: PhysAddr, access: AccessType) {
+        self.trace_access(MemTraceKind::warm(access), addr.val(), 0, None);
+        let _ = self.access_hierarchy(addr, access, false);
+    }
+
+    /// Fetch-directed prefetch of the instruction line at `addr` into the L1I.
+    ///
+    /// Returns the fill latency, or `None` when the L1I is disabled or
+    /// already holds the line. The fill walks the lower levels like a demand
+    /// miss but is not counted as an L1I miss.
+    pub fn prefetch_inst_line(&mut self, addr: PhysAddr) -> Option<u64> {
+        if !self.l1_i_cache.enabled || self.l1_i_cache.contains(addr.val()) {
+            return None;
+        }
+        let latency = self.access_hierarchy(addr, AccessType::Fetch, true);
+        self.stats.icache_misses -= 1;
+        Some(latency)
+    }
+
+    /// Non-blocking L1D access for a backend with MSHRs.
+    ///
+    /// Checks the L1D tags (training its prefetcher); on a miss, walks
+    /// L2 → L3 → DRAM for the fill latency and hands the miss to the MSHR
+    /// file at MSHR clock `now`, building the waiter only then. The line is
+    /// installed when [`Self::drain_mshr_fills`] sees the fill arrive.
+    pub fn access_l1d_nonblocking(
+        &mut self,
+        addr: PhysAddr,
+        access: AccessType,
+        pc: u64,
+        size: u64,
+        now: u64,
+        waiter: impl FnOnce() -> MshrWaiter,
+    ) -> L1dAccess {
+        let is_write = access == AccessType::Write;
+        if let Some(trace) = self.mem_trace.as_deref_mut() {
+            trace.set_clock(now);
+        }
+        let kind = if is_write { MemTraceKind::L1dWrite } else { MemTraceKind::L1dRead };
+        self.trace_access(kind, addr.val(), size, Some(pc));
+        self.profile_data_access(addr.val());
+
+        if self.l1_d_cache.access_check(addr.val(), is_write) {
+            self.stats.dcache_hits += 1;
+            let latency = self.l1_d_cache.latency + self.coherence_access(addr.val(), is_write);
+            return L1dAccess::Hit { latency };
+        }
+        self.stats.dcache_misses += 1;
+        let latency = self.l1_d_cache.latency + self.simulate_l1d_miss_latency(addr, access);
+        let response = self.l1d_mshrs.request(addr.val(), is_write, latency, now, waiter());
+        match response {
+            CacheResponse::MshrAllocated { .. } => {
+                self.stats.mshr_allocations += 1;
+                self.stats.mshr_occupancy += latency;
+            }
+            CacheResponse::MshrCoalesced { .. } => self.stats.mshr_coalesces += 1,
+            CacheResponse::MshrFull | CacheResponse::Hit => {}
+        }
+        L1dAccess::Miss { latency, response }
+    }
+
+    /// Installs the L1D lines whose MSHR fills have arrived by MSHR clock
+    /// `now`, in completion order, handing each of their waiters to
+    /// `resume`.
+    pub fn drain_mshr_fills(&mut self, now: u64, mut resume: impl FnMut(MshrWaiter)) {
+        if let Some(trace) = self.mem_trace.as_deref_mut() {
+            trace.set_clock(now);
+        }
+        loop {
+            let Some(MshrCompletion { line_addr, is_write, waiters }) =
+                self.l1d_mshrs.pop_completed(now)
+            else {
+                break;
+            };
+            waiters.for_each(&mut resume);
+            // The write-back penalty was already charged in the miss latency.
+            let (_penalty, evicted) =
+                self.l1_d_cache.install_line_public_tracked(line_addr, is_write, 0);
+            let Some(ev) = evicted else { continue };
+
+            // Exclusive policy: L1D eviction → install evicted line into L2
+            if self.inclusion_policy == InclusionPolicy::Exclusive && self.l2_cache.enabled {
+                let _ = self.l2_cache.install_or_replace(ev.addr, ev.dirty, 0);
+                self.stats.exclusive_l1_to_l2_swaps += 1;
+            }
+            self.note_private_eviction(ev.addr);
+        }
+    }
+
+    /// Drops every outstanding L1D miss (pipeline flush); their lines are
+    /// never installed.
+    pub fn flush_mshrs(&mut self) {
+        self.trace_access(MemTraceKind::MshrFlush, 0, 0, None);
+        self.l1d_mshrs.flush();
+    }
+
+    /// Invalidates the L1 I-cache (`fence.i`).
+    pub fn invalidate_l1i(&mut self) {
+        self.trace_access(MemTraceKind::InvalidateL1i, 0, 0, None);
+        let _ = self.l1_i_cache.invalidate_all();
+    }
+
+    /// Flushes the L1 D-cache and invalidates the L1 I-cache (`satp`
+    /// writes and a full `sfence.vma`).
+    pub fn flush_l1_caches(&mut self) {
+        self.trace_access(MemTraceKind::FlushL1, 0, 0, None);
+        let _ = self.l1_d_cache.flush();
+        let _ = self.l1_i_cache.invalidate_all();
+    }
+
+    /// Appends a record to the memory-access trace, if one is being captured.
+    #[inline]
+    fn trace_access(&mut self, kind: MemTraceKind, addr: u64, size: u64, pc: Option<u64>) {
+        if let Some(trace) = self.mem_trace.as_deref_mut() {
+            trace.record(kind, self.stats.cycles, addr, size, pc);
+        }
+    }
+
+    /// Counts a data access in the stack-distance profile, if one is kept.
+    #[inline]
+    fn profile_data_access(&mut self, addr: u64) {
+        if let Some(profiler) = self.stack_distance.as_deref_mut() {
+            profiler.access(addr, &mut self.stats.stack_distance);
+        }
+    }
+
+    /// Walks the cache hierarchy for one access; `timing` enables the DRAM model.
+    fn access_hierarchy(&mut self, addr: PhysAddr, access: AccessType, timing: bool) -> u64 {
+        if access != AccessType::Fetch {
+            self.profile_data_access(addr.val());
+        }
+        let timer = StageTimer::start();
+        let mut buf = std::mem::take(&mut self.cache_buffers);
+        let penalty = self.walk_hierarchy(addr, access, timing, &mut buf);
+        self.cache_buffers = buf;
+        timer.stop(&mut self.stats.stage_times, Stage::Hierarchy);
+        penalty
+    }
+
+    /// Body of [`Self::access_hierarchy`], using `buf` as scratch.
+    fn walk_hierarchy(
+        &mut self,
+        addr: PhysAddr,
+        access: AccessType,
+        timing: bool,
+        buf: &mut AccessBuffers,
+    ) -> u64 {
         // Dirty writebacks are fire-and-forget into write buffers (gem5 WriteBuffer
         // queue model). They do not block the demand access, so we pass 0 as the
         // next-level-latency used for dirty victim writeback costing.
@@ -208,41 +576,54 @@ impl Cpu {
 
         // If no cache level is enabled, every access goes directly to DRAM.
         if !l1_enabled && !self.l2_cache.enabled && !self.l3_cache.enabled {
+            if !timing {
+                return 0;
+            }
             let ram_latency = self.bus.mem_controller.access_latency(raw_addr, self.stats.cycles);
-            return self.bus.bus.calculate_transit_time(8)
+            let latency = self.bus.bus.calculate_transit_time(8)
                 + ram_latency
                 + self.bus.bus.calculate_transit_time(64);
+            if !is_inst {
+                self.tma_misses.note(MemLevel::Dram, self.stats.cycles + latency);
+            }
+            return latency;
+        }
+
+        // Coherence permission comes first, so probes it applies cannot
+        // invalidate the line this access is about to install.
+        if !is_inst {
+            total_penalty += self.coherence_access(raw_addr, is_write);
         }
 
         // ── L1 ──────────────────────────────────────────────────────────────────
-        let (l1_hit, _l1_pen, l1_evictions, l1_prefetches) = if is_inst {
-            if self.l1_i_cache.enabled {
-                self.l1_i_cache.access_tracked_split(raw_addr, false, WB_LAT)
-            } else {
-                (false, 0, Vec::new(), Vec::new())
-            }
-        } else if self.l1_d_cache.enabled {
-            self.l1_d_cache.access_tracked_split(raw_addr, is_write, WB_LAT)
+        // A disabled L1 clears `buf` and reports a miss.
+        let (l1_hit, _l1_pen) = if is_inst {
+            self.l1_i_cache.access_tracked_split(raw_addr, false, WB_LAT, buf)
         } else {
-            (false, 0, Vec::new(), Vec::new())
+            self.l1_d_cache.access_tracked_split(raw_addr, is_write, WB_LAT, buf)
         };
 
         // Filter L1 prefetch candidates through the shared filter, then install
-        let filtered_l1 =
-            self.prefetch_filter.filter_and_record(l1_prefetches, &mut self.stats.pf_dedup_l1);
-        let l1_pf_evictions = if is_inst {
-            self.l1_i_cache.install_prefetches(&filtered_l1, WB_LAT)
+        self.prefetch_filter.filter_and_record(&mut buf.prefetches, &mut self.stats.pf_dedup_l1);
+        if is_inst {
+            self.l1_i_cache.install_prefetches(&buf.prefetches, WB_LAT, &mut buf.evictions);
         } else {
-            self.l1_d_cache.install_prefetches(&filtered_l1, WB_LAT)
-        };
+            self.l1_d_cache.install_prefetches(&buf.prefetches, WB_LAT, &mut buf.evictions);
+        }
 
         // Exclusive policy: L1 eviction → install evicted line into L2
         if inclusion == InclusionPolicy::Exclusive && self.l2_cache.enabled {
-            for ev in l1_evictions.iter().chain(l1_pf_evictions.iter()) {
+            for ev in &buf.evictions {
                 let _ = self.l2_cache.install_or_replace(ev.addr, ev.dirty, WB_LAT);
                 self.stats.exclusive_l1_to_l2_swaps += 1;
             }
         }
+        if !is_inst {
+            self.note_private_evictions(buf);
+            if timing && !self.l2_cache.enabled && !self.l3_cache.enabled {
+                self.write_back_to_dram(buf);
+            }
+        }
 
         if is_inst && self.l1_i_cache.enabled {
             if l1_hit {
@@ -261,17 +642,17 @@ impl Cpu {
         // ── L2 ──────────────────────────────────────────────────────────────────
         if self.l2_cache.enabled {
             total_penalty += self.l2_cache.latency;
-            let (l2_hit, _l2_pen, l2_evictions, l2_prefetches) =
-                self.l2_cache.access_tracked_split(raw_addr, is_write, WB_LAT);
+            let (l2_hit, _l2_pen) =
+                self.l2_cache.access_tracked_split(raw_addr, is_write, WB_LAT, buf);
 
             // Filter and install L2 prefetch candidates
-            let filtered_l2 =
-                self.prefetch_filter.filter_and_record(l2_prefetches, &mut self.stats.pf_dedup_l2);
-            let l2_pf_evictions = self.l2_cache.install_prefetches(&filtered_l2, WB_LAT);
+            self.prefetch_filter
+                .filter_and_record(&mut buf.prefetches, &mut self.stats.pf_dedup_l2);
+            self.l2_cache.install_prefetches(&buf.prefetches, WB_LAT, &mut buf.evictions);
 
             // Inclusive policy: L2 eviction → back-invalidate L1 lines
             if inclusion == InclusionPolicy::Inclusive {
-                for ev in l2_evictions.iter().chain(l2_pf_evictions.iter()) {
+                for ev in &buf.evictions {
                     if self.l1_d_cache.invalidate_line(ev.addr) {
                         self.stats.inclusion_back_invalidations += 1;
                     }
@@ -280,14 +661,22 @@ impl Cpu {
                     }
                 }
             }
+            self.note_private_evictions(buf);
 
             // Exclusive policy: on L2 hit, remove from L2 (data moves to L1 exclusively)
             if inclusion == InclusionPolicy::Exclusive && l2_hit {
                 let _ = self.l2_cache.invalidate_line(raw_addr);
             }
 
+            if timing && !self.l3_cache.enabled {
+                self.write_back_to_dram(buf);
+            }
+
             if l2_hit {
                 self.stats.l2_hits += 1;
+                if timing && !is_inst {
+                    self.tma_misses.note(MemLevel::L2, self.stats.cycles + total_penalty);
+                }
                 return total_penalty;
             }
             self.stats.l2_misses += 1;
@@ -296,17 +685,11 @@ impl Cpu {
         // ── L3 ──────────────────────────────────────────────────────────────────
         if self.l3_cache.enabled {
             total_penalty += self.l3_cache.latency;
-            let (l3_hit, _l3_pen, l3_evictions, l3_prefetches) =
-                self.l3_cache.access_tracked_split(raw_addr, is_write, WB_LAT);
-
-            // Filter and install L3 prefetch candidates
-            let filtered_l3 =
-                self.prefetch_filter.filter_and_record(l3_prefetches, &mut self.stats.pf_dedup_l3);
-            let l3_pf_evictions = self.l3_cache.install_prefetches(&filtered_l3, WB_LAT);
+            let l3_hit = self.access_l3(raw_addr, is_write, buf);
 
             // Inclusive policy: L3 eviction → back-invalidate L2, L1D, L1I
             if inclusion == InclusionPolicy::Inclusive {
-                for ev in l3_evictions.iter().chain(l3_pf_evictions.iter()) {
+                for ev in &buf.evictions {
                     let _ = self.l2_cache.invalidate_line(ev.addr);
                     if self.l1_d_cache.invalidate_line(ev.addr) {
                         self.stats.inclusion_back_invalidations += 1;
@@ -317,8 +700,15 @@ impl Cpu {
                 }
             }
 
+            if timing {
+                self.write_back_to_dram(buf);
+            }
+
             if l3_hit {
                 self.stats.l3_hits += 1;
+                if timing && !is_inst {
+                    self.tma_misses.note(MemLevel::L3, self.stats.cycles + total_penalty);
+                }
                 return total_penalty;
             }
             self.stats.l3_misses += 1;
@@ -327,10 +717,16 @@ impl Cpu {
         // ── DRAM (all caches missed) ────────────────────────────────────────────
         // Only now do we consult the stateful DRAM controller, so its bank,
         // row-buffer, and refresh state reflects real memory traffic only.
+        if !timing {
+            return total_penalty;
+        }
         let ram_latency = self.bus.mem_controller.access_latency(raw_addr, self.stats.cycles);
         total_penalty += self.bus.bus.calculate_transit_time(8);
         total_penalty += ram_latency;
         total_penalty += self.bus.bus.calculate_transit_time(64);
+        if !is_inst {
+            self.tma_misses.note(MemLevel::Dram, self.stats.cycles + total_penalty);
+        }
         total_penalty
     }
 }
@@ -0,0 +1,431 @@
+//! Memory-access trace capture.
+//!
+//! Records every event that reaches the cache hierarchy so that
+//! [`crate::sim::replay`] can drive the hierarchy alone from the file. It
+//! performs the following:
+//! 1. **Events:** Timed and warming walks, non-blocking L1D probes, MSHR
+//!    flushes, and cache maintenance, each stamped with the machine cycle
+//!    (which the DRAM controller reads) and the MSHR clock (the backend's
+//!    own cycle counter, which MSHR fills are timed against).
+//! 2. **Encoding:** One tag byte (kind in bits 0-3, log2 size + 1 in bits
+//!    4-6, PC present in bit 7), then LEB128 deltas of the cycle and MSHR
+//!    clock and zigzag LEB128 deltas of the address and PC from the previous
+//!    record. Sequential streams cost 4-5 bytes per access.
+//! 3. **Errors:** Recording never fails the simulation; the first write
+//!    error is held and returned by [`MemTraceWriter::finish`].
+//!
+//! The file starts with an 8-byte magic and a little-endian `u32` version.
+
+use crate::common::AccessType;
+use std::fs::File;
+use std::io::{self, BufReader, BufWriter, Read, Write};
+
+/// File magic identifying an rvsim memory-access trace.
+pub const MAGIC: [u8; 8] = *b"RVSIMMTR";
+
+/// Current trace format version.
+pub const VERSION: u32 = 1;
+
+/// What a trace record asks the cache hierarchy to do.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+#[repr(u8)]
+pub enum MemTraceKind {
+    /// Timed instruction fetch (`Cpu::simulate_memory_access`).
+    Fetch = 0,
+    /// Timed data read.
+    Read = 1,
+    /// Timed data write.
+    Write = 2,
+    /// Untimed functional-warming fetch (`Cpu::warm_memory_access`).
+    WarmFetch = 3,
+    /// Untimed functional-warming read.
+    WarmRead = 4,
+    /// Untimed functional-warming write.
+    WarmWrite = 5,
+    /// Non-blocking L1D load probe (`Cpu::access_l1d_nonblocking`).
+    L1dRead = 6,
+    /// Non-blocking L1D store probe.
+    L1dWrite = 7,
+    /// All L1D MSHRs dropped (pipeline flush).
+    MshrFlush = 8,
+    /// L1I invalidated (`fence.i`).
+    InvalidateL1i = 9,
+    /// L1D flushed and L1I invalidated (`satp` write, `sfence.vma`).
+    FlushL1 = 10,
+}
+
+impl MemTraceKind {
+    /// Kind of a timed hierarchy walk for `access`.
+    pub const fn timed(access: AccessType) -> Self {
+        match access {
+            AccessType::Fetch => Self::Fetch,
+            AccessType::Read => Self::Read,
+            AccessType::Write => Self::Write,
+        }
+    }
+
+    /// Kind of an untimed warming walk for `access`.
+    pub const fn warm(access: AccessType) -> Self {
+        match access {
+            AccessType::Fetch => Self::WarmFetch,
+            AccessType::Read => Self::WarmRead,
+            AccessType::Write => Self::WarmWrite,
+        }
+    }
+
+    /// Decodes the kind bits of a tag byte.
+    const fn from_bits(bits: u8) -> Option<Self> {
+        Some(match bits {
+            0 => Self::Fetch,
+            1 => Self::Read,
+            2 => Self::Write,
+            3 => Self::WarmFetch,
+            4 => Self::WarmRead,
+            5 => Self::WarmWrite,
+            6 => Self::L1dRead,
+            7 => Self::L1dWrite,
+            8 => Self::MshrFlush,
+            9 => Self::InvalidateL1i,
+            10 => Self::FlushL1,
+            _ => return None,
+        })
+    }
+}
+
+/// One decoded trace record.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct MemTraceRecord {
+    /// Requested hierarchy operation.
+    pub kind: MemTraceKind,
+    /// Machine cycle (`stats.cycles`) when the event happened.
+    pub cycle: u64,
+    /// MSHR clock when the event happened.
+    pub clock: u64,
+    /// Physical address (0 for flushes and maintenance).
+    pub addr: u64,
+    /// Access size in bytes (a power of two up to 64), or 0 if not recorded.
+    pub size: u8,
+    /// PC of the instruction that caused the access, where known.
+    pub pc: Option<u64>,
+}
+
+/// Tag bit marking a record that carries a PC.
+const TAG_PC: u8 = 0x80;
+/// Shift of the size field in the tag byte.
+const TAG_SIZE_SHIFT: u8 = 4;
+/// Mask of the kind field in the tag byte.
+const TAG_KIND_MASK: u8 = 0x0F;
+
+/// Delta state shared by the encoder and decoder.
+#[derive(Clone, Copy, Debug, Default)]
+struct Cursor {
+    cycle: u64,
+    clock: u64,
+    addr: u64,
+    pc: u64,
+}
+
+/// Streaming trace encoder.
+#[derive(Debug)]
+pub struct MemTraceWriter<W: Write = BufWriter<File>> {
+    out: W,
+    /// Path the trace is written to (empty for in-memory writers).
+    path: String,
+    prev: Cursor,
+    /// MSHR clock stamped on subsequent records.
+    clock: u64,
+    records: u64,
+    /// First write error; recording stops once set.
+    error: Option<io::Error>,
+}
+
+impl MemTraceWriter {
+    /// Creates the trace file at `path` and writes the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be created or written.
+    pub fn create(path: &str) -> io::Result<Self> {
+        let file = File::create(path)?;
+        let mut writer = Self::new(BufWriter::with_capacity(1 << 20, file))?;
+        path.clone_into(&mut writer.path);
+        Ok(writer)
+    }
+}
+
+impl<W: Write> MemTraceWriter<W> {
+    /// Wraps `out` and writes the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the preamble cannot be written.
+    pub fn new(mut out: W) -> io::Result<Self> {
+        out.write_all(&MAGIC)?;
+        out.write_all(&VERSION.to_le_bytes())?;
+        Ok(Self {
+            out,
+            path: String::new(),
+            prev: Cursor::default(),
+            clock: 0,
+            records: 0,
+            error: None,
+        })
+    }
+
+    /// Path the trace is written to.
+    pub fn path(&self) -> &str {
+        &self.path
+    }
+
+    /// Records written so far.
+    pub const fn records(&self) -> u64 {
+        self.records
+    }
+
+    /// Sets the MSHR clock stamped on subsequent records.
+    #[inline]
+    pub const fn set_clock(&mut self, clock: u64) {
+        self.clock = clock;
+    }
+
+    /// Appends one record at machine cycle `cycle`.
+    ///
+    /// `size` is in bytes; sizes that are not a power of two up to 64 are
+    /// recorded as unknown.
+    pub fn record(
+        &mut self,
+        kind: MemTraceKind,
+        cycle: u64,
+        addr: u64,
+        size: u64,
+        pc: Option<u64>,
+    ) {
+        if self.error.is_some() {
+            return;
+        }
+        let size_code =
+            if size.is_power_of_two() && size <= 64 { size.trailing_zeros() as u8 + 1 } else { 0 };
+        let mut buf = [0u8; 1 + 4 * 10];
+        buf[0] = kind as u8 | (size_code << TAG_SIZE_SHIFT) | if pc.is_some() { TAG_PC } else { 0 };
+        let mut len = 1;
+        len += put_varint(&mut buf[len..], cycle.wrapping_sub(self.prev.cycle));
+        len += put_varint(&mut buf[len..], self.clock.wrapping_sub(self.prev.clock));
+        len += put_varint(&mut buf[len..], zigzag(addr.wrapping_sub(self.prev.addr)));
+        if let Some(pc) = pc {
+            len += put_varint(&mut buf[len..], zigzag(pc.wrapping_sub(self.prev.pc)));
+            self.prev.pc = pc;
+        }
+        self.prev.cycle = cycle;
+        self.prev.clock = self.clock;
+        self.prev.addr = addr;
+        match self.out.write_all(&buf[..len]) {
+            Ok(()) => self.records += 1,
+            Err(e) => self.error = Some(e),
+        }
+    }
+
+    /// Flushes the trace and returns the underlying writer.
+    ///
+    /// # Errors
+    ///
+    /// Returns the first error hit while recording, or the flush error.
+    pub fn finish(mut self) -> io::Result<W> {
+        if let Some(e) = self.error.take() {
+            return Err(e);
+        }
+        self.out.flush()?;
+        Ok(self.out)
+    }
+}
+
+/// Streaming trace decoder.
+#[derive(Debug)]
+pub struct MemTraceReader<R: Read = BufReader<File>> {
+    input: R,
+    prev: Cursor,
+}
+
+impl MemTraceReader {
+    /// Opens the trace file at `path` and checks its preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be read, or
+    /// [`io::ErrorKind::InvalidData`] if it is not a supported trace.
+    pub fn open(path: &str) -> io::Result<Self> {
+        Self::new(BufReader::with_capacity(1 << 20, File::open(path)?))
+    }
+}
+
+impl<R: Read> MemTraceReader<R> {
+    /// Wraps `input` and checks the preamble.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the preamble cannot be read, or
+    /// [`io::ErrorKind::InvalidData`] if it is not a supported trace.
+    pub fn new(mut input: R) -> io::Result<Self> {
+        let mut preamble = [0u8; 12];
+        input.read_exact(&mut preamble)?;
+        if preamble[..8] != MAGIC {
+            return Err(invalid("not an rvsim memory trace"));
+        }
+        let version = u32::from_le_bytes([preamble[8], preamble[9], preamble[10], preamble[11]]);
+        if version != VERSION {
+            return Err(invalid("unsupported memory trace version"));
+        }
+        Ok(Self { input, prev: Cursor::default() })
+    }
+
+    /// Decodes the next record, or `None` at the end of the trace.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error, or [`io::ErrorKind::InvalidData`] for a
+    /// malformed or truncated record.
+    pub fn next_record(&mut self) -> io::Result<Option<MemTraceRecord>> {
+        let mut tag = [0u8; 1];
+        if self.input.read(&mut tag)? == 0 {
+            return Ok(None);
+        }
+        let tag = tag[0];
+        let kind = MemTraceKind::from_bits(tag & TAG_KIND_MASK)
+            .ok_or_else(|| invalid("unknown memory trace record kind"))?;
+        let size_code = (tag & !TAG_PC) >> TAG_SIZE_SHIFT;
+
+        self.prev.cycle = self.prev.cycle.wrapping_add(self.varint()?);
+        self.prev.clock = self.prev.clock.wrapping_add(self.varint()?);
+        self.prev.addr = self.prev.addr.wrapping_add(unzigzag(self.varint()?));
+        let pc = if tag & TAG_PC == 0 {
+            None
+        } else {
+            self.prev.pc = self.prev.pc.wrapping_add(unzigzag(self.varint()?));
+            Some(self.prev.pc)
+        };
+        Ok(Some(MemTraceRecord {
+            kind,
+            cycle: self.prev.cycle,
+            clock: self.prev.clock,
+            addr: self.prev.addr,
+            size: if size_code == 0 { 0 } else { 1 << (size_code - 1) },
+            pc,
+        }))
+    }
+
+    /// Reads one LEB128 value of the current record.
+    fn varint(&mut self) -> io::Result<u64> {
+        read_varint(&mut self.input, "truncated memory trace record")
+    }
+}
+
+/// Reads one LEB128 value from `input`; end of input inside a record is
+/// an error with message `truncated`. Shared with the branch trace.
+pub(super) fn read_varint<R: Read>(input: &mut R, truncated: &str) -> io::Result<u64> {
+    let mut value = 0u64;
+    for shift in (0..64).step_by(7) {
+        let mut byte = [0u8; 1];
+        input.read_exact(&mut byte).map_err(|e| {
+            if e.kind() == io::ErrorKind::UnexpectedEof { invalid(truncated) } else { e }
+        })?;
+        value |= u64::from(byte[0] & 0x7F) << shift;
+        if byte[0] & 0x80 == 0 {
+            return Ok(value);
+        }
+    }
+    Err(invalid("overlong varint in trace record"))
+}
+
+/// An [`io::ErrorKind::InvalidData`] error for a malformed trace.
+pub(super) fn invalid(reason: &str) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, reason)
+}
+
+/// Writes `value` as LEB128 into `buf`, returning the bytes used.
+pub(super) fn put_varint(buf: &mut [u8], mut value: u64) -> usize {
+    let mut len = 0;
+    while value >= 0x80 {
+        buf[len] = (value as u8) | 0x80;
+        value >>= 7;
+        len += 1;
+    }
+    buf[len] = value as u8;
+    len + 1
+}
+
+/// Maps a two's-complement delta to an unsigned value with small magnitudes first.
+pub(super) const fn zigzag(delta: u64) -> u64 {
+    (delta << 1) ^ ((delta as i64 >> 63) as u64)
+}
+
+/// Inverse of [`zigzag`].
+pub(super) const fn unzigzag(value: u64) -> u64 {
+    (value >> 1) ^ (value & 1).wrapping_neg()
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    fn round_trip(records: &[MemTraceRecord]) -> Vec<MemTraceRecord> {
+        let mut writer = MemTraceWriter::new(Vec::new()).unwrap();
+        for r in records {
+            writer.set_clock(r.clock);
+            writer.record(r.kind, r.cycle, r.addr, u64::from(r.size), r.pc);
+        }
+        assert_eq!(writer.records(), records.len() as u64);
+        let bytes = writer.finish().unwrap();
+        let mut reader = MemTraceReader::new(bytes.as_slice()).unwrap();
+        let mut out = Vec::new();
+        while let Some(r) = reader.next_record().unwrap() {
+            out.push(r);
+        }
+        out
+    }
+
+    #[test]
+    fn records_round_trip() {
+        let rec = |kind, cycle, clock, addr, size, pc| MemTraceRecord {
+            kind,
+            cycle,
+            clock,
+            addr,
+            size,
+            pc,
+        };
+        let records = [
+            rec(MemTraceKind::Fetch, 3, 1, 0x8000_0000, 64, Some(0x8000_0000)),
+            rec(MemTraceKind::L1dRead, 9, 7, 0x8000_1000, 8, Some(0x8000_0004)),
+            rec(MemTraceKind::Write, 9, 7, 0x8000_0ff8, 0, None),
+            rec(MemTraceKind::L1dWrite, 12, 10, u64::MAX - 7, 1, Some(0x10)),
+            rec(MemTraceKind::MshrFlush, 12, 11, 0, 0, None),
+            rec(MemTraceKind::WarmRead, u64::MAX, 11, 0, 4, None),
+            rec(MemTraceKind::FlushL1, u64::MAX, 11, 0, 0, None),
+        ];
+        assert_eq!(round_trip(&records), records);
+    }
+
+    #[test]
+    fn sequential_accesses_are_compact() {
+        let mut writer = MemTraceWriter::new(Vec::new()).unwrap();
+        for i in 0..1000u64 {
+            writer.set_clock(i);
+            writer.record(MemTraceKind::L1dRead, i, 0x8000_0000 + 8 * i, 8, Some(0x8000_0100));
+        }
+        let bytes = writer.finish().unwrap();
+        assert!(bytes.len() < 12 + 1000 * 5 + 16, "{} bytes", bytes.len());
+    }
+
+    #[test]
+    fn rejects_foreign_and_truncated_files() {
+        let err = MemTraceReader::new(&b"RVSIMCKP\x01\0\0\0"[..]).unwrap_err();
+        assert_eq!(err.kind(), io::ErrorKind::InvalidData);
+
+        let mut writer = MemTraceWriter::new(Vec::new()).unwrap();
+        writer.record(MemTraceKind::Read, 300, 0x8000_0000, 8, None);
+        let mut bytes = writer.finish().unwrap();
+        let _ = bytes.pop();
+        let mut reader = MemTraceReader::new(bytes.as_slice()).unwrap();
+        assert_eq!(reader.next_record().unwrap_err().kind(), io::ErrorKind::InvalidData);
+    }
+}
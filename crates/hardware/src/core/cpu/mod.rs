@@ -6,31 +6,59 @@
 //! 2. **Memory Hierarchy:** MMU, TLBs, and multi-level cache simulations.
 //! 3. **System Integration:** System bus, devices, and RAM.
 
+/// Retired branch trace capture for offline predictor replay.
+pub mod branchtrace;
+
 /// Control and Status Register access and management.
 pub mod csr;
 
+/// Translated-block tier for the functional engine.
+pub mod dbt;
+
 /// Instruction execution orchestration and pipeline coordination.
 pub mod execution;
 
+/// Functional (atomic) instruction execution for fast-forwarding.
+pub mod functional;
+
 /// Memory access handling and load/store operations.
 pub mod memory;
 
+/// Memory-access trace capture for cache-only replay.
+pub mod memtrace;
+
+/// Cross-hart atomic memory operations for SMP systems.
+pub mod smp;
+
 /// Trap and exception handling logic.
 pub mod trap;
 
+/// Vector instruction execution (RVV).
+pub mod vector;
+
 use crate::common::{PhysAddr, RegisterFile};
-use crate::config::{Config, InclusionPolicy};
+use crate::config::{CacheConfig, Config, InclusionPolicy};
 use crate::core::arch::csr::Csrs;
 use crate::core::arch::mode::PrivilegeMode;
+use crate::core::cpu::branchtrace::{BranchKind, BranchRecord, BranchTraceWriter};
+use crate::core::cpu::dbt::BlockCache;
+use crate::core::cpu::memtrace::MemTraceWriter;
+use crate::core::pipeline::frontend::decode_cache::DecodeCache;
+use crate::core::pipeline::tma::MissTracker;
 use crate::core::pipeline::write_buffer::WriteCombiningBuffer;
 use crate::core::units::bru::BranchPredictorWrapper;
-use crate::core::units::cache::CacheSim;
+use crate::core::units::cache::coherence::CoherenceAgent;
 use crate::core::units::cache::mshr::MshrFile;
+use crate::core::units::cache::stack_distance::StackDistanceProfiler;
+use crate::core::units::cache::{AccessBuffers, CacheSim};
 use crate::core::units::mmu::Mmu;
 use crate::core::units::mmu::pmp::Pmp;
 use crate::core::units::prefetch::PrefetchFilter;
+use crate::core::units::vpu::VectorUnit;
 use crate::soc::System;
+use crate::soc::uncore::AtomicDomain;
 use crate::stats::SimStats;
+use std::sync::{Arc, Mutex};
 
 /// CPU architectural state: registers, caches, MMU, bus, and statistics.
 ///
@@ -49,6 +77,12 @@ pub struct Cpu {
     pub privilege: PrivilegeMode,
     /// Load Reservation address (for LR/SC).
     pub load_reservation: Option<PhysAddr>,
+    /// Value the reserving LR read (SMP only: SC fails if memory no longer holds it).
+    pub reservation_value: u64,
+    /// Hart index, reported by `mhartid`.
+    pub hart_id: usize,
+    /// Atomic domain shared with the other harts (`None` in a single-hart system).
+    pub atomics: Option<Arc<AtomicDomain>>,
 
     /// System Bus and Devices.
     pub bus: System,
@@ -64,14 +98,26 @@ pub struct Cpu {
     pub l2_cache: CacheSim,
     /// L3 Unified Cache.
     pub l3_cache: CacheSim,
+    /// L3 shared by all harts of an SMP system; used in place of `l3_cache` when set.
+    pub shared_l3: Option<Arc<Mutex<CacheSim>>>,
+    /// This hart's view of the coherence directory (`None` in a single-hart system).
+    pub coherence: Option<CoherenceAgent>,
     /// L1D MSHR file for non-blocking cache access (O3 backend only).
     pub l1d_mshrs: MshrFile,
+    /// L2 MSHRs held by L1D misses that missed the L2 (empty unless
+    /// `cache.l2.mshr_count` is set).
+    pub l2_mshrs: MshrFile,
+    /// This hart's L3 MSHRs, held by L1D misses that missed the L3 (empty
+    /// unless `cache.l3.mshr_count` is set).
+    pub l3_mshrs: MshrFile,
     /// Cache inclusion policy (Inclusive / Exclusive / NINE).
     pub inclusion_policy: InclusionPolicy,
     /// Write Combining Buffer for store coalescing.
     pub wcb: WriteCombiningBuffer,
     /// Shared prefetch filter to deduplicate prefetch requests across cache levels.
     pub prefetch_filter: PrefetchFilter,
+    /// Reused eviction/prefetch buffers for cache hierarchy walks.
+    pub cache_buffers: AccessBuffers,
     /// Base address of RAM — addresses at or above this go through the
     /// cache hierarchy for latency simulation; addresses below are MMIO.
     pub cache_base: u64,
@@ -85,6 +131,8 @@ pub struct Cpu {
     pub has_register_renaming: bool,
     /// I-cache line size in bytes (for cache-line-aligned fetch).
     pub i_cache_line_bytes: usize,
+    /// D-cache line size in bytes (for grouping vector element accesses).
+    pub d_cache_line_bytes: usize,
 
     /// Enable instruction tracing.
     pub trace: bool,
@@ -92,6 +140,8 @@ pub struct Cpu {
     pub exit_code: Option<u64>,
     /// Performance statistics.
     pub stats: SimStats,
+    /// Outstanding demand data misses, for top-down memory-bound attribution.
+    pub tma_misses: MissTracker,
     /// Direct mode (no translation, flat memory).
     pub direct_mode: bool,
     /// CLINT time divider.
@@ -116,7 +166,8 @@ pub struct Cpu {
     /// This pointer must maintain the following invariants at all times:
     /// - Points to a valid, allocated memory region of size `(ram_end - ram_start)` bytes
     /// - The memory region remains valid for the entire lifetime of the `Cpu` instance
-    /// - All accesses must verify: `ram_start <= address < ram_end` before dereferencing
+    /// - All accesses must verify that every byte lies in `ram_start..ram_end` before
+    ///   dereferencing (see [`Self::ram_offset`])
     /// - The pointer is valid for both reads and writes (memory is mutable)
     /// - Memory is properly aligned for the underlying allocation (even if individual
     ///   accesses use `read_unaligned`/`write_unaligned`)
@@ -150,6 +201,9 @@ pub struct Cpu {
     /// Trap on misaligned memory accesses instead of handling them natively.
     pub misaligned_access_trap: bool,
 
+    /// Vector register file, configuration CSRs, and timing model (RVV).
+    pub vector: VectorUnit,
+
     /// Cycle at which a kernel panic was first detected (None if not yet detected).
     /// The simulator runs for 100k more cycles after detection to allow the full
     /// panic message to be printed before exiting.
@@ -159,6 +213,36 @@ pub struct Cpu {
     /// hardware signal, so we must track the software component separately.
     pub sw_seip: bool,
 
+    /// Last value written to the simulation marker CSR (`CSR_SIM_MARKER`),
+    /// held until the `Simulator` consumes it after the current tick.
+    pub sim_marker: Option<u64>,
+
+    /// Functional warming: the functional engine trains caches and the branch
+    /// predictor on retired instructions (no timing is modeled).
+    pub functional_warming: bool,
+
+    /// Physical I-cache line last warmed by the functional engine, so each
+    /// line is accessed once per sequential run rather than per instruction.
+    pub warm_fetch_line: Option<u64>,
+
+    /// Host-side cache of decoded instructions shared by the decode stage
+    /// and the functional engine (not modeled; no timing effect).
+    pub decode_cache: DecodeCache,
+
+    /// Translated basic blocks for the functional engine (host-side; no
+    /// timing effect). Allocated only with `fast_forward.dbt`.
+    pub blocks: BlockCache,
+
+    /// Memory-access trace being captured (see [`Self::open_mem_trace`]).
+    pub mem_trace: Option<Box<MemTraceWriter>>,
+
+    /// Retired branch trace being captured (see [`Self::open_branch_trace`]).
+    pub branch_trace: Option<Box<BranchTraceWriter>>,
+
+    /// LRU stack-distance profiler of the L1-D access stream, counting into
+    /// `stats.stack_distance`. Allocated only with `cache.stack_distance`.
+    pub stack_distance: Option<Box<StackDistanceProfiler>>,
+
     /// Optional buffered writer for the commit log (enabled by the `commit-log` feature).
     #[cfg(feature = "commit-log")]
     pub commit_log: Option<std::io::BufWriter<std::fs::File>>,
@@ -212,15 +296,41 @@ impl Cpu {
     /// # Returns
     ///
     /// A new `Cpu` instance initialized according to the provided configuration.
-    pub fn new(mut system: System, config: &Config) -> Self {
+    pub fn new(system: System, config: &Config) -> Self {
+        let cache = &config.cache;
+        let caches = [&cache.l1_i, &cache.l1_d, &cache.l2, &cache.l3].map(CacheSim::new);
+        Self::with_caches(system, config, caches)
+    }
+
+    /// Builds a fresh CPU for `system`, reusing this CPU's cache arrays.
+    ///
+    /// The result is the CPU [`Self::new`] would build: the L1I, L1D, L2,
+    /// and L3 are reset in place (see [`CacheSim::reset`]) instead of being
+    /// reallocated, which dominates construction time for large caches.
+    /// `self` is left with empty placeholder caches and should be dropped.
+    #[must_use]
+    pub fn rebuild(&mut self, system: System, config: &Config) -> Self {
+        let cache = &config.cache;
+        let mut caches =
+            [&mut self.l1_i_cache, &mut self.l1_d_cache, &mut self.l2_cache, &mut self.l3_cache]
+                .map(|c| std::mem::replace(c, CacheSim::new(&CacheConfig::default())));
+        for (c, cfg) in caches.iter_mut().zip([&cache.l1_i, &cache.l1_d, &cache.l2, &cache.l3]) {
+            c.reset(cfg);
+        }
+        Self::with_caches(system, config, caches)
+    }
+
+    /// Builds a CPU around already-constructed L1I, L1D, L2, and L3 caches.
+    fn with_caches(mut system: System, config: &Config, caches: [CacheSim; 4]) -> Self {
         use crate::core::arch::csr::{
             MISA_DEFAULT_RV64IMAFDC, MISA_EXT_A, MISA_EXT_C, MISA_EXT_D, MISA_EXT_F, MISA_EXT_I,
-            MISA_EXT_M, MISA_EXT_S, MISA_EXT_U, MISA_XLEN_64, MSTATUS_DEFAULT_RV64, MSTATUS_FS,
-            MSTATUS_FS_INIT, MSTATUS_MXR, MSTATUS_SIE, MSTATUS_SPIE, MSTATUS_SPP, MSTATUS_SUM,
-            MSTATUS_UXL,
+            MISA_EXT_M, MISA_EXT_S, MISA_EXT_U, MISA_EXT_V, MISA_XLEN_64, MSTATUS_DEFAULT_RV64,
+            MSTATUS_FS, MSTATUS_FS_INIT, MSTATUS_MXR, MSTATUS_SIE, MSTATUS_SPIE, MSTATUS_SPP,
+            MSTATUS_SUM, MSTATUS_UXL, MSTATUS_VS, MSTATUS_VS_INIT,
         };
         use crate::isa::abi;
 
+        let vector_enabled = config.pipeline.vector.enabled;
         let configured_misa = config.pipeline.misa_override.as_ref().map_or_else(
             || {
                 MISA_XLEN_64
@@ -232,6 +342,7 @@ impl Cpu {
                     | MISA_EXT_M
                     | MISA_EXT_S
                     | MISA_EXT_U
+                    | if vector_enabled { MISA_EXT_V } else { 0 }
             },
             |override_str| {
                 let s = override_str.trim_start_matches("0x");
@@ -244,8 +355,13 @@ impl Cpu {
         // In direct (SE) mode, enable FP state so user programs can use
         // floating-point instructions without an OS to set mstatus.FS.
         // In full-system mode, firmware/OS is responsible for enabling FP.
-        let mstatus =
-            if direct_mode { MSTATUS_DEFAULT_RV64 | MSTATUS_FS_INIT } else { MSTATUS_DEFAULT_RV64 };
+        // The same applies to vector state when the V extension is present.
+        let vs_field = if vector_enabled { MSTATUS_VS } else { 0 };
+        let mstatus = if direct_mode {
+            MSTATUS_DEFAULT_RV64 | MSTATUS_FS_INIT | (vs_field & MSTATUS_VS_INIT)
+        } else {
+            MSTATUS_DEFAULT_RV64
+        };
 
         // Initialize sstatus as a view of mstatus (spec: sstatus is not a
         // separate register, it's a restricted view of mstatus).
@@ -253,6 +369,7 @@ impl Cpu {
             | MSTATUS_SPIE
             | MSTATUS_SPP
             | MSTATUS_FS
+            | vs_field
             | MSTATUS_SUM
             | MSTATUS_MXR
             | MSTATUS_UXL;
@@ -266,6 +383,7 @@ impl Cpu {
         };
 
         let bp = BranchPredictorWrapper::new(config);
+        let [l1_i_cache, l1_d_cache, l2_cache, l3_cache] = caches;
 
         let (ram_ptr, ram_start, ram_end) =
             system.bus.get_ram_info().unwrap_or((std::ptr::null_mut(), 0, 0));
@@ -285,6 +403,7 @@ impl Cpu {
             regs,
             pc: config.general.start_pc,
             trace: config.general.trace_instructions,
+            hart_id: system.hart,
             bus: system,
             exit_code: None,
             csrs,
@@ -292,10 +411,13 @@ impl Cpu {
             direct_mode,
             cache_base: config.system.ram_base,
             stats: SimStats::default(),
+            tma_misses: MissTracker::default(),
             branch_predictor: bp,
-            l1_i_cache: CacheSim::new(&config.cache.l1_i),
-            l1_d_cache: CacheSim::new(&config.cache.l1_d),
+            l1_i_cache,
+            l1_d_cache,
             l1d_mshrs: MshrFile::new(config.cache.l1_d.mshr_count, config.cache.l1_d.line_bytes),
+            l2_mshrs: MshrFile::new(config.cache.l2.mshr_count, config.cache.l2.line_bytes),
+            l3_mshrs: MshrFile::new(config.cache.l3.mshr_count, config.cache.l3.line_bytes),
             inclusion_policy: config.cache.inclusion_policy,
             wcb: WriteCombiningBuffer::new(config.cache.wcb_entries, config.cache.l1_d.line_bytes),
             prefetch_filter: PrefetchFilter::new(
@@ -308,21 +430,20 @@ impl Cpu {
                 },
                 config.cache.l1_d.line_bytes,
             ),
-            l2_cache: CacheSim::new(&config.cache.l2),
-            l3_cache: CacheSim::new(&config.cache.l3),
-            mmu: Mmu::new(
-                config.memory.tlb_size,
-                config.memory.l2_tlb_size,
-                config.memory.l2_tlb_ways,
-                config.memory.l2_tlb_latency,
-                config.memory.software_ad_bits,
-            ),
+            l2_cache,
+            l3_cache,
+            shared_l3: None,
+            coherence: None,
+            mmu: Mmu::from_config(&config.memory),
             pmp: Pmp::new(),
             load_reservation: None,
+            reservation_value: 0,
+            atomics: None,
             pipeline_width: config.pipeline.width,
             has_register_renaming: config.pipeline.backend
                 == crate::core::pipeline::engine::BackendType::OutOfOrder,
             i_cache_line_bytes: config.cache.l1_i.line_bytes.max(1),
+            d_cache_line_bytes: config.cache.l1_d.line_bytes.max(1),
             clint_divider: config.system.clint_divider,
             last_pc: 0,
             same_pc_count: 0,
@@ -338,8 +459,26 @@ impl Cpu {
             redirect_pending: false,
             software_ad_bits: config.memory.software_ad_bits,
             misaligned_access_trap: config.memory.misaligned_access_trap,
+            vector: VectorUnit::new(&config.pipeline.vector),
             panic_detected_at_cycle: None,
             sw_seip: false,
+            sim_marker: None,
+            functional_warming: config.general.fast_forward.warm,
+            warm_fetch_line: None,
+            decode_cache: DecodeCache::new(),
+            blocks: BlockCache::new(
+                config.general.fast_forward.enabled && config.general.fast_forward.dbt,
+                ram_start,
+                ram_end,
+            ),
+            cache_buffers: AccessBuffers::default(),
+            mem_trace: None,
+            branch_trace: None,
+            stack_distance: config
+                .cache
+                .stack_distance
+                .enabled
+                .then(|| Box::new(StackDistanceProfiler::new(&config.cache.stack_distance))),
             #[cfg(feature = "commit-log")]
             commit_log: None,
         }
@@ -365,6 +504,102 @@ impl Cpu {
         Ok(())
     }
 
+    /// Starts capturing every cache-hierarchy access to a trace file.
+    ///
+    /// The trace replays through [`crate::sim::replay::replay_mem_trace`]
+    /// under any cache geometry. Any trace already open is finished first.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::MemTraceIo`] if the file cannot be created or the
+    /// previous trace cannot be finished.
+    ///
+    /// [`SimError::MemTraceIo`]: crate::common::SimError::MemTraceIo
+    pub fn open_mem_trace(&mut self, path: &str) -> Result<(), crate::common::SimError> {
+        let _ = self.close_mem_trace()?;
+        let writer = MemTraceWriter::create(path).map_err(|source| {
+            crate::common::SimError::MemTraceIo { path: path.to_owned(), source }
+        })?;
+        self.mem_trace = Some(Box::new(writer));
+        Ok(())
+    }
+
+    /// Stops capturing and flushes the trace, returning the records written.
+    ///
+    /// Returns 0 if no trace was open.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::MemTraceIo`] if any part of the trace could not
+    /// be written.
+    ///
+    /// [`SimError::MemTraceIo`]: crate::common::SimError::MemTraceIo
+    pub fn close_mem_trace(&mut self) -> Result<u64, crate::common::SimError> {
+        let Some(writer) = self.mem_trace.take() else { return Ok(0) };
+        let path = writer.path().to_owned();
+        let records = writer.records();
+        let _ = writer
+            .finish()
+            .map_err(|source| crate::common::SimError::MemTraceIo { path, source })?;
+        Ok(records)
+    }
+
+    /// Starts capturing every retired control-transfer instruction to a
+    /// trace file.
+    ///
+    /// The trace replays through [`crate::sim::replay::replay_branch_trace`]
+    /// against any branch predictor configuration. Any trace already open is
+    /// finished first.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::BranchTraceIo`] if the file cannot be created or
+    /// the previous trace cannot be finished.
+    ///
+    /// [`SimError::BranchTraceIo`]: crate::common::SimError::BranchTraceIo
+    pub fn open_branch_trace(&mut self, path: &str) -> Result<(), crate::common::SimError> {
+        let _ = self.close_branch_trace()?;
+        let writer = BranchTraceWriter::create(path).map_err(|source| {
+            crate::common::SimError::BranchTraceIo { path: path.to_owned(), source }
+        })?;
+        self.branch_trace = Some(Box::new(writer));
+        Ok(())
+    }
+
+    /// Stops capturing and flushes the branch trace, returning the records
+    /// written.
+    ///
+    /// Returns 0 if no trace was open.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::BranchTraceIo`] if any part of the trace could
+    /// not be written.
+    ///
+    /// [`SimError::BranchTraceIo`]: crate::common::SimError::BranchTraceIo
+    pub fn close_branch_trace(&mut self) -> Result<u64, crate::common::SimError> {
+        let Some(writer) = self.branch_trace.take() else { return Ok(0) };
+        let path = writer.path().to_owned();
+        let records = writer.records();
+        let _ = writer
+            .finish()
+            .map_err(|source| crate::common::SimError::BranchTraceIo { path, source })?;
+        Ok(records)
+    }
+
+    /// Appends a retired branch or jump to the branch trace, if one is
+    /// being captured.
+    ///
+    /// `inst` is the expanded instruction; `target` is where it went if it
+    /// was taken.
+    #[inline]
+    pub fn record_branch(&mut self, pc: u64, inst: u32, compressed: bool, target: Option<u64>) {
+        let Some(trace) = self.branch_trace.as_deref_mut() else { return };
+        if let Some(kind) = BranchKind::classify(inst) {
+            trace.record(&BranchRecord { kind, pc, target, compressed });
+        }
+    }
+
     /// Retrieves the exit code if the simulation has finished.
     ///
     /// # Returns
@@ -374,6 +609,18 @@ impl Cpu {
         self.exit_code.take()
     }
 
+    /// Returns the `ram_ptr` offset of a `len`-byte access at physical address `raw`, or
+    /// `None` unless all of it lies in RAM.
+    #[inline]
+    pub const fn ram_offset(&self, raw: u64, len: u64) -> Option<usize> {
+        let offset = raw.wrapping_sub(self.ram_start);
+        if raw >= self.ram_start && offset.saturating_add(len) <= self.ram_end - self.ram_start {
+            Some(offset as usize)
+        } else {
+            None
+        }
+    }
+
     /// Dumps the current CPU state (PC and registers) to stdout.
     pub fn dump_state(&self) {
         println!("PC = {:#018x}", self.pc);
@@ -0,0 +1,160 @@
+//! Cross-Hart Atomics and Coherence.
+//!
+//! In an SMP system every hart runs on its own host thread, so the memory
+//! effect of LR/SC and AMOs must be performed atomically with respect to the
+//! other harts. Both execution engines route them through the hart's
+//! [`AtomicDomain`](crate::soc::uncore::AtomicDomain):
+//! 1. **LR:** Records the reservation in the domain and remembers the loaded value.
+//! 2. **SC:** Under the domain lock, succeeds only if no other hart's SC/AMO hit the
+//!    granule and memory still holds the LR value (catching plain stores, which do
+//!    not take the lock), then writes and invalidates every reservation on the granule.
+//! 3. **AMO:** Under the domain lock, reads, combines, writes, and invalidates.
+//! 4. **Coherence:** Data accesses consult the hart's
+//!    [`CoherenceAgent`](crate::core::units::cache::coherence::CoherenceAgent),
+//!    paying upgrade, invalidation, and transfer latency; probes from other
+//!    harts invalidate or downgrade lines in the private L1-D and L2.
+
+use super::Cpu;
+use crate::common::PhysAddr;
+use crate::core::pipeline::backend::shared::commit::write_store_to_memory;
+use crate::core::pipeline::signals::{AtomicOp, MemWidth};
+use crate::core::units::cache::AccessBuffers;
+use crate::core::units::cache::coherence::{CoherenceAgent, Probe};
+use crate::core::units::lsu::Lsu;
+use std::sync::Arc;
+
+impl Cpu {
+    /// Returns whether atomics must be performed through the SMP atomic domain.
+    #[inline]
+    pub(crate) const fn is_smp(&self) -> bool {
+        self.atomics.is_some()
+    }
+
+    /// Reads an atomic operand, sign-extending words.
+    fn read_atomic_operand(&mut self, paddr: PhysAddr, width: MemWidth) -> u64 {
+        match width {
+            MemWidth::Word => (self.bus.bus.read_u32(paddr) as i32) as i64 as u64,
+            MemWidth::Double => self.bus.bus.read_u64(paddr),
+            _ => 0,
+        }
+    }
+
+    /// Takes a reservation on `paddr` for an LR that read `value`.
+    pub(crate) fn smp_load_reserved(&mut self, paddr: PhysAddr, value: u64) {
+        self.set_reservation(paddr);
+        self.reservation_value = value;
+        if let Some(domain) = &self.atomics {
+            domain.reserve(self.hart_id, Self::align_reservation_address(paddr).val());
+        }
+    }
+
+    /// Performs an SC of `data` to `paddr`. Returns `true` if the store happened.
+    ///
+    /// The local reservation is always released.
+    pub(crate) fn smp_store_conditional(
+        &mut self,
+        paddr: PhysAddr,
+        data: u64,
+        width: MemWidth,
+    ) -> bool {
+        let Some(domain) = self.atomics.as_ref().map(Arc::clone) else {
+            return false;
+        };
+        let granule = Self::align_reservation_address(paddr).val();
+        let _guard = domain.lock();
+        let success = self.check_reservation(paddr)
+            && domain.holds(self.hart_id, granule)
+            && self.read_atomic_operand(paddr, width) == self.reservation_value;
+        self.clear_reservation();
+        if success {
+            write_store_to_memory(self, paddr, data, width);
+            domain.invalidate(granule);
+        }
+        success
+    }
+
+    /// Performs the AMO `op` with `operand` on `paddr`. Returns the old memory value.
+    pub(crate) fn smp_amo(
+        &mut self,
+        op: AtomicOp,
+        paddr: PhysAddr,
+        operand: u64,
+        width: MemWidth,
+    ) -> u64 {
+        let Some(domain) = self.atomics.as_ref().map(Arc::clone) else {
+            return 0;
+        };
+        let granule = Self::align_reservation_address(paddr).val();
+        let _guard = domain.lock();
+        let old = self.read_atomic_operand(paddr, width);
+        write_store_to_memory(self, paddr, Lsu::atomic_alu(op, old, operand, width), width);
+        domain.invalidate(granule);
+        if self.check_reservation(paddr) {
+            self.clear_reservation();
+        }
+        old
+    }
+
+    /// Checks a data access to `addr` against the coherence directory and
+    /// returns the cycles it adds (0 in a single-hart system or with permission).
+    pub(crate) fn coherence_access(&mut self, addr: u64, is_write: bool) -> u64 {
+        let Some(agent) = self.coherence.as_mut() else { return 0 };
+        let event = agent.access(addr, is_write);
+        let probed = !agent.probes.is_empty();
+        if probed {
+            self.apply_coherence_probes();
+        }
+        let Some(event) = event else { return 0 };
+        let stats = &mut self.stats;
+        stats.coherence_misses += u64::from(event.coherence_miss);
+        stats.coherence_upgrades += u64::from(event.upgrade);
+        stats.coherence_transfers += u64::from(event.grant.transfer);
+        stats.coherence_invalidations_sent += u64::from(event.grant.invalidated);
+        stats.coherence_stall_cycles += event.latency;
+        stats.coherence_sharers[(event.grant.peers as usize).min(3)] += 1;
+        event.latency
+    }
+
+    /// Applies probes other harts' requests queued for this hart.
+    pub(crate) fn drain_coherence_probes(&mut self) {
+        if self.coherence.as_mut().is_some_and(CoherenceAgent::poll) {
+            self.apply_coherence_probes();
+        }
+    }
+
+    /// Invalidates the private copies named by the agent's received probes.
+    ///
+    /// Downgrades need no cache action: the simulated caches hold no data,
+    /// and main memory is already up to date.
+    fn apply_coherence_probes(&mut self) {
+        let Some(agent) = self.coherence.as_mut() else { return };
+        let mut probes = std::mem::take(&mut agent.probes);
+        for probe in &probes {
+            if let Probe::Invalidate(line) = *probe {
+                let _ = self.l1_d_cache.invalidate_line(line);
+                let _ = self.l2_cache.invalidate_line(line);
+                self.stats.coherence_invalidations_received += 1;
+            }
+        }
+        probes.clear();
+        if let Some(agent) = self.coherence.as_mut() {
+            agent.probes = probes;
+        }
+    }
+
+    /// Releases lines in `buf.evictions` that are no longer held by any
+    /// private level (a replacement hint to the directory).
+    pub(crate) fn note_private_evictions(&mut self, buf: &AccessBuffers) {
+        for ev in &buf.evictions {
+            self.note_private_eviction(ev.addr);
+        }
+    }
+
+    /// Releases `line` if it left both the L1-D and the L2.
+    pub(crate) fn note_private_eviction(&mut self, line: u64) {
+        let Some(agent) = self.coherence.as_mut() else { return };
+        if !self.l1_d_cache.contains(line) && !self.l2_cache.contains(line) {
+            agent.evicted(agent.line(line));
+        }
+    }
+}
@@ -0,0 +1,443 @@
+//! Vector Instruction Execution.
+//!
+//! Vector instructions pass through the scalar pipeline without side effects
+//! and are executed here, in program order, when they commit (or when the
+//! functional engine retires them). It performs the following:
+//! 1. **Legality:** The V extension must be implemented and `mstatus.VS` not
+//!    Off; floating-point forms also require `mstatus.FS`.
+//! 2. **Configuration:** `vset{i}vl{i}` writes `vl` and `vtype` and returns
+//!    the new `vl` for `rd`.
+//! 3. **Arithmetic:** Delegated to [`VectorUnit::execute_arith`], with the
+//!    scalar operand read from the committed register file.
+//! 4. **Memory:** Unit-stride, strided, indexed, segment, whole-register,
+//!    mask, and fault-only-first accesses are split into element accesses,
+//!    each translated by the MMU and performed on RAM or the bus. A fault
+//!    records the faulting element in `vstart` so the access can resume.
+//! 5. **Timing:** In the detailed pipeline each distinct cache line of a
+//!    memory access is looked up in the cache hierarchy, and every operation
+//!    is scheduled on the vector unit's timing model.
+//!
+//! [`VectorUnit::execute_arith`]: crate::core::units::vpu::VectorUnit::execute_arith
+
+use super::Cpu;
+use crate::common::{AccessType, PhysAddr, RegIdx, Trap};
+use crate::core::arch::csr;
+use crate::core::arch::mode::PrivilegeMode;
+use crate::core::pipeline::backend::shared::commit::write_store_to_memory;
+use crate::core::pipeline::signals::{ControlSignals, MemWidth, VectorOp};
+use crate::core::units::lsu::unaligned;
+use crate::core::units::vpu::NUM_VREGS;
+use crate::core::units::vpu::timing::Footprint;
+use crate::isa::rvv::opcodes::{
+    LUMOP_FAULT_FIRST, LUMOP_MASK, LUMOP_UNIT, LUMOP_WHOLE_REG, MOP_INDEXED_ORDERED,
+    MOP_INDEXED_UNORDERED, MOP_STRIDED, MOP_UNIT, OPFVF, OPFVV, OPIVX, OPMVX, width_bits,
+};
+
+/// Largest register group a memory access may touch (`EMUL · NFIELDS`).
+const MAX_GROUP_REGS: usize = 8;
+
+/// Address of element `i` relative to the base register.
+#[derive(Clone, Copy, Debug)]
+enum Addressing {
+    /// `i · stride` bytes.
+    Stride(u64),
+    /// The zero-extended element `i` of an index register group.
+    Index { reg: usize, eew: u32 },
+}
+
+/// Element accesses performed by a vector load or store.
+#[derive(Clone, Copy, Debug)]
+struct Shape {
+    /// First data register.
+    vd: usize,
+    /// Store (otherwise load).
+    is_store: bool,
+    /// Effective vector length (elements per field).
+    evl: u64,
+    /// Data element width in bits.
+    eew: u32,
+    /// Registers per field (EMUL).
+    regs: usize,
+    /// Number of segment fields.
+    nf: usize,
+    addressing: Addressing,
+    /// Elements are masked by `v0`.
+    masked: bool,
+    /// Fault-only-first: a fault past element 0 trims `vl` instead of trapping.
+    fault_first: bool,
+}
+
+/// Maps an element width in bits to the scalar memory width.
+const fn mem_width(eew: u32) -> MemWidth {
+    match eew {
+        8 => MemWidth::Byte,
+        16 => MemWidth::Half,
+        32 => MemWidth::Word,
+        _ => MemWidth::Double,
+    }
+}
+
+impl Cpu {
+    /// Executes the vector instruction `inst` classified as `op`.
+    ///
+    /// `timed` selects the detailed pipeline: cache lines are accessed with
+    /// timing and the operation is scheduled on the vector timing model.
+    /// Otherwise caches are only warmed (when functional warming is on).
+    ///
+    /// Returns the value for a scalar destination register (`vsetvl`,
+    /// `vmv.x.s`, `vcpop.m`, `vfirst.m`, `vfmv.f.s`), if any.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`Trap::IllegalInstruction`] if vector (or, for floating-point
+    /// forms, FP) state is off or the encoding is reserved, and the
+    /// translation, access, or misalignment fault of a memory element.
+    pub fn execute_vector(
+        &mut self,
+        pc: u64,
+        inst: u32,
+        op: VectorOp,
+        timed: bool,
+    ) -> Result<Option<u64>, Trap> {
+        if op == VectorOp::None {
+            return Ok(None);
+        }
+        let vs = self.csrs.mstatus & csr::MSTATUS_VS;
+        if !self.vector.enabled || vs == 0 {
+            return Err(Trap::IllegalInstruction(inst));
+        }
+        let result = match op {
+            VectorOp::SetVl => {
+                let rs1 = self.regs.read(rs1_field(inst));
+                let rs2 = self.regs.read(rs2_field(inst));
+                let (vl, vtype) = self.vector.vsetvl_result(inst, rs1, rs2);
+                self.vector.vl = vl;
+                self.vector.vtype = vtype;
+                self.vector.vstart = 0;
+                Some(vl)
+            }
+            VectorOp::Arith => self.execute_vector_arith(inst, timed)?,
+            VectorOp::Load | VectorOp::Store => {
+                self.execute_vector_mem(pc, inst, op == VectorOp::Store, timed)?;
+                None
+            }
+            VectorOp::None => None,
+        };
+        self.mark_vs_dirty();
+        Ok(result)
+    }
+
+    /// Returns true if the vector instruction at the ROB head can commit at
+    /// the current cycle.
+    ///
+    /// Operations wait for a free vector queue slot; an operation with a
+    /// scalar destination also waits until its vector sources are written,
+    /// since the scalar result is needed at commit.
+    pub fn vector_commit_ready(&mut self, inst: u32, ctrl: &ControlSignals) -> bool {
+        let now = self.stats.cycles;
+        match ctrl.vector {
+            VectorOp::None | VectorOp::SetVl => true,
+            VectorOp::Load | VectorOp::Store => !self.vector.timing.is_full(now),
+            VectorOp::Arith => {
+                if self.vector.timing.is_full(now) {
+                    return false;
+                }
+                if !(ctrl.reg_write || ctrl.fp_reg_write) {
+                    return true;
+                }
+                let timing = &self.vector.timing;
+                let masked = (inst >> 25) & 1 == 0;
+                timing.is_ready(rs2_field(inst).as_usize(), now)
+                    && (!masked || timing.is_ready(0, now))
+            }
+        }
+    }
+
+    /// Sets `mstatus.VS`/`sstatus.VS` to DIRTY after a vector state change.
+    pub(super) const fn mark_vs_dirty(&mut self) {
+        self.csrs.mstatus = (self.csrs.mstatus & !csr::MSTATUS_VS) | csr::MSTATUS_VS_DIRTY;
+        self.csrs.sstatus = (self.csrs.sstatus & !csr::MSTATUS_VS) | csr::MSTATUS_VS_DIRTY;
+    }
+
+    /// Executes an `OP-V` arithmetic instruction.
+    fn execute_vector_arith(&mut self, inst: u32, timed: bool) -> Result<Option<u64>, Trap> {
+        let funct3 = (inst >> 12) & 0x7;
+        let is_fp = matches!(funct3, OPFVV | OPFVF);
+        if is_fp && self.csrs.mstatus & csr::MSTATUS_FS == 0 {
+            return Err(Trap::IllegalInstruction(inst));
+        }
+        let scalar = match funct3 {
+            OPIVX | OPMVX => self.regs.read(rs1_field(inst)),
+            OPFVF => self.regs.read_f(rs1_field(inst)),
+            _ => 0,
+        };
+
+        let out = self.vector.execute_arith(inst, scalar)?;
+        if out.fp_flags != 0 {
+            self.csrs.fflags |= u64::from(out.fp_flags);
+            self.mark_fs_dirty();
+        }
+        if timed {
+            let _ = self.vector.timing.issue_arith(
+                self.stats.cycles,
+                out.class,
+                &out.footprint,
+                out.elements,
+                out.width,
+            );
+        }
+        self.stats.vector_elements += out.elements;
+        Ok(out.scalar)
+    }
+
+    /// Decodes the element accesses of a vector load or store.
+    fn vector_mem_shape(&self, inst: u32, is_store: bool) -> Option<Shape> {
+        let vd = ((inst >> 7) & 0x1F) as usize;
+        let umop = (inst >> 20) & 0x1F;
+        let masked = (inst >> 25) & 1 == 0;
+        let mop = (inst >> 26) & 0x3;
+        let mew = (inst >> 28) & 1;
+        let nf = ((inst >> 29) & 0x7) as usize + 1;
+        let width = width_bits((inst >> 12) & 0x7);
+        let vtype = self.vector.vtype;
+        if mew != 0 {
+            return None;
+        }
+
+        let shape = match (mop, umop) {
+            (MOP_UNIT, LUMOP_WHOLE_REG) => {
+                // vl<nf>r / vs<nf>r: nf whole registers, independent of vtype.
+                if masked || !nf.is_power_of_two() || !vd.is_multiple_of(nf) {
+                    return None;
+                }
+                let evl = (nf * self.vector.vlen()) as u64 / u64::from(width);
+                let stride = u64::from(width / 8);
+                Shape {
+                    vd,
+                    is_store,
+                    evl,
+                    eew: width,
+                    regs: nf,
+                    nf: 1,
+                    addressing: Addressing::Stride(stride),
+                    masked: false,
+                    fault_first: false,
+                }
+            }
+            _ if vtype.vill => return None,
+            (MOP_UNIT, LUMOP_MASK) => {
+                if masked || nf != 1 || width != 8 {
+                    return None;
+                }
+                Shape {
+                    vd,
+                    is_store,
+                    evl: self.vector.vl.div_ceil(8),
+                    eew: 8,
+                    regs: 1,
+                    nf: 1,
+                    addressing: Addressing::Stride(1),
+                    masked: false,
+                    fault_first: false,
+                }
+            }
+            (MOP_UNIT, LUMOP_UNIT | LUMOP_FAULT_FIRST) | (MOP_STRIDED, _) => {
+                let fault_first = mop == MOP_UNIT && umop == LUMOP_FAULT_FIRST;
+                if fault_first && is_store {
+                    return None;
+                }
+                let stride = if mop == MOP_STRIDED {
+                    self.regs.read(rs2_field(inst))
+                } else {
+                    (nf as u64) * u64::from(width / 8)
+                };
+                Shape {
+                    vd,
+                    is_store,
+                    evl: self.vector.vl,
+                    eew: width,
+                    regs: vtype.group_regs(width)?,
+                    nf,
+                    addressing: Addressing::Stride(stride),
+                    masked,
+                    fault_first,
+                }
+            }
+            (MOP_INDEXED_UNORDERED | MOP_INDEXED_ORDERED, _) => {
+                // Data elements are SEW wide; the width field sizes the indices.
+                let index_regs = vtype.group_regs(width)?;
+                let index = umop as usize;
+                if !index.is_multiple_of(index_regs) {
+                    return None;
+                }
+                Shape {
+                    vd,
+                    is_store,
+                    evl: self.vector.vl,
+                    eew: vtype.sew,
+                    regs: vtype.group_regs(vtype.sew)?,
+                    nf,
+                    addressing: Addressing::Index { reg: index, eew: width },
+                    masked,
+                    fault_first: false,
+                }
+            }
+            _ => return None,
+        };
+
+        let group = shape.regs * shape.nf;
+        let legal = group <= MAX_GROUP_REGS
+            && vd + group <= NUM_VREGS
+            && vd.is_multiple_of(shape.regs)
+            && !(shape.masked && vd == 0 && !is_store);
+        legal.then_some(shape)
+    }
+
+    /// Executes a vector load or store element by element.
+    fn execute_vector_mem(
+        &mut self,
+        pc: u64,
+        inst: u32,
+        is_store: bool,
+        timed: bool,
+    ) -> Result<(), Trap> {
+        let shape = self.vector_mem_shape(inst, is_store).ok_or(Trap::IllegalInstruction(inst))?;
+        let base = self.regs.read(rs1_field(inst));
+        let access = if is_store { AccessType::Write } else { AccessType::Read };
+        let width = mem_width(shape.eew);
+        let bytes = u64::from(shape.eew / 8);
+        let line_bytes = self.d_cache_line_bytes as u64;
+
+        // First physical address touched in each run of accesses to one line.
+        let mut lines: Vec<PhysAddr> = Vec::new();
+        let mut elements = 0;
+        for i in self.vector.vstart..shape.evl {
+            let idx = i as usize;
+            if shape.masked && !self.vector.mask_bit(0, idx) {
+                continue;
+            }
+            let offset = match shape.addressing {
+                Addressing::Stride(stride) => i.wrapping_mul(stride),
+                Addressing::Index { reg, eew } => self.vector.read_elem(reg, idx, eew),
+            };
+            for field in 0..shape.nf {
+                let vaddr = base.wrapping_add(offset).wrapping_add(field as u64 * bytes);
+                let paddr = match self.vector_element_paddr(vaddr, access, bytes) {
+                    Ok(paddr) => paddr,
+                    Err(_) if shape.fault_first && i > 0 => {
+                        // Fault-only-first: keep the elements loaded so far.
+                        self.vector.vl = i;
+                        self.finish_vector_mem(pc, &shape, &lines, elements, timed);
+                        return Ok(());
+                    }
+                    Err(trap) => {
+                        self.vector.vstart = i;
+                        return Err(trap);
+                    }
+                };
+                let line = paddr.val() / line_bytes;
+                if lines.last().is_none_or(|last| last.val() / line_bytes != line) {
+                    lines.push(paddr);
+                }
+
+                let reg = shape.vd + field * shape.regs;
+                if is_store {
+                    let data = self.vector.read_elem(reg, idx, shape.eew);
+                    if self.check_reservation(paddr) {
+                        self.clear_reservation();
+                    }
+                    write_store_to_memory(self, paddr, data, width);
+                } else {
+                    let data = self.read_phys_load(paddr, width, false);
+                    self.vector.write_elem(reg, idx, shape.eew, data);
+                }
+            }
+            elements += 1;
+        }
+        self.finish_vector_mem(pc, &shape, &lines, elements, timed);
+        Ok(())
+    }
+
+    /// Translates one element address and checks the physical access.
+    fn vector_element_paddr(
+        &mut self,
+        vaddr: u64,
+        access: AccessType,
+        bytes: u64,
+    ) -> Result<PhysAddr, Trap> {
+        let is_store = access == AccessType::Write;
+        if self.misaligned_access_trap && !unaligned::is_aligned(vaddr, bytes) {
+            return Err(if is_store {
+                unaligned::store_misaligned_trap(vaddr)
+            } else {
+                unaligned::load_misaligned_trap(vaddr)
+            });
+        }
+        let paddr = self.translate_functional(vaddr, access, bytes)?;
+        // Unmapped regions fault for S/U-mode; M-mode probes read the bus default.
+        if self.privilege != PrivilegeMode::Machine && !self.bus.bus.is_valid_address(paddr) {
+            return Err(if is_store {
+                Trap::StoreAccessFault(vaddr)
+            } else {
+                Trap::LoadAccessFault(vaddr)
+            });
+        }
+        Ok(paddr)
+    }
+
+    /// Accounts the cache lines of a completed vector memory access.
+    fn finish_vector_mem(
+        &mut self,
+        pc: u64,
+        shape: &Shape,
+        lines: &[PhysAddr],
+        elements: u64,
+        timed: bool,
+    ) {
+        let access = if shape.is_store { AccessType::Write } else { AccessType::Read };
+        let line_bytes = self.d_cache_line_bytes as u64;
+        let mut latency = 0;
+        for &paddr in lines {
+            if paddr.val() < self.cache_base {
+                continue;
+            }
+            if timed {
+                latency =
+                    latency.max(self.simulate_memory_access_at(paddr, access, pc, line_bytes));
+            } else if self.functional_warming {
+                self.warm_memory_access(paddr, access);
+            }
+        }
+
+        if timed {
+            let group = shape.regs * shape.nf;
+            let mut fp = Footprint::default();
+            if shape.is_store {
+                fp.read(shape.vd, group);
+            } else {
+                fp.write(shape.vd, group);
+            }
+            if shape.masked {
+                fp.read(0, 1);
+            }
+            if let Addressing::Index { reg, eew } = shape.addressing {
+                fp.read(reg, self.vector.vtype.group_regs(eew).unwrap_or(1));
+            }
+            let _ =
+                self.vector.timing.issue_mem(self.stats.cycles, &fp, lines.len() as u64, latency);
+        }
+        self.vector.vstart = 0;
+        self.stats.vector_elements += elements;
+        self.stats.vector_mem_lines += lines.len() as u64;
+    }
+}
+
+/// The `rs1` field of an instruction.
+const fn rs1_field(inst: u32) -> RegIdx {
+    RegIdx::new(((inst >> 15) & 0x1F) as u8)
+}
+
+/// The `rs2` field of an instruction (`vs2` for vector instructions).
+const fn rs2_field(inst: u32) -> RegIdx {
+    RegIdx::new(((inst >> 20) & 0x1F) as u8)
+}
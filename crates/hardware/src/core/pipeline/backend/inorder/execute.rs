@@ -8,7 +8,9 @@ use crate::core::Cpu;
 use crate::core::pipeline::latches::{ExMem1Entry, RenameIssueEntry};
 use crate::core::pipeline::prf::PhysReg;
 use crate::core::pipeline::rob::{BpOutcome, CsrUpdate, Rob};
-use crate::core::pipeline::signals::{AluOp, ControlFlow, CsrOp, OpASrc, OpBSrc, SystemOp};
+use crate::core::pipeline::signals::{
+    AluOp, ControlFlow, CsrOp, OpASrc, OpBSrc, SystemOp, VectorOp,
+};
 use crate::core::units::alu::Alu;
 use crate::core::units::bru::BranchPredictor;
 use crate::core::units::fpu::Fpu;
@@ -27,21 +29,24 @@ const JALR_ALIGNMENT_MASK: u64 = !1;
 /// and produces `ExMem1Entry` results. CSR writes and `MRET`/`SRET` are recorded
 /// in the ROB for deferred application at commit.
 ///
-/// Returns `(results, needs_frontend_flush)`. When `needs_frontend_flush` is true,
-/// the engine must flush the issue queue and frontend (branch misprediction,
-/// CSR, MRET/SRET, FENCE.I, etc.).
+/// Drains `entries` and appends the results to `results`. Returns
+/// `needs_frontend_flush`: when true, the engine must flush the issue queue
+/// and frontend (branch misprediction, CSR, MRET/SRET, FENCE.I, etc.).
 pub fn execute_inorder(
     cpu: &mut Cpu,
-    entries: Vec<RenameIssueEntry>,
+    entries: &mut Vec<RenameIssueEntry>,
+    results: &mut Vec<ExMem1Entry>,
     rob: &mut Rob,
     inflight_fp_flags: u8,
-) -> (Vec<ExMem1Entry>, bool) {
-    let mut results = Vec::with_capacity(entries.len());
+) -> bool {
     let mut flush_remaining = false;
     // Accumulates fp_flags from FP instructions executed in this batch,
     // so a later CSR read of fflags in the same cycle sees them.
     let mut batch_fp_flags: u8 = 0;
 
+    // Drained rather than consumed so the buffer keeps its capacity.
+    #[allow(clippy::iter_with_drain)]
+    let entries = entries.drain(..);
     for id in entries {
         if flush_remaining {
             break;
@@ -630,6 +635,13 @@ pub fn execute_inorder(
 
         // ALU / FPU execution
         let (alu_out, fp_flags) = compute_alu(id.ctrl.alu, op_a, op_b, op_c, id.ctrl.is_rv32);
+        // vset{i}vl{i}: predict the new vl from the committed vtype state; commit
+        // re-executes it and replays younger instructions if the value differs.
+        let alu_out = if id.ctrl.vector == VectorOp::SetVl {
+            cpu.vector.vsetvl_result(id.inst, fwd_a, fwd_b).0
+        } else {
+            alu_out
+        };
 
         // FP exception flags are deferred to commit via the ROB entry
         // (applied by commit_stage in shared/commit.rs).
@@ -754,12 +766,18 @@ pub fn execute_inorder(
         });
     }
 
-    (results, flush_remaining)
+    flush_remaining
 }
 
 /// Computes the ALU/FPU result and returns `(result, fp_flags)`.
 /// `fp_flags` is non-zero only for floating-point arithmetic operations.
-fn compute_alu(alu_op: AluOp, op_a: u64, op_b: u64, op_c: u64, is_rv32: bool) -> (u64, u8) {
+pub(crate) fn compute_alu(
+    alu_op: AluOp,
+    op_a: u64,
+    op_b: u64,
+    op_c: u64,
+    is_rv32: bool,
+) -> (u64, u8) {
     // FP conversions and moves that need special handling.
     // Int-to-float and float-to-float conversions can raise FP exception
     // flags (INEXACT, OVERFLOW, etc.), so we use the host FPU to detect them.
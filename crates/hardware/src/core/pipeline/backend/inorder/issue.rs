@@ -8,6 +8,7 @@
 
 use crate::common::RegIdx;
 use crate::core::Cpu;
+use crate::core::pipeline::engine::lanes;
 use crate::core::pipeline::latches::RenameIssueEntry;
 use crate::core::pipeline::rob::{Rob, RobState, RobTag};
 use crate::core::pipeline::signals::SystemOp;
@@ -36,8 +37,11 @@ impl InOrderIssueUnit {
         Self { queue: VecDeque::with_capacity(capacity), capacity }
     }
 
-    /// Accept dispatched instructions from rename.
-    pub fn dispatch(&mut self, entries: Vec<RenameIssueEntry>) {
+    /// Accept dispatched instructions from rename, draining `entries`.
+    pub fn dispatch(&mut self, entries: &mut Vec<RenameIssueEntry>) {
+        // Drained rather than consumed so the latch keeps its capacity.
+        #[allow(clippy::iter_with_drain)]
+        let entries = entries.drain(..);
         for entry in entries {
             debug_assert!(
                 self.queue.len() < self.capacity,
@@ -54,20 +58,20 @@ impl InOrderIssueUnit {
     }
 
     /// Select instructions to execute this cycle, reading operands via
-    /// tags captured at rename time. Returns up to `width` entries with
-    /// operands populated.
+    /// tags captured at rename time. Appends up to `width` entries with
+    /// operands populated to `selected` (`W` entries when specialized, see
+    /// [`lanes`]).
     ///
     /// In-order: if the head-of-queue is blocked, nothing behind it can issue.
-    pub fn select(
+    pub fn select<const W: usize>(
         &mut self,
         width: usize,
         rob: &Rob,
         store_buffer: &StoreBuffer,
         cpu: &Cpu,
-    ) -> Vec<RenameIssueEntry> {
-        let mut selected = Vec::with_capacity(width);
-
-        for _ in 0..width {
+        selected: &mut Vec<RenameIssueEntry>,
+    ) {
+        for _ in 0..lanes::<W>(width) {
             let Some(entry) = self.queue.front() else { break };
 
             // Faulted instructions don't need operands — pass through
@@ -81,8 +85,12 @@ impl InOrderIssueUnit {
             // ── Serialization checks (matching O3 issue queue) ──────────
 
             // System/CSR instructions are serializing: wait for all older
-            // instructions to complete before issuing.
-            if entry.ctrl.system_op != SystemOp::None && !rob.all_before_completed(entry.rob_tag) {
+            // instructions to complete (and older vector instructions, which
+            // take effect at commit, to retire) before issuing.
+            if entry.ctrl.system_op != SystemOp::None
+                && (!rob.all_before_completed(entry.rob_tag)
+                    || rob.has_vector_before(entry.rob_tag))
+            {
                 break;
             }
 
@@ -141,8 +149,6 @@ impl InOrderIssueUnit {
                 break;
             }
         }
-
-        selected
     }
 
     /// Return a snapshot of the current issue queue contents (front = oldest).
@@ -150,6 +156,11 @@ impl InOrderIssueUnit {
         self.queue.iter().cloned().collect()
     }
 
+    /// Visits the `n` oldest entries, oldest first, without allocating.
+    pub fn for_each_oldest(&self, n: usize, f: impl FnMut(&RenameIssueEntry)) {
+        self.queue.iter().take(n).for_each(f);
+    }
+
     /// How many slots are available for dispatch?
     pub fn available_slots(&self) -> usize {
         self.capacity - self.queue.len()
@@ -18,37 +18,18 @@ use crate::core::pipeline::rob::Rob;
 use crate::core::pipeline::scoreboard::Scoreboard;
 use crate::core::pipeline::store_buffer::StoreBuffer;
 use crate::core::units::bru::BranchPredictor;
+use crate::stats::{Stage, StageTimer};
 
 /// Drain completed MSHRs: install cache lines in L1D and resume parked
 /// loads/atomics into the mem1→mem2 latch.  Mirrors the O3 backend's
 /// MSHR completion logic but without PRF/wakeup handling.
 fn drain_mshr_completions(cpu: &mut Cpu, mem1_mem2: &mut Vec<Mem1Mem2Entry>, now: u64) {
-    if cpu.l1d_mshrs.capacity() == 0 {
-        return;
-    }
-    let completed = cpu.l1d_mshrs.drain_completions(now);
-    for mshr_entry in completed {
-        let (_penalty, evicted) = cpu.l1_d_cache.install_line_public_tracked(
-            mshr_entry.line_addr,
-            mshr_entry.is_write,
-            0,
-        );
-
-        if cpu.inclusion_policy == crate::config::InclusionPolicy::Exclusive
-            && cpu.l2_cache.enabled
-            && let Some(ev) = evicted
-        {
-            let _ = cpu.l2_cache.install_or_replace(ev.addr, ev.dirty, 0);
-            cpu.stats.exclusive_l1_to_l2_swaps += 1;
-        }
-
-        for waiter in mshr_entry.waiters {
-            if let Some(mut parked) = waiter.parked_entry {
-                parked.complete_cycle = now;
-                mem1_mem2.push(parked);
-            }
+    cpu.drain_mshr_fills(now, |waiter| {
+        if let Some(mut parked) = waiter.parked_entry {
+            parked.complete_cycle = now;
+            mem1_mem2.push(parked);
         }
-    }
+    });
 }
 
 use self::issue::InOrderIssueUnit;
@@ -74,6 +55,12 @@ pub struct InOrderEngine {
     pub mem2_wb: Vec<Mem2WbEntry>,
     /// Memory1 stall counter (D-TLB / D-cache latency).
     pub mem1_stall: u64,
+    /// Instructions selected for execute this cycle (kept to reuse its storage).
+    selected: Vec<RenameIssueEntry>,
+    /// Empty buffer that Memory1 swaps `execute_mem1` into and consumes.
+    mem1_scratch: Vec<ExMem1Entry>,
+    /// Empty buffer that Memory2 swaps `mem1_mem2` into and consumes.
+    mem2_scratch: Vec<Mem1Mem2Entry>,
     /// Current cycle counter (for MSHR completion tracking).
     cycle: u64,
     /// Committed rename map stub (unused; required by shared `commit_stage` signature).
@@ -95,6 +82,9 @@ impl InOrderEngine {
             mem1_mem2: Vec::with_capacity(config.pipeline.width),
             mem2_wb: Vec::with_capacity(config.pipeline.width),
             mem1_stall: 0,
+            selected: Vec::with_capacity(config.pipeline.width),
+            mem1_scratch: Vec::with_capacity(config.pipeline.width),
+            mem2_scratch: Vec::with_capacity(config.pipeline.width),
             cycle: 0,
             committed_rename_map: RenameMap::new(),
             free_list: FreeList::new(0, 0),
@@ -103,7 +93,7 @@ impl InOrderEngine {
 }
 
 impl ExecutionEngine for InOrderEngine {
-    fn tick(&mut self, cpu: &mut Cpu, rename_output: &mut Vec<RenameIssueEntry>) {
+    fn tick<const W: usize>(&mut self, cpu: &mut Cpu, rename_output: &mut Vec<RenameIssueEntry>) {
         // Backend stages run in reverse order (drain from commit to issue)
         self.cycle += 1;
 
@@ -114,7 +104,8 @@ impl ExecutionEngine for InOrderEngine {
         let pc_before_commit = cpu.pc;
 
         // Commit: retire from ROB head
-        let trap_event = commit::commit_stage(
+        let timer = StageTimer::start();
+        let trap_event = commit::commit_stage::<W>(
             cpu,
             &mut self.rob,
             &mut self.store_buffer,
@@ -126,6 +117,7 @@ impl ExecutionEngine for InOrderEngine {
             None, // in-order backend: no PRF
             None, // in-order backend: no checkpoints
         );
+        timer.stop(&mut cpu.stats.stage_times, Stage::Commit);
 
         // Handle trap: flush everything
         if let Some((trap, pc)) = trap_event {
@@ -146,30 +138,38 @@ impl ExecutionEngine for InOrderEngine {
         }
 
         // Writeback: mark ROB entries as Completed
+        let timer = StageTimer::start();
         writeback::writeback_stage(cpu, &mut self.mem2_wb, &mut self.rob);
+        timer.stop(&mut cpu.stats.stage_times, Stage::Writeback);
 
         // Memory2: D-cache access / store buffer resolution
+        let timer = StageTimer::start();
         let _ = memory2::memory2_stage(
             cpu,
             &mut self.mem1_mem2,
+            &mut self.mem2_scratch,
             &mut self.mem2_wb,
             &mut self.store_buffer,
             &mut self.rob,
             None, // in-order backend: no load queue
         );
+        timer.stop(&mut cpu.stats.stage_times, Stage::Memory2);
 
         // Memory1: address translation (gated by mem1_stall)
         if self.mem1_stall > 0 {
             self.mem1_stall -= 1;
             cpu.stats.stalls_mem += 1;
         } else {
+            let timer = StageTimer::start();
             let _ = memory1::memory1_stage(
                 cpu,
                 &mut self.execute_mem1,
+                &mut self.mem1_scratch,
                 &mut self.mem1_mem2,
                 self.cycle,
                 None, // in-order backend: no load queue
             );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Memory1);
             // Derive stall from the worst-case entry's complete_cycle
             self.mem1_stall = self
                 .mem1_mem2
@@ -184,11 +184,19 @@ impl ExecutionEngine for InOrderEngine {
         let backpressured = !self.execute_mem1.is_empty();
 
         // Issue + Execute: select and read operands via tags
-        let (results, needs_flush) = if backpressured {
-            (Vec::new(), false)
+        let needs_flush = if backpressured {
+            false
         } else {
-            let issued = self.issuer.select(self.width, &self.rob, &self.store_buffer, cpu);
-            if issued.is_empty() && !self.issuer.is_empty() {
+            let timer = StageTimer::start();
+            self.issuer.select::<W>(
+                self.width,
+                &self.rob,
+                &self.store_buffer,
+                cpu,
+                &mut self.selected,
+            );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Issue);
+            if self.selected.is_empty() && !self.issuer.is_empty() {
                 cpu.stats.stalls_data += 1;
             }
             // Accumulate fp_flags from in-flight pipeline entries that
@@ -204,9 +212,17 @@ impl ExecutionEngine for InOrderEngine {
             for e in &self.mem2_wb {
                 inflight_fp_flags |= e.fp_flags;
             }
-            execute::execute_inorder(cpu, issued, &mut self.rob, inflight_fp_flags)
+            let timer = StageTimer::start();
+            let needs_flush = execute::execute_inorder(
+                cpu,
+                &mut self.selected,
+                &mut self.execute_mem1,
+                &mut self.rob,
+                inflight_fp_flags,
+            );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Execute);
+            needs_flush
         };
-        self.execute_mem1.extend(results);
 
         // If execute detected a misprediction / CSR / MRET / SRET / FENCE.I,
         // flush the issue queue, any pending rename output, and the inter-stage
@@ -256,13 +272,23 @@ impl ExecutionEngine for InOrderEngine {
         // the excess entries are silently dropped, leaving their ROB slots
         // permanently stuck in Issued state and deadlocking the pipeline.
         if !needs_flush {
-            let rename_entries = std::mem::take(rename_output);
-            if !rename_entries.is_empty() {
-                self.issuer.dispatch(rename_entries);
-            }
+            self.issuer.dispatch(rename_output);
         }
     }
 
+    fn is_idle(&self, cpu: &Cpu) -> bool {
+        self.mem1_stall == 0
+            && self.issuer.is_empty()
+            && self.execute_mem1.is_empty()
+            && self.mem1_mem2.is_empty()
+            && self.mem2_wb.is_empty()
+            && cpu.l1d_mshrs.active_count() == 0
+    }
+
+    fn advance_idle(&mut self, cycles: u64) {
+        self.cycle += cycles;
+    }
+
     fn can_accept(&self) -> usize {
         let rob_free = self.rob.free_slots();
         let sb_free = self.store_buffer.free_slots();
@@ -280,7 +306,7 @@ impl ExecutionEngine for InOrderEngine {
         self.mem2_wb.clear();
         self.mem1_stall = 0;
         // Flush all MSHRs — their parked entries are now invalid
-        cpu.l1d_mshrs.flush();
+        cpu.flush_mshrs();
         // Reset speculative GHR to committed state — wrong-path branch
         // outcomes may have been pushed into the speculative history.
         cpu.branch_predictor.repair_to_committed();
@@ -315,6 +341,10 @@ impl ExecutionEngine for InOrderEngine {
     fn scoreboard_mut(&mut self) -> &mut Scoreboard {
         &mut self.scoreboard
     }
+
+    fn mem_stalled(&self) -> bool {
+        self.mem1_stall > 0
+    }
 }
 
 #[cfg(test)]
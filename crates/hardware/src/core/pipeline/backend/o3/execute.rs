@@ -13,7 +13,9 @@ use crate::common::error::{ExceptionStage, Trap};
 use crate::core::Cpu;
 use crate::core::pipeline::latches::{ExMem1Entry, RenameIssueEntry};
 use crate::core::pipeline::rob::{BpOutcome, CsrUpdate, Rob};
-use crate::core::pipeline::signals::{AluOp, ControlFlow, CsrOp, OpASrc, OpBSrc, SystemOp};
+use crate::core::pipeline::signals::{
+    AluOp, ControlFlow, CsrOp, OpASrc, OpBSrc, SystemOp, VectorOp,
+};
 use crate::core::units::alu::Alu;
 use crate::core::units::bru::BranchPredictor;
 use crate::core::units::fpu::Fpu;
@@ -166,6 +168,13 @@ pub fn execute_one(cpu: &mut Cpu, id: RenameIssueEntry, rob: &mut Rob) -> (ExMem
 
     // ALU / FPU execution
     let (alu_out, fp_flags) = compute_alu(id.ctrl.alu, op_a, op_b, op_c, id.ctrl.is_rv32);
+    // vset{i}vl{i}: predict the new vl from the committed vtype state; commit
+    // re-executes it and replays younger instructions if the value differs.
+    let alu_out = if id.ctrl.vector == VectorOp::SetVl {
+        cpu.vector.vsetvl_result(id.inst, fwd_a, fwd_b).0
+    } else {
+        alu_out
+    };
     trace_execute!(cpu.trace;
         rob_tag  = id.rob_tag.0,
         pc       = %crate::trace::Hex(id.pc),
@@ -6,7 +6,7 @@
 //!
 //! Default latencies are Skylake-class values matching real hardware.
 
-use crate::core::pipeline::signals::{AluOp, ControlFlow, ControlSignals};
+use crate::core::pipeline::signals::{AluOp, ControlFlow, ControlSignals, VectorOp};
 use serde::Deserialize;
 
 /// Identifies which type of functional unit an instruction uses.
@@ -15,7 +15,8 @@ use serde::Deserialize;
 pub enum FuType {
     /// Integer ALU: add, sub, logic, shift, compare, set-less-than.
     IntAlu = 0,
-    /// Integer multiplier: mul, mulh, mulhsu, mulhu.
+    /// Integer multiplier: mul, mulh, mulhsu, mulhu. Also the Zbb bit
+    /// counts (clz, ctz, cpop), which share the multi-cycle integer port.
     IntMul = 1,
     /// Integer divider: div, divu, rem, remu. Non-pipelined.
     IntDiv = 2,
@@ -31,10 +32,13 @@ pub enum FuType {
     Branch = 7,
     /// Memory address calculation for loads and stores.
     Mem = 8,
+    /// Vector issue port: hands vector instructions to the vector unit,
+    /// which executes them at commit.
+    Vector = 9,
 }
 
 /// Number of distinct FU types.
-pub const FU_TYPE_COUNT: usize = 9;
+pub const FU_TYPE_COUNT: usize = 10;
 
 impl FuType {
     /// Human-readable name for stats output.
@@ -49,11 +53,15 @@ impl FuType {
             Self::FpDivSqrt => "fp_div_sqrt",
             Self::Branch => "branch",
             Self::Mem => "mem",
+            Self::Vector => "vector",
         }
     }
 
     /// Classify an instruction's FU type from its control signals.
     pub fn classify(ctrl: &ControlSignals) -> Self {
+        if ctrl.vector != VectorOp::None {
+            return Self::Vector;
+        }
         if ctrl.mem_read
             || ctrl.mem_write
             || ctrl.atomic_op != crate::core::pipeline::signals::AtomicOp::None
@@ -64,7 +72,14 @@ impl FuType {
             return Self::Branch;
         }
         match ctrl.alu {
-            AluOp::Mul | AluOp::Mulh | AluOp::Mulhsu | AluOp::Mulhu => Self::IntMul,
+            // Skylake runs lzcnt/tzcnt/popcnt on the 3-cycle multiply port.
+            AluOp::Mul
+            | AluOp::Mulh
+            | AluOp::Mulhsu
+            | AluOp::Mulhu
+            | AluOp::Clz
+            | AluOp::Ctz
+            | AluOp::Cpop => Self::IntMul,
             AluOp::Div | AluOp::Divu | AluOp::Rem | AluOp::Remu => Self::IntDiv,
             AluOp::FMul => Self::FpMul,
             AluOp::FDiv | AluOp::FSqrt => Self::FpDivSqrt,
@@ -170,6 +185,24 @@ pub struct FuConfig {
     pub num_mem: usize,
     /// Latency of memory operations in cycles.
     pub mem_latency: u64,
+    /// Number of vector issue ports.
+    #[serde(default = "FuConfig::default_num_vector")]
+    pub num_vector: usize,
+    /// Latency of handing a vector instruction to the vector unit in cycles.
+    #[serde(default = "FuConfig::default_vector_latency")]
+    pub vector_latency: u64,
+}
+
+impl FuConfig {
+    /// Returns the default number of vector issue ports.
+    const fn default_num_vector() -> usize {
+        1
+    }
+
+    /// Returns the default vector issue latency.
+    const fn default_vector_latency() -> u64 {
+        1
+    }
 }
 
 impl Default for FuConfig {
@@ -193,6 +226,8 @@ impl Default for FuConfig {
             branch_latency: 1,
             num_mem: 2,
             mem_latency: 1,
+            num_vector: Self::default_num_vector(),
+            vector_latency: Self::default_vector_latency(),
         }
     }
 }
@@ -229,6 +264,7 @@ impl FuPool {
         );
         add(&mut units, FuType::Branch, config.num_branch, config.branch_latency, true);
         add(&mut units, FuType::Mem, config.num_mem, config.mem_latency, true);
+        add(&mut units, FuType::Vector, config.num_vector, config.vector_latency, true);
 
         Self { units }
     }
@@ -314,6 +350,18 @@ mod tests {
         assert_eq!(FuType::classify(&ctrl), FuType::IntAlu);
     }
 
+    #[test]
+    fn test_classify_bitmanip() {
+        for alu in [AluOp::Sh1Add, AluOp::Andn, AluOp::Rol, AluOp::Rev8, AluOp::Bset] {
+            let ctrl = ControlSignals { alu, ..Default::default() };
+            assert_eq!(FuType::classify(&ctrl), FuType::IntAlu, "{alu:?}");
+        }
+        for alu in [AluOp::Clz, AluOp::Ctz, AluOp::Cpop] {
+            let ctrl = ControlSignals { alu, ..Default::default() };
+            assert_eq!(FuType::classify(&ctrl), FuType::IntMul, "{alu:?}");
+        }
+    }
+
     #[test]
     fn test_classify_int_div() {
         let ctrl = ControlSignals { alu: AluOp::Div, ..Default::default() };
@@ -337,4 +385,14 @@ mod tests {
         let ctrl = ControlSignals { mem_read: true, ..Default::default() };
         assert_eq!(FuType::classify(&ctrl), FuType::Mem);
     }
+
+    #[test]
+    fn test_classify_vector() {
+        // Vector loads carry no scalar memory access but still take the vector port.
+        let ctrl = ControlSignals { vector: VectorOp::Load, ..Default::default() };
+        assert_eq!(FuType::classify(&ctrl), FuType::Vector);
+        let ctrl =
+            ControlSignals { vector: VectorOp::Arith, alu: AluOp::Div, ..Default::default() };
+        assert_eq!(FuType::classify(&ctrl), FuType::Vector);
+    }
 }
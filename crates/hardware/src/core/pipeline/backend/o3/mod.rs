@@ -2,7 +2,7 @@
 //!
 //! The O3 backend reuses shared pipeline stages (Memory1, Memory2, Writeback,
 //! Commit) and shared hardware units (ALU, FPU, BRU), but has its own:
-//! - **`IssueQueue`**: CAM-style with wakeup/select (vs FIFO for in-order)
+//! - **`IssueQueue`**: bit-matrix wakeup/select (vs FIFO for in-order)
 //! - **`execute_one()`**: single-instruction execute (vs batch for in-order)
 
 pub mod execute;
@@ -25,9 +25,10 @@ use crate::core::pipeline::signals::ControlFlow;
 use crate::core::pipeline::store_buffer::StoreBuffer;
 use crate::core::units::bru::BranchPredictor;
 use crate::core::units::mdp::MemDepUnit;
+use crate::stats::{Stage, StageTimer};
 
 use self::fu_pool::{FuPool, FuType};
-use self::issue_queue::IssueQueue;
+use self::issue_queue::{IssueQueue, SelectedEntry};
 
 /// A result that has been computed but not yet written back (pending due to latency).
 #[derive(Debug)]
@@ -61,7 +62,7 @@ pub struct O3Engine {
     pub committed_rename_map: RenameMap,
     /// Tag-based register scoreboard (kept for in-order compatibility; O3 uses PRF).
     pub scoreboard: Scoreboard,
-    /// CAM-style issue queue with wakeup/select.
+    /// Issue queue with bit-matrix wakeup/select.
     pub issue_queue: IssueQueue,
     /// Functional unit pool for structural hazard modeling.
     pub fu_pool: FuPool,
@@ -73,12 +74,18 @@ pub struct O3Engine {
     pub load_ports: usize,
     /// Maximum stores issued per cycle.
     pub store_ports: usize,
+    /// Entries selected for issue this cycle (reused across cycles).
+    pub selected: Vec<SelectedEntry>,
     /// Execute -> Memory1 latch.
     pub execute_mem1: Vec<ExMem1Entry>,
     /// Memory1 -> Memory2 latch.
     pub mem1_mem2: Vec<Mem1Mem2Entry>,
     /// Memory2 -> Writeback latch.
     pub mem2_wb: Vec<Mem2WbEntry>,
+    /// Empty buffer that Memory1 swaps `execute_mem1` into and consumes.
+    mem1_scratch: Vec<ExMem1Entry>,
+    /// Empty buffer that Memory2 swaps `mem1_mem2` into and consumes.
+    mem2_scratch: Vec<Mem1Mem2Entry>,
     /// Current simulation cycle (for FU latency tracking).
     pub cycle: u64,
     /// Memory dependence unit for load-store ordering speculation.
@@ -96,6 +103,9 @@ pub struct O3Engine {
     /// rename map rebuild (forward-walking surviving ROB entries at `width`
     /// entries per cycle). Checkpoints eliminate this cost entirely.
     pub squash_stall_remaining: u64,
+
+    /// A ready instruction found no free functional unit this cycle.
+    fu_contended: bool,
 }
 
 impl O3Engine {
@@ -132,13 +142,17 @@ impl O3Engine {
             width: config.pipeline.width,
             load_ports: config.pipeline.load_ports,
             store_ports: config.pipeline.store_ports,
+            selected: Vec::with_capacity(config.pipeline.width),
             execute_mem1: Vec::with_capacity(config.pipeline.width),
             mem1_mem2: Vec::with_capacity(config.pipeline.width),
             mem2_wb: Vec::with_capacity(config.pipeline.width),
+            mem1_scratch: Vec::with_capacity(config.pipeline.width),
+            mem2_scratch: Vec::with_capacity(config.pipeline.width),
             cycle: 0,
             mdp: MemDepUnit::new(config),
             checkpoints: CheckpointTable::new(config.pipeline.checkpoint_count),
             squash_stall_remaining: 0,
+            fu_contended: false,
         }
     }
 
@@ -203,11 +217,12 @@ impl O3Engine {
 }
 
 impl ExecutionEngine for O3Engine {
-    fn tick(&mut self, cpu: &mut Cpu, rename_output: &mut Vec<RenameIssueEntry>) {
+    fn tick<const W: usize>(&mut self, cpu: &mut Cpu, rename_output: &mut Vec<RenameIssueEntry>) {
         // Backend stages run in reverse order (drain from commit to issue)
         self.cycle += 1;
         self.mdp.tick();
         let now = self.cycle;
+        self.fu_contended = false;
 
         // Drain squash recovery stall: the ROB read ports are busy processing
         // the squash walk (reclaiming entries / rebuilding rename map).
@@ -221,7 +236,8 @@ impl ExecutionEngine for O3Engine {
         let pc_before_commit = cpu.pc;
 
         // ── 1. Commit ──────────────────────────────────────────────────
-        let trap_event = commit::commit_stage(
+        let timer = StageTimer::start();
+        let trap_event = commit::commit_stage::<W>(
             cpu,
             &mut self.rob,
             &mut self.store_buffer,
@@ -233,6 +249,7 @@ impl ExecutionEngine for O3Engine {
             Some(&mut self.prf),
             Some(&mut self.checkpoints),
         );
+        timer.stop(&mut cpu.stats.stage_times, Stage::Commit);
 
         // Handle trap: flush everything
         if let Some((trap, pc)) = trap_event {
@@ -258,75 +275,50 @@ impl ExecutionEngine for O3Engine {
         }
 
         // ── 2. Writeback + Wakeup ──────────────────────────────────────
-        // Peek at mem2_wb to know which entries will complete, so we can
-        // wakeup dependents in the issue queue via PRF.
-        let wb_wakeups: Vec<_> = self
-            .mem2_wb
-            .iter()
-            .filter(|wb| wb.trap.is_none())
-            .map(|wb| {
-                let val = if wb.ctrl.mem_read {
-                    wb.load_data
-                } else if wb.ctrl.control_flow == ControlFlow::Jump {
-                    wb.pc.wrapping_add(wb.inst_size.as_u64())
-                } else {
-                    wb.alu
-                };
-                (wb.rob_tag, wb.rd_phys, val)
-            })
-            .collect();
+        // Broadcast wakeups to PRF + issue queue for the entries writeback
+        // completes, before it drains mem2_wb. Neither touches the ROB, so
+        // the order against writeback does not matter.
+        for wb in self.mem2_wb.iter().filter(|wb| wb.trap.is_none()) {
+            let val = if wb.ctrl.mem_read {
+                wb.load_data
+            } else if wb.ctrl.control_flow == ControlFlow::Jump {
+                wb.pc.wrapping_add(wb.inst_size.as_u64())
+            } else {
+                wb.alu
+            };
+            self.prf.write(wb.rd_phys, val);
+            self.issue_queue.wakeup_phys(wb.rd_phys, val);
+        }
 
+        let timer = StageTimer::start();
         writeback::writeback_stage(cpu, &mut self.mem2_wb, &mut self.rob);
-
-        // Broadcast wakeups to PRF + issue queue
-        for (_tag, rd_phys, val) in &wb_wakeups {
-            self.prf.write(*rd_phys, *val);
-            self.issue_queue.wakeup_phys(*rd_phys, *val);
-        }
+        timer.stop(&mut cpu.stats.stage_times, Stage::Writeback);
 
         // ── 2b. MSHR completions ─────────────────────────────────────
         // Drain completed MSHRs: install cache lines in L1D and resume
         // parked loads/atomics into the mem1→mem2 latch.
-        if cpu.l1d_mshrs.capacity() > 0 {
-            let completed = cpu.l1d_mshrs.drain_completions(now);
-            for mshr_entry in completed {
-                // Install the fetched line into L1D (with eviction tracking)
-                let (_penalty, evicted) = cpu.l1_d_cache.install_line_public_tracked(
-                    mshr_entry.line_addr,
-                    mshr_entry.is_write,
-                    0, // write-back penalty already accounted for in miss latency
-                );
-
-                // Exclusive policy: L1D eviction → install evicted line into L2
-                if cpu.inclusion_policy == crate::config::InclusionPolicy::Exclusive
-                    && cpu.l2_cache.enabled
-                    && let Some(ev) = evicted
-                {
-                    let _ = cpu.l2_cache.install_or_replace(ev.addr, ev.dirty, 0);
-                    cpu.stats.exclusive_l1_to_l2_swaps += 1;
-                }
-
-                // Resume parked loads/atomics
-                for waiter in mshr_entry.waiters {
-                    if let Some(mut parked) = waiter.parked_entry {
-                        // Set the completion cycle to now (data just arrived)
-                        parked.complete_cycle = now;
-                        self.mem1_mem2.push(parked);
-                    }
-                }
+        cpu.drain_mshr_fills(now, |waiter| {
+            // Resume parked loads/atomics
+            if let Some(mut parked) = waiter.parked_entry {
+                // Set the completion cycle to now (data just arrived)
+                parked.complete_cycle = now;
+                self.mem1_mem2.push(parked);
             }
-        }
+        });
 
         // ── 3. Memory2 ────────────────────────────────────────────────
         let wb_before = self.mem2_wb.len();
+        let timer = StageTimer::start();
         let mem_violation = memory2::memory2_stage(
             cpu,
             &mut self.mem1_mem2,
+            &mut self.mem2_scratch,
             &mut self.mem2_wb,
             &mut self.store_buffer,
             &mut self.rob,
             Some(&mut self.load_queue),
         );
+        timer.stop(&mut cpu.stats.stage_times, Stage::Memory2);
 
         // Notify MDP when stores resolve — wake instructions waiting on them.
         for entry in &self.mem2_wb[wb_before..] {
@@ -400,7 +392,7 @@ impl ExecutionEngine for O3Engine {
                 self.store_buffer.flush_speculative();
                 self.load_queue.flush();
                 self.mdp.flush();
-                cpu.l1d_mshrs.flush();
+                cpu.flush_mshrs();
 
                 self.mem1_mem2.clear();
                 self.mem2_wb.clear();
@@ -441,13 +433,16 @@ impl ExecutionEngine for O3Engine {
         if mem1_busy {
             cpu.stats.stalls_mem += 1;
         } else {
+            let timer = StageTimer::start();
             let cancelled = memory1::memory1_stage(
                 cpu,
                 &mut self.execute_mem1,
+                &mut self.mem1_scratch,
                 &mut self.mem1_mem2,
                 now,
                 Some(&mut self.load_queue),
             );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Memory1);
             // Cancel speculative wakeups for loads that missed L1D
             for phys in cancelled {
                 self.issue_queue.cancel_wakeup_phys(phys, &self.prf);
@@ -528,19 +523,26 @@ impl ExecutionEngine for O3Engine {
         let mut flush_keep_tag: Option<crate::core::pipeline::rob::RobTag> = None;
 
         {
-            let issued = self.issue_queue.select(
+            let mut issued = std::mem::take(&mut self.selected);
+            let timer = StageTimer::start();
+            self.issue_queue.select::<W>(
                 self.width,
                 &self.store_buffer,
                 &self.rob,
                 self.load_ports,
                 self.store_ports,
                 Some(&self.prf),
+                &mut issued,
             );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Issue);
 
             let mut issued_count = 0;
             let mut stalled_fu = false;
 
-            for selected in issued {
+            // Drained rather than consumed so the buffer keeps its capacity.
+            #[allow(clippy::iter_with_drain)]
+            let drained = issued.drain(..);
+            for selected in drained {
                 let entry = selected.entry;
                 let mem_dep = selected.mem_dep;
                 let fu_type = FuType::classify(&entry.ctrl);
@@ -577,7 +579,9 @@ impl ExecutionEngine for O3Engine {
                 let complete_cycle = self.fu_pool.acquire(fu_type, now);
                 let is_pipelined = self.fu_pool.is_pipelined(fu_type);
 
+                let timer = StageTimer::start();
                 let (ex_result, flush) = execute::execute_one(cpu, entry, &mut self.rob);
+                timer.stop(&mut cpu.stats.stage_times, Stage::Execute);
                 issued_count += 1;
 
                 let is_mem = ex_result.ctrl.mem_read
@@ -634,6 +638,9 @@ impl ExecutionEngine for O3Engine {
                 }
             }
 
+            self.selected = issued;
+            self.fu_contended = stalled_fu;
+
             if issued_count == 0 && !stalled_fu && !self.issue_queue.is_empty() {
                 cpu.stats.stalls_data += 1;
             }
@@ -697,7 +704,7 @@ impl ExecutionEngine for O3Engine {
                 self.store_buffer.flush_speculative();
                 self.load_queue.flush();
                 self.mdp.flush();
-                cpu.l1d_mshrs.flush();
+                cpu.flush_mshrs();
             }
             // Filter stale (wrong-path) entries from inter-stage latches and pending.
             self.mem1_mem2.retain(|e| e.rob_tag.is_older_or_eq(keep_tag));
@@ -705,15 +712,15 @@ impl ExecutionEngine for O3Engine {
             self.pending_results.retain(|p| p.entry.rob_tag.is_older_or_eq(keep_tag));
             self.execute_mem1.retain(|e| e.rob_tag.is_older_or_eq(keep_tag));
             // Restore speculative rename map: try checkpoint (O(1)), fallback to rebuild (O(n)).
-            // With a checkpoint, the rename map is restored in O(1) from the snapshot
-            // RAM — no ROB walk needed, so surviving=0 for the stall calculation.
+            // With a checkpoint, the modeled hardware restores the map in O(1) from
+            // its snapshot — no ROB walk needed, so surviving=0 for the stall
+            // calculation. (The simulator unwinds only the renames after the branch.)
             // Without a checkpoint (CSR/FENCE/no-checkpoint-config), the rename map
             // must be rebuilt by forward-walking surviving ROB entries, adding
             // ceil(surviving / width) stall cycles on top of the squash walk.
             let surviving = self.rob.len();
             if self.checkpoints.capacity() > 0 {
-                if let Some(ckpt) = self.checkpoints.find_by_tag(keep_tag) {
-                    self.rename_map = ckpt.rename_map.clone();
+                if self.checkpoints.restore(keep_tag, &mut self.rename_map) {
                     // Checkpoint found: O(1) rename restore, no rebuild penalty.
                     self.squash_stall_remaining = self.compute_squash_stall(squashed, 0);
                 } else {
@@ -735,7 +742,9 @@ impl ExecutionEngine for O3Engine {
 
         // ── 8. Dispatch from rename into issue queue ───────────────────
         if flush_keep_tag.is_none() {
-            let entries = std::mem::take(rename_output);
+            // Drained rather than consumed so the latch keeps its capacity.
+            #[allow(clippy::iter_with_drain)]
+            let entries = rename_output.drain(..);
             for entry in entries {
                 let is_load = entry.ctrl.mem_read;
                 let is_store = entry.ctrl.mem_write;
@@ -753,6 +762,21 @@ impl ExecutionEngine for O3Engine {
         cpu.stats.mdp_violations = mdp_stats.violations;
     }
 
+    fn is_idle(&self, cpu: &Cpu) -> bool {
+        self.squash_stall_remaining == 0
+            && self.issue_queue.is_empty()
+            && self.pending_results.is_empty()
+            && self.execute_mem1.is_empty()
+            && self.mem1_mem2.is_empty()
+            && self.mem2_wb.is_empty()
+            && cpu.l1d_mshrs.active_count() == 0
+    }
+
+    fn advance_idle(&mut self, cycles: u64) {
+        self.cycle += cycles;
+        self.mdp.tick_by(cycles);
+    }
+
     fn can_accept(&self) -> usize {
         // Block dispatch while the squash recovery walk is in progress.
         // The ROB read ports are busy reclaiming squashed entries / rebuilding
@@ -791,7 +815,7 @@ impl ExecutionEngine for O3Engine {
         self.mem1_mem2.clear();
         self.mem2_wb.clear();
         // Flush all MSHRs — their parked entries are now invalid
-        cpu.l1d_mshrs.flush();
+        cpu.flush_mshrs();
         // Reset speculative GHR to committed state — wrong-path branch
         // outcomes may have been pushed into the speculative history.
         cpu.branch_predictor.repair_to_committed();
@@ -876,6 +900,14 @@ impl ExecutionEngine for O3Engine {
     fn checkpoint_count(&self) -> usize {
         self.checkpoints.capacity()
     }
+
+    fn is_recovering(&self) -> bool {
+        self.squash_stall_remaining > 0
+    }
+
+    fn fu_contended(&self) -> bool {
+        self.fu_contended
+    }
 }
 
 #[cfg(test)]
@@ -11,20 +11,23 @@ use crate::common::constants::{
     DELEG_MEIP_BIT, DELEG_MSIP_BIT, DELEG_MTIP_BIT, DELEG_SEIP_BIT, DELEG_SSIP_BIT, DELEG_STIP_BIT,
 };
 use crate::common::constants::{PAGE_SHIFT, VPN_MASK};
-use crate::common::{Asid, LrScRecord, RegIdx, SfenceVmaInfo, Trap, Vpn};
+use crate::common::{Asid, InstSize, LrScRecord, RegIdx, SfenceVmaInfo, Trap, Vpn};
 use crate::core::Cpu;
 use crate::core::arch::csr;
 use crate::core::arch::mode::PrivilegeMode;
 use crate::core::arch::trap::TrapHandler;
 use crate::core::cpu::PC_TRACE_MAX;
 use crate::core::pipeline::checkpoint::CheckpointTable;
+use crate::core::pipeline::engine::lanes;
 use crate::core::pipeline::free_list::FreeList;
 use crate::core::pipeline::load_queue::LoadQueue;
 use crate::core::pipeline::prf::PhysRegFile;
 use crate::core::pipeline::rename_map::RenameMap;
 use crate::core::pipeline::rob::{Rob, RobState};
 use crate::core::pipeline::scoreboard::Scoreboard;
-use crate::core::pipeline::signals::{AluOp, ControlFlow, MemWidth, SystemOp};
+use crate::core::pipeline::signals::{
+    AluOp, ControlFlow, ControlSignals, MemWidth, SystemOp, VectorOp,
+};
 use crate::core::pipeline::store_buffer::{StoreBuffer, StoreResolution, width_to_bytes};
 use crate::core::units::bru::BranchPredictor;
 use crate::trace_branch;
@@ -34,11 +37,12 @@ use crate::trace_trap;
 
 /// Executes the Commit stage.
 ///
-/// Retires up to `width` instructions from the ROB head per cycle.
+/// Retires up to `width` instructions from the ROB head per cycle (`W`
+/// when specialized, see [`lanes`]).
 /// Handles register writes, CSR application, trap dispatch, and
 /// store buffer drain.
 #[allow(clippy::too_many_arguments)]
-pub fn commit_stage(
+pub fn commit_stage<const W: usize>(
     cpu: &mut Cpu,
     rob: &mut Rob,
     store_buffer: &mut StoreBuffer,
@@ -111,7 +115,7 @@ pub fn commit_stage(
     // Commit up to `width` entries from ROB head
     let mut retired_count: usize = 0;
     let rob_empty_at_start = rob.peek_head().is_none();
-    for _ in 0..width {
+    for _ in 0..lanes::<W>(width) {
         let Some(head) = rob.peek_head() else { break };
 
         // Safety guard: a load must not retire while older stores have unresolved
@@ -171,6 +175,9 @@ pub fn commit_stage(
                 if entry.phys_dst.0 != 0 {
                     free_list.reclaim(entry.phys_dst);
                 }
+                // Left the ROB without retiring: a wasted issue slot.
+                cpu.stats.tma_bad_speculation += 1;
+                cpu.stats.tma_bad_spec_squashed += 1;
                 trap_event = Some((the_trap.clone(), entry.pc));
             }
             break;
@@ -191,8 +198,55 @@ pub fn commit_stage(
             break;
         }
 
+        // Vector instructions execute at commit: wait for a vector queue
+        // slot, and for the vector sources of a scalar result.
+        if head.ctrl.vector != VectorOp::None && !cpu.vector_commit_ready(head.inst, &head.ctrl) {
+            cpu.stats.stalls_vector += 1;
+            break;
+        }
+
         // Completed — retire
-        let Some(entry) = rob.commit_head() else { break };
+        let Some(mut entry) = rob.commit_head() else { break };
+
+        // Apply the vector instruction to architectural state. Its scalar
+        // result (vl, vmv.x.s, ...) is only known now; if it differs from
+        // the value younger instructions consumed, or a vector store may
+        // have overwritten data they loaded, re-fetch after it.
+        let mut vector_replay = false;
+        if entry.ctrl.vector != VectorOp::None {
+            if matches!(entry.ctrl.vector, VectorOp::Load | VectorOp::Store) {
+                drain_all_committed(cpu, store_buffer);
+            }
+            match cpu.execute_vector(entry.pc, entry.inst, entry.ctrl.vector, true) {
+                Ok(scalar) => {
+                    let has_rd =
+                        (entry.ctrl.reg_write && !entry.rd.is_zero()) || entry.ctrl.fp_reg_write;
+                    if let Some(val) = scalar.filter(|_| has_rd)
+                        && entry.result != Some(val)
+                    {
+                        entry.result = Some(val);
+                        if let Some(ref mut prf) = prf {
+                            prf.write(entry.phys_dst, val);
+                        }
+                        vector_replay = true;
+                    }
+                    vector_replay |= entry.ctrl.vector == VectorOp::Store;
+                }
+                Err(trap) => {
+                    if entry.phys_dst.0 != 0 {
+                        free_list.reclaim(entry.phys_dst);
+                    }
+                    cpu.stats.tma_bad_speculation += 1;
+                    cpu.stats.tma_bad_spec_squashed += 1;
+                    trap_event = Some((trap, entry.pc));
+                    break;
+                }
+            }
+            if vector_replay {
+                cpu.pc = entry.pc.wrapping_add(entry.inst_size.as_u64());
+                cpu.redirect_pending = true;
+            }
+        }
         retired_count += 1;
 
         // Track the next-to-commit PC for accurate interrupt EPC when ROB is empty.
@@ -247,7 +301,7 @@ pub fn commit_stage(
         // Statistics
         if entry.inst != 0 && entry.inst != 0x13 {
             cpu.stats.instructions_retired += 1;
-            update_instruction_stats(cpu, &entry);
+            update_instruction_stats(cpu, &entry.ctrl);
         }
 
         // Apply deferred branch predictor update (only update on committed branches)
@@ -273,6 +327,12 @@ pub fn commit_stage(
                 cpu.stats.committed_branch_predictions += 1;
             }
         }
+        // Stream the retired branch or jump to the branch trace, if open.
+        if cpu.branch_trace.is_some() && entry.ctrl.control_flow != ControlFlow::Sequential {
+            let taken = entry.ctrl.control_flow == ControlFlow::Jump || entry.bp_outcome.taken;
+            let compressed = entry.inst_size == InstSize::Compressed;
+            cpu.record_branch(entry.pc, entry.inst, compressed, entry.bp_target.filter(|_| taken));
+        }
 
         // Write to register file
         debug_assert!(
@@ -451,17 +511,40 @@ pub fn commit_stage(
         // LR/SC reservation checks are deferred from Memory2 (speculative) to
         // commit (architectural) so that squashed instructions cannot corrupt
         // the reservation state.  See ISSUES.md Finding 5.
+        //
+        // In an SMP system the SC/AMO memory effect is performed here, under
+        // the atomic-domain lock, instead of draining from the store buffer
+        // (`performed`), after all older committed stores are made visible.
+        let mut performed = false;
+        let mut amo_replay = false;
         if let Some(lr_sc_rec) = entry.lr_sc {
             match lr_sc_rec {
-                LrScRecord::Lr { paddr } => {
-                    cpu.set_reservation(paddr);
+                LrScRecord::Lr { paddr, value } => {
+                    if cpu.is_smp() {
+                        cpu.smp_load_reserved(paddr, value);
+                    } else {
+                        cpu.set_reservation(paddr);
+                    }
                 }
-                LrScRecord::Sc { paddr } => {
-                    if cpu.check_reservation(paddr) {
+                LrScRecord::Sc { paddr, data } => {
+                    let success = if cpu.is_smp() {
+                        drain_all_committed(cpu, store_buffer);
+                        let ok = cpu.smp_store_conditional(paddr, data, entry.ctrl.width);
+                        if ok {
+                            store_buffer.cancel(entry.tag);
+                            performed = true;
+                            touch_atomic_line(cpu, paddr);
+                        }
+                        ok
+                    } else if cpu.check_reservation(paddr) {
                         // SC success — reservation valid, clear it and let
                         // the store (already in store buffer) drain normally.
                         cpu.clear_reservation();
+                        true
                     } else {
+                        false
+                    };
+                    if !success {
                         // SC failure — reservation was invalid.  The Memory2
                         // stage optimistically assumed success (rd=0, store
                         // resolved).  We must undo this:
@@ -485,11 +568,32 @@ pub fn commit_stage(
                         break;
                     }
                 }
+                LrScRecord::Amo { paddr, operand, old } => {
+                    drain_all_committed(cpu, store_buffer);
+                    let actual =
+                        cpu.smp_amo(entry.ctrl.atomic_op, paddr, operand, entry.ctrl.width);
+                    store_buffer.cancel(entry.tag);
+                    performed = true;
+                    touch_atomic_line(cpu, paddr);
+                    if actual != old {
+                        // Another hart changed the word after Memory2 read
+                        // it: younger instructions consumed a stale rd.
+                        if entry.ctrl.reg_write && !entry.rd.is_zero() {
+                            cpu.regs.write(entry.rd, actual);
+                            if let Some(ref mut prf) = prf {
+                                prf.write(entry.phys_dst, actual);
+                            }
+                        }
+                        cpu.pc = entry.pc.wrapping_add(entry.inst_size.as_u64());
+                        cpu.redirect_pending = true;
+                        amo_replay = true;
+                    }
+                }
             }
         }
 
         // Mark store buffer entry as committed (for stores)
-        if entry.ctrl.mem_write {
+        if entry.ctrl.mem_write && !performed {
             // Per RISC-V spec Section 8.2: a store to the reservation set
             // between a paired LR and SC must cause the SC to fail.  Clear
             // the reservation when a non-LR/SC store (regular store or AMO)
@@ -520,6 +624,10 @@ pub fn commit_stage(
             ckpt_table.free(ckpt_id);
         }
 
+        if amo_replay || vector_replay {
+            break;
+        }
+
         // FENCE.I always drains all committed stores — FENCE.I must see
         // prior stores before refilling I-cache.
         // SFENCE.VMA does NOT need drain_all_committed here because the
@@ -531,7 +639,7 @@ pub fn commit_stage(
             // FENCE.I: flush I-cache AFTER store drain so refills see new data.
             // The execute stage already redirected the frontend; this flush
             // ensures the I-cache doesn't hold stale lines when fetching resumes.
-            let _ = cpu.l1_i_cache.invalidate_all();
+            cpu.invalidate_l1i();
             // Re-redirect the frontend: the execute-time redirect may have
             // already caused fetches with stale I-cache data. Force a new
             // redirect so the frontend re-fetches with the flushed I-cache.
@@ -577,6 +685,7 @@ pub fn commit_stage(
         cpu.stats.cycles_rob_empty += 1;
     }
     cpu.stats.retire_histogram[retired_count.min(3)] += 1;
+    cpu.stats.tma_retiring += retired_count as u64;
 
     // Drain one committed store to memory per cycle
     drain_one_store(cpu, store_buffer);
@@ -584,6 +693,13 @@ pub fn commit_stage(
     trap_event
 }
 
+/// Updates the data caches for an SC/AMO performed directly at commit (SMP).
+fn touch_atomic_line(cpu: &mut Cpu, paddr: crate::common::PhysAddr) {
+    if paddr.val() >= cpu.ram_start && paddr.val() < cpu.ram_end {
+        let _latency = cpu.simulate_memory_access(paddr, crate::common::AccessType::Write);
+    }
+}
+
 /// Writes a single committed store from the store buffer to memory.
 ///
 /// If a Write Combining Buffer (WCB) is configured, stores are first merged
@@ -634,7 +750,7 @@ fn drain_one_store(cpu: &mut Cpu, store_buffer: &mut StoreBuffer) {
 /// Called before SATP writes to ensure page table entries set up by
 /// preceding stores are visible in physical memory before the page
 /// table walker consults them. Also flushes the WCB.
-fn drain_all_committed(cpu: &mut Cpu, store_buffer: &mut StoreBuffer) {
+pub(crate) fn drain_all_committed(cpu: &mut Cpu, store_buffer: &mut StoreBuffer) {
     while let Some(store) = store_buffer.drain_one() {
         if let StoreResolution::Committed { paddr, data } = store.resolution {
             let is_ram = paddr.val() >= cpu.ram_start && paddr.val() < cpu.ram_end;
@@ -659,17 +775,21 @@ fn flush_wcb(cpu: &mut Cpu) {
 }
 
 /// Writes a store's data to the correct memory target (RAM fast-path or bus).
-fn write_store_to_memory(
+///
+/// Stores that touch the HTIF range or run past the end of RAM take the bus path.
+pub(crate) fn write_store_to_memory(
     cpu: &mut Cpu,
     paddr: crate::common::PhysAddr,
     data: u64,
     width: MemWidth,
 ) {
     let raw = paddr.val();
-    let in_htif = cpu.htif_range.is_some_and(|(lo, hi)| raw >= lo && raw < hi);
-    let is_ram = !in_htif && raw >= cpu.ram_start && raw < cpu.ram_end;
-    if is_ram {
-        let offset = (raw - cpu.ram_start) as usize;
+    let len = width_to_bytes(width) as u64;
+    let in_htif = cpu.htif_range.is_some_and(|(lo, hi)| raw < hi && raw.saturating_add(len) > lo);
+    let ram_offset = if in_htif { None } else { cpu.ram_offset(raw, len) };
+    if let Some(offset) = ram_offset {
+        cpu.blocks.note_store(raw, len);
+        // SAFETY: `ram_offset` checked that every byte lies in RAM.
         unsafe {
             match width {
                 MemWidth::Byte => *cpu.ram_ptr.add(offset) = data as u8,
@@ -695,7 +815,7 @@ fn write_store_to_memory(
 }
 
 /// Checks for pending interrupts. Returns the trap if one should be taken.
-fn check_interrupts(cpu: &Cpu) -> Option<Trap> {
+pub(crate) fn check_interrupts(cpu: &Cpu) -> Option<Trap> {
     let mip = cpu.csrs.mip;
     let mie = cpu.csrs.mie;
     let mstatus = cpu.csrs.mstatus;
@@ -736,26 +856,28 @@ fn check_interrupts(cpu: &Cpu) -> Option<Trap> {
         .or_else(|| check(csr::MIP_STIP, csr::MIE_STIE, 1 << DELEG_STIP_BIT))
 }
 
-/// Updates instruction statistics based on the committed entry.
-const fn update_instruction_stats(cpu: &mut Cpu, entry: &crate::core::pipeline::rob::RobEntry) {
-    if entry.ctrl.mem_read {
-        if entry.ctrl.fp_reg_write {
+/// Updates instruction-mix statistics from a retired instruction's control signals.
+pub(crate) const fn update_instruction_stats(cpu: &mut Cpu, ctrl: &ControlSignals) {
+    if !matches!(ctrl.vector, VectorOp::None) {
+        cpu.stats.inst_vector += 1;
+    } else if ctrl.mem_read {
+        if ctrl.fp_reg_write {
             cpu.stats.inst_fp_load += 1;
         } else {
             cpu.stats.inst_load += 1;
         }
-    } else if entry.ctrl.mem_write {
-        if entry.ctrl.rs2_fp {
+    } else if ctrl.mem_write {
+        if ctrl.rs2_fp {
             cpu.stats.inst_fp_store += 1;
         } else {
             cpu.stats.inst_store += 1;
         }
-    } else if matches!(entry.ctrl.control_flow, ControlFlow::Branch | ControlFlow::Jump) {
+    } else if matches!(ctrl.control_flow, ControlFlow::Branch | ControlFlow::Jump) {
         cpu.stats.inst_branch += 1;
-    } else if !matches!(entry.ctrl.system_op, SystemOp::None) {
+    } else if !matches!(ctrl.system_op, SystemOp::None) {
         cpu.stats.inst_system += 1;
     } else {
-        match entry.ctrl.alu {
+        match ctrl.alu {
             AluOp::FAdd
             | AluOp::FSub
             | AluOp::FMul
@@ -794,18 +916,17 @@ const fn update_instruction_stats(cpu: &mut Cpu, entry: &crate::core::pipeline::
 /// Uses the deferred operand values captured at execute time for proper
 /// ASID/vaddr granularity, matching the RISC-V privileged specification:
 ///
-/// * rs1 == 0, rs2 == 0: flush all TLB entries + D-cache + I-cache
+/// * rs1 == 0, rs2 == 0: flush all TLB entries + page-walk cache + D-cache + I-cache
 /// * rs1 != 0, rs2 == 0: flush TLB entries matching virtual address in rs1
-/// * rs1 == 0, rs2 != 0: flush non-global TLB entries matching ASID in rs2
+/// * rs1 == 0, rs2 != 0: flush non-global TLB entries matching ASID in rs2 + page-walk cache
 /// * rs1 != 0, rs2 != 0: flush TLB entry matching both vaddr and ASID
-fn sfence_vma_commit(cpu: &mut Cpu, info: &SfenceVmaInfo) {
+///
+/// The per-address forms only order leaf PTEs, so cached page-walk pointers survive them.
+pub(crate) fn sfence_vma_commit(cpu: &mut Cpu, info: &SfenceVmaInfo) {
     match (!info.rs1_idx.is_zero(), !info.rs2_idx.is_zero()) {
         (false, false) => {
-            cpu.mmu.dtlb.flush();
-            cpu.mmu.itlb.flush();
-            cpu.mmu.l2_tlb.flush();
-            let _ = cpu.l1_d_cache.flush();
-            let _ = cpu.l1_i_cache.invalidate_all();
+            cpu.mmu.flush_all();
+            cpu.flush_l1_caches();
         }
         (true, false) => {
             let vpn = Vpn::new((info.rs1_val >> PAGE_SHIFT) & VPN_MASK);
@@ -818,6 +939,7 @@ fn sfence_vma_commit(cpu: &mut Cpu, info: &SfenceVmaInfo) {
             cpu.mmu.dtlb.flush_asid(asid);
             cpu.mmu.itlb.flush_asid(asid);
             cpu.mmu.l2_tlb.flush_asid(asid);
+            cpu.mmu.pwc.flush();
         }
         (true, true) => {
             let vpn = Vpn::new((info.rs1_val >> PAGE_SHIFT) & VPN_MASK);
@@ -907,7 +1029,7 @@ mod tests {
             .unwrap();
         rob.complete(tag, 42);
 
-        let trap = commit_stage(
+        let trap = commit_stage::<0>(
             &mut cpu,
             &mut rob,
             &mut store_buffer,
@@ -10,6 +10,7 @@
 
 use crate::common::{AccessType, ExceptionStage, PhysAddr, TranslationResult, VirtAddr};
 use crate::core::Cpu;
+use crate::core::cpu::memory::L1dAccess;
 use crate::core::pipeline::latches::{ExMem1Entry, Mem1Mem2Entry};
 use crate::core::pipeline::load_queue::LoadQueue;
 use crate::core::pipeline::prf::PhysReg;
@@ -30,22 +31,26 @@ use crate::trace_trap;
 /// (their `Mem1Mem2Entry` is stored inside the MSHR waiter). Stores that miss
 /// L1D allocate an MSHR for write-allocate but proceed immediately. Entries
 /// that cannot be processed (MSHR full) are pushed back into `input` for retry.
+/// Entries are consumed from `scratch`, which must be empty: `input` is
+/// swapped into it, so both buffers keep their storage across cycles.
 /// Returns a list of physical registers whose speculative wakeup should be
 /// cancelled (loads that missed L1D and were parked in MSHRs).
 pub fn memory1_stage(
     cpu: &mut Cpu,
     input: &mut Vec<ExMem1Entry>,
+    scratch: &mut Vec<ExMem1Entry>,
     output: &mut Vec<Mem1Mem2Entry>,
     current_cycle: u64,
     mut load_queue: Option<&mut LoadQueue>,
 ) -> Vec<PhysReg> {
-    let entries = std::mem::take(input);
+    debug_assert!(scratch.is_empty(), "memory1 scratch latch must start empty");
+    std::mem::swap(input, scratch);
     let has_mshrs = cpu.l1d_mshrs.capacity() > 0;
     let mut cancelled_wakeups: Vec<PhysReg> = Vec::new();
     // Do NOT clear output — memory2 may have pushed stalled entries back
     // into this latch. We append new entries after any stalled ones.
 
-    let mut iter = entries.into_iter();
+    let mut iter = scratch.drain(..);
 
     while let Some(ex) = iter.next() {
         // Propagate traps
@@ -253,187 +258,136 @@ pub fn memory1_stage(
             // caches entirely — they are uncacheable by nature.
             if paddr.val() >= cpu.cache_base && has_mshrs {
                 // ── Non-blocking path (MSHRs available) ──
-                let is_write = ex.ctrl.mem_write;
-                let l1d_hit = cpu.l1_d_cache.access_check(paddr.val(), is_write);
-
-                if l1d_hit {
-                    cpu.stats.dcache_hits += 1;
-                    per_entry_latency += cpu.l1_d_cache.latency;
-                    trace_mem!(cpu.trace;
-                        stage      = "M1",
-                        rob_tag    = ex.rob_tag.0,
-                        pc         = %crate::trace::Hex(ex.pc),
-                        paddr      = %crate::trace::Hex(paddr.val()),
-                        cache_hit  = true,
-                        latency    = cpu.l1_d_cache.latency,
-                        "M1: L1D cache HIT"
-                    );
-                    output.push(Mem1Mem2Entry {
-                        rob_tag: ex.rob_tag,
-                        pc: ex.pc,
-                        inst: ex.inst,
-                        inst_size: ex.inst_size,
-                        rd: ex.rd,
-                        rd_phys: ex.rd_phys,
-                        alu: ex.alu,
-                        vaddr: VirtAddr::new(ex.alu),
-                        paddr,
-                        store_data: ex.store_data,
-                        ctrl: ex.ctrl,
-                        trap: None,
-                        exception_stage: None,
-                        fp_flags: ex.fp_flags,
-                        complete_cycle: current_cycle + per_entry_latency,
-                        pte_update,
-                        sfence_vma: ex.sfence_vma,
-                    });
-                } else {
-                    // L1D miss — compute miss latency from L2/L3/DRAM
-                    cpu.stats.dcache_misses += 1;
-                    let miss_latency =
-                        cpu.l1_d_cache.latency + cpu.simulate_l1d_miss_latency(paddr, access_type);
-                    trace_mem!(cpu.trace;
-                        stage       = "M1",
-                        rob_tag     = ex.rob_tag.0,
-                        pc          = %crate::trace::Hex(ex.pc),
-                        paddr       = %crate::trace::Hex(paddr.val()),
-                        cache_hit   = false,
-                        miss_latency,
-                        "M1: L1D cache MISS"
-                    );
+                let entry = Mem1Mem2Entry {
+                    rob_tag: ex.rob_tag,
+                    pc: ex.pc,
+                    inst: ex.inst,
+                    inst_size: ex.inst_size,
+                    rd: ex.rd,
+                    rd_phys: ex.rd_phys,
+                    alu: ex.alu,
+                    vaddr: VirtAddr::new(ex.alu),
+                    paddr,
+                    store_data: ex.store_data,
+                    ctrl: ex.ctrl,
+                    trap: None,
+                    exception_stage: None,
+                    fp_flags: ex.fp_flags,
+                    complete_cycle: 0, // set below, or by MSHR completion
+                    pte_update,
+                    sfence_vma: ex.sfence_vma,
+                };
+                let is_atomic = ex.ctrl.atomic_op != AtomicOp::None;
+                let is_store_only = ex.ctrl.mem_write && !ex.ctrl.mem_read && !is_atomic;
 
-                    let is_atomic = ex.ctrl.atomic_op != AtomicOp::None;
-                    let is_store_only = ex.ctrl.mem_write && !ex.ctrl.mem_read && !is_atomic;
+                // Stores allocate an MSHR for write-allocate but proceed
+                // immediately (the store buffer handles the actual write);
+                // loads and atomics park in the MSHR until the line arrives.
+                let access = cpu.access_l1d_nonblocking(
+                    paddr,
+                    access_type,
+                    ex.pc,
+                    size,
+                    current_cycle,
+                    || MshrWaiter {
+                        rob_tag: ex.rob_tag,
+                        parked_entry: (!is_store_only).then(|| entry.clone()),
+                    },
+                );
 
-                    if is_store_only {
-                        // Stores: allocate MSHR for write-allocate but proceed
-                        // immediately. The store buffer handles the actual write.
-                        let waiter = MshrWaiter { rob_tag: ex.rob_tag, parked_entry: None };
-                        let resp = cpu.l1d_mshrs.request(
-                            paddr.val(),
-                            true,
-                            miss_latency,
-                            current_cycle,
-                            waiter,
+                match access {
+                    L1dAccess::Hit { latency } => {
+                        per_entry_latency += latency;
+                        trace_mem!(cpu.trace;
+                            stage      = "M1",
+                            rob_tag    = ex.rob_tag.0,
+                            pc         = %crate::trace::Hex(ex.pc),
+                            paddr      = %crate::trace::Hex(paddr.val()),
+                            cache_hit  = true,
+                            latency    = cpu.l1_d_cache.latency,
+                            "M1: L1D cache HIT"
                         );
-                        match resp {
-                            CacheResponse::MshrAllocated { .. } => {
-                                cpu.stats.mshr_allocations += 1;
-                            }
-                            CacheResponse::MshrCoalesced { .. } => {
-                                cpu.stats.mshr_coalesces += 1;
-                            }
-                            CacheResponse::MshrFull | CacheResponse::Hit => {
-                                // Store can proceed anyway — worst case the
-                                // write-allocate just doesn't happen.
-                            }
-                        }
-                        // Store proceeds with just L1D tag-check latency
-                        per_entry_latency += cpu.l1_d_cache.latency;
                         output.push(Mem1Mem2Entry {
-                            rob_tag: ex.rob_tag,
-                            pc: ex.pc,
-                            inst: ex.inst,
-                            inst_size: ex.inst_size,
-                            rd: ex.rd,
-                            rd_phys: ex.rd_phys,
-                            alu: ex.alu,
-                            vaddr: VirtAddr::new(ex.alu),
-                            paddr,
-                            store_data: ex.store_data,
-                            ctrl: ex.ctrl,
-                            trap: None,
-                            exception_stage: None,
-                            fp_flags: ex.fp_flags,
                             complete_cycle: current_cycle + per_entry_latency,
-                            pte_update,
-                            sfence_vma: ex.sfence_vma,
+                            ..entry
                         });
-                    } else {
-                        // Loads and atomics: park in MSHR
-                        let parked = Mem1Mem2Entry {
-                            rob_tag: ex.rob_tag,
-                            pc: ex.pc,
-                            inst: ex.inst,
-                            inst_size: ex.inst_size,
-                            rd: ex.rd,
-                            rd_phys: ex.rd_phys,
-                            alu: ex.alu,
-                            vaddr: VirtAddr::new(ex.alu),
-                            paddr,
-                            store_data: ex.store_data,
-                            ctrl: ex.ctrl,
-                            trap: None,
-                            exception_stage: None,
-                            fp_flags: ex.fp_flags,
-                            complete_cycle: 0, // set by MSHR completion
-                            pte_update,
-                            sfence_vma: ex.sfence_vma,
-                        };
-                        let waiter = MshrWaiter { rob_tag: ex.rob_tag, parked_entry: Some(parked) };
-                        let resp = cpu.l1d_mshrs.request(
-                            paddr.val(),
-                            is_write,
+                    }
+                    L1dAccess::Miss { latency: miss_latency, response } => {
+                        trace_mem!(cpu.trace;
+                            stage       = "M1",
+                            rob_tag     = ex.rob_tag.0,
+                            pc          = %crate::trace::Hex(ex.pc),
+                            paddr       = %crate::trace::Hex(paddr.val()),
+                            cache_hit   = false,
                             miss_latency,
-                            current_cycle,
-                            waiter,
+                            "M1: L1D cache MISS"
                         );
-                        match resp {
-                            CacheResponse::MshrAllocated { .. } => {
-                                cpu.stats.mshr_allocations += 1;
-                                // Cancel speculative wakeup — load won't complete at L1D latency
-                                cancelled_wakeups.push(ex.rd_phys);
-                                cpu.stats.load_replays += 1;
-                                trace_mem!(cpu.trace;
-                                    stage         = "M1",
-                                    rob_tag       = ex.rob_tag.0,
-                                    pc            = %crate::trace::Hex(ex.pc),
-                                    paddr         = %crate::trace::Hex(paddr.val()),
-                                    mshr_action   = "allocated",
-                                    rd_phys       = ex.rd_phys.0,
-                                    miss_latency,
-                                    "M1: MSHR allocated — load parked, speculative wakeup cancelled"
-                                );
-                                // Load is parked — do not push to output
-                            }
-                            CacheResponse::MshrCoalesced { .. } => {
-                                cpu.stats.mshr_coalesces += 1;
-                                // Cancel speculative wakeup — load won't complete at L1D latency
-                                cancelled_wakeups.push(ex.rd_phys);
-                                cpu.stats.load_replays += 1;
-                                trace_mem!(cpu.trace;
-                                    stage       = "M1",
-                                    rob_tag     = ex.rob_tag.0,
-                                    pc          = %crate::trace::Hex(ex.pc),
-                                    paddr       = %crate::trace::Hex(paddr.val()),
-                                    mshr_action = "coalesced",
-                                    rd_phys     = ex.rd_phys.0,
-                                    "M1: MSHR coalesced — load parked, speculative wakeup cancelled"
-                                );
-                                // Load is parked — do not push to output
-                            }
-                            CacheResponse::MshrFull => {
-                                cpu.stats.stalls_mshr_full += 1;
-                                trace_mem!(cpu.trace;
-                                    stage       = "M1",
-                                    rob_tag     = ex.rob_tag.0,
-                                    pc          = %crate::trace::Hex(ex.pc),
-                                    paddr       = %crate::trace::Hex(paddr.val()),
-                                    mshr_action = "full-stall",
-                                    "M1: MSHR full — load pushed back, retry next cycle"
-                                );
-                                // Push back to input for retry next cycle
-                                input.push(ex);
-                                input.extend(iter);
-                                return cancelled_wakeups;
+
+                        if is_store_only {
+                            // Worst case (MSHRs full) the write-allocate just
+                            // doesn't happen. The store proceeds with just
+                            // L1D tag-check latency.
+                            per_entry_latency += cpu.l1_d_cache.latency;
+                            output.push(Mem1Mem2Entry {
+                                complete_cycle: current_cycle + per_entry_latency,
+                                ..entry
+                            });
+                        } else {
+                            match response {
+                                CacheResponse::MshrAllocated { .. } => {
+                                    // Cancel speculative wakeup — load won't complete at L1D latency
+                                    cancelled_wakeups.push(ex.rd_phys);
+                                    cpu.stats.load_replays += 1;
+                                    trace_mem!(cpu.trace;
+                                        stage         = "M1",
+                                        rob_tag       = ex.rob_tag.0,
+                                        pc            = %crate::trace::Hex(ex.pc),
+                                        paddr         = %crate::trace::Hex(paddr.val()),
+                                        mshr_action   = "allocated",
+                                        rd_phys       = ex.rd_phys.0,
+                                        miss_latency,
+                                        "M1: MSHR allocated — load parked, speculative wakeup cancelled"
+                                    );
+                                    // Load is parked — do not push to output
+                                }
+                                CacheResponse::MshrCoalesced { .. } => {
+                                    // Cancel speculative wakeup — load won't complete at L1D latency
+                                    cancelled_wakeups.push(ex.rd_phys);
+                                    cpu.stats.load_replays += 1;
+                                    trace_mem!(cpu.trace;
+                                        stage       = "M1",
+                                        rob_tag     = ex.rob_tag.0,
+                                        pc          = %crate::trace::Hex(ex.pc),
+                                        paddr       = %crate::trace::Hex(paddr.val()),
+                                        mshr_action = "coalesced",
+                                        rd_phys     = ex.rd_phys.0,
+                                        "M1: MSHR coalesced — load parked, speculative wakeup cancelled"
+                                    );
+                                    // Load is parked — do not push to output
+                                }
+                                CacheResponse::MshrFull => {
+                                    cpu.stats.stalls_mshr_full += 1;
+                                    trace_mem!(cpu.trace;
+                                        stage       = "M1",
+                                        rob_tag     = ex.rob_tag.0,
+                                        pc          = %crate::trace::Hex(ex.pc),
+                                        paddr       = %crate::trace::Hex(paddr.val()),
+                                        mshr_action = "full-stall",
+                                        "M1: MSHR full — load pushed back, retry next cycle"
+                                    );
+                                    // Push back to input for retry next cycle
+                                    input.push(ex);
+                                    input.extend(iter);
+                                    return cancelled_wakeups;
+                                }
+                                CacheResponse::Hit => unreachable!(),
                             }
-                            CacheResponse::Hit => unreachable!(),
                         }
                     }
                 }
             } else if paddr.val() >= cpu.cache_base {
                 // ── Blocking path (no MSHRs) ──
-                let lat = cpu.simulate_memory_access(paddr, access_type);
+                let lat = cpu.simulate_memory_access_at(paddr, access_type, ex.pc, size);
                 per_entry_latency += lat;
                 output.push(Mem1Mem2Entry {
                     rob_tag: ex.rob_tag,
@@ -541,7 +495,7 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        let cancelled = memory1_stage(&mut cpu, &mut input, &mut output, 10, None);
+        let cancelled = memory1_stage(&mut cpu, &mut input, &mut Vec::new(), &mut output, 10, None);
 
         assert!(cancelled.is_empty());
         assert_eq!(input.len(), 0);
@@ -573,7 +527,7 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        let cancelled = memory1_stage(&mut cpu, &mut input, &mut output, 10, None);
+        let cancelled = memory1_stage(&mut cpu, &mut input, &mut Vec::new(), &mut output, 10, None);
 
         assert!(cancelled.is_empty());
         assert_eq!(input.len(), 0);
@@ -608,7 +562,7 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        let cancelled = memory1_stage(&mut cpu, &mut input, &mut output, 10, None);
+        let cancelled = memory1_stage(&mut cpu, &mut input, &mut Vec::new(), &mut output, 10, None);
 
         assert!(cancelled.is_empty());
         assert_eq!(output.len(), 1);
@@ -645,7 +599,7 @@ mod tests {
         let mut output = Vec::new();
 
         // 1st load: miss -> allocated in MSHR
-        let cancelled = memory1_stage(&mut cpu, &mut input, &mut output, 10, None);
+        let cancelled = memory1_stage(&mut cpu, &mut input, &mut Vec::new(), &mut output, 10, None);
         assert_eq!(cancelled.len(), 1); // Speculative wakeup cancelled
         assert_eq!(output.len(), 0); // Parked in MSHR
 
@@ -666,7 +620,8 @@ mod tests {
             fp_flags: 0,
             sfence_vma: None,
         }];
-        let cancelled2 = memory1_stage(&mut cpu, &mut input2, &mut output, 10, None);
+        let cancelled2 =
+            memory1_stage(&mut cpu, &mut input2, &mut Vec::new(), &mut output, 10, None);
         assert_eq!(cancelled2.len(), 0); // Hit, no cancel
         assert_eq!(output.len(), 1); // Proceeds to memory2
         assert_eq!(output[0].paddr, PhysAddr::new(0x8000_0000));
@@ -716,7 +671,7 @@ mod tests {
         let mut input = vec![entry1, entry2];
         let mut output = Vec::new();
 
-        let cancelled = memory1_stage(&mut cpu, &mut input, &mut output, 10, None);
+        let cancelled = memory1_stage(&mut cpu, &mut input, &mut Vec::new(), &mut output, 10, None);
 
         // 1st load misses and allocates the only MSHR.
         // 2nd load misses, sees MSHR full, and gets pushed back to input.
@@ -21,25 +21,30 @@ use crate::trace_trap;
 /// Returns `Some(violating_rob_tag)` if a memory ordering violation is detected
 /// (a store resolved its address and overlapped with a younger already-executed load).
 /// The caller should flush from this tag onward.
+///
+/// Entries are consumed from `scratch`, which must be empty: `input` is
+/// swapped into it, so both buffers keep their storage across cycles.
 pub fn memory2_stage(
     cpu: &mut Cpu,
     input: &mut Vec<Mem1Mem2Entry>,
+    scratch: &mut Vec<Mem1Mem2Entry>,
     output: &mut Vec<Mem2WbEntry>,
     store_buffer: &mut StoreBuffer,
     _rob: &mut Rob,
     mut load_queue: Option<&mut LoadQueue>,
 ) -> Option<(RobTag, u64)> {
     let mut violation: Option<(RobTag, u64)> = None;
-    let mut entries = std::mem::take(input);
+    debug_assert!(scratch.is_empty(), "memory2 scratch latch must start empty");
+    std::mem::swap(input, scratch);
 
     // Sort by rob_tag to ensure entries are processed in program order.
     // This prevents younger loads from stalling on unresolved older stores
     // that are behind them in the latch, which would deadlock the pipeline.
-    entries.sort_by_key(|e| e.rob_tag.0);
+    scratch.sort_by_key(|e| e.rob_tag.0);
 
     output.clear();
 
-    let mut iter = entries.into_iter();
+    let mut iter = scratch.drain(..);
 
     while let Some(mem) = iter.next() {
         // Propagate traps
@@ -104,7 +109,7 @@ pub fn memory2_stage(
                     };
                     // Defer reservation to commit — speculative LR must not
                     // modify architectural reservation state.
-                    lr_sc = Some(LrScRecord::Lr { paddr: raw_paddr });
+                    lr_sc = Some(LrScRecord::Lr { paddr: raw_paddr, value: ld });
                 }
                 AtomicOp::Sc => {
                     // Optimistically assume SC succeeds: resolve the store
@@ -113,7 +118,7 @@ pub fn memory2_stage(
                     // store and flush the pipeline.
                     store_buffer.resolve(mem.rob_tag, mem.vaddr, raw_paddr, mem.store_data);
                     ld = 0; // optimistic success
-                    lr_sc = Some(LrScRecord::Sc { paddr: raw_paddr });
+                    lr_sc = Some(LrScRecord::Sc { paddr: raw_paddr, data: mem.store_data });
 
                     // Check for memory ordering violation (same as regular stores).
                     if let Some(ref lq) = load_queue
@@ -169,6 +174,15 @@ pub fn memory2_stage(
                     }
 
                     ld = old_val;
+                    // In SMP another hart may modify the word before this AMO
+                    // retires; commit redoes it atomically and checks `old`.
+                    if cpu.is_smp() {
+                        lr_sc = Some(LrScRecord::Amo {
+                            paddr: raw_paddr,
+                            operand: mem.store_data,
+                            old: old_val,
+                        });
+                    }
                     // Note: AMOs may optionally clear the reservation per
                     // spec.  We skip this here because Memory2 is speculative
                     // — clearing on squash would corrupt LR/SC pairs.
@@ -438,8 +452,15 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        let violation =
-            memory2_stage(&mut cpu, &mut input, &mut output, &mut store_buffer, &mut rob, None);
+        let violation = memory2_stage(
+            &mut cpu,
+            &mut input,
+            &mut Vec::new(),
+            &mut output,
+            &mut store_buffer,
+            &mut rob,
+            None,
+        );
 
         assert!(violation.is_none());
         assert_eq!(input.len(), 0);
@@ -476,8 +497,15 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        let violation =
-            memory2_stage(&mut cpu, &mut input, &mut output, &mut store_buffer, &mut rob, None);
+        let violation = memory2_stage(
+            &mut cpu,
+            &mut input,
+            &mut Vec::new(),
+            &mut output,
+            &mut store_buffer,
+            &mut rob,
+            None,
+        );
 
         assert!(violation.is_none());
         assert_eq!(input.len(), 0); // Input is drained because trap is pushed
@@ -522,11 +550,22 @@ mod tests {
         }];
         let mut output = Vec::new();
 
-        memory2_stage(&mut cpu, &mut input_lr, &mut output, &mut store_buffer, &mut rob, None);
+        memory2_stage(
+            &mut cpu,
+            &mut input_lr,
+            &mut Vec::new(),
+            &mut output,
+            &mut store_buffer,
+            &mut rob,
+            None,
+        );
         // LR does NOT set reservation at Memory2 — deferred to commit
         assert!(!cpu.check_reservation(PhysAddr::new(0x8000_0000)));
         // But the output carries the deferred LR record
-        assert!(matches!(output[0].lr_sc, Some(LrScRecord::Lr { paddr: PhysAddr(0x8000_0000) })));
+        assert!(matches!(
+            output[0].lr_sc,
+            Some(LrScRecord::Lr { paddr: PhysAddr(0x8000_0000), .. })
+        ));
 
         let ctrl_sc = ControlSignals {
             atomic_op: crate::core::pipeline::signals::AtomicOp::Sc,
@@ -555,10 +594,21 @@ mod tests {
             sfence_vma: None,
         }];
 
-        memory2_stage(&mut cpu, &mut input_sc, &mut output, &mut store_buffer, &mut rob, None);
+        memory2_stage(
+            &mut cpu,
+            &mut input_sc,
+            &mut Vec::new(),
+            &mut output,
+            &mut store_buffer,
+            &mut rob,
+            None,
+        );
         // SC optimistically returns 0 (success) — actual check deferred to commit
         assert_eq!(output[0].load_data, 0);
-        assert!(matches!(output[0].lr_sc, Some(LrScRecord::Sc { paddr: PhysAddr(0x8000_0000) })));
+        assert!(matches!(
+            output[0].lr_sc,
+            Some(LrScRecord::Sc { paddr: PhysAddr(0x8000_0000), .. })
+        ));
         // Reservation unchanged at Memory2 (still not set — LR was deferred)
         assert!(!cpu.check_reservation(PhysAddr::new(0x8000_0000)));
     }
@@ -609,6 +659,7 @@ mod tests {
         let violation = memory2_stage(
             &mut cpu,
             &mut input,
+            &mut Vec::new(),
             &mut output,
             &mut store_buffer,
             &mut rob,
@@ -14,8 +14,9 @@ use crate::trace_writeback;
 
 /// Executes the Writeback stage: mark ROB entries Completed.
 pub fn writeback_stage(cpu: &mut Cpu, input: &mut Vec<Mem2WbEntry>, rob: &mut Rob) {
-    let entries = std::mem::take(input);
-
+    // Drained rather than consumed so the latch keeps its capacity.
+    #[allow(clippy::iter_with_drain)]
+    let entries = input.drain(..);
     for wb in entries {
         if let Some(ref trap) = wb.trap {
             // Mark as faulted
@@ -1,32 +1,54 @@
 //! Checkpoint table for O(1) branch recovery.
 //!
-//! A `CheckpointTable` stores snapshots of the speculative rename map taken
-//! at branch/jump dispatch time. On a misprediction, the rename map is
-//! restored directly from the checkpoint instead of walking the entire
-//! surviving ROB (`rebuild_rename_map()`), reducing recovery from O(ROB size)
-//! to O(1).
+//! A `CheckpointTable` records the speculative rename map state at
+//! branch/jump dispatch time without copying it. It performs the following:
+//! 1. **Undo log:** Every rename-map write made while a checkpoint is live
+//!    appends the mapping it overwrites to a shared log.
+//! 2. **Checkpoint:** Allocating a checkpoint only records the current log
+//!    position, so creation is O(1) regardless of map size.
+//! 3. **Recovery:** On a misprediction, the log is unwound back to the
+//!    branch's position, restoring exactly the mappings renamed after it,
+//!    instead of walking the entire surviving ROB (`rebuild_rename_map()`).
+//! 4. **Reclamation:** Log records older than the oldest live checkpoint are
+//!    discarded as checkpoints are freed at commit.
 
+use std::collections::VecDeque;
+
+use super::prf::PhysReg;
 use super::rename_map::RenameMap;
 use super::rob::RobTag;
+use crate::common::RegIdx;
 
 /// Index into the checkpoint table.
 #[derive(Clone, Copy, Debug, PartialEq, Eq)]
 pub struct CheckpointId(pub u8);
 
-/// A single rename map snapshot associated with a branch/jump.
-#[derive(Clone, Debug)]
+/// A rename-map checkpoint associated with a branch/jump.
+#[derive(Clone, Copy, Debug)]
 pub struct Checkpoint {
     /// ROB tag of the branch/jump that owns this checkpoint.
     pub branch_tag: RobTag,
-    /// Rename map snapshot taken *after* the branch's own rd rename.
-    pub rename_map: RenameMap,
+    /// Absolute undo-log position taken *after* the branch's own rd rename.
+    pub log_pos: u64,
+}
+
+/// One overwritten rename-map entry.
+#[derive(Clone, Copy, Debug)]
+struct UndoRecord {
+    reg: RegIdx,
+    is_fp: bool,
+    old: PhysReg,
 }
 
-/// Fixed-size table of checkpoint slots.
+/// Fixed-size table of checkpoint slots sharing one rename undo log.
 #[derive(Debug)]
 pub struct CheckpointTable {
     slots: Vec<Option<Checkpoint>>,
     count: usize,
+    /// Overwritten mappings, oldest first.
+    log: VecDeque<UndoRecord>,
+    /// Absolute position of `log[0]`.
+    log_base: u64,
 }
 
 impl CheckpointTable {
@@ -34,7 +56,7 @@ impl CheckpointTable {
     pub fn new(capacity: usize) -> Self {
         let mut slots = Vec::with_capacity(capacity);
         slots.resize_with(capacity, || None);
-        Self { slots, count: 0 }
+        Self { slots, count: 0, log: VecDeque::new(), log_base: 0 }
     }
 
     /// Returns the table capacity.
@@ -55,12 +77,30 @@ impl CheckpointTable {
         self.slots.len() - self.count
     }
 
-    /// Allocates a checkpoint slot, saving `rename_map` for `branch_tag`.
+    /// Absolute position one past the newest log record.
+    #[inline]
+    fn log_end(&self) -> u64 {
+        self.log_base + self.log.len() as u64
+    }
+
+    /// Records that `reg` is about to be remapped away from `old`.
+    ///
+    /// Must be called for every speculative rename-map write. Writes made
+    /// while no checkpoint is live need no undo and are not logged.
+    #[inline]
+    pub fn record_rename(&mut self, reg: RegIdx, is_fp: bool, old: PhysReg) {
+        if self.count > 0 {
+            self.log.push_back(UndoRecord { reg, is_fp, old });
+        }
+    }
+
+    /// Allocates a checkpoint slot for `branch_tag` at the current rename state.
     /// Returns `None` if the table is full.
-    pub fn allocate(&mut self, branch_tag: RobTag, rename_map: &RenameMap) -> Option<CheckpointId> {
+    pub fn allocate(&mut self, branch_tag: RobTag) -> Option<CheckpointId> {
+        let log_pos = self.log_end();
         for (i, slot) in self.slots.iter_mut().enumerate() {
             if slot.is_none() {
-                *slot = Some(Checkpoint { branch_tag, rename_map: rename_map.clone() });
+                *slot = Some(Checkpoint { branch_tag, log_pos });
                 self.count += 1;
                 return Some(CheckpointId(i as u8));
             }
@@ -73,16 +113,45 @@ impl CheckpointTable {
         self.slots.iter().filter_map(|s| s.as_ref()).find(|c| c.branch_tag == tag)
     }
 
+    /// Rolls `rename_map` back to the checkpoint owned by `tag`.
+    ///
+    /// Unwinds only the log records written after the checkpoint, newest
+    /// first, and drops them. The checkpoint itself stays allocated. Returns
+    /// `false` (leaving `rename_map` untouched) if `tag` has no checkpoint.
+    pub fn restore(&mut self, tag: RobTag, rename_map: &mut RenameMap) -> bool {
+        let Some(pos) = self.find_by_tag(tag).map(|c| c.log_pos) else {
+            return false;
+        };
+        while self.log_end() > pos {
+            let Some(rec) = self.log.pop_back() else { break };
+            rename_map.set(rec.reg, rec.is_fp, rec.old);
+        }
+        true
+    }
+
+    /// Drops log records no live checkpoint can unwind to.
+    fn trim_log(&mut self) {
+        let oldest = self.slots.iter().flatten().map(|c| c.log_pos).min();
+        let keep_from = oldest.unwrap_or_else(|| self.log_end());
+        while self.log_base < keep_from && self.log.pop_front().is_some() {
+            self.log_base += 1;
+        }
+    }
+
     /// Frees the checkpoint at `id`.
     pub fn free(&mut self, id: CheckpointId) {
         let idx = id.0 as usize;
         if idx < self.slots.len() && self.slots[idx].is_some() {
             self.slots[idx] = None;
             self.count -= 1;
+            self.trim_log();
         }
     }
 
     /// Frees all checkpoints whose `branch_tag` is newer than `keep_tag`.
+    ///
+    /// Log records of squashed instructions are kept until trimmed: unwinding
+    /// through them only reinstates mappings older checkpoints expect.
     pub fn flush_after(&mut self, keep_tag: RobTag) {
         for slot in &mut self.slots {
             if let &mut Some(ref ckpt) = slot
@@ -92,6 +161,7 @@ impl CheckpointTable {
                 self.count -= 1;
             }
         }
+        self.trim_log();
     }
 
     /// Frees all checkpoint slots.
@@ -100,6 +170,8 @@ impl CheckpointTable {
             *slot = None;
         }
         self.count = 0;
+        self.log_base = self.log_end();
+        self.log.clear();
     }
 }
 
@@ -107,13 +179,12 @@ impl CheckpointTable {
 #[allow(clippy::unwrap_used, unused_results)]
 mod tests {
     use super::*;
-    use crate::common::RegIdx;
-    use crate::core::pipeline::prf::PhysReg;
 
-    fn make_rename_map(marker: u16) -> RenameMap {
-        let mut rm = RenameMap::new();
-        rm.set(RegIdx::new(1), false, PhysReg(marker));
-        rm
+    /// Renames `reg` to `p`, logging the overwritten mapping like rename does.
+    fn rename(table: &mut CheckpointTable, rm: &mut RenameMap, reg: u8, is_fp: bool, p: u16) {
+        let reg = RegIdx::new(reg);
+        table.record_rename(reg, is_fp, rm.get(reg, is_fp));
+        rm.set(reg, is_fp, PhysReg(p));
     }
 
     #[test]
@@ -122,14 +193,12 @@ mod tests {
         assert_eq!(table.available(), 4);
         assert!(!table.is_full());
 
-        let rm = make_rename_map(100);
         let tag = RobTag(10);
-        let id = table.allocate(tag, &rm).unwrap();
+        let id = table.allocate(tag).unwrap();
         assert_eq!(table.available(), 3);
 
         let ckpt = table.find_by_tag(tag).unwrap();
         assert_eq!(ckpt.branch_tag, tag);
-        assert_eq!(ckpt.rename_map.get(RegIdx::new(1), false), PhysReg(100));
 
         table.free(id);
         assert_eq!(table.available(), 4);
@@ -139,21 +208,19 @@ mod tests {
     #[test]
     fn test_full_table() {
         let mut table = CheckpointTable::new(2);
-        let rm = make_rename_map(1);
-        table.allocate(RobTag(1), &rm).unwrap();
-        table.allocate(RobTag(2), &rm).unwrap();
+        table.allocate(RobTag(1)).unwrap();
+        table.allocate(RobTag(2)).unwrap();
         assert!(table.is_full());
-        assert!(table.allocate(RobTag(3), &rm).is_none());
+        assert!(table.allocate(RobTag(3)).is_none());
     }
 
     #[test]
     fn test_flush_after() {
         let mut table = CheckpointTable::new(4);
-        let rm = make_rename_map(1);
-        table.allocate(RobTag(1), &rm).unwrap();
-        table.allocate(RobTag(2), &rm).unwrap();
-        table.allocate(RobTag(3), &rm).unwrap();
-        table.allocate(RobTag(4), &rm).unwrap();
+        table.allocate(RobTag(1)).unwrap();
+        table.allocate(RobTag(2)).unwrap();
+        table.allocate(RobTag(3)).unwrap();
+        table.allocate(RobTag(4)).unwrap();
         assert!(table.is_full());
 
         // Keep tag 2, flush tags 3 and 4
@@ -168,9 +235,8 @@ mod tests {
     #[test]
     fn test_flush_all() {
         let mut table = CheckpointTable::new(4);
-        let rm = make_rename_map(1);
-        table.allocate(RobTag(1), &rm).unwrap();
-        table.allocate(RobTag(2), &rm).unwrap();
+        table.allocate(RobTag(1)).unwrap();
+        table.allocate(RobTag(2)).unwrap();
         table.flush_all();
         assert_eq!(table.available(), 4);
         assert!(table.find_by_tag(RobTag(1)).is_none());
@@ -181,10 +247,68 @@ mod tests {
         let mut table = CheckpointTable::new(0);
         assert!(table.is_full());
         assert_eq!(table.available(), 0);
-        let rm = make_rename_map(1);
-        assert!(table.allocate(RobTag(1), &rm).is_none());
+        assert!(table.allocate(RobTag(1)).is_none());
         // flush_after and flush_all should be no-ops
         table.flush_after(RobTag(1));
         table.flush_all();
     }
+
+    #[test]
+    fn test_restore_unwinds_renames_after_branch() {
+        let mut table = CheckpointTable::new(4);
+        let mut rm = RenameMap::new();
+        rename(&mut table, &mut rm, 1, false, 40); // before any checkpoint
+        table.allocate(RobTag(1)).unwrap();
+        rename(&mut table, &mut rm, 1, false, 41);
+        rename(&mut table, &mut rm, 2, true, 42);
+        rename(&mut table, &mut rm, 1, false, 43);
+
+        assert!(table.restore(RobTag(1), &mut rm));
+        assert_eq!(rm.get(RegIdx::new(1), false), PhysReg(40));
+        assert_eq!(rm.get(RegIdx::new(2), true), PhysReg(34));
+        // The checkpoint survives and can be restored again.
+        assert!(table.find_by_tag(RobTag(1)).is_some());
+        assert!(!table.restore(RobTag(9), &mut rm));
+    }
+
+    #[test]
+    fn test_restore_nested_checkpoints() {
+        let mut table = CheckpointTable::new(4);
+        let mut rm = RenameMap::new();
+        table.allocate(RobTag(1)).unwrap();
+        rename(&mut table, &mut rm, 5, false, 50);
+        table.allocate(RobTag(2)).unwrap();
+        rename(&mut table, &mut rm, 5, false, 51);
+        rename(&mut table, &mut rm, 6, false, 60);
+
+        assert!(table.restore(RobTag(2), &mut rm));
+        table.flush_after(RobTag(2));
+        assert_eq!(rm.get(RegIdx::new(5), false), PhysReg(50));
+        assert_eq!(rm.get(RegIdx::new(6), false), PhysReg(6));
+
+        assert!(table.restore(RobTag(1), &mut rm));
+        assert_eq!(rm.get(RegIdx::new(5), false), PhysReg(5));
+    }
+
+    #[test]
+    fn test_log_trimmed_when_checkpoints_free() {
+        let mut table = CheckpointTable::new(2);
+        let mut rm = RenameMap::new();
+        let first = table.allocate(RobTag(1)).unwrap();
+        rename(&mut table, &mut rm, 1, false, 40);
+        table.allocate(RobTag(2)).unwrap();
+        rename(&mut table, &mut rm, 2, false, 41);
+        assert_eq!(table.log.len(), 2);
+
+        // Committing the older branch drops records only it could unwind.
+        table.free(first);
+        assert_eq!(table.log.len(), 1);
+        assert!(table.restore(RobTag(2), &mut rm));
+        assert_eq!(rm.get(RegIdx::new(2), false), PhysReg(2));
+        assert_eq!(rm.get(RegIdx::new(1), false), PhysReg(40));
+
+        table.flush_all();
+        rename(&mut table, &mut rm, 3, false, 42);
+        assert!(table.log.is_empty());
+    }
 }
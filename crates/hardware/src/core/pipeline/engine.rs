@@ -5,10 +5,23 @@
 //! 2. **`ExecuteUnit`** — stage-level trait for instruction execution.
 //! 3. **`ExecutionEngine`** — high-level trait covering the entire backend.
 //! 4. **`PipelineDispatch`** — enum dispatch for type-erased pipeline storage.
-
+//!
+//! Pipelines are also generic over their width: `Pipeline<E, W>` runs `W`
+//! instructions per cycle, fixed at compile time, so the per-cycle loops in
+//! fetch, issue, commit, and slot accounting have constant trip counts.
+//! [`SpecializedPipeline`] instantiates the common widths
+//! ([`SPECIALIZED_WIDTHS`]) and falls back to `W = 0`, the configured width
+//! read at run time, for any other.
+
+use crate::config::Config;
+use crate::core::pipeline::backend::inorder::InOrderEngine;
+use crate::core::pipeline::backend::o3::O3Engine;
+use crate::core::pipeline::backend::shared::commit::drain_all_committed;
 use crate::core::pipeline::checkpoint::CheckpointTable;
 use crate::core::pipeline::free_list::FreeList;
-use crate::core::pipeline::latches::RenameIssueEntry;
+use crate::core::pipeline::frontend::Frontend;
+use crate::core::pipeline::history::{FrameWriter, Latch};
+use crate::core::pipeline::latches::{ExMem1Entry, Mem1Mem2Entry, Mem2WbEntry, RenameIssueEntry};
 use crate::core::pipeline::load_queue::LoadQueue;
 use crate::core::pipeline::prf::PhysRegFile;
 use crate::core::pipeline::rename_map::RenameMap;
@@ -29,12 +42,28 @@ pub enum BackendType {
     OutOfOrder,
 }
 
+/// Pipeline widths with a compile-time specialized pipeline.
+pub const SPECIALIZED_WIDTHS: [usize; 4] = [1, 2, 4, 8];
+
+/// Returns the width a pipeline specialized for `W` runs at: `W` itself,
+/// or the run-time `configured` width when `W` is 0.
+#[inline(always)]
+pub const fn lanes<const W: usize>(configured: usize) -> usize {
+    if W == 0 { configured } else { W }
+}
+
 /// The execution engine trait — implemented by `InOrderEngine` (and `O3Engine` in the future).
 ///
 /// Covers the backend pipeline: Issue -> Execute -> Memory1 -> Memory2 -> Writeback -> Commit.
 pub trait ExecutionEngine {
     /// Run one cycle of all backend stages (reverse order internally).
-    fn tick(&mut self, cpu: &mut crate::core::Cpu, rename_output: &mut Vec<RenameIssueEntry>);
+    ///
+    /// `W` is the width of the pipeline driving the engine (see [`lanes`]).
+    fn tick<const W: usize>(
+        &mut self,
+        cpu: &mut crate::core::Cpu,
+        rename_output: &mut Vec<RenameIssueEntry>,
+    );
 
     /// How many instructions can the engine accept from rename this cycle?
     fn can_accept(&self) -> usize;
@@ -105,29 +134,73 @@ pub trait ExecutionEngine {
     fn checkpoint_count(&self) -> usize {
         0
     }
+
+    /// Returns true when no stage has work in flight, so that a WFI-idle
+    /// cycle changes nothing but the engine's clocks (see [`Self::advance_idle`]).
+    ///
+    /// Completed wrong-path entries may remain in the ROB; commit never
+    /// retires them while the hart waits.
+    fn is_idle(&self, _cpu: &crate::core::Cpu) -> bool {
+        false
+    }
+
+    /// Advances the engine's clocks by `cycles` idle cycles, as if ticked.
+    fn advance_idle(&mut self, _cycles: u64) {}
+
+    /// Returns true while dispatch is blocked by flush recovery (ROB squash
+    /// walk, rename map rebuild).
+    fn is_recovering(&self) -> bool {
+        false
+    }
+
+    /// Returns true if a ready instruction found no free functional unit
+    /// this cycle.
+    fn fu_contended(&self) -> bool {
+        false
+    }
+
+    /// Returns true while the memory stage is blocked on an outstanding
+    /// access (for engines that stall in order behind one).
+    fn mem_stalled(&self) -> bool {
+        false
+    }
 }
 
 /// The full pipeline combines a frontend and an engine.
 ///
 /// The frontend is generic over the engine type, so the full pipeline
-/// maintains both together.
+/// maintains both together. `W` is the width the pipeline is specialized
+/// for, or 0 to use the configured width.
 #[derive(Debug)]
-pub struct Pipeline<E: ExecutionEngine> {
+pub struct Pipeline<E: ExecutionEngine, const W: usize = 0> {
     /// Frontend stages: fetch, decode, rename.
-    pub frontend: crate::core::pipeline::frontend::Frontend<E>,
+    pub frontend: Frontend<E, W>,
     /// Backend execution engine (in-order or out-of-order).
     pub engine: E,
     /// Buffer for rename stage output, consumed by the engine each cycle.
     pub rename_output: Vec<RenameIssueEntry>,
 }
 
-impl<E: ExecutionEngine> Pipeline<E> {
+impl<E: ExecutionEngine, const W: usize> Pipeline<E, W> {
+    /// Creates a pipeline around `engine` with empty latches.
+    pub fn new(config: &Config, engine: E) -> Self {
+        let width = lanes::<W>(config.pipeline.width);
+        Self {
+            frontend: Frontend::new(width, &config.pipeline.ftq),
+            engine,
+            rename_output: Vec::with_capacity(width),
+        }
+    }
+
     /// Run one cycle of the entire pipeline.
     pub fn tick(&mut self, cpu: &mut crate::core::Cpu) {
         let pc_before = cpu.pc;
 
         // Backend always runs (commit/writeback/memory must drain even during stalls)
-        self.engine.tick(cpu, &mut self.rename_output);
+        self.engine.tick::<W>(cpu, &mut self.rename_output);
+        let squashed = self.engine.rob_mut().take_squashed();
+        cpu.stats.tma_bad_speculation += squashed;
+        cpu.stats.tma_bad_spec_squashed += squashed;
 
         // If the backend redirected the PC (branch misprediction, trap, etc.),
         // flush the frontend and any pending rename output so stale instructions
@@ -162,18 +235,222 @@ impl<E: ExecutionEngine> Pipeline<E> {
         self.rename_output.clear();
         self.engine.flush(cpu);
     }
+
+    /// Flush the entire pipeline and write every committed store to memory.
+    ///
+    /// Afterwards memory and `cpu` hold exactly the state of the last commit,
+    /// so execution can resume elsewhere at `cpu.committed_next_pc`.
+    pub fn drain(&mut self, cpu: &mut crate::core::Cpu) {
+        self.flush(cpu);
+        drain_all_committed(cpu, self.engine.store_buffer_mut());
+    }
+
+    /// Returns true when a tick would only advance clocks: the hart waits in
+    /// WFI (so the frontend is stalled) and the backend is idle.
+    pub fn is_idle(&self, cpu: &crate::core::Cpu) -> bool {
+        cpu.wfi_waiting && self.rename_output.is_empty() && self.engine.is_idle(cpu)
+    }
+
+    /// Record the frontend latches and pending rename output into `frame`.
+    fn record_frontend(&self, frame: &mut FrameWriter<'_>) {
+        let fe = &self.frontend;
+        for e in &fe.fetch1_fetch2 {
+            frame.push(Latch::Fetch1Fetch2, e.pc, 0, 0);
+        }
+        for e in &fe.fetch2_decode {
+            frame.push(Latch::Fetch2Decode, e.pc, e.inst, 0);
+        }
+        for e in &fe.decode_rename {
+            frame.push(Latch::DecodeRename, e.pc, e.inst, 0);
+        }
+        for e in &self.rename_output {
+            frame.push(Latch::RenameIssue, e.pc, e.inst, e.rob_tag.0);
+        }
+        let header = frame.frame();
+        header.fetch1_stall = fe.fetch1_stall;
+        header.fetch2_stall = fe.fetch2_stall;
+    }
+}
+
+/// Record the backend latches past issue into `frame`.
+fn record_backend(
+    frame: &mut FrameWriter<'_>,
+    execute_mem1: &[ExMem1Entry],
+    mem1_mem2: &[Mem1Mem2Entry],
+    mem2_wb: &[Mem2WbEntry],
+) {
+    for e in execute_mem1 {
+        frame.push(Latch::ExecuteMem1, e.pc, e.inst, e.rob_tag.0);
+    }
+    for e in mem1_mem2 {
+        frame.push(Latch::Mem1Mem2, e.pc, e.inst, e.rob_tag.0);
+    }
+    for e in mem2_wb {
+        frame.push(Latch::Mem2Wb, e.pc, e.inst, e.rob_tag.0);
+    }
+}
+
+/// Record one issue queue entry into `frame`.
+fn record_issue(frame: &mut FrameWriter<'_>, e: &RenameIssueEntry) {
+    let waiting = e.rs1_tag.is_some() || e.rs2_tag.is_some();
+    frame.push_issue(e.pc, e.inst, e.rob_tag.0, waiting);
+}
+
+impl<const W: usize> Pipeline<InOrderEngine, W> {
+    /// Capture a point-in-time snapshot of all inter-stage latch contents.
+    fn snapshot(&self, width: usize) -> PipelineSnapshot {
+        PipelineSnapshot {
+            fetch1_fetch2: self.frontend.fetch1_fetch2.clone(),
+            fetch2_decode: self.frontend.fetch2_decode.clone(),
+            decode_rename: self.frontend.decode_rename.clone(),
+            rename_issue: self.rename_output.clone(),
+            issue_queue: self.engine.issuer.queue_snapshot(),
+            execute_mem1: self.engine.execute_mem1.clone(),
+            mem1_mem2: self.engine.mem1_mem2.clone(),
+            mem2_wb: self.engine.mem2_wb.clone(),
+            fetch1_stall: self.frontend.fetch1_stall,
+            fetch2_stall: self.frontend.fetch2_stall,
+            mem1_stall: self.engine.mem1_stall,
+            width,
+        }
+    }
+
+    /// Record this cycle's latch contents into `frame`, without allocating.
+    fn record(&self, width: usize, frame: &mut FrameWriter<'_>) {
+        self.record_frontend(frame);
+        let issuer = &self.engine.issuer;
+        frame.frame().issue_queue_len = issuer.len() as u32;
+        issuer.for_each_oldest(width, |e| record_issue(frame, e));
+        let engine = &self.engine;
+        record_backend(frame, &engine.execute_mem1, &engine.mem1_mem2, &engine.mem2_wb);
+        frame.frame().mem1_stall = engine.mem1_stall;
+    }
+}
+
+impl<const W: usize> Pipeline<O3Engine, W> {
+    /// Capture a point-in-time snapshot of all inter-stage latch contents.
+    fn snapshot(&self, width: usize) -> PipelineSnapshot {
+        PipelineSnapshot {
+            fetch1_fetch2: self.frontend.fetch1_fetch2.clone(),
+            fetch2_decode: self.frontend.fetch2_decode.clone(),
+            decode_rename: self.frontend.decode_rename.clone(),
+            rename_issue: self.rename_output.clone(),
+            issue_queue: self.engine.issue_queue.queue_snapshot(),
+            execute_mem1: self.engine.execute_mem1.clone(),
+            mem1_mem2: self.engine.mem1_mem2.clone(),
+            mem2_wb: self.engine.mem2_wb.clone(),
+            fetch1_stall: self.frontend.fetch1_stall,
+            fetch2_stall: self.frontend.fetch2_stall,
+            mem1_stall: 0, // O3 uses per-entry complete_cycle, no global stall
+            width,
+        }
+    }
+
+    /// Record this cycle's latch contents into `frame`, without allocating.
+    fn record(&self, width: usize, frame: &mut FrameWriter<'_>) {
+        self.record_frontend(frame);
+        let iq = &self.engine.issue_queue;
+        frame.frame().issue_queue_len = iq.len() as u32;
+        iq.for_each_oldest(width, |e| record_issue(frame, e));
+        let engine = &self.engine;
+        record_backend(frame, &engine.execute_mem1, &engine.mem1_mem2, &engine.mem2_wb);
+    }
+}
+
+/// A pipeline around engine `E`, instantiated for its configured width.
+#[derive(Debug)]
+pub enum SpecializedPipeline<E: ExecutionEngine> {
+    /// Scalar pipeline.
+    W1(Box<Pipeline<E, 1>>),
+    /// 2-wide pipeline.
+    W2(Box<Pipeline<E, 2>>),
+    /// 4-wide pipeline.
+    W4(Box<Pipeline<E, 4>>),
+    /// 8-wide pipeline.
+    W8(Box<Pipeline<E, 8>>),
+    /// Any other width, read from the configuration at run time.
+    Any(Box<Pipeline<E>>),
+}
+
+/// Evaluates `$body` with `$p` bound to the pipeline of whichever width `$pipeline` holds.
+macro_rules! each_width {
+    ($pipeline:expr, $p:ident => $body:expr) => {
+        match $pipeline {
+            SpecializedPipeline::W1($p) => $body,
+            SpecializedPipeline::W2($p) => $body,
+            SpecializedPipeline::W4($p) => $body,
+            SpecializedPipeline::W8($p) => $body,
+            SpecializedPipeline::Any($p) => $body,
+        }
+    };
+}
+
+impl<E: ExecutionEngine> SpecializedPipeline<E> {
+    /// Creates a pipeline around `engine`, specialized for the configured
+    /// width when it is one of [`SPECIALIZED_WIDTHS`].
+    pub fn new(config: &Config, engine: E) -> Self {
+        match config.pipeline.width {
+            1 => Self::W1(Box::new(Pipeline::new(config, engine))),
+            2 => Self::W2(Box::new(Pipeline::new(config, engine))),
+            4 => Self::W4(Box::new(Pipeline::new(config, engine))),
+            8 => Self::W8(Box::new(Pipeline::new(config, engine))),
+            _ => Self::Any(Box::new(Pipeline::new(config, engine))),
+        }
+    }
+
+    /// The backend engine.
+    pub fn engine(&self) -> &E {
+        each_width!(self, p => &p.engine)
+    }
+
+    /// The backend engine, mutably.
+    pub fn engine_mut(&mut self) -> &mut E {
+        each_width!(self, p => &mut p.engine)
+    }
+
+    /// Run one cycle (see [`Pipeline::tick`]).
+    pub fn tick(&mut self, cpu: &mut crate::core::Cpu) {
+        each_width!(self, p => p.tick(cpu));
+    }
+
+    /// Flush (see [`Pipeline::flush`]).
+    pub fn flush(&mut self, cpu: &mut crate::core::Cpu) {
+        each_width!(self, p => p.flush(cpu));
+    }
+
+    /// Drain (see [`Pipeline::drain`]).
+    pub fn drain(&mut self, cpu: &mut crate::core::Cpu) {
+        each_width!(self, p => p.drain(cpu));
+    }
+
+    /// Returns true when a tick would only advance clocks (see [`Pipeline::is_idle`]).
+    pub fn is_idle(&self, cpu: &crate::core::Cpu) -> bool {
+        each_width!(self, p => p.is_idle(cpu))
+    }
 }
 
 /// Type-erased pipeline for storage in the non-generic Cpu struct.
 #[derive(Debug)]
 pub enum PipelineDispatch {
     /// In-order pipeline.
-    InOrder(Box<Pipeline<crate::core::pipeline::backend::inorder::InOrderEngine>>),
+    InOrder(SpecializedPipeline<InOrderEngine>),
     /// Out-of-order pipeline.
-    OutOfOrder(Box<Pipeline<crate::core::pipeline::backend::o3::O3Engine>>),
+    OutOfOrder(SpecializedPipeline<O3Engine>),
 }
 
 impl PipelineDispatch {
+    /// Creates the pipeline for the configured backend and width.
+    pub fn new(config: &Config) -> Self {
+        match config.pipeline.backend {
+            BackendType::InOrder => {
+                Self::InOrder(SpecializedPipeline::new(config, InOrderEngine::new(config)))
+            }
+            BackendType::OutOfOrder => {
+                Self::OutOfOrder(SpecializedPipeline::new(config, O3Engine::new(config)))
+            }
+        }
+    }
+
     /// Run one cycle.
     pub fn tick(&mut self, cpu: &mut crate::core::Cpu) {
         match self {
@@ -190,37 +467,50 @@ impl PipelineDispatch {
         }
     }
 
+    /// Drain (see [`Pipeline::drain`]).
+    pub fn drain(&mut self, cpu: &mut crate::core::Cpu) {
+        match self {
+            Self::InOrder(p) => p.drain(cpu),
+            Self::OutOfOrder(p) => p.drain(cpu),
+        }
+    }
+
+    /// Returns true when a tick would only advance clocks (see [`Pipeline::is_idle`]).
+    pub fn is_idle(&self, cpu: &crate::core::Cpu) -> bool {
+        match self {
+            Self::InOrder(p) => p.is_idle(cpu),
+            Self::OutOfOrder(p) => p.is_idle(cpu),
+        }
+    }
+
+    /// Accounts `cycles` idle cycles, as if ticked (requires [`Self::is_idle`]).
+    ///
+    /// Each one records a zero-retire cycle, exactly as the commit stage does
+    /// while the hart waits in WFI.
+    pub fn advance_idle(&mut self, cpu: &mut crate::core::Cpu, cycles: u64) {
+        match self {
+            Self::InOrder(p) => p.engine_mut().advance_idle(cycles),
+            Self::OutOfOrder(p) => p.engine_mut().advance_idle(cycles),
+        }
+        cpu.stats.retire_histogram[0] += cycles;
+    }
+
     /// Capture a point-in-time snapshot of all inter-stage latch contents.
     pub fn snapshot(&self, width: usize) -> PipelineSnapshot {
         match self {
-            Self::InOrder(p) => PipelineSnapshot {
-                fetch1_fetch2: p.frontend.fetch1_fetch2.clone(),
-                fetch2_decode: p.frontend.fetch2_decode.clone(),
-                decode_rename: p.frontend.decode_rename.clone(),
-                rename_issue: p.rename_output.clone(),
-                issue_queue: p.engine.issuer.queue_snapshot(),
-                execute_mem1: p.engine.execute_mem1.clone(),
-                mem1_mem2: p.engine.mem1_mem2.clone(),
-                mem2_wb: p.engine.mem2_wb.clone(),
-                fetch1_stall: p.frontend.fetch1_stall,
-                fetch2_stall: p.frontend.fetch2_stall,
-                mem1_stall: p.engine.mem1_stall,
-                width,
-            },
-            Self::OutOfOrder(p) => PipelineSnapshot {
-                fetch1_fetch2: p.frontend.fetch1_fetch2.clone(),
-                fetch2_decode: p.frontend.fetch2_decode.clone(),
-                decode_rename: p.frontend.decode_rename.clone(),
-                rename_issue: p.rename_output.clone(),
-                issue_queue: p.engine.issue_queue.queue_snapshot(),
-                execute_mem1: p.engine.execute_mem1.clone(),
-                mem1_mem2: p.engine.mem1_mem2.clone(),
-                mem2_wb: p.engine.mem2_wb.clone(),
-                fetch1_stall: p.frontend.fetch1_stall,
-                fetch2_stall: p.frontend.fetch2_stall,
-                mem1_stall: 0, // O3 uses per-entry complete_cycle, no global stall
-                width,
-            },
+            Self::InOrder(p) => each_width!(p, p => p.snapshot(width)),
+            Self::OutOfOrder(p) => each_width!(p, p => p.snapshot(width)),
+        }
+    }
+
+    /// Record the latch contents (at most `width` per latch) into `frame`.
+    ///
+    /// Unlike [`Self::snapshot`] this copies only the identity of each
+    /// instruction into preallocated storage (see [`crate::core::pipeline::history`]).
+    pub fn record(&self, width: usize, frame: &mut FrameWriter<'_>) {
+        match self {
+            Self::InOrder(p) => each_width!(p, p => p.record(width, frame)),
+            Self::OutOfOrder(p) => each_width!(p, p => p.record(width, frame)),
         }
     }
 }
@@ -232,7 +522,7 @@ mod tests {
 
     struct DummyEngine;
     impl ExecutionEngine for DummyEngine {
-        fn tick(
+        fn tick<const W: usize>(
             &mut self,
             _cpu: &mut crate::core::Cpu,
             _rename_output: &mut Vec<RenameIssueEntry>,
@@ -327,10 +617,7 @@ mod tests {
         let system = crate::soc::builder::System::new(&config, "");
         let mut cpu = crate::core::Cpu::new(system, &config);
 
-        let frontend = crate::core::pipeline::frontend::Frontend::new(config.pipeline.width);
-        let engine = crate::core::pipeline::backend::inorder::InOrderEngine::new(&config);
-        let pipeline = Pipeline { frontend, engine, rename_output: Vec::new() };
-        let mut dispatch = PipelineDispatch::InOrder(Box::new(pipeline));
+        let mut dispatch = PipelineDispatch::new(&config);
 
         dispatch.tick(&mut cpu);
         dispatch.flush(&mut cpu);
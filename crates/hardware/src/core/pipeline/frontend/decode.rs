@@ -13,6 +13,7 @@ use crate::core::Cpu;
 use crate::core::pipeline::latches::{IdExEntry, IfIdEntry};
 use crate::core::pipeline::signals::{
     AluOp, AtomicOp, ControlFlow, ControlSignals, CsrOp, MemWidth, OpASrc, OpBSrc, SystemOp,
+    VectorOp,
 };
 use crate::isa::decode::decode as instruction_decode;
 use crate::isa::instruction::{Decoded, InstructionBits};
@@ -23,13 +24,12 @@ use crate::isa::rv64d::{funct7 as d_funct7, opcodes as d_opcodes};
 use crate::isa::rv64f::{funct3 as f_funct3, funct7 as f_funct7, opcodes as f_opcodes};
 use crate::isa::rv64i::{funct3 as i_funct3, funct7 as i_funct7, opcodes as i_opcodes};
 use crate::isa::rv64m::{funct3 as m_funct3, opcodes as m_opcodes};
+use crate::isa::rvb::{funct7 as b_funct7, funct12 as b_funct12};
+use crate::isa::rvv::{funct6 as v_funct6, opcodes as v_opcodes};
 
 /// ADDI x0, x0, 0 instruction encoding (canonical NOP).
 const INSTRUCTION_NOP: u32 = 0x0000_0013;
 
-/// Bit 5 of funct7 field indicating alternate encoding (e.g., SUB vs ADD).
-const FUNCT7_ALT_BIT: u32 = 0x20;
-
 /// Floating-point width encoding for 32-bit word operations.
 const FP_WIDTH_WORD: u32 = 0x2;
 
@@ -42,8 +42,91 @@ const FP_FMT_SINGLE: u32 = 0;
 /// Floating-point format encoding for double-precision (64-bit).
 const FP_FMT_DOUBLE: u32 = 1;
 
+/// Decodes the shift-immediate group of `OP_IMM` / `OP_IMM_32` (funct3
+/// `001` and `101`): the base shifts plus the Zba, Zbb, and Zbs forms that
+/// share their encoding space.
+///
+/// RV64 shifts take a 6-bit amount, so `OP_IMM` is selected by funct6;
+/// the word forms take a 5-bit amount and are selected by funct7.
+const fn decode_shift_imm(d: &Decoded) -> Option<AluOp> {
+    let imm12 = (d.raw >> 20) & 0xFFF;
+    let funct6 = d.funct7 >> 1;
+    let word = d.opcode == i_opcodes::OP_IMM_32;
+    Some(match (d.funct3, word) {
+        (i_funct3::SLL, false) => match funct6 {
+            b_funct7::F6_SHIFT => AluOp::Sll,
+            b_funct7::F6_BSETI => AluOp::Bset,
+            b_funct7::F6_BCLRI_BEXTI => AluOp::Bclr,
+            b_funct7::F6_BINVI => AluOp::Binv,
+            _ => match imm12 {
+                b_funct12::CLZ => AluOp::Clz,
+                b_funct12::CTZ => AluOp::Ctz,
+                b_funct12::CPOP => AluOp::Cpop,
+                b_funct12::SEXT_B => AluOp::SextB,
+                b_funct12::SEXT_H => AluOp::SextH,
+                _ => return None,
+            },
+        },
+        (i_funct3::SRL_SRA, false) => match funct6 {
+            b_funct7::F6_SHIFT => AluOp::Srl,
+            b_funct7::F6_SRAI => AluOp::Sra,
+            b_funct7::F6_RORI => AluOp::Ror,
+            b_funct7::F6_BCLRI_BEXTI => AluOp::Bext,
+            _ => match imm12 {
+                b_funct12::ORC_B => AluOp::OrcB,
+                b_funct12::REV8 => AluOp::Rev8,
+                _ => return None,
+            },
+        },
+        (i_funct3::SLL, true) => match d.funct7 {
+            i_funct7::DEFAULT => AluOp::Sll,
+            _ if funct6 == b_funct7::F6_SLLI_UW => AluOp::SllUw,
+            _ => match imm12 {
+                b_funct12::CLZ => AluOp::Clz,
+                b_funct12::CTZ => AluOp::Ctz,
+                b_funct12::CPOP => AluOp::Cpop,
+                _ => return None,
+            },
+        },
+        (i_funct3::SRL_SRA, true) => match d.funct7 {
+            i_funct7::DEFAULT => AluOp::Srl,
+            i_funct7::SRA => AluOp::Sra,
+            b_funct7::ROTATE => AluOp::Ror,
+            _ => return None,
+        },
+        _ => return None,
+    })
+}
+
+/// Decodes the Zba, Zbb, and Zbs register-register forms of `OP_REG` /
+/// `OP_REG_32`. Returns `None` for encodings outside these extensions.
+const fn decode_bitmanip_reg(d: &Decoded) -> Option<AluOp> {
+    let word = d.opcode == i_opcodes::OP_REG_32;
+    Some(match (d.funct7, d.funct3, word) {
+        (b_funct7::SHADD, i_funct3::SLT, _) => AluOp::Sh1Add,
+        (b_funct7::SHADD, i_funct3::XOR, _) => AluOp::Sh2Add,
+        (b_funct7::SHADD, i_funct3::OR, _) => AluOp::Sh3Add,
+        (b_funct7::ADD_UW, i_funct3::ADD_SUB, true) => AluOp::AddUw,
+        (b_funct7::ADD_UW, i_funct3::XOR, true) if d.rs2.is_zero() => AluOp::ZextH,
+        (b_funct7::NEGATE, i_funct3::AND, false) => AluOp::Andn,
+        (b_funct7::NEGATE, i_funct3::OR, false) => AluOp::Orn,
+        (b_funct7::NEGATE, i_funct3::XOR, false) => AluOp::Xnor,
+        (b_funct7::MINMAX, i_funct3::XOR, false) => AluOp::Min,
+        (b_funct7::MINMAX, i_funct3::SRL_SRA, false) => AluOp::Minu,
+        (b_funct7::MINMAX, i_funct3::OR, false) => AluOp::Max,
+        (b_funct7::MINMAX, i_funct3::AND, false) => AluOp::Maxu,
+        (b_funct7::ROTATE, i_funct3::SLL, _) => AluOp::Rol,
+        (b_funct7::ROTATE, i_funct3::SRL_SRA, _) => AluOp::Ror,
+        (b_funct7::BSET, i_funct3::SLL, false) => AluOp::Bset,
+        (b_funct7::BCLR_BEXT, i_funct3::SLL, false) => AluOp::Bclr,
+        (b_funct7::BCLR_BEXT, i_funct3::SRL_SRA, false) => AluOp::Bext,
+        (b_funct7::BINV, i_funct3::SLL, false) => AluOp::Binv,
+        _ => return None,
+    })
+}
+
 /// Decodes a single instruction into control signals.
-fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals, Trap> {
+pub(crate) fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals, Trap> {
     let mut c = ControlSignals {
         a_src: OpASrc::Reg1,
         b_src: OpBSrc::Imm,
@@ -112,13 +195,8 @@ fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals,
                 i_funct3::XOR => AluOp::Xor,
                 i_funct3::OR => AluOp::Or,
                 i_funct3::AND => AluOp::And,
-                i_funct3::SLL => AluOp::Sll,
-                i_funct3::SRL_SRA => {
-                    if (d.funct7 & FUNCT7_ALT_BIT) != 0 {
-                        AluOp::Sra
-                    } else {
-                        AluOp::Srl
-                    }
+                i_funct3::SLL | i_funct3::SRL_SRA => {
+                    decode_shift_imm(d).ok_or(Trap::IllegalInstruction(inst))?
                 }
                 _ => return Err(Trap::IllegalInstruction(inst)),
             };
@@ -152,7 +230,7 @@ fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals,
                     (i_funct3::SRL_SRA, i_funct7::SRA) => AluOp::Sra,
                     (i_funct3::OR, i_funct7::DEFAULT) => AluOp::Or,
                     (i_funct3::AND, i_funct7::DEFAULT) => AluOp::And,
-                    _ => return Err(Trap::IllegalInstruction(inst)),
+                    _ => decode_bitmanip_reg(d).ok_or(Trap::IllegalInstruction(inst))?,
                 };
             }
         }
@@ -186,6 +264,30 @@ fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals,
             c.mem_write = c.atomic_op != AtomicOp::Lr;
             c.reg_write = true;
         }
+        // Vector loads/stores use the LOAD-FP/STORE-FP widths the F/D
+        // extensions leave free; they perform no scalar memory access.
+        f_opcodes::OP_LOAD_FP if v_opcodes::is_vector_width(d.funct3) => {
+            c.vector = VectorOp::Load;
+        }
+        f_opcodes::OP_STORE_FP if v_opcodes::is_vector_width(d.funct3) => {
+            c.vector = VectorOp::Store;
+        }
+        v_opcodes::OP_V => {
+            let funct6 = inst >> 26;
+            c.vector = VectorOp::Arith;
+            match d.funct3 {
+                v_opcodes::OPCFG => {
+                    c.vector = VectorOp::SetVl;
+                    c.reg_write = true;
+                }
+                // vmv.x.s, vcpop.m, vfirst.m
+                v_opcodes::OPMVV if funct6 == v_funct6::VWXUNARY0 => c.reg_write = true,
+                // vfmv.f.s
+                v_opcodes::OPFVV if funct6 == v_funct6::VWFUNARY0 => c.fp_reg_write = true,
+                v_opcodes::OPFVF => c.rs1_fp = true,
+                _ => {}
+            }
+        }
         f_opcodes::OP_LOAD_FP => {
             c.fp_reg_write = true;
             c.mem_read = true;
@@ -360,7 +462,12 @@ fn decode_instruction(inst: u32, pc: u64, d: &Decoded) -> Result<ControlSignals,
 /// Decode->Rename entries (`IdExEntry`).
 pub fn decode_stage(cpu: &mut Cpu, input: &mut Vec<IfIdEntry>, output: &mut Vec<IdExEntry>) {
     let mut consumed_count = 0;
-    let mut bundle_writes: Vec<(RegIdx, bool)> = Vec::with_capacity(cpu.pipeline_width);
+    // Registers written earlier in this bundle: one bit per register, integer
+    // registers in `[0]` and FP registers in `[1]`.
+    let mut bundle_writes = [0u32; 2];
+    let written = |writes: &[u32; 2], reg: RegIdx, fp: bool| {
+        writes[usize::from(fp)] & (1 << reg.as_usize()) != 0
+    };
     let mut broke_on_trap = false;
 
     for if_entry in input.iter() {
@@ -385,11 +492,14 @@ pub fn decode_stage(cpu: &mut Cpu, input: &mut Vec<IfIdEntry>, output: &mut Vec<
             continue;
         }
 
-        let d = instruction_decode(inst);
-
-        let (ctrl, trap, ex_stage) = match decode_instruction(inst, if_entry.pc, &d) {
-            Ok(c) => (c, None, None),
-            Err(t) => (ControlSignals::default(), Some(t), Some(ExceptionStage::Decode)),
+        let (d, ctrl, trap, ex_stage) = match cpu.decode_cache.decode(if_entry.pc, inst) {
+            Ok((d, c)) => (d, c, None, None),
+            Err(t) => (
+                instruction_decode(inst),
+                ControlSignals::default(),
+                Some(t),
+                Some(ExceptionStage::Decode),
+            ),
         };
 
         // Check for intra-bundle hazards (superscalar, in-order only).
@@ -400,10 +510,10 @@ pub fn decode_stage(cpu: &mut Cpu, input: &mut Vec<IfIdEntry>, output: &mut Vec<
         let rs3_idx = inst.rs3();
         if !cpu.has_register_renaming {
             let hazard = ((!d.rs1.is_zero() || ctrl.rs1_fp)
-                && bundle_writes.contains(&(d.rs1, ctrl.rs1_fp)))
+                && written(&bundle_writes, d.rs1, ctrl.rs1_fp))
                 || ((!d.rs2.is_zero() || ctrl.rs2_fp)
-                    && bundle_writes.contains(&(d.rs2, ctrl.rs2_fp)))
-                || (ctrl.rs3_fp && bundle_writes.contains(&(rs3_idx, true)));
+                    && written(&bundle_writes, d.rs2, ctrl.rs2_fp))
+                || (ctrl.rs3_fp && written(&bundle_writes, rs3_idx, true));
 
             if hazard {
                 break;
@@ -411,10 +521,10 @@ pub fn decode_stage(cpu: &mut Cpu, input: &mut Vec<IfIdEntry>, output: &mut Vec<
         }
 
         if ctrl.reg_write && !d.rd.is_zero() {
-            bundle_writes.push((d.rd, false));
+            bundle_writes[0] |= 1 << d.rd.as_usize();
         }
         if ctrl.fp_reg_write {
-            bundle_writes.push((d.rd, true));
+            bundle_writes[1] |= 1 << d.rd.as_usize();
         }
 
         let rv1 = if ctrl.rs1_fp { cpu.regs.read_f(d.rs1) } else { cpu.regs.read(d.rs1) };
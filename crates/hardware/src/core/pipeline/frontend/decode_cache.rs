@@ -0,0 +1,130 @@
+//! Decoded-Instruction Cache.
+//!
+//! A host-side memo of `decode` + `decode_instruction` results so hot loops
+//! are not re-decoded on every pass through the frontend. It is not a modeled
+//! structure and has no effect on timing. It performs the following:
+//! 1. **Indexing:** Direct-mapped on the fetch PC (halfword granularity, so
+//!    compressed and standard instructions share the table).
+//! 2. **Tagging:** Each entry is tagged with both the PC and the (expanded)
+//!    instruction bits it was decoded from. Fetch re-reads the bits every
+//!    time, so self-modifying code, `fence.i`, and `sfence.vma` remappings are
+//!    observed on the next lookup without explicit invalidation.
+//! 3. **Fill policy:** Only successful decodes are cached; instructions that
+//!    raise a decode trap are decoded from scratch each time.
+
+use crate::common::error::Trap;
+use crate::core::pipeline::frontend::decode::decode_instruction;
+use crate::core::pipeline::signals::ControlSignals;
+use crate::isa::decode::decode as instruction_decode;
+use crate::isa::instruction::Decoded;
+
+/// Number of entries (power of two).
+pub const DECODE_CACHE_ENTRIES: usize = 2048;
+
+/// Tag of an empty entry (fetch PCs are always halfword-aligned).
+const INVALID_PC: u64 = u64::MAX;
+
+#[derive(Clone, Copy, Debug)]
+struct Entry {
+    pc: u64,
+    inst: u32,
+    decoded: Decoded,
+    ctrl: ControlSignals,
+}
+
+/// Direct-mapped cache of decoded instructions.
+#[derive(Debug)]
+pub struct DecodeCache {
+    entries: Box<[Entry]>,
+}
+
+impl Default for DecodeCache {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl DecodeCache {
+    /// Creates an empty cache.
+    pub fn new() -> Self {
+        let empty = Entry {
+            pc: INVALID_PC,
+            inst: 0,
+            decoded: Decoded::default(),
+            ctrl: ControlSignals::default(),
+        };
+        Self { entries: vec![empty; DECODE_CACHE_ENTRIES].into_boxed_slice() }
+    }
+
+    /// Decodes `inst` fetched at `pc`, reusing a previous decode when possible.
+    ///
+    /// Equivalent to `decode` followed by `decode_instruction`.
+    ///
+    /// # Errors
+    ///
+    /// Returns the decode trap (illegal instruction, `ebreak`, ...) raised by
+    /// `decode_instruction`.
+    #[inline]
+    pub fn decode(&mut self, pc: u64, inst: u32) -> Result<(Decoded, ControlSignals), Trap> {
+        let entry = &mut self.entries[((pc >> 1) as usize) & (DECODE_CACHE_ENTRIES - 1)];
+        if entry.pc == pc && entry.inst == inst {
+            return Ok((entry.decoded, entry.ctrl));
+        }
+        let decoded = instruction_decode(inst);
+        let ctrl = decode_instruction(inst, pc, &decoded)?;
+        *entry = Entry { pc, inst, decoded, ctrl };
+        Ok((decoded, ctrl))
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    /// `addi x1, x0, 5`
+    const ADDI: u32 = 0x0050_0093;
+    /// `add x3, x1, x2`
+    const ADD: u32 = 0x0020_81B3;
+
+    #[test]
+    fn test_hit_matches_fresh_decode() {
+        let mut cache = DecodeCache::new();
+        let _ = cache.decode(0x8000_0000, ADDI).unwrap();
+        let (d, c) = cache.decode(0x8000_0000, ADDI).unwrap();
+        let fresh = instruction_decode(ADDI);
+        assert_eq!(d.raw, fresh.raw);
+        assert_eq!(d.imm, 5);
+        assert!(c.reg_write);
+    }
+
+    #[test]
+    fn test_changed_bits_are_redecoded() {
+        let mut cache = DecodeCache::new();
+        let _ = cache.decode(0x8000_0000, ADDI).unwrap();
+        // Same PC, new code (self-modifying code or a remapped page).
+        let (d, _) = cache.decode(0x8000_0000, ADD).unwrap();
+        assert_eq!(d.raw, ADD);
+        assert_eq!(d.rd.as_usize(), 3);
+    }
+
+    #[test]
+    fn test_aliasing_pcs_do_not_hit() {
+        let mut cache = DecodeCache::new();
+        let alias = 0x8000_0000 + 2 * DECODE_CACHE_ENTRIES as u64;
+        let _ = cache.decode(0x8000_0000, ADDI).unwrap();
+        let (d, _) = cache.decode(alias, ADD).unwrap();
+        assert_eq!(d.raw, ADD);
+        let (d, _) = cache.decode(0x8000_0000, ADDI).unwrap();
+        assert_eq!(d.raw, ADDI);
+    }
+
+    #[test]
+    fn test_decode_traps_are_not_cached() {
+        let mut cache = DecodeCache::new();
+        // `ebreak` traps with its own PC, so it must never be served stale.
+        let ebreak = 0x0010_0073;
+        assert!(matches!(cache.decode(0x100, ebreak), Err(Trap::Breakpoint(0x100))));
+        assert!(matches!(cache.decode(0x100, ebreak), Err(Trap::Breakpoint(0x100))));
+    }
+}
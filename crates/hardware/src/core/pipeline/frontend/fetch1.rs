@@ -17,6 +17,7 @@ use crate::common::{
 };
 use crate::core::Cpu;
 use crate::core::arch::csr;
+use crate::core::pipeline::engine::lanes;
 use crate::core::pipeline::latches::Fetch1Fetch2Entry;
 use crate::core::units::bru::{BranchPredictor, Ghr};
 use crate::isa::abi;
@@ -27,8 +28,13 @@ use crate::trace_fetch;
 /// Executes the Fetch1 stage: PC generation + I-TLB + branch prediction.
 ///
 /// Produces entries in the Fetch1->Fetch2 latch with physical addresses
-/// and prediction information.
-pub fn fetch1_stage(cpu: &mut Cpu, output: &mut Vec<Fetch1Fetch2Entry>, stall_out: &mut u64) {
+/// and prediction information. `W` is the specialized pipeline width (see
+/// [`lanes`]).
+pub fn fetch1_stage<const W: usize>(
+    cpu: &mut Cpu,
+    output: &mut Vec<Fetch1Fetch2Entry>,
+    stall_out: &mut u64,
+) {
     output.clear();
 
     let mut current_pc = cpu.pc;
@@ -42,7 +48,7 @@ pub fn fetch1_stage(cpu: &mut Cpu, output: &mut Vec<Fetch1Fetch2Entry>, stall_ou
     let line_bytes = cpu.i_cache_line_bytes as u64;
     let line_end = (current_pc | (line_bytes - 1)) + 1; // end of current cache line
 
-    for _ in 0..cpu.pipeline_width {
+    for _ in 0..lanes::<W>(cpu.pipeline_width) {
         // Stop if fewer than 2 bytes remain in this cache line (minimum instruction size).
         if current_pc + 2 > line_end {
             break;
@@ -15,6 +15,8 @@
 //!   `pending` → `output`. The I-cache is NOT re-accessed on delivery
 //!   (the line was already installed on the miss), so there is exactly
 //!   one miss stat and zero spurious hit stats per miss event.
+//! - **FDIP hit:** A hit on a line whose fetch-directed prefetch is still
+//!   in flight stalls like a miss, for the remaining fill latency only.
 
 // RISC-V instructions may be misaligned (compressed 16-bit instructions); read_unaligned is intentional.
 #![allow(clippy::cast_ptr_alignment)]
@@ -22,6 +24,7 @@
 use crate::common::constants::{COMPRESSED_INSTRUCTION_MASK, COMPRESSED_INSTRUCTION_VALUE};
 use crate::common::{AccessType, ExceptionStage, InstSize, Trap, VirtAddr};
 use crate::core::Cpu;
+use crate::core::pipeline::frontend::ftq::FetchTargetQueue;
 use crate::core::pipeline::latches::{Fetch1Fetch2Entry, IfIdEntry};
 use crate::isa::rvc::expand::expand;
 use crate::{trace_fetch, trace_trap};
@@ -34,12 +37,15 @@ use crate::{trace_fetch, trace_trap};
 /// - On an I-cache **miss**, decoded instructions go into `pending`
 ///   and `stall_out` is set to the miss penalty. The caller delivers
 ///   `pending` when the stall expires (without re-probing the cache).
+///
+/// Hits are checked against the FDIP prefetches tracked in `ftq`.
 pub fn fetch2_stage(
     cpu: &mut Cpu,
     input: &mut Vec<Fetch1Fetch2Entry>,
     output: &mut Vec<IfIdEntry>,
     pending: &mut Vec<IfIdEntry>,
     stall_out: &mut u64,
+    ftq: &mut FetchTargetQueue,
 ) {
     output.clear();
     pending.clear();
@@ -67,8 +73,17 @@ pub fn fetch2_stage(
             }
             last_line = this_line;
 
-            let penalty = cpu.simulate_memory_access(f1.paddr, AccessType::Fetch);
-            icache_penalty += penalty;
+            let penalty = cpu.simulate_memory_access_at(
+                f1.paddr,
+                AccessType::Fetch,
+                f1.pc,
+                cpu.i_cache_line_bytes as u64,
+            );
+            icache_penalty += if penalty == 0 {
+                ftq.demand_hit(cpu, this_line, cpu.stats.cycles)
+            } else {
+                penalty
+            };
         }
     }
 
@@ -82,8 +97,9 @@ pub fn fetch2_stage(
     };
 
     // --- Consume input and decode ---
-    let entries = std::mem::take(input);
-
+    // Drained rather than consumed so the latch keeps its capacity.
+    #[allow(clippy::iter_with_drain)]
+    let entries = input.drain(..);
     for f1 in entries {
         // Propagate traps from Fetch1
         if let Some(ref trap) = f1.trap {
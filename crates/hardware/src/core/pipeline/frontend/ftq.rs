@@ -0,0 +1,276 @@
+//! Fetch Target Queue (FTQ) and fetch-directed instruction prefetching (FDIP).
+//!
+//! With a nonzero FTQ depth the branch-prediction unit is decoupled from the
+//! I-cache: Fetch1 acts as the BPU and runs ahead of fetch, predicting one
+//! fetch block (a run of sequential instructions within one cache line,
+//! ending at a predicted-taken control transfer) per cycle into the queue.
+//! Fetch2 consumes blocks from the head, so an I-cache miss stalls fetch
+//! but not prediction, and the BPU keeps enqueueing up to the configured depth.
+//!
+//! FDIP issues a prefetch for each block's line as it is enqueued. The fill
+//! installs the line into the L1I, and its arrival cycle is tracked here. When
+//! Fetch2 later demands the line, it waits only for the part of the fill that
+//! has not yet elapsed.
+//!
+//! Reference: Reinman, Calder, Austin, "Fetch Directed Instruction
+//! Prefetching", MICRO 1999.
+
+use crate::common::PhysAddr;
+use crate::config::FtqConfig;
+use crate::core::Cpu;
+use crate::core::pipeline::latches::Fetch1Fetch2Entry;
+use std::collections::VecDeque;
+
+/// Prefetched lines remembered per FTQ entry before the oldest are dropped.
+const INFLIGHT_PER_ENTRY: usize = 2;
+
+/// An FDIP prefetch awaiting its demand fetch.
+#[derive(Clone, Copy, Debug)]
+struct Prefetch {
+    /// Physical line address.
+    line: u64,
+    /// Cycle at which the fill reaches the L1I.
+    ready: u64,
+}
+
+/// Queue of predicted fetch blocks between the BPU and Fetch2.
+#[derive(Debug)]
+pub struct FetchTargetQueue {
+    /// Maximum number of blocks held (0 = coupled frontend).
+    depth: usize,
+    /// Issue fetch-directed prefetches for enqueued blocks.
+    fdip: bool,
+    /// Predicted blocks, oldest first.
+    blocks: VecDeque<Vec<Fetch1Fetch2Entry>>,
+    /// Emptied block buffers reused to avoid a per-block allocation.
+    pool: Vec<Vec<Fetch1Fetch2Entry>>,
+    /// Prefetched lines not yet demanded, oldest first.
+    inflight: VecDeque<Prefetch>,
+    /// The BPU enqueued a faulting block and must wait for the redirect.
+    halted: bool,
+}
+
+impl FetchTargetQueue {
+    /// Creates a queue from the FTQ configuration.
+    pub fn new(config: &FtqConfig) -> Self {
+        Self {
+            depth: config.depth,
+            fdip: config.fdip,
+            blocks: VecDeque::with_capacity(config.depth),
+            pool: Vec::with_capacity(config.depth),
+            inflight: VecDeque::with_capacity(config.depth * INFLIGHT_PER_ENTRY),
+            halted: false,
+        }
+    }
+
+    /// Returns `true` when the frontend is decoupled (nonzero depth).
+    pub const fn is_enabled(&self) -> bool {
+        self.depth > 0
+    }
+
+    /// Number of blocks currently queued.
+    pub fn len(&self) -> usize {
+        self.blocks.len()
+    }
+
+    /// Returns `true` when no blocks are queued.
+    pub fn is_empty(&self) -> bool {
+        self.blocks.is_empty()
+    }
+
+    /// Returns `true` when the BPU cannot enqueue another block.
+    pub fn is_full(&self) -> bool {
+        self.blocks.len() >= self.depth
+    }
+
+    /// Returns `true` while the BPU waits for a redirect after a fault.
+    pub const fn is_halted(&self) -> bool {
+        self.halted
+    }
+
+    /// Takes an empty buffer for the BPU to predict the next block into.
+    pub fn take_buffer(&mut self) -> Vec<Fetch1Fetch2Entry> {
+        self.pool.pop().unwrap_or_default()
+    }
+
+    /// Enqueues a predicted block and issues its FDIP prefetch.
+    ///
+    /// An empty block returns its buffer to the pool. A block ending in a
+    /// fetch fault halts the BPU, since everything behind it is squashed
+    /// when the fault reaches commit.
+    pub fn push(&mut self, cpu: &mut Cpu, block: Vec<Fetch1Fetch2Entry>) {
+        let Some(first) = block.first() else {
+            self.pool.push(block);
+            return;
+        };
+        if block.last().is_some_and(|e| e.trap.is_some()) {
+            self.halted = true;
+        }
+        if self.fdip && first.trap.is_none() {
+            self.prefetch(cpu, first.paddr);
+        }
+        self.blocks.push_back(block);
+    }
+
+    /// Moves the head block into `latch`, which must be empty.
+    ///
+    /// Returns `false` if the queue is empty.
+    pub fn pop_into(&mut self, latch: &mut Vec<Fetch1Fetch2Entry>) -> bool {
+        let Some(block) = self.blocks.pop_front() else {
+            return false;
+        };
+        self.pool.push(std::mem::replace(latch, block));
+        true
+    }
+
+    /// Discards all queued blocks (on a redirect).
+    ///
+    /// In-flight prefetches are kept: their fills still arrive and a
+    /// corrected path may demand them.
+    pub fn flush(&mut self) {
+        while let Some(mut block) = self.blocks.pop_front() {
+            block.clear();
+            self.pool.push(block);
+        }
+        self.halted = false;
+    }
+
+    /// Prefetches the line holding `paddr` unless the L1I already has it.
+    fn prefetch(&mut self, cpu: &mut Cpu, paddr: PhysAddr) {
+        let line = paddr.val() & !(cpu.i_cache_line_bytes as u64 - 1);
+        if self.inflight.iter().any(|p| p.line == line) {
+            return;
+        }
+        let Some(latency) = cpu.prefetch_inst_line(PhysAddr::new(line)) else {
+            return;
+        };
+        cpu.stats.fdip_prefetches += 1;
+        if self.inflight.len() >= self.depth * INFLIGHT_PER_ENTRY {
+            let _ = self.inflight.pop_front();
+        }
+        self.inflight.push_back(Prefetch { line, ready: cpu.stats.cycles + latency });
+    }
+
+    /// Accounts a Fetch2 demand hit on `line` at cycle `now`.
+    ///
+    /// Returns the cycles still to wait if the hit is on an FDIP fill that
+    /// has not yet arrived, and 0 otherwise. Each prefetched line is
+    /// credited once, as useful if its fill had arrived or late if not.
+    pub fn demand_hit(&mut self, cpu: &mut Cpu, line: u64, now: u64) -> u64 {
+        let Some(pos) = self.inflight.iter().position(|p| p.line == line) else {
+            return 0;
+        };
+        let Some(Prefetch { ready, .. }) = self.inflight.remove(pos) else {
+            return 0;
+        };
+        if ready > now {
+            cpu.stats.fdip_late += 1;
+            ready - now
+        } else {
+            cpu.stats.fdip_useful += 1;
+            0
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::PhysAddr;
+    use crate::config::Config;
+    use crate::core::units::bru::Ghr;
+    use crate::soc::builder::System;
+
+    fn entry(pc: u64) -> Fetch1Fetch2Entry {
+        Fetch1Fetch2Entry {
+            pc,
+            paddr: PhysAddr::new(pc),
+            pred_taken: false,
+            pred_target: 0,
+            trap: None,
+            exception_stage: None,
+            ghr_snapshot: Ghr::default(),
+            ras_snapshot: 0,
+        }
+    }
+
+    fn setup(depth: usize) -> (Cpu, FetchTargetQueue) {
+        let mut config = Config::default();
+        config.pipeline.ftq.depth = depth;
+        config.cache.l1_i.enabled = true;
+        let cpu = Cpu::new(System::new(&config, ""), &config);
+        (cpu, FetchTargetQueue::new(&config.pipeline.ftq))
+    }
+
+    #[test]
+    fn test_depth_zero_is_disabled() {
+        let (_, ftq) = setup(0);
+        assert!(!ftq.is_enabled());
+        assert!(ftq.is_full());
+    }
+
+    #[test]
+    fn test_push_pop_in_order_and_fill_limit() {
+        let (mut cpu, mut ftq) = setup(2);
+        ftq.push(&mut cpu, vec![entry(0x8000_0000)]);
+        ftq.push(&mut cpu, vec![entry(0x8000_0040)]);
+        assert!(ftq.is_full());
+
+        let mut latch = Vec::new();
+        assert!(ftq.pop_into(&mut latch));
+        assert_eq!(latch[0].pc, 0x8000_0000);
+        latch.clear();
+        assert!(ftq.pop_into(&mut latch));
+        assert_eq!(latch[0].pc, 0x8000_0040);
+        assert!(!ftq.pop_into(&mut latch));
+    }
+
+    #[test]
+    fn test_empty_block_is_not_queued() {
+        let (mut cpu, mut ftq) = setup(2);
+        let buf = ftq.take_buffer();
+        ftq.push(&mut cpu, buf);
+        assert!(ftq.is_empty());
+    }
+
+    #[test]
+    fn test_faulting_block_halts_until_flush() {
+        let (mut cpu, mut ftq) = setup(4);
+        let mut bad = entry(0x8000_0001);
+        bad.trap = Some(crate::common::Trap::InstructionAddressMisaligned(0x8000_0001));
+        ftq.push(&mut cpu, vec![bad]);
+        assert!(ftq.is_halted());
+        ftq.flush();
+        assert!(ftq.is_empty());
+        assert!(!ftq.is_halted());
+    }
+
+    #[test]
+    fn test_prefetch_credits_late_then_useful() {
+        let (mut cpu, mut ftq) = setup(4);
+        ftq.push(&mut cpu, vec![entry(0x8000_0000)]);
+        assert_eq!(cpu.stats.fdip_prefetches, 1);
+        assert_eq!(cpu.stats.icache_misses, 0, "a prefetch is not a demand miss");
+        assert!(cpu.l1_i_cache.contains(0x8000_0000));
+
+        // Demanded immediately: the fill is still in flight.
+        let now = cpu.stats.cycles;
+        assert!(ftq.demand_hit(&mut cpu, 0x8000_0000, now) > 0);
+        assert_eq!(cpu.stats.fdip_late, 1);
+        // Credited once only.
+        assert_eq!(ftq.demand_hit(&mut cpu, 0x8000_0000, now), 0);
+
+        ftq.push(&mut cpu, vec![entry(0x8000_1000)]);
+        assert_eq!(ftq.demand_hit(&mut cpu, 0x8000_1000, u64::MAX), 0);
+        assert_eq!(cpu.stats.fdip_useful, 1);
+    }
+
+    #[test]
+    fn test_resident_line_is_not_prefetched() {
+        let (mut cpu, mut ftq) = setup(4);
+        ftq.push(&mut cpu, vec![entry(0x8000_0000)]);
+        ftq.flush();
+        ftq.push(&mut cpu, vec![entry(0x8000_0010)]);
+        assert_eq!(cpu.stats.fdip_prefetches, 1);
+    }
+}
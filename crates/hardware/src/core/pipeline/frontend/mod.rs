@@ -2,21 +2,32 @@
 //!
 //! The frontend is generic over the execution engine and handles:
 //! Fetch1 -> Fetch2 -> Decode -> Rename
+//!
+//! With a nonzero FTQ depth, Fetch1 is a decoupled branch-prediction unit
+//! that fills the fetch target queue, and Fetch2 consumes it (see [`ftq`]).
 
 pub mod decode;
+pub mod decode_cache;
 pub mod fetch1;
 pub mod fetch2;
+pub mod ftq;
 pub mod rename;
 
-use crate::core::pipeline::engine::ExecutionEngine;
+use crate::config::FtqConfig;
+use crate::core::pipeline::engine::{ExecutionEngine, lanes};
 use crate::core::pipeline::latches::{Fetch1Fetch2Entry, IdExEntry, IfIdEntry, RenameIssueEntry};
+use crate::core::pipeline::tma::{self, FetchBubble};
+use crate::stats::{Stage, StageTimer};
+use ftq::FetchTargetQueue;
 use std::marker::PhantomData;
 
 /// The frontend pipeline, generic over the execution engine.
 ///
 /// Same frontend code works with `InOrderEngine` and (future) `O3Engine`.
+/// `W` is the pipeline width the frontend is specialized for, or 0 to use
+/// the configured width (see [`lanes`]).
 #[derive(Debug)]
-pub struct Frontend<E: ExecutionEngine> {
+pub struct Frontend<E: ExecutionEngine, const W: usize = 0> {
     /// Fetch1 -> Fetch2 latch.
     pub fetch1_fetch2: Vec<Fetch1Fetch2Entry>,
     /// Fetch2 -> Decode latch (reuses `IfIdEntry` for I-cache result).
@@ -32,12 +43,20 @@ pub struct Frontend<E: ExecutionEngine> {
     /// expires these are moved to `fetch2_decode` without re-accessing the
     /// I-cache (the line was already installed on the miss).
     fetch2_pending: Vec<IfIdEntry>,
+    /// Empty buffer that rename swaps `decode_rename` into and consumes.
+    rename_scratch: Vec<IdExEntry>,
+    /// Predicted fetch blocks between Fetch1 (the BPU) and Fetch2.
+    pub ftq: FetchTargetQueue,
+    /// Refilling after a flush: set by [`Self::flush`], cleared once rename
+    /// delivers again.
+    resteer: bool,
     _marker: PhantomData<E>,
 }
 
-impl<E: ExecutionEngine> Frontend<E> {
-    /// Creates a new frontend with the given pipeline width.
-    pub fn new(width: usize) -> Self {
+impl<E: ExecutionEngine, const W: usize> Frontend<E, W> {
+    /// Creates a new frontend with the given pipeline width and FTQ.
+    pub fn new(width: usize, ftq: &FtqConfig) -> Self {
+        let width = lanes::<W>(width);
         Self {
             fetch1_fetch2: Vec::with_capacity(width),
             fetch2_decode: Vec::with_capacity(width),
@@ -45,6 +64,9 @@ impl<E: ExecutionEngine> Frontend<E> {
             fetch1_stall: 0,
             fetch2_stall: 0,
             fetch2_pending: Vec::with_capacity(width),
+            rename_scratch: Vec::with_capacity(width),
+            ftq: FetchTargetQueue::new(ftq),
+            resteer: false,
             _marker: PhantomData,
         }
     }
@@ -57,7 +79,23 @@ impl<E: ExecutionEngine> Frontend<E> {
         rename_output: &mut Vec<RenameIssueEntry>,
     ) {
         // Rename: decode_rename -> engine (ROB alloc)
-        rename::rename_stage(cpu, &mut self.decode_rename, engine, rename_output);
+        let capacity = engine.can_accept();
+        let waiting = self.decode_rename.len();
+        let bubble = self.fetch_bubble();
+        let timer = StageTimer::start();
+        rename::rename_stage(
+            cpu,
+            &mut self.decode_rename,
+            &mut self.rename_scratch,
+            engine,
+            rename_output,
+        );
+        timer.stop(&mut cpu.stats.stage_times, Stage::Rename);
+        let delivered = waiting.saturating_sub(self.decode_rename.len());
+        tma::account_slots::<W, E>(cpu, engine, capacity, waiting, delivered, bubble);
+        if delivered > 0 {
+            self.resteer = false;
+        }
 
         // Decode: fetch2_decode -> decode_rename
         // Only run decode when rename has consumed the previous output;
@@ -65,7 +103,9 @@ impl<E: ExecutionEngine> Frontend<E> {
         // rename can't drain it (e.g. ROB full), causing unbounded growth
         // and O(n²) behaviour as rename re-scans the growing vec each cycle.
         if self.decode_rename.is_empty() {
+            let timer = StageTimer::start();
             decode::decode_stage(cpu, &mut self.fetch2_decode, &mut self.decode_rename);
+            timer.stop(&mut cpu.stats.stage_times, Stage::Decode);
         }
 
         // Fetch2: fetch1_fetch2 -> fetch2_decode (gated by fetch2_stall or backpressure)
@@ -77,13 +117,21 @@ impl<E: ExecutionEngine> Frontend<E> {
                 self.fetch2_decode.append(&mut self.fetch2_pending);
             }
         } else if self.fetch2_decode.is_empty() {
+            let timer = StageTimer::start();
             fetch2::fetch2_stage(
                 cpu,
                 &mut self.fetch1_fetch2,
                 &mut self.fetch2_decode,
                 &mut self.fetch2_pending,
                 &mut self.fetch2_stall,
+                &mut self.ftq,
             );
+            timer.stop(&mut cpu.stats.stage_times, Stage::Fetch2);
+        }
+
+        if self.ftq.is_enabled() {
+            self.tick_decoupled(cpu);
+            return;
         }
 
         // Fetch1: PC gen -> fetch1_fetch2 (gated by fetch1_stall or backpressure)
@@ -93,17 +141,63 @@ impl<E: ExecutionEngine> Frontend<E> {
             // Only run F1 when F2 has consumed the previous output;
             // otherwise F1 would clear the latch and overwrite entries
             // that F2 still needs to process.
-            fetch1::fetch1_stage(cpu, &mut self.fetch1_fetch2, &mut self.fetch1_stall);
+            let timer = StageTimer::start();
+            fetch1::fetch1_stage::<W>(cpu, &mut self.fetch1_fetch2, &mut self.fetch1_stall);
+            timer.stop(&mut cpu.stats.stage_times, Stage::Fetch1);
+        }
+    }
+
+    /// Why fetch would leave an empty rename slot this cycle.
+    fn fetch_bubble(&self) -> FetchBubble {
+        if self.fetch2_stall > 0 && !self.fetch2_pending.is_empty() {
+            FetchBubble::ICache
+        } else if self.fetch2_stall > 0 || (self.fetch1_stall > 0 && self.ftq.is_empty()) {
+            // Fetch2 stalls without pending instructions on a page-crossing
+            // translation; a Fetch1 stall matters once the FTQ has drained.
+            FetchBubble::ITlb
+        } else if self.resteer {
+            FetchBubble::Resteer
+        } else {
+            FetchBubble::Bandwidth
+        }
+    }
+
+    /// Fetch1 as a decoupled BPU: predicts into the FTQ, then hands the
+    /// head block to Fetch2.
+    ///
+    /// The BPU runs whenever the queue has room, regardless of Fetch2
+    /// stalls. A block predicted this cycle can be delivered this cycle when
+    /// the queue was empty, so decoupling adds no latency over the coupled
+    /// frontend.
+    fn tick_decoupled(&mut self, cpu: &mut crate::core::Cpu) {
+        cpu.stats.ftq_occupancy += self.ftq.len() as u64;
+
+        if self.fetch1_stall > 0 {
+            self.fetch1_stall -= 1;
+        } else if self.ftq.is_full() {
+            cpu.stats.stalls_ftq_full += 1;
+        } else if !self.ftq.is_halted() {
+            let timer = StageTimer::start();
+            let mut block = self.ftq.take_buffer();
+            fetch1::fetch1_stage::<W>(cpu, &mut block, &mut self.fetch1_stall);
+            self.ftq.push(cpu, block);
+            timer.stop(&mut cpu.stats.stage_times, Stage::Fetch1);
+        }
+
+        if self.fetch1_fetch2.is_empty() {
+            let _ = self.ftq.pop_into(&mut self.fetch1_fetch2);
         }
     }
 
-    /// Flushes all frontend latches and stall counters.
+    /// Flushes all frontend latches, the FTQ, and stall counters.
     pub fn flush(&mut self) {
+        self.ftq.flush();
         self.fetch1_fetch2.clear();
         self.fetch2_decode.clear();
         self.fetch2_pending.clear();
         self.decode_rename.clear();
         self.fetch1_stall = 0;
         self.fetch2_stall = 0;
+        self.resteer = true;
     }
 }
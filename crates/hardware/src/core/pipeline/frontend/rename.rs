@@ -17,16 +17,22 @@ use crate::trace_rename;
 
 /// Executes the rename stage: allocate ROB/SB entries, capture source tags, mark scoreboard.
 ///
+/// Entries are consumed from `scratch`, which must be empty: `input` is
+/// swapped into it, so entries pushed back into `input` and the next
+/// cycle's decode output reuse storage instead of reallocating it.
+///
 /// # Panics
 ///
 /// Panics if checkpoint allocation fails after the stall check indicated a slot was available.
 pub fn rename_stage<E: ExecutionEngine>(
     cpu: &mut Cpu,
     input: &mut Vec<IdExEntry>,
+    scratch: &mut Vec<IdExEntry>,
     engine: &mut E,
     rename_output: &mut Vec<RenameIssueEntry>,
 ) {
-    let entries = std::mem::take(input);
+    debug_assert!(scratch.is_empty(), "rename scratch latch must start empty");
+    std::mem::swap(input, scratch);
 
     // Compute the dispatch budget once. can_accept() returns
     // min(rob_free, sb_free, iq_free, width). During the loop below,
@@ -37,6 +43,9 @@ pub fn rename_stage<E: ExecutionEngine>(
     // dispatch failures in the next backend tick.
     let mut budget = engine.can_accept();
 
+    // Drained rather than consumed so the buffer keeps its capacity.
+    #[allow(clippy::iter_with_drain)]
+    let entries = scratch.drain(..);
     for id in entries {
         // Check if engine can accept more instructions
         if budget == 0 {
@@ -111,6 +120,13 @@ pub fn rename_stage<E: ExecutionEngine>(
 
             // Update speculative rename map and mark PRF not-ready
             if needs_dst {
+                if engine.checkpoint_count() > 0 {
+                    engine.checkpoint_table_mut().record_rename(
+                        id.rd,
+                        id.ctrl.fp_reg_write,
+                        old_phys_dst,
+                    );
+                }
                 engine.rename_map_mut().set(id.rd, id.ctrl.fp_reg_write, rd_phys);
                 engine.prf_mut().allocate(rd_phys);
             }
@@ -135,12 +151,9 @@ pub fn rename_stage<E: ExecutionEngine>(
                 }
             }
 
-            // Allocate checkpoint for branch/jump (snapshot rename map *after* rd rename)
+            // Allocate checkpoint for branch/jump (rename state *after* rd rename)
             if is_branch_or_jump && engine.checkpoint_count() > 0 {
-                let map_snapshot = engine.rename_map().clone();
-
-                let Some(ckpt_id) = engine.checkpoint_table_mut().allocate(rob_tag, &map_snapshot)
-                else {
+                let Some(ckpt_id) = engine.checkpoint_table_mut().allocate(rob_tag) else {
                     unreachable!("checkpoint table full after stall check");
                 };
 
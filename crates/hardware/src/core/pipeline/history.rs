@@ -0,0 +1,266 @@
+//! Pipeline history: a ring buffer of compact per-cycle latch records.
+//!
+//! [`PipelineHistory`] keeps the last `cycles` detailed cycles of pipeline
+//! state so a viewer can rewind around a mispredict or a stall without
+//! re-simulating. Unlike a [`PipelineSnapshot`](super::snapshot::PipelineSnapshot),
+//! a record holds only the identity of each in-flight instruction (PC,
+//! encoding, and ROB tag) plus the stall counters. All storage is allocated
+//! up front: every cycle overwrites the oldest record in place, so
+//! recording allocates nothing.
+//!
+//! Each latch keeps at most `width` slots per cycle. For the issue queue
+//! these are its `width` oldest entries, and the full occupancy is kept in
+//! [`HistoryFrame::issue_queue_len`].
+
+/// An inter-stage latch recorded by [`PipelineHistory`].
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Latch {
+    /// Fetch1 → Fetch2.
+    Fetch1Fetch2,
+    /// Fetch2 → Decode.
+    Fetch2Decode,
+    /// Decode → Rename.
+    DecodeRename,
+    /// Rename → Issue (pending dispatch).
+    RenameIssue,
+    /// Issue queue (oldest entries).
+    IssueQueue,
+    /// Execute → Memory1.
+    ExecuteMem1,
+    /// Memory1 → Memory2.
+    Mem1Mem2,
+    /// Memory2 → Writeback.
+    Mem2Wb,
+}
+
+impl Latch {
+    /// Number of recorded latches.
+    pub const COUNT: usize = 8;
+
+    /// Every latch, in pipeline order.
+    pub const ALL: [Self; Self::COUNT] = [
+        Self::Fetch1Fetch2,
+        Self::Fetch2Decode,
+        Self::DecodeRename,
+        Self::RenameIssue,
+        Self::IssueQueue,
+        Self::ExecuteMem1,
+        Self::Mem1Mem2,
+        Self::Mem2Wb,
+    ];
+
+    /// Latch name, matching the `PipelineSnapshot` field it records.
+    pub const fn name(self) -> &'static str {
+        match self {
+            Self::Fetch1Fetch2 => "fetch1_fetch2",
+            Self::Fetch2Decode => "fetch2_decode",
+            Self::DecodeRename => "decode_rename",
+            Self::RenameIssue => "rename_issue",
+            Self::IssueQueue => "issue_queue",
+            Self::ExecuteMem1 => "execute_mem1",
+            Self::Mem1Mem2 => "mem1_mem2",
+            Self::Mem2Wb => "mem2_wb",
+        }
+    }
+}
+
+/// One recorded latch slot.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct HistorySlot {
+    /// Instruction address.
+    pub pc: u64,
+    /// Instruction encoding (0 in Fetch1, before the I-cache returns it).
+    pub inst: u32,
+    /// ROB tag (0 before rename; live tags are never 0).
+    pub rob_tag: u32,
+}
+
+/// Per-cycle header of a [`PipelineHistory`] record.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct HistoryFrame {
+    /// Value of `stats.cycles` after the recorded tick.
+    pub cycle: u64,
+    /// Fetch1 stall cycles remaining.
+    pub fetch1_stall: u64,
+    /// Fetch2 stall cycles remaining.
+    pub fetch2_stall: u64,
+    /// Memory1 stall cycles remaining (always 0 on the O3 backend).
+    pub mem1_stall: u64,
+    /// Issue queue occupancy, including entries beyond the recorded `width`.
+    pub issue_queue_len: u32,
+    /// Recorded slots per latch, indexed by `Latch as usize`.
+    lens: [u16; Latch::COUNT],
+    /// Bit `i` set if recorded issue queue slot `i` still waits for an operand.
+    issue_waiting: u64,
+}
+
+/// Fixed-capacity ring of the last N cycles of pipeline state.
+///
+/// Records are laid out at a fixed stride of [`Latch::COUNT`] × `width`
+/// slots, so a record is found by index arithmetic alone.
+#[derive(Clone, Debug)]
+pub struct PipelineHistory {
+    /// Record headers, `capacity` long.
+    frames: Vec<HistoryFrame>,
+    /// Record slots, `capacity × Latch::COUNT × width` long.
+    slots: Vec<HistorySlot>,
+    /// Slots per latch per record.
+    width: usize,
+    /// Index of the oldest record.
+    head: usize,
+    /// Records held.
+    len: usize,
+}
+
+impl PipelineHistory {
+    /// Creates a history holding the last `cycles` cycles of a `width`-wide
+    /// pipeline (at least one of each).
+    pub fn new(cycles: usize, width: usize) -> Self {
+        let (cycles, width) = (cycles.max(1), width.max(1));
+        Self {
+            frames: vec![HistoryFrame::default(); cycles],
+            slots: vec![HistorySlot::default(); cycles * Latch::COUNT * width],
+            width,
+            head: 0,
+            len: 0,
+        }
+    }
+
+    /// Maximum number of cycles held.
+    pub const fn capacity(&self) -> usize {
+        self.frames.len()
+    }
+
+    /// Slots recorded per latch per cycle.
+    pub const fn width(&self) -> usize {
+        self.width
+    }
+
+    /// Number of cycles held.
+    pub const fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns `true` if no cycle has been recorded.
+    pub const fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Drops every record, keeping the storage.
+    pub const fn clear(&mut self) {
+        self.head = 0;
+        self.len = 0;
+    }
+
+    /// Returns record `i`, counting from the oldest held.
+    pub fn get(&self, i: usize) -> Option<HistoryRecord<'_>> {
+        if i >= self.len {
+            return None;
+        }
+        let index = (self.head + i) % self.capacity();
+        let stride = Latch::COUNT * self.width;
+        Some(HistoryRecord {
+            frame: &self.frames[index],
+            slots: &self.slots[index * stride..(index + 1) * stride],
+            width: self.width,
+        })
+    }
+
+    /// Returns the record of `cycle`, if it is still held.
+    ///
+    /// Records are in cycle order but may skip cycles (functional or WFI
+    /// idle time), so this is a binary search.
+    pub fn find(&self, cycle: u64) -> Option<HistoryRecord<'_>> {
+        let slot = |i| (self.head + i) % self.capacity();
+        let (mut lo, mut hi) = (0, self.len);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            match self.frames[slot(mid)].cycle.cmp(&cycle) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => return self.get(mid),
+            }
+        }
+        None
+    }
+
+    /// Iterates over the records, oldest first.
+    pub fn iter(&self) -> impl Iterator<Item = HistoryRecord<'_>> {
+        (0..self.len).filter_map(|i| self.get(i))
+    }
+
+    /// Starts the record for `cycle`, overwriting the oldest once full.
+    pub fn push(&mut self, cycle: u64) -> FrameWriter<'_> {
+        let capacity = self.capacity();
+        let index = (self.head + self.len) % capacity;
+        if self.len == capacity {
+            self.head = (self.head + 1) % capacity;
+        } else {
+            self.len += 1;
+        }
+        let frame = &mut self.frames[index];
+        *frame = HistoryFrame { cycle, ..HistoryFrame::default() };
+        let stride = Latch::COUNT * self.width;
+        FrameWriter {
+            frame,
+            slots: &mut self.slots[index * stride..(index + 1) * stride],
+            width: self.width,
+        }
+    }
+}
+
+/// Fills in one record of a [`PipelineHistory`].
+#[derive(Debug)]
+pub struct FrameWriter<'a> {
+    frame: &'a mut HistoryFrame,
+    slots: &'a mut [HistorySlot],
+    width: usize,
+}
+
+impl FrameWriter<'_> {
+    /// Mutable access to the record header (stall counters, queue length).
+    pub const fn frame(&mut self) -> &mut HistoryFrame {
+        self.frame
+    }
+
+    /// Appends a slot to `latch`. Slots beyond the record width are dropped.
+    pub fn push(&mut self, latch: Latch, pc: u64, inst: u32, rob_tag: u32) {
+        let n = usize::from(self.frame.lens[latch as usize]);
+        if n < self.width {
+            self.slots[latch as usize * self.width + n] = HistorySlot { pc, inst, rob_tag };
+            self.frame.lens[latch as usize] += 1;
+        }
+    }
+
+    /// Appends an issue queue slot, noting whether it waits for an operand.
+    pub fn push_issue(&mut self, pc: u64, inst: u32, rob_tag: u32, waiting: bool) {
+        let n = usize::from(self.frame.lens[Latch::IssueQueue as usize]);
+        if waiting && n < self.width.min(64) {
+            self.frame.issue_waiting |= 1 << n;
+        }
+        self.push(Latch::IssueQueue, pc, inst, rob_tag);
+    }
+}
+
+/// A borrowed view of one cycle in a [`PipelineHistory`].
+#[derive(Clone, Copy, Debug)]
+pub struct HistoryRecord<'a> {
+    /// Record header.
+    pub frame: &'a HistoryFrame,
+    slots: &'a [HistorySlot],
+    width: usize,
+}
+
+impl<'a> HistoryRecord<'a> {
+    /// Slots of `latch` this cycle, oldest first.
+    pub fn latch(&self, latch: Latch) -> &'a [HistorySlot] {
+        let start = latch as usize * self.width;
+        &self.slots[start..start + usize::from(self.frame.lens[latch as usize])]
+    }
+
+    /// Whether issue queue slot `i` was waiting for an operand (tracked for
+    /// the first 64 slots).
+    pub const fn issue_waiting(&self, i: usize) -> bool {
+        i < 64 && self.frame.issue_waiting & (1 << i) != 0
+    }
+}
@@ -56,3 +56,9 @@ pub mod backend;
 
 /// Point-in-time pipeline state snapshot.
 pub mod snapshot;
+
+/// Ring buffer of recent per-cycle pipeline state.
+pub mod history;
+
+/// Top-down (TMA) issue-slot accounting.
+pub mod tma;
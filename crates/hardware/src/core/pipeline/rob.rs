@@ -8,13 +8,11 @@
 //! 4. **Forwarding:** Provides the most recent result for any register from in-flight instructions.
 //! 5. **Flush:** Squashes speculative entries after a misprediction or trap.
 
-use std::collections::HashMap;
-
 use crate::common::error::{ExceptionStage, LrScRecord, PteUpdate, SfenceVmaInfo, Trap};
 use crate::common::{CsrAddr, InstSize, RegIdx};
 use crate::core::pipeline::checkpoint::CheckpointId;
 use crate::core::pipeline::prf::PhysReg;
-use crate::core::pipeline::signals::ControlSignals;
+use crate::core::pipeline::signals::{ControlSignals, VectorOp};
 use crate::core::units::bru::Ghr;
 
 /// Branch outcome recorded at execute time for deferred predictor update.
@@ -31,8 +29,12 @@ pub struct BpOutcome {
 
 /// Unique tag identifying an in-flight instruction in the ROB.
 ///
-/// Tags are monotonically increasing (wrapping at `u32::MAX` back to 1,
-/// skipping 0). Comparisons between in-flight tags must use
+/// A tag is `(generation << slot_bits) | slot`: the low bits are the ROB slot
+/// the instruction occupies, so lookup is a mask and compare. The generation
+/// advances whenever allocation wraps or the ROB is flushed, which keeps tags
+/// monotonically increasing (wrapping at `u32::MAX`, skipping 0) and makes
+/// stale tags of squashed instructions never match a reused slot.
+/// Comparisons between in-flight tags must use
 /// [`RobTag::is_older_than`] / [`RobTag::is_newer_than`] which handle
 /// wraparound via signed-distance arithmetic.
 #[derive(Clone, Copy, Debug, PartialEq, Eq, Hash, Default)]
@@ -163,10 +165,12 @@ pub struct Rob {
     tail: usize,
     /// Number of valid entries.
     count: usize,
-    /// Monotonically increasing tag counter.
-    next_tag: u32,
-    /// O(1) tag → slot index lookup.
-    tag_index: HashMap<RobTag, usize>,
+    /// Generation encoded in the high bits of tags allocated at `tail`.
+    generation: u32,
+    /// Number of low tag bits holding the slot index.
+    slot_bits: u32,
+    /// Entries squashed by flushes since the last [`Self::take_squashed`].
+    squashed: u64,
 }
 
 impl Rob {
@@ -179,8 +183,24 @@ impl Rob {
             head: 0,
             tail: 0,
             count: 0,
-            next_tag: 1,
-            tag_index: HashMap::with_capacity(capacity),
+            generation: 1,
+            slot_bits: capacity.next_power_of_two().trailing_zeros(),
+            squashed: 0,
+        }
+    }
+
+    /// Slot index encoded in `tag`.
+    #[inline]
+    const fn slot_of(&self, tag: RobTag) -> usize {
+        (tag.0 & ((1u32 << self.slot_bits) - 1)) as usize
+    }
+
+    /// Starts a new tag generation, skipping the one that would produce tag 0.
+    #[inline]
+    const fn advance_generation(&mut self) {
+        self.generation = self.generation.wrapping_add(1);
+        if (self.generation << self.slot_bits) == 0 {
+            self.generation = 1;
         }
     }
 
@@ -231,11 +251,7 @@ impl Rob {
             return None;
         }
 
-        let tag = RobTag(self.next_tag);
-        self.next_tag = self.next_tag.wrapping_add(1);
-        if self.next_tag == 0 {
-            self.next_tag = 1; // skip 0
-        }
+        let tag = RobTag((self.generation << self.slot_bits) | self.tail as u32);
 
         self.entries[self.tail] = RobEntry {
             tag,
@@ -267,8 +283,10 @@ impl Rob {
             checkpoint_id: None,
         };
 
-        let _ = self.tag_index.insert(tag, self.tail);
         self.tail = (self.tail + 1) % self.entries.len();
+        if self.tail == 0 {
+            self.advance_generation();
+        }
         self.count += 1;
         Some(tag)
     }
@@ -416,6 +434,8 @@ impl Rob {
 
     /// Commits (retires) the head entry. Returns the entry if it was Completed or Faulted.
     /// Returns `None` if the ROB is empty or the head is still Issued.
+    ///
+    /// The entry is moved out of its slot (which is left invalid) rather than cloned.
     pub fn commit_head(&mut self) -> Option<RobEntry> {
         if self.count == 0 {
             return None;
@@ -426,9 +446,7 @@ impl Rob {
             return None; // not ready
         }
 
-        let committed = self.entries[self.head].clone();
-        let _ = self.tag_index.remove(&committed.tag);
-        self.entries[self.head].valid = false;
+        let committed = std::mem::take(&mut self.entries[self.head]);
         self.head = (self.head + 1) % self.entries.len();
         self.count -= 1;
         Some(committed)
@@ -436,10 +454,11 @@ impl Rob {
 
     /// Flushes all entries from the ROB.
     pub fn flush_all(&mut self) {
+        self.squashed += self.count as u64;
         for entry in &mut self.entries {
             entry.valid = false;
         }
-        self.tag_index.clear();
+        self.advance_generation();
         self.head = 0;
         self.tail = 0;
         self.count = 0;
@@ -452,18 +471,9 @@ impl Rob {
             return;
         }
 
-        // Find the index of the entry with this tag
-        let mut idx = self.head;
-        let mut found = false;
-        for _ in 0..self.count {
-            if self.entries[idx].tag == tag {
-                found = true;
-                break;
-            }
-            idx = (idx + 1) % self.entries.len();
-        }
-
-        if !found {
+        // Locate the entry with this tag
+        let idx = self.slot_of(tag);
+        if idx >= self.entries.len() || !self.entries[idx].valid || self.entries[idx].tag != tag {
             return;
         }
 
@@ -480,13 +490,15 @@ impl Rob {
 
         let mut remove_idx = keep_idx;
         while remove_idx != self.tail {
-            let _ = self.tag_index.remove(&self.entries[remove_idx].tag);
             self.entries[remove_idx].valid = false;
             remove_idx = (remove_idx + 1) % self.entries.len();
         }
 
         self.tail = keep_idx;
+        // Squashed tags must not match the instructions that reuse their slots.
+        self.advance_generation();
         // Recount
+        let before = self.count;
         self.count = 0;
         let mut i = self.head;
         loop {
@@ -498,6 +510,13 @@ impl Rob {
             }
             i = (i + 1) % self.entries.len();
         }
+        self.squashed += (before - self.count) as u64;
+    }
+
+    /// Returns the entries squashed by flushes since the last call, and
+    /// resets the count.
+    pub const fn take_squashed(&mut self) -> u64 {
+        std::mem::replace(&mut self.squashed, 0)
     }
 
     /// Finds the latest in-flight result for a given register.
@@ -586,10 +605,11 @@ impl Rob {
     }
 
     /// Finds a mutable reference to the entry with the given tag.
+    #[inline]
     fn find_entry_mut(&mut self, tag: RobTag) -> Option<&mut RobEntry> {
-        let idx = *self.tag_index.get(&tag)?;
-        let entry = &mut self.entries[idx];
-        if entry.valid { Some(entry) } else { None }
+        let idx = self.slot_of(tag);
+        let entry = self.entries.get_mut(idx)?;
+        if entry.valid && entry.tag == tag { Some(entry) } else { None }
     }
 
     /// Iterate over all valid entries from head to tail, calling `f` on each.
@@ -607,10 +627,11 @@ impl Rob {
     }
 
     /// Finds a reference to the entry with the given tag.
+    #[inline]
     pub fn find_entry(&self, tag: RobTag) -> Option<&RobEntry> {
-        let idx = *self.tag_index.get(&tag)?;
-        let entry = &self.entries[idx];
-        if entry.valid { Some(entry) } else { None }
+        let idx = self.slot_of(tag);
+        let entry = self.entries.get(idx)?;
+        if entry.valid && entry.tag == tag { Some(entry) } else { None }
     }
 
     /// Iterate over all valid entries from head to tail in program order.
@@ -679,6 +700,28 @@ impl Rob {
         true // tag not found in ROB (shouldn't happen)
     }
 
+    /// Returns true if any ROB entry older than `tag` is a vector instruction.
+    ///
+    /// Vector instructions update vector state (and `vl`, `fflags`) only
+    /// when they commit, so system/CSR instructions wait for older ones to
+    /// retire rather than merely complete.
+    pub fn has_vector_before(&self, tag: RobTag) -> bool {
+        let mut idx = self.head;
+        for _ in 0..self.count {
+            let entry = &self.entries[idx];
+            if entry.valid {
+                if entry.tag == tag {
+                    return false;
+                }
+                if entry.ctrl.vector != VectorOp::None {
+                    return true;
+                }
+            }
+            idx = (idx + 1) % self.entries.len();
+        }
+        false
+    }
+
     /// Returns true if all older ROB entries matching a FENCE's predecessor
     /// set have completed (Completed or Faulted).
     ///
@@ -871,6 +914,42 @@ mod tests {
         assert_eq!(entry.pc, 0x1000);
     }
 
+    #[test]
+    fn test_squashed_tag_does_not_match_reused_slot() {
+        let mut rob = Rob::new(4);
+        let t1 = alloc(&mut rob, 0x1000, 1, make_ctrl(true, false)).unwrap();
+        let stale = alloc(&mut rob, 0x1004, 2, make_ctrl(true, false)).unwrap();
+        rob.flush_after(t1);
+
+        // The new instruction takes the squashed one's slot with a new tag.
+        let fresh = alloc(&mut rob, 0x2000, 3, make_ctrl(true, false)).unwrap();
+        assert_ne!(fresh, stale);
+        assert!(fresh.is_newer_than(stale));
+
+        // A late completion for the squashed tag must be ignored.
+        rob.complete(stale, 7);
+        assert!(rob.find_entry(stale).is_none());
+        assert_eq!(rob.find_entry(fresh).unwrap().state, RobState::Issued);
+    }
+
+    #[test]
+    fn test_tags_increase_across_wraps_and_flushes() {
+        let mut rob = Rob::new(3);
+        let mut prev = RobTag(0);
+        for i in 0..20 {
+            let tag = alloc(&mut rob, i * 4, 1, make_ctrl(true, false)).unwrap();
+            assert!(tag.is_newer_than(prev));
+            assert_ne!(tag.0, 0);
+            prev = tag;
+            if i % 5 == 4 {
+                rob.flush_all();
+            } else {
+                rob.complete(tag, i);
+                assert_eq!(rob.commit_head().unwrap().result, Some(i));
+            }
+        }
+    }
+
     #[test]
     fn test_find_latest_result() {
         let mut rob = Rob::new(8);
@@ -66,6 +66,84 @@ pub enum AluOp {
     /// Integer remainder (unsigned).
     Remu,
 
+    /// Shift left by 1 and add (`sh1add`; `sh1add.uw` when 32-bit).
+    Sh1Add,
+
+    /// Shift left by 2 and add (`sh2add`; `sh2add.uw` when 32-bit).
+    Sh2Add,
+
+    /// Shift left by 3 and add (`sh3add`; `sh3add.uw` when 32-bit).
+    Sh3Add,
+
+    /// Add zero-extended low word of the first operand (`add.uw`).
+    AddUw,
+
+    /// Shift left zero-extended low word (`slli.uw`).
+    SllUw,
+
+    /// AND with inverted second operand.
+    Andn,
+
+    /// OR with inverted second operand.
+    Orn,
+
+    /// Bitwise exclusive NOR.
+    Xnor,
+
+    /// Count leading zeros.
+    Clz,
+
+    /// Count trailing zeros.
+    Ctz,
+
+    /// Count set bits.
+    Cpop,
+
+    /// Signed maximum.
+    Max,
+
+    /// Unsigned maximum.
+    Maxu,
+
+    /// Signed minimum.
+    Min,
+
+    /// Unsigned minimum.
+    Minu,
+
+    /// Sign-extend the low byte.
+    SextB,
+
+    /// Sign-extend the low halfword.
+    SextH,
+
+    /// Zero-extend the low halfword.
+    ZextH,
+
+    /// Rotate left.
+    Rol,
+
+    /// Rotate right.
+    Ror,
+
+    /// Set each byte to all ones if it is nonzero (`orc.b`).
+    OrcB,
+
+    /// Reverse the byte order.
+    Rev8,
+
+    /// Clear a single bit.
+    Bclr,
+
+    /// Extract a single bit.
+    Bext,
+
+    /// Invert a single bit.
+    Binv,
+
+    /// Set a single bit.
+    Bset,
+
     /// Floating-point addition.
     FAdd,
 
@@ -198,6 +276,30 @@ pub enum AtomicOp {
     Maxu,
 }
 
+/// Vector instruction classification (RVV).
+///
+/// Vector instructions pass through the scalar pipeline without scalar
+/// memory or ALU side effects and are executed by the vector unit when they
+/// commit.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Default)]
+pub enum VectorOp {
+    /// Not a vector instruction.
+    #[default]
+    None,
+
+    /// Vector configuration (`vsetvli`, `vsetivli`, `vsetvl`).
+    SetVl,
+
+    /// Vector arithmetic, mask, permutation, or move instruction.
+    Arith,
+
+    /// Vector load.
+    Load,
+
+    /// Vector store.
+    Store,
+}
+
 /// Memory access width for load and store operations.
 #[derive(Clone, Copy, Debug, Default)]
 pub enum MemWidth {
@@ -358,4 +460,6 @@ pub struct ControlSignals {
     pub rs3_fp: bool,
     /// Atomic memory operation type.
     pub atomic_op: AtomicOp,
+    /// Vector instruction class.
+    pub vector: VectorOp,
 }
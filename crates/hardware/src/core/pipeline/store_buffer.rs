@@ -7,6 +7,12 @@
 //! 3. **Forwarding:** Provide store-to-load forwarding for loads that hit a pending store.
 //! 4. **Commit:** Mark entries as committed when the ROB retires the store.
 //! 5. **Drain:** Write committed stores to memory one per cycle.
+//!
+//! Entries are allocated in program order, so the ring from head to tail is
+//! sorted by age and a ROB tag is located by binary search. Resolved stores
+//! are also indexed by cache line (a hashed bucket per line holding a bitset of
+//! ring slots), and unresolved ones by a pending bitset, so forwarding and
+//! ordering checks only visit stores that can actually conflict.
 
 use crate::common::{PhysAddr, VirtAddr};
 use crate::core::pipeline::rob::RobTag;
@@ -85,6 +91,139 @@ pub struct StoreBufferEntry {
     pub valid: bool,
 }
 
+/// Log2 of the granule resolved stores are indexed by.
+const INDEX_LINE_SHIFT: u32 = 6;
+
+/// Slot bitsets indexing the store buffer ring.
+#[derive(Debug)]
+struct SlotIndex {
+    /// `words` words per bucket: the slots of resolved stores touching a
+    /// line that hashes to the bucket.
+    lines: Box<[u64]>,
+    /// Slots whose address is still unresolved.
+    pending: Box<[u64]>,
+    /// Words per bitset.
+    words: usize,
+    /// Bucket count minus one (bucket count is a power of two).
+    bucket_mask: usize,
+}
+
+impl SlotIndex {
+    fn new(capacity: usize) -> Self {
+        let words = capacity.div_ceil(64).max(1);
+        let buckets = (2 * capacity).next_power_of_two().max(1);
+        Self {
+            lines: vec![0; buckets * words].into_boxed_slice(),
+            pending: vec![0; words].into_boxed_slice(),
+            words,
+            bucket_mask: buckets - 1,
+        }
+    }
+
+    /// First and last line touched by an access of `size` bytes at `addr`.
+    #[inline]
+    const fn line_span(addr: u64, size: usize) -> [u64; 2] {
+        let last = addr + (size as u64).saturating_sub(1);
+        [addr >> INDEX_LINE_SHIFT, last >> INDEX_LINE_SHIFT]
+    }
+
+    /// First word of the bitset of the bucket `line` hashes to.
+    #[inline]
+    const fn bucket(&self, line: u64) -> usize {
+        let hash = (line.wrapping_mul(0x9E37_79B9_7F4A_7C15) >> 32) as usize;
+        (hash & self.bucket_mask) * self.words
+    }
+
+    #[inline]
+    const fn bit(slot: usize) -> (usize, u64) {
+        (slot / 64, 1 << (slot % 64))
+    }
+
+    /// Indexes the resolved store in `slot` covering `size` bytes at `addr`.
+    fn insert(&mut self, slot: usize, addr: u64, size: usize) {
+        let (word, bit) = Self::bit(slot);
+        for line in Self::line_span(addr, size) {
+            let base = self.bucket(line);
+            self.lines[base + word] |= bit;
+        }
+    }
+
+    /// Removes the resolved store in `slot` covering `size` bytes at `addr`.
+    fn remove(&mut self, slot: usize, addr: u64, size: usize) {
+        let (word, bit) = Self::bit(slot);
+        for line in Self::line_span(addr, size) {
+            let base = self.bucket(line);
+            self.lines[base + word] &= !bit;
+        }
+    }
+
+    fn set_pending(&mut self, slot: usize, pending: bool) {
+        let (word, bit) = Self::bit(slot);
+        if pending {
+            self.pending[word] |= bit;
+        } else {
+            self.pending[word] &= !bit;
+        }
+    }
+
+    /// Adds `entry` (in `slot`) to the index according to its resolution.
+    fn add(&mut self, slot: usize, entry: &StoreBufferEntry) {
+        match entry.resolution {
+            StoreResolution::Pending => self.set_pending(slot, true),
+            StoreResolution::Ready { paddr, .. } | StoreResolution::Committed { paddr, .. } => {
+                self.insert(slot, paddr.val(), width_to_bytes(entry.width));
+            }
+            StoreResolution::Cancelled => {}
+        }
+    }
+
+    /// Removes `entry` (in `slot`) from the index.
+    fn discard(&mut self, slot: usize, entry: &StoreBufferEntry) {
+        match entry.resolution {
+            StoreResolution::Pending => self.set_pending(slot, false),
+            StoreResolution::Ready { paddr, .. } | StoreResolution::Committed { paddr, .. } => {
+                self.remove(slot, paddr.val(), width_to_bytes(entry.width));
+            }
+            StoreResolution::Cancelled => {}
+        }
+    }
+
+    fn clear(&mut self) {
+        self.lines.fill(0);
+        self.pending.fill(0);
+    }
+
+    /// Calls `f` with every slot that may hold a resolved store overlapping
+    /// `size` bytes at `addr` (bucket collisions yield extra candidates).
+    #[inline]
+    fn for_each_candidate(&self, addr: u64, size: usize, mut f: impl FnMut(usize)) {
+        let [first, last] = Self::line_span(addr, size);
+        let (a, b) = (self.bucket(first), self.bucket(last));
+        for word in 0..self.words {
+            let mut bits = self.lines[a + word] | self.lines[b + word];
+            while bits != 0 {
+                f(word * 64 + bits.trailing_zeros() as usize);
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    /// Calls `f` with every unresolved slot until it returns `true`.
+    #[inline]
+    fn any_pending(&self, mut f: impl FnMut(usize) -> bool) -> bool {
+        for (word, &w) in self.pending.iter().enumerate() {
+            let mut bits = w;
+            while bits != 0 {
+                if f(word * 64 + bits.trailing_zeros() as usize) {
+                    return true;
+                }
+                bits &= bits - 1;
+            }
+        }
+        false
+    }
+}
+
 /// Store buffer — FIFO queue of pending stores.
 #[derive(Debug)]
 pub struct StoreBuffer {
@@ -95,6 +234,8 @@ pub struct StoreBuffer {
     tail: usize,
     /// Number of valid entries.
     count: usize,
+    /// Line and pending-slot index over `entries`.
+    index: SlotIndex,
 }
 
 impl StoreBuffer {
@@ -102,7 +243,44 @@ impl StoreBuffer {
     pub fn new(capacity: usize) -> Self {
         let mut entries = Vec::with_capacity(capacity);
         entries.resize_with(capacity, StoreBufferEntry::default);
-        Self { entries, head: 0, tail: 0, count: 0 }
+        Self { entries, head: 0, tail: 0, count: 0, index: SlotIndex::new(capacity) }
+    }
+
+    /// Returns the ring slot holding `rob_tag`, by binary search over the
+    /// age-ordered ring.
+    fn slot_of(&self, rob_tag: RobTag) -> Option<usize> {
+        let cap = self.entries.len();
+        let (mut lo, mut hi) = (0, self.count);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let slot = (self.head + mid) % cap;
+            let tag = self.entries[slot].rob_tag;
+            if tag == rob_tag {
+                return Some(slot);
+            }
+            if tag.is_older_than(rob_tag) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        None
+    }
+
+    /// Age of `slot` (0 = oldest entry).
+    #[inline]
+    const fn age(&self, slot: usize) -> usize {
+        (slot + self.entries.len() - self.head) % self.entries.len()
+    }
+
+    /// Rebuilds the index after the ring has been compacted.
+    fn reindex(&mut self) {
+        self.index.clear();
+        let cap = self.entries.len();
+        for i in 0..self.count {
+            let slot = (self.head + i) % cap;
+            self.index.add(slot, &self.entries[slot]);
+        }
     }
 
     /// Returns the capacity.
@@ -170,6 +348,7 @@ impl StoreBuffer {
             resolution: StoreResolution::Pending,
             valid: true,
         };
+        self.index.set_pending(self.tail, true);
 
         self.tail = (self.tail + 1) % self.entries.len();
         self.count += 1;
@@ -178,9 +357,12 @@ impl StoreBuffer {
 
     /// Resolves a store's address and data after memory translation.
     pub fn resolve(&mut self, rob_tag: RobTag, vaddr: VirtAddr, paddr: PhysAddr, data: u64) {
-        if let Some(entry) = self.find_by_tag_mut(rob_tag) {
+        if let Some(slot) = self.slot_of(rob_tag) {
+            let entry = &mut self.entries[slot];
+            self.index.discard(slot, entry);
             entry.vaddr = vaddr;
             entry.resolution = StoreResolution::Ready { paddr, data };
+            self.index.add(slot, entry);
         }
     }
 
@@ -218,82 +400,53 @@ impl StoreBuffer {
         let load_start = paddr.val();
         let load_end = load_start + load_size as u64;
 
-        // Search from newest to oldest for the most recent matching store
-        let mut idx = if self.tail == 0 { self.entries.len() - 1 } else { self.tail - 1 };
-
-        for _ in 0..self.count {
-            let entry = &self.entries[idx];
-            if entry.valid {
-                // Skip stores that are newer than or same age as the load —
-                // they are after the load in program order and must not forward.
-                if !entry.rob_tag.is_older_than(load_rob_tag) {
-                    if idx == 0 {
-                        idx = self.entries.len() - 1;
-                    } else {
-                        idx -= 1;
-                    }
-                    continue;
-                }
-
-                // Older store — check for overlap based on resolution state.
-                match entry.resolution {
-                    StoreResolution::Ready { paddr: store_paddr, data: store_data }
-                    | StoreResolution::Committed { paddr: store_paddr, data: store_data } => {
-                        let store_size = width_to_bytes(entry.width);
-                        let store_start = store_paddr.val();
-                        let store_end = store_start + store_size as u64;
-
-                        // Check for any overlap
-                        if load_start < store_end && load_end > store_start {
-                            // Full overlap: store completely covers the load
-                            if store_start <= load_start && store_end >= load_end {
-                                let offset = (load_start - store_start) as u32;
-                                let shifted = store_data >> (offset * 8);
-                                let mask = if load_size >= 8 {
-                                    u64::MAX
-                                } else {
-                                    (1u64 << (load_size * 8)) - 1
-                                };
-                                return ForwardResult::Hit(shifted & mask);
-                            }
-                            // Partial overlap: must stall
-                            return ForwardResult::Stall;
-                        }
-                    }
-                    // Pending or Cancelled: no resolved address to check.
-                    // (Loads are not issued until all older stores have their
-                    // addresses resolved, so Pending is handled at issue time.)
-                    _ => {}
-                }
+        // The most recent older store overlapping the load decides.
+        let mut newest: Option<(usize, u64, u64, u64)> = None;
+        self.index.for_each_candidate(load_start, load_size, |slot| {
+            let entry = &self.entries[slot];
+            // Stores newer than or same age as the load are after it in
+            // program order and must not forward.
+            if !entry.rob_tag.is_older_than(load_rob_tag) {
+                return;
             }
-            if idx == 0 {
-                idx = self.entries.len() - 1;
-            } else {
-                idx -= 1;
+            // Only resolved stores are indexed. (Loads are not issued until all
+            // older stores have their addresses resolved, so Pending is handled
+            // at issue time.)
+            let (StoreResolution::Ready { paddr: store_paddr, data }
+            | StoreResolution::Committed { paddr: store_paddr, data }) = entry.resolution
+            else {
+                return;
+            };
+            let store_start = store_paddr.val();
+            let store_end = store_start + width_to_bytes(entry.width) as u64;
+            let age = self.age(slot);
+            if load_start < store_end
+                && load_end > store_start
+                && newest.is_none_or(|(a, ..)| age > a)
+            {
+                newest = Some((age, store_start, store_end, data));
             }
-        }
+        });
 
-        ForwardResult::Miss
+        let Some((_, store_start, store_end, store_data)) = newest else {
+            return ForwardResult::Miss;
+        };
+        // Full overlap: store completely covers the load
+        if store_start <= load_start && store_end >= load_end {
+            let offset = (load_start - store_start) as u32;
+            let shifted = store_data >> (offset * 8);
+            let mask = if load_size >= 8 { u64::MAX } else { (1u64 << (load_size * 8)) - 1 };
+            return ForwardResult::Hit(shifted & mask);
+        }
+        // Partial overlap: must stall
+        ForwardResult::Stall
     }
 
     /// Checks whether any store buffer entry older than `rob_tag` has an
     /// unresolved address. Used by the issue queue to prevent loads from
     /// issuing before older stores have their addresses resolved.
     pub fn has_unresolved_store_before(&self, rob_tag: RobTag) -> bool {
-        if self.count == 0 {
-            return false;
-        }
-        let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            let entry = &self.entries[idx];
-            if entry.valid && entry.rob_tag.is_older_than(rob_tag) && entry.resolution.is_pending()
-            {
-                return true;
-            }
-            idx = (idx + 1) % cap;
-        }
-        false
+        self.index.any_pending(|slot| self.entries[slot].rob_tag.is_older_than(rob_tag))
     }
 
     /// Checks whether a specific store is unresolved (no address yet).
@@ -302,56 +455,32 @@ impl StoreBuffer {
     /// resolved address (Pending state). Returns `false` if the store is
     /// resolved, committed, or not found (stale tag).
     pub fn is_unresolved(&self, rob_tag: RobTag) -> bool {
-        if self.count == 0 {
-            return false;
-        }
-        let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            let entry = &self.entries[idx];
-            if entry.valid && entry.rob_tag == rob_tag {
-                return entry.resolution.is_pending();
-            }
-            idx = (idx + 1) % cap;
-        }
-        false
+        self.slot_of(rob_tag).is_some_and(|slot| self.entries[slot].resolution.is_pending())
     }
 
     /// Checks whether any store buffer entry older than `rob_tag` overlaps
     /// the given physical address range. Used by LR/AMO to stall until older
     /// stores to the same address have drained, preserving atomicity.
     pub fn has_older_store_to(&self, paddr: PhysAddr, width: MemWidth, rob_tag: RobTag) -> bool {
-        if self.count == 0 {
-            return false;
+        // Unresolved store to unknown address — must assume overlap
+        if self.has_unresolved_store_before(rob_tag) {
+            return true;
         }
-        let load_size = width_to_bytes(width) as u64;
+        let load_size = width_to_bytes(width);
         let load_start = paddr.val();
-        let load_end = load_start + load_size;
-        let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            let entry = &self.entries[idx];
-            if entry.valid && entry.rob_tag.is_older_than(rob_tag) {
-                match entry.resolution {
-                    // Unresolved store to unknown address — must assume overlap
-                    StoreResolution::Pending => return true,
-                    // Resolved store — check for address overlap
-                    StoreResolution::Ready { paddr: store_paddr, .. }
-                    | StoreResolution::Committed { paddr: store_paddr, .. } => {
-                        let store_size = width_to_bytes(entry.width) as u64;
-                        let store_start = store_paddr.val();
-                        let store_end = store_start + store_size;
-                        if load_start < store_end && load_end > store_start {
-                            return true;
-                        }
-                    }
-                    // Cancelled: no-op, cannot overlap
-                    StoreResolution::Cancelled => {}
-                }
+        let load_end = load_start + load_size as u64;
+        let mut overlap = false;
+        self.index.for_each_candidate(load_start, load_size, |slot| {
+            let entry = &self.entries[slot];
+            if let Some(store_paddr) = entry.resolution.paddr()
+                && entry.rob_tag.is_older_than(rob_tag)
+            {
+                let store_start = store_paddr.val();
+                let store_end = store_start + width_to_bytes(entry.width) as u64;
+                overlap |= load_start < store_end && load_end > store_start;
             }
-            idx = (idx + 1) % cap;
-        }
-        false
+        });
+        overlap
     }
 
     /// Drains (removes) the oldest committed store. Returns it so the caller
@@ -367,6 +496,7 @@ impl StoreBuffer {
         }
 
         let drained = self.entries[self.head].clone();
+        self.index.discard(self.head, &drained);
         self.entries[self.head].valid = false;
         self.head = (self.head + 1) % self.entries.len();
         self.count -= 1;
@@ -401,6 +531,7 @@ impl StoreBuffer {
 
         self.tail = new_tail;
         self.count = new_count;
+        self.reindex();
     }
 
     /// Flushes store buffer entries allocated *after* the given ROB tag.
@@ -441,6 +572,7 @@ impl StoreBuffer {
 
         self.tail = new_tail;
         self.count = new_count;
+        self.reindex();
     }
 
     /// Flushes all entries (including committed ones).
@@ -451,57 +583,37 @@ impl StoreBuffer {
         self.head = 0;
         self.tail = 0;
         self.count = 0;
+        self.index.clear();
     }
 
     /// Cancels (removes) a store buffer entry that will not be written.
     /// Used for failed SC (store-conditional) instructions.
     pub fn cancel(&mut self, rob_tag: RobTag) {
+        let Some(slot) = self.slot_of(rob_tag) else { return };
         let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            if self.entries[idx].valid && self.entries[idx].rob_tag == rob_tag {
-                // If this is the tail entry, we can simply retract it
-                let prev_tail = if self.tail == 0 { cap - 1 } else { self.tail - 1 };
-                if idx == prev_tail {
-                    self.entries[idx].valid = false;
-                    self.tail = prev_tail;
-                    self.count -= 1;
-                } else {
-                    // Not at tail — mark as cancelled no-op that drain_one will
-                    // pass through without writing to memory.
-                    self.entries[idx].resolution = StoreResolution::Cancelled;
-                }
-                return;
-            }
-            idx = (idx + 1) % cap;
+        self.index.discard(slot, &self.entries[slot]);
+        // If this is the tail entry, we can simply retract it
+        let prev_tail = if self.tail == 0 { cap - 1 } else { self.tail - 1 };
+        if slot == prev_tail {
+            self.entries[slot].valid = false;
+            self.tail = prev_tail;
+            self.count -= 1;
+        } else {
+            // Not at tail — mark as cancelled no-op that drain_one will
+            // pass through without writing to memory.
+            self.entries[slot].resolution = StoreResolution::Cancelled;
         }
     }
 
     /// Returns the resolved physical address for the entry with the given ROB tag,
     /// or `None` if the entry is not found or has no address yet.
     pub fn find_paddr(&self, rob_tag: RobTag) -> Option<PhysAddr> {
-        let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            if self.entries[idx].valid && self.entries[idx].rob_tag == rob_tag {
-                return self.entries[idx].resolution.paddr();
-            }
-            idx = (idx + 1) % cap;
-        }
-        None
+        self.slot_of(rob_tag).and_then(|slot| self.entries[slot].resolution.paddr())
     }
 
     /// Finds the entry with the given ROB tag.
     fn find_by_tag_mut(&mut self, rob_tag: RobTag) -> Option<&mut StoreBufferEntry> {
-        let cap = self.entries.len();
-        let mut idx = self.head;
-        for _ in 0..self.count {
-            if self.entries[idx].valid && self.entries[idx].rob_tag == rob_tag {
-                return Some(&mut self.entries[idx]);
-            }
-            idx = (idx + 1) % cap;
-        }
-        None
+        self.slot_of(rob_tag).map(|slot| &mut self.entries[slot])
     }
 }
 
@@ -636,4 +748,77 @@ mod tests {
             );
         }
     }
+
+    #[test]
+    fn test_forward_takes_newest_older_store() {
+        let mut sb = StoreBuffer::new(8);
+        for (tag, data) in [(1, 0x11), (2, 0x22), (3, 0x33)] {
+            sb.allocate(RobTag(tag), MemWidth::Double);
+            sb.resolve(RobTag(tag), VirtAddr::new(0), PhysAddr::new(0x8000_0040), data);
+        }
+        let at = PhysAddr::new(0x8000_0040);
+        assert_eq!(sb.forward_load(at, MemWidth::Double, RobTag(4)), ForwardResult::Hit(0x33));
+        assert_eq!(sb.forward_load(at, MemWidth::Double, RobTag(3)), ForwardResult::Hit(0x22));
+        assert_eq!(sb.forward_load(at, MemWidth::Double, RobTag(1)), ForwardResult::Miss);
+    }
+
+    #[test]
+    fn test_line_crossing_store_is_found_from_either_line() {
+        let mut sb = StoreBuffer::new(4);
+        sb.allocate(RobTag(1), MemWidth::Double);
+        // Bytes 0x3C..0x44 straddle two 64-byte lines.
+        sb.resolve(RobTag(1), VirtAddr::new(0), PhysAddr::new(0x8000_003C), u64::MAX);
+        let above = PhysAddr::new(0x8000_0040);
+        assert_eq!(
+            sb.forward_load(above, MemWidth::Word, RobTag(2)),
+            ForwardResult::Hit(0xFFFF_FFFF)
+        );
+        assert!(sb.has_older_store_to(above, MemWidth::Word, RobTag(2)));
+        assert_eq!(sb.forward_load(above, MemWidth::Double, RobTag(2)), ForwardResult::Stall);
+    }
+
+    #[test]
+    fn test_pending_and_cancelled_stores() {
+        let mut sb = StoreBuffer::new(4);
+        sb.allocate(RobTag(1), MemWidth::Word);
+        sb.allocate(RobTag(2), MemWidth::Word);
+        sb.allocate(RobTag(3), MemWidth::Word);
+        assert!(sb.has_unresolved_store_before(RobTag(2)));
+        assert!(!sb.has_unresolved_store_before(RobTag(1)));
+        assert!(sb.is_unresolved(RobTag(2)));
+
+        sb.resolve(RobTag(1), VirtAddr::new(0), PhysAddr::new(0x8000_0000), 1);
+        sb.resolve(RobTag(2), VirtAddr::new(0), PhysAddr::new(0x8000_0100), 2);
+        assert!(!sb.has_unresolved_store_before(RobTag(3)));
+        assert!(sb.has_unresolved_store_before(RobTag(4)));
+        assert!(!sb.has_older_store_to(PhysAddr::new(0x8000_0200), MemWidth::Word, RobTag(3)));
+
+        // A cancelled store can no longer forward.
+        sb.cancel(RobTag(2));
+        let at = PhysAddr::new(0x8000_0100);
+        assert_eq!(sb.forward_load(at, MemWidth::Word, RobTag(4)), ForwardResult::Miss);
+        assert_eq!(sb.find_paddr(RobTag(1)), Some(PhysAddr::new(0x8000_0000)));
+    }
+
+    #[test]
+    fn test_flush_after_reindexes() {
+        let mut sb = StoreBuffer::new(4);
+        // Wrap the ring so the kept entries straddle the end.
+        for tag in 1..=3 {
+            sb.allocate(RobTag(tag), MemWidth::Word);
+            sb.resolve(RobTag(tag), VirtAddr::new(0), PhysAddr::new(0x8000_0000), tag as u64);
+            sb.mark_committed(RobTag(tag));
+            sb.drain_one().unwrap();
+        }
+        for tag in 4..=7 {
+            sb.allocate(RobTag(tag), MemWidth::Word);
+            sb.resolve(RobTag(tag), VirtAddr::new(0), PhysAddr::new(0x8000_0000), tag as u64);
+        }
+        sb.flush_after(RobTag(5));
+        assert_eq!(sb.len(), 2);
+        let at = PhysAddr::new(0x8000_0000);
+        assert_eq!(sb.forward_load(at, MemWidth::Word, RobTag(9)), ForwardResult::Hit(5));
+        assert_eq!(sb.find_paddr(RobTag(6)), None);
+        assert_eq!(sb.find_paddr(RobTag(4)), Some(at));
+    }
 }
@@ -0,0 +1,187 @@
+//! Top-down microarchitecture analysis (TMA) slot accounting.
+//!
+//! Every cycle the frontend ticks, rename has `width` issue slots. Each
+//! slot is attributed to exactly one category at the rename/dispatch
+//! boundary. This is shared by both backends:
+//!
+//! - **Issued:** an instruction was renamed into the backend. It is later
+//!   counted as retiring when it commits, or as bad speculation when a
+//!   flush squashes it from the ROB.
+//! - **Bad speculation (recovery):** dispatch is blocked while the backend
+//!   recovers from a flush (ROB squash walk, rename map rebuild).
+//! - **Backend bound:** the backend could not accept the slot. If the ROB
+//!   head is an unfinished load or store, or the store buffer is full, the
+//!   slot is memory bound, as it is while an in-order memory stage is
+//!   blocked on an access. It is charged to the deepest cache level with a
+//!   demand miss still outstanding, or to L1 when none is. Otherwise the
+//!   slot is core bound, split into FU/port contention (a ready instruction
+//!   found no free unit this cycle) and other execution latency.
+//! - **Frontend bound:** the backend had room but the frontend delivered
+//!   nothing for the slot. It is charged to an I-cache miss, I-TLB
+//!   translation, a branch resteer (refilling after a redirect), or fetch
+//!   bandwidth (taken branches and line boundaries).
+//!
+//! Issued + recovery + backend + frontend equals `tma_slots` exactly.
+//! Retiring + squashed accounts for every issued slot except for the
+//! instructions still in flight.
+//!
+//! Reference: Yasin, "A Top-Down Method for Performance Analysis and
+//! Counters Architecture", ISPASS 2014.
+
+use crate::core::Cpu;
+use crate::core::pipeline::engine::{ExecutionEngine, lanes};
+use crate::core::pipeline::rob::RobState;
+
+/// Level of the memory hierarchy a demand data miss is served from.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, PartialOrd, Ord)]
+pub enum MemLevel {
+    /// L1 data cache (hit, or no miss outstanding).
+    L1 = 0,
+    /// L2 cache.
+    L2 = 1,
+    /// L3 cache.
+    L3 = 2,
+    /// Main memory.
+    Dram = 3,
+}
+
+/// Tracks how long demand data misses past each cache level stay outstanding.
+#[derive(Clone, Debug, Default)]
+pub struct MissTracker {
+    /// Cycle until which a miss past L1, L2, and L3 respectively is outstanding.
+    until: [u64; 3],
+}
+
+impl MissTracker {
+    /// Records a demand data miss served by `level` that completes at cycle `done`.
+    pub fn note(&mut self, level: MemLevel, done: u64) {
+        for until in &mut self.until[..level as usize] {
+            *until = (*until).max(done);
+        }
+    }
+
+    /// Returns the deepest level with a miss still outstanding at cycle `now`.
+    pub const fn deepest(&self, now: u64) -> MemLevel {
+        match self.until {
+            [_, _, l3] if l3 > now => MemLevel::Dram,
+            [_, l2, _] if l2 > now => MemLevel::L3,
+            [l1, _, _] if l1 > now => MemLevel::L2,
+            _ => MemLevel::L1,
+        }
+    }
+}
+
+/// Why the frontend delivered no instruction for a slot, sampled at rename.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum FetchBubble {
+    /// Fetch is waiting on an I-cache miss.
+    ICache,
+    /// Fetch is waiting on I-TLB translation.
+    ITlb,
+    /// The frontend is refilling after a redirect.
+    Resteer,
+    /// None of the above: partial fetch blocks and pipeline fill.
+    Bandwidth,
+}
+
+/// Attributes this cycle's `width` rename slots.
+///
+/// `capacity` is what the backend reported it could accept before rename,
+/// `waiting` the instructions queued at rename, and `delivered` how many
+/// rename moved into the backend. `W` is the specialized pipeline width
+/// (see [`lanes`]).
+pub fn account_slots<const W: usize, E: ExecutionEngine>(
+    cpu: &mut Cpu,
+    engine: &E,
+    capacity: usize,
+    waiting: usize,
+    delivered: usize,
+    bubble: FetchBubble,
+) {
+    let width = lanes::<W>(cpu.pipeline_width);
+    let delivered = delivered.min(width);
+    let stats = &mut cpu.stats;
+    stats.tma_slots += width as u64;
+    let idle = (width - delivered) as u64;
+    if idle == 0 {
+        return;
+    }
+
+    if engine.is_recovering() {
+        stats.tma_bad_speculation += idle;
+        stats.tma_bad_spec_recovery += idle;
+        return;
+    }
+
+    // Slots the backend had room for but the frontend left empty; the rest
+    // (no room, or rename-internal stalls such as a full checkpoint table)
+    // are backend bound.
+    let frontend = (capacity.min(width).saturating_sub(waiting.max(delivered)) as u64).min(idle);
+    let backend = idle - frontend;
+
+    if frontend > 0 {
+        stats.tma_frontend_bound += frontend;
+        *match bubble {
+            FetchBubble::ICache => &mut stats.tma_fe_icache,
+            FetchBubble::ITlb => &mut stats.tma_fe_itlb,
+            FetchBubble::Resteer => &mut stats.tma_fe_resteer,
+            FetchBubble::Bandwidth => &mut stats.tma_fe_bandwidth,
+        } += frontend;
+    }
+
+    if backend > 0 {
+        stats.tma_backend_bound += backend;
+        let head_waits_on_memory = engine.rob().peek_head().is_some_and(|head| {
+            head.state == RobState::Issued && (head.ctrl.mem_read || head.ctrl.mem_write)
+        });
+        if head_waits_on_memory || engine.mem_stalled() || engine.store_buffer().is_full() {
+            stats.tma_be_memory += backend;
+            *match cpu.tma_misses.deepest(stats.cycles) {
+                MemLevel::L1 => &mut stats.tma_be_mem_l1,
+                MemLevel::L2 => &mut stats.tma_be_mem_l2,
+                MemLevel::L3 => &mut stats.tma_be_mem_l3,
+                MemLevel::Dram => &mut stats.tma_be_mem_dram,
+            } += backend;
+        } else {
+            stats.tma_be_core += backend;
+            if engine.fu_contended() {
+                stats.tma_be_core_fu += backend;
+            } else {
+                stats.tma_be_core_other += backend;
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_deepest_outstanding_level() {
+        let mut misses = MissTracker::default();
+        assert_eq!(misses.deepest(0), MemLevel::L1);
+
+        misses.note(MemLevel::L2, 10);
+        misses.note(MemLevel::Dram, 5);
+        assert_eq!(misses.deepest(0), MemLevel::Dram);
+        assert_eq!(misses.deepest(5), MemLevel::L2, "DRAM fill has arrived");
+        assert_eq!(misses.deepest(10), MemLevel::L1);
+    }
+
+    #[test]
+    fn test_l1_hits_are_not_misses() {
+        let mut misses = MissTracker::default();
+        misses.note(MemLevel::L1, 100);
+        assert_eq!(misses.deepest(0), MemLevel::L1);
+    }
+
+    #[test]
+    fn test_l3_miss_marks_lower_levels() {
+        let mut misses = MissTracker::default();
+        misses.note(MemLevel::L3, 20);
+        assert_eq!(misses.deepest(0), MemLevel::L3);
+        misses.note(MemLevel::L2, 30);
+        assert_eq!(misses.deepest(25), MemLevel::L2);
+    }
+}
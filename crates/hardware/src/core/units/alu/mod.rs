@@ -3,16 +3,21 @@
 //! This module implements the integer ALU used in the Execute stage.
 //! It handles standard arithmetic, logical operations, and shifts
 //! for both 32-bit and 64-bit operands. It also implements the
-//! Multiply/Divide (M) extension operations.
+//! Multiply/Divide (M) extension operations and the Zba, Zbb, and Zbs
+//! bit-manipulation extensions.
 //!
 //! Operations are organized into submodules by category:
 //! - [`arithmetic`]: Add, Sub, Mul, Mulh, Mulhsu, Mulhu, Div, Divu, Rem, Remu
 //! - [`logic`]:      Or, And, Xor, Slt, Sltu
 //! - [`shifts`]:     Sll, Srl, Sra
+//! - [`bitmanip`]:   Zba address generation, Zbb bit operations, Zbs single-bit
 
 /// Integer arithmetic operations (add, subtract, multiply, divide).
 pub mod arithmetic;
 
+/// Bit-manipulation operations (sh1add, clz, rol, bset, ...).
+pub mod bitmanip;
+
 /// Bitwise logical and comparison operations (or, and, xor, slt).
 pub mod logic;
 
@@ -25,7 +30,8 @@ use crate::core::pipeline::signals::AluOp;
 ///
 /// Implements all RISC-V integer arithmetic and logical operations
 /// including addition, subtraction, shifts, comparisons, and
-/// multiply/divide operations from the I and M extensions.
+/// multiply/divide operations from the I and M extensions, plus the
+/// Zba, Zbb, and Zbs bit-manipulation extensions.
 #[derive(Debug)]
 pub struct Alu;
 
@@ -96,6 +102,34 @@ impl Alu {
             // Shifts: sll, srl, sra
             AluOp::Sll | AluOp::Srl | AluOp::Sra => shifts::execute(op, a, b, is32),
 
+            // Bit manipulation: Zba, Zbb, Zbs
+            AluOp::Sh1Add
+            | AluOp::Sh2Add
+            | AluOp::Sh3Add
+            | AluOp::AddUw
+            | AluOp::SllUw
+            | AluOp::Andn
+            | AluOp::Orn
+            | AluOp::Xnor
+            | AluOp::Clz
+            | AluOp::Ctz
+            | AluOp::Cpop
+            | AluOp::Max
+            | AluOp::Maxu
+            | AluOp::Min
+            | AluOp::Minu
+            | AluOp::SextB
+            | AluOp::SextH
+            | AluOp::ZextH
+            | AluOp::Rol
+            | AluOp::Ror
+            | AluOp::OrcB
+            | AluOp::Rev8
+            | AluOp::Bclr
+            | AluOp::Bext
+            | AluOp::Binv
+            | AluOp::Bset => bitmanip::execute(op, a, b, is32),
+
             // Non-integer operations (FP, etc.) are not handled here.
             _ => 0,
         }
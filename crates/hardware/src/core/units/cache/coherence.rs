@@ -0,0 +1,376 @@
+//! MESI/MOESI Coherence Directory.
+//!
+//! Keeps the private L1-D/L2 caches of an SMP system coherent at the shared
+//! level. It performs the following:
+//! 1. **Directory:** One [`Coherence`] per system tracks, for every line held
+//!    by some hart, the set of sharers and the owning hart (E/M/O). A read
+//!    miss is granted E (no other copy) or S; a write miss or upgrade is
+//!    granted M after invalidating every other copy. Under MOESI a read of a
+//!    line another hart owns leaves that hart in O, and it keeps supplying
+//!    readers.
+//! 2. **Probes:** Invalidations and downgrades are queued in the target
+//!    hart's inbox and applied by that hart at its next cycle (or its next
+//!    directory transaction), since its caches belong to its own thread.
+//! 3. **Agent:** Each hart's [`CoherenceAgent`] mirrors the state that the
+//!    directory granted it, so reads of held lines and writes to E/M lines
+//!    never touch the directory. Lines evicted from all private levels are
+//!    released to the directory in batches (replacement hints).
+//!
+//! Instruction fetches are not tracked: the I-cache is kept coherent by
+//! `fence.i` as on real RISC-V parts.
+
+use crate::config::{CoherenceConfig, CoherenceProtocol};
+use crate::soc::uncore::lock;
+use std::collections::{HashMap, HashSet};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Mutex};
+
+/// Caps the set of lines remembered as lost to another hart's write.
+const LOST_LINES_CAP: usize = 1 << 16;
+
+/// State of a line in one hart's private caches.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum LineState {
+    /// Dirty, no other copy.
+    Modified,
+    /// Possibly dirty, other harts may hold S copies (MOESI only).
+    Owned,
+    /// Clean, no other copy.
+    Exclusive,
+    /// Clean, other copies may exist.
+    Shared,
+}
+
+/// A request the directory sends to a hart's private caches.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Probe {
+    /// Another hart is writing the line: drop it.
+    Invalidate(u64),
+    /// Another hart is reading the line: give up exclusivity.
+    Downgrade(u64),
+}
+
+/// Outcome of a directory transaction, as seen by the requester.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct Grant {
+    /// State granted to the requester.
+    pub state: LineState,
+    /// Other harts holding the line when the request arrived.
+    pub peers: u32,
+    /// Other harts' copies invalidated by the request.
+    pub invalidated: u32,
+    /// Data was supplied by another hart's cache.
+    pub transfer: bool,
+}
+
+/// Directory entry of one line.
+#[derive(Clone, Copy, Debug, Default)]
+struct Entry {
+    /// Bit `h` set when hart `h` holds a copy.
+    sharers: u32,
+    /// Hart holding the line in E, M, or O (always also a sharer).
+    owner: Option<u8>,
+}
+
+/// Per-hart probe queue.
+#[derive(Debug, Default)]
+struct Inbox {
+    pending: AtomicBool,
+    probes: Mutex<Vec<Probe>>,
+}
+
+/// Coherence directory shared by all harts of a system.
+#[derive(Debug)]
+pub struct Coherence {
+    protocol: CoherenceProtocol,
+    directory: Mutex<HashMap<u64, Entry>>,
+    inboxes: Box<[Inbox]>,
+}
+
+impl Coherence {
+    /// Creates an empty directory for `harts` harts.
+    pub fn new(harts: usize, protocol: CoherenceProtocol) -> Self {
+        let inboxes = (0..harts.clamp(1, 32)).map(|_| Inbox::default()).collect();
+        Self { protocol, directory: Mutex::new(HashMap::new()), inboxes }
+    }
+
+    /// Queues `probe` for `hart`.
+    fn send(&self, hart: usize, probe: Probe) {
+        if let Some(inbox) = self.inboxes.get(hart) {
+            lock(&inbox.probes).push(probe);
+            inbox.pending.store(true, Ordering::Release);
+        }
+    }
+
+    /// Moves `hart`'s queued probes into `out`. Returns whether there were any.
+    pub fn take_probes(&self, hart: usize, out: &mut Vec<Probe>) -> bool {
+        let Some(inbox) = self.inboxes.get(hart) else { return false };
+        if !inbox.pending.load(Ordering::Relaxed) || !inbox.pending.swap(false, Ordering::Acquire) {
+            return false;
+        }
+        out.append(&mut lock(&inbox.probes));
+        true
+    }
+
+    /// Removes `hart` from the sharers of each line in `lines`.
+    fn release(directory: &mut HashMap<u64, Entry>, hart: usize, lines: &[u64]) {
+        let me = 1u32 << hart;
+        for line in lines {
+            if let Some(entry) = directory.get_mut(line) {
+                entry.sharers &= !me;
+                if entry.owner == Some(hart as u8) {
+                    entry.owner = None;
+                }
+                if entry.sharers == 0 {
+                    let _ = directory.remove(line);
+                }
+            }
+        }
+    }
+
+    /// Performs a read (`write == false`) or write request by `hart` for `line`,
+    /// after first applying `released` replacement hints from the same hart.
+    pub fn request(&self, hart: usize, line: u64, write: bool, released: &[u64]) -> Grant {
+        let me = 1u32 << hart;
+        let mut directory = lock(&self.directory);
+        Self::release(&mut directory, hart, released);
+        let entry = directory.entry(line).or_default();
+        let others = entry.sharers & !me;
+        let peers = others.count_ones();
+        let foreign_owner = entry.owner.filter(|&o| usize::from(o) != hart);
+        // A hart that already holds a copy needs no data, only permission.
+        let transfer = foreign_owner.is_some() && entry.sharers & me == 0;
+
+        let grant = if write {
+            let mut rest = others;
+            while rest != 0 {
+                let peer = rest.trailing_zeros() as usize;
+                rest &= rest - 1;
+                self.send(peer, Probe::Invalidate(line));
+            }
+            entry.sharers = me;
+            entry.owner = Some(hart as u8);
+            Grant { state: LineState::Modified, peers, invalidated: peers, transfer }
+        } else {
+            if let Some(owner) = foreign_owner {
+                self.send(usize::from(owner), Probe::Downgrade(line));
+                if self.protocol == CoherenceProtocol::Mesi {
+                    entry.owner = None;
+                }
+            }
+            entry.sharers |= me;
+            let state = if others == 0 {
+                entry.owner = Some(hart as u8);
+                LineState::Exclusive
+            } else {
+                LineState::Shared
+            };
+            Grant { state, peers, invalidated: 0, transfer }
+        };
+        drop(directory);
+        grant
+    }
+}
+
+/// Result of an access that needed the directory.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct CoherenceEvent {
+    /// The directory's answer.
+    pub grant: Grant,
+    /// The access was a write to a line already held in S or O.
+    pub upgrade: bool,
+    /// The line had been taken away by another hart's write (a coherence miss).
+    pub coherence_miss: bool,
+    /// Extra cycles the access pays for coherence.
+    pub latency: u64,
+}
+
+/// One hart's view of the directory.
+#[derive(Debug)]
+pub struct CoherenceAgent {
+    shared: Arc<Coherence>,
+    hart: usize,
+    line_mask: u64,
+    config: CoherenceConfig,
+    /// State the directory granted for each line this hart holds.
+    states: HashMap<u64, LineState>,
+    /// Lines evicted from every private level, not yet released.
+    released: Vec<u64>,
+    /// Lines lost to another hart's write and not yet re-requested.
+    lost: HashSet<u64>,
+    /// Received probes, to be applied to the private caches.
+    pub probes: Vec<Probe>,
+}
+
+impl CoherenceAgent {
+    /// Creates the agent of `hart`, tracking lines of `line_bytes` bytes.
+    pub fn new(
+        shared: Arc<Coherence>,
+        hart: usize,
+        line_bytes: usize,
+        config: CoherenceConfig,
+    ) -> Self {
+        Self {
+            shared,
+            hart,
+            line_mask: !(line_bytes.max(1).next_power_of_two() as u64 - 1),
+            config,
+            states: HashMap::new(),
+            released: Vec::new(),
+            lost: HashSet::new(),
+            probes: Vec::new(),
+        }
+    }
+
+    /// Line address containing `addr`.
+    #[inline]
+    pub const fn line(&self, addr: u64) -> u64 {
+        addr & self.line_mask
+    }
+
+    /// Pulls queued probes into [`Self::probes`], updating local state.
+    ///
+    /// Returns whether any probe arrived; the caller must then apply
+    /// [`Self::probes`] to its caches.
+    pub fn poll(&mut self) -> bool {
+        let start = self.probes.len();
+        if !self.shared.take_probes(self.hart, &mut self.probes) {
+            return false;
+        }
+        for probe in &self.probes[start..] {
+            match *probe {
+                Probe::Invalidate(line) => {
+                    if self.states.remove(&line).is_some() {
+                        if self.lost.len() >= LOST_LINES_CAP {
+                            self.lost.clear();
+                        }
+                        let _ = self.lost.insert(line);
+                    }
+                }
+                Probe::Downgrade(line) => {
+                    if let Some(state) = self.states.get_mut(&line) {
+                        *state = match self.config.protocol {
+                            CoherenceProtocol::Moesi => LineState::Owned,
+                            CoherenceProtocol::Mesi => LineState::Shared,
+                        };
+                    }
+                }
+            }
+        }
+        true
+    }
+
+    /// Checks a data access against the local state, asking the directory
+    /// when the hart lacks permission. Returns `None` when no request was needed.
+    pub fn access(&mut self, addr: u64, write: bool) -> Option<CoherenceEvent> {
+        // Apply pending probes first, so a downgrade is never upgraded silently.
+        let _ = self.poll();
+        let line = self.line(addr);
+        let held = self.states.get(&line).copied();
+        match (held, write) {
+            (Some(_), false) | (Some(LineState::Modified), true) => return None,
+            (Some(LineState::Exclusive), true) => {
+                // Silent E→M upgrade.
+                let _ = self.states.insert(line, LineState::Modified);
+                return None;
+            }
+            _ => {}
+        }
+
+        let grant = self.shared.request(self.hart, line, write, &self.released);
+        self.released.clear();
+        let _ = self.states.insert(line, grant.state);
+        let upgrade = held.is_some();
+        let coherence_miss = !upgrade && self.lost.remove(&line);
+
+        let cfg = &self.config;
+        let invalidate = if grant.invalidated > 0 { cfg.invalidation_latency } else { 0 };
+        let latency = if grant.transfer {
+            cfg.transfer_latency.max(invalidate)
+        } else if upgrade {
+            cfg.upgrade_latency.max(invalidate)
+        } else {
+            invalidate
+        };
+        Some(CoherenceEvent { grant, upgrade, coherence_miss, latency })
+    }
+
+    /// Notes that `line` left every private cache level.
+    pub fn evicted(&mut self, line: u64) {
+        if self.states.remove(&line).is_some() {
+            self.released.push(line);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn agents(harts: usize, protocol: CoherenceProtocol) -> Vec<CoherenceAgent> {
+        let shared = Arc::new(Coherence::new(harts, protocol));
+        let config = CoherenceConfig { protocol, ..CoherenceConfig::default() };
+        (0..harts).map(|h| CoherenceAgent::new(Arc::clone(&shared), h, 64, config)).collect()
+    }
+
+    #[test]
+    fn test_first_reader_gets_exclusive_and_writes_silently() {
+        let mut a = agents(2, CoherenceProtocol::Mesi);
+        let ev = a[0].access(0x1008, false).unwrap_or_else(|| panic!("cold miss"));
+        assert_eq!(ev.grant.state, LineState::Exclusive);
+        assert_eq!(ev.latency, 0);
+        assert!(a[0].access(0x1010, true).is_none(), "E→M needs no request");
+    }
+
+    #[test]
+    fn test_write_invalidates_sharers() {
+        let mut a = agents(3, CoherenceProtocol::Mesi);
+        let _ = a[0].access(0x2000, false);
+        let _ = a[1].access(0x2000, false);
+        let ev = a[2].access(0x2000, true).unwrap_or_else(|| panic!("write miss"));
+        assert_eq!(ev.grant.invalidated, 2);
+        assert!(a[0].poll() && a[1].poll());
+        assert_eq!(a[0].probes.last(), Some(&Probe::Invalidate(0x2000)));
+
+        // Hart 0 re-reads: a coherence miss served by hart 2's cache.
+        let ev = a[0].access(0x2000, false).unwrap_or_else(|| panic!("coherence miss"));
+        assert!(ev.coherence_miss && ev.grant.transfer);
+        assert_eq!(ev.grant.state, LineState::Shared);
+    }
+
+    #[test]
+    fn test_upgrade_from_shared() {
+        let mut a = agents(2, CoherenceProtocol::Mesi);
+        let _ = a[0].access(0x40, false);
+        let _ = a[1].access(0x40, false);
+        let ev = a[0].access(0x40, true).unwrap_or_else(|| panic!("upgrade"));
+        assert!(ev.upgrade && !ev.grant.transfer);
+        assert_eq!(ev.grant.invalidated, 1);
+        assert_eq!(ev.latency, CoherenceConfig::default().invalidation_latency);
+    }
+
+    #[test]
+    fn test_moesi_owner_keeps_supplying_readers() {
+        let mut a = agents(3, CoherenceProtocol::Moesi);
+        let _ = a[0].access(0x80, true);
+        assert!(a[1].access(0x80, false).is_some_and(|ev| ev.grant.transfer));
+        assert!(a[0].poll());
+        assert!(a[2].access(0x80, false).is_some_and(|ev| ev.grant.transfer));
+
+        let mut mesi = agents(3, CoherenceProtocol::Mesi);
+        let _ = mesi[0].access(0x80, true);
+        let _ = mesi[1].access(0x80, false);
+        assert!(mesi[2].access(0x80, false).is_some_and(|ev| !ev.grant.transfer));
+    }
+
+    #[test]
+    fn test_released_line_is_exclusive_again() {
+        let mut a = agents(2, CoherenceProtocol::Mesi);
+        let _ = a[0].access(0xC0, false);
+        let _ = a[1].access(0xC0, false);
+        a[1].evicted(0xC0);
+        let _ = a[1].access(0x1C0, false); // carries the release
+        let ev = a[0].access(0xC0, true).unwrap_or_else(|| panic!("upgrade"));
+        assert_eq!(ev.grant.invalidated, 0);
+    }
+}
@@ -11,13 +11,19 @@ pub mod policies;
 /// Miss Status Holding Registers (MSHRs) for non-blocking cache access.
 pub mod mshr;
 
-use self::policies::{
-    FifoPolicy, LruPolicy, MruPolicy, PlruPolicy, RandomPolicy, ReplacementPolicy,
-};
-use crate::config::{CacheConfig, Prefetcher as PrefetcherType, ReplacementPolicy as PolicyType};
-use crate::core::units::prefetch::{
-    NextLinePrefetcher, Prefetcher, StreamPrefetcher, StridePrefetcher, TaggedPrefetcher,
-};
+/// Vectorized compare of one tag against all ways of a set.
+pub mod tag_match;
+
+/// MESI/MOESI directory keeping private caches coherent across harts.
+pub mod coherence;
+
+/// Single-pass LRU stack-distance profiling (miss-ratio curves).
+pub mod stack_distance;
+
+use self::policies::{Policy, ReplacementPolicy};
+use self::tag_match::{MAX_WAYS_PER_MATCH, match_ways};
+use crate::config::CacheConfig;
+use crate::core::units::prefetch::{PrefetchEngine, Prefetcher};
 
 /// Information about an evicted cache line.
 #[derive(Clone, Copy, Debug)]
@@ -28,30 +34,58 @@ pub struct EvictedLine {
     pub dirty: bool,
 }
 
-/// Cache line entry containing tag, validity, and dirty bits.
+/// Caller-owned output buffers for tracked cache accesses.
+///
+/// Reused across accesses so that, once their capacity has grown to the
+/// associativity / prefetch degree, a cache access performs no heap
+/// allocation.
 #[derive(Clone, Debug, Default)]
-struct CacheLine {
-    tag: u64,
-    valid: bool,
-    dirty: bool,
+pub struct AccessBuffers {
+    /// Lines evicted by the access (demand miss and installed prefetches).
+    pub evictions: Vec<EvictedLine>,
+    /// Prefetch candidates generated by the access.
+    pub prefetches: Vec<u64>,
+}
+
+impl AccessBuffers {
+    /// Empties both buffers, keeping their capacity.
+    #[inline]
+    pub fn clear(&mut self) {
+        self.evictions.clear();
+        self.prefetches.clear();
+    }
 }
 
+/// Tag of an invalid way. Real tags are `addr / (line_bytes * num_sets)`,
+/// which cannot reach `u64::MAX` for lines of two or more bytes.
+const INVALID_TAG: u64 = u64::MAX;
+
 /// Cache simulator implementing a set-associative cache with configurable policies.
 ///
 /// Supports various replacement policies (FIFO, LRU, PLRU, Random, MRU) and prefetchers
 /// (Next-Line, Stride, Stream, Tagged). Models cache hits, misses, and write-back penalties.
+///
+/// Sets are stored as a structure of arrays: each set's tags are contiguous, so a lookup
+/// is one vectorized compare ([`match_ways`]), and dirty bits are packed per set.
+/// Validity is encoded in the tag itself (`INVALID_TAG`).
 pub struct CacheSim {
     /// Access latency in cycles (added on hit; miss adds next-level latency).
     pub latency: u64,
     /// When false, accesses bypass this cache and use next-level latency only.
     pub enabled: bool,
-    /// Optional hardware prefetcher (boxed for dynamic dispatch; `Send + Sync` for thread safety).
-    pub prefetcher: Option<Box<dyn Prefetcher + Send + Sync>>,
-    lines: Vec<CacheLine>,
+    /// Optional hardware prefetcher (enum-dispatched so it can inline).
+    pub prefetcher: Option<PrefetchEngine>,
+    /// Tag of every way, set-major (`INVALID_TAG` when the way is invalid).
+    tags: Box<[u64]>,
+    /// Dirty bits, `mask_words` words per set (way `w` is bit `w % 64` of word `w / 64`).
+    dirty: Box<[u64]>,
+    mask_words: usize,
     num_sets: usize,
     ways: usize,
     line_bytes: usize,
-    policy: Box<dyn ReplacementPolicy + Send + Sync>,
+    policy: Policy,
+    /// Reused prefetch-candidate buffer for the untracked access paths.
+    prefetch_scratch: Vec<u64>,
 }
 
 impl std::fmt::Debug for CacheSim {
@@ -78,41 +112,16 @@ impl CacheSim {
     ///
     /// A new `CacheSim` instance initialized according to the configuration.
     pub fn new(config: &CacheConfig) -> Self {
-        let safe_ways = if config.ways == 0 { 1 } else { config.ways };
-        let safe_line = if config.line_bytes == 0 { 64 } else { config.line_bytes };
-        let safe_size = if config.size_bytes == 0 { 4096 } else { config.size_bytes };
-
-        let num_lines = safe_size / safe_line;
-        let num_sets = num_lines / safe_ways;
-
-        let policy: Box<dyn ReplacementPolicy + Send + Sync> = match config.policy {
-            PolicyType::Fifo => Box::new(FifoPolicy::new(num_sets, safe_ways)),
-            PolicyType::Random => Box::new(RandomPolicy::new(num_sets, safe_ways)),
-            PolicyType::Plru => Box::new(PlruPolicy::new(num_sets, safe_ways)),
-            PolicyType::Lru => Box::new(LruPolicy::new(num_sets, safe_ways)),
-            PolicyType::Mru => Box::new(MruPolicy::new(num_sets, safe_ways)),
-        };
+        let (num_sets, safe_ways, safe_line) = Self::geometry(config);
 
-        let prefetcher: Option<Box<dyn Prefetcher + Send + Sync>> = match config.prefetcher {
-            PrefetcherType::NextLine => {
-                Some(Box::new(NextLinePrefetcher::new(safe_line, config.prefetch_degree)))
-            }
-            PrefetcherType::Stride => Some(Box::new(StridePrefetcher::new(
-                safe_line,
-                config.prefetch_table_size,
-                config.prefetch_degree,
-            ))),
-            PrefetcherType::Stream => {
-                Some(Box::new(StreamPrefetcher::new(safe_line, config.prefetch_degree)))
-            }
-            PrefetcherType::Tagged => {
-                Some(Box::new(TaggedPrefetcher::new(safe_line, config.prefetch_degree)))
-            }
-            PrefetcherType::None => None,
-        };
+        let policy = Policy::new(config.policy, num_sets, safe_ways);
+        let prefetcher = PrefetchEngine::from_config(config, safe_line);
 
+        let mask_words = safe_ways.div_ceil(64);
         Self {
-            lines: vec![CacheLine::default(); num_sets * safe_ways],
+            tags: vec![INVALID_TAG; num_sets * safe_ways].into_boxed_slice(),
+            dirty: vec![0; num_sets * mask_words].into_boxed_slice(),
+            mask_words,
             num_sets,
             ways: safe_ways,
             line_bytes: safe_line,
@@ -120,7 +129,37 @@ impl CacheSim {
             enabled: config.enabled,
             policy,
             prefetcher,
+            prefetch_scratch: Vec::new(),
+        }
+    }
+
+    /// Sets, ways, and line size of `config`, with zero fields defaulted.
+    const fn geometry(config: &CacheConfig) -> (usize, usize, usize) {
+        let ways = if config.ways == 0 { 1 } else { config.ways };
+        let line = if config.line_bytes == 0 { 64 } else { config.line_bytes };
+        let size = if config.size_bytes == 0 { 4096 } else { config.size_bytes };
+        (size / line / ways, ways, line)
+    }
+
+    /// Returns this cache to the state `CacheSim::new(config)` would build.
+    ///
+    /// When the geometry and replacement policy are unchanged the tag, dirty,
+    /// and policy arrays are cleared in place rather than reallocated, which
+    /// is what makes reusing one cache across many short runs cheap.
+    pub fn reset(&mut self, config: &CacheConfig) {
+        if Self::geometry(config) != (self.num_sets, self.ways, self.line_bytes)
+            || self.policy.kind() != config.policy
+        {
+            *self = Self::new(config);
+            return;
         }
+        self.tags.fill(INVALID_TAG);
+        self.dirty.fill(0);
+        self.policy.reset();
+        self.prefetcher = PrefetchEngine::from_config(config, self.line_bytes);
+        self.latency = config.latency;
+        self.enabled = config.enabled;
+        self.prefetch_scratch.clear();
     }
 
     /// Reconstructs the physical address from a set index and tag.
@@ -129,6 +168,70 @@ impl CacheSim {
         tag * (self.line_bytes * self.num_sets) as u64 + (set_index * self.line_bytes) as u64
     }
 
+    /// Splits `addr` into its set index and tag.
+    #[inline]
+    const fn locate(&self, addr: u64) -> (usize, u64) {
+        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
+        let tag = addr / (self.line_bytes * self.num_sets) as u64;
+        (set_index, tag)
+    }
+
+    /// Returns the first way of `set_index` whose tag equals `tag`.
+    ///
+    /// Passing `INVALID_TAG` finds the first free way.
+    #[inline]
+    fn find_way(&self, set_index: usize, tag: u64) -> Option<usize> {
+        let base = set_index * self.ways;
+        let set = &self.tags[base..base + self.ways];
+        set.chunks(MAX_WAYS_PER_MATCH).enumerate().find_map(|(chunk, tags)| {
+            let mask = match_ways(tags, tag);
+            (mask != 0).then(|| chunk * MAX_WAYS_PER_MATCH + mask.trailing_zeros() as usize)
+        })
+    }
+
+    /// Word index and bit of the dirty flag of `way` in `set_index`.
+    #[inline]
+    const fn dirty_bit(&self, set_index: usize, way: usize) -> (usize, u64) {
+        (set_index * self.mask_words + way / 64, 1 << (way % 64))
+    }
+
+    /// Returns the dirty flag of `way` in `set_index`.
+    #[inline]
+    fn is_dirty(&self, set_index: usize, way: usize) -> bool {
+        let (word, bit) = self.dirty_bit(set_index, way);
+        self.dirty[word] & bit != 0
+    }
+
+    /// Sets the dirty flag of `way` in `set_index` to `dirty`.
+    #[inline]
+    fn set_dirty(&mut self, set_index: usize, way: usize, dirty: bool) {
+        let (word, bit) = self.dirty_bit(set_index, way);
+        if dirty {
+            self.dirty[word] |= bit;
+        } else {
+            self.dirty[word] &= !bit;
+        }
+    }
+
+    /// Writes `tag` into `way` of `set_index` with the given dirty flag.
+    #[inline]
+    fn fill_way(&mut self, set_index: usize, way: usize, tag: u64, dirty: bool) {
+        self.tags[set_index * self.ways + way] = tag;
+        self.set_dirty(set_index, way, dirty);
+    }
+
+    /// Looks up `addr`; on a hit, updates replacement state and (for writes)
+    /// the dirty flag. Returns whether it hit.
+    #[inline]
+    fn probe_and_touch(&mut self, set_index: usize, tag: u64, is_write: bool) -> bool {
+        let Some(way) = self.find_way(set_index, tag) else { return false };
+        self.policy.update(set_index, way);
+        if is_write {
+            self.set_dirty(set_index, way, true);
+        }
+        true
+    }
+
     /// Checks if the cache contains the specified address.
     ///
     /// # Arguments
@@ -141,26 +244,15 @@ impl CacheSim {
     ///
     /// # Panics
     ///
-    /// This function will not panic. Array indexing is guaranteed safe because:
-    /// - `set_index` is always `< num_sets` (modulo operation)
-    /// - `base_idx = set_index * ways` is always `< lines.len()`
-    /// - `idx = base_idx + i` where `i < ways` ensures `idx < lines.len()`
+    /// This function will not panic. Array indexing is guaranteed safe because
+    /// `set_index` is always `< num_sets` (modulo operation), so the set's
+    /// `ways` tags lie within `tags`.
     pub fn contains(&self, addr: u64) -> bool {
         if !self.enabled {
             return false;
         }
-
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if self.lines[idx].valid && self.lines[idx].tag == tag {
-                return true;
-            }
-        }
-        false
+        let (set_index, tag) = self.locate(addr);
+        self.find_way(set_index, tag).is_some()
     }
 
     /// Installs a cache line for the specified address.
@@ -193,25 +285,22 @@ impl CacheSim {
         is_write: bool,
         next_level_latency: u64,
     ) -> (u64, Option<EvictedLine>) {
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
+        let (set_index, tag) = self.locate(addr);
         let victim_way = self.policy.get_victim(set_index);
-        let victim_idx = base_idx + victim_way;
+        let victim_tag = self.tags[set_index * self.ways + victim_way];
         let mut penalty = 0;
         let mut evicted = None;
 
-        if self.lines[victim_idx].valid {
-            let victim_addr = self.reconstruct_addr(set_index, self.lines[victim_idx].tag);
-            let victim_dirty = self.lines[victim_idx].dirty;
+        if victim_tag != INVALID_TAG {
+            let victim_addr = self.reconstruct_addr(set_index, victim_tag);
+            let victim_dirty = self.is_dirty(set_index, victim_way);
             evicted = Some(EvictedLine { addr: victim_addr, dirty: victim_dirty });
             if victim_dirty {
                 penalty += next_level_latency;
             }
         }
 
-        self.lines[victim_idx] = CacheLine { tag, valid: true, dirty: is_write };
+        self.fill_way(set_index, victim_way, tag, is_write);
         self.policy.update(set_index, victim_way);
 
         (penalty, evicted)
@@ -239,45 +328,40 @@ impl CacheSim {
             return (false, 0);
         }
 
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
-        let mut hit = false;
+        let (set_index, tag) = self.locate(addr);
+        let hit = self.probe_and_touch(set_index, tag, is_write);
         let mut penalty = 0;
 
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if self.lines[idx].valid && self.lines[idx].tag == tag {
-                self.policy.update(set_index, i);
-                if is_write {
-                    self.lines[idx].dirty = true;
-                }
-                hit = true;
-                break;
-            }
-        }
-
         if !hit {
             penalty += self.install_line(addr, is_write, next_level_latency);
         }
 
-        let prefetches =
-            self.prefetcher.as_mut().map_or_else(Vec::new, |pref| pref.observe(addr, hit));
+        self.prefetch_and_install(addr, hit, next_level_latency);
 
-        for target in prefetches {
+        (hit, penalty)
+    }
+
+    /// Runs the prefetcher for an access and installs its candidates directly.
+    fn prefetch_and_install(&mut self, addr: u64, hit: bool, next_level_latency: u64) {
+        let Some(pref) = self.prefetcher.as_mut() else {
+            return;
+        };
+        let mut targets = std::mem::take(&mut self.prefetch_scratch);
+        targets.clear();
+        pref.observe_into(addr, hit, &mut targets);
+        for &target in &targets {
             if !self.contains(target) {
                 let _ = self.install_line(target, false, next_level_latency);
             }
         }
-
-        (hit, penalty)
+        self.prefetch_scratch = targets;
     }
 
     /// Accesses the cache with eviction tracking for inclusion/exclusion policies.
     ///
-    /// Returns `(hit, penalty, Vec<EvictedLine>)` where the evicted lines
-    /// include both the demand miss eviction and any prefetch-triggered evictions.
+    /// Returns `(hit, penalty)`. `out` is cleared first; afterwards
+    /// `out.evictions` holds both the demand miss eviction and any
+    /// prefetch-triggered evictions, and `out.prefetches` the candidates.
     ///
     /// Prefetch candidates are installed directly. Use `access_tracked_split` if
     /// you need to filter prefetch candidates before installation.
@@ -286,82 +370,61 @@ impl CacheSim {
         addr: u64,
         is_write: bool,
         next_level_latency: u64,
-    ) -> (bool, u64, Vec<EvictedLine>) {
-        let (hit, penalty, evictions, prefetch_candidates) =
-            self.access_tracked_split(addr, is_write, next_level_latency);
-
-        // Install all prefetch candidates directly
-        let mut all_evictions = evictions;
-        for target in prefetch_candidates {
-            if !self.contains(target) {
-                let (_pen, evicted) = self.install_line_tracked(target, false, next_level_latency);
-                if let Some(ev) = evicted {
-                    all_evictions.push(ev);
-                }
-            }
-        }
-
-        (hit, penalty, all_evictions)
+        out: &mut AccessBuffers,
+    ) -> (bool, u64) {
+        let (hit, penalty) = self.access_tracked_split(addr, is_write, next_level_latency, out);
+        self.install_prefetches(&out.prefetches, next_level_latency, &mut out.evictions);
+        (hit, penalty)
     }
 
     /// Accesses the cache with eviction tracking, returning prefetch candidates
     /// separately instead of installing them.
     ///
-    /// Returns `(hit, penalty, demand_evictions, prefetch_candidates)`.
-    /// The caller is responsible for filtering and installing the prefetch candidates.
+    /// Returns `(hit, penalty)`. `out` is cleared first; afterwards
+    /// `out.evictions` holds the demand eviction (if any) and `out.prefetches`
+    /// the prefetch candidates. The caller is responsible for filtering and
+    /// installing the prefetch candidates.
     pub fn access_tracked_split(
         &mut self,
         addr: u64,
         is_write: bool,
         next_level_latency: u64,
-    ) -> (bool, u64, Vec<EvictedLine>, Vec<u64>) {
+        out: &mut AccessBuffers,
+    ) -> (bool, u64) {
+        out.clear();
         if !self.enabled {
-            return (false, 0, Vec::new(), Vec::new());
+            return (false, 0);
         }
 
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
-        let mut hit = false;
+        let (set_index, tag) = self.locate(addr);
+        let hit = self.probe_and_touch(set_index, tag, is_write);
         let mut penalty = 0;
-        let mut evictions = Vec::new();
-
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if self.lines[idx].valid && self.lines[idx].tag == tag {
-                self.policy.update(set_index, i);
-                if is_write {
-                    self.lines[idx].dirty = true;
-                }
-                hit = true;
-                break;
-            }
-        }
 
         if !hit {
             let (pen, evicted) = self.install_line_tracked(addr, is_write, next_level_latency);
             penalty += pen;
             if let Some(ev) = evicted {
-                evictions.push(ev);
+                out.evictions.push(ev);
             }
         }
 
-        let prefetches =
-            self.prefetcher.as_mut().map_or_else(Vec::new, |pref| pref.observe(addr, hit));
+        if let Some(pref) = self.prefetcher.as_mut() {
+            pref.observe_into(addr, hit, &mut out.prefetches);
+        }
 
-        (hit, penalty, evictions, prefetches)
+        (hit, penalty)
     }
 
-    /// Installs prefetch targets into this cache, returning any evictions.
+    /// Installs prefetch targets into this cache, appending any evictions to
+    /// `evictions`.
     ///
     /// Used after filtering prefetch candidates through a shared prefetch filter.
     pub fn install_prefetches(
         &mut self,
         targets: &[u64],
         next_level_latency: u64,
-    ) -> Vec<EvictedLine> {
-        let mut evictions = Vec::new();
+        evictions: &mut Vec<EvictedLine>,
+    ) {
         for &target in targets {
             if !self.contains(target) {
                 let (_pen, evicted) = self.install_line_tracked(target, false, next_level_latency);
@@ -370,7 +433,6 @@ impl CacheSim {
                 }
             }
         }
-        evictions
     }
 
     /// Non-blocking cache access: checks for hit/miss without installing the line on miss.
@@ -383,30 +445,10 @@ impl CacheSim {
             return false;
         }
 
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
-        let mut hit = false;
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if self.lines[idx].valid && self.lines[idx].tag == tag {
-                self.policy.update(set_index, i);
-                if is_write {
-                    self.lines[idx].dirty = true;
-                }
-                hit = true;
-                break;
-            }
-        }
+        let (set_index, tag) = self.locate(addr);
+        let hit = self.probe_and_touch(set_index, tag, is_write);
 
-        let prefetches =
-            self.prefetcher.as_mut().map_or_else(Vec::new, |pref| pref.observe(addr, hit));
-        for target in prefetches {
-            if !self.contains(target) {
-                let _ = self.install_line(target, false, 0);
-            }
-        }
+        self.prefetch_and_install(addr, hit, 0);
 
         hit
     }
@@ -444,19 +486,10 @@ impl CacheSim {
             return false;
         }
 
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
-
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if self.lines[idx].valid && self.lines[idx].tag == tag {
-                self.lines[idx].valid = false;
-                self.lines[idx].dirty = false;
-                return true;
-            }
-        }
-        false
+        let (set_index, tag) = self.locate(addr);
+        let Some(way) = self.find_way(set_index, tag) else { return false };
+        self.fill_way(set_index, way, INVALID_TAG, false);
+        true
     }
 
     /// Installs a line without evicting the previous one (used for exclusive policy
@@ -474,18 +507,13 @@ impl CacheSim {
             return (0, None);
         }
 
-        let set_index = ((addr as usize) / self.line_bytes) % self.num_sets;
-        let tag = addr / (self.line_bytes * self.num_sets) as u64;
-        let base_idx = set_index * self.ways;
+        let (set_index, tag) = self.locate(addr);
 
         // Try to find an invalid (free) way first
-        for i in 0..self.ways {
-            let idx = base_idx + i;
-            if !self.lines[idx].valid {
-                self.lines[idx] = CacheLine { tag, valid: true, dirty: is_write };
-                self.policy.update(set_index, i);
-                return (0, None);
-            }
+        if let Some(way) = self.find_way(set_index, INVALID_TAG) {
+            self.fill_way(set_index, way, tag, is_write);
+            self.policy.update(set_index, way);
+            return (0, None);
         }
 
         // No free way — fall back to replacement
@@ -508,15 +536,14 @@ impl CacheSim {
         if !self.enabled {
             return evicted;
         }
-        for i in 0..self.lines.len() {
-            if self.lines[i].valid && self.lines[i].dirty {
-                let set_index = i / self.ways;
+        for i in 0..self.tags.len() {
+            let (set_index, way) = (i / self.ways, i % self.ways);
+            if self.tags[i] != INVALID_TAG && self.is_dirty(set_index, way) {
                 evicted.push(EvictedLine {
-                    addr: self.reconstruct_addr(set_index, self.lines[i].tag),
+                    addr: self.reconstruct_addr(set_index, self.tags[i]),
                     dirty: true,
                 });
-                self.lines[i].dirty = false;
-                self.lines[i].valid = false;
+                self.fill_way(set_index, way, INVALID_TAG, false);
             }
         }
         evicted
@@ -530,19 +557,17 @@ impl CacheSim {
         if !self.enabled {
             return evicted;
         }
-        for i in 0..self.lines.len() {
-            if self.lines[i].valid {
-                if self.lines[i].dirty {
-                    let set_index = i / self.ways;
-                    evicted.push(EvictedLine {
-                        addr: self.reconstruct_addr(set_index, self.lines[i].tag),
-                        dirty: true,
-                    });
-                }
-                self.lines[i].dirty = false;
-                self.lines[i].valid = false;
+        for i in 0..self.tags.len() {
+            let (set_index, way) = (i / self.ways, i % self.ways);
+            if self.tags[i] != INVALID_TAG && self.is_dirty(set_index, way) {
+                evicted.push(EvictedLine {
+                    addr: self.reconstruct_addr(set_index, self.tags[i]),
+                    dirty: true,
+                });
             }
         }
+        self.tags.fill(INVALID_TAG);
+        self.dirty.fill(0);
         evicted
     }
 }
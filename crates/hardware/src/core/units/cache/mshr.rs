@@ -4,18 +4,17 @@
 //! in-flight simultaneously, enabling Memory-Level Parallelism (MLP).
 //! When a second miss arrives for the same cache line, it coalesces with
 //! the existing MSHR entry instead of allocating a new one.
+//!
+//! Outstanding entries are also kept in a min-heap keyed by completion
+//! cycle, so finding the next fill (and the common cycle in which none
+//! arrives) costs a peek rather than a scan. Each slot keeps its waiter
+//! list across reuse, so steady-state misses do not allocate.
 
 use crate::core::pipeline::latches::Mem1Mem2Entry;
 use crate::core::pipeline::rob::RobTag;
-
-/// State of an MSHR entry.
-#[derive(Clone, Copy, Debug, PartialEq, Eq)]
-pub enum MshrState {
-    /// Waiting for data from next cache level / DRAM.
-    Pending,
-    /// Data has arrived; ready to install line and wake waiters.
-    Complete,
-}
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
+use std::vec::Drain;
 
 /// A single waiter attached to an MSHR.
 #[derive(Clone, Debug)]
@@ -32,8 +31,6 @@ pub struct MshrWaiter {
 pub struct MshrEntry {
     /// Cache-line-aligned physical address.
     pub line_addr: u64,
-    /// Current state.
-    pub state: MshrState,
     /// Cycle at which the miss data will be available.
     pub complete_cycle: u64,
     /// Instructions waiting on this line.
@@ -44,6 +41,19 @@ pub struct MshrEntry {
     pub is_write: bool,
 }
 
+/// A fill that has arrived, returned by [`MshrFile::pop_completed`].
+///
+/// The slot is already free; `waiters` drains its waiter list in place.
+#[derive(Debug)]
+pub struct MshrCompletion<'a> {
+    /// Cache-line-aligned physical address.
+    pub line_addr: u64,
+    /// Whether any merged access was a write.
+    pub is_write: bool,
+    /// Instructions that were waiting on this line.
+    pub waiters: Drain<'a, MshrWaiter>,
+}
+
 /// Result of attempting an MSHR-aware cache access.
 #[derive(Clone, Debug, PartialEq, Eq)]
 pub enum CacheResponse {
@@ -70,6 +80,9 @@ pub struct MshrFile {
     cap: usize,
     count: usize,
     line_bytes: usize,
+    /// `(complete_cycle, slot)` of every valid entry, earliest first; ties
+    /// complete in slot order.
+    pending: BinaryHeap<Reverse<(u64, usize)>>,
 }
 
 impl MshrFile {
@@ -79,7 +92,6 @@ impl MshrFile {
         let entries = vec![
             MshrEntry {
                 line_addr: 0,
-                state: MshrState::Pending,
                 complete_cycle: 0,
                 waiters: Vec::new(),
                 valid: false,
@@ -87,7 +99,13 @@ impl MshrFile {
             };
             capacity
         ];
-        Self { entries, cap: capacity, count: 0, line_bytes: safe_line }
+        Self {
+            entries,
+            cap: capacity,
+            count: 0,
+            line_bytes: safe_line,
+            pending: BinaryHeap::with_capacity(capacity),
+        }
     }
 
     /// Align an address to the cache line boundary.
@@ -98,12 +116,27 @@ impl MshrFile {
 
     /// Find index of an existing MSHR for this cache line.
     fn find_line(&self, line_addr: u64) -> Option<usize> {
-        for (i, entry) in self.entries.iter().enumerate() {
-            if entry.valid && entry.line_addr == line_addr {
-                return Some(i);
-            }
+        if self.count == 0 {
+            return None;
+        }
+        self.entries.iter().position(|e| e.valid && e.line_addr == line_addr)
+    }
+
+    /// Claims a free slot for `line_addr`, completing at `complete_cycle`.
+    fn allocate(&mut self, line_addr: u64, is_write: bool, complete_cycle: u64) -> Option<usize> {
+        if self.count >= self.cap {
+            return None;
         }
-        None
+        let idx = self.entries.iter().position(|e| !e.valid)?;
+        let entry = &mut self.entries[idx];
+        entry.line_addr = line_addr;
+        entry.complete_cycle = complete_cycle;
+        entry.valid = true;
+        entry.is_write = is_write;
+        entry.waiters.clear();
+        self.count += 1;
+        self.pending.push(Reverse((complete_cycle, idx)));
+        Some(idx)
     }
 
     /// Attempt to allocate or coalesce an MSHR for the given address.
@@ -122,61 +155,77 @@ impl MshrFile {
 
         // Check for existing MSHR (coalesce)
         if let Some(idx) = self.find_line(line_addr) {
-            let complete_cycle = self.entries[idx].complete_cycle;
-            self.entries[idx].waiters.push(waiter);
-            if is_write {
-                self.entries[idx].is_write = true;
-            }
-            return CacheResponse::MshrCoalesced { complete_cycle };
+            let entry = &mut self.entries[idx];
+            entry.waiters.push(waiter);
+            entry.is_write |= is_write;
+            return CacheResponse::MshrCoalesced { complete_cycle: entry.complete_cycle };
         }
 
         // Allocate new MSHR
-        if self.count >= self.cap {
-            return CacheResponse::MshrFull;
+        let complete_cycle = current_cycle + miss_latency;
+        match self.allocate(line_addr, is_write, complete_cycle) {
+            Some(idx) => {
+                self.entries[idx].waiters.push(waiter);
+                CacheResponse::MshrAllocated { complete_cycle }
+            }
+            None => CacheResponse::MshrFull,
         }
+    }
 
-        for entry in &mut self.entries {
-            if !entry.valid {
-                let complete_cycle = current_cycle + miss_latency;
-                *entry = MshrEntry {
-                    line_addr,
-                    state: MshrState::Pending,
-                    complete_cycle,
-                    waiters: vec![waiter],
-                    valid: true,
-                    is_write,
-                };
-                self.count += 1;
-                return CacheResponse::MshrAllocated { complete_cycle };
-            }
+    /// Tracks a miss with no waiters (a lower cache level, whose waiters
+    /// are held by the level above) until `complete_cycle`.
+    ///
+    /// Coalesces with an outstanding miss to the same line, returning its
+    /// completion cycle.
+    pub fn reserve(&mut self, addr: u64, is_write: bool, complete_cycle: u64) -> CacheResponse {
+        let line_addr = self.line_align(addr);
+        if let Some(idx) = self.find_line(line_addr) {
+            let entry = &mut self.entries[idx];
+            entry.is_write |= is_write;
+            return CacheResponse::MshrCoalesced { complete_cycle: entry.complete_cycle };
         }
+        match self.allocate(line_addr, is_write, complete_cycle) {
+            Some(_) => CacheResponse::MshrAllocated { complete_cycle },
+            None => CacheResponse::MshrFull,
+        }
+    }
 
-        CacheResponse::MshrFull
+    /// Completion cycle of the outstanding miss to `addr`'s line, if any.
+    pub fn pending_fill(&self, addr: u64) -> Option<u64> {
+        let idx = self.find_line(self.line_align(addr))?;
+        Some(self.entries[idx].complete_cycle)
     }
 
-    /// Check for completed MSHRs and return them.
+    /// Frees the earliest MSHR whose fill has arrived by `current_cycle`.
     ///
-    /// Completed entries are freed. The caller is responsible for
-    /// installing the cache line and resuming parked loads.
-    pub fn drain_completions(&mut self, current_cycle: u64) -> Vec<MshrEntry> {
-        let mut completed = Vec::new();
-        for entry in &mut self.entries {
-            if entry.valid && entry.complete_cycle <= current_cycle {
-                let mut taken = MshrEntry {
-                    line_addr: 0,
-                    state: MshrState::Complete,
-                    complete_cycle: 0,
-                    waiters: Vec::new(),
-                    valid: false,
-                    is_write: false,
-                };
-                std::mem::swap(entry, &mut taken);
-                taken.state = MshrState::Complete;
-                self.count -= 1;
-                completed.push(taken);
-            }
+    /// Returns `None` without touching the entries if no fill is due. The
+    /// caller is responsible for installing the cache line and resuming the
+    /// waiters.
+    pub fn pop_completed(&mut self, current_cycle: u64) -> Option<MshrCompletion<'_>> {
+        let &Reverse((complete_cycle, idx)) = self.pending.peek()?;
+        if complete_cycle > current_cycle {
+            return None;
         }
-        completed
+        let _ = self.pending.pop();
+        self.count -= 1;
+        let entry = &mut self.entries[idx];
+        entry.valid = false;
+        Some(MshrCompletion {
+            line_addr: entry.line_addr,
+            is_write: entry.is_write,
+            waiters: entry.waiters.drain(..),
+        })
+    }
+
+    /// Frees every MSHR whose fill has arrived by `current_cycle`,
+    /// dropping its waiters.
+    pub fn retire_through(&mut self, current_cycle: u64) {
+        while self.pop_completed(current_cycle).is_some() {}
+    }
+
+    /// Earliest cycle at which an outstanding fill completes, if any.
+    pub fn next_completion(&self) -> Option<u64> {
+        self.pending.peek().map(|&Reverse((cycle, _))| cycle)
     }
 
     /// Remove waiters with `rob_tag > keep_tag` (misprediction recovery).
@@ -200,6 +249,7 @@ impl MshrFile {
             entry.waiters.clear();
         }
         self.count = 0;
+        self.pending.clear();
     }
 
     /// Number of active MSHRs.
@@ -231,6 +281,21 @@ mod tests {
         MshrWaiter { rob_tag: RobTag(tag), parked_entry: None }
     }
 
+    /// Pops every fill due by `now`, in completion order.
+    fn drain(mf: &mut MshrFile, now: u64) -> Vec<MshrEntry> {
+        let mut completed = Vec::new();
+        while let Some(done) = mf.pop_completed(now) {
+            completed.push(MshrEntry {
+                line_addr: done.line_addr,
+                complete_cycle: 0,
+                is_write: done.is_write,
+                valid: false,
+                waiters: done.waiters.collect(),
+            });
+        }
+        completed
+    }
+
     #[test]
     fn test_allocate_and_complete() {
         let mut mf = MshrFile::new(4, 64);
@@ -241,12 +306,12 @@ mod tests {
         assert_eq!(mf.active_count(), 1);
 
         // Not yet complete at cycle 50
-        let completed = mf.drain_completions(50);
+        let completed = drain(&mut mf, 50);
         assert!(completed.is_empty());
         assert_eq!(mf.active_count(), 1);
 
         // Complete at cycle 110
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 1);
         assert_eq!(completed[0].line_addr, 0x1000);
         assert_eq!(completed[0].waiters.len(), 1);
@@ -267,7 +332,7 @@ mod tests {
         assert_eq!(mf.active_count(), 1); // Still just one MSHR
 
         // Complete — both waiters should be returned
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 1);
         assert_eq!(completed[0].waiters.len(), 2);
     }
@@ -298,7 +363,7 @@ mod tests {
 
         // MSHR for 0x1000 still has waiter tag=1, lost tag=5
         // MSHR for 0x2000 lost its only waiter tag=3 but entry stays
-        let completed = mf.drain_completions(200);
+        let completed = drain(&mut mf, 200);
         assert_eq!(completed.len(), 2);
         let mshr_1000 = completed.iter().find(|e| e.line_addr == 0x1000).unwrap();
         assert_eq!(mshr_1000.waiters.len(), 1);
@@ -330,7 +395,7 @@ mod tests {
         assert_eq!(mf.active_count(), 2);
 
         // Both complete at same cycle
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 2);
         assert_eq!(mf.active_count(), 0);
     }
@@ -354,7 +419,7 @@ mod tests {
         assert_eq!(mf.active_count(), 1);
 
         // Completion returns the entry with is_write=true and empty parked_entry
-        let completed = mf.drain_completions(90);
+        let completed = drain(&mut mf, 90);
         assert_eq!(completed.len(), 1);
         assert!(completed[0].is_write);
         assert!(completed[0].waiters[0].parked_entry.is_none());
@@ -370,7 +435,7 @@ mod tests {
         assert!(mf.is_full());
 
         // Complete one
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 2);
         assert_eq!(mf.active_count(), 0);
 
@@ -390,7 +455,7 @@ mod tests {
         // Store to same line coalesces and sets is_write=true
         mf.request(0x1008, true, 100, 15, make_waiter(2));
 
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 1);
         assert!(completed[0].is_write); // upgraded to write
         assert_eq!(completed[0].waiters.len(), 2);
@@ -410,9 +475,49 @@ mod tests {
         assert_eq!(mf.active_count(), 1);
 
         // Completion still fires, just with no waiters
-        let completed = mf.drain_completions(110);
+        let completed = drain(&mut mf, 110);
         assert_eq!(completed.len(), 1);
         assert_eq!(completed[0].waiters.len(), 0);
         assert_eq!(completed[0].line_addr, 0x1000);
     }
+
+    #[test]
+    fn test_completions_pop_in_cycle_order() {
+        let mut mf = MshrFile::new(4, 64);
+        mf.request(0x1000, false, 300, 0, make_waiter(1));
+        mf.request(0x2000, false, 100, 0, make_waiter(2));
+        mf.request(0x3000, false, 200, 0, make_waiter(3));
+        assert_eq!(mf.next_completion(), Some(100));
+        assert!(mf.pop_completed(99).is_none());
+
+        let lines: Vec<u64> = drain(&mut mf, 300).iter().map(|e| e.line_addr).collect();
+        assert_eq!(lines, [0x2000, 0x3000, 0x1000]);
+        assert_eq!(mf.next_completion(), None);
+    }
+
+    #[test]
+    fn test_reserve_tracks_waiterless_misses() {
+        let mut mf = MshrFile::new(1, 64);
+        assert!(matches!(mf.reserve(0x1000, false, 50), CacheResponse::MshrAllocated { .. }));
+        assert_eq!(mf.pending_fill(0x1010), Some(50));
+        assert_eq!(mf.pending_fill(0x2000), None);
+        assert!(matches!(
+            mf.reserve(0x1020, true, 80),
+            CacheResponse::MshrCoalesced { complete_cycle: 50 }
+        ));
+        assert_eq!(mf.reserve(0x2000, false, 80), CacheResponse::MshrFull);
+
+        mf.retire_through(50);
+        assert_eq!(mf.active_count(), 0);
+        assert!(matches!(mf.reserve(0x2000, false, 80), CacheResponse::MshrAllocated { .. }));
+    }
+
+    #[test]
+    fn test_flush_clears_pending_completions() {
+        let mut mf = MshrFile::new(2, 64);
+        mf.request(0x1000, false, 100, 10, make_waiter(1));
+        mf.flush();
+        assert_eq!(mf.next_completion(), None);
+        assert!(drain(&mut mf, 1000).is_empty());
+    }
 }
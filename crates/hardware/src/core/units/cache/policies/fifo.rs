@@ -35,6 +35,11 @@ impl FifoPolicy {
     pub fn new(sets: usize, ways: usize) -> Self {
         Self { next_way: vec![0; sets], ways }
     }
+
+    /// Restores the state of a freshly created policy, keeping its allocation.
+    pub fn reset(&mut self) {
+        self.next_way.fill(0);
+    }
 }
 
 impl ReplacementPolicy for FifoPolicy {
@@ -9,6 +9,9 @@
 //! - `Mru`: Most Recently Used.
 //! - `Plru`: Pseudo-LRU (Tree-based).
 //! - `Random`: Random selection.
+//!
+//! [`Policy`] wraps the concrete policies in an enum so the cache dispatches
+//! statically and the per-access `update` can inline into the set lookup.
 
 /// First-In, First-Out replacement policy.
 pub mod fifo;
@@ -31,6 +34,8 @@ pub use mru::MruPolicy;
 pub use plru::PlruPolicy;
 pub use random::RandomPolicy;
 
+use crate::config::ReplacementPolicy as PolicyType;
+
 /// Trait for cache replacement policies.
 ///
 /// Defines the interface for updating usage state and selecting victim lines.
@@ -54,3 +59,77 @@ pub trait ReplacementPolicy: Send + Sync {
     /// The index of the way to evict.
     fn get_victim(&mut self, set: usize) -> usize;
 }
+
+/// Statically dispatched replacement policy selected from the configuration.
+#[derive(Debug)]
+pub enum Policy {
+    /// First-In, First-Out.
+    Fifo(FifoPolicy),
+    /// Least Recently Used.
+    Lru(LruPolicy),
+    /// Most Recently Used.
+    Mru(MruPolicy),
+    /// Tree Pseudo-LRU.
+    Plru(PlruPolicy),
+    /// Random selection.
+    Random(RandomPolicy),
+}
+
+impl Policy {
+    /// Creates the policy of the given kind for `sets` x `ways` lines.
+    pub fn new(kind: PolicyType, sets: usize, ways: usize) -> Self {
+        match kind {
+            PolicyType::Fifo => Self::Fifo(FifoPolicy::new(sets, ways)),
+            PolicyType::Lru => Self::Lru(LruPolicy::new(sets, ways)),
+            PolicyType::Mru => Self::Mru(MruPolicy::new(sets, ways)),
+            PolicyType::Plru => Self::Plru(PlruPolicy::new(sets, ways)),
+            PolicyType::Random => Self::Random(RandomPolicy::new(sets, ways)),
+        }
+    }
+
+    /// Returns which kind of policy this is.
+    pub const fn kind(&self) -> PolicyType {
+        match self {
+            Self::Fifo(_) => PolicyType::Fifo,
+            Self::Lru(_) => PolicyType::Lru,
+            Self::Mru(_) => PolicyType::Mru,
+            Self::Plru(_) => PolicyType::Plru,
+            Self::Random(_) => PolicyType::Random,
+        }
+    }
+
+    /// Restores the state of a freshly created policy in place.
+    pub fn reset(&mut self) {
+        match self {
+            Self::Fifo(p) => p.reset(),
+            Self::Lru(p) => p.reset(),
+            Self::Mru(p) => p.reset(),
+            Self::Plru(p) => p.reset(),
+            Self::Random(p) => p.reset(),
+        }
+    }
+}
+
+impl ReplacementPolicy for Policy {
+    #[inline]
+    fn update(&mut self, set: usize, way: usize) {
+        match self {
+            Self::Fifo(p) => p.update(set, way),
+            Self::Lru(p) => p.update(set, way),
+            Self::Mru(p) => p.update(set, way),
+            Self::Plru(p) => p.update(set, way),
+            Self::Random(p) => p.update(set, way),
+        }
+    }
+
+    #[inline]
+    fn get_victim(&mut self, set: usize) -> usize {
+        match self {
+            Self::Fifo(p) => p.get_victim(set),
+            Self::Lru(p) => p.get_victim(set),
+            Self::Mru(p) => p.get_victim(set),
+            Self::Plru(p) => p.get_victim(set),
+            Self::Random(p) => p.get_victim(set),
+        }
+    }
+}
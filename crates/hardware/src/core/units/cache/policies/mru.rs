@@ -30,6 +30,15 @@ impl MruPolicy {
         }
         Self { usage }
     }
+
+    /// Restores the state of a freshly created policy, keeping its allocation.
+    pub fn reset(&mut self) {
+        for stack in &mut self.usage {
+            for (way, slot) in stack.iter_mut().enumerate() {
+                *slot = way;
+            }
+        }
+    }
 }
 
 impl ReplacementPolicy for MruPolicy {
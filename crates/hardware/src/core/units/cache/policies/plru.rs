@@ -38,6 +38,11 @@ impl PlruPolicy {
     pub fn new(sets: usize, ways: usize) -> Self {
         Self { usage: vec![0; sets], ways }
     }
+
+    /// Restores the state of a freshly created policy, keeping its allocation.
+    pub fn reset(&mut self) {
+        self.usage.fill(0);
+    }
 }
 
 impl ReplacementPolicy for PlruPolicy {
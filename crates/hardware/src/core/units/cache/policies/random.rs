@@ -25,6 +25,11 @@ impl RandomPolicy {
     pub const fn new(_sets: usize, ways: usize) -> Self {
         Self { ways, state: 123456789 }
     }
+
+    /// Restores the state of a freshly created policy, keeping its allocation.
+    pub const fn reset(&mut self) {
+        *self = Self::new(0, self.ways);
+    }
 }
 
 impl ReplacementPolicy for RandomPolicy {
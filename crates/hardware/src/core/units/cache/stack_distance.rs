@@ -0,0 +1,240 @@
+//! Single-pass LRU stack-distance profiling.
+//!
+//! Mattson's observation is that under LRU a set's contents at `w` ways are
+//! its `w` most recently used lines, so one LRU stack per set answers "would
+//! this access hit?" for every associativity at once: it hits at `w` ways iff
+//! its line is among the top `w` of the stack. Keeping one family of stacks
+//! per power-of-two set count covers every `sets × ways × line` geometry from
+//! a single pass over the access stream.
+//!
+//! Set sampling bounds the cost of the larger set counts: at most
+//! `sampled_sets` sets are tracked per set count, chosen by hashing the low
+//! set-index bits, and the miss ratios of those sets stand in for the cache.
+//! Set counts at or below the sample size are exact.
+
+use crate::config::StackDistanceConfig;
+
+/// Tag of an empty stack entry; real tags are line addresses shifted right,
+/// which cannot reach `u64::MAX`.
+const EMPTY: u64 = u64::MAX;
+
+/// Multiplier choosing which high set-index bits are sampled for given low
+/// bits (Fibonacci hashing).
+const SAMPLE_HASH: u64 = 0x9E37_79B9_7F4A_7C15;
+
+/// Stack-distance histograms for every profiled set count.
+///
+/// Lives in [`crate::stats::SimStats`] so a region of interest subtracts it
+/// like any other counter. Empty unless `cache.stack_distance` is enabled.
+#[derive(Clone, Debug, Default, PartialEq, Eq)]
+pub struct StackDistanceHistogram {
+    /// Line size in bytes.
+    pub line_bytes: u64,
+    /// Deepest stack position tracked (largest associativity answered).
+    pub ways: usize,
+    /// Profiled set counts, `1, 2, 4, ...`.
+    pub sets: Vec<u64>,
+    /// Accesses that fell in a tracked set, per set count.
+    pub accesses: Vec<u64>,
+    /// Hits per stack depth (0 = most recently used), `ways` per set count.
+    pub hits: Vec<u64>,
+}
+
+impl StackDistanceHistogram {
+    /// Returns `true` if nothing was profiled.
+    #[must_use]
+    pub const fn is_empty(&self) -> bool {
+        self.sets.is_empty()
+    }
+
+    /// Index of `sets` among the profiled set counts.
+    fn level(&self, sets: u64) -> Option<usize> {
+        self.sets.iter().position(|&s| s == sets)
+    }
+
+    /// Profiled accesses for a cache with `sets` sets.
+    #[must_use]
+    pub fn accesses(&self, sets: u64) -> Option<u64> {
+        self.level(sets).map(|level| self.accesses[level])
+    }
+
+    /// Profiled hits of an LRU cache with `sets` sets of `ways` ways.
+    ///
+    /// Returns `None` for a geometry outside the profiled range.
+    #[must_use]
+    pub fn hits(&self, sets: u64, ways: usize) -> Option<u64> {
+        if ways == 0 || ways > self.ways {
+            return None;
+        }
+        let level = self.level(sets)?;
+        Some(self.hits[level * self.ways..][..ways].iter().sum())
+    }
+
+    /// Miss ratio of an LRU cache with `sets` sets of `ways` ways.
+    ///
+    /// Returns `None` for a geometry outside the profiled range, and `0.0`
+    /// if no access reached a tracked set.
+    #[must_use]
+    pub fn miss_ratio(&self, sets: u64, ways: usize) -> Option<f64> {
+        let hits = self.hits(sets, ways)?;
+        let accesses = self.accesses(sets)?;
+        Some(if accesses == 0 { 0.0 } else { 1.0 - hits as f64 / accesses as f64 })
+    }
+
+    /// Returns the counts accumulated since `base`, an earlier snapshot of
+    /// this histogram. A `base` of another shape (or an empty one) is taken
+    /// as zero.
+    #[must_use]
+    pub fn since(&self, base: &Self) -> Self {
+        let mut delta = self.clone();
+        if base.sets == self.sets && base.ways == self.ways {
+            for (count, base) in delta.accesses.iter_mut().zip(&base.accesses) {
+                *count = count.saturating_sub(*base);
+            }
+            for (count, base) in delta.hits.iter_mut().zip(&base.hits) {
+                *count = count.saturating_sub(*base);
+            }
+        }
+        delta
+    }
+}
+
+/// LRU stacks feeding a [`StackDistanceHistogram`].
+#[derive(Clone, Debug)]
+pub struct StackDistanceProfiler {
+    /// log2 of the line size.
+    line_shift: u32,
+    /// Stack depth per set.
+    ways: usize,
+    /// log2 of the tracked sets per set count.
+    sample_bits: u32,
+    /// Per set count (`1 << index` sets), `ways` tags per tracked set, most
+    /// recently used first.
+    stacks: Vec<Vec<u64>>,
+}
+
+impl StackDistanceProfiler {
+    /// Creates a profiler for `config`.
+    ///
+    /// Sizes are rounded down to powers of two; at least one set, way, and
+    /// sampled set are profiled.
+    #[must_use]
+    pub fn new(config: &StackDistanceConfig) -> Self {
+        let line_shift = config.line_bytes.max(1).ilog2();
+        let set_bits = config.max_sets.max(1).ilog2().min(63 - line_shift);
+        let sample_bits = config.sampled_sets.max(1).ilog2();
+        let ways = config.max_ways.max(1);
+        let stacks = (0..=set_bits)
+            .map(|bits| vec![EMPTY; (1usize << bits.min(sample_bits)) * ways])
+            .collect();
+        Self { line_shift, ways, sample_bits, stacks }
+    }
+
+    /// An all-zero histogram of this profiler's shape.
+    #[must_use]
+    pub fn histogram(&self) -> StackDistanceHistogram {
+        let levels = self.stacks.len();
+        StackDistanceHistogram {
+            line_bytes: 1 << self.line_shift,
+            ways: self.ways,
+            sets: (0..levels).map(|bits| 1 << bits).collect(),
+            accesses: vec![0; levels],
+            hits: vec![0; levels * self.ways],
+        }
+    }
+
+    /// Profiles an access to `addr`, counting it in `hist` (given this
+    /// profiler's shape if empty).
+    pub fn access(&mut self, addr: u64, hist: &mut StackDistanceHistogram) {
+        if hist.is_empty() {
+            *hist = self.histogram();
+        }
+        let line = addr >> self.line_shift;
+        let (ways, sample_bits) = (self.ways, self.sample_bits);
+        for (level, stack) in self.stacks.iter_mut().enumerate() {
+            let set_bits = level as u32;
+            let set = line & ((1 << set_bits) - 1);
+            let slot = if set_bits > sample_bits {
+                let low = set & ((1 << sample_bits) - 1);
+                let picked = low.wrapping_mul(SAMPLE_HASH) >> (64 - (set_bits - sample_bits));
+                if set >> sample_bits != picked {
+                    continue;
+                }
+                low
+            } else {
+                set
+            };
+
+            let tag = line >> set_bits;
+            let entries = &mut stack[slot as usize * ways..][..ways];
+            hist.accesses[level] += 1;
+            if let Some(depth) = entries.iter().position(|&t| t == tag) {
+                hist.hits[level * ways + depth] += 1;
+                entries[..=depth].rotate_right(1);
+            } else {
+                entries.rotate_right(1);
+                entries[0] = tag;
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn config(max_sets: usize, max_ways: usize, sampled_sets: usize) -> StackDistanceConfig {
+        StackDistanceConfig { enabled: true, line_bytes: 64, max_sets, max_ways, sampled_sets }
+    }
+
+    #[test]
+    fn cyclic_sweep_thrashes_until_it_fits() {
+        let mut profiler = StackDistanceProfiler::new(&config(16, 8, 16));
+        let mut hist = StackDistanceHistogram::default();
+        // Eight lines touched round-robin, ten times.
+        for _ in 0..10 {
+            for line in 0..8 {
+                profiler.access(line * 64, &mut hist);
+            }
+        }
+
+        // Fully associative: LRU misses every access below eight ways.
+        assert_eq!(hist.accesses(1), Some(80));
+        assert_eq!(hist.miss_ratio(1, 7), Some(1.0));
+        assert_eq!(hist.hits(1, 8), Some(72), "only the cold misses remain");
+        // Eight sets: each line has its own set.
+        assert_eq!(hist.hits(8, 1), Some(72));
+        // Two sets of four lines each, cycled: four ways hold them.
+        assert_eq!(hist.hits(2, 3), Some(0));
+        assert_eq!(hist.hits(2, 4), Some(72));
+        assert_eq!(hist.miss_ratio(32, 1), None, "beyond max_sets");
+        assert_eq!(hist.hits(1, 9), None, "beyond max_ways");
+    }
+
+    #[test]
+    fn sampling_tracks_a_subset_of_sets() {
+        let mut profiler = StackDistanceProfiler::new(&config(64, 4, 8));
+        let mut hist = StackDistanceHistogram::default();
+        for _ in 0..4 {
+            for line in 0..64 {
+                profiler.access(line * 64, &mut hist);
+            }
+        }
+        assert_eq!(hist.accesses(8), Some(256), "unsampled");
+        assert_eq!(hist.accesses(64), Some(8 * 4), "one set in eight");
+        assert_eq!(hist.hits(64, 1), Some(8 * 3));
+    }
+
+    #[test]
+    fn since_subtracts_a_snapshot() {
+        let mut profiler = StackDistanceProfiler::new(&config(4, 2, 4));
+        let mut hist = StackDistanceHistogram::default();
+        profiler.access(0, &mut hist);
+        let base = hist.clone();
+        profiler.access(0, &mut hist);
+        let delta = hist.since(&base);
+        assert_eq!(delta.accesses(1), Some(1));
+        assert_eq!(delta.hits(1, 1), Some(1));
+        assert_eq!(hist.since(&StackDistanceHistogram::default()), hist);
+    }
+}
@@ -0,0 +1,149 @@
+//! Vectorized Tag Match.
+//!
+//! Compares one tag against every way of a set in a single pass and returns
+//! the matching ways as a bitmask. The implementation is selected at compile
+//! time from the target features (`.cargo/config.toml` builds with
+//! `target-cpu=native` locally):
+//! 1. **AVX2:** Four 64-bit tags per compare (`vpcmpeqq` + `vmovmskpd`).
+//! 2. **SSE4.1:** Two tags per compare (`pcmpeqq` + `movmskpd`).
+//! 3. **NEON:** Two tags per compare (`cmeq`), lanes narrowed to bits.
+//! 4. **Scalar:** A branch-free fold the compiler is free to vectorize.
+
+/// Maximum number of tags compared by one [`match_ways`] call.
+pub const MAX_WAYS_PER_MATCH: usize = 64;
+
+/// Returns a mask with bit `i` set when `tags[i] == tag`.
+///
+/// `tags` holds at most [`MAX_WAYS_PER_MATCH`] entries; higher entries are ignored.
+#[inline]
+pub fn match_ways(tags: &[u64], tag: u64) -> u64 {
+    let tags = &tags[..tags.len().min(MAX_WAYS_PER_MATCH)];
+    simd::match_ways(tags, tag)
+}
+
+/// Scalar compare of `tags` (element `i` maps to bit `offset + i`).
+#[inline]
+fn match_scalar(tags: &[u64], tag: u64, offset: usize) -> u64 {
+    tags.iter().enumerate().fold(0, |mask, (i, &t)| mask | (u64::from(t == tag) << (offset + i)))
+}
+
+#[cfg(all(target_arch = "x86_64", target_feature = "avx2"))]
+mod simd {
+    use std::arch::x86_64::{
+        _mm256_castsi256_pd, _mm256_cmpeq_epi64, _mm256_loadu_si256, _mm256_movemask_pd,
+        _mm256_set1_epi64x,
+    };
+
+    #[inline]
+    pub(super) fn match_ways(tags: &[u64], tag: u64) -> u64 {
+        let chunks = tags.chunks_exact(4);
+        let tail = chunks.remainder();
+        let mut mask = 0;
+        // SAFETY: AVX2 is enabled at compile time (cfg above), and every load
+        // reads exactly the four `u64`s of a `chunks_exact(4)` chunk;
+        // `loadu` has no alignment requirement.
+        unsafe {
+            let needle = _mm256_set1_epi64x(tag as i64);
+            for (i, chunk) in chunks.enumerate() {
+                let ways = _mm256_loadu_si256(chunk.as_ptr().cast());
+                let eq = _mm256_cmpeq_epi64(ways, needle);
+                mask |= (_mm256_movemask_pd(_mm256_castsi256_pd(eq)) as u64) << (i * 4);
+            }
+        }
+        mask | super::match_scalar(tail, tag, tags.len() - tail.len())
+    }
+}
+
+#[cfg(all(target_arch = "x86_64", target_feature = "sse4.1", not(target_feature = "avx2")))]
+mod simd {
+    use std::arch::x86_64::{
+        _mm_castsi128_pd, _mm_cmpeq_epi64, _mm_loadu_si128, _mm_movemask_pd, _mm_set1_epi64x,
+    };
+
+    #[inline]
+    pub(super) fn match_ways(tags: &[u64], tag: u64) -> u64 {
+        let chunks = tags.chunks_exact(2);
+        let tail = chunks.remainder();
+        let mut mask = 0;
+        // SAFETY: SSE4.1 is enabled at compile time (cfg above), and every load
+        // reads exactly the two `u64`s of a `chunks_exact(2)` chunk;
+        // `loadu` has no alignment requirement.
+        unsafe {
+            let needle = _mm_set1_epi64x(tag as i64);
+            for (i, chunk) in chunks.enumerate() {
+                let ways = _mm_loadu_si128(chunk.as_ptr().cast());
+                let eq = _mm_cmpeq_epi64(ways, needle);
+                mask |= (_mm_movemask_pd(_mm_castsi128_pd(eq)) as u64) << (i * 2);
+            }
+        }
+        mask | super::match_scalar(tail, tag, tags.len() - tail.len())
+    }
+}
+
+#[cfg(all(target_arch = "aarch64", target_feature = "neon"))]
+mod simd {
+    use std::arch::aarch64::{vceqq_u64, vdupq_n_u64, vgetq_lane_u64, vld1q_u64};
+
+    #[inline]
+    pub(super) fn match_ways(tags: &[u64], tag: u64) -> u64 {
+        let chunks = tags.chunks_exact(2);
+        let tail = chunks.remainder();
+        let mut mask = 0;
+        // SAFETY: NEON is enabled at compile time (cfg above), and every load
+        // reads exactly the two `u64`s of a `chunks_exact(2)` chunk.
+        unsafe {
+            let needle = vdupq_n_u64(tag);
+            for (i, chunk) in chunks.enumerate() {
+                let eq = vceqq_u64(vld1q_u64(chunk.as_ptr()), needle);
+                let lanes = (vgetq_lane_u64::<0>(eq) & 1) | (vgetq_lane_u64::<1>(eq) & 2);
+                mask |= lanes << (i * 2);
+            }
+        }
+        mask | super::match_scalar(tail, tag, tags.len() - tail.len())
+    }
+}
+
+#[cfg(not(any(
+    all(target_arch = "x86_64", target_feature = "sse4.1"),
+    all(target_arch = "aarch64", target_feature = "neon"),
+)))]
+mod simd {
+    #[inline]
+    pub(super) fn match_ways(tags: &[u64], tag: u64) -> u64 {
+        super::match_scalar(tags, tag, 0)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_matches_scalar_for_every_width_and_position() {
+        for ways in 1..=MAX_WAYS_PER_MATCH {
+            let mut tags: Vec<u64> = (0..ways as u64).map(|i| 0x1000 + i).collect();
+            for hit in 0..ways {
+                assert_eq!(match_ways(&tags, 0x1000 + hit as u64), 1 << hit, "ways={ways}");
+            }
+            assert_eq!(match_ways(&tags, 7), 0);
+
+            // Duplicate tags (e.g. several invalid ways) set several bits.
+            tags[0] = u64::MAX;
+            tags[ways - 1] = u64::MAX;
+            assert_eq!(match_ways(&tags, u64::MAX), match_scalar(&tags, u64::MAX, 0));
+        }
+    }
+
+    #[test]
+    fn test_high_bit_tags_compare_exactly() {
+        let tags = [0x8000_0000_0000_0001, 1, 0x8000_0000_0000_0000];
+        assert_eq!(match_ways(&tags, 0x8000_0000_0000_0000), 0b100);
+        assert_eq!(match_ways(&tags, 1), 0b010);
+    }
+
+    #[test]
+    fn test_ways_beyond_limit_are_ignored() {
+        let tags = vec![5u64; MAX_WAYS_PER_MATCH + 8];
+        assert_eq!(match_ways(&tags, 5), u64::MAX);
+    }
+}
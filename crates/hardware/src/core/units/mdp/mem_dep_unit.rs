@@ -194,6 +194,13 @@ impl MemDepUnit {
         }
     }
 
+    /// Advances the predictor clock by `cycles` ticks at once.
+    pub fn tick_by(&mut self, cycles: u64) {
+        if let PredictorKind::StoreSet(predictor) = &mut self.predictor {
+            predictor.tick_by(cycles);
+        }
+    }
+
     /// Returns a snapshot of predictor statistics.
     pub fn stats(&self) -> MdpStats {
         self.stats.clone()
@@ -56,6 +56,18 @@ impl StoreSetPredictor {
     const fn ssit_index(&self, pc: u64) -> SsitIndex {
         SsitIndex::from_pc(pc, self.ssit.len())
     }
+
+    /// Advances the clear clock by `cycles` ticks, clearing the SSIT if a
+    /// clear interval boundary falls within them (as `cycles` ticks would).
+    pub fn tick_by(&mut self, cycles: u64) {
+        let before = self.tick_counter;
+        self.tick_counter += cycles;
+        if self.ssit_clear_interval > 0
+            && self.tick_counter / self.ssit_clear_interval != before / self.ssit_clear_interval
+        {
+            self.ssit.fill(None);
+        }
+    }
 }
 
 impl MemDepPredictor for StoreSetPredictor {
@@ -321,4 +333,23 @@ mod tests {
         // the SSIT no longer maps the PC to a set).
         assert_eq!(p.predict(load_pc, RobTag(10), false), MemPrediction::NoDep);
     }
+
+    #[test]
+    fn test_tick_by_clears_only_across_interval_boundary() {
+        let mut p = StoreSetPredictor::new(&StoreSetConfig {
+            ssit_size: 64,
+            lfst_size: 16,
+            ssit_clear_interval: 100,
+        });
+        let (load_pc, store_pc) = (0x1000, 0x2000);
+        p.train(load_pc, store_pc);
+        p.register_store(store_pc, RobTag(5));
+
+        p.tick_by(99);
+        assert_eq!(p.predict(load_pc, RobTag(10), false), MemPrediction::DepOn(RobTag(5)));
+
+        // The 100th tick falls inside this batch.
+        p.tick_by(1000);
+        assert_eq!(p.predict(load_pc, RobTag(10), false), MemPrediction::NoDep);
+    }
 }
@@ -3,7 +3,7 @@
 //! This module implements the Memory Management Unit, responsible for
 //! virtual-to-physical address translation. It supports the RISC-V SV39
 //! paging scheme and includes Translation Lookaside Buffers (TLBs) for
-//! caching translations.
+//! caching translations and a page-walk cache for the upper page-table levels.
 
 /// Physical Memory Protection (PMP).
 pub mod pmp;
@@ -11,21 +11,71 @@ pub mod pmp;
 /// Page table walker implementation for SV39 virtual memory.
 pub mod ptw;
 
+/// Page-walk cache for non-leaf page-table entries.
+pub mod pwc;
+
 /// Translation Lookaside Buffer (TLB) for caching virtual-to-physical address translations.
 pub mod tlb;
 
 use crate::common::{AccessType, Asid, PhysAddr, TranslationResult, Trap, VirtAddr, Vpn};
+use crate::config::MemoryConfig;
 use crate::core::arch::csr::Csrs;
 use crate::core::arch::mode::PrivilegeMode;
 use crate::core::units::mmu::pmp::Pmp;
 use crate::soc::interconnect::Bus;
+use crate::stats::SimStats;
+
+use self::pwc::PageWalkCache;
+use self::tlb::{L2Tlb, Tlb, TlbHit};
+
+/// Translation counters kept by the MMU and mirrored into [`SimStats`].
+#[derive(Clone, Copy, Debug, Default)]
+pub struct MmuStats {
+    /// Fetch translations that hit the iTLB.
+    pub itlb_hits: u64,
+    /// Fetch translations that missed the iTLB.
+    pub itlb_misses: u64,
+    /// Load/store translations that hit the dTLB.
+    pub dtlb_hits: u64,
+    /// Load/store translations that missed the dTLB.
+    pub dtlb_misses: u64,
+    /// L1 misses served by the shared L2 TLB.
+    pub l2_tlb_hits: u64,
+    /// L1 misses that also missed the L2 TLB.
+    pub l2_tlb_misses: u64,
+    /// TLB hits (L1 or L2) served by a 2 MiB / 1 GiB superpage entry.
+    pub superpage_hits: u64,
+    /// Hardware page table walks.
+    pub page_walks: u64,
+    /// PTEs read from memory by the walker.
+    pub pte_reads: u64,
+    /// Walks that resumed below the root from a page-walk cache entry.
+    pub pwc_hits: u64,
+    /// Walks that found no page-walk cache entry.
+    pub pwc_misses: u64,
+}
 
-use self::tlb::{L2Tlb, Tlb};
+impl MmuStats {
+    /// Copies the counters into the simulator statistics.
+    pub const fn copy_to(&self, stats: &mut SimStats) {
+        stats.itlb_hits = self.itlb_hits;
+        stats.itlb_misses = self.itlb_misses;
+        stats.dtlb_hits = self.dtlb_hits;
+        stats.dtlb_misses = self.dtlb_misses;
+        stats.l2_tlb_hits = self.l2_tlb_hits;
+        stats.l2_tlb_misses = self.l2_tlb_misses;
+        stats.tlb_superpage_hits = self.superpage_hits;
+        stats.page_walks = self.page_walks;
+        stats.ptw_pte_reads = self.pte_reads;
+        stats.pwc_hits = self.pwc_hits;
+        stats.pwc_misses = self.pwc_misses;
+    }
+}
 
 /// Memory Management Unit (MMU) for virtual-to-physical address translation.
 ///
 /// Implements RISC-V SV39 page-based virtual memory with separate instruction
-/// and data L1 TLBs, a shared L2 TLB, and a page table walker.
+/// and data L1 TLBs, a shared L2 TLB, a page-walk cache, and a page table walker.
 #[derive(Debug)]
 pub struct Mmu {
     /// Data TLB for load/store address translation.
@@ -34,6 +84,10 @@ pub struct Mmu {
     pub itlb: Tlb,
     /// Shared L2 TLB (set-associative, consulted on L1 miss).
     pub l2_tlb: L2Tlb,
+    /// Page-walk cache of upper-level pointer PTEs (consulted on L2 TLB miss).
+    pub pwc: PageWalkCache,
+    /// Translation counters.
+    pub stats: MmuStats,
     /// Software-managed A/D bits: PTW faults on A=0 or D=0 instead of
     /// auto-setting them (matches spike's behavior).
     pub software_ad_bits: bool,
@@ -51,7 +105,8 @@ impl Mmu {
     ///
     /// # Returns
     ///
-    /// A new `Mmu` instance with initialized TLBs.
+    /// A new `Mmu` instance with initialized TLBs, without superpage entries
+    /// or a page-walk cache (see [`Mmu::from_config`]).
     pub fn new(
         tlb_size: usize,
         l2_size: usize,
@@ -63,10 +118,39 @@ impl Mmu {
             dtlb: Tlb::new(tlb_size),
             itlb: Tlb::new(tlb_size),
             l2_tlb: L2Tlb::new(l2_size, l2_ways, l2_latency),
+            pwc: PageWalkCache::new(0),
+            stats: MmuStats::default(),
             software_ad_bits,
         }
     }
 
+    /// Creates an MMU sized by the memory configuration, including the
+    /// superpage TLB entries and the page-walk cache.
+    pub fn from_config(config: &MemoryConfig) -> Self {
+        Self {
+            dtlb: Tlb::with_superpages(config.tlb_size, config.tlb_superpage_entries),
+            itlb: Tlb::with_superpages(config.tlb_size, config.tlb_superpage_entries),
+            l2_tlb: L2Tlb::with_superpages(
+                config.l2_tlb_size,
+                config.l2_tlb_ways,
+                config.l2_tlb_latency,
+                config.l2_tlb_superpage_entries,
+            ),
+            pwc: PageWalkCache::new(config.page_walk_cache_size),
+            stats: MmuStats::default(),
+            software_ad_bits: config.software_ad_bits,
+        }
+    }
+
+    /// Flushes every TLB level and the page-walk cache (`SFENCE.VMA x0, x0`,
+    /// `satp` writes, checkpoint restore).
+    pub fn flush_all(&mut self) {
+        self.dtlb.flush();
+        self.itlb.flush();
+        self.l2_tlb.flush();
+        self.pwc.flush();
+    }
+
     /// Translates a virtual address to a physical address.
     ///
     /// Performs address translation using the page table walker and TLBs,
@@ -176,6 +260,15 @@ impl Mmu {
             self.dtlb.lookup(vpn, asid)
         };
 
+        let l1_hit = tlb_entry.filter(|hit| access != AccessType::Write || hit.d);
+        if access == AccessType::Fetch {
+            self.stats.itlb_hits += u64::from(l1_hit.is_some());
+            self.stats.itlb_misses += u64::from(l1_hit.is_none());
+        } else {
+            self.stats.dtlb_hits += u64::from(l1_hit.is_some());
+            self.stats.dtlb_misses += u64::from(l1_hit.is_none());
+        }
+
         if let Some(hit) = tlb_entry {
             // If writing to a page with D=0, invalidate the TLB entry and
             // fall through to the page table walk so the PTW sets the dirty
@@ -183,6 +276,7 @@ impl Mmu {
             if access == AccessType::Write && !hit.d {
                 self.dtlb.invalidate(vpn);
             } else {
+                self.stats.superpage_hits += u64::from(hit.level > 0);
                 if access == AccessType::Write && !hit.w {
                     return TranslationResult::fault(Trap::StorePageFault(vaddr.val()), 0);
                 }
@@ -220,13 +314,13 @@ impl Mmu {
 
         // L1 TLB miss — check the shared L2 TLB before invoking the PTW.
         let l2_latency = self.l2_tlb.latency;
-        if let Some((ppn, pte_bits, entry_asid)) = self.l2_tlb.lookup(vpn, asid) {
-            // Extract permission bits from cached PTE.
-            let r = (pte_bits >> 1) & 1 != 0;
-            let w = (pte_bits >> 2) & 1 != 0;
-            let x = (pte_bits >> 3) & 1 != 0;
-            let u = (pte_bits >> 4) & 1 != 0;
-            let d = (pte_bits >> 7) & 1 != 0;
+        let l2_entry = self.l2_tlb.lookup(vpn, asid);
+        let l2_hit = l2_entry.is_some_and(|(hit, _, _)| access != AccessType::Write || hit.d);
+        self.stats.l2_tlb_hits += u64::from(l2_hit);
+        self.stats.l2_tlb_misses += u64::from(!l2_hit);
+
+        if let Some((hit, pte_bits, entry_asid)) = l2_entry {
+            let TlbHit { ppn, r, w, x, u, d, level } = hit;
 
             // Check dirty bit — if writing with D=0, fall through to PTW.
             if access == AccessType::Write && !d {
@@ -234,6 +328,7 @@ impl Mmu {
                 // Do NOT promote to L1 — the entry has D=0 and would
                 // cause a repeated fallthrough on the next L1 hit.
             } else {
+                self.stats.superpage_hits += u64::from(level > 0);
                 // Permission checks (must mirror the L1 TLB hit path).
                 // Run these BEFORE promoting to L1 so faulting entries
                 // never pollute the L1 cache.
@@ -277,9 +372,9 @@ impl Mmu {
 
                 // Permissions passed — promote to L1 TLB.
                 if access == AccessType::Fetch {
-                    self.itlb.insert(vpn, ppn, pte_bits, entry_asid);
+                    self.itlb.insert_page(vpn, ppn, pte_bits, entry_asid, level);
                 } else {
-                    self.dtlb.insert(vpn, ppn, pte_bits, entry_asid);
+                    self.dtlb.insert_page(vpn, ppn, pte_bits, entry_asid, level);
                 }
 
                 let paddr = ppn.to_addr() | vaddr.page_offset();
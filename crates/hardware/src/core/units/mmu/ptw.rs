@@ -117,7 +117,8 @@ impl PageTableEntry {
 
 /// Performs a hardware page table walk for SV39.
 ///
-/// Traverses the page table tree starting from the root PPN in the SATP register.
+/// Traverses the page table tree starting from the root PPN in the SATP register,
+/// or from the deepest table the page-walk cache holds a pointer to.
 /// It supports 4KB pages, 2MB megapages, and 1GB gigapages.
 ///
 /// # Arguments
@@ -177,11 +178,23 @@ fn page_table_walk_inner(
     const PTE_UPDATE_CYCLES: u64 = 10;
 
     let satp = csrs.satp;
-    let mut ppn_raw = satp & SATP_PPN_MASK;
+    let root_ppn = satp & SATP_PPN_MASK;
     let asid = Asid::new(((satp >> SATP_ASID_SHIFT) & SATP_ASID_MASK) as u16);
+    let vpn = Vpn::new((vaddr.val() >> PAGE_SHIFT) & VPN_MASK);
     let mut cycles = 0;
 
-    for level in (0..SV39_LEVELS).rev() {
+    mmu.stats.page_walks += 1;
+    let (start_level, mut ppn_raw) = if mmu.pwc.is_disabled() {
+        (SV39_LEVELS - 1, root_ppn)
+    } else if let Some(cached) = mmu.pwc.lookup(root_ppn, vpn.val()) {
+        mmu.stats.pwc_hits += 1;
+        cached
+    } else {
+        mmu.stats.pwc_misses += 1;
+        (SV39_LEVELS - 1, root_ppn)
+    };
+
+    for level in (0..=start_level).rev() {
         let vpn_shift = PAGE_SHIFT + level as u64 * VPN_BITS_PER_LEVEL;
         let vpn_i = (vaddr.val() >> vpn_shift) & VPN_ENTRY_MASK;
         let pte_addr = (ppn_raw << PAGE_SHIFT) + (vpn_i * PTE_SIZE);
@@ -202,6 +215,7 @@ fn page_table_walk_inner(
         }
 
         cycles += bus.calculate_transit_time(8);
+        mmu.stats.pte_reads += 1;
         let raw_pte = bus.read_u64(crate::common::PhysAddr::new(pte_addr));
         let pte = PageTableEntry::new(raw_pte);
 
@@ -214,6 +228,7 @@ fn page_table_walk_inner(
                 return TranslationResult::fault(page_fault(vaddr.val(), access), cycles);
             }
             ppn_raw = pte.ppn_raw();
+            mmu.pwc.insert(root_ppn, level, vpn.val(), ppn_raw);
             continue;
         }
 
@@ -266,19 +281,20 @@ fn page_table_walk_inner(
         let final_paddr = final_ppn.to_addr() | (vaddr.val() & offset_mask);
 
         let specific_4kb_ppn = Ppn::new(final_paddr >> PAGE_SHIFT);
-        let vpn = Vpn::new((vaddr.val() >> PAGE_SHIFT) & VPN_MASK);
 
         // Insert the *original* PTE bits into TLBs (without speculative
         // A/D updates). After commit writes the A/D bits to RAM, the
         // next access will re-walk and cache the correct state.
+        // Superpage leaves occupy one superpage entry where configured.
         let pte_raw = pte.raw();
+        let page_level = level as u8;
         if access == AccessType::Fetch {
-            mmu.itlb.insert(vpn, specific_4kb_ppn, pte_raw, asid);
+            mmu.itlb.insert_page(vpn, specific_4kb_ppn, pte_raw, asid, page_level);
         } else {
-            mmu.dtlb.insert(vpn, specific_4kb_ppn, pte_raw, asid);
+            mmu.dtlb.insert_page(vpn, specific_4kb_ppn, pte_raw, asid, page_level);
         }
         // Also populate the shared L2 TLB.
-        mmu.l2_tlb.insert(vpn, specific_4kb_ppn, pte_raw, asid);
+        mmu.l2_tlb.insert_page(vpn, specific_4kb_ppn, pte_raw, asid, page_level);
 
         return pte_update.map_or_else(
             || TranslationResult::success(PhysAddr::new(final_paddr), cycles),
@@ -0,0 +1,143 @@
+//! Page-Walk Cache (PWC).
+//!
+//! Caches the non-leaf (pointer) PTEs read by the hardware page table walker,
+//! keyed by the page-table root and the VPN bits that select them. A walk that
+//! misses both TLB levels probes the PWC first and, on a hit, starts directly
+//! at the deepest cached table: a level-1 pointer hit skips two of the three
+//! SV39 PTE reads, a level-2 (root) pointer hit skips one.
+//!
+//! Non-leaf PTEs carry no A/D bits, so cached pointers never go stale through
+//! walker updates. Software must order page-table edits with `SFENCE.VMA`; the
+//! PWC is flushed by the global and per-ASID forms and by `satp` writes. The
+//! per-address forms only order leaf PTEs (privileged spec, 4.2.1) and leave
+//! the PWC intact.
+
+/// Number of VPN bits translated by each SV39 page-table level.
+const VPN_BITS_PER_LEVEL: u32 = 9;
+
+/// A cached pointer PTE.
+#[derive(Clone, Copy, Debug, Default)]
+struct PwcEntry {
+    /// Root table PPN (`satp.PPN`) of the address space this pointer belongs to.
+    root: u64,
+    /// Level of the table the pointer PTE was read from (2 or 1).
+    level: u8,
+    /// VPN bits above `level` that selected the pointer (`vpn >> 9 * level`).
+    prefix: u64,
+    /// PPN of the next-level table the pointer leads to.
+    next_ppn: u64,
+    /// Entry validity flag.
+    valid: bool,
+}
+
+/// Fully-associative page-walk cache with round-robin replacement.
+#[derive(Debug)]
+pub struct PageWalkCache {
+    /// Entry storage; empty when the PWC is disabled.
+    entries: Vec<PwcEntry>,
+    /// Next round-robin victim.
+    next: usize,
+}
+
+impl PageWalkCache {
+    /// Creates a page-walk cache with `size` entries (0 disables it).
+    pub fn new(size: usize) -> Self {
+        Self { entries: vec![PwcEntry::default(); size], next: 0 }
+    }
+
+    /// Returns `true` if the PWC has no entries (caching disabled).
+    pub const fn is_disabled(&self) -> bool {
+        self.entries.is_empty()
+    }
+
+    /// Finds the deepest cached pointer on the walk of `vpn` from `root`.
+    ///
+    /// Returns `(level, table_ppn)`: the walk resumes at `level` reading from
+    /// the table at `table_ppn`. `None` means the walk starts at the root.
+    pub fn lookup(&self, root: u64, vpn: u64) -> Option<(usize, u64)> {
+        let mut best: Option<&PwcEntry> = None;
+        for e in &self.entries {
+            if e.valid
+                && e.root == root
+                && e.prefix == vpn >> (VPN_BITS_PER_LEVEL * u32::from(e.level))
+                && best.is_none_or(|b| e.level < b.level)
+            {
+                best = Some(e);
+            }
+        }
+        best.map(|e| (usize::from(e.level) - 1, e.next_ppn))
+    }
+
+    /// Records the pointer PTE read at `level` (2 or 1) on the walk of `vpn`.
+    pub fn insert(&mut self, root: u64, level: usize, vpn: u64, next_ppn: u64) {
+        let n = self.entries.len();
+        if n == 0 {
+            return;
+        }
+        let level = level as u8;
+        let prefix = vpn >> (VPN_BITS_PER_LEVEL * u32::from(level));
+        let slot = self
+            .entries
+            .iter()
+            .position(|e| e.valid && e.root == root && e.level == level && e.prefix == prefix)
+            .or_else(|| self.entries.iter().position(|e| !e.valid))
+            .unwrap_or_else(|| {
+                let victim = self.next;
+                self.next = (victim + 1) % n;
+                victim
+            });
+        self.entries[slot] = PwcEntry { root, level, prefix, next_ppn, valid: true };
+    }
+
+    /// Invalidates every cached pointer.
+    pub fn flush(&mut self) {
+        for e in &mut self.entries {
+            e.valid = false;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const ROOT: u64 = 0x80000;
+
+    #[test]
+    fn test_deepest_pointer_wins() {
+        let mut pwc = PageWalkCache::new(4);
+        let vpn = (1 << 18) | (3 << 9) | 5;
+        assert_eq!(pwc.lookup(ROOT, vpn), None);
+
+        pwc.insert(ROOT, 2, vpn, 0x100);
+        assert_eq!(pwc.lookup(ROOT, vpn), Some((1, 0x100)));
+        pwc.insert(ROOT, 1, vpn, 0x200);
+        assert_eq!(pwc.lookup(ROOT, vpn), Some((0, 0x200)));
+
+        // Same gigabyte, different megabyte: only the root pointer applies.
+        assert_eq!(pwc.lookup(ROOT, (1 << 18) | (4 << 9)), Some((1, 0x100)));
+        // Other address spaces never hit.
+        assert_eq!(pwc.lookup(ROOT + 1, vpn), None);
+    }
+
+    #[test]
+    fn test_round_robin_replacement_and_flush() {
+        let mut pwc = PageWalkCache::new(2);
+        for g in 0..3u64 {
+            pwc.insert(ROOT, 2, g << 18, 0x100 + g);
+        }
+        assert_eq!(pwc.lookup(ROOT, 0), None, "oldest entry was replaced");
+        assert_eq!(pwc.lookup(ROOT, 2 << 18), Some((1, 0x102)));
+
+        pwc.flush();
+        assert_eq!(pwc.lookup(ROOT, 2 << 18), None);
+    }
+
+    #[test]
+    fn test_disabled_cache_stores_nothing() {
+        let mut pwc = PageWalkCache::new(0);
+        assert!(pwc.is_disabled());
+        pwc.insert(ROOT, 2, 0, 0x100);
+        assert_eq!(pwc.lookup(ROOT, 0), None);
+    }
+}
@@ -5,6 +5,12 @@
 //! (VPN) and Physical Page Numbers (PPN), along with permission bits (R/W/X/U)
 //! to speed up address translation. On L1 miss the shared L2 TLB is consulted
 //! before invoking the hardware page table walker.
+//!
+//! Both levels can also hold a small fully-associative array of superpage
+//! (2 MiB megapage / 1 GiB gigapage) entries. One such entry covers every
+//! 4 KiB page of the superpage, so large kernel and huge-page mappings no
+//! longer occupy (and thrash) one indexed slot per 4 KiB page touched. The
+//! superpage array is probed only when the indexed 4 KiB array misses.
 
 use crate::common::{Asid, Ppn, Vpn};
 
@@ -24,6 +30,8 @@ pub struct TlbHit {
     pub u: bool,
     /// Dirty bit (if `false` on a write, the PTW must set it before the mapping is cached).
     pub d: bool,
+    /// Page-table level of the mapping: 0 = 4 KiB, 1 = 2 MiB, 2 = 1 GiB.
+    pub level: u8,
 }
 
 /// A single entry in the TLB.
@@ -50,6 +58,111 @@ struct TlbEntry {
     asid: Asid,
     /// PTE Global bit — matches regardless of ASID.
     global: bool,
+    /// Page-table level of the leaf (0 = 4 KiB, 1 = 2 MiB, 2 = 1 GiB).
+    /// Superpage entries store the VPN/PPN of the first 4 KiB page.
+    level: u8,
+}
+
+/// Number of VPN bits translated by each SV39 page-table level.
+const VPN_BITS_PER_LEVEL: u64 = 9;
+
+/// Mask of the VPN bits that fall inside a page of the given level.
+const fn span_mask(level: u8) -> u64 {
+    (1 << (level as u64 * VPN_BITS_PER_LEVEL)) - 1
+}
+
+impl TlbEntry {
+    /// Builds a valid entry from a raw PTE. `vpn`/`ppn` may name any 4 KiB
+    /// page inside the mapping; they are aligned down to the page of `level`.
+    const fn from_pte(vpn: Vpn, ppn: Ppn, pte: u64, asid: Asid, level: u8) -> Self {
+        let span = span_mask(level);
+        Self {
+            vpn: Vpn::new(vpn.val() & !span),
+            ppn: Ppn::new(ppn.val() & !span),
+            valid: true,
+            r: (pte >> 1) & 1 != 0,
+            w: (pte >> 2) & 1 != 0,
+            x: (pte >> 3) & 1 != 0,
+            u: (pte >> 4) & 1 != 0,
+            global: (pte >> 5) & 1 != 0,
+            d: (pte >> 7) & 1 != 0,
+            asid,
+            level,
+        }
+    }
+
+    /// Returns `true` if this entry translates `vpn` for `asid`.
+    const fn matches(&self, vpn: Vpn, asid: Asid) -> bool {
+        self.valid
+            && (self.vpn.val() ^ vpn.val()) & !span_mask(self.level) == 0
+            && (self.global || self.asid.val() == asid.val())
+    }
+
+    /// Returns `true` if this entry's mapping covers `vpn` (any ASID).
+    const fn covers(&self, vpn: Vpn) -> bool {
+        self.valid && (self.vpn.val() ^ vpn.val()) & !span_mask(self.level) == 0
+    }
+
+    /// Translation of `vpn` (which this entry must cover).
+    const fn hit(&self, vpn: Vpn) -> TlbHit {
+        TlbHit {
+            ppn: Ppn::new(self.ppn.val() | (vpn.val() & span_mask(self.level))),
+            r: self.r,
+            w: self.w,
+            x: self.x,
+            u: self.u,
+            d: self.d,
+            level: self.level,
+        }
+    }
+}
+
+/// Fully-associative superpage entries with round-robin replacement.
+#[derive(Debug)]
+struct SuperpageArray {
+    /// Entry storage; empty when superpage entries are disabled.
+    entries: Vec<TlbEntry>,
+    /// Next round-robin victim.
+    next: usize,
+}
+
+impl SuperpageArray {
+    fn new(size: usize) -> Self {
+        Self { entries: vec![TlbEntry::default(); size], next: 0 }
+    }
+
+    fn lookup(&self, vpn: Vpn, asid: Asid) -> Option<TlbHit> {
+        self.entries.iter().find(|e| e.matches(vpn, asid)).map(|e| e.hit(vpn))
+    }
+
+    /// Installs `entry`, replacing a stale copy of the same mapping first,
+    /// then an invalid slot, then the round-robin victim.
+    fn insert(&mut self, entry: TlbEntry) {
+        let n = self.entries.len();
+        if n == 0 {
+            return;
+        }
+        let slot = self
+            .entries
+            .iter()
+            .position(|e| e.matches(entry.vpn, entry.asid) && e.level == entry.level)
+            .or_else(|| self.entries.iter().position(|e| !e.valid))
+            .unwrap_or_else(|| {
+                let victim = self.next;
+                self.next = (victim + 1) % n;
+                victim
+            });
+        self.entries[slot] = entry;
+    }
+
+    /// Invalidates every entry for which `pred` holds.
+    fn invalidate_where(&mut self, pred: impl Fn(&TlbEntry) -> bool) {
+        for e in &mut self.entries {
+            if e.valid && pred(e) {
+                e.valid = false;
+            }
+        }
+    }
 }
 
 /// Translation Lookaside Buffer structure.
@@ -59,6 +172,8 @@ pub struct Tlb {
     entries: Vec<TlbEntry>,
     /// Mask used for indexing (size - 1).
     mask: usize,
+    /// 2 MiB / 1 GiB entries, probed when the indexed array misses.
+    superpages: SuperpageArray,
 }
 
 impl Tlb {
@@ -68,9 +183,24 @@ impl Tlb {
     ///
     /// * `size` - Number of entries (will be rounded up to next power of 2).
     pub fn new(size: usize) -> Self {
+        Self::with_superpages(size, 0)
+    }
+
+    /// Creates a new TLB with an additional fully-associative superpage array.
+    ///
+    /// # Arguments
+    ///
+    /// * `size` - Number of 4 KiB entries (will be rounded up to next power of 2).
+    /// * `superpage_entries` - Number of 2 MiB / 1 GiB entries (0 disables them;
+    ///   superpages are then cached one 4 KiB page at a time).
+    pub fn with_superpages(size: usize, superpage_entries: usize) -> Self {
         let safe_size = if size.is_power_of_two() { size } else { size.next_power_of_two() };
 
-        Self { entries: vec![TlbEntry::default(); safe_size], mask: safe_size - 1 }
+        Self {
+            entries: vec![TlbEntry::default(); safe_size],
+            mask: safe_size - 1,
+            superpages: SuperpageArray::new(superpage_entries),
+        }
     }
 
     /// Looks up a VPN in the TLB.
@@ -83,7 +213,8 @@ impl Tlb {
     /// # Returns
     ///
     /// Returns [`TlbHit`] if the VPN is cached, otherwise `None`.
-    /// Global entries (G bit set in PTE) match regardless of ASID.
+    /// Global entries (G bit set in PTE) match regardless of ASID. On a miss
+    /// in the indexed array the superpage entries are searched.
     ///
     /// # Panics
     ///
@@ -100,16 +231,12 @@ impl Tlb {
         let entry = unsafe { self.entries.get_unchecked(idx) };
 
         if entry.valid && entry.vpn == vpn && (entry.global || entry.asid == asid) {
-            return Some(TlbHit {
-                ppn: entry.ppn,
-                r: entry.r,
-                w: entry.w,
-                x: entry.x,
-                u: entry.u,
-                d: entry.d,
-            });
+            return Some(entry.hit(vpn));
+        }
+        if self.superpages.entries.is_empty() {
+            return None;
         }
-        None
+        self.superpages.lookup(vpn, asid)
     }
 
     /// Inserts a new mapping into the TLB.
@@ -121,24 +248,31 @@ impl Tlb {
     /// * `pte` - Raw Page Table Entry (used to extract permissions).
     /// * `asid` - Address Space Identifier from SATP[59:44].
     pub fn insert(&mut self, vpn: Vpn, ppn: Ppn, pte: u64, asid: Asid) {
-        let r = (pte >> 1) & 1 != 0;
-        let w = (pte >> 2) & 1 != 0;
-        let x = (pte >> 3) & 1 != 0;
-        let u = (pte >> 4) & 1 != 0;
-        let global = (pte >> 5) & 1 != 0;
-        let d = (pte >> 7) & 1 != 0;
-
         let idx = (vpn.val() as usize) & self.mask;
 
-        self.entries[idx] = TlbEntry { vpn, ppn, valid: true, r, w, x, u, d, asid, global };
+        self.entries[idx] = TlbEntry::from_pte(vpn, ppn, pte, asid, 0);
     }
 
-    /// Invalidates a single TLB entry by VPN (used for dirty-bit re-walk).
+    /// Inserts a mapping found at page-table `level` (0 = 4 KiB, 1 = 2 MiB,
+    /// 2 = 1 GiB).
+    ///
+    /// `vpn`/`ppn` name the 4 KiB page being accessed. Superpages go to the
+    /// superpage array; without one they are cached as that single 4 KiB page.
+    pub fn insert_page(&mut self, vpn: Vpn, ppn: Ppn, pte: u64, asid: Asid, level: u8) {
+        if level == 0 || self.superpages.entries.is_empty() {
+            self.insert(vpn, ppn, pte, asid);
+        } else {
+            self.superpages.insert(TlbEntry::from_pte(vpn, ppn, pte, asid, level));
+        }
+    }
+
+    /// Invalidates the TLB entries translating `vpn` (used for dirty-bit re-walk).
     pub fn invalidate(&mut self, vpn: Vpn) {
         let idx = (vpn.val() as usize) & self.mask;
         if self.entries[idx].valid && self.entries[idx].vpn == vpn {
             self.entries[idx].valid = false;
         }
+        self.superpages.invalidate_where(|e| e.covers(vpn));
     }
 
     /// Flushes all entries from the TLB.
@@ -148,6 +282,7 @@ impl Tlb {
         for e in &mut self.entries {
             e.valid = false;
         }
+        self.superpages.invalidate_where(|_| true);
     }
 
     /// Flushes TLB entries matching a specific virtual address.
@@ -155,10 +290,7 @@ impl Tlb {
     /// Called when SFENCE.VMA has rs1!=x0 and rs2=x0.
     /// Invalidates entries whose VPN matches `vpn`, regardless of ASID.
     pub fn flush_vaddr(&mut self, vpn: Vpn) {
-        let idx = (vpn.val() as usize) & self.mask;
-        if self.entries[idx].valid && self.entries[idx].vpn == vpn {
-            self.entries[idx].valid = false;
-        }
+        self.invalidate(vpn);
     }
 
     /// Flushes TLB entries matching a specific ASID.
@@ -171,6 +303,7 @@ impl Tlb {
                 e.valid = false;
             }
         }
+        self.superpages.invalidate_where(|e| !e.global && e.asid == asid);
     }
 
     /// Flushes TLB entries matching both a virtual address and ASID.
@@ -183,6 +316,7 @@ impl Tlb {
         if e.valid && e.vpn == vpn && !e.global && e.asid == asid {
             e.valid = false;
         }
+        self.superpages.invalidate_where(|e| e.covers(vpn) && !e.global && e.asid == asid);
     }
 }
 
@@ -191,7 +325,8 @@ impl Tlb {
 // ════════════════════════════════════════════════════════════════════════
 
 /// Shared L2 TLB sitting between the per-access-type L1 TLBs and the
-/// hardware page table walker. 4-way set-associative with LRU replacement.
+/// hardware page table walker. 4-way set-associative with LRU replacement,
+/// plus an optional fully-associative superpage array.
 #[derive(Debug)]
 pub struct L2Tlb {
     /// Flat array of entries: `sets * ways` elements, laid out
@@ -204,6 +339,8 @@ pub struct L2Tlb {
     /// Per-set LRU counters. Each element is a small array of way ages
     /// (lower = more recently used). Stored flat: `[set0_way0_age, set0_way1_age, …]`.
     lru: Vec<u8>,
+    /// 2 MiB / 1 GiB entries, probed when the indexed sets miss.
+    superpages: SuperpageArray,
     /// Access latency in cycles for an L2 TLB hit.
     pub latency: u64,
 }
@@ -215,6 +352,17 @@ impl L2Tlb {
     /// * `ways` – set associativity (e.g. 4).
     /// * `latency` – cycles charged on an L2 TLB hit.
     pub fn new(total_entries: usize, ways: usize, latency: u64) -> Self {
+        Self::with_superpages(total_entries, ways, latency, 0)
+    }
+
+    /// Creates a new L2 TLB with `superpage_entries` fully-associative
+    /// 2 MiB / 1 GiB entries alongside the set-associative 4 KiB array.
+    pub fn with_superpages(
+        total_entries: usize,
+        ways: usize,
+        latency: u64,
+        superpage_entries: usize,
+    ) -> Self {
         let safe_ways = if ways == 0 { 4 } else { ways };
         let sets_raw = total_entries / safe_ways;
         let num_sets =
@@ -226,30 +374,36 @@ impl L2Tlb {
             ways: safe_ways,
             set_mask: num_sets - 1,
             lru: vec![0u8; capacity],
+            superpages: SuperpageArray::new(superpage_entries),
             latency,
         }
     }
 
     /// Looks up a VPN in the L2 TLB.
     ///
-    /// Returns `Some((ppn, pte_bits, asid))` on hit so the caller can
+    /// Returns `Some((hit, pte_bits, asid))` on hit so the caller can
     /// promote the entry into the L1 TLB. The `pte_bits` value is a
-    /// reconstructed raw PTE suitable for `Tlb::insert`.
-    pub fn lookup(&mut self, vpn: Vpn, asid: Asid) -> Option<(Ppn, u64, Asid)> {
+    /// reconstructed raw PTE suitable for [`Tlb::insert_page`] together
+    /// with `hit.level`.
+    pub fn lookup(&mut self, vpn: Vpn, asid: Asid) -> Option<(TlbHit, u64, Asid)> {
         let set = (vpn.val() as usize) & self.set_mask;
         let base = set * self.ways;
 
         for w in 0..self.ways {
             let e = &self.entries[base + w];
             if e.valid && e.vpn == vpn && (e.global || e.asid == asid) {
-                let ppn = e.ppn;
+                let hit = e.hit(vpn);
                 let entry_asid = e.asid;
                 let pte_bits = Self::reconstruct_pte(e);
                 self.touch_lru(set, w);
-                return Some((ppn, pte_bits, entry_asid));
+                return Some((hit, pte_bits, entry_asid));
             }
         }
-        None
+        self.superpages
+            .entries
+            .iter()
+            .find(|e| e.matches(vpn, asid))
+            .map(|e| (e.hit(vpn), Self::reconstruct_pte(e), e.asid))
     }
 
     /// Inserts an entry, evicting the LRU way if the set is full.
@@ -282,11 +436,21 @@ impl L2Tlb {
         self.touch_lru(set, victim);
     }
 
+    /// Inserts a mapping found at page-table `level`; see [`Tlb::insert_page`].
+    pub fn insert_page(&mut self, vpn: Vpn, ppn: Ppn, pte: u64, asid: Asid, level: u8) {
+        if level == 0 || self.superpages.entries.is_empty() {
+            self.insert(vpn, ppn, pte, asid);
+        } else {
+            self.superpages.insert(TlbEntry::from_pte(vpn, ppn, pte, asid, level));
+        }
+    }
+
     /// Flushes all entries.
     pub fn flush(&mut self) {
         for e in &mut self.entries {
             e.valid = false;
         }
+        self.superpages.invalidate_where(|_| true);
     }
 
     /// Flushes entries matching a specific virtual address.
@@ -299,6 +463,7 @@ impl L2Tlb {
                 e.valid = false;
             }
         }
+        self.superpages.invalidate_where(|e| e.covers(vpn));
     }
 
     /// Flushes non-global entries matching a specific ASID.
@@ -308,6 +473,7 @@ impl L2Tlb {
                 e.valid = false;
             }
         }
+        self.superpages.invalidate_where(|e| !e.global && e.asid == asid);
     }
 
     /// Flushes entries matching both a virtual address and ASID.
@@ -320,27 +486,17 @@ impl L2Tlb {
                 e.valid = false;
             }
         }
+        self.superpages.invalidate_where(|e| e.covers(vpn) && !e.global && e.asid == asid);
     }
 
     // ── internal helpers ──────────────────────────────────────────────
 
     fn write_entry(&mut self, idx: usize, vpn: Vpn, ppn: Ppn, pte: u64, asid: Asid) {
-        self.entries[idx] = TlbEntry {
-            vpn,
-            ppn,
-            valid: true,
-            r: (pte >> 1) & 1 != 0,
-            w: (pte >> 2) & 1 != 0,
-            x: (pte >> 3) & 1 != 0,
-            u: (pte >> 4) & 1 != 0,
-            global: (pte >> 5) & 1 != 0,
-            d: (pte >> 7) & 1 != 0,
-            asid,
-        };
+        self.entries[idx] = TlbEntry::from_pte(vpn, ppn, pte, asid, 0);
     }
 
     /// Reconstruct a raw PTE value from a `TlbEntry` so it can be
-    /// passed to `Tlb::insert` when promoting from L2 to L1.
+    /// passed to `Tlb::insert_page` when promoting from L2 to L1.
     const fn reconstruct_pte(e: &TlbEntry) -> u64 {
         let mut pte: u64 = 1; // V bit
         if e.r {
@@ -2,7 +2,7 @@
 //!
 //! This module contains implementations of various processor execution units
 //! including the ALU, FPU, branch prediction unit, load/store unit, memory
-//! management unit, cache system, and prefetchers.
+//! management unit, cache system, prefetchers, and vector unit.
 
 /// Arithmetic Logic Unit for integer operations.
 pub mod alu;
@@ -27,3 +27,6 @@ pub mod mmu;
 
 /// Hardware prefetcher implementations (stride, stream, tagged).
 pub mod prefetch;
+
+/// Vector processing unit: register file, arithmetic, and timing (RVV 1.0).
+pub mod vpu;
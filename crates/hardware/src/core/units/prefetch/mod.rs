@@ -1,7 +1,8 @@
 //! Hardware Prefetcher implementations.
 //!
 //! This module contains the interface and implementations for various
-//! hardware prefetchers used to hide memory latency.
+//! hardware prefetchers used to hide memory latency. [`PrefetchEngine`]
+//! wraps them in an enum so caches dispatch to them statically.
 
 /// Next-line prefetcher (prefetches sequential cache lines).
 pub mod next_line;
@@ -20,25 +21,78 @@ pub use self::stream::StreamPrefetcher;
 pub use self::stride::StridePrefetcher;
 pub use self::tagged::TaggedPrefetcher;
 
+use crate::config::{CacheConfig, Prefetcher as PrefetcherType};
+
 /// Trait for cache prefetcher implementations.
 ///
 /// Prefetchers observe memory access patterns and generate prefetch
 /// requests to reduce cache miss penalties.
 pub trait Prefetcher: Send + Sync {
-    /// Observes a memory access and generates prefetch addresses.
+    /// Observes a memory access and appends prefetch addresses to `out`.
     ///
     /// Called by the cache on each access to allow the prefetcher to
-    /// learn access patterns and generate prefetch requests.
+    /// learn access patterns and generate prefetch requests. `out` is a
+    /// caller-owned buffer reused across accesses, so the hot path does not
+    /// allocate; implementations must only append to it.
     ///
     /// # Arguments
     ///
     /// * `addr` - The address that was accessed
     /// * `hit` - Whether the access was a cache hit
+    /// * `out` - Buffer the prefetch addresses are appended to
+    fn observe_into(&mut self, addr: u64, hit: bool, out: &mut Vec<u64>);
+
+    /// Observes a memory access and returns the prefetch addresses.
     ///
-    /// # Returns
+    /// Allocating convenience wrapper around [`Self::observe_into`].
+    fn observe(&mut self, addr: u64, hit: bool) -> Vec<u64> {
+        let mut out = Vec::new();
+        self.observe_into(addr, hit, &mut out);
+        out
+    }
+}
+
+/// Statically dispatched prefetcher selected from the configuration.
+#[derive(Debug)]
+pub enum PrefetchEngine {
+    /// Next-line prefetcher.
+    NextLine(NextLinePrefetcher),
+    /// Stride prefetcher.
+    Stride(StridePrefetcher),
+    /// Stream prefetcher.
+    Stream(StreamPrefetcher),
+    /// Tagged prefetcher.
+    Tagged(TaggedPrefetcher),
+}
+
+impl PrefetchEngine {
+    /// Creates the prefetcher described by `config`, or `None` if disabled.
     ///
-    /// A vector of addresses to prefetch. Empty if no prefetches are needed.
-    fn observe(&mut self, addr: u64, hit: bool) -> Vec<u64>;
+    /// `line_bytes` is the (sanitized) line size of the owning cache.
+    pub fn from_config(config: &CacheConfig, line_bytes: usize) -> Option<Self> {
+        let degree = config.prefetch_degree;
+        Some(match config.prefetcher {
+            PrefetcherType::NextLine => Self::NextLine(NextLinePrefetcher::new(line_bytes, degree)),
+            PrefetcherType::Stride => {
+                Self::Stride(StridePrefetcher::new(line_bytes, config.prefetch_table_size, degree))
+            }
+            PrefetcherType::Stream => Self::Stream(StreamPrefetcher::new(line_bytes, degree)),
+            PrefetcherType::Tagged => Self::Tagged(TaggedPrefetcher::new(line_bytes, degree)),
+            PrefetcherType::None => return None,
+        })
+    }
+}
+
+impl Prefetcher for PrefetchEngine {
+    #[inline]
+    fn observe_into(&mut self, addr: u64, hit: bool, out: &mut Vec<u64>) {
+        match self {
+            Self::NextLine(p) => p.observe_into(addr, hit, out),
+            Self::Stride(p) => p.observe_into(addr, hit, out),
+            Self::Stream(p) => p.observe_into(addr, hit, out),
+            Self::Tagged(p) => p.observe_into(addr, hit, out),
+        }
+    }
 }
 
 /// Shared prefetch filter to deduplicate prefetch requests across cache levels.
@@ -120,25 +174,24 @@ impl PrefetchFilter {
         }
     }
 
-    /// Filters a list of prefetch addresses, removing any that are already
-    /// in the filter or in the given cache. Inserts surviving addresses into
-    /// the filter.
+    /// Filters a list of prefetch addresses in place, removing any that are
+    /// already in the filter. Inserts surviving addresses into the filter.
     ///
-    /// Returns the filtered list of addresses that should actually be prefetched.
-    pub fn filter_and_record(&mut self, addrs: Vec<u64>, dedup_count: &mut u64) -> Vec<u64> {
+    /// On return `addrs` holds only the addresses that should actually be
+    /// prefetched, in their original order.
+    pub fn filter_and_record(&mut self, addrs: &mut Vec<u64>, dedup_count: &mut u64) {
         if self.table.is_empty() {
-            return addrs;
+            return;
         }
-        let mut result = Vec::with_capacity(addrs.len());
-        for addr in addrs {
+        addrs.retain(|&addr| {
             if self.contains(addr) {
                 *dedup_count += 1;
+                false
             } else {
                 self.insert(addr);
-                result.push(addr);
+                true
             }
-        }
-        result
+        });
     }
 }
 
@@ -177,8 +230,9 @@ mod filter_tests {
         let mut filter = PrefetchFilter::new(64, 64);
         filter.insert(0x1000); // Already known
         let mut dedup = 0;
-        let result = filter.filter_and_record(vec![0x1000, 0x1040, 0x1080], &mut dedup);
-        assert_eq!(result.len(), 2); // 0x1040 and 0x1080
+        let mut addrs = vec![0x1000, 0x1040, 0x1080];
+        filter.filter_and_record(&mut addrs, &mut dedup);
+        assert_eq!(addrs, [0x1040, 0x1080]);
         assert_eq!(dedup, 1); // 0x1000 was deduped
         assert!(filter.contains(0x1040));
         assert!(filter.contains(0x1080));
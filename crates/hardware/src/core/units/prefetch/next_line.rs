@@ -37,18 +37,12 @@ impl Prefetcher for NextLinePrefetcher {
     ///
     /// * `addr` - The memory address being accessed.
     /// * `_hit` - Whether the access was a cache hit (ignored by this prefetcher).
-    ///
-    /// # Returns
-    ///
-    /// A vector of addresses to prefetch.
-    fn observe(&mut self, addr: u64, _hit: bool) -> Vec<u64> {
-        let mut prefetches = Vec::new();
-
+    /// * `out` - Buffer the prefetch addresses are appended to.
+    fn observe_into(&mut self, addr: u64, _hit: bool, out: &mut Vec<u64>) {
         for k in 1..=self.degree {
             let offset = self.line_bytes * k as u64;
             let target = (addr & !(self.line_bytes - 1)) + offset;
-            prefetches.push(target);
+            out.push(target);
         }
-        prefetches
     }
 }
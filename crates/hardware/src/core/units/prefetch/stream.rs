@@ -65,12 +65,8 @@ impl Prefetcher for StreamPrefetcher {
     ///
     /// * `addr` - The memory address being accessed.
     /// * `_hit` - Whether the access was a cache hit (ignored).
-    ///
-    /// # Returns
-    ///
-    /// A vector of addresses to prefetch.
-    fn observe(&mut self, addr: u64, _hit: bool) -> Vec<u64> {
-        let mut prefetches = Vec::new();
+    /// * `out` - Buffer the prefetch addresses are appended to.
+    fn observe_into(&mut self, addr: u64, _hit: bool, out: &mut Vec<u64>) {
         let diff = (addr as i64) - (self.last_addr as i64);
         let line_sz = self.line_bytes as i64;
 
@@ -106,11 +102,10 @@ impl Prefetcher for StreamPrefetcher {
                 };
 
                 let target = (addr & !(self.line_bytes - 1)).wrapping_add(offset);
-                prefetches.push(target);
+                out.push(target);
             }
         }
 
         self.last_addr = addr;
-        prefetches
     }
 }
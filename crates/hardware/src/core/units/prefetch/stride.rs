@@ -75,16 +75,12 @@ impl Prefetcher for StridePrefetcher {
     ///
     /// * `addr` - The memory address being accessed.
     /// * `_hit` - Whether the access was a cache hit (ignored).
-    ///
-    /// # Returns
-    ///
-    /// A vector of addresses to prefetch.
-    fn observe(&mut self, addr: u64, _hit: bool) -> Vec<u64> {
+    /// * `out` - Buffer the prefetch addresses are appended to.
+    fn observe_into(&mut self, addr: u64, _hit: bool, out: &mut Vec<u64>) {
         let idx = ((addr >> 6) as usize) & self.table_mask;
         let entry = &mut self.table[idx];
 
         let current_stride = (addr as i64) - (entry.last_addr as i64);
-        let mut prefetches = Vec::new();
 
         if current_stride == entry.stride {
             if entry.confidence < 3 {
@@ -95,7 +91,7 @@ impl Prefetcher for StridePrefetcher {
                     let target = (addr as i64 + lookahead) as u64;
 
                     let aligned = target & !(self.line_bytes - 1);
-                    prefetches.push(aligned);
+                    out.push(aligned);
                 }
             }
         } else if entry.confidence > 0 {
@@ -105,6 +101,5 @@ impl Prefetcher for StridePrefetcher {
         }
 
         entry.last_addr = addr;
-        prefetches
     }
 }
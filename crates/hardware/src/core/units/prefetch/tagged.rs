@@ -65,12 +65,8 @@ impl Prefetcher for TaggedPrefetcher {
     ///
     /// * `addr` - The memory address being accessed.
     /// * `hit` - Whether the access was a cache hit.
-    ///
-    /// # Returns
-    ///
-    /// A vector of addresses to prefetch.
-    fn observe(&mut self, addr: u64, hit: bool) -> Vec<u64> {
-        let mut prefetches = Vec::new();
+    /// * `out` - Buffer the prefetch addresses are appended to.
+    fn observe_into(&mut self, addr: u64, hit: bool, out: &mut Vec<u64>) {
         let aligned_addr = addr & !(self.line_bytes - 1);
 
         if !hit || self.was_prefetched(aligned_addr) {
@@ -78,11 +74,9 @@ impl Prefetcher for TaggedPrefetcher {
                 let offset = self.line_bytes * k as u64;
                 let target = aligned_addr + offset;
 
-                prefetches.push(target);
+                out.push(target);
                 self.mark_prefetched(target);
             }
         }
-
-        prefetches
     }
 }
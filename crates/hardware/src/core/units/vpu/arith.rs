@@ -0,0 +1,1376 @@
+//! Vector Arithmetic Execution.
+//!
+//! Executes `OP-V` arithmetic instructions on the register file of a
+//! [`VectorUnit`]:
+//! 1. **Body:** Each instruction processes elements `vstart..vl`. Inactive
+//!    (masked-off) and tail elements are left undisturbed, which satisfies
+//!    both the undisturbed and the agnostic policies.
+//! 2. **Overlap:** Results are gathered before any is written, so a
+//!    destination group that overlaps a source sees the original values.
+//! 3. **Legality:** Misaligned register groups, a masked destination that
+//!    overlaps `v0`, unsupported element widths, and encodings outside the
+//!    implemented subset (widening and narrowing floating-point,
+//!    `vrgatherei16`, `vfrsqrt7`/`vfrec7`) return an illegal-instruction trap.
+//!
+//! Floating-point operations use the scalar [`Fpu`], so they share its
+//! rounding (the dynamic rounding mode is not applied) and flag behavior.
+
+use super::VectorUnit;
+use super::timing::{Footprint, VecClass};
+use crate::common::Trap;
+use crate::core::pipeline::signals::AluOp;
+use crate::core::units::fpu::Fpu;
+use crate::core::units::fpu::exception_flags::FpFlags;
+use crate::isa::rvv::funct6 as f6;
+use crate::isa::rvv::opcodes::{OPFVF, OPFVV, OPIVI, OPIVV, OPIVX, OPMVV, OPMVX};
+use std::ops::Range;
+
+/// Canonical single-precision NaN, used for improperly NaN-boxed scalars.
+const CANONICAL_NAN_F32: u64 = 0x7FC0_0000;
+
+/// Upper half of a NaN-boxed single-precision value.
+const NAN_BOX: u64 = 0xFFFF_FFFF_0000_0000;
+
+/// Result of executing one vector arithmetic instruction.
+#[derive(Clone, Copy, Debug, Default)]
+pub struct VecOutcome {
+    /// Value for a scalar destination (`vmv.x.s`, `vcpop.m`, `vfirst.m`,
+    /// `vfmv.f.s`).
+    pub scalar: Option<u64>,
+    /// Accrued floating-point exception flags (`fflags` bits).
+    pub fp_flags: u8,
+    /// Execution class, selecting the latency.
+    pub class: VecClass,
+    /// Body elements processed.
+    pub elements: u64,
+    /// Widest element width touched, in bits.
+    pub width: u32,
+    /// Register groups read and written.
+    pub footprint: Footprint,
+}
+
+/// Decoded fields of an `OP-V` arithmetic instruction.
+#[derive(Clone, Copy, Debug)]
+struct Fields {
+    vd: usize,
+    /// `vs1`, `rs1`, or the 5-bit immediate.
+    rs1: usize,
+    vs2: usize,
+    funct3: u32,
+    funct6: u32,
+    /// `vm = 0`: masked by `v0`, or `v0` is an operand (carry, merge).
+    masked: bool,
+}
+
+impl Fields {
+    const fn decode(inst: u32) -> Self {
+        Self {
+            vd: ((inst >> 7) & 0x1F) as usize,
+            rs1: ((inst >> 15) & 0x1F) as usize,
+            vs2: ((inst >> 20) & 0x1F) as usize,
+            funct3: (inst >> 12) & 0x7,
+            funct6: inst >> 26,
+            masked: (inst >> 25) & 1 == 0,
+        }
+    }
+
+    /// The `rs1` field as a sign-extended 5-bit immediate.
+    const fn simm5(self) -> u64 {
+        (((self.rs1 as i64) << 59) >> 59) as u64
+    }
+}
+
+/// Second source operand: a vector group or a scalar broadcast to all
+/// elements.
+#[derive(Clone, Copy, Debug)]
+enum Operand {
+    Vector(usize),
+    Scalar(u64),
+}
+
+/// Element widths of an element-wise operation. `src2` is `None` when
+/// `vs2` is not read.
+#[derive(Clone, Copy, Debug)]
+struct Widths {
+    dst: u32,
+    src2: Option<u32>,
+    src1: u32,
+}
+
+impl Widths {
+    const fn same(sew: u32) -> Self {
+        Self { dst: sew, src2: Some(sew), src1: sew }
+    }
+}
+
+/// All-ones mask of `bits` bits.
+const fn ones(bits: u32) -> u64 {
+    if bits >= 64 { u64::MAX } else { (1 << bits) - 1 }
+}
+
+/// Sign-extends the low `bits` bits of `x`.
+const fn sext(x: u64, bits: u32) -> i64 {
+    let shift = 64 - bits;
+    ((x << shift) as i64) >> shift
+}
+
+/// Fixed-point rounding increment for shifting `v` right by `d` bits under
+/// rounding mode `vxrm` (RVV §3.8).
+const fn round_increment(v: u128, d: u32, vxrm: u8) -> u128 {
+    if d == 0 {
+        return 0;
+    }
+    let bit_d = (v >> d) & 1;
+    let bit_d1 = (v >> (d - 1)) & 1;
+    let below_d1 = v & ((1 << (d - 1)) - 1);
+    let below_d = v & ((1 << d) - 1);
+    match vxrm & 0x3 {
+        // rnu: round to nearest, ties up
+        0 => bit_d1,
+        // rne: round to nearest, ties to even
+        1 => bit_d1 & (below_d1 != 0 || bit_d != 0) as u128,
+        // rdn: truncate
+        2 => 0,
+        // rod: jam the lost bits into the LSB
+        _ => (bit_d == 0 && below_d != 0) as u128,
+    }
+}
+
+/// Unsigned rounding right shift.
+const fn roundoff_u(v: u128, d: u32, vxrm: u8) -> u128 {
+    (v >> d) + round_increment(v, d, vxrm)
+}
+
+/// Signed rounding right shift.
+const fn roundoff_s(v: i128, d: u32, vxrm: u8) -> i128 {
+    (v >> d) + round_increment(v as u128, d, vxrm) as i128
+}
+
+/// Clamps `v` to the signed `bits`-bit range, setting `sat` on overflow.
+const fn clip_signed(v: i128, bits: u32, sat: &mut bool) -> u64 {
+    let max = (1i128 << (bits - 1)) - 1;
+    let min = -(1i128 << (bits - 1));
+    if v > max {
+        *sat = true;
+        max as u64
+    } else if v < min {
+        *sat = true;
+        min as u64
+    } else {
+        v as u64
+    }
+}
+
+/// Clamps `v` to the unsigned `bits`-bit range, setting `sat` on overflow.
+const fn clip_unsigned(v: u128, bits: u32, sat: &mut bool) -> u64 {
+    let max = ones(bits) as u128;
+    if v > max {
+        *sat = true;
+        max as u64
+    } else {
+        v as u64
+    }
+}
+
+/// Integer division with RISC-V semantics for division by zero and overflow.
+const fn divide(a: u64, b: u64, sew: u32, signed: bool, rem: bool) -> u64 {
+    if signed {
+        let (x, y) = (sext(a, sew), sext(b, sew));
+        if y == 0 {
+            return if rem { a } else { u64::MAX };
+        }
+        if x == sext(1 << (sew - 1), sew) && y == -1 {
+            return if rem { 0 } else { a };
+        }
+        (if rem { x % y } else { x / y }) as u64
+    } else if b == 0 {
+        if rem { a } else { u64::MAX }
+    } else if rem {
+        a % b
+    } else {
+        a / b
+    }
+}
+
+/// Converts an integer element to floating point, rounding to nearest-even.
+///
+/// Returns the result bits and the inexact flag if rounding occurred.
+fn int_to_float(x: u64, signed: bool, is32: bool) -> (u64, u8) {
+    let bits = if is32 { 32 } else { 64 };
+    let exact = if signed { i128::from(sext(x, bits)) } else { i128::from(x & ones(bits)) };
+    let (result, back) = if is32 {
+        let f = exact as f32;
+        (u64::from(f.to_bits()), f as i128)
+    } else {
+        let f = exact as f64;
+        (f.to_bits(), f as i128)
+    };
+    (result, if back == exact { 0 } else { FpFlags::NX.bits() })
+}
+
+/// Unboxes a scalar `f` register operand for a `SEW`-bit element.
+const fn fp_scalar(raw: u64, is32: bool) -> u64 {
+    if !is32 {
+        raw
+    } else if raw & NAN_BOX == NAN_BOX {
+        raw & 0xFFFF_FFFF
+    } else {
+        CANONICAL_NAN_F32
+    }
+}
+
+impl VectorUnit {
+    /// Executes an `OP-V` arithmetic instruction.
+    ///
+    /// `scalar` is the value of the scalar `rs1` register for `.vx` (integer
+    /// register) and `.vf` (floating-point register) forms. On success
+    /// `vstart` is reset to zero.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`Trap::IllegalInstruction`] if `vtype.vill` is set or the
+    /// encoding is reserved or unsupported.
+    pub fn execute_arith(&mut self, inst: u32, scalar: u64) -> Result<VecOutcome, Trap> {
+        let f = Fields::decode(inst);
+        let result = if f.funct3 == OPIVI && f.funct6 == f6::VSMUL_VMVNR {
+            // Whole-register moves do not depend on vtype.
+            self.move_whole(&f)
+        } else if self.vtype.vill {
+            None
+        } else {
+            match f.funct3 {
+                OPIVV | OPIVX | OPIVI => self.exec_int(&f, scalar),
+                OPMVV | OPMVX => self.exec_mask_mul(&f, scalar),
+                OPFVV | OPFVF => self.exec_fp(&f, scalar),
+                _ => None,
+            }
+        };
+        let outcome = result.ok_or(Trap::IllegalInstruction(inst))?;
+        self.vstart = 0;
+        Ok(outcome)
+    }
+
+    /// Integer (`OPIVV`, `OPIVX`, `OPIVI`) instructions.
+    fn exec_int(&mut self, f: &Fields, scalar: u64) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let max = ones(sew);
+        let shamt = u64::from(sew - 1);
+        let imm = match f.funct6 {
+            f6::VSLL
+            | f6::VSRL
+            | f6::VSRA
+            | f6::VSSRL
+            | f6::VSSRA
+            | f6::VNSRL
+            | f6::VNSRA
+            | f6::VNCLIPU
+            | f6::VNCLIP
+            | f6::VRGATHER
+            | f6::VSLIDEUP
+            | f6::VSLIDEDOWN => f.rs1 as u64,
+            _ => f.simm5(),
+        };
+        let op1 = match f.funct3 {
+            OPIVV => Operand::Vector(f.rs1),
+            OPIVX => Operand::Scalar(scalar),
+            _ => Operand::Scalar(imm),
+        };
+        let same = Widths::same(sew);
+        let narrow = Widths { dst: sew, src2: Some(2 * sew), src1: sew };
+        let s = move |x: u64| sext(x, sew);
+        let vxrm = self.vxrm;
+        let mut sat = false;
+
+        let out = match f.funct6 {
+            f6::VADD => self.map(f, op1, same, true, false, |a, b, _, _| a.wrapping_add(b)),
+            f6::VSUB => self.map(f, op1, same, true, false, |a, b, _, _| a.wrapping_sub(b)),
+            f6::VRSUB => self.map(f, op1, same, true, false, |a, b, _, _| b.wrapping_sub(a)),
+            f6::VMINU => self.map(f, op1, same, true, false, |a, b, _, _| a.min(b)),
+            f6::VMIN => {
+                self.map(f, op1, same, true, false, |a, b, _, _| if s(a) < s(b) { a } else { b })
+            }
+            f6::VMAXU => self.map(f, op1, same, true, false, |a, b, _, _| a.max(b)),
+            f6::VMAX => {
+                self.map(f, op1, same, true, false, |a, b, _, _| if s(a) > s(b) { a } else { b })
+            }
+            f6::VAND => self.map(f, op1, same, true, false, |a, b, _, _| a & b),
+            f6::VOR => self.map(f, op1, same, true, false, |a, b, _, _| a | b),
+            f6::VXOR => self.map(f, op1, same, true, false, |a, b, _, _| a ^ b),
+            f6::VSLL => self.map(f, op1, same, true, false, |a, b, _, _| a << (b & shamt)),
+            f6::VSRL => self.map(f, op1, same, true, false, |a, b, _, _| a >> (b & shamt)),
+            f6::VSRA => {
+                self.map(f, op1, same, true, false, |a, b, _, _| (s(a) >> (b & shamt)) as u64)
+            }
+            f6::VSADDU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                clip_unsigned(u128::from(a) + u128::from(b), sew, &mut sat)
+            }),
+            f6::VSADD => self.map(f, op1, same, true, false, |a, b, _, _| {
+                clip_signed(i128::from(s(a)) + i128::from(s(b)), sew, &mut sat)
+            }),
+            f6::VSSUBU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                if a < b {
+                    sat = true;
+                    0
+                } else {
+                    a - b
+                }
+            }),
+            f6::VSSUB => self.map(f, op1, same, true, false, |a, b, _, _| {
+                clip_signed(i128::from(s(a)) - i128::from(s(b)), sew, &mut sat)
+            }),
+            f6::VSSRL => self.map(f, op1, same, true, false, |a, b, _, _| {
+                roundoff_u(u128::from(a), (b & shamt) as u32, vxrm) as u64
+            }),
+            f6::VSSRA => self.map(f, op1, same, true, false, |a, b, _, _| {
+                roundoff_s(i128::from(s(a)), (b & shamt) as u32, vxrm) as u64
+            }),
+            f6::VSMUL_VMVNR => self.map(f, op1, same, true, false, |a, b, _, _| {
+                let product = i128::from(s(a)) * i128::from(s(b));
+                clip_signed(roundoff_s(product, sew - 1, vxrm), sew, &mut sat)
+            }),
+            f6::VMSEQ => self.map_mask(f, op1, same, true, |a, b, _| a == b),
+            f6::VMSNE => self.map_mask(f, op1, same, true, |a, b, _| a != b),
+            f6::VMSLTU => self.map_mask(f, op1, same, true, |a, b, _| a < b),
+            f6::VMSLT => self.map_mask(f, op1, same, true, |a, b, _| s(a) < s(b)),
+            f6::VMSLEU => self.map_mask(f, op1, same, true, |a, b, _| a <= b),
+            f6::VMSLE => self.map_mask(f, op1, same, true, |a, b, _| s(a) <= s(b)),
+            f6::VMSGTU => self.map_mask(f, op1, same, true, |a, b, _| a > b),
+            f6::VMSGT => self.map_mask(f, op1, same, true, |a, b, _| s(a) > s(b)),
+            f6::VADC if f.masked => self.map(f, op1, same, false, false, |a, b, _, c| {
+                a.wrapping_add(b).wrapping_add(u64::from(c))
+            }),
+            f6::VSBC if f.masked => self.map(f, op1, same, false, false, |a, b, _, c| {
+                a.wrapping_sub(b).wrapping_sub(u64::from(c))
+            }),
+            f6::VMADC => {
+                let carry_in = f.masked;
+                self.map_mask(f, op1, same, false, |a, b, c| {
+                    u128::from(a) + u128::from(b) + u128::from(c && carry_in) > u128::from(max)
+                })
+            }
+            f6::VMSBC => {
+                let borrow_in = f.masked;
+                self.map_mask(f, op1, same, false, |a, b, c| {
+                    u128::from(a) < u128::from(b) + u128::from(c && borrow_in)
+                })
+            }
+            f6::VMERGE if f.masked => {
+                self.map(f, op1, same, false, false, |a, b, _, v0| if v0 { b } else { a })
+            }
+            f6::VMERGE if f.vs2 == 0 => {
+                let splat = Widths { src2: None, ..same };
+                self.map(f, op1, splat, false, false, |_, b, _, _| b)
+            }
+            f6::VRGATHER => self.gather(f, op1),
+            f6::VSLIDEUP if f.funct3 != OPIVV => self.slide_up(f, op1, None),
+            f6::VSLIDEDOWN if f.funct3 != OPIVV => self.slide_down(f, op1, None),
+            f6::VNSRL if sew < 64 => {
+                let mask = u64::from(2 * sew - 1);
+                self.map(f, op1, narrow, true, false, |a, b, _, _| a >> (b & mask))
+            }
+            f6::VNSRA if sew < 64 => {
+                let mask = u64::from(2 * sew - 1);
+                self.map(f, op1, narrow, true, false, |a, b, _, _| {
+                    (sext(a, 2 * sew) >> (b & mask)) as u64
+                })
+            }
+            f6::VNCLIPU if sew < 64 => {
+                let mask = u64::from(2 * sew - 1);
+                self.map(f, op1, narrow, true, false, |a, b, _, _| {
+                    clip_unsigned(roundoff_u(u128::from(a), (b & mask) as u32, vxrm), sew, &mut sat)
+                })
+            }
+            f6::VNCLIP if sew < 64 => {
+                let mask = u64::from(2 * sew - 1);
+                self.map(f, op1, narrow, true, false, |a, b, _, _| {
+                    let v = roundoff_s(i128::from(sext(a, 2 * sew)), (b & mask) as u32, vxrm);
+                    clip_signed(v, sew, &mut sat)
+                })
+            }
+            f6::VWREDSUMU if f.funct3 == OPIVV && sew < 64 => {
+                self.reduce(f, sew, 2 * sew, u64::wrapping_add)
+            }
+            f6::VWREDSUM if f.funct3 == OPIVV && sew < 64 => {
+                self.reduce(f, sew, 2 * sew, |acc, x| acc.wrapping_add(s(x) as u64))
+            }
+            _ => None,
+        };
+        if sat {
+            self.vxsat = true;
+        }
+        out
+    }
+
+    /// Mask, reduction, and multiply/divide (`OPMVV`, `OPMVX`) instructions.
+    fn exec_mask_mul(&mut self, f: &Fields, scalar: u64) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let vv = f.funct3 == OPMVV;
+        let op1 = if vv { Operand::Vector(f.rs1) } else { Operand::Scalar(scalar) };
+        let same = Widths::same(sew);
+        let wide = Widths { dst: 2 * sew, src2: Some(sew), src1: sew };
+        let wide_w = Widths { dst: 2 * sew, src2: Some(2 * sew), src1: sew };
+        let can_widen = sew < 64;
+        let s = move |x: u64| sext(x, sew);
+        let vxrm = self.vxrm;
+
+        let class = match f.funct6 {
+            f6::VDIVU..=f6::VREM => VecClass::Div,
+            f6::VMULHU..=f6::VNMSAC | f6::VWMULU..=f6::VWMACCSU => VecClass::Mul,
+            _ => VecClass::Alu,
+        };
+        let out =
+            match f.funct6 {
+                f6::VREDSUM if vv => self.reduce(f, sew, sew, u64::wrapping_add),
+                f6::VREDAND if vv => self.reduce(f, sew, sew, |acc, x| acc & x),
+                f6::VREDOR if vv => self.reduce(f, sew, sew, |acc, x| acc | x),
+                f6::VREDXOR if vv => self.reduce(f, sew, sew, |acc, x| acc ^ x),
+                f6::VREDMINU if vv => self.reduce(f, sew, sew, u64::min),
+                f6::VREDMIN if vv => {
+                    self.reduce(f, sew, sew, |acc, x| if s(x) < s(acc) { x } else { acc })
+                }
+                f6::VREDMAXU if vv => self.reduce(f, sew, sew, u64::max),
+                f6::VREDMAX if vv => {
+                    self.reduce(f, sew, sew, |acc, x| if s(x) > s(acc) { x } else { acc })
+                }
+                f6::VAADDU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    roundoff_u(u128::from(a) + u128::from(b), 1, vxrm) as u64
+                }),
+                f6::VAADD => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    roundoff_s(i128::from(s(a)) + i128::from(s(b)), 1, vxrm) as u64
+                }),
+                f6::VASUBU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    roundoff_s(i128::from(a) - i128::from(b), 1, vxrm) as u64
+                }),
+                f6::VASUB => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    roundoff_s(i128::from(s(a)) - i128::from(s(b)), 1, vxrm) as u64
+                }),
+                f6::VSLIDE1UP if !vv => self.slide_up(f, Operand::Scalar(1), Some(scalar)),
+                f6::VSLIDE1DOWN if !vv => self.slide_down(f, Operand::Scalar(1), Some(scalar)),
+                f6::VWXUNARY0 if vv => self.scalar_result(f, true),
+                f6::VWXUNARY0 if f.vs2 == 0 => self.move_to_element(f, scalar),
+                f6::VXUNARY0 if vv => self.extend(f),
+                f6::VMUNARY0 if vv => self.mask_unary(f),
+                f6::VCOMPRESS if vv => self.compress(f),
+                f6::VMANDN if vv => self.mask_logical(f, |a, b| a && !b),
+                f6::VMAND if vv => self.mask_logical(f, |a, b| a && b),
+                f6::VMOR if vv => self.mask_logical(f, |a, b| a || b),
+                f6::VMXOR if vv => self.mask_logical(f, |a, b| a ^ b),
+                f6::VMORN if vv => self.mask_logical(f, |a, b| a || !b),
+                f6::VMNAND if vv => self.mask_logical(f, |a, b| !(a && b)),
+                f6::VMNOR if vv => self.mask_logical(f, |a, b| !(a || b)),
+                f6::VMXNOR if vv => self.mask_logical(f, |a, b| !(a ^ b)),
+                f6::VDIVU => self
+                    .map(f, op1, same, true, false, |a, b, _, _| divide(a, b, sew, false, false)),
+                f6::VDIV => {
+                    self.map(f, op1, same, true, false, |a, b, _, _| divide(a, b, sew, true, false))
+                }
+                f6::VREMU => {
+                    self.map(f, op1, same, true, false, |a, b, _, _| divide(a, b, sew, false, true))
+                }
+                f6::VREM => {
+                    self.map(f, op1, same, true, false, |a, b, _, _| divide(a, b, sew, true, true))
+                }
+                f6::VMULHU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    ((u128::from(a) * u128::from(b)) >> sew) as u64
+                }),
+                f6::VMUL => self.map(f, op1, same, true, false, |a, b, _, _| a.wrapping_mul(b)),
+                f6::VMULHSU => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    ((i128::from(s(a)) * i128::from(b)) >> sew) as u64
+                }),
+                f6::VMULH => self.map(f, op1, same, true, false, |a, b, _, _| {
+                    ((i128::from(s(a)) * i128::from(s(b))) >> sew) as u64
+                }),
+                f6::VMADD => self
+                    .map(f, op1, same, true, true, |a, b, d, _| b.wrapping_mul(d).wrapping_add(a)),
+                f6::VNMSUB => self
+                    .map(f, op1, same, true, true, |a, b, d, _| a.wrapping_sub(b.wrapping_mul(d))),
+                f6::VMACC => self
+                    .map(f, op1, same, true, true, |a, b, d, _| b.wrapping_mul(a).wrapping_add(d)),
+                f6::VNMSAC => self
+                    .map(f, op1, same, true, true, |a, b, d, _| d.wrapping_sub(b.wrapping_mul(a))),
+                f6::VWADDU if can_widen => self.map(f, op1, wide, true, false, |a, b, _, _| a + b),
+                f6::VWADD if can_widen => {
+                    self.map(f, op1, wide, true, false, |a, b, _, _| (s(a) + s(b)) as u64)
+                }
+                f6::VWSUBU if can_widen => {
+                    self.map(f, op1, wide, true, false, |a, b, _, _| a.wrapping_sub(b))
+                }
+                f6::VWSUB if can_widen => {
+                    self.map(f, op1, wide, true, false, |a, b, _, _| (s(a) - s(b)) as u64)
+                }
+                f6::VWADDU_W if can_widen => {
+                    self.map(f, op1, wide_w, true, false, |a, b, _, _| a.wrapping_add(b))
+                }
+                f6::VWADD_W if can_widen => self.map(f, op1, wide_w, true, false, |a, b, _, _| {
+                    sext(a, 2 * sew).wrapping_add(s(b)) as u64
+                }),
+                f6::VWSUBU_W if can_widen => {
+                    self.map(f, op1, wide_w, true, false, |a, b, _, _| a.wrapping_sub(b))
+                }
+                f6::VWSUB_W if can_widen => self.map(f, op1, wide_w, true, false, |a, b, _, _| {
+                    sext(a, 2 * sew).wrapping_sub(s(b)) as u64
+                }),
+                f6::VWMULU if can_widen => self.map(f, op1, wide, true, false, |a, b, _, _| a * b),
+                f6::VWMULSU if can_widen => {
+                    self.map(f, op1, wide, true, false, |a, b, _, _| (s(a) * b as i64) as u64)
+                }
+                f6::VWMUL if can_widen => {
+                    self.map(f, op1, wide, true, false, |a, b, _, _| (s(a) * s(b)) as u64)
+                }
+                f6::VWMACCU if can_widen => {
+                    self.map(f, op1, wide, true, true, |a, b, d, _| d.wrapping_add(a * b))
+                }
+                f6::VWMACC if can_widen => self.map(f, op1, wide, true, true, |a, b, d, _| {
+                    d.wrapping_add((s(a) * s(b)) as u64)
+                }),
+                f6::VWMACCUS if can_widen && !vv => {
+                    self.map(f, op1, wide, true, true, |a, b, d, _| {
+                        d.wrapping_add((b as i64 * s(a)) as u64)
+                    })
+                }
+                f6::VWMACCSU if can_widen => self.map(f, op1, wide, true, true, |a, b, d, _| {
+                    d.wrapping_add((s(b) * a as i64) as u64)
+                }),
+                _ => None,
+            };
+        out.map(|o| VecOutcome { class, ..o })
+    }
+
+    /// Floating-point (`OPFVV`, `OPFVF`) instructions for SEW of 32 or 64.
+    fn exec_fp(&mut self, f: &Fields, scalar: u64) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        if sew != 32 && sew != 64 {
+            return None;
+        }
+        let is32 = sew == 32;
+        let vv = f.funct3 == OPFVV;
+        let fs1 = fp_scalar(scalar, is32);
+        let op1 = if vv { Operand::Vector(f.rs1) } else { Operand::Scalar(fs1) };
+        let same = Widths::same(sew);
+        let nan_box = move |x: u64| if is32 { x | NAN_BOX } else { x };
+        let mut flags = 0u8;
+        let mut fpu = |op: AluOp, a: u64, b: u64, c: u64| {
+            let (r, fl) = Fpu::execute_full(op, nan_box(a), nan_box(b), nan_box(c), is32);
+            flags |= fl.bits();
+            r
+        };
+
+        let class = match f.funct6 {
+            f6::VFDIV | f6::VFRDIV => VecClass::Div,
+            f6::VFUNARY1 if f.rs1 == 0 => VecClass::Div,
+            f6::VFSGNJ
+            | f6::VFSGNJN
+            | f6::VFSGNJX
+            | f6::VFSLIDE1UP
+            | f6::VFSLIDE1DOWN
+            | f6::VWFUNARY0
+            | f6::VFMERGE => VecClass::Alu,
+            _ => VecClass::Fp,
+        };
+        let out = match f.funct6 {
+            f6::VFADD => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FAdd, a, b, 0))
+            }
+            f6::VFSUB => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FSub, a, b, 0))
+            }
+            f6::VFRSUB if !vv => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FSub, b, a, 0))
+            }
+            f6::VFMIN => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FMin, a, b, 0))
+            }
+            f6::VFMAX => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FMax, a, b, 0))
+            }
+            f6::VFSGNJ => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FSgnJ, a, b, 0))
+            }
+            f6::VFSGNJN => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FSgnJN, a, b, 0))
+            }
+            f6::VFSGNJX => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FSgnJX, a, b, 0))
+            }
+            f6::VFDIV => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FDiv, a, b, 0))
+            }
+            f6::VFRDIV if !vv => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FDiv, b, a, 0))
+            }
+            f6::VFMUL => {
+                self.map(f, op1, same, true, false, |a, b, _, _| fpu(AluOp::FMul, a, b, 0))
+            }
+            f6::VFMACC => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FMAdd, b, a, d))
+            }
+            f6::VFNMACC => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FNMAdd, b, a, d))
+            }
+            f6::VFMSAC => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FMSub, b, a, d))
+            }
+            f6::VFNMSAC => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FNMSub, b, a, d))
+            }
+            f6::VFMADD => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FMAdd, b, d, a))
+            }
+            f6::VFNMADD => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FNMAdd, b, d, a))
+            }
+            f6::VFMSUB => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FMSub, b, d, a))
+            }
+            f6::VFNMSUB => {
+                self.map(f, op1, same, true, true, |a, b, d, _| fpu(AluOp::FNMSub, b, d, a))
+            }
+            f6::VMFEQ => self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FEq, a, b, 0) != 0),
+            f6::VMFLE => self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FLe, a, b, 0) != 0),
+            f6::VMFLT => self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FLt, a, b, 0) != 0),
+            f6::VMFNE => self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FEq, a, b, 0) == 0),
+            f6::VMFGT if !vv => {
+                self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FLt, b, a, 0) != 0)
+            }
+            f6::VMFGE if !vv => {
+                self.map_mask(f, op1, same, true, |a, b, _| fpu(AluOp::FLe, b, a, 0) != 0)
+            }
+            f6::VFMERGE if !vv && f.masked => {
+                self.map(f, op1, same, false, false, |a, b, _, v0| if v0 { b } else { a })
+            }
+            f6::VFMERGE if !vv && f.vs2 == 0 => {
+                let splat = Widths { src2: None, ..same };
+                self.map(f, op1, splat, false, false, |_, b, _, _| b)
+            }
+            f6::VWFUNARY0 if vv && f.rs1 == 0 => self.scalar_result(f, false),
+            f6::VWFUNARY0 if !vv && f.vs2 == 0 => self.move_to_element(f, fs1),
+            f6::VFUNARY0 if vv => {
+                let to_int = match f.rs1 {
+                    0b00000 | 0b00110 => Some(if is32 { AluOp::FCvtWUS } else { AluOp::FCvtLUS }),
+                    0b00001 | 0b00111 => Some(if is32 { AluOp::FCvtWS } else { AluOp::FCvtLS }),
+                    _ => None,
+                };
+                match (to_int, f.rs1) {
+                    (Some(op), _) => {
+                        self.map(f, op1, same, true, false, |a, _, _, _| fpu(op, a, 0, 0))
+                    }
+                    (None, 0b00010 | 0b00011) => {
+                        let signed = f.rs1 == 0b00011;
+                        self.map(f, op1, same, true, false, |a, _, _, _| {
+                            let (r, fl) = int_to_float(a, signed, is32);
+                            flags |= fl;
+                            r
+                        })
+                    }
+                    _ => None,
+                }
+            }
+            f6::VFUNARY1 if vv && f.rs1 == 0 => {
+                self.map(f, op1, same, true, false, |a, _, _, _| fpu(AluOp::FSqrt, a, 0, 0))
+            }
+            f6::VFUNARY1 if vv && f.rs1 == 0b10000 => {
+                self.map(f, op1, same, true, false, |a, _, _, _| fpu(AluOp::FClass, a, 0, 0))
+            }
+            f6::VFREDUSUM | f6::VFREDOSUM if vv => {
+                self.reduce(f, sew, sew, |acc, x| fpu(AluOp::FAdd, acc, x, 0))
+            }
+            f6::VFREDMIN if vv => self.reduce(f, sew, sew, |acc, x| fpu(AluOp::FMin, acc, x, 0)),
+            f6::VFREDMAX if vv => self.reduce(f, sew, sew, |acc, x| fpu(AluOp::FMax, acc, x, 0)),
+            f6::VFSLIDE1UP if !vv => self.slide_up(f, Operand::Scalar(1), Some(fs1)),
+            f6::VFSLIDE1DOWN if !vv => self.slide_down(f, Operand::Scalar(1), Some(fs1)),
+            _ => None,
+        };
+        out.map(|o| VecOutcome { class, fp_flags: flags, ..o })
+    }
+
+    /// Body elements of the current instruction.
+    const fn body(&self) -> Range<usize> {
+        self.vstart as usize..self.vl as usize
+    }
+
+    /// Outcome of an operation over the body elements.
+    const fn outcome(&self, width: u32, footprint: Footprint) -> VecOutcome {
+        VecOutcome {
+            scalar: None,
+            fp_flags: 0,
+            class: VecClass::Alu,
+            elements: self.vl.saturating_sub(self.vstart),
+            width,
+            footprint,
+        }
+    }
+
+    /// Element `idx` of the second source operand.
+    fn operand(&self, op1: Operand, idx: usize, eew: u32) -> u64 {
+        match op1 {
+            Operand::Vector(reg) => self.read_elem(reg, idx, eew),
+            Operand::Scalar(x) => x & ones(eew),
+        }
+    }
+
+    /// Checks register group alignment of the sources and records them.
+    fn sources(&self, f: &Fields, op1: Operand, w: Widths) -> Option<Footprint> {
+        let mut fp = Footprint::default();
+        if let Some(eew) = w.src2 {
+            let regs = self.vtype.group_regs(eew)?;
+            if !f.vs2.is_multiple_of(regs) {
+                return None;
+            }
+            fp.read(f.vs2, regs);
+        }
+        if let Operand::Vector(reg) = op1 {
+            let regs = self.vtype.group_regs(w.src1)?;
+            if !reg.is_multiple_of(regs) {
+                return None;
+            }
+            fp.read(reg, regs);
+        }
+        if f.masked {
+            fp.read(0, 1);
+        }
+        Some(fp)
+    }
+
+    /// Checks and records a vector destination group of `regs` registers.
+    ///
+    /// The old destination value is a source when the operation accumulates
+    /// into it or leaves some of its elements undisturbed.
+    const fn dest(
+        &self,
+        fp: &mut Footprint,
+        f: &Fields,
+        regs: usize,
+        skip_inactive: bool,
+        reads_vd: bool,
+    ) -> Option<()> {
+        if !f.vd.is_multiple_of(regs) || (f.masked && f.vd == 0) {
+            return None;
+        }
+        let partial = (skip_inactive && f.masked && !self.vtype.vma)
+            || (!self.vtype.vta && self.vl < self.vlmax());
+        if reads_vd || partial {
+            fp.read(f.vd, regs);
+        }
+        fp.write(f.vd, regs);
+        Some(())
+    }
+
+    /// Element-wise operation with a vector destination.
+    ///
+    /// `kernel(vs2, op1, vd, v0)` receives the `vs2` element, the second
+    /// operand, the old destination element (if `reads_vd`), and mask bit
+    /// `v0[i]`. With `skip_inactive`, masked-off elements are not computed;
+    /// otherwise `v0` is an operand and every body element is written.
+    fn map(
+        &mut self,
+        f: &Fields,
+        op1: Operand,
+        w: Widths,
+        skip_inactive: bool,
+        reads_vd: bool,
+        mut kernel: impl FnMut(u64, u64, u64, bool) -> u64,
+    ) -> Option<VecOutcome> {
+        let regs = self.vtype.group_regs(w.dst)?;
+        let mut fp = self.sources(f, op1, w)?;
+        self.dest(&mut fp, f, regs, skip_inactive, reads_vd)?;
+        let mut out = Vec::with_capacity(self.body().len());
+        for i in self.body() {
+            if skip_inactive && !self.active(f.masked, i) {
+                continue;
+            }
+            let a = w.src2.map_or(0, |eew| self.read_elem(f.vs2, i, eew));
+            let b = self.operand(op1, i, w.src1);
+            let d = if reads_vd { self.read_elem(f.vd, i, w.dst) } else { 0 };
+            out.push((i, kernel(a, b, d, self.mask_bit(0, i))));
+        }
+        for (i, val) in out {
+            self.write_elem(f.vd, i, w.dst, val);
+        }
+        Some(self.outcome(w.dst.max(w.src2.unwrap_or(0)), fp))
+    }
+
+    /// Element-wise operation producing a mask (`kernel(vs2, op1, v0)`).
+    ///
+    /// Mask destinations are always tail-agnostic, so only masked-off
+    /// elements under the undisturbed policy make the old value a source.
+    fn map_mask(
+        &mut self,
+        f: &Fields,
+        op1: Operand,
+        w: Widths,
+        skip_inactive: bool,
+        mut kernel: impl FnMut(u64, u64, bool) -> bool,
+    ) -> Option<VecOutcome> {
+        let mut fp = self.sources(f, op1, w)?;
+        if skip_inactive && f.masked && !self.vtype.vma {
+            fp.read(f.vd, 1);
+        }
+        fp.write(f.vd, 1);
+        let mut out = Vec::with_capacity(self.body().len());
+        for i in self.body() {
+            if skip_inactive && !self.active(f.masked, i) {
+                continue;
+            }
+            let a = w.src2.map_or(0, |eew| self.read_elem(f.vs2, i, eew));
+            let b = self.operand(op1, i, w.src1);
+            out.push((i, kernel(a, b, self.mask_bit(0, i))));
+        }
+        for (i, bit) in out {
+            self.set_mask_bit(f.vd, i, bit);
+        }
+        Some(self.outcome(w.src1.max(w.src2.unwrap_or(0)), fp))
+    }
+
+    /// Reduction: `vd[0] = kernel(...kernel(vs1[0], vs2[i])...)` over the
+    /// active elements, with the accumulator `acc_eew` bits wide. Requires
+    /// `vstart = 0`; `vd` is not written when `vl = 0`.
+    fn reduce(
+        &mut self,
+        f: &Fields,
+        src_eew: u32,
+        acc_eew: u32,
+        mut kernel: impl FnMut(u64, u64) -> u64,
+    ) -> Option<VecOutcome> {
+        let regs = self.vtype.group_regs(src_eew)?;
+        if self.vstart != 0 || !f.vs2.is_multiple_of(regs) {
+            return None;
+        }
+        let mut fp = Footprint::default();
+        fp.read(f.vs2, regs);
+        fp.read(f.rs1, 1);
+        if f.masked {
+            fp.read(0, 1);
+        }
+        fp.write(f.vd, 1);
+        if self.vl > 0 {
+            let mut acc = self.read_elem(f.rs1, 0, acc_eew);
+            for i in self.body() {
+                if self.active(f.masked, i) {
+                    acc = kernel(acc, self.read_elem(f.vs2, i, src_eew));
+                }
+            }
+            self.write_elem(f.vd, 0, acc_eew, acc);
+        }
+        Some(self.outcome(acc_eew, fp))
+    }
+
+    /// `vrgather.vv`/`.vx`/`.vi`: `vd[i] = vs2[op1[i]]`, or zero if the index
+    /// is at least `VLMAX`.
+    fn gather(&mut self, f: &Fields, op1: Operand) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let vlmax = self.vlmax();
+        let regs = self.vtype.group_regs(sew)?;
+        let mut fp = self.sources(f, op1, Widths::same(sew))?;
+        self.dest(&mut fp, f, regs, true, false)?;
+        let mut out = Vec::with_capacity(self.body().len());
+        for i in self.body() {
+            if !self.active(f.masked, i) {
+                continue;
+            }
+            let idx = self.operand(op1, i, sew);
+            let val = if idx < vlmax { self.read_elem(f.vs2, idx as usize, sew) } else { 0 };
+            out.push((i, val));
+        }
+        for (i, val) in out {
+            self.write_elem(f.vd, i, sew, val);
+        }
+        Some(self.outcome(sew, fp))
+    }
+
+    /// `vslideup` (`fill = None`) and `vslide1up`/`vfslide1up` (`offset = 1`,
+    /// `fill` written to element 0).
+    fn slide_up(&mut self, f: &Fields, offset: Operand, fill: Option<u64>) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let regs = self.vtype.group_regs(sew)?;
+        let offset = self.operand(offset, 0, 64);
+        let mut fp = self.sources(f, Operand::Scalar(0), Widths::same(sew))?;
+        self.dest(&mut fp, f, regs, true, fill.is_none())?;
+        let mut out = Vec::with_capacity(self.body().len());
+        for i in self.body() {
+            if !self.active(f.masked, i) {
+                continue;
+            }
+            if (i as u64) >= offset {
+                out.push((i, self.read_elem(f.vs2, i - offset as usize, sew)));
+            } else if let Some(x) = fill {
+                out.push((i, x));
+            }
+        }
+        for (i, val) in out {
+            self.write_elem(f.vd, i, sew, val);
+        }
+        Some(self.outcome(sew, fp))
+    }
+
+    /// `vslidedown` (`fill = None`) and `vslide1down`/`vfslide1down`
+    /// (`offset = 1`, `fill` written to element `vl - 1`).
+    fn slide_down(&mut self, f: &Fields, offset: Operand, fill: Option<u64>) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let vlmax = self.vlmax();
+        let regs = self.vtype.group_regs(sew)?;
+        let offset = self.operand(offset, 0, 64);
+        let mut fp = self.sources(f, Operand::Scalar(0), Widths::same(sew))?;
+        self.dest(&mut fp, f, regs, true, false)?;
+        let last = self.vl.saturating_sub(1) as usize;
+        let mut out = Vec::with_capacity(self.body().len());
+        for i in self.body() {
+            if !self.active(f.masked, i) {
+                continue;
+            }
+            let val = match fill {
+                Some(x) if i == last => x,
+                _ => match (i as u64).checked_add(offset) {
+                    Some(idx) if idx < vlmax => self.read_elem(f.vs2, idx as usize, sew),
+                    _ => 0,
+                },
+            };
+            out.push((i, val));
+        }
+        for (i, val) in out {
+            self.write_elem(f.vd, i, sew, val);
+        }
+        Some(self.outcome(sew, fp))
+    }
+
+    /// `vmv<nr>r.v`: copies `nr` whole registers regardless of `vtype`.
+    fn move_whole(&mut self, f: &Fields) -> Option<VecOutcome> {
+        let nr = f.rs1 + 1;
+        if f.masked
+            || !matches!(nr, 1 | 2 | 4 | 8)
+            || !f.vd.is_multiple_of(nr)
+            || !f.vs2.is_multiple_of(nr)
+        {
+            return None;
+        }
+        let vlenb = self.vlenb();
+        let src = f.vs2 * vlenb;
+        self.regs.copy_within(src..src + nr * vlenb, f.vd * vlenb);
+        let mut fp = Footprint::default();
+        fp.read(f.vs2, nr);
+        fp.write(f.vd, nr);
+        Some(VecOutcome { elements: (nr * vlenb / 8) as u64, ..self.outcome(64, fp) })
+    }
+
+    /// Instructions with a scalar result: `vmv.x.s`, `vcpop.m`, and
+    /// `vfirst.m` (`int = true`), or `vfmv.f.s`.
+    fn scalar_result(&self, f: &Fields, int: bool) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let mut fp = Footprint::default();
+        fp.read(f.vs2, 1);
+        let value = match (int, f.rs1) {
+            (true, 0b00000) => sext(self.read_elem(f.vs2, 0, sew), sew) as u64,
+            (false, 0b00000) if sew == 32 => self.read_elem(f.vs2, 0, 32) | NAN_BOX,
+            (false, 0b00000) => self.read_elem(f.vs2, 0, sew),
+            (true, 0b10000 | 0b10001) if self.vstart == 0 => {
+                if f.masked {
+                    fp.read(0, 1);
+                }
+                let mut set =
+                    self.body().filter(|&i| self.active(f.masked, i) && self.mask_bit(f.vs2, i));
+                if f.rs1 == 0b10000 {
+                    set.count() as u64
+                } else {
+                    set.next().map_or(u64::MAX, |i| i as u64)
+                }
+            }
+            _ => return None,
+        };
+        Some(VecOutcome { scalar: Some(value), ..self.outcome(sew, fp) })
+    }
+
+    /// `vmv.s.x`/`vfmv.s.f`: writes element 0 if `vstart < vl`.
+    fn move_to_element(&mut self, f: &Fields, scalar: u64) -> Option<VecOutcome> {
+        if f.masked {
+            return None;
+        }
+        let sew = self.vtype.sew;
+        let mut fp = Footprint::default();
+        if !self.vtype.vta {
+            fp.read(f.vd, 1);
+        }
+        fp.write(f.vd, 1);
+        if self.vstart < self.vl {
+            self.write_elem(f.vd, 0, sew, scalar);
+        }
+        Some(VecOutcome { elements: 1, ..self.outcome(sew, fp) })
+    }
+
+    /// `vzext.vf{2,4,8}` and `vsext.vf{2,4,8}`.
+    fn extend(&mut self, f: &Fields) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let (factor, signed) = match f.rs1 {
+            0b00010 => (8, false),
+            0b00011 => (8, true),
+            0b00100 => (4, false),
+            0b00101 => (4, true),
+            0b00110 => (2, false),
+            0b00111 => (2, true),
+            _ => return None,
+        };
+        let src = sew / factor;
+        if src < 8 {
+            return None;
+        }
+        let w = Widths { dst: sew, src2: Some(src), src1: sew };
+        self.map(f, Operand::Scalar(0), w, true, false, |a, _, _, _| {
+            if signed { sext(a, src) as u64 } else { a }
+        })
+    }
+
+    /// `vmsbf.m`, `vmsif.m`, `vmsof.m`, `viota.m`, and `vid.v`.
+    fn mask_unary(&mut self, f: &Fields) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        if self.vstart != 0 {
+            return None;
+        }
+        match f.rs1 {
+            0b00001..=0b00011 => {
+                if f.vd == f.vs2 || (f.masked && f.vd == 0) {
+                    return None;
+                }
+                let w = Widths { dst: 1, src2: None, src1: sew };
+                let mut fp = self.sources(f, Operand::Scalar(0), w)?;
+                fp.read(f.vs2, 1);
+                fp.write(f.vd, 1);
+                let mut found = false;
+                for i in self.body() {
+                    if !self.active(f.masked, i) {
+                        continue;
+                    }
+                    let bit = self.mask_bit(f.vs2, i);
+                    let (sbf, sif, sof) = if found {
+                        (false, false, false)
+                    } else if bit {
+                        found = true;
+                        (false, true, true)
+                    } else {
+                        (true, true, false)
+                    };
+                    let out = match f.rs1 {
+                        0b00001 => sbf,
+                        0b00010 => sof,
+                        _ => sif,
+                    };
+                    self.set_mask_bit(f.vd, i, out);
+                }
+                Some(self.outcome(sew, fp))
+            }
+            0b10000 => {
+                let regs = self.vtype.group_regs(sew)?;
+                let w = Widths { dst: sew, src2: None, src1: sew };
+                let mut fp = self.sources(f, Operand::Scalar(0), w)?;
+                fp.read(f.vs2, 1);
+                self.dest(&mut fp, f, regs, true, false)?;
+                let mut count = 0;
+                for i in self.body() {
+                    if !self.active(f.masked, i) {
+                        continue;
+                    }
+                    let bit = self.mask_bit(f.vs2, i);
+                    self.write_elem(f.vd, i, sew, count);
+                    count += u64::from(bit);
+                }
+                Some(self.outcome(sew, fp))
+            }
+            0b10001 if f.vs2 == 0 => self.vid(f, Widths { dst: sew, src2: None, src1: sew }),
+            _ => None,
+        }
+    }
+
+    /// `vid.v`: writes each active element's index.
+    fn vid(&mut self, f: &Fields, w: Widths) -> Option<VecOutcome> {
+        let regs = self.vtype.group_regs(w.dst)?;
+        let mut fp = self.sources(f, Operand::Scalar(0), w)?;
+        self.dest(&mut fp, f, regs, true, false)?;
+        for i in self.body() {
+            if self.active(f.masked, i) {
+                self.write_elem(f.vd, i, w.dst, i as u64);
+            }
+        }
+        Some(self.outcome(w.dst, fp))
+    }
+
+    /// `vcompress.vm`: packs the `vs2` elements selected by mask `vs1` into
+    /// the lowest elements of `vd`.
+    fn compress(&mut self, f: &Fields) -> Option<VecOutcome> {
+        let sew = self.vtype.sew;
+        let regs = self.vtype.group_regs(sew)?;
+        if f.masked || self.vstart != 0 || !f.vs2.is_multiple_of(regs) {
+            return None;
+        }
+        let mut fp = Footprint::default();
+        fp.read(f.vs2, regs);
+        fp.read(f.rs1, 1);
+        self.dest(&mut fp, f, regs, false, false)?;
+        let packed: Vec<u64> = self
+            .body()
+            .filter(|&i| self.mask_bit(f.rs1, i))
+            .map(|i| self.read_elem(f.vs2, i, sew))
+            .collect();
+        for (j, val) in packed.into_iter().enumerate() {
+            self.write_elem(f.vd, j, sew, val);
+        }
+        Some(self.outcome(sew, fp))
+    }
+
+    /// Mask-register logical instructions (`vmand.mm` and friends).
+    fn mask_logical(&mut self, f: &Fields, op: impl Fn(bool, bool) -> bool) -> Option<VecOutcome> {
+        if f.masked {
+            return None;
+        }
+        let mut fp = Footprint::default();
+        fp.read(f.vs2, 1);
+        fp.read(f.rs1, 1);
+        fp.write(f.vd, 1);
+        let bits: Vec<(usize, bool)> = self
+            .body()
+            .map(|i| (i, op(self.mask_bit(f.vs2, i), self.mask_bit(f.rs1, i))))
+            .collect();
+        for (i, bit) in bits {
+            self.set_mask_bit(f.vd, i, bit);
+        }
+        Some(VecOutcome { width: 1, ..self.outcome(1, fp) })
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+    use crate::config::VectorConfig;
+    use crate::isa::rvv::vtype::VType;
+
+    /// Encodes an `OP-V` instruction.
+    fn op_v(funct6: u32, vm: u32, vs2: u32, rs1: u32, funct3: u32, vd: u32) -> u32 {
+        (funct6 << 26) | (vm << 25) | (vs2 << 20) | (rs1 << 15) | (funct3 << 12) | (vd << 7) | 0x57
+    }
+
+    /// VLEN = 128 with the given vtype and `vl = VLMAX`.
+    fn unit(vtype: u64) -> VectorUnit {
+        let mut v = VectorUnit::new(&VectorConfig { enabled: true, ..VectorConfig::default() });
+        v.vtype = VType::decode(vtype);
+        v.vl = v.vlmax();
+        v
+    }
+
+    const E32M1: u64 = 0b010_000;
+    const E64M1: u64 = 0b011_000;
+
+    fn fill(v: &mut VectorUnit, reg: usize, eew: u32, vals: &[u64]) {
+        for (i, &x) in vals.iter().enumerate() {
+            v.write_elem(reg, i, eew, x);
+        }
+    }
+
+    fn elems(v: &VectorUnit, reg: usize, eew: u32, n: usize) -> Vec<u64> {
+        (0..n).map(|i| v.read_elem(reg, i, eew)).collect()
+    }
+
+    #[test]
+    fn vadd_vv_and_vx() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[1, 2, 3, u64::from(u32::MAX)]);
+        fill(&mut v, 2, 32, &[10, 20, 30, 1]);
+        let out = v.execute_arith(op_v(f6::VADD, 1, 1, 2, OPIVV, 3), 0).unwrap();
+        assert_eq!(elems(&v, 3, 32, 4), [11, 22, 33, 0]);
+        assert_eq!(out.elements, 4);
+
+        let _ = v.execute_arith(op_v(f6::VADD, 1, 1, 5, OPIVX, 4), 100).unwrap();
+        assert_eq!(elems(&v, 4, 32, 4), [101, 102, 103, 99]);
+    }
+
+    #[test]
+    fn masked_elements_are_undisturbed() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[1, 1, 1, 1]);
+        fill(&mut v, 3, 32, &[7, 7, 7, 7]);
+        v.set_mask_bit(0, 1, true);
+        v.set_mask_bit(0, 3, true);
+        // vadd.vi v3, v1, 4, v0.t
+        let _ = v.execute_arith(op_v(f6::VADD, 0, 1, 4, OPIVI, 3), 0).unwrap();
+        assert_eq!(elems(&v, 3, 32, 4), [7, 5, 7, 5]);
+    }
+
+    #[test]
+    fn tail_is_undisturbed_below_vlmax() {
+        let mut v = unit(E32M1);
+        v.vl = 2;
+        fill(&mut v, 3, 32, &[9, 9, 9, 9]);
+        let _ = v.execute_arith(op_v(f6::VMERGE, 1, 0, 5, OPIVI, 3), 0).unwrap();
+        assert_eq!(elems(&v, 3, 32, 4), [5, 5, 9, 9]);
+    }
+
+    #[test]
+    fn saturating_add_sets_vxsat() {
+        let mut v = unit(0b000_000); // e8
+        fill(&mut v, 1, 8, &[250, 100]);
+        v.vl = 2;
+        let _ = v.execute_arith(op_v(f6::VSADDU, 1, 1, 10, OPIVI, 2), 0).unwrap();
+        assert_eq!(elems(&v, 2, 8, 2), [255, 110]);
+        assert!(v.vxsat);
+    }
+
+    #[test]
+    fn averaging_add_rounds_per_vxrm() {
+        let mut v = unit(0b000_000);
+        v.vl = 1;
+        fill(&mut v, 1, 8, &[3]);
+        // (3 + 0) >> 1 = 1.5: rnu rounds up, rdn truncates.
+        let _ = v.execute_arith(op_v(f6::VAADDU, 1, 1, 0, OPMVX, 2), 0).unwrap();
+        assert_eq!(v.read_elem(2, 0, 8), 2);
+        v.vxrm = 2;
+        let _ = v.execute_arith(op_v(f6::VAADDU, 1, 1, 0, OPMVX, 2), 0).unwrap();
+        assert_eq!(v.read_elem(2, 0, 8), 1);
+    }
+
+    #[test]
+    fn compare_writes_mask_bits() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[1, 5, 3, 8]);
+        let _ = v.execute_arith(op_v(f6::VMSGTU, 1, 1, 3, OPIVI, 0), 0).unwrap();
+        assert_eq!(
+            (0..4).map(|i| v.mask_bit(0, i)).collect::<Vec<_>>(),
+            [false, true, false, true]
+        );
+    }
+
+    #[test]
+    fn reductions_fold_into_element_zero() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 2, 32, &[1, 2, 3, 4]);
+        fill(&mut v, 1, 32, &[100]);
+        let _ = v.execute_arith(op_v(f6::VREDSUM, 1, 2, 1, OPMVV, 3), 0).unwrap();
+        assert_eq!(v.read_elem(3, 0, 32), 110);
+
+        // Widening sum of signed bytes into a 16-bit accumulator.
+        let mut v = unit(0b000_000);
+        v.vl = 3;
+        fill(&mut v, 2, 8, &[0xFF, 0xFF, 0x02]);
+        let _ = v.execute_arith(op_v(f6::VWREDSUM, 1, 2, 1, OPIVV, 3), 0).unwrap();
+        assert_eq!(v.read_elem(3, 0, 16), 0);
+    }
+
+    #[test]
+    fn widening_multiply_doubles_the_group() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[u64::from(u32::MAX), 2, 3, 4]);
+        // vwmulu.vx v2, v1, x: v2-v3 hold four 64-bit products.
+        let out = v.execute_arith(op_v(f6::VWMULU, 1, 1, 5, OPMVX, 2), 2).unwrap();
+        assert_eq!(elems(&v, 2, 64, 4), [0x1_FFFF_FFFE, 4, 6, 8]);
+        assert_eq!(out.class, VecClass::Mul);
+        // An odd destination is misaligned for EMUL = 2.
+        assert!(v.execute_arith(op_v(f6::VWMULU, 1, 1, 5, OPMVX, 3), 2).is_err());
+    }
+
+    #[test]
+    fn divide_by_zero_follows_scalar_semantics() {
+        let mut v = unit(E64M1);
+        fill(&mut v, 1, 64, &[7, 9]);
+        let _ = v.execute_arith(op_v(f6::VDIVU, 1, 1, 0, OPMVX, 2), 0).unwrap();
+        assert_eq!(elems(&v, 2, 64, 2), [u64::MAX, u64::MAX]);
+        let _ = v.execute_arith(op_v(f6::VREM, 1, 1, 0, OPMVX, 2), 0).unwrap();
+        assert_eq!(elems(&v, 2, 64, 2), [7, 9]);
+    }
+
+    #[test]
+    fn slides_and_gather() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[10, 20, 30, 40]);
+        fill(&mut v, 2, 32, &[0, 0, 0, 0]);
+        let _ = v.execute_arith(op_v(f6::VSLIDEUP, 1, 1, 1, OPIVI, 2), 0).unwrap();
+        assert_eq!(elems(&v, 2, 32, 4), [0, 10, 20, 30]);
+        let _ = v.execute_arith(op_v(f6::VSLIDE1DOWN, 1, 1, 5, OPMVX, 3), 99).unwrap();
+        assert_eq!(elems(&v, 3, 32, 4), [20, 30, 40, 99]);
+
+        fill(&mut v, 4, 32, &[3, 0, 9, 1]);
+        let _ = v.execute_arith(op_v(f6::VRGATHER, 1, 1, 4, OPIVV, 5), 0).unwrap();
+        assert_eq!(elems(&v, 5, 32, 4), [40, 10, 0, 20]);
+    }
+
+    #[test]
+    fn compress_and_iota() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[10, 20, 30, 40]);
+        fill(&mut v, 3, 32, &[0, 0, 0, 0]);
+        v.set_mask_bit(2, 1, true);
+        v.set_mask_bit(2, 3, true);
+        let _ = v.execute_arith(op_v(f6::VCOMPRESS, 1, 1, 2, OPMVV, 3), 0).unwrap();
+        assert_eq!(elems(&v, 3, 32, 4), [20, 40, 0, 0]);
+
+        let _ = v.execute_arith(op_v(f6::VMUNARY0, 1, 2, 0b10000, OPMVV, 4), 0).unwrap();
+        assert_eq!(elems(&v, 4, 32, 4), [0, 0, 1, 1]);
+        let _ = v.execute_arith(op_v(f6::VMUNARY0, 1, 0, 0b10001, OPMVV, 5), 0).unwrap();
+        assert_eq!(elems(&v, 5, 32, 4), [0, 1, 2, 3]);
+    }
+
+    #[test]
+    fn scalar_results() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 1, 32, &[0xFFFF_FFFE, 1, 2, 3]);
+        let out = v.execute_arith(op_v(f6::VWXUNARY0, 1, 1, 0, OPMVV, 10), 0).unwrap();
+        assert_eq!(out.scalar, Some(-2i64 as u64));
+        assert!(!out.footprint.writes_vector());
+
+        v.set_mask_bit(2, 2, true);
+        v.set_mask_bit(2, 3, true);
+        let cpop = v.execute_arith(op_v(f6::VWXUNARY0, 1, 2, 0b10000, OPMVV, 10), 0).unwrap();
+        let first = v.execute_arith(op_v(f6::VWXUNARY0, 1, 2, 0b10001, OPMVV, 10), 0).unwrap();
+        assert_eq!((cpop.scalar, first.scalar), (Some(2), Some(2)));
+    }
+
+    #[test]
+    fn fp_add_and_fma() {
+        let mut v = unit(E32M1);
+        let f = |x: f32| u64::from(x.to_bits());
+        fill(&mut v, 1, 32, &[f(1.5), f(2.0), f(-1.0), f(0.5)]);
+        let two = Fpu::box_f32(2.0);
+        let _ = v.execute_arith(op_v(f6::VFADD, 1, 1, 1, OPFVF, 2), two).unwrap();
+        assert_eq!(elems(&v, 2, 32, 4), [f(3.5), f(4.0), f(1.0), f(2.5)]);
+
+        // vfmacc.vf v2, f, v1: v2 += 2 * v1
+        let out = v.execute_arith(op_v(f6::VFMACC, 1, 1, 1, OPFVF, 2), two).unwrap();
+        assert_eq!(elems(&v, 2, 32, 4), [f(6.5), f(8.0), f(-1.0), f(3.5)]);
+        assert_eq!(out.class, VecClass::Fp);
+
+        // 1/3 is inexact.
+        fill(&mut v, 3, 32, &[f(1.0), f(1.0), f(1.0), f(1.0)]);
+        let out = v.execute_arith(op_v(f6::VFDIV, 1, 3, 1, OPFVF, 4), Fpu::box_f32(3.0)).unwrap();
+        assert_ne!(out.fp_flags & FpFlags::NX.bits(), 0);
+    }
+
+    #[test]
+    fn int_float_conversions() {
+        let mut v = unit(E64M1);
+        fill(&mut v, 1, 64, &[(-3i64) as u64, u64::MAX]);
+        let out = v.execute_arith(op_v(f6::VFUNARY0, 1, 1, 0b00011, OPFVV, 2), 0).unwrap();
+        assert_eq!(v.read_elem(2, 0, 64), (-3.0f64).to_bits());
+        assert_eq!(out.fp_flags, 0);
+        let _ = v.execute_arith(op_v(f6::VFUNARY0, 1, 2, 0b00001, OPFVV, 3), 0).unwrap();
+        assert_eq!(v.read_elem(3, 0, 64), (-3i64) as u64);
+
+        let out = v.execute_arith(op_v(f6::VFUNARY0, 1, 1, 0b00010, OPFVV, 2), 0).unwrap();
+        assert_eq!(v.read_elem(2, 1, 64), (u64::MAX as f64).to_bits());
+        assert_eq!(out.fp_flags, FpFlags::NX.bits());
+    }
+
+    #[test]
+    fn whole_register_move_ignores_vill() {
+        let mut v = unit(E32M1);
+        fill(&mut v, 2, 32, &[1, 2, 3, 4, 5, 6, 7, 8]);
+        v.vtype = VType::ILLEGAL;
+        // vmv2r.v v4, v2
+        let _ = v.execute_arith(op_v(f6::VSMUL_VMVNR, 1, 2, 1, OPIVI, 4), 0).unwrap();
+        assert_eq!(elems(&v, 4, 32, 8), [1, 2, 3, 4, 5, 6, 7, 8]);
+        // Anything else is illegal under vill.
+        let inst = op_v(f6::VADD, 1, 1, 2, OPIVV, 3);
+        assert_eq!(v.execute_arith(inst, 0).unwrap_err(), Trap::IllegalInstruction(inst));
+    }
+
+    #[test]
+    fn masked_destination_may_not_overlap_v0() {
+        let mut v = unit(E32M1);
+        assert!(v.execute_arith(op_v(f6::VADD, 0, 1, 2, OPIVV, 0), 0).is_err());
+        // Mask-producing compares may write v0.
+        assert!(v.execute_arith(op_v(f6::VMSEQ, 0, 1, 2, OPIVV, 0), 0).is_ok());
+    }
+}
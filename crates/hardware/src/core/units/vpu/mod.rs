@@ -0,0 +1,256 @@
+//! Vector Processing Unit (VPU).
+//!
+//! This module implements the architectural state of the RISC-V Vector
+//! extension and its arithmetic datapath:
+//! 1. **Register File:** Thirty-two `VLEN`-bit registers stored as one
+//!    little-endian byte array, so the elements of a register group are
+//!    contiguous.
+//! 2. **Configuration:** `vl`, `vtype`, `vstart`, and the fixed-point `vxrm`
+//!    and `vxsat` fields of `vcsr`.
+//! 3. **Arithmetic:** Element-wise integer, fixed-point, floating-point,
+//!    mask, reduction, and permutation instructions ([`arith`]).
+//! 4. **Timing:** Completion times, lane throughput, and register renaming
+//!    ([`timing`]).
+//!
+//! Vector loads and stores need address translation and the memory system,
+//! so they are driven by the CPU and only use the element accessors here.
+
+/// Vector arithmetic instruction execution.
+pub mod arith;
+
+/// Vector unit issue, throughput, and renaming model.
+pub mod timing;
+
+use crate::config::VectorConfig;
+use crate::isa::rvv::vtype::{self, VType};
+
+use self::timing::VectorTiming;
+
+/// Number of architectural vector registers.
+pub const NUM_VREGS: usize = 32;
+
+/// Smallest supported VLEN in bits.
+const MIN_VLEN: usize = 64;
+
+/// Largest VLEN permitted by the specification, in bits.
+const MAX_VLEN: usize = 65536;
+
+/// Architectural vector state and timing model of one hart.
+#[derive(Clone, Debug)]
+pub struct VectorUnit {
+    /// The V extension is implemented.
+    pub enabled: bool,
+    /// Bits per vector register.
+    vlen: usize,
+    /// Register file, `NUM_VREGS · VLEN / 8` bytes.
+    regs: Vec<u8>,
+    /// Vector length (`vl`).
+    pub vl: u64,
+    /// Vector type (`vtype`).
+    pub vtype: VType,
+    /// Index of the first element to execute (`vstart`).
+    pub vstart: u64,
+    /// Fixed-point rounding mode (`vxrm`).
+    pub vxrm: u8,
+    /// Fixed-point saturation flag (`vxsat`).
+    pub vxsat: bool,
+    /// Issue and completion timing.
+    pub timing: VectorTiming,
+}
+
+impl VectorUnit {
+    /// Creates a vector unit with all registers zero and `vtype.vill` set.
+    ///
+    /// `VLEN` is rounded to a power of two between 64 and 65536 bits.
+    pub fn new(config: &VectorConfig) -> Self {
+        let vlen = config.vlen.clamp(MIN_VLEN, MAX_VLEN).next_power_of_two();
+        Self {
+            enabled: config.enabled,
+            vlen,
+            regs: vec![0; NUM_VREGS * vlen / 8],
+            vl: 0,
+            vtype: VType::ILLEGAL,
+            vstart: 0,
+            vxrm: 0,
+            vxsat: false,
+            timing: VectorTiming::new(config),
+        }
+    }
+
+    /// Bits per vector register (`VLEN`).
+    pub const fn vlen(&self) -> usize {
+        self.vlen
+    }
+
+    /// Bytes per vector register (`vlenb`).
+    pub const fn vlenb(&self) -> usize {
+        self.vlen / 8
+    }
+
+    /// Maximum vector length for the current `vtype`.
+    pub const fn vlmax(&self) -> u64 {
+        self.vtype.vlmax(self.vlen as u64)
+    }
+
+    /// `vcsr`: `vxrm` in bits 2:1, `vxsat` in bit 0.
+    pub const fn vcsr(&self) -> u64 {
+        ((self.vxrm as u64) << 1) | self.vxsat as u64
+    }
+
+    /// Writes `vcsr`.
+    pub const fn set_vcsr(&mut self, val: u64) {
+        self.vxrm = ((val >> 1) & 0x3) as u8;
+        self.vxsat = val & 1 != 0;
+    }
+
+    /// Reads element `idx` of `eew` bits from the register group starting at
+    /// `reg`, zero-extended. Elements past the register file read as zero.
+    pub fn read_elem(&self, reg: usize, idx: usize, eew: u32) -> u64 {
+        let bytes = eew as usize / 8;
+        let off = reg * self.vlenb() + idx * bytes;
+        self.regs.get(off..off + bytes).map_or(0, |b| {
+            let mut buf = [0u8; 8];
+            buf[..bytes].copy_from_slice(b);
+            u64::from_le_bytes(buf)
+        })
+    }
+
+    /// Writes the low `eew` bits of `val` to element `idx` of the register
+    /// group starting at `reg`.
+    pub fn write_elem(&mut self, reg: usize, idx: usize, eew: u32, val: u64) {
+        let bytes = eew as usize / 8;
+        let off = reg * self.vlenb() + idx * bytes;
+        if let Some(b) = self.regs.get_mut(off..off + bytes) {
+            b.copy_from_slice(&val.to_le_bytes()[..bytes]);
+        }
+    }
+
+    /// Reads mask bit `idx` of register `reg`.
+    pub fn mask_bit(&self, reg: usize, idx: usize) -> bool {
+        let off = reg * self.vlenb() + idx / 8;
+        self.regs.get(off).is_some_and(|b| (b >> (idx % 8)) & 1 != 0)
+    }
+
+    /// Writes mask bit `idx` of register `reg`.
+    pub fn set_mask_bit(&mut self, reg: usize, idx: usize, bit: bool) {
+        let off = reg * self.vlenb() + idx / 8;
+        if let Some(b) = self.regs.get_mut(off) {
+            if bit {
+                *b |= 1 << (idx % 8);
+            } else {
+                *b &= !(1 << (idx % 8));
+            }
+        }
+    }
+
+    /// Returns true if element `idx` is active: the instruction is unmasked
+    /// or bit `idx` of `v0` is set.
+    pub fn active(&self, masked: bool, idx: usize) -> bool {
+        !masked || self.mask_bit(0, idx)
+    }
+
+    /// Computes the `vl` and `vtype` written by a `vsetvli`, `vsetivli`, or
+    /// `vsetvl` instruction with scalar operands `rs1_val` and `rs2_val`.
+    ///
+    /// The AVL is `rs1` (or the `vsetivli` immediate); `rs1 = x0` requests
+    /// `VLMAX` when `rd` is not `x0` and keeps the current `vl` otherwise.
+    pub const fn vsetvl_result(&self, inst: u32, rs1_val: u64, rs2_val: u64) -> (u64, VType) {
+        let rd = (inst >> 7) & 0x1F;
+        let rs1 = (inst >> 15) & 0x1F;
+        let (vtype_bits, avl) = if inst >> 31 == 0 {
+            // vsetvli: zimm[10:0]
+            (((inst >> 20) & 0x7FF) as u64, None)
+        } else if (inst >> 30) & 1 == 1 {
+            // vsetivli: zimm[9:0], uimm[4:0] in the rs1 field
+            (((inst >> 20) & 0x3FF) as u64, Some(rs1 as u64))
+        } else {
+            (rs2_val, None)
+        };
+        let vt = VType::decode(vtype_bits);
+        if vt.vill {
+            return (0, vt);
+        }
+        let vlmax = vt.vlmax(self.vlen as u64);
+        let avl = match avl {
+            Some(uimm) => uimm,
+            None if rs1 != 0 => rs1_val,
+            None if rd != 0 => u64::MAX,
+            None => self.vl,
+        };
+        (vtype::set_vl(avl, vlmax), vt)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn unit() -> VectorUnit {
+        VectorUnit::new(&VectorConfig { enabled: true, vlen: 128, ..VectorConfig::default() })
+    }
+
+    #[test]
+    fn elements_of_a_group_are_contiguous() {
+        let mut v = unit();
+        // With VLEN = 128, element 4 of a 32-bit group at v2 is element 0 of v3.
+        v.write_elem(2, 4, 32, 0xDEAD_BEEF);
+        assert_eq!(v.read_elem(3, 0, 32), 0xDEAD_BEEF);
+        assert_eq!(v.read_elem(3, 0, 16), 0xBEEF);
+        assert_eq!(v.read_elem(3, 1, 8), 0xBE);
+    }
+
+    #[test]
+    fn mask_bits_round_trip() {
+        let mut v = unit();
+        v.set_mask_bit(0, 9, true);
+        assert!(v.mask_bit(0, 9));
+        assert!(!v.mask_bit(0, 8));
+        assert!(v.active(false, 8));
+        assert!(!v.active(true, 8));
+        assert!(v.active(true, 9));
+        v.set_mask_bit(0, 9, false);
+        assert!(!v.mask_bit(0, 9));
+    }
+
+    #[test]
+    fn vsetvli_avl_rules() {
+        let mut v = unit();
+        // vsetvli a0, a1, e32, m1: AVL from rs1, clamped to VLMAX = 4.
+        let inst = (0b0_1101_0000 << 20) | (11 << 15) | (0b111 << 12) | (10 << 7) | 0x57;
+        assert_eq!(v.vsetvl_result(inst, 3, 0).0, 3);
+        assert_eq!(v.vsetvl_result(inst, 100, 0).0, 4);
+
+        // rs1 = x0, rd != x0: VLMAX.
+        let vlmax = inst & !(0x1F << 15);
+        assert_eq!(v.vsetvl_result(vlmax, 0, 0).0, 4);
+
+        // rs1 = x0, rd = x0: keep vl.
+        v.vl = 2;
+        let keep = vlmax & !(0x1F << 7);
+        assert_eq!(v.vsetvl_result(keep, 0, 0).0, 2);
+    }
+
+    #[test]
+    fn vsetivli_and_vsetvl_encodings() {
+        let v = unit();
+        // vsetivli a0, 7, e8, m1 -> VLMAX 16, vl 7.
+        let ivli = (0b11 << 30) | (7 << 15) | (0b111 << 12) | (10 << 7) | 0x57;
+        let (vl, vt) = v.vsetvl_result(ivli, 0, 0);
+        assert_eq!((vl, vt.sew), (7, 8));
+
+        // vsetvl with an illegal vtype sets vill and vl = 0.
+        let vsetvl = (0b1000000 << 25) | (11 << 15) | (0b111 << 12) | (10 << 7) | 0x57;
+        let (vl, vt) = v.vsetvl_result(vsetvl, 10, 0b100_000);
+        assert!(vt.vill);
+        assert_eq!(vl, 0);
+    }
+
+    #[test]
+    fn vlen_is_sanitized() {
+        let v = VectorUnit::new(&VectorConfig { vlen: 100, ..VectorConfig::default() });
+        assert_eq!(v.vlen(), 128);
+        assert_eq!(v.vlenb(), 16);
+        let v = VectorUnit::new(&VectorConfig { vlen: 8, ..VectorConfig::default() });
+        assert_eq!(v.vlen(), 64);
+    }
+}
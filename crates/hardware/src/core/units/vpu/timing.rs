@@ -0,0 +1,276 @@
+//! Vector Unit Timing Model.
+//!
+//! Vector instructions are executed architecturally when they commit; this
+//! model decides when each one would finish on a decoupled vector unit:
+//! 1. **Dependencies:** An operation starts once its source register groups
+//!    are written (read-after-write). Without renaming, it also waits for
+//!    older readers and writers of its destination (write-after-read,
+//!    write-after-write).
+//! 2. **Renaming:** With more physical than architectural registers, each
+//!    destination register takes a spare physical register instead. A spare
+//!    becomes free again once the value it replaced has been read by every
+//!    older reader and the new value is written.
+//! 3. **Throughput:** Arithmetic and memory operations occupy their unit for
+//!    `ceil(vl·SEW / (64·lanes))` cycles, or one cycle per cache line.
+//! 4. **Queue:** At most `queue_depth` operations are in flight; commit stalls
+//!    when the queue is full.
+
+use super::NUM_VREGS;
+use crate::config::VectorConfig;
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, VecDeque};
+
+/// Execution class of a vector operation, selecting its latency and unit.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, Default)]
+pub enum VecClass {
+    /// Integer ALU, mask, permutation, and move operations.
+    #[default]
+    Alu,
+    /// Integer multiply and multiply-accumulate.
+    Mul,
+    /// Floating-point operations.
+    Fp,
+    /// Integer divide, floating-point divide and square root.
+    Div,
+    /// Vector load or store.
+    Mem,
+}
+
+/// Register groups an operation reads and writes: `(first register, count)`.
+#[derive(Clone, Copy, Debug, Default)]
+pub struct Footprint {
+    srcs: [(u8, u8); 4],
+    num_srcs: usize,
+    dst: Option<(u8, u8)>,
+}
+
+impl Footprint {
+    /// Adds a source register group.
+    pub const fn read(&mut self, reg: usize, count: usize) {
+        if self.num_srcs < self.srcs.len() {
+            self.srcs[self.num_srcs] = (reg as u8, count as u8);
+            self.num_srcs += 1;
+        }
+    }
+
+    /// Sets the destination register group.
+    pub const fn write(&mut self, reg: usize, count: usize) {
+        self.dst = Some((reg as u8, count as u8));
+    }
+
+    /// Returns true if the operation writes a vector register.
+    pub const fn writes_vector(&self) -> bool {
+        self.dst.is_some()
+    }
+
+    fn sources(&self) -> impl Iterator<Item = usize> + '_ {
+        self.srcs[..self.num_srcs]
+            .iter()
+            .flat_map(|&(r, n)| r as usize..(r as usize + n as usize).min(NUM_VREGS))
+    }
+
+    fn dests(&self) -> impl Iterator<Item = usize> {
+        self.dst.into_iter().flat_map(|(r, n)| r as usize..(r as usize + n as usize).min(NUM_VREGS))
+    }
+}
+
+/// Issue and completion tracking for the vector unit.
+#[derive(Clone, Debug)]
+pub struct VectorTiming {
+    lanes: u64,
+    alu_latency: u64,
+    mul_latency: u64,
+    fp_latency: u64,
+    div_latency: u64,
+    queue_depth: usize,
+    /// Spare physical registers are modeled (renaming enabled).
+    renaming: bool,
+    /// Cycle at which each architectural register's latest value is written.
+    ready: [u64; NUM_VREGS],
+    /// Cycle at which the last reader of each architectural register finishes.
+    last_read: [u64; NUM_VREGS],
+    /// Cycles at which each spare physical register becomes free.
+    spares: BinaryHeap<Reverse<u64>>,
+    /// Cycle at which the arithmetic unit accepts a new operation.
+    arith_free: u64,
+    /// Cycle at which the memory unit accepts a new operation.
+    mem_free: u64,
+    /// Completion cycles of operations still in flight.
+    in_flight: VecDeque<u64>,
+}
+
+impl VectorTiming {
+    /// Creates the timing model for `config`.
+    pub fn new(config: &VectorConfig) -> Self {
+        let spare_count = config.phys_regs.saturating_sub(NUM_VREGS);
+        Self {
+            lanes: config.lanes.max(1) as u64,
+            alu_latency: config.alu_latency.max(1),
+            mul_latency: config.mul_latency.max(1),
+            fp_latency: config.fp_latency.max(1),
+            div_latency: config.div_latency.max(1),
+            queue_depth: config.queue_depth.max(1),
+            renaming: spare_count > 0,
+            ready: [0; NUM_VREGS],
+            last_read: [0; NUM_VREGS],
+            spares: (0..spare_count).map(|_| Reverse(0)).collect(),
+            arith_free: 0,
+            mem_free: 0,
+            in_flight: VecDeque::with_capacity(config.queue_depth.max(1)),
+        }
+    }
+
+    /// Returns true if `queue_depth` operations are still in flight at `now`.
+    pub fn is_full(&mut self, now: u64) -> bool {
+        self.in_flight.retain(|&done| done > now);
+        self.in_flight.len() >= self.queue_depth
+    }
+
+    /// Returns true if register `reg` has been written by cycle `now`.
+    pub fn is_ready(&self, reg: usize, now: u64) -> bool {
+        self.ready.get(reg).is_none_or(|&t| t <= now)
+    }
+
+    /// Schedules an arithmetic operation on `elements` elements of `sew`
+    /// bits and returns its completion cycle.
+    pub fn issue_arith(
+        &mut self,
+        now: u64,
+        class: VecClass,
+        fp: &Footprint,
+        elements: u64,
+        sew: u32,
+    ) -> u64 {
+        let bits_per_cycle = 64 * self.lanes;
+        let occupancy = (elements * u64::from(sew)).div_ceil(bits_per_cycle).max(1);
+        let latency = match class {
+            VecClass::Mul => self.mul_latency,
+            VecClass::Fp => self.fp_latency,
+            VecClass::Div => self.div_latency,
+            VecClass::Alu | VecClass::Mem => self.alu_latency,
+        };
+        self.schedule(now, fp, false, occupancy, latency)
+    }
+
+    /// Schedules a memory operation touching `lines` cache lines whose
+    /// access latency (from issue of the first line) is `latency`, and
+    /// returns its completion cycle.
+    pub fn issue_mem(&mut self, now: u64, fp: &Footprint, lines: u64, latency: u64) -> u64 {
+        self.schedule(now, fp, true, lines.max(1), latency.max(1))
+    }
+
+    fn schedule(
+        &mut self,
+        now: u64,
+        fp: &Footprint,
+        is_mem: bool,
+        occupancy: u64,
+        latency: u64,
+    ) -> u64 {
+        let unit_free = if is_mem { self.mem_free } else { self.arith_free };
+        let mut start = fp.sources().fold(now.max(unit_free), |t, r| t.max(self.ready[r]));
+        let dests: Vec<usize> = fp.dests().collect();
+        if self.renaming {
+            // Each destination register takes the earliest-free spare.
+            for _ in &dests {
+                if let Some(Reverse(free_at)) = self.spares.pop() {
+                    start = start.max(free_at);
+                }
+            }
+        } else {
+            for &r in &dests {
+                start = start.max(self.ready[r]).max(self.last_read[r]);
+            }
+        }
+
+        let busy_until = start + occupancy;
+        let done = busy_until + latency - 1;
+        if is_mem {
+            self.mem_free = busy_until;
+        } else {
+            self.arith_free = busy_until;
+        }
+        for r in fp.sources() {
+            self.last_read[r] = self.last_read[r].max(busy_until);
+        }
+        for &r in &dests {
+            if self.renaming {
+                // The replaced physical register is recycled once its value
+                // has been consumed and the new value is written.
+                self.spares.push(Reverse(self.last_read[r].max(done)));
+                self.last_read[r] = 0;
+            }
+            self.ready[r] = done;
+        }
+        self.in_flight.push_back(done);
+        done
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn timing(phys_regs: usize) -> VectorTiming {
+        VectorTiming::new(&VectorConfig {
+            lanes: 2,
+            alu_latency: 2,
+            queue_depth: 2,
+            phys_regs,
+            ..VectorConfig::default()
+        })
+    }
+
+    fn footprint(srcs: &[usize], dst: usize) -> Footprint {
+        let mut fp = Footprint::default();
+        for &s in srcs {
+            fp.read(s, 1);
+        }
+        fp.write(dst, 1);
+        fp
+    }
+
+    #[test]
+    fn occupancy_scales_with_lanes() {
+        let mut t = timing(32);
+        // 16 x 32-bit elements over 128 bits/cycle = 4 cycles, then 2 of latency.
+        let done = t.issue_arith(10, VecClass::Alu, &footprint(&[1], 2), 16, 32);
+        assert_eq!(done, 15);
+        assert!(!t.is_ready(2, 14));
+        assert!(t.is_ready(2, 15));
+    }
+
+    #[test]
+    fn dependent_op_waits_for_its_source() {
+        let mut t = timing(32);
+        let first = t.issue_arith(0, VecClass::Alu, &footprint(&[1], 2), 4, 32);
+        let second = t.issue_arith(0, VecClass::Alu, &footprint(&[2], 3), 4, 32);
+        assert_eq!(second, first + 2);
+    }
+
+    #[test]
+    fn renaming_removes_write_after_read_stall() {
+        // v2 <- v1 (slow), then v1 <- v3: without renaming the write to v1
+        // waits for the read of v1 to finish.
+        let mut plain = timing(32);
+        let _ = plain.issue_arith(0, VecClass::Alu, &footprint(&[1], 2), 64, 64);
+        let fp = footprint(&[3], 1);
+        let _ = plain.issue_mem(0, &fp, 1, 1);
+        let plain_done = plain.ready[1];
+
+        let mut renamed = timing(40);
+        let _ = renamed.issue_arith(0, VecClass::Alu, &footprint(&[1], 2), 64, 64);
+        let _ = renamed.issue_mem(0, &fp, 1, 1);
+        assert!(renamed.ready[1] < plain_done);
+    }
+
+    #[test]
+    fn queue_fills_and_drains() {
+        let mut t = timing(32);
+        let a = t.issue_arith(0, VecClass::Alu, &footprint(&[], 1), 1, 8);
+        let _ = t.issue_arith(0, VecClass::Alu, &footprint(&[], 2), 1, 8);
+        assert!(t.is_full(0));
+        assert!(t.is_full(a - 1));
+        assert!(!t.is_full(a));
+    }
+}
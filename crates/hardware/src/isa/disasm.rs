@@ -10,6 +10,8 @@
 //! - RV64A (atomic)
 //! - RV64F (single-precision float)
 //! - RV64D (double-precision float)
+//! - Zba, Zbb, Zbs (bit manipulation)
+//! - RVV 1.0 (vector configuration, arithmetic, and memory)
 //! - Privileged (ECALL, EBREAK, xRET, CSR, FENCE, WFI)
 //!
 //! # Usage
@@ -28,7 +30,10 @@ use crate::isa::rv64d::funct7 as d_f7;
 use crate::isa::rv64f::{funct3 as f_f3, funct7 as f_f7, opcodes as f_op};
 use crate::isa::rv64i::{funct3 as i_f3, funct7 as i_f7, opcodes as i_op};
 use crate::isa::rv64m::{funct3 as m_f3, opcodes as m_op};
+use crate::isa::rvb::{funct7 as b_f7, funct12 as b_f12};
 use crate::isa::rvc;
+use crate::isa::rvv::vtype::VType;
+use crate::isa::rvv::{funct6 as v_f6, opcodes as v_op};
 
 /// ABI register names for x0–x31.
 const REG_NAMES: [&str; 32] = [
@@ -116,6 +121,8 @@ pub fn disassemble(inst: u32) -> String {
             };
             format!("{mn} {}, {imm_i}({})", xreg(rd), xreg(rs1))
         }
+        f_op::OP_LOAD_FP if v_op::is_vector_width(f3) => disasm_vector_mem(inst, true),
+        f_op::OP_STORE_FP if v_op::is_vector_width(f3) => disasm_vector_mem(inst, false),
         f_op::OP_LOAD_FP => {
             let mn = if f3 == i_f3::LW { "flw" } else { "fld" };
             format!("{mn} {}, {imm_i}({})", freg(rd), xreg(rs1))
@@ -207,6 +214,9 @@ pub fn disassemble(inst: u32) -> String {
             format!("fnmadd.{p} {}, {}, {}, {}", freg(rd), freg(rs1), freg(rs2), freg(inst.rs3()))
         }
 
+        // ── Vector ────────────────────────────────────────
+        v_op::OP_V => disasm_op_v(inst),
+
         // ── Atomic ────────────────────────────────────────
         a_op::OP_AMO => disasm_amo(rd, rs1, rs2, f3, f7),
 
@@ -245,6 +255,15 @@ fn disasm_op_reg(rd: RegIdx, rs1: RegIdx, rs2: RegIdx, f3: u32, f7: u32, is_w: b
         return format!("{mn}{suffix} {}, {}, {}", xreg(rd), xreg(rs1), xreg(rs2));
     }
 
+    // Zba / Zbb / Zbs
+    if let Some(mn) = bitmanip_reg_name(f3, f7, is_w, rs2) {
+        return if mn == "zext.h" {
+            format!("{mn} {}, {}", xreg(rd), xreg(rs1))
+        } else {
+            format!("{mn} {}, {}, {}", xreg(rd), xreg(rs1), xreg(rs2))
+        };
+    }
+
     let mn = match (f3, f7) {
         (i_f3::ADD_SUB, i_f7::DEFAULT) => "add",
         (i_f3::ADD_SUB, i_f7::SUB) => "sub",
@@ -261,10 +280,83 @@ fn disasm_op_reg(rd: RegIdx, rs1: RegIdx, rs2: RegIdx, f3: u32, f7: u32, is_w: b
     format!("{mn}{suffix} {}, {}, {}", xreg(rd), xreg(rs1), xreg(rs2))
 }
 
+/// Returns the mnemonic of a Zba, Zbb, or Zbs register-register form.
+const fn bitmanip_reg_name(f3: u32, f7: u32, is_w: bool, rs2: RegIdx) -> Option<&'static str> {
+    Some(match (f7, f3, is_w) {
+        (b_f7::SHADD, i_f3::SLT, false) => "sh1add",
+        (b_f7::SHADD, i_f3::XOR, false) => "sh2add",
+        (b_f7::SHADD, i_f3::OR, false) => "sh3add",
+        (b_f7::SHADD, i_f3::SLT, true) => "sh1add.uw",
+        (b_f7::SHADD, i_f3::XOR, true) => "sh2add.uw",
+        (b_f7::SHADD, i_f3::OR, true) => "sh3add.uw",
+        (b_f7::ADD_UW, i_f3::ADD_SUB, true) => "add.uw",
+        (b_f7::ADD_UW, i_f3::XOR, true) if rs2.is_zero() => "zext.h",
+        (b_f7::NEGATE, i_f3::AND, false) => "andn",
+        (b_f7::NEGATE, i_f3::OR, false) => "orn",
+        (b_f7::NEGATE, i_f3::XOR, false) => "xnor",
+        (b_f7::MINMAX, i_f3::XOR, false) => "min",
+        (b_f7::MINMAX, i_f3::SRL_SRA, false) => "minu",
+        (b_f7::MINMAX, i_f3::OR, false) => "max",
+        (b_f7::MINMAX, i_f3::AND, false) => "maxu",
+        (b_f7::ROTATE, i_f3::SLL, false) => "rol",
+        (b_f7::ROTATE, i_f3::SRL_SRA, false) => "ror",
+        (b_f7::ROTATE, i_f3::SLL, true) => "rolw",
+        (b_f7::ROTATE, i_f3::SRL_SRA, true) => "rorw",
+        (b_f7::BSET, i_f3::SLL, false) => "bset",
+        (b_f7::BCLR_BEXT, i_f3::SLL, false) => "bclr",
+        (b_f7::BCLR_BEXT, i_f3::SRL_SRA, false) => "bext",
+        (b_f7::BINV, i_f3::SLL, false) => "binv",
+        _ => return None,
+    })
+}
+
+/// Returns the mnemonic of a Zba, Zbb, or Zbs shift-immediate or unary
+/// form, and whether it takes a shift amount.
+const fn bitmanip_imm_name(f3: u32, imm12: u32, is_w: bool) -> Option<(&'static str, bool)> {
+    let f6 = imm12 >> 6;
+    let f7 = imm12 >> 5;
+    Some(match (f3, is_w) {
+        (i_f3::SLL, false) => match (f6, imm12) {
+            (b_f7::F6_BSETI, _) => ("bseti", true),
+            (b_f7::F6_BCLRI_BEXTI, _) => ("bclri", true),
+            (b_f7::F6_BINVI, _) => ("binvi", true),
+            (_, b_f12::CLZ) => ("clz", false),
+            (_, b_f12::CTZ) => ("ctz", false),
+            (_, b_f12::CPOP) => ("cpop", false),
+            (_, b_f12::SEXT_B) => ("sext.b", false),
+            (_, b_f12::SEXT_H) => ("sext.h", false),
+            _ => return None,
+        },
+        (i_f3::SRL_SRA, false) => match (f6, imm12) {
+            (b_f7::F6_RORI, _) => ("rori", true),
+            (b_f7::F6_BCLRI_BEXTI, _) => ("bexti", true),
+            (_, b_f12::ORC_B) => ("orc.b", false),
+            (_, b_f12::REV8) => ("rev8", false),
+            _ => return None,
+        },
+        (i_f3::SLL, true) => match (f6, imm12) {
+            (b_f7::F6_SLLI_UW, _) => ("slli.uw", true),
+            (_, b_f12::CLZ) => ("clzw", false),
+            (_, b_f12::CTZ) => ("ctzw", false),
+            (_, b_f12::CPOP) => ("cpopw", false),
+            _ => return None,
+        },
+        (i_f3::SRL_SRA, true) if f7 == b_f7::ROTATE => ("roriw", true),
+        _ => return None,
+    })
+}
+
 /// Disassemble `OP_IMM` / `OP_IMM_32` (I-type immediate arithmetic).
 fn disasm_op_imm(rd: RegIdx, rs1: RegIdx, f3: u32, imm: i64, is_w: bool) -> String {
     let suffix = if is_w { "w" } else { "" };
     let shamt = imm & 0x3F;
+    if let Some((mn, has_shamt)) = bitmanip_imm_name(f3, imm as u32 & 0xFFF, is_w) {
+        return if has_shamt {
+            format!("{mn} {}, {}, {shamt}", xreg(rd), xreg(rs1))
+        } else {
+            format!("{mn} {}, {}", xreg(rd), xreg(rs1))
+        };
+    }
     let mn = match f3 {
         i_f3::ADD_SUB => "addi",
         i_f3::SLT => "slti",
@@ -412,6 +504,314 @@ fn disasm_system(inst: u32, rd: RegIdx, rs1: RegIdx, f3: u32) -> String {
     format!("{mn} {}, {csr:#05x}, {}", xreg(rd), xreg(rs1))
 }
 
+/// Returns the name of vector register `v<idx>`.
+fn vreg(idx: u32) -> String {
+    format!("v{idx}")
+}
+
+/// Mask operand suffix: `", v0.t"` when the instruction is masked (`vm=0`).
+const fn vmask(inst: u32) -> &'static str {
+    if (inst >> 25) & 1 == 0 { ", v0.t" } else { "" }
+}
+
+/// Formats a `vtype` immediate as `e<sew>, m<lmul>, t{a,u}, m{a,u}`.
+fn vtype_name(zimm: u64) -> String {
+    let vt = VType::decode(zimm);
+    if vt.vill {
+        return format!("{zimm:#x}");
+    }
+    let lmul = if vt.lmul_log2 >= 0 {
+        format!("m{}", 1 << vt.lmul_log2)
+    } else {
+        format!("mf{}", 1 << -vt.lmul_log2)
+    };
+    let ta = if vt.vta { "ta" } else { "tu" };
+    let ma = if vt.vma { "ma" } else { "mu" };
+    format!("e{}, {lmul}, {ta}, {ma}", vt.sew)
+}
+
+/// Disassemble a vector load or store (`LOAD-FP`/`STORE-FP` vector widths).
+fn disasm_vector_mem(inst: u32, is_load: bool) -> String {
+    let eew = v_op::width_bits(inst.funct3());
+    let nf = (inst >> 29) + 1;
+    let mop = (inst >> 26) & 0x3;
+    let umop = (inst >> 20) & 0x1F;
+    let vd = vreg((inst >> 7) & 0x1F);
+    let rs1 = xreg(inst.rs1());
+    let m = vmask(inst);
+    let (l, seg) =
+        (if is_load { "l" } else { "s" }, if nf > 1 { format!("seg{nf}") } else { String::new() });
+    match mop {
+        v_op::MOP_UNIT => match umop {
+            v_op::LUMOP_WHOLE_REG if is_load => format!("vl{nf}re{eew}.v {vd}, ({rs1})"),
+            v_op::LUMOP_WHOLE_REG => format!("vs{nf}r.v {vd}, ({rs1})"),
+            v_op::LUMOP_MASK => format!("v{l}m.v {vd}, ({rs1})"),
+            v_op::LUMOP_FAULT_FIRST if is_load => format!("vl{seg}e{eew}ff.v {vd}, ({rs1}){m}"),
+            v_op::LUMOP_UNIT => format!("v{l}{seg}e{eew}.v {vd}, ({rs1}){m}"),
+            _ => format!("unknown ({inst:#010x})"),
+        },
+        v_op::MOP_STRIDED => {
+            let seg = if nf > 1 { format!("sseg{nf}") } else { "se".to_string() };
+            let eew = if nf > 1 { format!("e{eew}") } else { eew.to_string() };
+            format!("v{l}{seg}{eew}.v {vd}, ({rs1}), {}{m}", xreg(inst.rs2()))
+        }
+        _ => {
+            let order = if mop == v_op::MOP_INDEXED_ORDERED { "o" } else { "u" };
+            let seg = if nf > 1 { format!("seg{nf}") } else { "x".to_string() };
+            format!("v{l}{order}{seg}ei{eew}.v {vd}, ({rs1}), {}{m}", vreg(umop))
+        }
+    }
+}
+
+/// Disassemble `OP-V` (vector configuration and arithmetic).
+fn disasm_op_v(inst: u32) -> String {
+    let f3 = inst.funct3();
+    let f6 = inst >> 26;
+    let vd = (inst >> 7) & 0x1F;
+    let vs1 = (inst >> 15) & 0x1F;
+    let vs2 = (inst >> 20) & 0x1F;
+    let m = vmask(inst);
+
+    if f3 == v_op::OPCFG {
+        let rd = xreg(inst.rd());
+        return if inst >> 31 == 0 {
+            format!(
+                "vsetvli {rd}, {}, {}",
+                xreg(inst.rs1()),
+                vtype_name(u64::from((inst >> 20) & 0x7FF))
+            )
+        } else if (inst >> 30) & 1 == 1 {
+            format!("vsetivli {rd}, {vs1}, {}", vtype_name(u64::from((inst >> 20) & 0x3FF)))
+        } else {
+            format!("vsetvl {rd}, {}, {}", xreg(inst.rs1()), xreg(inst.rs2()))
+        };
+    }
+
+    // Third operand by category: vector, scalar, or immediate.
+    let simm = ((vs1 as i32) << 27) >> 27;
+    let op1 = match f3 {
+        v_op::OPIVV | v_op::OPMVV | v_op::OPFVV => vreg(vs1),
+        v_op::OPIVX | v_op::OPMVX => xreg(inst.rs1()).to_string(),
+        v_op::OPFVF => freg(inst.rs1()).to_string(),
+        _ => simm.to_string(),
+    };
+    let sfx = match f3 {
+        v_op::OPIVV | v_op::OPMVV | v_op::OPFVV => "vv",
+        v_op::OPIVX | v_op::OPMVX => "vx",
+        v_op::OPFVF => "vf",
+        _ => "vi",
+    };
+    let (vd_s, vs2_s) = (vreg(vd), vreg(vs2));
+
+    let unary = |name: &str| format!("{name} {vd_s}, {vs2_s}{m}");
+    let name = match f3 {
+        v_op::OPIVV | v_op::OPIVX | v_op::OPIVI => match f6 {
+            v_f6::VADD => "vadd",
+            v_f6::VSUB => "vsub",
+            v_f6::VRSUB => "vrsub",
+            v_f6::VMINU => "vminu",
+            v_f6::VMIN => "vmin",
+            v_f6::VMAXU => "vmaxu",
+            v_f6::VMAX => "vmax",
+            v_f6::VAND => "vand",
+            v_f6::VOR => "vor",
+            v_f6::VXOR => "vxor",
+            v_f6::VRGATHER => "vrgather",
+            v_f6::VSLIDEUP => "vslideup",
+            v_f6::VSLIDEDOWN => "vslidedown",
+            v_f6::VADC => return format!("vadc.{sfx}m {vd_s}, {vs2_s}, {op1}, v0"),
+            v_f6::VMADC if m.is_empty() => return format!("vmadc.{sfx} {vd_s}, {vs2_s}, {op1}"),
+            v_f6::VMADC => return format!("vmadc.{sfx}m {vd_s}, {vs2_s}, {op1}, v0"),
+            v_f6::VSBC => return format!("vsbc.{sfx}m {vd_s}, {vs2_s}, {op1}, v0"),
+            v_f6::VMSBC if m.is_empty() => return format!("vmsbc.{sfx} {vd_s}, {vs2_s}, {op1}"),
+            v_f6::VMSBC => return format!("vmsbc.{sfx}m {vd_s}, {vs2_s}, {op1}, v0"),
+            v_f6::VMERGE if m.is_empty() => return format!("vmv.v.{} {vd_s}, {op1}", &sfx[1..]),
+            v_f6::VMERGE => return format!("vmerge.{sfx}m {vd_s}, {vs2_s}, {op1}, v0"),
+            v_f6::VMSEQ => "vmseq",
+            v_f6::VMSNE => "vmsne",
+            v_f6::VMSLTU => "vmsltu",
+            v_f6::VMSLT => "vmslt",
+            v_f6::VMSLEU => "vmsleu",
+            v_f6::VMSLE => "vmsle",
+            v_f6::VMSGTU => "vmsgtu",
+            v_f6::VMSGT => "vmsgt",
+            v_f6::VSADDU => "vsaddu",
+            v_f6::VSADD => "vsadd",
+            v_f6::VSSUBU => "vssubu",
+            v_f6::VSSUB => "vssub",
+            v_f6::VSLL => "vsll",
+            v_f6::VSMUL_VMVNR if f3 == v_op::OPIVI => {
+                return format!("vmv{}r.v {vd_s}, {vs2_s}", vs1 + 1);
+            }
+            v_f6::VSMUL_VMVNR => "vsmul",
+            v_f6::VSRL => "vsrl",
+            v_f6::VSRA => "vsra",
+            v_f6::VSSRL => "vssrl",
+            v_f6::VSSRA => "vssra",
+            v_f6::VNSRL => return format!("vnsrl.w{} {vd_s}, {vs2_s}, {op1}{m}", &sfx[1..]),
+            v_f6::VNSRA => return format!("vnsra.w{} {vd_s}, {vs2_s}, {op1}{m}", &sfx[1..]),
+            v_f6::VNCLIPU => return format!("vnclipu.w{} {vd_s}, {vs2_s}, {op1}{m}", &sfx[1..]),
+            v_f6::VNCLIP => return format!("vnclip.w{} {vd_s}, {vs2_s}, {op1}{m}", &sfx[1..]),
+            v_f6::VWREDSUMU => return format!("vwredsumu.vs {vd_s}, {vs2_s}, {op1}{m}"),
+            v_f6::VWREDSUM => return format!("vwredsum.vs {vd_s}, {vs2_s}, {op1}{m}"),
+            _ => return format!("unknown ({inst:#010x})"),
+        },
+        v_op::OPMVV | v_op::OPMVX => match f6 {
+            v_f6::VREDSUM..=v_f6::VREDMAX if f3 == v_op::OPMVV => {
+                let red = ["sum", "and", "or", "xor", "minu", "min", "maxu", "max"][f6 as usize];
+                return format!("vred{red}.vs {vd_s}, {vs2_s}, {op1}{m}");
+            }
+            v_f6::VAADDU => "vaaddu",
+            v_f6::VAADD => "vaadd",
+            v_f6::VASUBU => "vasubu",
+            v_f6::VASUB => "vasub",
+            v_f6::VSLIDE1UP if f3 == v_op::OPMVX => "vslide1up",
+            v_f6::VSLIDE1DOWN if f3 == v_op::OPMVX => "vslide1down",
+            v_f6::VWXUNARY0 if f3 == v_op::OPMVX => return format!("vmv.s.x {vd_s}, {op1}"),
+            v_f6::VWXUNARY0 => {
+                let rd = xreg(inst.rd());
+                return match vs1 {
+                    0b00000 => format!("vmv.x.s {rd}, {vs2_s}"),
+                    0b10000 => format!("vcpop.m {rd}, {vs2_s}{m}"),
+                    0b10001 => format!("vfirst.m {rd}, {vs2_s}{m}"),
+                    _ => format!("unknown ({inst:#010x})"),
+                };
+            }
+            v_f6::VXUNARY0 if f3 == v_op::OPMVV => {
+                let ext = if vs1 & 1 == 0 { "vzext" } else { "vsext" };
+                return match vs1 >> 1 {
+                    1 => unary(&format!("{ext}.vf8")),
+                    2 => unary(&format!("{ext}.vf4")),
+                    3 => unary(&format!("{ext}.vf2")),
+                    _ => format!("unknown ({inst:#010x})"),
+                };
+            }
+            v_f6::VMUNARY0 if f3 == v_op::OPMVV => {
+                return match vs1 {
+                    0b00001 => unary("vmsbf.m"),
+                    0b00010 => unary("vmsof.m"),
+                    0b00011 => unary("vmsif.m"),
+                    0b10000 => unary("viota.m"),
+                    0b10001 => format!("vid.v {vd_s}{m}"),
+                    _ => format!("unknown ({inst:#010x})"),
+                };
+            }
+            v_f6::VCOMPRESS if f3 == v_op::OPMVV => {
+                return format!("vcompress.vm {vd_s}, {vs2_s}, {op1}");
+            }
+            v_f6::VMANDN..=v_f6::VMXNOR if f3 == v_op::OPMVV => {
+                let op = ["andn", "and", "or", "xor", "orn", "nand", "nor", "xnor"]
+                    [(f6 - v_f6::VMANDN) as usize];
+                return format!("vm{op}.mm {vd_s}, {vs2_s}, {op1}");
+            }
+            v_f6::VDIVU => "vdivu",
+            v_f6::VDIV => "vdiv",
+            v_f6::VREMU => "vremu",
+            v_f6::VREM => "vrem",
+            v_f6::VMULHU => "vmulhu",
+            v_f6::VMUL => "vmul",
+            v_f6::VMULHSU => "vmulhsu",
+            v_f6::VMULH => "vmulh",
+            v_f6::VMADD | v_f6::VNMSUB | v_f6::VMACC | v_f6::VNMSAC => {
+                let mn = match f6 {
+                    v_f6::VMADD => "vmadd",
+                    v_f6::VNMSUB => "vnmsub",
+                    v_f6::VMACC => "vmacc",
+                    _ => "vnmsac",
+                };
+                return format!("{mn}.{sfx} {vd_s}, {op1}, {vs2_s}{m}");
+            }
+            v_f6::VWADDU => "vwaddu",
+            v_f6::VWADD => "vwadd",
+            v_f6::VWSUBU => "vwsubu",
+            v_f6::VWSUB => "vwsub",
+            v_f6::VWADDU_W..=v_f6::VWSUB_W => {
+                let op = ["vwaddu", "vwadd", "vwsubu", "vwsub"][(f6 - v_f6::VWADDU_W) as usize];
+                return format!("{op}.w{} {vd_s}, {vs2_s}, {op1}{m}", &sfx[1..]);
+            }
+            v_f6::VWMULU => "vwmulu",
+            v_f6::VWMULSU => "vwmulsu",
+            v_f6::VWMUL => "vwmul",
+            v_f6::VWMACCU | v_f6::VWMACC | v_f6::VWMACCUS | v_f6::VWMACCSU => {
+                let mn = match f6 {
+                    v_f6::VWMACCU => "vwmaccu",
+                    v_f6::VWMACC => "vwmacc",
+                    v_f6::VWMACCUS => "vwmaccus",
+                    _ => "vwmaccsu",
+                };
+                return format!("{mn}.{sfx} {vd_s}, {op1}, {vs2_s}{m}");
+            }
+            _ => return format!("unknown ({inst:#010x})"),
+        },
+        _ => match f6 {
+            v_f6::VFADD => "vfadd",
+            v_f6::VFSUB => "vfsub",
+            v_f6::VFMIN => "vfmin",
+            v_f6::VFMAX => "vfmax",
+            v_f6::VFREDUSUM | v_f6::VFREDOSUM | v_f6::VFREDMIN | v_f6::VFREDMAX
+                if f3 == v_op::OPFVV =>
+            {
+                let red = ["", "usum", "", "osum", "", "min", "", "max"][f6 as usize];
+                return format!("vfred{red}.vs {vd_s}, {vs2_s}, {op1}{m}");
+            }
+            v_f6::VFSGNJ => "vfsgnj",
+            v_f6::VFSGNJN => "vfsgnjn",
+            v_f6::VFSGNJX => "vfsgnjx",
+            v_f6::VFSLIDE1UP if f3 == v_op::OPFVF => "vfslide1up",
+            v_f6::VFSLIDE1DOWN if f3 == v_op::OPFVF => "vfslide1down",
+            v_f6::VWFUNARY0 if f3 == v_op::OPFVF => return format!("vfmv.s.f {vd_s}, {op1}"),
+            v_f6::VWFUNARY0 if vs1 == 0 => {
+                return format!("vfmv.f.s {}, {vs2_s}", freg(inst.rd()));
+            }
+            v_f6::VFUNARY0 if f3 == v_op::OPFVV => {
+                return match vs1 {
+                    0b00000 => unary("vfcvt.xu.f.v"),
+                    0b00001 => unary("vfcvt.x.f.v"),
+                    0b00010 => unary("vfcvt.f.xu.v"),
+                    0b00011 => unary("vfcvt.f.x.v"),
+                    0b00110 => unary("vfcvt.rtz.xu.f.v"),
+                    0b00111 => unary("vfcvt.rtz.x.f.v"),
+                    _ => format!("unknown ({inst:#010x})"),
+                };
+            }
+            v_f6::VFUNARY1 if f3 == v_op::OPFVV => {
+                return match vs1 {
+                    0b00000 => unary("vfsqrt.v"),
+                    0b00100 => unary("vfrsqrt7.v"),
+                    0b00101 => unary("vfrec7.v"),
+                    0b10000 => unary("vfclass.v"),
+                    _ => format!("unknown ({inst:#010x})"),
+                };
+            }
+            v_f6::VFMERGE if f3 == v_op::OPFVF && m.is_empty() => {
+                return format!("vfmv.v.f {vd_s}, {op1}");
+            }
+            v_f6::VFMERGE if f3 == v_op::OPFVF => {
+                return format!("vfmerge.vfm {vd_s}, {vs2_s}, {op1}, v0");
+            }
+            v_f6::VMFEQ => "vmfeq",
+            v_f6::VMFLE => "vmfle",
+            v_f6::VMFLT => "vmflt",
+            v_f6::VMFNE => "vmfne",
+            v_f6::VMFGT if f3 == v_op::OPFVF => "vmfgt",
+            v_f6::VMFGE if f3 == v_op::OPFVF => "vmfge",
+            v_f6::VFDIV => "vfdiv",
+            v_f6::VFRDIV if f3 == v_op::OPFVF => "vfrdiv",
+            v_f6::VFMUL => "vfmul",
+            v_f6::VFRSUB if f3 == v_op::OPFVF => "vfrsub",
+            v_f6::VFMADD..=v_f6::VFNMSAC => {
+                let mn = [
+                    "vfmadd", "vfnmadd", "vfmsub", "vfnmsub", "vfmacc", "vfnmacc", "vfmsac",
+                    "vfnmsac",
+                ][(f6 - v_f6::VFMADD) as usize];
+                return format!("{mn}.{sfx} {vd_s}, {op1}, {vs2_s}{m}");
+            }
+            _ => return format!("unknown ({inst:#010x})"),
+        },
+    };
+    format!("{name}.{sfx} {vd_s}, {vs2_s}, {op1}{m}")
+}
+
 /// Determine FMA precision suffix from the format field (bits 26:25).
 #[allow(clippy::verbose_bit_mask)]
 const fn fp_precision(f7: u32) -> &'static str {
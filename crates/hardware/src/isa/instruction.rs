@@ -151,7 +151,7 @@ impl InstructionBits for u32 {
 ///
 /// Contains all instruction fields extracted during decoding, including
 /// opcode, register indices, function codes, and sign-extended immediate.
-#[derive(Clone, Debug, Default)]
+#[derive(Clone, Copy, Debug, Default)]
 pub struct Decoded {
     /// Raw 32-bit instruction encoding.
     pub raw: u32,
@@ -10,7 +10,9 @@
 //! * `rv64a`: Standard Extension for Atomic Instructions.
 //! * `rv64f`: Standard Extension for Single-Precision Floating-Point.
 //! * `rv64d`: Standard Extension for Double-Precision Floating-Point.
+//! * `rvb`: Bit-Manipulation Extensions (Zba, Zbb, Zbs).
 //! * `rvc`: Standard Extension for Compressed Instructions.
+//! * `rvv`: Standard Extension for Vector Operations.
 //! * `privileged`: Privileged Architecture (CSRs, Traps).
 
 /// Application Binary Interface (ABI) register name mappings.
@@ -43,5 +45,11 @@ pub mod rv64i;
 /// Integer multiply/divide extension (MUL, DIV, REM instructions).
 pub mod rv64m;
 
+/// Bit-manipulation extensions (address generation, basic bit ops, single-bit ops).
+pub mod rvb;
+
 /// Compressed instruction extension (16-bit instruction encoding).
 pub mod rvc;
+
+/// Vector extension (configuration, arithmetic, and vector memory operations).
+pub mod rvv;
@@ -0,0 +1,25 @@
+//! RISC-V Bit-Manipulation Unary Encodings (imm[11:0]).
+//!
+//! The unary Zbb operations take a single source register; the whole
+//! I-type immediate field identifies the operation.
+
+/// Count leading zeros (`clz`, `clzw`).
+pub const CLZ: u32 = 0x600;
+
+/// Count trailing zeros (`ctz`, `ctzw`).
+pub const CTZ: u32 = 0x601;
+
+/// Count set bits (`cpop`, `cpopw`).
+pub const CPOP: u32 = 0x602;
+
+/// Sign-extend byte (`sext.b`).
+pub const SEXT_B: u32 = 0x604;
+
+/// Sign-extend halfword (`sext.h`).
+pub const SEXT_H: u32 = 0x605;
+
+/// Bitwise OR-combine within each byte (`orc.b`).
+pub const ORC_B: u32 = 0x287;
+
+/// Byte-reverse the full 64-bit register (`rev8`, RV64 encoding).
+pub const REV8: u32 = 0x6B8;
@@ -0,0 +1,54 @@
+//! RISC-V Bit-Manipulation Function Codes (funct7 / funct6).
+//!
+//! Register-register forms are selected by `funct7` together with `funct3`.
+//! On RV64 the shift-immediate forms (`bseti`, `rori`, `slli.uw`, ...) use a
+//! 6-bit shift amount, leaving `funct6` (bits 31-26) as the selector.
+
+/// Zba shift-and-add: `sh1add` (funct3 `010`), `sh2add` (`100`), `sh3add` (`110`),
+/// and their `.uw` forms under `OP_REG_32`.
+pub const SHADD: u32 = 0b0010000;
+
+/// Zba `add.uw` (`OP_REG_32`, funct3 `000`); also Zbb `zext.h` (`OP_REG_32`,
+/// funct3 `100`, rs2 = 0).
+pub const ADD_UW: u32 = 0b0000100;
+
+/// Zbb logical-with-negate: `andn` (funct3 `111`), `orn` (`110`), `xnor` (`100`).
+pub const NEGATE: u32 = 0b0100000;
+
+/// Zbb integer minimum/maximum: `min` (`100`), `minu` (`101`), `max` (`110`),
+/// `maxu` (`111`).
+pub const MINMAX: u32 = 0b0000101;
+
+/// Zbb rotates `rol` (`001`) and `ror` (`101`); with funct3 `001` under
+/// `OP_IMM`, the count/sign-extend group selected by the rs2 field.
+pub const ROTATE: u32 = 0b0110000;
+
+/// Zbs `bset` (funct3 `001`).
+pub const BSET: u32 = 0b0010100;
+
+/// Zbs `bclr` (funct3 `001`) and `bext` (funct3 `101`).
+pub const BCLR_BEXT: u32 = 0b0100100;
+
+/// Zbs `binv` (funct3 `001`).
+pub const BINV: u32 = 0b0110100;
+
+/// Base `slli`/`srli` shift-immediate selector (funct6).
+pub const F6_SHIFT: u32 = 0b000000;
+
+/// Base `srai` selector (funct6).
+pub const F6_SRAI: u32 = 0b010000;
+
+/// Zba `slli.uw` selector (funct6, `OP_IMM_32`).
+pub const F6_SLLI_UW: u32 = 0b000010;
+
+/// Zbb `rori` selector (funct6).
+pub const F6_RORI: u32 = 0b011000;
+
+/// Zbs `bseti` selector (funct6).
+pub const F6_BSETI: u32 = 0b001010;
+
+/// Zbs `bclri` and `bexti` selector (funct6).
+pub const F6_BCLRI_BEXTI: u32 = 0b010010;
+
+/// Zbs `binvi` selector (funct6).
+pub const F6_BINVI: u32 = 0b011010;
@@ -0,0 +1,17 @@
+//! RISC-V Bit-Manipulation Extensions (Zba, Zbb, Zbs).
+//!
+//! The bit-manipulation instructions share the `OP_REG`, `OP_REG_32`,
+//! `OP_IMM`, and `OP_IMM_32` opcodes with the base integer set and are
+//! distinguished by `funct7` (register forms), `funct6` (shift-immediate
+//! forms), or the full 12-bit immediate (unary forms).
+//!
+//! # Structure
+//!
+//! - `funct7`: Selectors for register-register and shift-immediate forms.
+//! - `funct12`: Immediate encodings of the unary operations (`clz`, `rev8`, ...).
+
+/// Function code 7 (and 6) definitions for bit-manipulation operations.
+pub mod funct7;
+
+/// Immediate-field encodings of the unary bit-manipulation operations.
+pub mod funct12;
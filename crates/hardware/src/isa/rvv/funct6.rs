@@ -0,0 +1,277 @@
+//! RISC-V Vector (V) Function Codes (funct6).
+//!
+//! The `funct6` field (bits 31-26) selects the operation within an `OP-V`
+//! operand category (`funct3`). Codes are grouped by the categories that
+//! define them: integer (`OPIVV`/`OPIVX`/`OPIVI`), mask/multiply
+//! (`OPMVV`/`OPMVX`), and floating-point (`OPFVV`/`OPFVF`).
+
+// ── Integer (OPI) ────────────────────────────────────────
+
+/// Vector add.
+pub const VADD: u32 = 0b000000;
+/// Vector subtract.
+pub const VSUB: u32 = 0b000010;
+/// Vector reverse subtract (scalar - element).
+pub const VRSUB: u32 = 0b000011;
+/// Vector unsigned minimum.
+pub const VMINU: u32 = 0b000100;
+/// Vector signed minimum.
+pub const VMIN: u32 = 0b000101;
+/// Vector unsigned maximum.
+pub const VMAXU: u32 = 0b000110;
+/// Vector signed maximum.
+pub const VMAX: u32 = 0b000111;
+/// Vector bitwise AND.
+pub const VAND: u32 = 0b001001;
+/// Vector bitwise OR.
+pub const VOR: u32 = 0b001010;
+/// Vector bitwise XOR.
+pub const VXOR: u32 = 0b001011;
+/// Vector register gather.
+pub const VRGATHER: u32 = 0b001100;
+/// Vector slide up.
+pub const VSLIDEUP: u32 = 0b001110;
+/// Vector slide down.
+pub const VSLIDEDOWN: u32 = 0b001111;
+/// Vector add with carry.
+pub const VADC: u32 = 0b010000;
+/// Vector add carry-out (mask result).
+pub const VMADC: u32 = 0b010001;
+/// Vector subtract with borrow.
+pub const VSBC: u32 = 0b010010;
+/// Vector subtract borrow-out (mask result).
+pub const VMSBC: u32 = 0b010011;
+/// Vector merge (`vm=0`) or move (`vmv.v.*`, `vm=1`).
+pub const VMERGE: u32 = 0b010111;
+/// Set mask if equal.
+pub const VMSEQ: u32 = 0b011000;
+/// Set mask if not equal.
+pub const VMSNE: u32 = 0b011001;
+/// Set mask if less than, unsigned.
+pub const VMSLTU: u32 = 0b011010;
+/// Set mask if less than, signed.
+pub const VMSLT: u32 = 0b011011;
+/// Set mask if less than or equal, unsigned.
+pub const VMSLEU: u32 = 0b011100;
+/// Set mask if less than or equal, signed.
+pub const VMSLE: u32 = 0b011101;
+/// Set mask if greater than, unsigned (`.vx`/`.vi` only).
+pub const VMSGTU: u32 = 0b011110;
+/// Set mask if greater than, signed (`.vx`/`.vi` only).
+pub const VMSGT: u32 = 0b011111;
+/// Saturating add, unsigned.
+pub const VSADDU: u32 = 0b100000;
+/// Saturating add, signed.
+pub const VSADD: u32 = 0b100001;
+/// Saturating subtract, unsigned.
+pub const VSSUBU: u32 = 0b100010;
+/// Saturating subtract, signed.
+pub const VSSUB: u32 = 0b100011;
+/// Shift left logical.
+pub const VSLL: u32 = 0b100101;
+/// Fractional multiply with rounding and saturation (`.vv`/`.vx`), or
+/// whole-register move `vmv<nr>r.v` (`.vi`).
+pub const VSMUL_VMVNR: u32 = 0b100111;
+/// Shift right logical.
+pub const VSRL: u32 = 0b101000;
+/// Shift right arithmetic.
+pub const VSRA: u32 = 0b101001;
+/// Scaling shift right logical (with rounding).
+pub const VSSRL: u32 = 0b101010;
+/// Scaling shift right arithmetic (with rounding).
+pub const VSSRA: u32 = 0b101011;
+/// Narrowing shift right logical.
+pub const VNSRL: u32 = 0b101100;
+/// Narrowing shift right arithmetic.
+pub const VNSRA: u32 = 0b101101;
+/// Narrowing clip, unsigned.
+pub const VNCLIPU: u32 = 0b101110;
+/// Narrowing clip, signed.
+pub const VNCLIP: u32 = 0b101111;
+/// Widening sum reduction, unsigned.
+pub const VWREDSUMU: u32 = 0b110000;
+/// Widening sum reduction, signed.
+pub const VWREDSUM: u32 = 0b110001;
+
+// ── Mask / multiply (OPM) ────────────────────────────────
+
+/// Sum reduction.
+pub const VREDSUM: u32 = 0b000000;
+/// AND reduction.
+pub const VREDAND: u32 = 0b000001;
+/// OR reduction.
+pub const VREDOR: u32 = 0b000010;
+/// XOR reduction.
+pub const VREDXOR: u32 = 0b000011;
+/// Unsigned minimum reduction.
+pub const VREDMINU: u32 = 0b000100;
+/// Signed minimum reduction.
+pub const VREDMIN: u32 = 0b000101;
+/// Unsigned maximum reduction.
+pub const VREDMAXU: u32 = 0b000110;
+/// Signed maximum reduction.
+pub const VREDMAX: u32 = 0b000111;
+/// Averaging add, unsigned.
+pub const VAADDU: u32 = 0b001000;
+/// Averaging add, signed.
+pub const VAADD: u32 = 0b001001;
+/// Averaging subtract, unsigned.
+pub const VASUBU: u32 = 0b001010;
+/// Averaging subtract, signed.
+pub const VASUB: u32 = 0b001011;
+/// Slide up by one, inserting a scalar at element 0.
+pub const VSLIDE1UP: u32 = 0b001110;
+/// Slide down by one, inserting a scalar at element `vl-1`.
+pub const VSLIDE1DOWN: u32 = 0b001111;
+/// Integer scalar moves and mask queries (`vmv.x.s`, `vcpop.m`,
+/// `vfirst.m` as `.vv`; `vmv.s.x` as `.vx`).
+pub const VWXUNARY0: u32 = 0b010000;
+/// Integer extension (`vzext.vf*`, `vsext.vf*`).
+pub const VXUNARY0: u32 = 0b010010;
+/// Mask-set and index operations (`vmsbf`, `vmsof`, `vmsif`, `viota`, `vid`).
+pub const VMUNARY0: u32 = 0b010100;
+/// Compress active elements.
+pub const VCOMPRESS: u32 = 0b010111;
+/// Mask AND-NOT.
+pub const VMANDN: u32 = 0b011000;
+/// Mask AND.
+pub const VMAND: u32 = 0b011001;
+/// Mask OR.
+pub const VMOR: u32 = 0b011010;
+/// Mask XOR.
+pub const VMXOR: u32 = 0b011011;
+/// Mask OR-NOT.
+pub const VMORN: u32 = 0b011100;
+/// Mask NAND.
+pub const VMNAND: u32 = 0b011101;
+/// Mask NOR.
+pub const VMNOR: u32 = 0b011110;
+/// Mask XNOR.
+pub const VMXNOR: u32 = 0b011111;
+/// Divide, unsigned.
+pub const VDIVU: u32 = 0b100000;
+/// Divide, signed.
+pub const VDIV: u32 = 0b100001;
+/// Remainder, unsigned.
+pub const VREMU: u32 = 0b100010;
+/// Remainder, signed.
+pub const VREM: u32 = 0b100011;
+/// Multiply high, unsigned.
+pub const VMULHU: u32 = 0b100100;
+/// Multiply low.
+pub const VMUL: u32 = 0b100101;
+/// Multiply high, signed × unsigned.
+pub const VMULHSU: u32 = 0b100110;
+/// Multiply high, signed.
+pub const VMULH: u32 = 0b100111;
+/// Multiply-add, overwriting the multiplicand (`vd = vs1*vd + vs2`).
+pub const VMADD: u32 = 0b101001;
+/// Negated multiply-subtract, overwriting the multiplicand (`vd = -(vs1*vd) + vs2`).
+pub const VNMSUB: u32 = 0b101011;
+/// Multiply-accumulate (`vd = vs1*vs2 + vd`).
+pub const VMACC: u32 = 0b101101;
+/// Negated multiply-subtract-accumulate (`vd = -(vs1*vs2) + vd`).
+pub const VNMSAC: u32 = 0b101111;
+/// Widening add, unsigned.
+pub const VWADDU: u32 = 0b110000;
+/// Widening add, signed.
+pub const VWADD: u32 = 0b110001;
+/// Widening subtract, unsigned.
+pub const VWSUBU: u32 = 0b110010;
+/// Widening subtract, signed.
+pub const VWSUB: u32 = 0b110011;
+/// Widening add, unsigned, wide first operand (`.wv`/`.wx`).
+pub const VWADDU_W: u32 = 0b110100;
+/// Widening add, signed, wide first operand.
+pub const VWADD_W: u32 = 0b110101;
+/// Widening subtract, unsigned, wide first operand.
+pub const VWSUBU_W: u32 = 0b110110;
+/// Widening subtract, signed, wide first operand.
+pub const VWSUB_W: u32 = 0b110111;
+/// Widening multiply, unsigned.
+pub const VWMULU: u32 = 0b111000;
+/// Widening multiply, signed × unsigned.
+pub const VWMULSU: u32 = 0b111010;
+/// Widening multiply, signed.
+pub const VWMUL: u32 = 0b111011;
+/// Widening multiply-accumulate, unsigned.
+pub const VWMACCU: u32 = 0b111100;
+/// Widening multiply-accumulate, signed.
+pub const VWMACC: u32 = 0b111101;
+/// Widening multiply-accumulate, unsigned scalar × signed vector (`.vx` only).
+pub const VWMACCUS: u32 = 0b111110;
+/// Widening multiply-accumulate, signed × unsigned.
+pub const VWMACCSU: u32 = 0b111111;
+
+// ── Floating-point (OPF) ─────────────────────────────────
+
+/// Floating-point add.
+pub const VFADD: u32 = 0b000000;
+/// Floating-point unordered sum reduction.
+pub const VFREDUSUM: u32 = 0b000001;
+/// Floating-point subtract.
+pub const VFSUB: u32 = 0b000010;
+/// Floating-point ordered sum reduction.
+pub const VFREDOSUM: u32 = 0b000011;
+/// Floating-point minimum.
+pub const VFMIN: u32 = 0b000100;
+/// Floating-point minimum reduction.
+pub const VFREDMIN: u32 = 0b000101;
+/// Floating-point maximum.
+pub const VFMAX: u32 = 0b000110;
+/// Floating-point maximum reduction.
+pub const VFREDMAX: u32 = 0b000111;
+/// Floating-point sign injection.
+pub const VFSGNJ: u32 = 0b001000;
+/// Floating-point negated sign injection.
+pub const VFSGNJN: u32 = 0b001001;
+/// Floating-point XOR sign injection.
+pub const VFSGNJX: u32 = 0b001010;
+/// Floating-point slide up by one, inserting `rs1` at element 0.
+pub const VFSLIDE1UP: u32 = 0b001110;
+/// Floating-point slide down by one, inserting `rs1` at element `vl-1`.
+pub const VFSLIDE1DOWN: u32 = 0b001111;
+/// Floating-point scalar moves (`vfmv.f.s` as `.vv`, `vfmv.s.f` as `.vf`).
+pub const VWFUNARY0: u32 = 0b010000;
+/// Floating-point conversions (`vfcvt.*`).
+pub const VFUNARY0: u32 = 0b010010;
+/// Floating-point unary operations (`vfsqrt`, `vfclass`, estimates).
+pub const VFUNARY1: u32 = 0b010011;
+/// Floating-point merge (`vm=0`) or splat (`vfmv.v.f`, `vm=1`).
+pub const VFMERGE: u32 = 0b010111;
+/// Set mask if floating-point equal.
+pub const VMFEQ: u32 = 0b011000;
+/// Set mask if floating-point less than or equal.
+pub const VMFLE: u32 = 0b011001;
+/// Set mask if floating-point less than.
+pub const VMFLT: u32 = 0b011011;
+/// Set mask if floating-point not equal.
+pub const VMFNE: u32 = 0b011100;
+/// Set mask if floating-point greater than (`.vf` only).
+pub const VMFGT: u32 = 0b011101;
+/// Set mask if floating-point greater than or equal (`.vf` only).
+pub const VMFGE: u32 = 0b011111;
+/// Floating-point divide.
+pub const VFDIV: u32 = 0b100000;
+/// Floating-point reverse divide (`.vf` only).
+pub const VFRDIV: u32 = 0b100001;
+/// Floating-point multiply.
+pub const VFMUL: u32 = 0b100100;
+/// Floating-point reverse subtract (`.vf` only).
+pub const VFRSUB: u32 = 0b100111;
+/// Fused multiply-add, overwriting the multiplicand (`vd = +(vs1*vd) + vs2`).
+pub const VFMADD: u32 = 0b101000;
+/// Fused negated multiply-add, overwriting the multiplicand (`vd = -(vs1*vd) - vs2`).
+pub const VFNMADD: u32 = 0b101001;
+/// Fused multiply-subtract, overwriting the multiplicand (`vd = +(vs1*vd) - vs2`).
+pub const VFMSUB: u32 = 0b101010;
+/// Fused negated multiply-subtract, overwriting the multiplicand (`vd = -(vs1*vd) + vs2`).
+pub const VFNMSUB: u32 = 0b101011;
+/// Fused multiply-accumulate (`vd = +(vs1*vs2) + vd`).
+pub const VFMACC: u32 = 0b101100;
+/// Fused negated multiply-accumulate (`vd = -(vs1*vs2) - vd`).
+pub const VFNMACC: u32 = 0b101101;
+/// Fused multiply-subtract-accumulate (`vd = +(vs1*vs2) - vd`).
+pub const VFMSAC: u32 = 0b101110;
+/// Fused negated multiply-subtract-accumulate (`vd = -(vs1*vs2) + vd`).
+pub const VFNMSAC: u32 = 0b101111;
@@ -0,0 +1,19 @@
+//! RISC-V Vector Extension (V, version 1.0).
+//!
+//! Defines the encodings of the vector configuration, arithmetic, and memory
+//! instructions, and the `vtype` register format.
+//!
+//! # Structure
+//!
+//! - `opcodes`: Major opcode, `funct3` operand categories, and memory fields.
+//! - `funct6`: Function codes for vector arithmetic operations.
+//! - `vtype`: Decoding of `vtype` (SEW, LMUL, policy bits) and `VLMAX`.
+
+/// Function code 6 definitions for vector arithmetic operations.
+pub mod funct6;
+
+/// Vector opcodes, operand categories, and memory addressing fields.
+pub mod opcodes;
+
+/// Vector type register (`vtype`) decoding.
+pub mod vtype;
@@ -0,0 +1,68 @@
+//! RISC-V Vector (V) Opcodes and Encoding Fields.
+//!
+//! Vector arithmetic and configuration instructions share the `OP-V` major
+//! opcode and are split into operand categories by `funct3`. Vector loads and
+//! stores reuse the `LOAD-FP`/`STORE-FP` opcodes with element-width encodings
+//! that the scalar F/D extensions leave unused.
+
+/// Vector arithmetic and configuration (`OP-V`).
+pub const OP_V: u32 = 0b1010111;
+
+/// Integer vector-vector (`.vv`).
+pub const OPIVV: u32 = 0b000;
+/// Floating-point vector-vector (`.vv`).
+pub const OPFVV: u32 = 0b001;
+/// Mask/multiply vector-vector (`.vv`, `.mm`).
+pub const OPMVV: u32 = 0b010;
+/// Integer vector-immediate (`.vi`).
+pub const OPIVI: u32 = 0b011;
+/// Integer vector-scalar (`.vx`).
+pub const OPIVX: u32 = 0b100;
+/// Floating-point vector-scalar (`.vf`).
+pub const OPFVF: u32 = 0b101;
+/// Mask/multiply vector-scalar (`.vx`).
+pub const OPMVX: u32 = 0b110;
+/// Configuration (`vsetvli`, `vsetivli`, `vsetvl`).
+pub const OPCFG: u32 = 0b111;
+
+/// Memory element width: 8-bit (`funct3` of a vector load/store).
+pub const WIDTH_E8: u32 = 0b000;
+/// Memory element width: 16-bit.
+pub const WIDTH_E16: u32 = 0b101;
+/// Memory element width: 32-bit.
+pub const WIDTH_E32: u32 = 0b110;
+/// Memory element width: 64-bit.
+pub const WIDTH_E64: u32 = 0b111;
+
+/// Addressing mode (`mop`, bits 27-26): unit-stride.
+pub const MOP_UNIT: u32 = 0b00;
+/// Addressing mode: indexed, unordered.
+pub const MOP_INDEXED_UNORDERED: u32 = 0b01;
+/// Addressing mode: strided.
+pub const MOP_STRIDED: u32 = 0b10;
+/// Addressing mode: indexed, ordered.
+pub const MOP_INDEXED_ORDERED: u32 = 0b11;
+
+/// Unit-stride variant (`lumop`/`sumop`, bits 24-20): regular access.
+pub const LUMOP_UNIT: u32 = 0b00000;
+/// Unit-stride variant: whole-register access (`vl<nf>r`, `vs<nf>r`).
+pub const LUMOP_WHOLE_REG: u32 = 0b01000;
+/// Unit-stride variant: mask access (`vlm.v`, `vsm.v`).
+pub const LUMOP_MASK: u32 = 0b01011;
+/// Unit-stride variant: fault-only-first load (`vle<eew>ff.v`).
+pub const LUMOP_FAULT_FIRST: u32 = 0b10000;
+
+/// Returns true if a `LOAD-FP`/`STORE-FP` `funct3` selects a vector access.
+pub const fn is_vector_width(funct3: u32) -> bool {
+    matches!(funct3, WIDTH_E8 | WIDTH_E16 | WIDTH_E32 | WIDTH_E64)
+}
+
+/// Returns the element width in bits of a vector memory `funct3`.
+pub const fn width_bits(funct3: u32) -> u32 {
+    match funct3 {
+        WIDTH_E16 => 16,
+        WIDTH_E32 => 32,
+        WIDTH_E64 => 64,
+        _ => 8,
+    }
+}
@@ -0,0 +1,160 @@
+//! Vector Type Register (`vtype`).
+//!
+//! `vtype` holds the selected element width (SEW), the register group
+//! multiplier (LMUL), and the tail/mask agnostic policy bits. A value the
+//! implementation does not support sets `vill` instead, and every vector
+//! instruction other than `vset{i}vl{i}` then raises an illegal-instruction
+//! exception. This module decodes `vtype` and derives `VLMAX` for a given
+//! `VLEN`; it has no knowledge of the register file.
+
+/// Maximum element width supported (ELEN), in bits.
+pub const ELEN: u32 = 64;
+
+/// The `vill` bit (XLEN-1).
+pub const VILL: u64 = 1 << 63;
+
+/// Bits of `vtype` that hold defined fields (`vlmul`, `vsew`, `vta`, `vma`).
+const FIELD_MASK: u64 = 0xFF;
+
+/// Decoded `vtype` value.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub struct VType {
+    /// Selected element width in bits (8, 16, 32, or 64).
+    pub sew: u32,
+    /// Register group multiplier as a power of two (-3 for 1/8 up to 3 for 8).
+    pub lmul_log2: i32,
+    /// Tail agnostic.
+    pub vta: bool,
+    /// Mask agnostic.
+    pub vma: bool,
+    /// Unsupported configuration; vector instructions are illegal.
+    pub vill: bool,
+}
+
+impl Default for VType {
+    /// `vtype` out of reset: `vill` set.
+    fn default() -> Self {
+        Self::ILLEGAL
+    }
+}
+
+impl VType {
+    /// The `vill` configuration.
+    pub const ILLEGAL: Self = Self { sew: 8, lmul_log2: 0, vta: false, vma: false, vill: true };
+
+    /// Decodes a `vtype` value, mapping reserved or unsupported encodings
+    /// (nonzero reserved bits, `vsew` > e64, `vlmul` = 4, or SEW > LMUL·ELEN)
+    /// to [`Self::ILLEGAL`].
+    pub const fn decode(bits: u64) -> Self {
+        if bits & !FIELD_MASK != 0 {
+            return Self::ILLEGAL;
+        }
+        let vsew = ((bits >> 3) & 0x7) as u32;
+        let lmul_log2 = match bits & 0x7 {
+            0 => 0,
+            1 => 1,
+            2 => 2,
+            3 => 3,
+            5 => -3,
+            6 => -2,
+            7 => -1,
+            _ => return Self::ILLEGAL,
+        };
+        if vsew > 3 {
+            return Self::ILLEGAL;
+        }
+        let sew = 8 << vsew;
+        if lmul_log2 < 0 && sew > ELEN >> -lmul_log2 {
+            return Self::ILLEGAL;
+        }
+        Self { sew, lmul_log2, vta: bits & 0x40 != 0, vma: bits & 0x80 != 0, vill: false }
+    }
+
+    /// Encodes back to the architectural `vtype` value.
+    pub const fn bits(self) -> u64 {
+        if self.vill {
+            return VILL;
+        }
+        let vlmul = (self.lmul_log2 & 0x7) as u64;
+        let vsew = self.sew.trailing_zeros() as u64 - 3;
+        vlmul | (vsew << 3) | ((self.vta as u64) << 6) | ((self.vma as u64) << 7)
+    }
+
+    /// Maximum vector length (`LMUL · VLEN / SEW`) for `vlen` bits per register.
+    pub const fn vlmax(self, vlen: u64) -> u64 {
+        if self.vill {
+            return 0;
+        }
+        let per_reg = vlen / self.sew as u64;
+        if self.lmul_log2 >= 0 { per_reg << self.lmul_log2 } else { per_reg >> -self.lmul_log2 }
+    }
+
+    /// Number of registers in a group of `eew`-bit elements (EMUL, at least 1).
+    ///
+    /// Returns `None` if EMUL = `eew`/SEW · LMUL falls outside 1/8 ..= 8.
+    pub const fn group_regs(self, eew: u32) -> Option<usize> {
+        let emul_log2 =
+            self.lmul_log2 + eew.trailing_zeros() as i32 - self.sew.trailing_zeros() as i32;
+        if emul_log2 < -3 || emul_log2 > 3 {
+            return None;
+        }
+        Some(if emul_log2 > 0 { 1 << emul_log2 } else { 1 })
+    }
+}
+
+/// Computes the new `vl` for a requested application vector length.
+///
+/// Uses `vl = min(AVL, VLMAX)`, one of the assignments permitted by the
+/// specification.
+pub const fn set_vl(avl: u64, vlmax: u64) -> u64 {
+    if avl < vlmax { avl } else { vlmax }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn decodes_sew_lmul_and_policy() {
+        // e32, m2, ta, ma
+        let vt = VType::decode(0b1101_0001);
+        assert_eq!(vt.sew, 32);
+        assert_eq!(vt.lmul_log2, 1);
+        assert!(vt.vta && vt.vma && !vt.vill);
+        assert_eq!(vt.bits(), 0b1101_0001);
+        assert_eq!(vt.vlmax(128), 8);
+    }
+
+    #[test]
+    fn fractional_lmul_limits_sew() {
+        // e8, mf8 is legal; e16, mf8 exceeds LMUL·ELEN.
+        assert_eq!(VType::decode(0b000_101).vlmax(128), 2);
+        assert!(VType::decode(0b001_101).vill);
+    }
+
+    #[test]
+    fn reserved_encodings_set_vill() {
+        assert!(VType::decode(0b000_100).vill, "vlmul = 4 is reserved");
+        assert!(VType::decode(0b100_000).vill, "e128 is unsupported");
+        assert!(VType::decode(1 << 8).vill, "reserved bits must be zero");
+        assert_eq!(VType::ILLEGAL.bits(), VILL);
+        assert_eq!(VType::ILLEGAL.vlmax(128), 0);
+    }
+
+    #[test]
+    fn group_regs_follows_emul() {
+        let vt = VType::decode(0b010_001); // e32, m2
+        assert_eq!(vt.group_regs(32), Some(2));
+        assert_eq!(vt.group_regs(64), Some(4));
+        assert_eq!(vt.group_regs(8), Some(1)); // mf2
+        let m8 = VType::decode(0b000_011); // e8, m8
+        assert_eq!(m8.group_regs(16), None);
+    }
+
+    #[test]
+    fn set_vl_clamps_to_vlmax() {
+        assert_eq!(set_vl(5, 16), 5);
+        assert_eq!(set_vl(100, 16), 16);
+        assert_eq!(set_vl(u64::MAX, 4), 4);
+    }
+}
@@ -0,0 +1,206 @@
+//! Basic-Block Vector (BBV) profiling.
+//!
+//! Collects SimPoint-compatible basic-block vectors while the functional
+//! engine fast-forwards. It performs the following:
+//! 1. **Block detection:** A dynamic basic block is a run of sequentially
+//!    retired instructions; it ends at any PC discontinuity (taken branch,
+//!    jump, trap, or `xRET`).
+//! 2. **Interval accounting:** Each block's instruction count is charged to
+//!    the block's entry PC. Once an interval has retired at least
+//!    `interval` instructions, it is closed at the next block boundary.
+//! 3. **Output:** [`BbvProfiler::write_to`] emits the `.bb` format read by
+//!    the `SimPoint` tool: one `T:<id>:<count> ...` line per interval, with
+//!    block IDs numbered from 1 in first-seen order.
+
+use std::collections::HashMap;
+use std::io::{self, Write};
+
+/// One closed profiling interval: `(block id, instructions)`, sorted by id.
+pub type BasicBlockVector = Vec<(u32, u64)>;
+
+/// Basic-block vector profiler fed with retired instructions.
+#[derive(Debug, Clone)]
+pub struct BbvProfiler {
+    /// Target instructions per interval.
+    interval: u64,
+    /// Block entry PC -> 1-based block ID.
+    ids: HashMap<u64, u32>,
+    /// Instruction counts per block ID for the open interval.
+    counts: HashMap<u32, u64>,
+    /// Closed intervals, in execution order.
+    intervals: Vec<BasicBlockVector>,
+    /// Entry PC of the open block, if one is open.
+    block_start: Option<u64>,
+    /// Instructions retired in the open block.
+    block_len: u64,
+    /// PC the open block expects the next retired instruction at.
+    expected_pc: u64,
+    /// Instructions charged to the open interval (closed blocks only).
+    interval_insts: u64,
+}
+
+impl BbvProfiler {
+    /// Creates a profiler that closes an interval every `interval` instructions.
+    ///
+    /// An `interval` of 0 is treated as 1.
+    pub fn new(interval: u64) -> Self {
+        Self {
+            interval: interval.max(1),
+            ids: HashMap::new(),
+            counts: HashMap::new(),
+            intervals: Vec::new(),
+            block_start: None,
+            block_len: 0,
+            expected_pc: 0,
+            interval_insts: 0,
+        }
+    }
+
+    /// Target instructions per interval.
+    pub const fn interval(&self) -> u64 {
+        self.interval
+    }
+
+    /// Intervals closed so far, in execution order.
+    ///
+    /// Does not include the open interval; call [`Self::flush`] first to
+    /// close it.
+    pub fn intervals(&self) -> &[BasicBlockVector] {
+        &self.intervals
+    }
+
+    /// Records one retired instruction at `pc` whose successor is `next_pc`.
+    pub fn record(&mut self, pc: u64, next_pc: u64) {
+        // A retired instruction that does not follow the open block means
+        // control left it without a retire (trap or interrupt entry).
+        if self.block_start.is_some() && pc != self.expected_pc {
+            self.close_block();
+        }
+        let _ = self.block_start.get_or_insert(pc);
+        self.block_len += 1;
+        self.expected_pc = next_pc;
+
+        let step = next_pc.wrapping_sub(pc);
+        if step != 2 && step != 4 {
+            self.close_block();
+        }
+    }
+
+    /// Closes the open block and the open interval, if either is non-empty.
+    pub fn flush(&mut self) {
+        self.close_block();
+        if !self.counts.is_empty() {
+            self.close_interval();
+        }
+    }
+
+    /// Writes every closed interval in `SimPoint` `.bb` format.
+    ///
+    /// # Errors
+    ///
+    /// Returns any I/O error from the underlying writer.
+    pub fn write_to<W: Write>(&self, w: &mut W) -> io::Result<()> {
+        for bbv in &self.intervals {
+            write!(w, "T")?;
+            for (id, count) in bbv {
+                write!(w, ":{id}:{count} ")?;
+            }
+            writeln!(w)?;
+        }
+        Ok(())
+    }
+
+    fn close_block(&mut self) {
+        let Some(start) = self.block_start.take() else {
+            return;
+        };
+        let next_id = self.ids.len() as u32 + 1;
+        let id = *self.ids.entry(start).or_insert(next_id);
+        *self.counts.entry(id).or_insert(0) += self.block_len;
+        self.interval_insts += self.block_len;
+        self.block_len = 0;
+        if self.interval_insts >= self.interval {
+            self.close_interval();
+        }
+    }
+
+    fn close_interval(&mut self) {
+        let mut bbv: BasicBlockVector = self.counts.drain().collect();
+        bbv.sort_unstable_by_key(|&(id, _)| id);
+        self.intervals.push(bbv);
+        self.interval_insts = 0;
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    /// Retires `n` sequential 4-byte instructions starting at `pc`, the last
+    /// of which jumps to `target`.
+    fn run_block(p: &mut BbvProfiler, pc: u64, n: u64, target: u64) {
+        for i in 0..n - 1 {
+            p.record(pc + 4 * i, pc + 4 * (i + 1));
+        }
+        p.record(pc + 4 * (n - 1), target);
+    }
+
+    #[test]
+    fn test_blocks_end_at_discontinuity() {
+        let mut p = BbvProfiler::new(100);
+        run_block(&mut p, 0x1000, 3, 0x2000);
+        run_block(&mut p, 0x2000, 2, 0x1000);
+        run_block(&mut p, 0x1000, 3, 0x2000);
+        p.flush();
+
+        assert_eq!(p.intervals(), &[vec![(1, 6), (2, 2)]]);
+    }
+
+    #[test]
+    fn test_interval_closes_at_block_boundary() {
+        let mut p = BbvProfiler::new(4);
+        run_block(&mut p, 0x1000, 3, 0x1000);
+        run_block(&mut p, 0x1000, 3, 0x1000);
+        run_block(&mut p, 0x1000, 3, 0x1000);
+        p.flush();
+
+        // 6 >= 4 closes the first interval; the remaining 3 form a partial one.
+        assert_eq!(p.intervals(), &[vec![(1, 6)], vec![(1, 3)]]);
+    }
+
+    #[test]
+    fn test_trap_entry_splits_block() {
+        let mut p = BbvProfiler::new(100);
+        p.record(0x1000, 0x1004);
+        // Instruction at 0x1004 faulted; the handler retires next.
+        p.record(0x8000, 0x8004);
+        p.flush();
+
+        assert_eq!(p.intervals(), &[vec![(1, 1), (2, 1)]]);
+    }
+
+    #[test]
+    fn test_compressed_instructions_are_sequential() {
+        let mut p = BbvProfiler::new(100);
+        p.record(0x1000, 0x1002);
+        p.record(0x1002, 0x1006);
+        p.record(0x1006, 0x1000);
+        p.flush();
+
+        assert_eq!(p.intervals(), &[vec![(1, 3)]]);
+    }
+
+    #[test]
+    fn test_write_simpoint_format() {
+        let mut p = BbvProfiler::new(2);
+        run_block(&mut p, 0x1000, 2, 0x2000);
+        run_block(&mut p, 0x2000, 1, 0x1000);
+        run_block(&mut p, 0x1000, 2, 0x2000);
+        p.flush();
+
+        let mut out = Vec::new();
+        p.write_to(&mut out).unwrap();
+        assert_eq!(String::from_utf8(out).unwrap(), "T:1:2 \nT:1:2 :2:1 \n");
+    }
+}
@@ -0,0 +1,574 @@
+//! Binary architectural checkpoints.
+//!
+//! A checkpoint captures the architectural state of the hart (PC, privilege,
+//! GPRs, FPRs, CSRs, WFI state), the CLINT timer, and the contents of RAM.
+//! The file layout is:
+//! 1. **Preamble:** 8-byte magic, `u32` format version, `u32` page size.
+//! 2. **Header:** Little-endian `u64` words (RAM range, page count, data
+//!    offset, hart state, CSRs), followed by the ascending index of every
+//!    non-zero RAM page.
+//! 3. **Pages:** The non-zero pages themselves, starting at a page-aligned
+//!    file offset so they can be `mmap`ed in place.
+//!
+//! Zero pages are never written, so a mostly-idle 1 GiB guest produces a file
+//! the size of its working set, and pages the guest never touched are not
+//! even scanned (see `DramBuffer::touched_pages`). On restore, RAM is remapped copy-on-write
+//! from the file (see `DramBuffer::restore_pages`) instead of being read,
+//! so resuming costs one `mmap` per contiguous run of pages.
+//!
+//! Microarchitectural state (caches, TLBs, predictors, in-flight pipeline)
+//! is not saved; it is flushed on restore.
+//!
+//! Secondary harts and the state of the PLIC, UART, and `VirtIO` disk are not
+//! saved either, so multi-hart systems and guests that have configured those
+//! devices are refused with [`SimError::CheckpointUnsupported`] rather than
+//! resumed with half their state. Polled UART output leaves no state behind,
+//! so single-hart bare-metal workloads checkpoint normally.
+
+use super::simulator::Simulator;
+use crate::common::{RegIdx, SimError};
+use crate::core::arch::csr::Csrs;
+use crate::core::arch::mode::PrivilegeMode;
+use crate::soc::memory::buffer::DramBuffer;
+use std::ffi::OsString;
+use std::fs::{self, File};
+use std::io::{self, BufReader, BufWriter, Read, Write};
+use std::path::Path;
+
+/// File magic identifying an rvsim checkpoint.
+pub const MAGIC: [u8; 8] = *b"RVSIMCKP";
+
+/// Current checkpoint format version.
+pub const VERSION: u32 = 3;
+
+/// Granularity of sparse RAM storage and file alignment.
+pub const PAGE_SIZE: usize = 4096;
+
+/// Header flag bits. Bit 1 is reserved; host settings such as tracing come
+/// from the restoring simulator's configuration, not the file.
+const FLAG_DIRECT_MODE: u64 = 1 << 0;
+const FLAG_WFI_WAITING: u64 = 1 << 2;
+
+/// Words in the fixed part of the header (before GPRs/FPRs/CSRs).
+const FIXED_WORDS: usize = 13;
+
+/// Defines the ordered CSR list stored in a checkpoint. Appending fields is
+/// backward compatible: older files simply restore fewer CSRs.
+macro_rules! checkpoint_csrs {
+    ($($field:ident),* $(,)?) => {
+        /// Number of CSR words this version reads and writes.
+        const CSR_WORDS: usize = [$(stringify!($field)),*].len();
+
+        fn csrs_to_words(c: &Csrs) -> Vec<u64> {
+            vec![$(c.$field),*]
+        }
+
+        fn csrs_from_words(c: &mut Csrs, words: &[u64]) {
+            let mut it = words.iter();
+            $(
+                if let Some(&v) = it.next() {
+                    c.$field = v;
+                }
+            )*
+        }
+    };
+}
+
+checkpoint_csrs!(
+    mstatus, misa, medeleg, mideleg, mie, mtvec, mscratch, mepc, mcause, mtval, mip, sstatus, sie,
+    stvec, sscratch, sepc, scause, stval, sip, satp, cycle, time, instret, mcycle, minstret,
+    stimecmp, fflags, frm, mcounteren, scounteren, menvcfg,
+);
+
+impl Simulator {
+    /// Writes a checkpoint of the architectural state and RAM to `path`.
+    ///
+    /// The file is written next to `path` and renamed into place, so a
+    /// checkpoint that is currently mapped by a restored simulator can be
+    /// overwritten safely.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::CheckpointUnsupported`] for a multi-hart system or
+    /// one whose devices hold state a checkpoint would lose, and
+    /// [`SimError::CheckpointIo`] if the file cannot be written.
+    pub fn save_checkpoint(&mut self, path: &Path) -> Result<(), SimError> {
+        self.check_checkpointable()?;
+        let io_err = |source| SimError::CheckpointIo { path: path.display().to_string(), source };
+
+        let cpu = &mut self.cpu;
+        let clint = cpu.bus.bus.clint_mut().map_or([0; 4], |c| c.hart0_state());
+        let (ram_start, ram_end) = (cpu.ram_start, cpu.ram_end);
+        let ram = cpu.bus.bus.ram_buffer();
+        let ram_len = ram.map_or(0, DramBuffer::len);
+        // Only pages the guest has touched are scanned, so saving a large,
+        // mostly idle RAM costs its working set rather than its size.
+        let pages: Vec<u64> = ram.map_or_else(Vec::new, |r| {
+            r.touched_pages(PAGE_SIZE)
+                .into_iter()
+                .filter(|&p| {
+                    let off = p as usize * PAGE_SIZE;
+                    r.read_slice(off, PAGE_SIZE.min(ram_len - off)).iter().any(|&b| b != 0)
+                })
+                .collect()
+        });
+
+        let mut words = vec![0u64; FIXED_WORDS];
+        for i in 0u8..32 {
+            words.push(cpu.regs.read(RegIdx::new(i)));
+        }
+        for i in 0u8..32 {
+            words.push(cpu.regs.read_f(RegIdx::new(i)));
+        }
+        let csrs = csrs_to_words(&cpu.csrs);
+        let flags = (if cpu.direct_mode { FLAG_DIRECT_MODE } else { 0 })
+            | (if cpu.wfi_waiting { FLAG_WFI_WAITING } else { 0 });
+        let header_len = 16 + 8 * (words.len() + csrs.len() + pages.len());
+        let data_offset = header_len.next_multiple_of(PAGE_SIZE) as u64;
+        words[..FIXED_WORDS].copy_from_slice(&[
+            ram_start,
+            ram_end,
+            pages.len() as u64,
+            data_offset,
+            cpu.pc,
+            u64::from(cpu.privilege.to_u8()),
+            flags,
+            cpu.wfi_pc,
+            csrs.len() as u64,
+            clint[0],
+            clint[1],
+            clint[2],
+            clint[3],
+        ]);
+
+        let mut tmp = OsString::from(path.as_os_str());
+        tmp.push(".tmp");
+        let write = || -> io::Result<()> {
+            let mut w = BufWriter::new(File::create(&tmp)?);
+            w.write_all(&MAGIC)?;
+            w.write_all(&VERSION.to_le_bytes())?;
+            w.write_all(&(PAGE_SIZE as u32).to_le_bytes())?;
+            for word in words.iter().chain(&csrs).chain(&pages) {
+                w.write_all(&word.to_le_bytes())?;
+            }
+            w.write_all(&vec![0u8; data_offset as usize - header_len])?;
+            if let Some(r) = ram {
+                let mut page = [0u8; PAGE_SIZE];
+                for &p in &pages {
+                    let off = p as usize * PAGE_SIZE;
+                    let data = r.read_slice(off, PAGE_SIZE.min(ram_len - off));
+                    if data.len() == PAGE_SIZE {
+                        w.write_all(data)?;
+                    } else {
+                        page[..data.len()].copy_from_slice(data);
+                        w.write_all(&page)?;
+                    }
+                }
+            }
+            w.into_inner().map_err(io::IntoInnerError::into_error)?.sync_all()?;
+            fs::rename(&tmp, path)
+        };
+        write().map_err(io_err)
+    }
+
+    /// Restores architectural state and RAM from a checkpoint at `path`.
+    ///
+    /// The simulator must have the same RAM base and size as the one that
+    /// saved the checkpoint; the microarchitecture may differ. Caches, TLBs,
+    /// and the pipeline are flushed, and the pipeline resumes at the restored
+    /// PC.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::CheckpointUnsupported`] if this simulator could not
+    /// have saved one (see [`Self::save_checkpoint`]),
+    /// [`SimError::CheckpointIo`] if the file cannot be read or mapped, and
+    /// [`SimError::InvalidCheckpoint`] if it is not a checkpoint, its RAM
+    /// layout does not match, or its page list is corrupt.
+    pub fn restore_checkpoint(&mut self, path: &Path) -> Result<(), SimError> {
+        self.check_checkpointable()?;
+        let name = path.display().to_string();
+        let io_err = |source| SimError::CheckpointIo { path: name.clone(), source };
+        let invalid = |reason: String| SimError::InvalidCheckpoint { path: name.clone(), reason };
+
+        let file = File::open(path).map_err(io_err)?;
+        let mut r = BufReader::new(&file);
+
+        let mut preamble = [0u8; 16];
+        r.read_exact(&mut preamble).map_err(io_err)?;
+        if preamble[..8] != MAGIC {
+            return Err(invalid("not an rvsim checkpoint".into()));
+        }
+        let version = u32::from_le_bytes([preamble[8], preamble[9], preamble[10], preamble[11]]);
+        if version != VERSION {
+            return Err(invalid(format!("unsupported format version {version}")));
+        }
+        let page_size =
+            u32::from_le_bytes([preamble[12], preamble[13], preamble[14], preamble[15]]) as usize;
+        if page_size != PAGE_SIZE {
+            return Err(invalid(format!("unsupported page size {page_size}")));
+        }
+
+        let fixed = read_words(&mut r, FIXED_WORDS).map_err(io_err)?;
+        let [
+            ram_start,
+            ram_end,
+            page_count,
+            data_offset,
+            pc,
+            privilege,
+            flags,
+            wfi_pc,
+            csr_count,
+            mtime,
+            mtime_phase,
+            mtimecmp,
+            msip,
+        ] = fixed[..]
+        else {
+            return Err(invalid("truncated header".into()));
+        };
+        if (ram_start, ram_end) != (self.cpu.ram_start, self.cpu.ram_end) {
+            return Err(invalid(format!(
+                "RAM layout mismatch: checkpoint has {ram_start:#x}..{ram_end:#x}, \
+                 simulator has {:#x}..{:#x}",
+                self.cpu.ram_start, self.cpu.ram_end
+            )));
+        }
+        // Both counts size allocations below, so bound them by what this
+        // simulator and the file can actually hold before reading further.
+        if csr_count > CSR_WORDS as u64 {
+            return Err(invalid(format!("{csr_count} CSR words, this version knows {CSR_WORDS}")));
+        }
+        let ram_pages = (ram_end - ram_start).div_ceil(PAGE_SIZE as u64);
+        let file_len = file.metadata().map_err(io_err)?.len();
+        let header_len = 16 + 8 * (FIXED_WORDS as u64 + 64 + csr_count);
+        let data_end = page_count
+            .checked_mul(PAGE_SIZE as u64)
+            .and_then(|bytes| bytes.checked_add(data_offset));
+        if page_count > ram_pages
+            || data_offset < header_len + 8 * page_count
+            || data_end.is_none_or(|end| end > file_len)
+        {
+            return Err(invalid(format!(
+                "{page_count} pages at offset {data_offset:#x} do not fit in {ram_pages} RAM \
+                 pages or the {file_len}-byte file"
+            )));
+        }
+        let regs = read_words(&mut r, 64).map_err(io_err)?;
+        let csrs = read_words(&mut r, csr_count as usize).map_err(io_err)?;
+        let pages = read_words(&mut r, page_count as usize).map_err(io_err)?;
+        if !pages.is_empty()
+            && (self.cpu.bus.bus.ram_buffer().is_none() || data_offset % PAGE_SIZE as u64 != 0)
+        {
+            return Err(invalid("page data without RAM or misaligned".into()));
+        }
+        if let Some(ram) = self.cpu.bus.bus.ram_buffer() {
+            ram.restore_pages(&file, data_offset, &pages, PAGE_SIZE).map_err(|e| {
+                if e.kind() == io::ErrorKind::InvalidData {
+                    invalid(e.to_string())
+                } else {
+                    io_err(e)
+                }
+            })?;
+        }
+
+        let cpu = &mut self.cpu;
+        cpu.pc = pc;
+        cpu.privilege = PrivilegeMode::from_u8(privilege as u8);
+        cpu.direct_mode = flags & FLAG_DIRECT_MODE != 0;
+        cpu.wfi_waiting = flags & FLAG_WFI_WAITING != 0;
+        cpu.wfi_pc = wfi_pc;
+        for (i, &v) in regs[..32].iter().enumerate() {
+            cpu.regs.write(RegIdx::new(i as u8), v);
+        }
+        for (i, &v) in regs[32..].iter().enumerate() {
+            cpu.regs.write_f(RegIdx::new(i as u8), v);
+        }
+        csrs_from_words(&mut cpu.csrs, &csrs);
+        if let Some(c) = cpu.bus.bus.clint_mut() {
+            c.restore_hart0_state([mtime, mtime_phase, mtimecmp, msip]);
+        }
+
+        let _ = cpu.l1_i_cache.flush();
+        let _ = cpu.l1_d_cache.flush();
+        let _ = cpu.l2_cache.flush();
+        let _ = cpu.l3_cache.flush();
+        cpu.mmu.flush_all();
+
+        self.pipeline.flush(&mut self.cpu);
+        self.cpu.committed_next_pc = pc;
+        self.cpu.redirect_pending = true;
+        self.sync_arch_regs();
+        Ok(())
+    }
+
+    /// Fails if this system holds state that checkpoints do not capture.
+    fn check_checkpointable(&self) -> Result<(), SimError> {
+        let reason = if let Some(smp) = &self.smp {
+            format!("{} harts; checkpoints hold a single hart", smp.harts.len() + 1)
+        } else if let Some(device) = self.cpu.bus.bus.unsaved_device() {
+            format!("{device} has been configured by the guest and its state is not saved")
+        } else {
+            return Ok(());
+        };
+        Err(SimError::CheckpointUnsupported { reason })
+    }
+}
+
+/// Reads `n` little-endian `u64` words.
+fn read_words<R: Read>(r: &mut R, n: usize) -> io::Result<Vec<u64>> {
+    let mut bytes = vec![0u8; n * 8];
+    r.read_exact(&mut bytes)?;
+    Ok(bytes
+        .chunks_exact(8)
+        .map(|c| u64::from_le_bytes([c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]]))
+        .collect())
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used, unused_results)]
+mod tests {
+    use super::*;
+    use crate::common::PhysAddr;
+    use crate::config::Config;
+    use crate::soc::builder::System;
+
+    /// `x1 += 1; mem[x2] = x1; loop`.
+    const COUNTER_LOOP: [u32; 3] = [0x0010_8093, 0x0011_3023, 0xFF9F_F06F];
+    const RAM_SIZE: usize = 1 << 20;
+    const DATA_OFFSET: u64 = 0x8000;
+
+    fn config(ram_size: usize) -> Config {
+        let mut config = Config::default();
+        config.memory.ram_size = ram_size;
+        config.general.fast_forward.enabled = true;
+        config
+    }
+
+    fn sim(config: &Config) -> Simulator {
+        let system = System::new(config, "");
+        let mut sim = Simulator::new(system, config);
+        let base = sim.cpu.pc;
+        for (i, inst) in COUNTER_LOOP.iter().enumerate() {
+            sim.cpu.bus.bus.write_u32(PhysAddr::new(base + (i as u64) * 4), *inst);
+        }
+        sim.cpu.regs.write(RegIdx::new(2), base + DATA_OFFSET);
+        sim
+    }
+
+    fn run(sim: &mut Simulator, cycles: u64) {
+        for _ in 0..cycles {
+            sim.tick().unwrap();
+        }
+    }
+
+    #[test]
+    fn test_round_trip_restores_state() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let mut a = sim(&config(RAM_SIZE));
+        run(&mut a, 30);
+        a.save_checkpoint(&path).unwrap();
+
+        let mut b = Simulator::new(System::new(&config(RAM_SIZE), ""), &config(RAM_SIZE));
+        b.restore_checkpoint(&path).unwrap();
+
+        assert_eq!(b.cpu.pc, a.cpu.pc);
+        for i in 0u8..32 {
+            assert_eq!(b.cpu.regs.read(RegIdx::new(i)), a.cpu.regs.read(RegIdx::new(i)));
+        }
+        assert_eq!(b.cpu.csrs.mstatus, a.cpu.csrs.mstatus);
+        let data = PhysAddr::new(a.cpu.ram_start + DATA_OFFSET);
+        assert_eq!(b.cpu.bus.bus.read_u64(data), 10);
+
+        // Both continue identically from the restored state.
+        run(&mut a, 30);
+        run(&mut b, 30);
+        assert_eq!(b.cpu.regs.read(RegIdx::new(1)), a.cpu.regs.read(RegIdx::new(1)));
+        assert_eq!(b.cpu.bus.bus.read_u64(data), a.cpu.bus.bus.read_u64(data));
+    }
+
+    #[test]
+    fn test_restore_keeps_host_trace_setting() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        for trace in [false, true] {
+            let mut a = sim(&config(RAM_SIZE));
+            a.cpu.trace = trace;
+            a.save_checkpoint(&path).unwrap();
+
+            let mut b = sim(&config(RAM_SIZE));
+            b.cpu.trace = !trace;
+            b.restore_checkpoint(&path).unwrap();
+            assert_eq!(b.cpu.trace, !trace);
+        }
+    }
+
+    #[test]
+    fn test_only_nonzero_pages_are_stored() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let mut a = sim(&config(RAM_SIZE));
+        run(&mut a, 30);
+        a.save_checkpoint(&path).unwrap();
+
+        // Code page + data page, after a one-page header.
+        let len = fs::metadata(&path).unwrap().len();
+        assert_eq!(len, 3 * PAGE_SIZE as u64);
+    }
+
+    #[test]
+    fn test_large_idle_ram_saves_working_set() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let mut config = config(256 << 20);
+        config.memory.huge_pages = crate::config::HugePages::Transparent;
+        let mut a = sim(&config);
+        run(&mut a, 30);
+        a.save_checkpoint(&path).unwrap();
+        assert_eq!(fs::metadata(&path).unwrap().len(), 3 * PAGE_SIZE as u64);
+
+        let mut b = sim(&config);
+        b.restore_checkpoint(&path).unwrap();
+        let data = PhysAddr::new(b.cpu.ram_start + DATA_OFFSET);
+        assert_eq!(b.cpu.bus.bus.read_u64(data), 10);
+    }
+
+    #[test]
+    fn test_restore_clears_pages_absent_from_checkpoint() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        sim(&config(RAM_SIZE)).save_checkpoint(&path).unwrap();
+
+        let mut b = sim(&config(RAM_SIZE));
+        let stale = PhysAddr::new(b.cpu.ram_start + 0x1_0000);
+        b.cpu.bus.bus.write_u64(stale, 0xDEAD_BEEF);
+        b.restore_checkpoint(&path).unwrap();
+
+        assert_eq!(b.cpu.bus.bus.read_u64(stale), 0);
+        // Restored RAM stays writable (copy-on-write, file untouched).
+        b.cpu.bus.bus.write_u64(stale, 7);
+        assert_eq!(b.cpu.bus.bus.read_u64(stale), 7);
+    }
+
+    #[test]
+    fn test_resave_over_mapped_checkpoint() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let mut a = sim(&config(RAM_SIZE));
+        run(&mut a, 30);
+        a.save_checkpoint(&path).unwrap();
+
+        let mut b = sim(&config(RAM_SIZE));
+        b.restore_checkpoint(&path).unwrap();
+        b.save_checkpoint(&path).unwrap();
+        run(&mut b, 3);
+
+        let data = PhysAddr::new(b.cpu.ram_start + DATA_OFFSET);
+        assert_eq!(b.cpu.bus.bus.read_u64(data), 11);
+    }
+
+    #[test]
+    fn test_ram_size_mismatch_is_rejected() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        sim(&config(RAM_SIZE)).save_checkpoint(&path).unwrap();
+
+        let mut b = sim(&config(2 * RAM_SIZE));
+        let err = b.restore_checkpoint(&path).unwrap_err();
+        assert!(matches!(err, SimError::InvalidCheckpoint { .. }));
+    }
+
+    #[test]
+    fn test_clint_timer_round_trips() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let config = config(RAM_SIZE);
+        let mtime = PhysAddr::new(config.system.clint_base + 0xBFF8);
+        let mtimecmp = PhysAddr::new(config.system.clint_base + 0x4000);
+        let mut a = sim(&config);
+        a.cpu.bus.bus.write_u64(mtimecmp, 0x1234_5678);
+        run(&mut a, 100);
+        a.save_checkpoint(&path).unwrap();
+
+        let mut b = sim(&config);
+        b.restore_checkpoint(&path).unwrap();
+        let saved = a.cpu.bus.bus.read_u64(mtime);
+        assert!(saved > 0);
+        assert_eq!(b.cpu.bus.bus.read_u64(mtime), saved);
+        assert_eq!(b.cpu.bus.bus.read_u64(mtimecmp), 0x1234_5678);
+    }
+
+    #[test]
+    fn test_configured_devices_are_refused() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let config = config(RAM_SIZE);
+        for (reg, val) in [(config.system.uart_base + 1, 1), (config.system.disk_base + 0x70, 1)] {
+            let mut a = sim(&config);
+            a.cpu.bus.bus.write_u32(PhysAddr::new(reg), val);
+            let err = a.save_checkpoint(&path).unwrap_err();
+            assert!(matches!(err, SimError::CheckpointUnsupported { .. }), "{err}");
+            assert!(!path.exists());
+        }
+
+        // Polled console output leaves nothing to lose.
+        let mut a = sim(&config);
+        a.cpu.bus.bus.write_u8(PhysAddr::new(config.system.uart_base), b'\n');
+        a.save_checkpoint(&path).unwrap();
+    }
+
+    #[test]
+    fn test_multi_hart_system_is_refused() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        sim(&config(RAM_SIZE)).save_checkpoint(&path).unwrap();
+
+        let mut config = config(RAM_SIZE);
+        config.system.harts = 2;
+        let mut smp = sim(&config);
+        let err = smp.save_checkpoint(&dir.path().join("smp.bin")).unwrap_err();
+        assert!(matches!(err, SimError::CheckpointUnsupported { .. }), "{err}");
+        let err = smp.restore_checkpoint(&path).unwrap_err();
+        assert!(matches!(err, SimError::CheckpointUnsupported { .. }), "{err}");
+    }
+
+    #[test]
+    fn test_corrupt_header_counts_are_rejected() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        let mut a = sim(&config(RAM_SIZE));
+        run(&mut a, 30);
+        a.save_checkpoint(&path).unwrap();
+        let good = fs::read(&path).unwrap();
+
+        // Header word 2 is the page count, word 8 the CSR count.
+        let patch = |word: usize, value: u64| {
+            let mut bytes = good.clone();
+            bytes[16 + 8 * word..24 + 8 * word].copy_from_slice(&value.to_le_bytes());
+            bytes
+        };
+        for bytes in [
+            patch(8, u64::MAX),
+            patch(8, CSR_WORDS as u64 + 1),
+            patch(2, u64::MAX),
+            patch(2, 3),
+            good[..good.len() - PAGE_SIZE].to_vec(),
+        ] {
+            fs::write(&path, bytes).unwrap();
+            let err = sim(&config(RAM_SIZE)).restore_checkpoint(&path).unwrap_err();
+            assert!(matches!(err, SimError::InvalidCheckpoint { .. }), "{err}");
+        }
+    }
+
+    #[test]
+    fn test_non_checkpoint_file_is_rejected() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("ckpt.bin");
+        fs::write(&path, b"{\"magic\": \"rvsim-checkpoint\"}").unwrap();
+
+        let err = sim(&config(RAM_SIZE)).restore_checkpoint(&path).unwrap_err();
+        assert!(matches!(err, SimError::InvalidCheckpoint { .. }));
+    }
+}
@@ -4,7 +4,7 @@
 //! This allows the simulator to provide a DTB to OpenSBI/Linux without
 //! requiring an external `dtc` compilation step.
 
-use crate::config::Config;
+use crate::config::{Config, MAX_HARTS};
 
 // FDT constants
 const FDT_MAGIC: u32 = 0xd00dfeed;
@@ -158,6 +158,23 @@ impl FdtBuilder {
     }
 }
 
+/// Phandle of hart `hart`'s local interrupt controller (hart 0 keeps phandle 1).
+const fn intc_phandle(hart: u32) -> u32 {
+    if hart == 0 { 1 } else { 0x100 + hart }
+}
+
+/// `interrupts-extended` cells routing `irqs` of every hart's local controller.
+fn interrupts_extended(harts: u32, irqs: [u32; 2]) -> Vec<u8> {
+    let mut ie = Vec::with_capacity(16 * harts as usize);
+    for hart in 0..harts {
+        for irq in irqs {
+            ie.extend_from_slice(&intc_phandle(hart).to_be_bytes());
+            ie.extend_from_slice(&irq.to_be_bytes());
+        }
+    }
+    ie
+}
+
 /// Generates a DTB binary matching the simulator's `SoC` layout.
 ///
 /// The generated DTB includes:
@@ -166,7 +183,7 @@ impl FdtBuilder {
 /// - PLIC at 0x0c000000
 /// - UART at `uart_base`
 /// - `VirtIO` block device at `disk_base`
-/// - CPU with rv64imafdc ISA and SV39 MMU
+/// - One CPU per configured hart, each `rv64imafdc_zba_zbb_zbs` with SV39 MMU
 pub fn generate_dtb(config: &Config) -> Vec<u8> {
     let ram_base = config.system.ram_base;
     let ram_size = config.memory.ram_size as u64;
@@ -182,8 +199,9 @@ pub fn generate_dtb(config: &Config) -> Vec<u8> {
         format!("root=/dev/vda rw console=ttyS0 earlycon=uart8250,mmio,{uart_base:#x} rootwait");
     let stdout_path = format!("/soc/uart@{uart_base:x}");
 
-    // Phandle values (arbitrary unique IDs)
-    let cpu0_intc_phandle: u32 = 1;
+    let harts = config.system.harts.clamp(1, MAX_HARTS) as u32;
+
+    // Phandle values (arbitrary unique IDs; see `intc_phandle` for the harts)
     let plic_phandle: u32 = 2;
 
     let mut b = FdtBuilder::new();
@@ -207,24 +225,26 @@ pub fn generate_dtb(config: &Config) -> Vec<u8> {
     b.prop_u32("#size-cells", 0);
     b.prop_u32("timebase-frequency", timebase_freq);
 
-    // /cpus/cpu@0
-    b.begin_node("cpu@0");
-    b.prop_string("device_type", "cpu");
-    b.prop_reg_1_0(0);
-    b.prop_string("status", "okay");
-    b.prop_string("compatible", "riscv");
-    b.prop_string("riscv,isa", "rv64imafdc");
-    b.prop_string("mmu-type", "riscv,sv39");
-
-    // /cpus/cpu@0/interrupt-controller
-    b.begin_node("interrupt-controller");
-    b.prop_u32("#interrupt-cells", 1);
-    b.prop_empty("interrupt-controller");
-    b.prop_string("compatible", "riscv,cpu-intc");
-    b.prop_u32("phandle", cpu0_intc_phandle);
-    b.end_node(); // interrupt-controller
-
-    b.end_node(); // cpu@0
+    for hart in 0..harts {
+        // /cpus/cpu@N
+        b.begin_node(&format!("cpu@{hart}"));
+        b.prop_string("device_type", "cpu");
+        b.prop_reg_1_0(hart);
+        b.prop_string("status", "okay");
+        b.prop_string("compatible", "riscv");
+        b.prop_string("riscv,isa", "rv64imafdc_zba_zbb_zbs");
+        b.prop_string("mmu-type", "riscv,sv39");
+
+        // /cpus/cpu@N/interrupt-controller
+        b.begin_node("interrupt-controller");
+        b.prop_u32("#interrupt-cells", 1);
+        b.prop_empty("interrupt-controller");
+        b.prop_string("compatible", "riscv,cpu-intc");
+        b.prop_u32("phandle", intc_phandle(hart));
+        b.end_node(); // interrupt-controller
+
+        b.end_node(); // cpu@N
+    }
     b.end_node(); // cpus
 
     // /memory
@@ -249,13 +269,9 @@ pub fn generate_dtb(config: &Config) -> Vec<u8> {
         b.begin_node(&node_name);
         b.prop_string("compatible", "riscv,clint0");
         b.prop_reg_2_2(clint_base, 0x10000);
-        // interrupts-extended: <&cpu0_intc 3>, <&cpu0_intc 7>
+        // interrupts-extended: <&cpuN_intc 3>, <&cpuN_intc 7> per hart
         // (3 = M-mode software interrupt, 7 = M-mode timer interrupt)
-        let mut ie = Vec::with_capacity(16);
-        ie.extend_from_slice(&cpu0_intc_phandle.to_be_bytes());
-        ie.extend_from_slice(&3u32.to_be_bytes());
-        ie.extend_from_slice(&cpu0_intc_phandle.to_be_bytes());
-        ie.extend_from_slice(&7u32.to_be_bytes());
+        let ie = interrupts_extended(harts, [3, 7]);
         b.prop_bytes("interrupts-extended", &ie);
         b.end_node();
     }
@@ -292,13 +308,10 @@ pub fn generate_dtb(config: &Config) -> Vec<u8> {
         b.prop_reg_2_2(plic_base, 0x4000000);
         b.prop_u32("#interrupt-cells", 1);
         b.prop_empty("interrupt-controller");
-        // interrupts-extended: <&cpu0_intc 11>, <&cpu0_intc 9>
-        // (11 = M-mode external interrupt, 9 = S-mode external interrupt)
-        let mut ie = Vec::with_capacity(16);
-        ie.extend_from_slice(&cpu0_intc_phandle.to_be_bytes());
-        ie.extend_from_slice(&11u32.to_be_bytes());
-        ie.extend_from_slice(&cpu0_intc_phandle.to_be_bytes());
-        ie.extend_from_slice(&9u32.to_be_bytes());
+        // interrupts-extended: <&cpuN_intc 11>, <&cpuN_intc 9> per hart
+        // (11 = M-mode external interrupt, 9 = S-mode external interrupt),
+        // matching the PLIC's two contexts per hart.
+        let ie = interrupts_extended(harts, [11, 9]);
         b.prop_bytes("interrupts-extended", &ie);
         b.prop_u32("riscv,ndev", 0x35);
         b.prop_u32("phandle", plic_phandle);
@@ -0,0 +1,263 @@
+//! Streaming interval statistics.
+//!
+//! Records one fixed-width row of counter deltas per sampling interval to an
+//! append-only file, so long time-series runs cost a subtraction and a
+//! buffered write per interval instead of a statistics snapshot. The file
+//! layout is:
+//! 1. **Preamble:** 8-byte magic, `u32` format version, `u32` column count,
+//!    `u64` header length in bytes (a multiple of 8).
+//! 2. **Columns:** The column names joined by `'\n'`, zero-padded to the
+//!    header length. The first column is `cycle`, the machine cycle at the
+//!    end of the interval; the rest are [`SimStats::COUNTERS`], each the
+//!    change over the interval.
+//! 3. **Rows:** Little-endian `u64` values, one row of every column per
+//!    interval.
+//!
+//! Every value is 8-byte aligned from the start of the file, so a reader can
+//! `mmap` it and view each column as a strided `u64` array without copying.
+//! The row count is implied by the file size; a trailing partial row (from a
+//! run still in progress) is ignored.
+
+use crate::stats::SimStats;
+use std::fs::File;
+use std::io::{self, BufReader, BufWriter, Read, Write};
+
+/// File magic identifying an rvsim interval statistics file.
+pub const MAGIC: [u8; 8] = *b"RVSIMIST";
+
+/// Current file format version.
+pub const VERSION: u32 = 1;
+
+/// Name of the leading interval-end cycle column.
+pub const CYCLE_COLUMN: &str = "cycle";
+
+/// Bytes before the column names.
+const PREAMBLE_BYTES: usize = 24;
+
+/// Streaming interval statistics encoder.
+#[derive(Debug)]
+pub struct IntervalStatsWriter<W: Write = BufWriter<File>> {
+    out: W,
+    /// Path the rows are written to (empty for in-memory writers).
+    path: String,
+    /// Counters at the end of the previous interval.
+    prev: [u64; SimStats::COUNTER_COUNT],
+    rows: u64,
+}
+
+impl IntervalStatsWriter {
+    /// Creates the file at `path` and writes the header; the first row
+    /// counts from `start`.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be created or written.
+    pub fn create(path: &str, start: &SimStats) -> io::Result<Self> {
+        let file = File::create(path)?;
+        let mut writer = Self::new(BufWriter::new(file), start)?;
+        path.clone_into(&mut writer.path);
+        Ok(writer)
+    }
+}
+
+impl<W: Write> IntervalStatsWriter<W> {
+    /// Wraps `out` and writes the header; the first row counts from `start`.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the header cannot be written.
+    pub fn new(mut out: W, start: &SimStats) -> io::Result<Self> {
+        let mut names = CYCLE_COLUMN.to_owned();
+        for name in SimStats::COUNTERS {
+            names.push('\n');
+            names.push_str(name);
+        }
+        let header_len = (PREAMBLE_BYTES + names.len()).next_multiple_of(8);
+        let mut header = Vec::with_capacity(header_len);
+        header.extend_from_slice(&MAGIC);
+        header.extend_from_slice(&VERSION.to_le_bytes());
+        header.extend_from_slice(&(SimStats::COUNTER_COUNT as u32 + 1).to_le_bytes());
+        header.extend_from_slice(&(header_len as u64).to_le_bytes());
+        header.extend_from_slice(names.as_bytes());
+        header.resize(header_len, 0);
+        out.write_all(&header)?;
+        out.flush()?;
+        Ok(Self { out, path: String::new(), prev: start.counters(), rows: 0 })
+    }
+
+    /// Path the rows are written to.
+    pub fn path(&self) -> &str {
+        &self.path
+    }
+
+    /// Rows written so far.
+    pub const fn rows(&self) -> u64 {
+        self.rows
+    }
+
+    /// Appends the row for the interval ending at `stats`.
+    ///
+    /// The row is flushed, so a reader of the file sees it immediately.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the row cannot be written.
+    pub fn record(&mut self, stats: &SimStats) -> io::Result<()> {
+        let counters = stats.counters();
+        let mut row = [0u8; 8 * (SimStats::COUNTER_COUNT + 1)];
+        let (cycle, deltas) = row.split_at_mut(8);
+        cycle.copy_from_slice(&stats.cycles.to_le_bytes());
+        for ((out, now), prev) in deltas.chunks_exact_mut(8).zip(counters).zip(self.prev) {
+            out.copy_from_slice(&now.saturating_sub(prev).to_le_bytes());
+        }
+        self.prev = counters;
+        self.out.write_all(&row)?;
+        self.out.flush()?;
+        self.rows += 1;
+        Ok(())
+    }
+
+    /// Flushes the file, returning the underlying writer.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if buffered rows cannot be written.
+    pub fn finish(mut self) -> io::Result<W> {
+        self.out.flush()?;
+        Ok(self.out)
+    }
+}
+
+/// A decoded interval statistics file.
+#[derive(Clone, Debug, PartialEq, Eq)]
+pub struct IntervalTable {
+    /// Column names, `cycle` first.
+    pub columns: Vec<String>,
+    /// Values, row-major.
+    pub values: Vec<u64>,
+}
+
+impl IntervalTable {
+    /// Reads the file at `path`.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be read or is malformed.
+    pub fn open(path: &str) -> io::Result<Self> {
+        Self::read(BufReader::new(File::open(path)?))
+    }
+
+    /// Decodes a file from `input`, dropping a trailing partial row.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if `input` cannot be read or is malformed.
+    pub fn read<R: Read>(mut input: R) -> io::Result<Self> {
+        let invalid = |msg: &str| io::Error::new(io::ErrorKind::InvalidData, msg.to_owned());
+        let mut preamble = [0u8; PREAMBLE_BYTES];
+        input.read_exact(&mut preamble)?;
+        if preamble[..8] != MAGIC {
+            return Err(invalid("not an rvsim interval statistics file"));
+        }
+        let word =
+            |at: usize| u32::from_le_bytes(preamble[at..at + 4].try_into().unwrap_or_default());
+        if word(8) != VERSION {
+            return Err(invalid("unsupported interval statistics version"));
+        }
+        let ncols = word(12) as usize;
+        let header_len = u64::from_le_bytes(preamble[16..].try_into().unwrap_or_default()) as usize;
+        if ncols == 0 || header_len < PREAMBLE_BYTES || !header_len.is_multiple_of(8) {
+            return Err(invalid("malformed interval statistics header"));
+        }
+
+        let mut names = vec![0u8; header_len - PREAMBLE_BYTES];
+        input.read_exact(&mut names)?;
+        let names = std::str::from_utf8(&names)
+            .map_err(|_| invalid("malformed interval statistics header"))?;
+        let columns: Vec<String> =
+            names.trim_end_matches('\0').split('\n').map(str::to_owned).collect();
+        if columns.len() != ncols {
+            return Err(invalid("malformed interval statistics header"));
+        }
+
+        let mut body = Vec::new();
+        let _ = input.read_to_end(&mut body)?;
+        let whole = body.len() / (8 * ncols) * 8 * ncols;
+        let values = body[..whole]
+            .chunks_exact(8)
+            .map(|b| u64::from_le_bytes(b.try_into().unwrap_or_default()))
+            .collect();
+        Ok(Self { columns, values })
+    }
+
+    /// Number of rows.
+    pub const fn len(&self) -> usize {
+        self.values.len() / self.columns.len()
+    }
+
+    /// Returns `true` if no interval was recorded.
+    pub const fn is_empty(&self) -> bool {
+        self.values.is_empty()
+    }
+
+    /// Values of row `index`, in column order.
+    pub fn row(&self, index: usize) -> &[u64] {
+        &self.values[index * self.columns.len()..][..self.columns.len()]
+    }
+
+    /// Values of the column `name`, or `None` if there is no such column.
+    pub fn column(&self, name: &str) -> Option<Vec<u64>> {
+        let at = self.columns.iter().position(|c| c == name)?;
+        Some(self.values.iter().skip(at).step_by(self.columns.len()).copied().collect())
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    fn at(cycles: u64, instructions_retired: u64) -> SimStats {
+        let mut stats = SimStats::default();
+        stats.cycles = cycles;
+        stats.instructions_retired = instructions_retired;
+        stats
+    }
+
+    #[test]
+    fn rows_hold_deltas_from_the_start() {
+        let mut w = IntervalStatsWriter::new(Vec::new(), &at(100, 40)).unwrap();
+        w.record(&at(200, 90)).unwrap();
+        w.record(&at(300, 190)).unwrap();
+        assert_eq!(w.rows(), 2);
+        let bytes = w.finish().unwrap();
+        assert_eq!(bytes.len() % 8, 0, "rows stay 8-byte aligned");
+
+        let table = IntervalTable::read(bytes.as_slice()).unwrap();
+        assert_eq!(table.columns[0], CYCLE_COLUMN);
+        assert_eq!(&table.columns[1..], SimStats::COUNTERS);
+        assert_eq!(table.len(), 2);
+        assert_eq!(table.column("cycle"), Some(vec![200, 300]));
+        assert_eq!(table.column("cycles"), Some(vec![100, 100]));
+        assert_eq!(table.column("instructions_retired"), Some(vec![50, 100]));
+        assert_eq!(table.column("dcache_misses"), Some(vec![0, 0]));
+        assert_eq!(table.column("nope"), None);
+        assert_eq!(table.row(1)[..3], [300, 100, 100]);
+    }
+
+    #[test]
+    fn a_partial_trailing_row_is_ignored() {
+        let mut w = IntervalStatsWriter::new(Vec::new(), &SimStats::default()).unwrap();
+        w.record(&at(10, 5)).unwrap();
+        let mut bytes = w.finish().unwrap();
+        bytes.extend_from_slice(&[1; 12]);
+        assert_eq!(IntervalTable::read(bytes.as_slice()).unwrap().len(), 1);
+    }
+
+    #[test]
+    fn rejects_a_foreign_file() {
+        let err =
+            IntervalTable::read(&b"RVSIMCKP\x02\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0"[..]).unwrap_err();
+        assert!(err.to_string().contains("not an rvsim interval"), "{err}");
+    }
+}
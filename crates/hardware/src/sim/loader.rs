@@ -147,12 +147,15 @@ pub struct ElfLoadResult {
     pub entry: u64,
     /// Address of the `tohost` symbol, if present.
     pub tohost_addr: Option<u64>,
+    /// `begin_signature`..`end_signature` symbol addresses, if both are present.
+    pub signature: Option<(u64, u64)>,
 }
 
 /// Attempts to load an ELF file into memory via the bus.
 ///
 /// If the file starts with the ELF magic (`\x7fELF`), parses the ELF,
-/// loads all `PT_LOAD` segments, and extracts the `tohost` symbol address.
+/// loads all `PT_LOAD` segments, and extracts the `tohost` and signature
+/// symbol addresses.
 /// Returns `None` if the data is not a valid ELF.
 pub fn try_load_elf(data: &[u8], bus: &mut Bus) -> Option<ElfLoadResult> {
     if data.len() < 4 || &data[..4] != b"\x7fELF" {
@@ -188,10 +191,12 @@ pub fn try_load_elf(data: &[u8], bus: &mut Bus) -> Option<ElfLoadResult> {
         }
     }
 
-    // Find tohost symbol
-    let tohost_addr = file.symbols().find(|s| s.name() == Ok("tohost")).map(|s| s.address());
+    // Find the tohost and signature-region symbols
+    let symbol = |name: &str| file.symbols().find(|s| s.name() == Ok(name)).map(|s| s.address());
+    let tohost_addr = symbol("tohost");
+    let signature = symbol("begin_signature").zip(symbol("end_signature"));
 
-    Some(ElfLoadResult { entry, tohost_addr })
+    Some(ElfLoadResult { entry, tohost_addr, signature })
 }
 
 #[cfg(test)]
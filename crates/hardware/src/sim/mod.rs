@@ -1,9 +1,19 @@
 //! Simulation utilities, program loading, and the top-level `Simulator`.
 //!
 //! Provides utilities for loading binaries into memory, setting up
-//! the initial system state, and the `Simulator` struct that owns
-//! both the CPU and the pipeline.
+//! the initial system state, the `Simulator` struct that owns
+//! both the CPU and the pipeline, binary checkpoints, and basic-block
+//! vector profiling with `SimPoint` selection for sampled simulation,
+//! streaming interval statistics, cache-only replay of memory-access traces,
+//! multi-hart (SMP) execution, and batched in-process test-suite runs.
 
+pub mod bbv;
+pub mod checkpoint;
 pub mod dtb;
+pub mod interval_stats;
 pub mod loader;
+pub mod replay;
+pub mod simpoint;
 pub mod simulator;
+pub mod smp;
+pub mod suite;
@@ -0,0 +1,178 @@
+//! Cache-only replay of memory-access traces, and predictor-only replay of
+//! branch traces.
+//!
+//! Drives a fresh hart's cache hierarchy from a trace captured with
+//! [`Cpu::open_mem_trace`], with no fetch, decode, or execution. It performs
+//! the following:
+//! 1. **Clocks:** Each record restores the machine cycle the DRAM controller
+//!    reads, and MSHR fills due by the record's MSHR clock are installed
+//!    first, one completion cycle at a time, as the backend's per-cycle
+//!    drain would.
+//! 2. **Dispatch:** Each record is issued through the same `Cpu` port the
+//!    pipeline used (timed or warming walk, non-blocking L1D access, MSHR
+//!    flush, or cache maintenance).
+//!
+//! Replaying under the capturing config reproduces the cache counters of an
+//! in-order run exactly. Under another geometry the access stream and its
+//! timing are the captured ones: feedback of the new hit/miss latencies on
+//! when the program issues its accesses is not modeled (and an O3 pipeline's
+//! stream depends on timing even for the same geometry).
+//!
+//! A branch trace captured with [`Cpu::open_branch_trace`] is replayed
+//! against a bare [`BranchPredictorWrapper`] per config, each on its own host
+//! thread: every retired branch is predicted as fetch would and then trained
+//! as commit would. Branches are retired in program order, so the trace is
+//! independent of the capturing predictor and of the core model.
+
+use crate::common::{AccessType, PhysAddr, SimError};
+use crate::config::Config;
+use crate::core::Cpu;
+use crate::core::cpu::branchtrace::{BranchKind, BranchTraceReader};
+use crate::core::cpu::memtrace::{MemTraceKind, MemTraceReader};
+use crate::core::pipeline::rob::RobTag;
+use crate::core::units::bru::BranchPredictorWrapper;
+use crate::core::units::cache::mshr::MshrWaiter;
+use crate::soc::System;
+use crate::stats::SimStats;
+use std::io::{self, Read};
+use std::num::NonZeroUsize;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::thread;
+
+/// Replays the trace at `path` through a hierarchy built from `config`.
+///
+/// Returns the statistics of the replay: the cache, prefetch, and MSHR
+/// counters, with `cycles` at the last record's machine cycle.
+///
+/// # Errors
+///
+/// Returns [`SimError::MemTraceIo`] if the trace cannot be read or is
+/// malformed.
+pub fn replay_mem_trace(config: &Config, path: &str) -> Result<SimStats, SimError> {
+    let io_err = |source| SimError::MemTraceIo { path: path.to_owned(), source };
+    let mut reader = MemTraceReader::open(path).map_err(io_err)?;
+    let mut cpu = Cpu::new(System::new(config, ""), config);
+    replay(&mut cpu, &mut reader).map_err(io_err)?;
+    Ok(cpu.stats)
+}
+
+/// Issues every remaining record of `reader` to `cpu`'s cache hierarchy.
+///
+/// # Errors
+///
+/// Returns the reader's error for an unreadable or malformed record.
+pub fn replay<R: Read>(cpu: &mut Cpu, reader: &mut MemTraceReader<R>) -> io::Result<()> {
+    while let Some(rec) = reader.next_record()? {
+        cpu.stats.cycles = rec.cycle;
+        while let Some(done) = cpu.l1d_mshrs.next_completion()
+            && done <= rec.clock
+        {
+            cpu.drain_mshr_fills(done, drop);
+        }
+
+        let addr = PhysAddr::new(rec.addr);
+        let size = u64::from(rec.size);
+        match rec.kind {
+            MemTraceKind::Fetch => {
+                let _ = cpu.simulate_memory_access(addr, AccessType::Fetch);
+            }
+            MemTraceKind::Read => {
+                let _ = cpu.simulate_memory_access(addr, AccessType::Read);
+            }
+            MemTraceKind::Write => {
+                let _ = cpu.simulate_memory_access(addr, AccessType::Write);
+            }
+            MemTraceKind::WarmFetch => cpu.warm_memory_access(addr, AccessType::Fetch),
+            MemTraceKind::WarmRead => cpu.warm_memory_access(addr, AccessType::Read),
+            MemTraceKind::WarmWrite => cpu.warm_memory_access(addr, AccessType::Write),
+            MemTraceKind::L1dRead | MemTraceKind::L1dWrite => {
+                let access = if rec.kind == MemTraceKind::L1dWrite {
+                    AccessType::Write
+                } else {
+                    AccessType::Read
+                };
+                let pc = rec.pc.unwrap_or(0);
+                let _ = cpu.access_l1d_nonblocking(addr, access, pc, size, rec.clock, || {
+                    MshrWaiter { rob_tag: RobTag(0), parked_entry: None }
+                });
+            }
+            MemTraceKind::MshrFlush => cpu.flush_mshrs(),
+            MemTraceKind::InvalidateL1i => cpu.invalidate_l1i(),
+            MemTraceKind::FlushL1 => cpu.flush_l1_caches(),
+        }
+    }
+    Ok(())
+}
+
+/// Scores the branch predictor of every config in `configs` on the branch
+/// trace at `path`, replaying up to one config per host thread.
+///
+/// Returns one [`SimStats`] per config, in order, with `inst_branch` counting
+/// every traced branch and jump and `committed_branch_predictions` /
+/// `committed_branch_mispredictions` scoring the conditional branches, as a
+/// full run counts them.
+///
+/// # Errors
+///
+/// Returns [`SimError::BranchTraceIo`] if the trace cannot be read or is
+/// malformed.
+pub fn replay_branch_trace(configs: &[Config], path: &str) -> Result<Vec<SimStats>, SimError> {
+    let workers = thread::available_parallelism().map_or(1, NonZeroUsize::get).min(configs.len());
+    let next = AtomicUsize::new(0);
+    let mut results: Vec<Option<Result<SimStats, SimError>>> =
+        configs.iter().map(|_| None).collect();
+    thread::scope(|s| {
+        let handles: Vec<_> = (0..workers)
+            .map(|_| {
+                s.spawn(|| {
+                    let mut done = Vec::new();
+                    loop {
+                        let i = next.fetch_add(1, Ordering::Relaxed);
+                        let Some(config) = configs.get(i) else { break done };
+                        done.push((i, replay_branches(config, path)));
+                    }
+                })
+            })
+            .collect();
+        for handle in handles {
+            let done = handle.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic));
+            for (i, result) in done {
+                results[i] = Some(result);
+            }
+        }
+    });
+    results.into_iter().flatten().collect()
+}
+
+/// Replays the trace at `path` against a predictor built from `config`.
+fn replay_branches(config: &Config, path: &str) -> Result<SimStats, SimError> {
+    let io_err = |source| SimError::BranchTraceIo { path: path.to_owned(), source };
+    let mut reader = BranchTraceReader::open(path).map_err(io_err)?;
+    let mut bp = BranchPredictorWrapper::new(config);
+    score_branches(&mut bp, &mut reader).map_err(io_err)
+}
+
+/// Predicts, scores, and trains `bp` on every remaining record of `reader`.
+///
+/// # Errors
+///
+/// Returns the reader's error for an unreadable or malformed record.
+pub fn score_branches<R: Read>(
+    bp: &mut BranchPredictorWrapper,
+    reader: &mut BranchTraceReader<R>,
+) -> io::Result<SimStats> {
+    let mut stats = SimStats::default();
+    while let Some(rec) = reader.next_record()? {
+        let mispredicted = rec.mispredicted_by(bp);
+        rec.train(bp);
+        stats.inst_branch += 1;
+        if rec.kind == BranchKind::Conditional {
+            if mispredicted {
+                stats.committed_branch_mispredictions += 1;
+            } else {
+                stats.committed_branch_predictions += 1;
+            }
+        }
+    }
+    Ok(stats)
+}
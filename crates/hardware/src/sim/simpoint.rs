@@ -0,0 +1,265 @@
+//! `SimPoint` selection from basic-block vectors.
+//!
+//! Picks a small set of representative intervals whose weighted statistics
+//! estimate the whole program, following the `SimPoint` 3.0 method:
+//! 1. **Normalize:** Each interval's BBV is scaled to sum to 1.
+//! 2. **Project:** Vectors are randomly projected down to [`PROJECTED_DIMS`]
+//!    dimensions, which keeps k-means cheap regardless of code size.
+//! 3. **Cluster:** k-means (k-means++ seeding) runs for every `k` up to
+//!    `max_k`; the smallest `k` whose BIC score reaches 90% of the observed
+//!    BIC range is kept.
+//! 4. **Select:** The interval closest to each centroid represents its
+//!    cluster, weighted by the fraction of intervals in the cluster.
+
+use super::bbv::BasicBlockVector;
+
+/// Dimensions after random projection (`SimPoint` default).
+pub const PROJECTED_DIMS: usize = 15;
+
+/// Fraction of the BIC range the chosen clustering must reach.
+const BIC_THRESHOLD: f64 = 0.9;
+
+/// Maximum Lloyd iterations per k-means run.
+const MAX_ITERATIONS: usize = 100;
+
+/// A representative interval and the fraction of execution it stands for.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SimPoint {
+    /// Zero-based interval index into the profiled BBV sequence.
+    pub interval: usize,
+    /// Fraction of all intervals this point represents (weights sum to 1).
+    pub weight: f64,
+}
+
+type Point = [f64; PROJECTED_DIMS];
+
+/// Chooses simulation points for the given intervals.
+///
+/// Returns at most `max_k` points sorted by interval index. The result is
+/// deterministic for a given `seed`.
+pub fn pick_simpoints(intervals: &[BasicBlockVector], max_k: usize, seed: u64) -> Vec<SimPoint> {
+    if intervals.is_empty() {
+        return Vec::new();
+    }
+    let points: Vec<Point> = intervals.iter().map(|bbv| project(bbv, seed)).collect();
+    let max_k = max_k.clamp(1, points.len());
+
+    let runs: Vec<(Vec<usize>, Vec<Point>, f64)> = (1..=max_k)
+        .map(|k| {
+            let (assign, centroids) = kmeans(&points, k, seed);
+            let score = bic(&points, &assign, &centroids);
+            (assign, centroids, score)
+        })
+        .collect();
+
+    let (lo, hi) = runs
+        .iter()
+        .fold((f64::INFINITY, f64::NEG_INFINITY), |(lo, hi), r| (lo.min(r.2), hi.max(r.2)));
+    let cutoff = BIC_THRESHOLD.mul_add(hi - lo, lo);
+    let Some((assign, centroids, _)) = runs.iter().find(|r| r.2 >= cutoff) else {
+        return Vec::new();
+    };
+
+    let n = points.len() as f64;
+    let mut picks: Vec<SimPoint> = centroids
+        .iter()
+        .enumerate()
+        .filter_map(|(c, centroid)| {
+            let members = (0..points.len()).filter(|&i| assign[i] == c);
+            let size = members.clone().count();
+            let rep = members.min_by(|&a, &b| {
+                dist2(&points[a], centroid).total_cmp(&dist2(&points[b], centroid))
+            })?;
+            Some(SimPoint { interval: rep, weight: size as f64 / n })
+        })
+        .collect();
+    picks.sort_unstable_by_key(|p| p.interval);
+    picks
+}
+
+/// `SplitMix64` step, used for both projection and seeding.
+const fn splitmix64(mut x: u64) -> u64 {
+    x = x.wrapping_add(0x9E37_79B9_7F4A_7C15);
+    x = (x ^ (x >> 30)).wrapping_mul(0xBF58_476D_1CE4_E5B9);
+    x = (x ^ (x >> 27)).wrapping_mul(0x94D0_49BB_1331_11EB);
+    x ^ (x >> 31)
+}
+
+/// Maps a hash to a uniform value in `[-1, 1)`.
+fn unit(h: u64) -> f64 {
+    ((h >> 11) as f64 / (1u64 << 52) as f64) - 1.0
+}
+
+/// Normalizes a BBV and projects it onto the random basis.
+///
+/// The projection matrix is never materialized: each block's row is derived
+/// from a hash of `(seed, block id, dimension)`.
+fn project(bbv: &BasicBlockVector, seed: u64) -> Point {
+    let total: u64 = bbv.iter().map(|&(_, c)| c).sum();
+    let mut p = [0.0; PROJECTED_DIMS];
+    if total == 0 {
+        return p;
+    }
+    for &(id, count) in bbv {
+        let freq = count as f64 / total as f64;
+        let row = splitmix64(seed ^ (u64::from(id) << 8));
+        for (d, v) in p.iter_mut().enumerate() {
+            *v = freq.mul_add(unit(splitmix64(row ^ d as u64)), *v);
+        }
+    }
+    p
+}
+
+fn dist2(a: &Point, b: &Point) -> f64 {
+    a.iter().zip(b).map(|(x, y)| (x - y) * (x - y)).sum()
+}
+
+/// Index of the centroid nearest to `p`.
+fn nearest(p: &Point, centroids: &[Point]) -> usize {
+    let mut best = (0, f64::INFINITY);
+    for (c, centroid) in centroids.iter().enumerate() {
+        let d = dist2(p, centroid);
+        if d < best.1 {
+            best = (c, d);
+        }
+    }
+    best.0
+}
+
+/// Lloyd's k-means with k-means++ seeding. Returns assignments and centroids.
+fn kmeans(points: &[Point], k: usize, seed: u64) -> (Vec<usize>, Vec<Point>) {
+    let mut rng = splitmix64(seed ^ k as u64);
+    let mut next = || {
+        rng = splitmix64(rng);
+        (rng >> 11) as f64 / (1u64 << 53) as f64
+    };
+
+    let first = ((next() * points.len() as f64) as usize).min(points.len() - 1);
+    let mut centroids = vec![points[first]];
+    while centroids.len() < k {
+        let d: Vec<f64> =
+            points.iter().map(|p| dist2(p, &centroids[nearest(p, &centroids)])).collect();
+        let total: f64 = d.iter().sum();
+        if total <= 0.0 {
+            // Fewer distinct points than clusters.
+            break;
+        }
+        let mut target = next() * total;
+        let pick = d
+            .iter()
+            .position(|&w| {
+                target -= w;
+                target <= 0.0
+            })
+            .unwrap_or(points.len() - 1);
+        centroids.push(points[pick]);
+    }
+
+    let mut assign = vec![0; points.len()];
+    for _ in 0..MAX_ITERATIONS {
+        let mut changed = false;
+        for (a, p) in assign.iter_mut().zip(points) {
+            let c = nearest(p, &centroids);
+            if *a != c {
+                *a = c;
+                changed = true;
+            }
+        }
+        let mut sums = vec![[0.0; PROJECTED_DIMS]; centroids.len()];
+        let mut sizes = vec![0usize; centroids.len()];
+        for (&a, p) in assign.iter().zip(points) {
+            sizes[a] += 1;
+            for (s, v) in sums[a].iter_mut().zip(p) {
+                *s += v;
+            }
+        }
+        for ((centroid, sum), &size) in centroids.iter_mut().zip(&sums).zip(&sizes) {
+            if size > 0 {
+                for (c, s) in centroid.iter_mut().zip(sum) {
+                    *c = s / size as f64;
+                }
+            }
+        }
+        if !changed {
+            break;
+        }
+    }
+    (assign, centroids)
+}
+
+/// Bayesian Information Criterion of a clustering (spherical Gaussians,
+/// Pelleg & Moore); larger is better.
+fn bic(points: &[Point], assign: &[usize], centroids: &[Point]) -> f64 {
+    let r = points.len() as f64;
+    let k = centroids.len() as f64;
+    let m = PROJECTED_DIMS as f64;
+
+    let sse: f64 = assign.iter().zip(points).map(|(&a, p)| dist2(p, &centroids[a])).sum();
+    let variance = (sse / (r - k).max(1.0) / m).max(f64::MIN_POSITIVE);
+
+    let mut sizes = vec![0usize; centroids.len()];
+    for &a in assign {
+        sizes[a] += 1;
+    }
+    // Per-point Gaussian normalization term, shared by every cluster.
+    let norm = (-0.5f64).mul_add((2.0 * std::f64::consts::PI).ln(), -(m / 2.0 * variance.ln()));
+    let log_likelihood: f64 = sizes
+        .iter()
+        .filter(|&&n| n > 0)
+        .map(|&n| {
+            let n = n as f64;
+            n.mul_add(n.ln() - r.ln() + norm, -(n - k) / 2.0)
+        })
+        .sum();
+    // (k - 1) mixture weights + k * m centroid coordinates + 1 variance.
+    let params = m.mul_add(k, k);
+    (params / 2.0).mul_add(-r.ln(), log_likelihood)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Two distinct phases: A uses blocks 1-2, B uses blocks 3-4.
+    fn two_phase(a: usize, b: usize) -> Vec<BasicBlockVector> {
+        let phase_a = vec![(1, 900), (2, 100)];
+        let phase_b = vec![(3, 500), (4, 500)];
+        std::iter::repeat_n(phase_a, a).chain(std::iter::repeat_n(phase_b, b)).collect()
+    }
+
+    #[test]
+    fn test_empty_profile_has_no_points() {
+        assert!(pick_simpoints(&[], 10, 1).is_empty());
+    }
+
+    #[test]
+    fn test_single_phase_picks_one_point() {
+        let picks = pick_simpoints(&two_phase(8, 0), 5, 1);
+        assert_eq!(picks.len(), 1);
+        assert!((picks[0].weight - 1.0).abs() < 1e-12);
+    }
+
+    #[test]
+    fn test_two_phases_are_weighted_by_size() {
+        let picks = pick_simpoints(&two_phase(6, 2), 5, 1);
+        assert_eq!(picks.len(), 2);
+        assert!(picks[0].interval < 6);
+        assert!(picks[1].interval >= 6);
+        assert!((picks[0].weight - 0.75).abs() < 1e-12);
+        assert!((picks[1].weight - 0.25).abs() < 1e-12);
+    }
+
+    #[test]
+    fn test_weights_sum_to_one() {
+        let mut intervals = two_phase(5, 5);
+        intervals.push(vec![(5, 10)]);
+        let total: f64 = pick_simpoints(&intervals, 8, 7).iter().map(|p| p.weight).sum();
+        assert!((total - 1.0).abs() < 1e-12);
+    }
+
+    #[test]
+    fn test_selection_is_deterministic() {
+        let intervals = two_phase(4, 4);
+        assert_eq!(pick_simpoints(&intervals, 4, 42), pick_simpoints(&intervals, 4, 42));
+    }
+}
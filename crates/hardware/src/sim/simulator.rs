@@ -4,13 +4,51 @@
 //! `Option<PipelineDispatch>` inside `Cpu` and temporarily `take()`-en each tick.
 
 use crate::common::SimError;
-use crate::config::Config;
+use crate::config::{Config, FastForwardConfig, RoiConfig};
 use crate::core::Cpu;
-use crate::core::pipeline::backend::inorder::InOrderEngine;
-use crate::core::pipeline::backend::o3::O3Engine;
-use crate::core::pipeline::engine::{BackendType, Pipeline, PipelineDispatch};
-use crate::core::pipeline::frontend::Frontend;
+use crate::core::arch::csr::{SIM_MARKER_ROI_BEGIN, SIM_MARKER_ROI_END};
+use crate::core::cpu::dbt::BlockLimits;
+use crate::core::pipeline::engine::PipelineDispatch;
+use crate::core::pipeline::history::PipelineHistory;
+use crate::sim::bbv::BbvProfiler;
+use crate::sim::smp::Smp;
 use crate::soc::System;
+use crate::stats::SimStats;
+use std::borrow::Cow;
+use std::path::Path;
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// Cycles between polls of the stop flag in [`Simulator::run_batch`].
+const STOP_POLL_CYCLES: u64 = 4096;
+
+/// Execution engine currently driving the simulation.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum ExecMode {
+    /// Cycle-level pipeline model (frontend + backend engine).
+    Detailed,
+    /// Functional fast-forward: one instruction per cycle, no timing model.
+    Functional,
+}
+
+/// Stop conditions for [`Simulator::run_batch`]; `None` means unbounded.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct RunLimits {
+    /// Maximum cycles to simulate.
+    pub cycles: Option<u64>,
+    /// Maximum instructions to retire (on hart 0).
+    pub instructions: Option<u64>,
+}
+
+/// Why [`Simulator::run_batch`] returned.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum BatchExit {
+    /// The guest finished with this exit code.
+    Exited(u64),
+    /// A [`RunLimits`] bound was reached.
+    Limit,
+    /// The stop flag was raised.
+    Stopped,
+}
 
 /// Top-level simulator: CPU architectural state + pipeline.
 #[derive(Debug)]
@@ -19,6 +57,24 @@ pub struct Simulator {
     pub cpu: Cpu,
     /// Pipeline implementation (frontend + backend engine).
     pub pipeline: PipelineDispatch,
+    /// Active execution engine.
+    pub mode: ExecMode,
+    /// Fast-forward switchover triggers.
+    fast_forward: FastForwardConfig,
+    /// Basic-block vector profiler, fed by the functional engine.
+    pub bbv: Option<BbvProfiler>,
+    /// Harts 1..N of a multi-hart system (this simulator is hart 0).
+    pub smp: Option<Box<Smp>>,
+    /// Recent detailed cycles of pipeline state (see [`Self::record_history`]).
+    pub history: Option<PipelineHistory>,
+    /// Skip WFI idle cycles in the run loops (see [`Self::skip_idle`]).
+    idle_skip: bool,
+    /// Region-of-interest marker handling.
+    roi: RoiConfig,
+    /// Statistics snapshot taken when the region of interest began.
+    roi_base: Option<SimStats>,
+    /// Region-of-interest statistics, frozen when it ended.
+    roi_stats: Option<SimStats>,
 }
 
 unsafe impl Send for Simulator {}
@@ -26,31 +82,212 @@ unsafe impl Sync for Simulator {}
 
 impl Simulator {
     /// Creates a new simulator with the given system and configuration.
+    ///
+    /// For a multi-hart system this simulator drives hart 0 and owns the
+    /// other harts in [`Self::smp`].
     pub fn new(system: System, config: &Config) -> Self {
-        let cpu = Cpu::new(system, config);
-        let pipeline = match config.pipeline.backend {
-            BackendType::InOrder => PipelineDispatch::InOrder(Box::new(Pipeline {
-                frontend: Frontend::new(config.pipeline.width),
-                engine: InOrderEngine::new(config),
-                rename_output: Vec::with_capacity(config.pipeline.width),
-            })),
-            BackendType::OutOfOrder => PipelineDispatch::OutOfOrder(Box::new(Pipeline {
-                frontend: Frontend::new(config.pipeline.width),
-                engine: O3Engine::new(config),
-                rename_output: Vec::with_capacity(config.pipeline.width),
-            })),
+        let smp = Smp::new(&system, config);
+        Self::assemble(Cpu::new(system, config), config, smp)
+    }
+
+    /// Replaces this simulator with a fresh one for `system` and `config`.
+    ///
+    /// The result matches [`Self::new`], but a single-hart simulator keeps
+    /// its cache arrays (see [`Cpu::rebuild`]), so running many short
+    /// programs back to back does not reallocate the cache hierarchy for
+    /// each. Multi-hart systems are rebuilt from scratch.
+    pub fn reset(&mut self, system: System, config: &Config) {
+        let smp = Smp::new(&system, config);
+        let cpu = if smp.is_some() || self.smp.is_some() {
+            Cpu::new(system, config)
+        } else {
+            self.cpu.rebuild(system, config)
         };
-        Self { cpu, pipeline }
+        *self = Self::assemble(cpu, config, smp);
+    }
+
+    /// Wraps hart 0's CPU and connects the secondary harts, if any.
+    fn assemble(cpu: Cpu, config: &Config, smp: Option<Box<Smp>>) -> Self {
+        let mut sim = Self::with_cpu(cpu, config);
+        if let Some(mut smp) = smp {
+            smp.connect(&mut sim.cpu, config);
+            sim.smp = Some(smp);
+        }
+        sim
+    }
+
+    /// Creates a simulator for one hart.
+    pub(super) fn single(system: System, config: &Config) -> Self {
+        Self::with_cpu(Cpu::new(system, config), config)
+    }
+
+    /// Creates a simulator for one hart around an already-built CPU.
+    fn with_cpu(cpu: Cpu, config: &Config) -> Self {
+        let pipeline = PipelineDispatch::new(config);
+        let fast_forward = config.general.fast_forward;
+        let mode = if fast_forward.enabled { ExecMode::Functional } else { ExecMode::Detailed };
+        let bbv = fast_forward.bbv_interval.map(BbvProfiler::new);
+        let idle_skip = config.general.idle_skip;
+        Self {
+            cpu,
+            pipeline,
+            mode,
+            fast_forward,
+            bbv,
+            smp: None,
+            history: None,
+            idle_skip,
+            roi: config.general.roi.clone(),
+            roi_base: None,
+            roi_stats: None,
+        }
     }
 
     /// Synchronize the architectural register file into the O3 PRF.
     ///
     /// Must be called after all register initialization (loader setup, etc.)
     /// but before the first pipeline tick. For the in-order backend this is a no-op.
+    /// In a multi-hart system, the other harts first take hart 0's boot state.
     pub fn sync_arch_regs(&mut self) {
+        if let Some(smp) = self.smp.as_mut() {
+            smp.mirror_boot_state(&self.cpu);
+        }
+        self.sync_prf();
+    }
+
+    /// Copies this hart's architectural registers into the O3 PRF.
+    pub(super) fn sync_prf(&mut self) {
         if let PipelineDispatch::OutOfOrder(ref mut p) = self.pipeline {
-            p.engine.sync_arch_regs(&self.cpu);
+            p.engine_mut().sync_arch_regs(&self.cpu);
+        }
+    }
+
+    /// Hands execution from the functional engine to the detailed pipeline.
+    ///
+    /// The pipeline has never run while fast-forwarding, so it only needs the
+    /// architectural registers copied in and the frontend pointed at `cpu.pc`.
+    pub fn switch_to_detailed(&mut self) {
+        if self.mode == ExecMode::Detailed {
+            return;
+        }
+        self.mode = ExecMode::Detailed;
+        self.cpu.committed_next_pc = self.cpu.pc;
+        self.cpu.redirect_pending = true;
+        self.sync_prf();
+        if self.cpu.trace {
+            ::tracing::debug!(
+                target: "rvsim::cpu",
+                cycles  = self.cpu.stats.cycles,
+                instret = self.cpu.stats.instructions_retired,
+                pc      = %crate::trace::Hex(self.cpu.pc),
+                "Fast-forward complete, switching to detailed pipeline"
+            );
+        }
+    }
+
+    /// Hands execution from the detailed pipeline back to the functional engine.
+    ///
+    /// Everything in flight is squashed and committed stores are written to
+    /// memory, so the functional engine resumes right after the last commit.
+    /// The PC and instruction-count triggers have had their turn by now and
+    /// are disarmed; only a marker switches back to the detailed pipeline.
+    pub fn switch_to_functional(&mut self) {
+        if self.mode == ExecMode::Functional {
+            return;
+        }
+        self.pipeline.drain(&mut self.cpu);
+        self.mode = ExecMode::Functional;
+        self.cpu.pc = self.cpu.committed_next_pc;
+        self.fast_forward.until_pc = None;
+        self.fast_forward.until_instructions = None;
+        if self.cpu.trace {
+            ::tracing::debug!(
+                target: "rvsim::cpu",
+                cycles  = self.cpu.stats.cycles,
+                instret = self.cpu.stats.instructions_retired,
+                pc      = %crate::trace::Hex(self.cpu.pc),
+                "Region of interest complete, switching to functional engine"
+            );
+        }
+    }
+
+    /// Statistics to report.
+    ///
+    /// With `general.roi.stats` these count from the last `roi_begin` and are
+    /// frozen at the following `roi_end`; otherwise they are `cpu.stats`.
+    /// `cpu.stats` itself is never reset: its cycle count is the machine
+    /// clock, and run limits count from it.
+    pub fn stats(&self) -> Cow<'_, SimStats> {
+        match (&self.roi_stats, &self.roi_base) {
+            (Some(frozen), _) => Cow::Borrowed(frozen),
+            (None, Some(base)) => Cow::Owned(self.cpu.stats.since(base)),
+            (None, None) => Cow::Borrowed(&self.cpu.stats),
+        }
+    }
+
+    /// Acts on a region-of-interest marker the guest wrote this cycle.
+    ///
+    /// `roi_begin` saves the configured checkpoint and switches to the
+    /// detailed pipeline (with `roi.detailed` or `fast_forward.until_marker`)
+    /// if the hart is fast-forwarding, then snapshots the statistics. `roi_end`
+    /// freezes the counts since then and returns to the functional engine (with
+    /// `roi.detailed`). Other marker values, and every marker while no ROI
+    /// option is set, are left for the fast-forward trigger.
+    ///
+    /// # Errors
+    ///
+    /// Returns the error from [`Self::save_checkpoint`].
+    fn handle_roi_marker(&mut self) -> Result<(), SimError> {
+        let Some(marker @ (SIM_MARKER_ROI_BEGIN | SIM_MARKER_ROI_END)) = self.cpu.sim_marker else {
+            return Ok(());
+        };
+        if !self.roi.is_enabled() {
+            return Ok(());
+        }
+        self.cpu.sim_marker = None;
+        if marker == SIM_MARKER_ROI_BEGIN {
+            if self.mode == ExecMode::Functional {
+                if let Some(path) = self.roi.checkpoint.clone() {
+                    self.save_checkpoint(Path::new(&path))?;
+                }
+                if self.roi.detailed || self.fast_forward.until_marker {
+                    self.switch_to_detailed();
+                }
+            }
+            if self.roi.stats {
+                self.roi_base = Some(self.cpu.stats.snapshot());
+                self.roi_stats = None;
+            }
+        } else {
+            if self.roi.stats
+                && let Some(base) = &self.roi_base
+            {
+                self.roi_stats = Some(self.cpu.stats.since(base));
+            }
+            if self.roi.detailed {
+                self.switch_to_functional();
+            }
         }
+        Ok(())
+    }
+
+    /// Starts keeping the pipeline state of the last `cycles` detailed
+    /// cycles in [`Self::history`], replacing any earlier history.
+    ///
+    /// Storage for every record is allocated here, so recording costs a
+    /// copy of each latch's PCs and encodings per cycle and no allocation.
+    /// Cycles run in the functional engine or skipped as WFI idle time (see
+    /// [`Self::skip_idle`]) are not recorded.
+    pub fn record_history(&mut self, cycles: usize) {
+        self.history = Some(PipelineHistory::new(cycles, self.cpu.pipeline_width));
+    }
+
+    /// Returns true once any configured fast-forward trigger has fired.
+    fn fast_forward_reached(&mut self) -> bool {
+        let ff = &self.fast_forward;
+        ff.until_pc.is_some_and(|pc| self.cpu.pc == pc && !self.cpu.wfi_waiting)
+            || ff.until_instructions.is_some_and(|n| self.cpu.stats.instructions_retired >= n)
+            || (ff.until_marker && self.cpu.sim_marker.take().is_some())
     }
 
     /// Advances the simulator by one clock cycle.
@@ -62,17 +299,200 @@ impl Simulator {
     ///
     /// Returns [`SimError::KernelPanic`] if the guest OS panic sentinel fires.
     pub fn tick(&mut self) -> Result<(), SimError> {
+        self.tick_hart()?;
+        if let Some(smp) = self.smp.as_mut() {
+            smp.tick(&mut self.cpu)?;
+        }
+        Ok(())
+    }
+
+    /// Runs up to `cycles` cycles, stopping early when the guest exits.
+    ///
+    /// Returns the exit code if the guest finished. A multi-hart system runs
+    /// each hart on its own host thread (see [`crate::sim::smp`]); a single
+    /// hart runs translated blocks while fast-forwarding (see
+    /// [`Self::run_translated`]) and skips WFI idle time (see [`Self::skip_idle`]).
+    ///
+    /// # Errors
+    ///
+    /// Returns the first error any hart's [`Self::tick`] raised.
+    pub fn run(&mut self, cycles: u64) -> Result<Option<u64>, SimError> {
+        let Some(mut smp) = self.smp.take() else {
+            let mut ran = 0;
+            while ran < cycles {
+                self.tick()?;
+                ran += 1;
+                ran += self.run_translated(cycles - ran, None)?;
+                if let Some(code) = self.take_exit() {
+                    return Ok(Some(code));
+                }
+                ran += self.skip_idle(cycles - ran);
+            }
+            return Ok(None);
+        };
+        let result = smp.run(self, cycles);
+        self.smp = Some(smp);
+        result
+    }
+
+    /// Runs until the guest exits, a limit is reached, or `stop` is raised.
+    ///
+    /// This is the batch entry point for hosts that drive the simulator from
+    /// another thread (e.g. with the Python GIL released): nothing but `stop`
+    /// is shared, and it is polled every few thousand cycles rather than per
+    /// cycle. A raised flag is left set; clearing it is up to the caller.
+    ///
+    /// A multi-hart system without an instruction limit runs its harts in
+    /// parallel (see [`Self::run`]); otherwise harts tick in lockstep.
+    ///
+    /// # Errors
+    ///
+    /// Returns the first error any hart's [`Self::tick`] raised.
+    pub fn run_batch(
+        &mut self,
+        limits: RunLimits,
+        stop: &AtomicBool,
+    ) -> Result<BatchExit, SimError> {
+        let start_insts = self.cpu.stats.instructions_retired;
+        let max_insts = limits.instructions.map(|n| start_insts.saturating_add(n));
+        let mut remaining = limits.cycles.unwrap_or(u64::MAX);
+        while remaining > 0 {
+            if stop.load(Ordering::Relaxed) {
+                return Ok(BatchExit::Stopped);
+            }
+            let block = remaining.min(STOP_POLL_CYCLES);
+            remaining -= block;
+            if self.smp.is_some() && limits.instructions.is_none() {
+                if let Some(code) = self.run(block)? {
+                    return Ok(BatchExit::Exited(code));
+                }
+                continue;
+            }
+            let mut ran = 0;
+            while ran < block {
+                if limits.instructions.is_some_and(|n| {
+                    self.cpu.stats.instructions_retired.saturating_sub(start_insts) >= n
+                }) {
+                    return Ok(BatchExit::Limit);
+                }
+                self.tick()?;
+                ran += 1;
+                ran += self.run_translated(block - ran, max_insts)?;
+                if let Some(code) = self.take_exit() {
+                    return Ok(BatchExit::Exited(code));
+                }
+                ran += self.skip_idle(block - ran);
+            }
+        }
+        Ok(BatchExit::Limit)
+    }
+
+    /// Runs up to `max` cycles of translated code while fast-forwarding.
+    ///
+    /// With `fast_forward.dbt` set, hot basic blocks run from the hart's
+    /// translated-block tier (see [`crate::core::cpu::dbt`]), cycle for cycle
+    /// as [`Self::tick`] would run them, stopping before any fast-forward
+    /// trigger fires and once `max_instructions` (an absolute retired count)
+    /// is reached. Returns the cycles run: 0 in the detailed engine, in a
+    /// multi-hart system, while collecting basic-block vectors, or until the
+    /// current PC starts a hot block.
+    ///
+    /// # Errors
+    ///
+    /// Returns [`SimError::KernelPanic`] if the guest panic sentinel fires.
+    pub fn run_translated(
+        &mut self,
+        max: u64,
+        max_instructions: Option<u64>,
+    ) -> Result<u64, SimError> {
+        if self.mode != ExecMode::Functional || self.smp.is_some() || self.bbv.is_some() || max == 0
+        {
+            return Ok(0);
+        }
+        let ff = &self.fast_forward;
+        if ff.until_marker && self.cpu.sim_marker.is_some() {
+            return Ok(0);
+        }
+        let max_instructions = match (ff.until_instructions, max_instructions) {
+            (Some(a), Some(b)) => Some(a.min(b)),
+            (a, b) => a.or(b),
+        };
+        self.cpu.run_blocks(max, BlockLimits { stop_pc: ff.until_pc, max_instructions })
+    }
+
+    /// Accounts up to `max` cycles of WFI idle time in one step.
+    ///
+    /// While the hart waits in WFI with no enabled interrupt pending and
+    /// nothing in flight, every tick until the next device event (CLINT
+    /// deadline, UART stdin poll, Sstc compare) only advances the clocks.
+    /// This advances `stats.cycles`, device time (`mtime`), and the WFI,
+    /// mode, and retire counters over all of them at once, exactly as
+    /// ticking would. Returns the number of cycles skipped: 0 when disabled
+    /// (`general.idle_skip`), in a multi-hart system, or when anything is
+    /// still in flight.
+    pub fn skip_idle(&mut self, max: u64) -> u64 {
+        if !self.idle_skip || self.smp.is_some() || max == 0 {
+            return 0;
+        }
+        let detailed = self.mode == ExecMode::Detailed;
+        if detailed && !self.pipeline.is_idle(&self.cpu) {
+            return 0;
+        }
+        // A pending fast-forward trigger must see its switchover tick.
+        let ff = &self.fast_forward;
+        if !detailed
+            && (ff.until_instructions.is_some_and(|n| self.cpu.stats.instructions_retired >= n)
+                || (ff.until_marker && self.cpu.sim_marker.is_some()))
+        {
+            return 0;
+        }
+        let cycles = self.cpu.idle_cycles().min(max);
+        if cycles > 0 {
+            self.cpu.advance_idle(cycles);
+            if detailed {
+                self.pipeline.advance_idle(&mut self.cpu, cycles);
+            }
+        }
+        cycles
+    }
+
+    /// Advances this hart alone by one clock cycle.
+    pub(super) fn tick_hart(&mut self) -> Result<(), SimError> {
         let prev_priv = self.cpu.privilege;
         let skip = self.cpu.pre_tick()?;
         if !skip {
-            self.pipeline.tick(&mut self.cpu);
+            if self.mode == ExecMode::Functional && self.fast_forward_reached() {
+                self.switch_to_detailed();
+            }
+            match self.mode {
+                ExecMode::Detailed => {
+                    self.pipeline.tick(&mut self.cpu);
+                    if let Some(history) = self.history.as_mut() {
+                        let mut frame = history.push(self.cpu.stats.cycles);
+                        self.pipeline.record(self.cpu.pipeline_width, &mut frame);
+                    }
+                }
+                ExecMode::Functional => self.step_functional(),
+            }
         }
         self.cpu.post_tick(prev_priv);
-        Ok(())
+        self.handle_roi_marker()
+    }
+
+    /// Runs one functional step, feeding the BBV profiler when it retires.
+    fn step_functional(&mut self) {
+        let pc = self.cpu.pc;
+        let retired = self.cpu.stats.instructions_retired;
+        self.cpu.step_functional();
+        if let Some(bbv) = self.bbv.as_mut()
+            && self.cpu.stats.instructions_retired != retired
+        {
+            bbv.record(pc, self.cpu.pc);
+        }
     }
 
-    /// Retrieves the exit code if the simulation has finished.
-    pub const fn take_exit(&mut self) -> Option<u64> {
-        self.cpu.take_exit()
+    /// Retrieves the exit code if the simulation has finished (on any hart).
+    pub fn take_exit(&mut self) -> Option<u64> {
+        self.cpu.take_exit().or_else(|| self.smp.as_mut()?.take_exit())
     }
 }
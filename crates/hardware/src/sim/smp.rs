@@ -0,0 +1,205 @@
+//! Multi-hart (SMP) simulation.
+//!
+//! Hart 0 is the owning [`Simulator`]; [`Smp`] holds harts 1..N, each a full
+//! `Simulator` over its own view of the shared uncore. It provides:
+//! 1. **Lockstep:** [`Simulator::tick`] advances every hart by one cycle, then
+//!    the uncore. Deterministic; used for single-stepping and tests.
+//! 2. **Threaded quanta:** [`Simulator::run`] runs each hart on its own host
+//!    thread for `smp_quantum` cycles at a time. At each quantum boundary the
+//!    harts meet at a barrier, the uncore's device time advances by the
+//!    quantum, and exit and kernel-panic conditions are checked.
+//! 3. **Sharing:** All harts share main memory, the uncore devices, one L3,
+//!    and an [`AtomicDomain`] for LR/SC and AMOs. The private L1-D/L2 are
+//!    kept coherent by a [`Coherence`] directory.
+
+use super::simulator::Simulator;
+use crate::common::{RegIdx, SimError};
+use crate::config::Config;
+use crate::core::Cpu;
+use crate::core::units::cache::CacheSim;
+use crate::core::units::cache::coherence::{Coherence, CoherenceAgent};
+use crate::isa::abi;
+use crate::soc::System;
+use crate::soc::uncore::{AtomicDomain, SharedUncore, lock};
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Barrier, Mutex};
+
+/// Cycles a kernel panic banner is allowed to finish printing before the run fails.
+const PANIC_GRACE_CYCLES: u64 = 10_000;
+
+/// Harts 1..N of an SMP simulation and the uncore they share with hart 0.
+#[derive(Debug)]
+pub struct Smp {
+    /// Secondary harts, in hart-id order starting at hart 1.
+    pub harts: Vec<Simulator>,
+    uncore: SharedUncore,
+    /// Cycles each hart runs between synchronizations in [`Simulator::run`].
+    quantum: u64,
+}
+
+/// Outcome shared by the hart threads of one [`Simulator::run`] call.
+#[derive(Debug, Default)]
+struct RunState {
+    exit: Option<u64>,
+    error: Option<SimError>,
+}
+
+impl Smp {
+    /// Builds the secondary harts of `system`. Returns `None` for a single-hart system.
+    pub(super) fn new(system: &System, config: &Config) -> Option<Box<Self>> {
+        let uncore = Arc::clone(system.uncore.as_ref()?);
+        let harts = lock(&uncore).harts();
+        let harts = (1..harts)
+            .filter_map(|hart| system.secondary(config, hart))
+            .map(|hart| Simulator::single(hart, config))
+            .collect();
+        Some(Box::new(Self { harts, uncore, quantum: config.system.smp_quantum.max(1) }))
+    }
+
+    /// Wires `primary` and the secondaries to one shared L3, atomic domain,
+    /// and (when they have private data caches) coherence directory.
+    pub(super) fn connect(&mut self, primary: &mut Cpu, config: &Config) {
+        let harts = self.harts.len() + 1;
+        let atomics = Arc::new(AtomicDomain::new(harts));
+        let l3 = Arc::new(Mutex::new(CacheSim::new(&config.cache.l3)));
+        let cache = &config.cache;
+        let coherence = (cache.l1_d.enabled || cache.l2.enabled)
+            .then(|| Arc::new(Coherence::new(harts, cache.coherence.protocol)));
+        for cpu in std::iter::once(primary).chain(self.harts.iter_mut().map(|sim| &mut sim.cpu)) {
+            cpu.atomics = Some(Arc::clone(&atomics));
+            cpu.shared_l3 = Some(Arc::clone(&l3));
+            cpu.coherence = coherence.as_ref().map(|dir| {
+                CoherenceAgent::new(
+                    Arc::clone(dir),
+                    cpu.hart_id,
+                    cache.l1_d.line_bytes,
+                    cache.coherence,
+                )
+            });
+        }
+    }
+
+    /// Copies hart 0's boot state (PC, privilege, CSRs, registers) to every
+    /// secondary, with `a0` holding the hart id as firmware expects.
+    pub(super) fn mirror_boot_state(&mut self, primary: &Cpu) {
+        for sim in &mut self.harts {
+            let cpu = &mut sim.cpu;
+            cpu.pc = primary.pc;
+            cpu.privilege = primary.privilege;
+            cpu.csrs = primary.csrs.clone();
+            cpu.htif_range = primary.htif_range;
+            for r in 1..32 {
+                let idx = RegIdx::new(r);
+                cpu.regs.write(idx, primary.regs.read(idx));
+                cpu.regs.write_f(idx, primary.regs.read_f(idx));
+            }
+            cpu.regs.write(abi::REG_A0, cpu.hart_id as u64);
+            sim.sync_prf();
+        }
+    }
+
+    /// Returns the first pending exit code of a secondary hart.
+    pub(super) fn take_exit(&mut self) -> Option<u64> {
+        self.harts.iter_mut().find_map(Simulator::take_exit)
+    }
+
+    /// Lockstep cycle after hart 0 has ticked: every secondary, then the uncore.
+    pub(super) fn tick(&mut self, primary: &mut Cpu) -> Result<(), SimError> {
+        for sim in &mut self.harts {
+            sim.tick_hart()?;
+        }
+        advance_uncore(&self.uncore, primary, 1)
+    }
+
+    /// Runs every hart on its own thread for up to `cycles` cycles.
+    pub(super) fn run(
+        &mut self,
+        primary: &mut Simulator,
+        cycles: u64,
+    ) -> Result<Option<u64>, SimError> {
+        if cycles == 0 {
+            return Ok(None);
+        }
+        let barrier = Barrier::new(self.harts.len() + 1);
+        let stop = AtomicBool::new(false);
+        let state = Mutex::new(RunState::default());
+        let Self { harts, uncore, quantum } = self;
+        let (quantum, barrier, stop, state) = (*quantum, &barrier, &stop, &state);
+
+        std::thread::scope(|scope| {
+            for sim in harts {
+                let _ = scope.spawn(move || {
+                    let mut done = 0;
+                    loop {
+                        let q = quantum.min(cycles - done);
+                        run_quantum(sim, q, state);
+                        let _ = barrier.wait();
+                        // Hart 0 synchronizes the uncore here.
+                        let _ = barrier.wait();
+                        if stop.load(Ordering::Acquire) {
+                            break;
+                        }
+                        done += q;
+                    }
+                });
+            }
+
+            let mut done = 0;
+            loop {
+                let q = quantum.min(cycles - done);
+                run_quantum(primary, q, state);
+                let _ = barrier.wait();
+                let synced = advance_uncore(uncore, &mut primary.cpu, q);
+                done += q;
+                let mut st = lock(state);
+                if let Err(e) = synced
+                    && st.error.is_none()
+                {
+                    st.error = Some(e);
+                }
+                let finished = done >= cycles || st.exit.is_some() || st.error.is_some();
+                drop(st);
+                stop.store(finished, Ordering::Release);
+                let _ = barrier.wait();
+                if finished {
+                    break;
+                }
+            }
+        });
+
+        let st = std::mem::take(&mut *lock(state));
+        st.error.map_or(Ok(st.exit), Err)
+    }
+}
+
+/// Advances device time by `cycles` and fails once a kernel panic has had
+/// [`PANIC_GRACE_CYCLES`] to print (harts only see ports, so `pre_tick`
+/// cannot observe the UART).
+fn advance_uncore(uncore: &SharedUncore, primary: &mut Cpu, cycles: u64) -> Result<(), SimError> {
+    let panicked = {
+        let mut uncore = lock(uncore);
+        uncore.advance(cycles);
+        uncore.bus.check_kernel_panic()
+    };
+    if panicked {
+        let detected_at = *primary.panic_detected_at_cycle.get_or_insert(primary.stats.cycles);
+        if primary.stats.cycles.saturating_sub(detected_at) >= PANIC_GRACE_CYCLES {
+            return Err(SimError::KernelPanic { cycle: detected_at });
+        }
+    }
+    Ok(())
+}
+
+/// Runs `sim` for `cycles` cycles, stopping early on exit or error.
+fn run_quantum(sim: &mut Simulator, cycles: u64, state: &Mutex<RunState>) {
+    for _ in 0..cycles {
+        if let Err(e) = sim.tick_hart() {
+            let _ = lock(state).error.get_or_insert(e);
+            return;
+        }
+        if let Some(code) = sim.cpu.take_exit() {
+            let _ = lock(state).exit.get_or_insert(code);
+            return;
+        }
+    }
+}
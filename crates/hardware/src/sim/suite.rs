@@ -0,0 +1,148 @@
+//! In-process batched execution of bare-metal test suites.
+//!
+//! [`run_suite`] runs every test image under every configuration on a pool
+//! of host threads and returns all outcomes at once. A suite such as
+//! riscv-tests or the torture tests is thousands of runs of a few thousand
+//! cycles each, so per-run set-up dominates: each worker therefore keeps one
+//! [`Simulator`] and resets it between tests ([`Simulator::reset`]), which
+//! clears the cache arrays in place instead of reallocating them.
+//!
+//! Each test boots as the Python `Cpu` boots a bare-metal ELF: its segments
+//! are loaded, the PC starts at the entry point, and HTIF is wired to the
+//! `tohost` symbol. When the image defines `begin_signature` and
+//! `end_signature`, the memory between them is read back after the run.
+
+use crate::common::{PhysAddr, SimError};
+use crate::config::Config;
+use crate::core::arch::mode::PrivilegeMode;
+use crate::sim::loader;
+use crate::sim::simulator::{BatchExit, RunLimits, Simulator};
+use crate::soc::System;
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+use std::thread;
+
+/// Result of running one test image under one configuration.
+#[derive(Debug)]
+pub struct TestOutcome {
+    /// Index of the configuration in the `configs` passed to [`run_suite`].
+    pub config: usize,
+    /// Index of the test image in the `tests` passed to [`run_suite`].
+    pub test: usize,
+    /// How the run ended: the HTIF exit code, a limit, or a simulator error.
+    pub result: Result<BatchExit, SimError>,
+    /// Cycles simulated.
+    pub cycles: u64,
+    /// Instructions retired.
+    pub instructions: u64,
+    /// Contents of `begin_signature..end_signature`, if the image defines both.
+    pub signature: Option<Vec<u8>>,
+}
+
+/// Runs every test image under every configuration across `threads` host threads.
+///
+/// `threads == 0` uses one thread per available CPU. Each run stops at the
+/// guest's HTIF exit or at `limits`. Outcomes are returned ordered by
+/// configuration, then test.
+pub fn run_suite<T: AsRef<[u8]> + Sync>(
+    configs: &[Config],
+    tests: &[T],
+    limits: RunLimits,
+    threads: usize,
+) -> Vec<TestOutcome> {
+    let jobs = configs.len() * tests.len();
+    if jobs == 0 {
+        return Vec::new();
+    }
+    let threads =
+        if threads == 0 { thread::available_parallelism().map_or(1, usize::from) } else { threads };
+    // Jobs are handed out configuration-major, so a worker mostly resets its
+    // simulator into the configuration it just ran and keeps its caches.
+    let next = AtomicUsize::new(0);
+    let mut outcomes: Vec<TestOutcome> = thread::scope(|scope| {
+        let workers: Vec<_> = (0..threads.min(jobs))
+            .map(|_| {
+                scope.spawn(|| {
+                    let stop = AtomicBool::new(false);
+                    let mut sim = None;
+                    let mut done = Vec::new();
+                    loop {
+                        let job = next.fetch_add(1, Ordering::Relaxed);
+                        if job >= jobs {
+                            break done;
+                        }
+                        let (config, test) = (job / tests.len(), job % tests.len());
+                        let elf = tests[test].as_ref();
+                        done.push(run_test(
+                            &mut sim,
+                            config,
+                            &configs[config],
+                            test,
+                            elf,
+                            limits,
+                            &stop,
+                        ));
+                    }
+                })
+            })
+            .collect();
+        workers
+            .into_iter()
+            .flat_map(|worker| {
+                worker.join().unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+            })
+            .collect()
+    });
+    outcomes.sort_unstable_by_key(|o| (o.config, o.test));
+    outcomes
+}
+
+/// Boots `elf` in `slot`'s simulator (creating it on first use) and runs it.
+fn run_test(
+    slot: &mut Option<Simulator>,
+    config_index: usize,
+    config: &Config,
+    test: usize,
+    elf: &[u8],
+    limits: RunLimits,
+    stop: &AtomicBool,
+) -> TestOutcome {
+    let mut outcome = TestOutcome {
+        config: config_index,
+        test,
+        result: Err(SimError::InvalidElf),
+        cycles: 0,
+        instructions: 0,
+        signature: None,
+    };
+    let mut system = System::new(config, "");
+    let Some(loaded) = loader::try_load_elf(elf, &mut system.bus) else {
+        return outcome;
+    };
+    if let Some(tohost) = loaded.tohost_addr {
+        system.add_htif(tohost);
+    }
+    let sim = match slot {
+        Some(sim) => {
+            sim.reset(system, config);
+            sim
+        }
+        None => slot.insert(Simulator::new(system, config)),
+    };
+    sim.cpu.pc = loaded.entry;
+    if let Some(tohost) = loaded.tohost_addr {
+        sim.cpu.direct_mode = false;
+        sim.cpu.privilege = PrivilegeMode::Machine;
+        sim.cpu.htif_range = Some((tohost, tohost + 16));
+    }
+    sim.sync_arch_regs();
+
+    outcome.result = sim.run_batch(limits, stop);
+    (outcome.cycles, outcome.instructions) = {
+        let stats = sim.stats();
+        (stats.cycles, stats.instructions_retired)
+    };
+    outcome.signature = loaded.signature.map(|(begin, end)| {
+        (begin..end).map(|addr| sim.cpu.bus.bus.read_u8(PhysAddr::new(addr))).collect()
+    });
+    outcome
+}
@@ -5,18 +5,22 @@
 //! 2. **Device registration:** Instantiates RAM, UART, VirtIO disk, CLINT, PLIC, SysCon, and RTC.
 //! 3. **Memory controller:** Selects simple or DRAM controller based on config.
 //! 4. **Binary loading:** Optionally loads a disk image from path and kernel via `load_binary_at`.
+//! 5. **SMP:** With `system.harts > 1` the devices are moved into a shared `Uncore`; every hart
+//!    gets its own `System` whose bus maps the shared RAM directly and reaches the devices
+//!    through MMIO ports.
 
-use crate::config::{Config, MemoryController as MemControllerType};
-use crate::soc::devices::{Clint, GoldfishRtc, Htif, Plic, SysCon, Uart, VirtioBlock};
+use crate::config::{Config, MAX_HARTS, MemoryController as MemControllerType};
+use crate::soc::devices::{Clint, DiskImage, GoldfishRtc, Htif, Plic, SysCon, Uart, VirtioBlock};
 use crate::soc::interconnect::Bus;
 use crate::soc::memory::Memory;
 use crate::soc::memory::buffer::DramBuffer;
 use crate::soc::memory::controller::{
     DramConfig, DramController, MemoryController, SimpleController,
 };
-use std::fs;
-use std::sync::Arc;
+use crate::soc::memory::frfcfs::{FrFcfsConfig, FrFcfsController};
+use crate::soc::uncore::{MmioPort, SharedUncore, Uncore, lock};
 use std::sync::atomic::AtomicU64;
+use std::sync::{Arc, Mutex};
 
 /// Top-level system instance containing the bus, memory controller, and exit flag.
 ///
@@ -29,6 +33,10 @@ pub struct System {
     pub mem_controller: Box<dyn MemoryController + Send + Sync>,
     /// Atomic exit code: when not `u64::MAX`, simulation should stop and use this as exit code.
     pub exit_request: Arc<AtomicU64>,
+    /// Devices shared with the other harts (`None` in a single-hart system).
+    pub uncore: Option<SharedUncore>,
+    /// Index of the hart this system view belongs to.
+    pub hart: usize,
 }
 
 impl std::fmt::Debug for System {
@@ -36,6 +44,7 @@ impl std::fmt::Debug for System {
         f.debug_struct("System")
             .field("bus", &self.bus)
             .field("exit_request", &self.exit_request)
+            .field("hart", &self.hart)
             .finish_non_exhaustive()
     }
 }
@@ -45,6 +54,8 @@ impl System {
     ///
     /// Creates the bus, RAM, UART, `VirtIO` disk (loading `disk_path` if non-empty), CLINT, PLIC,
     /// `SysCon`, and Goldfish RTC. The memory controller is chosen from `config.memory.controller`.
+    /// With `config.system.harts > 1` the devices go to a shared uncore and the returned system
+    /// is hart 0's view of it; build the other harts with [`Self::secondary`].
     ///
     /// # Arguments
     ///
@@ -55,68 +66,59 @@ impl System {
     ///
     /// A fully constructed `System` ready for simulation.
     pub fn new(config: &Config, disk_path: &str) -> Self {
-        let mut bus = Bus::new(config.system.bus_width, config.system.bus_latency);
         let exit_request = Arc::new(AtomicU64::new(u64::MAX));
+        let harts = config.system.harts.clamp(1, MAX_HARTS);
+        let (bus, ram_buffer) = build_devices(config, disk_path, harts, &exit_request);
 
-        let ram_base = config.system.ram_base;
-        let ram_size = config.memory.ram_size;
-        let ram_buffer = Arc::new(DramBuffer::new(ram_size));
-        let mem = Memory::new(ram_buffer.clone(), ram_base);
-
-        let uart_base = config.system.uart_base;
-        let uart = Uart::new(uart_base, config.system.uart_to_stderr, config.system.uart_quiet);
-
-        let clint_addr = config.system.clint_base;
-        let clint = Clint::new(clint_addr, config.system.clint_divider);
-
-        let plic_addr = 0x0c00_0000;
-        let plic = Plic::new(plic_addr);
-
-        let disk_base = config.system.disk_base;
-        let mut disk = VirtioBlock::new(disk_base, ram_base, ram_buffer);
-        if !disk_path.is_empty()
-            && let Ok(disk_data) = fs::read(disk_path)
-            && !disk_data.is_empty()
-        {
-            disk.load(disk_data);
+        if harts == 1 {
+            return Self {
+                bus,
+                mem_controller: memory_controller(config),
+                exit_request,
+                uncore: None,
+                hart: 0,
+            };
         }
+        let uncore = Arc::new(Mutex::new(Uncore::new(bus, ram_buffer, harts)));
+        Self::hart_view(config, uncore, exit_request, 0)
+    }
 
-        let syscon_addr = config.system.syscon_base;
-        let syscon = SysCon::new(syscon_addr, exit_request.clone());
-
-        let rtc = GoldfishRtc::new(0x101000);
-
-        bus.add_device(Box::new(mem));
-        bus.add_device(Box::new(uart));
-        bus.add_device(Box::new(disk));
-        bus.add_device(Box::new(clint));
-        bus.add_device(Box::new(plic));
-        bus.add_device(Box::new(syscon));
-        bus.add_device(Box::new(rtc));
-
-        if config.system.tohost_addr != 0 {
-            let htif = Htif::new(config.system.tohost_addr, exit_request.clone());
-            bus.add_device(Box::new(htif));
-        }
+    /// Builds hart `hart`'s view of this system's uncore.
+    ///
+    /// Returns `None` for a single-hart system or an out-of-range hart.
+    pub fn secondary(&self, config: &Config, hart: usize) -> Option<Self> {
+        let uncore = self.uncore.as_ref()?;
+        let harts = lock(uncore).harts();
+        (hart < harts).then(|| {
+            Self::hart_view(config, Arc::clone(uncore), Arc::clone(&self.exit_request), hart)
+        })
+    }
 
-        let mem_controller: Box<dyn MemoryController + Send + Sync> = match config.memory.controller
+    /// Private bus of one SMP hart: shared RAM plus a port for each uncore device.
+    fn hart_view(
+        config: &Config,
+        uncore: SharedUncore,
+        exit_request: Arc<AtomicU64>,
+        hart: usize,
+    ) -> Self {
+        let mut bus = Bus::new(config.system.bus_width, config.system.bus_latency);
         {
-            MemControllerType::Dram => Box::new(DramController::new(DramConfig {
-                t_cas: config.memory.t_cas,
-                t_ras: config.memory.t_ras,
-                t_pre: config.memory.t_pre,
-                t_rrd: config.memory.t_rrd,
-                num_banks: config.memory.num_banks,
-                row_size_bytes: config.memory.row_size_bytes,
-                t_refi: config.memory.t_refi,
-                t_rfc: config.memory.t_rfc,
-            })),
-            MemControllerType::Simple => {
-                Box::new(SimpleController::new(config.memory.row_miss_latency))
+            let hub = lock(&uncore);
+            bus.add_device(Box::new(Memory::new(hub.ram(), config.system.ram_base)));
+            for dev in hub.bus.devices().filter(|d| d.name() != "DRAM") {
+                bus.add_device(Box::new(MmioPort::new(Arc::clone(&uncore), dev)));
             }
-        };
-
-        Self { bus, mem_controller, exit_request }
+            if let Some(line) = hub.line(hart) {
+                bus.attach_irq_line(line);
+            }
+        }
+        Self {
+            bus,
+            mem_controller: memory_controller(config),
+            exit_request,
+            uncore: Some(uncore),
+            hart,
+        }
     }
 
     /// Loads a binary into memory at the given physical address.
@@ -138,6 +140,16 @@ impl System {
         self.bus.tick()
     }
 
+    /// Number of following [`Self::tick`] calls that only advance time.
+    pub const fn quiet_cycles(&self) -> u64 {
+        self.bus.quiet_cycles()
+    }
+
+    /// Advances the devices by `cycles` quiet cycles (at most [`Self::quiet_cycles`]).
+    pub fn advance_quiet(&mut self, cycles: u64) {
+        let _ = self.bus.tick_by(cycles);
+    }
+
     /// Returns the requested exit code if a device has requested shutdown.
     ///
     /// # Returns
@@ -161,8 +173,107 @@ impl System {
     ///
     /// Called after ELF loading discovers a `tohost` symbol. The device shares
     /// the same `exit_request` atomic so the simulation loop picks up the exit.
+    ///
+    /// In an SMP system the device joins the uncore and this hart reaches it through a port;
+    /// harts built afterwards with [`Self::secondary`] see it too.
     pub fn add_htif(&mut self, tohost_addr: u64) {
         let htif = Htif::new(tohost_addr, self.exit_request.clone());
-        self.bus.add_device(Box::new(htif));
+        if let Some(uncore) = &self.uncore {
+            let port = MmioPort::new(Arc::clone(uncore), &htif);
+            lock(uncore).bus.add_device(Box::new(htif));
+            self.bus.add_device(Box::new(port));
+        } else {
+            self.bus.add_device(Box::new(htif));
+        }
+    }
+}
+
+/// Creates the device bus (RAM and every MMIO device) and returns it with the RAM buffer.
+fn build_devices(
+    config: &Config,
+    disk_path: &str,
+    harts: usize,
+    exit_request: &Arc<AtomicU64>,
+) -> (Bus, Arc<DramBuffer>) {
+    let mut bus = Bus::new(config.system.bus_width, config.system.bus_latency);
+
+    let ram_base = config.system.ram_base;
+    let ram_size = config.memory.ram_size;
+    let ram_buffer = Arc::new(DramBuffer::with_backing(
+        ram_size,
+        config.memory.huge_pages,
+        config.memory.numa_local,
+    ));
+    let mem = Memory::new(ram_buffer.clone(), ram_base);
+
+    let uart_base = config.system.uart_base;
+    let uart = Uart::new(uart_base, config.system.uart_to_stderr, config.system.uart_quiet);
+
+    let clint_addr = config.system.clint_base;
+    let clint = Clint::with_harts(clint_addr, config.system.clint_divider, harts);
+
+    let plic_addr = 0x0c00_0000;
+    let plic = Plic::with_harts(plic_addr, harts);
+
+    let disk_base = config.system.disk_base;
+    let mut disk = VirtioBlock::new(disk_base, ram_base, ram_buffer.clone()).with_timing(
+        config.system.disk_latency,
+        config.system.disk_bytes_per_cycle,
+        config.system.disk_queue_depth,
+    );
+    if !disk_path.is_empty()
+        && let Ok(image) = DiskImage::open(disk_path, config.system.disk_write_through)
+        && !image.is_empty()
+    {
+        disk.attach(image);
+    }
+
+    let syscon_addr = config.system.syscon_base;
+    let syscon = SysCon::new(syscon_addr, exit_request.clone());
+
+    let rtc = GoldfishRtc::new(0x101000);
+
+    bus.add_device(Box::new(mem));
+    bus.add_device(Box::new(uart));
+    bus.add_device(Box::new(disk));
+    bus.add_device(Box::new(clint));
+    bus.add_device(Box::new(plic));
+    bus.add_device(Box::new(syscon));
+    bus.add_device(Box::new(rtc));
+
+    if config.system.tohost_addr != 0 {
+        let htif = Htif::new(config.system.tohost_addr, exit_request.clone());
+        bus.add_device(Box::new(htif));
+    }
+    (bus, ram_buffer)
+}
+
+/// Creates the main memory controller selected by `config.memory.controller`.
+fn memory_controller(config: &Config) -> Box<dyn MemoryController + Send + Sync> {
+    let m = &config.memory;
+    let dram = DramConfig {
+        t_cas: m.t_cas,
+        t_ras: m.t_ras,
+        t_pre: m.t_pre,
+        t_rrd: m.t_rrd,
+        num_banks: m.num_banks,
+        row_size_bytes: m.row_size_bytes,
+        t_refi: m.t_refi,
+        t_rfc: m.t_rfc,
+    };
+    match m.controller {
+        MemControllerType::Dram => Box::new(DramController::new(dram)),
+        MemControllerType::FrFcfs => Box::new(FrFcfsController::new(FrFcfsConfig {
+            dram,
+            channels: m.channels,
+            ranks: m.ranks,
+            read_queue_size: m.read_queue_size,
+            write_queue_size: m.write_queue_size,
+            write_high_watermark: m.write_high_watermark,
+            write_low_watermark: m.write_low_watermark,
+            t_burst: m.t_burst,
+            t_wtr: m.t_wtr,
+        })),
+        MemControllerType::Simple => Box::new(SimpleController::new(m.row_miss_latency)),
     }
 }
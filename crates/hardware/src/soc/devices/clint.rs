@@ -6,9 +6,9 @@
 //!
 //! # Memory Map
 //!
-//! * `0x0000`: MSIP (Machine Software Interrupt Pending)
-//! * `0x4000`: MTIMECMP (Machine Time Compare)
-//! * `0xBFF8`: MTIME (Machine Time)
+//! * `0x0000 + 4 * hart`: MSIP (Machine Software Interrupt Pending)
+//! * `0x4000 + 8 * hart`: MTIMECMP (Machine Time Compare)
+//! * `0xBFF8`: MTIME (Machine Time, shared by all harts)
 
 use crate::soc::devices::Device;
 
@@ -26,10 +26,10 @@ pub struct Clint {
     base_addr: u64,
     /// Current machine time counter.
     mtime: u64,
-    /// Machine time compare register.
-    mtimecmp: u64,
-    /// Machine software interrupt pending register.
-    msip: u32,
+    /// Machine time compare register, one per hart.
+    mtimecmp: Vec<u64>,
+    /// Machine software interrupt pending register, one per hart.
+    msip: Vec<u32>,
     /// Divider to scale CPU cycles to timer ticks.
     divider: u64,
     /// Internal counter for the divider.
@@ -37,28 +37,72 @@ pub struct Clint {
 }
 
 impl Clint {
-    /// Creates a new CLINT device.
+    /// Creates a new single-hart CLINT device.
     ///
     /// # Arguments
     ///
     /// * `base_addr` - The base physical address.
     /// * `divider` - The ratio of CPU cycles to timer ticks (e.g., 10 means timer increments every 10 cycles).
-    pub const fn new(base_addr: u64, divider: u64) -> Self {
+    pub fn new(base_addr: u64, divider: u64) -> Self {
+        Self::with_harts(base_addr, divider, 1)
+    }
+
+    /// Creates a CLINT with one MSIP and MTIMECMP register per hart.
+    ///
+    /// `harts` is clamped to at least 1.
+    pub fn with_harts(base_addr: u64, divider: u64, harts: usize) -> Self {
+        let harts = harts.max(1);
         Self {
             base_addr,
             mtime: 0,
-            mtimecmp: u64::MAX,
-            msip: 0,
+            mtimecmp: vec![u64::MAX; harts],
+            msip: vec![0; harts],
             divider: if divider == 0 { 1 } else { divider },
             counter: 0,
         }
     }
-}
 
-impl Clint {
-    /// Returns `true` if the machine software interrupt pending bit is set.
-    pub const fn msip_pending(&self) -> bool {
-        (self.msip & 1) != 0
+    /// Returns `true` if hart 0's machine software interrupt pending bit is set.
+    pub fn msip_pending(&self) -> bool {
+        self.hart_msip_pending(0)
+    }
+
+    /// Returns `true` if `hart`'s machine software interrupt pending bit is set.
+    pub fn hart_msip_pending(&self, hart: usize) -> bool {
+        self.msip.get(hart).is_some_and(|&m| m & 1 != 0)
+    }
+
+    /// Returns `true` if `hart`'s machine timer interrupt is pending (`mtime >= mtimecmp`).
+    pub fn hart_timer_pending(&self, hart: usize) -> bool {
+        self.mtimecmp.get(hart).is_some_and(|&cmp| self.mtime >= cmp)
+    }
+
+    /// Returns hart 0's timer state (`mtime`, divider phase, `mtimecmp`, `msip`)
+    /// for a single-hart checkpoint.
+    pub fn hart0_state(&self) -> [u64; 4] {
+        [self.mtime, self.counter, self.mtimecmp[0], u64::from(self.msip[0])]
+    }
+
+    /// Restores state saved by [`Self::hart0_state`].
+    pub fn restore_hart0_state(&mut self, [mtime, counter, mtimecmp, msip]: [u64; 4]) {
+        self.mtime = mtime;
+        self.counter = counter % self.divider;
+        self.mtimecmp[0] = mtimecmp;
+        self.msip[0] = msip as u32 & 1;
+    }
+
+    /// Returns the hart whose MSIP register lives at `offset`.
+    fn msip_hart(&self, offset: u64) -> Option<usize> {
+        let rel = offset.checked_sub(MSIP_OFFSET)?;
+        let hart = (rel / 4) as usize;
+        (rel % 4 == 0 && hart < self.msip.len()).then_some(hart)
+    }
+
+    /// Returns the hart and 32-bit half (0 = low, 1 = high) of the MTIMECMP word at `offset`.
+    fn mtimecmp_slot(&self, offset: u64) -> Option<(usize, u32)> {
+        let rel = offset.checked_sub(MTIMECMP_OFFSET)?;
+        let hart = (rel / 8) as usize;
+        (rel % 4 == 0 && hart < self.mtimecmp.len()).then_some((hart, ((rel % 8) / 4) as u32))
     }
 }
 
@@ -92,21 +136,30 @@ impl Device for Clint {
     /// Handles reads to MSIP, and the lower/upper halves of MTIME and MTIMECMP.
     fn read_u32(&mut self, offset: u64) -> u32 {
         match offset {
-            MSIP_OFFSET => self.msip,
-            MTIMECMP_OFFSET => self.mtimecmp as u32,
-            val if val == MTIMECMP_OFFSET + 4 => (self.mtimecmp >> 32) as u32,
             MTIME_OFFSET => self.mtime as u32,
             val if val == MTIME_OFFSET + 4 => (self.mtime >> 32) as u32,
-            _ => 0,
+            _ => {
+                if let Some(hart) = self.msip_hart(offset) {
+                    self.msip[hart]
+                } else if let Some((hart, half)) = self.mtimecmp_slot(offset) {
+                    (self.mtimecmp[hart] >> (32 * half)) as u32
+                } else {
+                    0
+                }
+            }
         }
     }
 
     /// Reads a double-word (64-bit) from the device.
     fn read_u64(&mut self, offset: u64) -> u64 {
-        match offset {
-            MSIP_OFFSET => self.msip as u64,
-            MTIMECMP_OFFSET => self.mtimecmp,
-            MTIME_OFFSET => self.mtime,
+        if offset == MTIME_OFFSET {
+            return self.mtime;
+        }
+        if let Some(hart) = self.msip_hart(offset) {
+            return self.msip[hart] as u64;
+        }
+        match self.mtimecmp_slot(offset) {
+            Some((hart, 0)) => self.mtimecmp[hart],
             _ => 0,
         }
     }
@@ -121,35 +174,37 @@ impl Device for Clint {
     /// Handles writes to MSIP, and the lower/upper halves of MTIME and MTIMECMP.
     fn write_u32(&mut self, offset: u64, val: u32) {
         match offset {
-            MSIP_OFFSET => self.msip = val & 1,
-            MTIMECMP_OFFSET => {
-                self.mtimecmp = (self.mtimecmp & 0xFFFF_FFFF_0000_0000) | (val as u64);
-            }
-            o if o == MTIMECMP_OFFSET + 4 => {
-                self.mtimecmp = (self.mtimecmp & 0x0000_0000_FFFF_FFFF) | ((val as u64) << 32);
-            }
             MTIME_OFFSET => self.mtime = (self.mtime & 0xFFFF_FFFF_0000_0000) | (val as u64),
             o if o == MTIME_OFFSET + 4 => {
                 self.mtime = (self.mtime & 0x0000_0000_FFFF_FFFF) | ((val as u64) << 32);
             }
-            _ => {}
+            _ => {
+                if let Some(hart) = self.msip_hart(offset) {
+                    self.msip[hart] = val & 1;
+                } else if let Some((hart, half)) = self.mtimecmp_slot(offset) {
+                    let shift = 32 * half;
+                    let cmp = &mut self.mtimecmp[hart];
+                    *cmp = (*cmp & !(0xFFFF_FFFF << shift)) | ((val as u64) << shift);
+                }
+            }
         }
     }
 
     /// Writes a double-word (64-bit) to the device.
     fn write_u64(&mut self, offset: u64, val: u64) {
-        match offset {
-            MSIP_OFFSET => self.msip = (val as u32) & 1,
-            MTIMECMP_OFFSET => self.mtimecmp = val,
-            MTIME_OFFSET => self.mtime = val,
-            _ => {}
+        if offset == MTIME_OFFSET {
+            self.mtime = val;
+        } else if let Some(hart) = self.msip_hart(offset) {
+            self.msip[hart] = (val as u32) & 1;
+        } else if let Some((hart, 0)) = self.mtimecmp_slot(offset) {
+            self.mtimecmp[hart] = val;
         }
     }
 
     /// Advances the device state by one cycle.
     ///
     /// Increments the `mtime` counter based on the configured divider.
-    /// Returns `true` if the machine timer interrupt is pending (`mtime >= mtimecmp`).
+    /// Returns `true` if hart 0's machine timer interrupt is pending (`mtime >= mtimecmp`).
     fn tick(&mut self) -> bool {
         self.counter += 1;
         if self.counter >= self.divider {
@@ -157,7 +212,26 @@ impl Device for Clint {
             self.counter = 0;
         }
 
-        self.mtime >= self.mtimecmp
+        self.hart_timer_pending(0)
+    }
+
+    /// Advances `mtime` by `cycles` CPU cycles in one step; the returned level is hart 0's timer.
+    fn advance(&mut self, cycles: u64) -> bool {
+        let total = self.counter + cycles;
+        self.mtime = self.mtime.wrapping_add(total / self.divider);
+        self.counter = total % self.divider;
+        self.hart_timer_pending(0)
+    }
+
+    /// Cycles until `mtime` reaches the nearest not-yet-pending `mtimecmp`; `None` once every
+    /// hart's timer is pending, since a timer stays pending until software rewrites `mtimecmp`
+    /// or `mtime`.
+    fn next_event(&self) -> Option<u64> {
+        self.mtimecmp
+            .iter()
+            .filter(|&&cmp| self.mtime < cmp)
+            .map(|&cmp| (cmp - self.mtime).saturating_mul(self.divider) - self.counter)
+            .min()
     }
 
     fn as_clint_mut(&mut self) -> Option<&mut Clint> {
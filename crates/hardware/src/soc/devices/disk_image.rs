@@ -0,0 +1,183 @@
+//! Block Device Backing Store.
+//!
+//! Provides [`DiskImage`], the byte store behind the `VirtIO` block device. On
+//! Unix a disk image file is `mmap`ed instead of read into memory, so opening a
+//! multi-gigabyte image is O(1) and only the sectors the guest touches are ever
+//! paged in. Guest writes either stay private to the simulation (copy-on-write,
+//! the default) or go straight through to the file.
+
+use std::fs::{File, OpenOptions};
+use std::io;
+use std::slice;
+
+/// Bytes of a disk image, either owned or mapped from a file.
+pub struct DiskImage {
+    ptr: *mut u8,
+    len: usize,
+    /// Keeps the storage alive when the image is not mapped (empty otherwise).
+    _owned: Vec<u8>,
+    is_mmap: bool,
+}
+
+unsafe impl Send for DiskImage {}
+unsafe impl Sync for DiskImage {}
+
+impl std::fmt::Debug for DiskImage {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("DiskImage")
+            .field("len", &self.len)
+            .field("is_mmap", &self.is_mmap)
+            .finish_non_exhaustive()
+    }
+}
+
+impl Default for DiskImage {
+    /// Creates an empty (zero-sector) image.
+    fn default() -> Self {
+        Self::from_vec(Vec::new())
+    }
+}
+
+impl DiskImage {
+    /// Wraps an in-memory image.
+    pub const fn from_vec(mut data: Vec<u8>) -> Self {
+        Self { ptr: data.as_mut_ptr(), len: data.len(), _owned: data, is_mmap: false }
+    }
+
+    /// Opens the image file at `path`.
+    ///
+    /// On Unix the file is mapped: with `write_through` guest writes are
+    /// shared with the file (`MAP_SHARED`), otherwise they are private to this
+    /// image (`MAP_PRIVATE`) and the file is only read. Elsewhere, and for
+    /// empty files, the image is read into memory and writes are never
+    /// persisted.
+    ///
+    /// # Errors
+    ///
+    /// Returns the I/O error if the file cannot be opened or mapped.
+    pub fn open(path: &str, write_through: bool) -> io::Result<Self> {
+        let file = OpenOptions::new().read(true).write(write_through).open(path)?;
+        Self::map(&file, write_through)
+    }
+
+    #[cfg(unix)]
+    fn map(file: &File, write_through: bool) -> io::Result<Self> {
+        use std::os::unix::io::AsRawFd;
+
+        let len = usize::try_from(file.metadata()?.len())
+            .map_err(|_| io::Error::new(io::ErrorKind::InvalidInput, "disk image too large"))?;
+        if len == 0 {
+            return Ok(Self::default());
+        }
+        let flags = if write_through { libc::MAP_SHARED } else { libc::MAP_PRIVATE };
+        let ptr = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ | libc::PROT_WRITE,
+                flags,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(Self { ptr: ptr.cast(), len, _owned: Vec::new(), is_mmap: true })
+    }
+
+    #[cfg(not(unix))]
+    fn map(file: &File, _write_through: bool) -> io::Result<Self> {
+        use std::io::Read;
+
+        let mut data = Vec::new();
+        let _ = (&*file).read_to_end(&mut data)?;
+        Ok(Self::from_vec(data))
+    }
+
+    /// Size of the image in bytes.
+    pub const fn len(&self) -> usize {
+        self.len
+    }
+
+    /// Returns true if the image has zero size.
+    pub const fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns true if the image is mapped from a file.
+    pub const fn is_mapped(&self) -> bool {
+        self.is_mmap
+    }
+
+    /// The image bytes.
+    pub const fn as_slice(&self) -> &[u8] {
+        unsafe { slice::from_raw_parts(self.ptr, self.len) }
+    }
+
+    /// The image bytes, mutably.
+    pub const fn as_mut_slice(&mut self) -> &mut [u8] {
+        unsafe { slice::from_raw_parts_mut(self.ptr, self.len) }
+    }
+}
+
+impl Drop for DiskImage {
+    /// Unmaps a mapped image; a write-through mapping's dirty pages are
+    /// written back to the file by the kernel.
+    fn drop(&mut self) {
+        #[cfg(unix)]
+        if self.is_mmap {
+            unsafe {
+                let _ = libc::munmap(self.ptr.cast(), self.len);
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+#[allow(clippy::unwrap_used)]
+mod tests {
+    use super::*;
+
+    fn image_file(tag: &str, data: &[u8]) -> String {
+        let path = std::env::temp_dir()
+            .join(format!("rvsim-disk-image-{tag}-{}.img", std::process::id()))
+            .to_string_lossy()
+            .into_owned();
+        std::fs::write(&path, data).unwrap();
+        path
+    }
+
+    #[test]
+    fn copy_on_write_leaves_the_file_untouched() {
+        let path = image_file("cow", &[7; 1024]);
+        let mut image = DiskImage::open(&path, false).unwrap();
+        assert_eq!(image.len(), 1024);
+        assert_eq!(image.is_mapped(), cfg!(unix));
+        image.as_mut_slice()[..4].copy_from_slice(&[1, 2, 3, 4]);
+        assert_eq!(image.as_slice()[..5], [1, 2, 3, 4, 7]);
+        drop(image);
+        assert_eq!(std::fs::read(&path).unwrap(), vec![7; 1024]);
+        std::fs::remove_file(&path).unwrap();
+    }
+
+    #[cfg(unix)]
+    #[test]
+    fn write_through_reaches_the_file() {
+        let path = image_file("wt", &[0; 512]);
+        let mut image = DiskImage::open(&path, true).unwrap();
+        image.as_mut_slice()[510..].copy_from_slice(&[0x55, 0xaa]);
+        drop(image);
+        assert_eq!(std::fs::read(&path).unwrap()[510..], [0x55, 0xaa]);
+        std::fs::remove_file(&path).unwrap();
+    }
+
+    #[test]
+    fn an_empty_file_is_an_empty_image() {
+        let path = image_file("empty", &[]);
+        let image = DiskImage::open(&path, false).unwrap();
+        assert!(image.is_empty());
+        assert!(image.as_slice().is_empty());
+        std::fs::remove_file(&path).unwrap();
+    }
+}
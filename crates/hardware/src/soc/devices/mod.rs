@@ -7,6 +7,9 @@
 /// Core Local Interruptor (timer and software interrupt controller).
 pub mod clint;
 
+/// Backing store for block devices (file-mapped disk images).
+pub mod disk_image;
+
 /// Goldfish RTC (Real-Time Clock) device.
 pub mod goldfish_rtc;
 
@@ -26,6 +29,7 @@ pub mod uart;
 pub mod virtio_disk;
 
 pub use clint::Clint;
+pub use disk_image::DiskImage;
 pub use goldfish_rtc::GoldfishRtc;
 pub use htif::Htif;
 pub use plic::Plic;
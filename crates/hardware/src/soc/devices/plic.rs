@@ -24,8 +24,8 @@ const PLIC_ENABLE_BASE: u64 = 0x002000;
 /// Base offset for PLIC context-specific registers (threshold, claim/complete).
 const PLIC_CONTEXT_BASE: u64 = 0x200000;
 
-/// Number of interrupt contexts (M-mode + S-mode per HART).
-const NUM_CONTEXTS: usize = 2;
+/// Number of interrupt contexts per HART (M-mode + S-mode).
+const CONTEXTS_PER_HART: usize = 2;
 
 /// Number of 32-bit enable words per context (covers 1024 interrupt sources).
 const ENABLE_WORDS_PER_CONTEXT: usize = 32;
@@ -48,18 +48,31 @@ pub struct Plic {
 }
 
 impl Plic {
-    /// Creates a new PLIC device.
+    /// Creates a new single-hart PLIC device.
     pub fn new(base_addr: u64) -> Self {
+        Self::with_harts(base_addr, 1)
+    }
+
+    /// Creates a PLIC with an M-mode and an S-mode context per hart.
+    ///
+    /// Hart `h` owns contexts `2h` (M) and `2h + 1` (S). `harts` is clamped to at least 1.
+    pub fn with_harts(base_addr: u64, harts: usize) -> Self {
+        let contexts = harts.max(1) * CONTEXTS_PER_HART;
         Self {
             base_addr,
             priorities: vec![0; 1024],
             pending: vec![0; 32],
-            enables: vec![vec![0u32; ENABLE_WORDS_PER_CONTEXT]; NUM_CONTEXTS],
-            thresholds: vec![0; NUM_CONTEXTS],
-            claims: vec![0; NUM_CONTEXTS],
+            enables: vec![vec![0u32; ENABLE_WORDS_PER_CONTEXT]; contexts],
+            thresholds: vec![0; contexts],
+            claims: vec![0; contexts],
         }
     }
 
+    /// Number of interrupt contexts.
+    const fn contexts(&self) -> usize {
+        self.thresholds.len()
+    }
+
     /// Updates the pending status of interrupts based on external signals.
     ///
     /// # Arguments
@@ -72,29 +85,24 @@ impl Plic {
 
     /// Checks for pending interrupts that exceed the priority threshold.
     ///
+    /// Re-evaluates every context and latches its claim value.
+    ///
     /// # Returns
     ///
     /// A tuple `(meip, seip)` indicating if a Machine External Interrupt
-    /// or Supervisor External Interrupt is pending.
+    /// or Supervisor External Interrupt is pending for hart 0.
     pub fn check_interrupts(&mut self) -> (bool, bool) {
-        let mut meip = false;
-        let mut seip = false;
-
-        if self.has_qualified_irq(0) {
-            meip = true;
-            self.claims[0] = self.calc_max_id(0);
-        } else {
-            self.claims[0] = 0;
-        }
-
-        if self.has_qualified_irq(1) {
-            seip = true;
-            self.claims[1] = self.calc_max_id(1);
-        } else {
-            self.claims[1] = 0;
+        for ctx in 0..self.contexts() {
+            self.claims[ctx] = if self.has_qualified_irq(ctx) { self.calc_max_id(ctx) } else { 0 };
         }
+        self.hart_interrupts(0)
+    }
 
-        (meip, seip)
+    /// Returns `(meip, seip)` for `hart` as of the last [`Self::check_interrupts`].
+    pub fn hart_interrupts(&self, hart: usize) -> (bool, bool) {
+        let ctx = hart * CONTEXTS_PER_HART;
+        let asserted = |c: usize| self.claims.get(c).is_some_and(|&id| id != 0);
+        (asserted(ctx), asserted(ctx + 1))
     }
 
     /// Determines if a context has any pending interrupt above its threshold.
@@ -183,13 +191,13 @@ impl Device for Plic {
             let rel = (offset - PLIC_ENABLE_BASE) as usize;
             let ctx = rel / 0x80;
             let word_idx = (rel % 0x80) / 4;
-            if ctx < NUM_CONTEXTS && word_idx < ENABLE_WORDS_PER_CONTEXT {
+            if ctx < self.contexts() && word_idx < ENABLE_WORDS_PER_CONTEXT {
                 return self.enables[ctx][word_idx];
             }
         } else if offset >= PLIC_CONTEXT_BASE {
             let ctx = (offset - PLIC_CONTEXT_BASE) as usize / 0x1000;
             let reg = offset & 0xFFF;
-            if ctx < 2 {
+            if ctx < self.contexts() {
                 if reg == 0 {
                     return self.thresholds[ctx];
                 }
@@ -226,13 +234,13 @@ impl Device for Plic {
             let rel = (offset - PLIC_ENABLE_BASE) as usize;
             let ctx = rel / 0x80;
             let word_idx = (rel % 0x80) / 4;
-            if ctx < NUM_CONTEXTS && word_idx < ENABLE_WORDS_PER_CONTEXT {
+            if ctx < self.contexts() && word_idx < ENABLE_WORDS_PER_CONTEXT {
                 self.enables[ctx][word_idx] = val;
             }
         } else if offset >= PLIC_CONTEXT_BASE {
             let ctx = (offset - PLIC_CONTEXT_BASE) as usize / 0x1000;
             let reg = offset & 0xFFF;
-            if ctx < 2 {
+            if ctx < self.contexts() {
                 if reg == 0 {
                     self.thresholds[ctx] = val;
                 }
@@ -300,4 +308,14 @@ impl Device for Plic {
     fn as_plic_mut(&mut self) -> Option<&mut Plic> {
         Some(self)
     }
+
+    /// Any programmed priority, enable, or threshold, or a pending or claimed source.
+    fn has_unsaved_state(&self) -> bool {
+        let nonzero = |words: &[u32]| words.iter().any(|&w| w != 0);
+        nonzero(&self.priorities)
+            || nonzero(&self.pending)
+            || self.enables.iter().any(|e| nonzero(e))
+            || nonzero(&self.thresholds)
+            || nonzero(&self.claims)
+    }
 }
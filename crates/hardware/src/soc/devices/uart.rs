@@ -358,11 +358,38 @@ impl Device for Uart {
         (iir & IIR_NO_INTERRUPT) == 0
     }
 
+    /// Advances the stdin poll counter by `cycles`, polling once if it wraps.
+    fn advance(&mut self, cycles: u64) -> bool {
+        let elapsed = u64::from(self.tick_count) + cycles;
+        self.tick_count = elapsed as u8;
+        if elapsed > u64::from(u8::MAX) {
+            self.check_stdin();
+        }
+        let iir = self.update_interrupts();
+        (iir & IIR_NO_INTERRUPT) == 0
+    }
+
+    /// Cycles until the next stdin poll.
+    fn next_event(&self) -> Option<u64> {
+        Some(u64::from(u8::MAX) + 1 - u64::from(self.tick_count))
+    }
+
     /// Returns the Interrupt Request (IRQ) ID associated with this device.
     fn get_irq_id(&self) -> Option<IrqId> {
         Some(IrqId::new(10))
     }
 
+    /// Programmed control registers or unread input. Plain polled output
+    /// (writing THR, reading LSR) leaves no state behind.
+    fn has_unsaved_state(&self) -> bool {
+        self.ier != 0
+            || self.lcr != 0
+            || self.mcr != 0
+            || self.scr != 0
+            || self.div != 0
+            || !self.rx_queue.is_empty()
+    }
+
     /// Returns a mutable reference to the UART if this device is one.
     fn as_uart_mut(&mut self) -> Option<&mut Uart> {
         Some(self)
@@ -5,7 +5,10 @@
 
 use crate::common::IrqId;
 use crate::soc::devices::Device;
+use crate::soc::devices::disk_image::DiskImage;
 use crate::soc::memory::buffer::DramBuffer;
+use std::cmp::Reverse;
+use std::collections::BinaryHeap;
 use std::sync::Arc;
 
 /// `VirtIO` MMIO magic value register offset.
@@ -116,11 +119,33 @@ const VRING_DESC_F_WRITE: u16 = 2;
 /// Disk sector size in bytes (512 bytes per sector).
 const SECTOR_SIZE: u64 = 512;
 
+/// A request whose data has been transferred but which the driver has not yet
+/// been told about.
+#[derive(Clone, Copy, Debug, PartialEq, Eq, PartialOrd, Ord)]
+struct InFlight {
+    /// Device cycle at which the request completes.
+    done: u64,
+    /// Head descriptor index, reported in the used ring.
+    head: u16,
+    /// Bytes written into guest buffers, reported in the used ring.
+    len: u32,
+    /// Guest address of the status byte, if the request had one.
+    status_addr: Option<u64>,
+}
+
 /// `VirtIO` Block device structure.
 ///
 /// Implements a memory-mapped block device compliant with the `VirtIO` specification.
 /// It uses a shared DRAM buffer to perform DMA operations for reading and writing
-/// disk sectors.
+/// disk sectors, copying directly between guest RAM and the (usually `mmap`ed)
+/// [`DiskImage`].
+///
+/// Requests are serviced by `queue_depth` independent channels. Each takes
+/// `latency` cycles plus its size over `bytes_per_cycle` from when a channel
+/// frees up; its data moves when the driver notifies the queue, but the used
+/// ring entry, status byte, and interrupt are only posted once it completes.
+/// With no latency or bandwidth limit every request completes during the
+/// notify write.
 #[derive(Debug)]
 pub struct VirtioBlock {
     /// Base physical address of the device MMIO region.
@@ -128,7 +153,7 @@ pub struct VirtioBlock {
     /// Base physical address of system RAM.
     ram_base: u64,
     /// Disk image data.
-    disk_image: Vec<u8>,
+    disk_image: DiskImage,
     /// Shared reference to system RAM for DMA.
     ram: Arc<DramBuffer>,
 
@@ -163,6 +188,19 @@ pub struct VirtioBlock {
     device_features_sel: u32,
     /// Driver features selection.
     driver_features_sel: u32,
+
+    /// Fixed service latency per request, in cycles.
+    latency: u64,
+    /// Transfer bandwidth in bytes per cycle (0 = unlimited).
+    bytes_per_cycle: u64,
+    /// Cycle at which each service channel next becomes free.
+    channels: Vec<u64>,
+    /// Cycles this device has been advanced.
+    now: u64,
+    /// Requests awaiting completion, earliest first.
+    in_flight: BinaryHeap<Reverse<InFlight>>,
+    /// Descriptor chain of the request being parsed (reused across requests).
+    descriptors: Vec<(u64, u32, u16)>,
 }
 
 unsafe impl Send for VirtioBlock {}
@@ -171,16 +209,19 @@ unsafe impl Sync for VirtioBlock {}
 impl VirtioBlock {
     /// Creates a new `VirtIO` Block device.
     ///
+    /// The device starts with an empty disk and completes requests instantly;
+    /// see [`Self::with_timing`].
+    ///
     /// # Arguments
     ///
     /// * `base_addr` - MMIO base address.
     /// * `ram_base` - System RAM base address.
     /// * `ram` - Shared DRAM buffer for DMA access.
-    pub const fn new(base_addr: u64, ram_base: u64, ram: Arc<DramBuffer>) -> Self {
+    pub fn new(base_addr: u64, ram_base: u64, ram: Arc<DramBuffer>) -> Self {
         Self {
             base_addr,
             ram_base,
-            disk_image: Vec::new(),
+            disk_image: DiskImage::default(),
             ram,
             status: 0,
             queue_num: 0,
@@ -196,57 +237,93 @@ impl VirtioBlock {
             last_avail_idx: 0,
             device_features_sel: 0,
             driver_features_sel: 0,
+            latency: 0,
+            bytes_per_cycle: 0,
+            channels: vec![0],
+            now: 0,
+            in_flight: BinaryHeap::new(),
+            descriptors: Vec::with_capacity(QUEUE_NUM_MAX_VALUE as usize),
         }
     }
 
-    /// Loads a disk image into the device.
+    /// Sets the request service model.
     ///
     /// # Arguments
     ///
-    /// * `data` - The raw bytes of the disk image.
-    pub fn load(&mut self, data: Vec<u8>) {
-        self.disk_image = data;
+    /// * `latency` - Fixed cycles per request.
+    /// * `bytes_per_cycle` - Transfer bandwidth (0 = unlimited).
+    /// * `queue_depth` - Requests serviced concurrently (at least 1).
+    #[must_use]
+    pub fn with_timing(mut self, latency: u64, bytes_per_cycle: u64, queue_depth: usize) -> Self {
+        self.latency = latency;
+        self.bytes_per_cycle = bytes_per_cycle;
+        self.channels = vec![self.now; queue_depth.max(1)];
+        self
     }
 
-    /// Performs a Direct Memory Access (DMA) read from system RAM.
-    ///
-    /// Reads `len` bytes from the physical address `addr`.
+    /// Loads a disk image into the device.
     ///
     /// # Arguments
     ///
-    /// * `addr` - Physical address to read from.
-    /// * `len` - Number of bytes to read.
-    ///
-    /// # Returns
-    ///
-    /// A vector containing the read bytes. Returns zeroed bytes if the address
-    /// is out of bounds.
-    fn dma_read(&self, addr: u64, len: usize) -> Vec<u8> {
-        if addr < self.ram_base {
-            return vec![0; len];
-        }
-        let offset = (addr - self.ram_base) as usize;
+    /// * `data` - The raw bytes of the disk image.
+    pub fn load(&mut self, data: Vec<u8>) {
+        self.disk_image = DiskImage::from_vec(data);
+    }
 
-        if offset >= self.ram.len() || offset + len > self.ram.len() {
-            return vec![0; len];
-        }
+    /// Attaches an opened (typically file-mapped) disk image.
+    pub fn attach(&mut self, image: DiskImage) {
+        self.disk_image = image;
+    }
 
-        self.ram.read_slice(offset, len).to_vec()
+    /// Number of requests transferred but not yet completed.
+    pub fn in_flight(&self) -> usize {
+        self.in_flight.len()
     }
 
+    /// Device reset (the driver writes 0 to the status register).
+    ///
+    /// Returns every register to its initial value and drops requests still
+    /// in flight, so none of them completes into the rings the driver sets up
+    /// next. The disk contents and timing model are kept.
+    fn reset(&mut self) {
+        self.status = 0;
+        self.queue_num = 0;
+        self.queue_ready = 0;
+        self.queue_notify = 0;
+        self.queue_desc_low = 0;
+        self.queue_desc_high = 0;
+        self.queue_avail_low = 0;
+        self.queue_avail_high = 0;
+        self.queue_used_low = 0;
+        self.queue_used_high = 0;
+        self.interrupt_status = 0;
+        self.last_avail_idx = 0;
+        self.device_features_sel = 0;
+        self.driver_features_sel = 0;
+        self.channels.fill(self.now);
+        self.in_flight.clear();
+    }
+
+    /// Returns the RAM offset of `len` bytes at physical address `addr`, or
+    /// `None` if they are not all inside RAM.
+    fn ram_offset(&self, addr: u64, len: usize) -> Option<usize> {
+        let offset = usize::try_from(addr.checked_sub(self.ram_base)?).ok()?;
+        (offset.checked_add(len)? <= self.ram.len()).then_some(offset)
+    }
+
+    /// Reads a `u16` from system RAM (0 if out of bounds).
     fn dma_read_u16(&self, addr: u64) -> u16 {
-        let b = self.dma_read(addr, 2);
-        u16::from_le_bytes([b[0], b[1]])
+        self.ram_offset(addr, 2).map_or(0, |offset| self.ram.read_u16(offset))
     }
 
+    /// Reads a `u32` from system RAM (0 if out of bounds).
     fn dma_read_u32(&self, addr: u64) -> u32 {
-        let b = self.dma_read(addr, 4);
-        u32::from_le_bytes([b[0], b[1], b[2], b[3]])
+        self.ram_offset(addr, 4).map_or(0, |offset| self.ram.read_u32(offset))
     }
 
+    /// Reads a `u64` from system RAM (0 if out of bounds).
     fn dma_read_u64(&self, addr: u64) -> u64 {
-        let b = self.dma_read(addr, 8);
-        u64::from_le_bytes([b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7]])
+        self.ram_offset(addr, 8).map_or(0, |offset| self.ram.read_u64(offset))
     }
 
     /// Performs a Direct Memory Access (DMA) write to system RAM.
@@ -258,28 +335,24 @@ impl VirtioBlock {
     /// * `addr` - Physical address to write to.
     /// * `data` - Bytes to write.
     fn dma_write(&self, addr: u64, data: &[u8]) {
-        if addr < self.ram_base {
-            println!("[VirtIO] DMA Write Out of Bounds (Low): 0x{addr:x}");
-            return;
-        }
-        let offset = (addr - self.ram_base) as usize;
-
-        if offset >= self.ram.len() || offset + data.len() > self.ram.len() {
-            println!(
+        match self.ram_offset(addr, data.len()) {
+            Some(offset) => self.ram.write_slice(offset, data),
+            None if addr < self.ram_base => {
+                println!("[VirtIO] DMA Write Out of Bounds (Low): 0x{addr:x}");
+            }
+            None => println!(
                 "[VirtIO] DMA Write Out of Bounds (High): 0x{:x} (Size: {})",
                 addr,
                 data.len()
-            );
-            return;
+            ),
         }
-
-        self.ram.write_slice(offset, data);
     }
 
     /// Processes the `VirtQueue`.
     ///
     /// Reads descriptors from the Available Ring, executes the requests (Read/Write),
-    /// and updates the Used Ring. This is triggered by a write to the Queue Notify register.
+    /// and schedules their completion. This is triggered by a write to the Queue Notify
+    /// register.
     fn process_queue(&mut self) {
         if self.queue_num == 0 {
             return;
@@ -287,9 +360,9 @@ impl VirtioBlock {
 
         let desc_addr = ((self.queue_desc_high as u64) << 32) | (self.queue_desc_low as u64);
         let avail_addr = ((self.queue_avail_high as u64) << 32) | (self.queue_avail_low as u64);
-        let used_addr = ((self.queue_used_high as u64) << 32) | (self.queue_used_low as u64);
 
         let avail_idx = self.dma_read_u16(avail_addr + 2);
+        let mut descriptors = std::mem::take(&mut self.descriptors);
 
         while self.last_avail_idx != avail_idx {
             let ring_offset = 4 + (self.last_avail_idx as u64 % self.queue_num as u64) * 2;
@@ -305,9 +378,13 @@ impl VirtioBlock {
             }
 
             let mut current_idx = head_idx;
-            let mut descriptors = Vec::new();
+            descriptors.clear();
 
             loop {
+                if descriptors.len() >= self.queue_num as usize {
+                    println!("[VirtIO] Error: Descriptor chain longer than the queue (loop?)");
+                    break;
+                }
                 if current_idx as u32 >= self.queue_num {
                     println!(
                         "[VirtIO] Error: Descriptor index {} out of bounds (Queue Size {})",
@@ -331,69 +408,110 @@ impl VirtioBlock {
             }
 
             let mut len_written = 0;
-            if descriptors.len() >= 3 {
+            let mut bytes = 0u64;
+            let status_addr = if descriptors.len() >= 3 {
                 let (h_addr, _, _) = descriptors[0];
-                let header = self.dma_read(h_addr, 16);
-                let type_val = u32::from_le_bytes([header[0], header[1], header[2], header[3]]);
-                let sector = u64::from_le_bytes([
-                    header[8], header[9], header[10], header[11], header[12], header[13],
-                    header[14], header[15],
-                ]);
+                let type_val = self.dma_read_u32(h_addr);
+                let sector = self.dma_read_u64(h_addr + 8);
                 let is_write = type_val == 1;
                 let is_flush = type_val == 4;
 
                 let (s_addr, _, _) = descriptors[descriptors.len() - 1];
+                let data = &descriptors[1..descriptors.len() - 1];
 
                 let sector_offset = (sector * SECTOR_SIZE) as usize;
-                let mut current_offset = 0;
+                let mut current_offset = sector_offset;
 
                 if is_flush {
                     // FLUSH: no data transfer, just acknowledge
                 } else if is_write {
-                    let mut current_disk_offset = sector_offset;
-
-                    for (d_addr, d_len, _) in &descriptors[1..descriptors.len() - 1] {
-                        let data = self.dma_read(*d_addr, *d_len as usize);
-                        if current_disk_offset + data.len() <= self.disk_image.len() {
-                            self.disk_image[current_disk_offset..current_disk_offset + data.len()]
-                                .copy_from_slice(&data);
+                    for &(d_addr, d_len, _) in data {
+                        let len = d_len as usize;
+                        if let Some(src) = self.ram_offset(d_addr, len)
+                            && let Some(dst) = self
+                                .disk_image
+                                .as_mut_slice()
+                                .get_mut(current_offset..current_offset + len)
+                        {
+                            dst.copy_from_slice(self.ram.read_slice(src, len));
                         }
-                        current_disk_offset += *d_len as usize;
-                        len_written += *d_len;
+                        current_offset += len;
+                        len_written += d_len;
                     }
+                    bytes = u64::from(len_written);
                 } else {
-                    for (d_addr, d_len, d_flags) in &descriptors[1..descriptors.len() - 1] {
-                        if (d_flags & VRING_DESC_F_WRITE) != 0
-                            && sector_offset + current_offset < self.disk_image.len()
-                        {
-                            let available =
-                                self.disk_image.len() - (sector_offset + current_offset);
-                            let copy_len = std::cmp::min(*d_len as usize, available);
+                    let disk = self.disk_image.as_slice();
+                    for &(d_addr, d_len, d_flags) in data {
+                        if (d_flags & VRING_DESC_F_WRITE) != 0 && current_offset < disk.len() {
+                            let copy_len = (d_len as usize).min(disk.len() - current_offset);
                             self.dma_write(
-                                *d_addr,
-                                &self.disk_image[sector_offset + current_offset
-                                    ..sector_offset + current_offset + copy_len],
+                                d_addr,
+                                &disk[current_offset..current_offset + copy_len],
                             );
                             len_written += copy_len as u32;
                         }
-                        current_offset += *d_len as usize;
+                        current_offset += d_len as usize;
                     }
+                    bytes = u64::from(len_written);
                 }
 
+                Some(s_addr)
+            } else {
+                None
+            };
+
+            let done = self.schedule(bytes);
+            self.in_flight.push(Reverse(InFlight {
+                done,
+                head: head_idx,
+                len: len_written,
+                status_addr,
+            }));
+            self.last_avail_idx = self.last_avail_idx.wrapping_add(1);
+        }
+        self.descriptors = descriptors;
+        self.retire();
+    }
+
+    /// Books a request of `bytes` on the earliest free channel; returns its
+    /// completion cycle.
+    fn schedule(&mut self, bytes: u64) -> u64 {
+        let transfer =
+            if self.bytes_per_cycle == 0 { 0 } else { bytes.div_ceil(self.bytes_per_cycle) };
+        let Some(channel) = self.channels.iter_mut().min() else {
+            return self.now;
+        };
+        let done = (*channel).max(self.now) + self.latency + transfer;
+        *channel = done;
+        done
+    }
+
+    /// Posts every request completed by the current cycle to the used ring and
+    /// raises the interrupt if any were.
+    fn retire(&mut self) {
+        let used_addr = ((self.queue_used_high as u64) << 32) | (self.queue_used_low as u64);
+        let mut completed = false;
+        while let Some(&Reverse(req)) = self.in_flight.peek()
+            && req.done <= self.now
+        {
+            let _ = self.in_flight.pop();
+            if let Some(s_addr) = req.status_addr {
                 self.dma_write(s_addr, &[0]);
             }
 
             let used_idx_addr = used_addr + 2;
             let current_used = self.dma_read_u16(used_idx_addr);
-            let used_elem = used_addr + 4 + (current_used as u64 % self.queue_num as u64) * 8;
+            let used_elem =
+                used_addr + 4 + (current_used as u64 % self.queue_num.max(1) as u64) * 8;
 
-            self.dma_write(used_elem, &u32::from(head_idx).to_le_bytes());
-            self.dma_write(used_elem + 4, &len_written.to_le_bytes());
+            self.dma_write(used_elem, &u32::from(req.head).to_le_bytes());
+            self.dma_write(used_elem + 4, &req.len.to_le_bytes());
             self.dma_write(used_idx_addr, &current_used.wrapping_add(1).to_le_bytes());
-
-            self.last_avail_idx = self.last_avail_idx.wrapping_add(1);
+            completed = true;
+        }
+        if completed {
+            self.interrupt_status |= 1;
         }
-        self.interrupt_status |= 1;
     }
 }
 
@@ -457,6 +575,7 @@ impl Device for VirtioBlock {
                 self.process_queue();
             }
             REG_INTERRUPT_ACK => self.interrupt_status &= !val,
+            REG_STATUS if val == 0 => self.reset(),
             REG_STATUS => self.status = val,
             REG_QUEUE_DESC_LOW => self.queue_desc_low = val,
             REG_QUEUE_DESC_HIGH => self.queue_desc_high = val,
@@ -497,11 +616,28 @@ impl Device for VirtioBlock {
     ///
     /// Returns true if an interrupt is pending.
     fn tick(&mut self) -> bool {
+        self.advance(1)
+    }
+
+    /// Advances the device clock by `cycles`, completing every request due by then.
+    fn advance(&mut self, cycles: u64) -> bool {
+        self.now += cycles;
+        self.retire();
         (self.interrupt_status & 1) != 0
     }
 
+    /// Cycles until the earliest in-flight request completes.
+    fn next_event(&self) -> Option<u64> {
+        self.in_flight.peek().map(|Reverse(req)| req.done.saturating_sub(self.now))
+    }
+
     /// Returns the Interrupt Request (IRQ) ID associated with this device.
     fn get_irq_id(&self) -> Option<IrqId> {
         Some(IrqId::new(1))
     }
+
+    /// Any driver initialization, since the queue and in-flight requests are not saved.
+    fn has_unsaved_state(&self) -> bool {
+        self.status != 0 || self.queue_num != 0 || !self.in_flight.is_empty()
+    }
 }
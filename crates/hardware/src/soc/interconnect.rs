@@ -1,18 +1,30 @@
 //! System interconnect (bus) for memory and MMIO access.
 //!
 //! This module implements the bus that routes physical address accesses to devices. It provides:
-//! 1. **Device registration:** Devices are added by address range and sorted for lookup.
-//! 2. **Access routing:** Read/write by address with last-device hint for throughput.
-//! 3. **Tick and IRQ:** Each device is ticked; PLIC aggregates IRQs for timer and external.
+//! 1. **Device registration:** Devices are added by address range; a sorted, non-overlapping
+//!    region table is rebuilt on each registration (devices nested inside another, such as
+//!    HTIF inside RAM, take precedence over their parent).
+//! 2. **Access routing:** RAM accesses go straight to the `DramBuffer`; everything else is
+//!    routed by binary search over the region table.
+//! 3. **Tick and IRQ:** Event-driven. Each device reports when it next needs to run; `tick` is a
+//!    counter bump until the earliest deadline or an MMIO access, and only then are devices
+//!    brought up to date and the PLIC re-evaluated.
 //! 4. **Load and RAM pointer:** Binary loading and raw RAM pointer for CPU DMA-style access.
+//! 5. **SMP:** A hart's private bus in a multi-hart system reports the interrupt levels
+//!    published on its [`IrqLine`] instead of evaluating devices itself; the shared devices
+//!    live on the uncore's bus, which reports per-hart levels via [`Bus::hart_irqs`].
 
-use super::devices::Device;
+use super::devices::{Clint, Device};
+use super::memory::buffer::DramBuffer;
+use super::uncore::IrqLine;
 use crate::common::PhysAddr;
+use std::sync::Arc;
 
 /// System bus connecting CPU and devices; routes accesses by physical address.
 ///
 /// Holds a sorted list of devices (RAM, UART, disk, CLINT, PLIC, etc.), bus width and latency
-/// for transfer time calculation, and indices for fast RAM/UART/CLINT lookup.
+/// for transfer time calculation, the region table for routing, and indices for fast
+/// RAM/UART/CLINT lookup.
 pub struct Bus {
     /// Registered MMIO and memory devices (boxed for dynamic dispatch; `Send + Sync` for thread safety).
     devices: Vec<Box<dyn Device + Send + Sync>>,
@@ -20,11 +32,75 @@ pub struct Bus {
     pub width_bytes: u64,
     /// Base latency in cycles per transaction.
     pub latency_cycles: u64,
-    last_device_idx: usize,
+    /// Non-overlapping address regions sorted by start address.
+    regions: Vec<Region>,
+    /// Direct path to RAM, bypassing `dyn Device`.
+    ram: Option<RamWindow>,
     ram_idx: Option<usize>,
     uart_idx: Option<usize>,
-    htif_idx: Option<usize>,
     clint_idx: Option<usize>,
+    plic_idx: Option<usize>,
+    /// Number of `tick` calls so far (the bus's notion of the current cycle).
+    now: u64,
+    /// Per-device scheduling state, parallel to `devices`.
+    slots: Vec<DeviceSlot>,
+    /// Earliest `DeviceSlot::due` over all devices.
+    next_due: u64,
+    /// Set by MMIO accesses; forces a full re-evaluation on the next `tick`.
+    dirty: bool,
+    /// IRQ flags returned by the last full evaluation.
+    irq_flags: (bool, bool, bool, bool),
+    /// Interrupt levels published by the SMP uncore; replaces device evaluation in `tick`.
+    irq_line: Option<Arc<IrqLine>>,
+}
+
+/// A contiguous address range routed to one device.
+#[derive(Clone, Copy, Debug)]
+struct Region {
+    start: u64,
+    end: u64,
+    /// Index into `Bus::devices`.
+    idx: usize,
+    /// Base address of the device (offsets are relative to it).
+    base: u64,
+}
+
+/// RAM as seen by the bus fast path.
+#[derive(Debug)]
+struct RamWindow {
+    buffer: Arc<DramBuffer>,
+    base: u64,
+    size: u64,
+    /// Addresses claimed by devices nested inside RAM (e.g. HTIF), as one `[start, end)` span;
+    /// they take the slow path.
+    hole: (u64, u64),
+}
+
+impl RamWindow {
+    /// Returns the buffer offset for an access of `len` bytes if it lies entirely in RAM.
+    #[inline]
+    const fn offset(&self, raw: u64, len: u64) -> Option<usize> {
+        let offset = raw.wrapping_sub(self.base);
+        if offset < self.size
+            && self.size - offset >= len
+            && (raw.saturating_add(len) <= self.hole.0 || raw >= self.hole.1)
+        {
+            Some(offset as usize)
+        } else {
+            None
+        }
+    }
+}
+
+/// Scheduling state for one device.
+#[derive(Clone, Copy, Debug)]
+struct DeviceSlot {
+    /// Cycle the device has been advanced to.
+    synced: u64,
+    /// Cycle at which the device must next be advanced (`u64::MAX` = only on access).
+    due: u64,
+    /// IRQ level reported by the last `advance`.
+    irq: bool,
 }
 
 impl std::fmt::Debug for Bus {
@@ -32,11 +108,13 @@ impl std::fmt::Debug for Bus {
         f.debug_struct("Bus")
             .field("width_bytes", &self.width_bytes)
             .field("latency_cycles", &self.latency_cycles)
-            .field("last_device_idx", &self.last_device_idx)
+            .field("regions", &self.regions)
             .field("ram_idx", &self.ram_idx)
             .field("uart_idx", &self.uart_idx)
-            .field("htif_idx", &self.htif_idx)
             .field("clint_idx", &self.clint_idx)
+            .field("plic_idx", &self.plic_idx)
+            .field("now", &self.now)
+            .field("next_due", &self.next_due)
             .field("num_devices", &self.devices.len())
             .finish_non_exhaustive()
     }
@@ -58,15 +136,34 @@ impl Bus {
             devices: Vec::new(),
             width_bytes,
             latency_cycles,
-            last_device_idx: 0,
+            regions: Vec::new(),
+            ram: None,
             ram_idx: None,
             uart_idx: None,
-            htif_idx: None,
             clint_idx: None,
+            plic_idx: None,
+            now: 0,
+            slots: Vec::new(),
+            next_due: 0,
+            dirty: true,
+            irq_flags: (false, false, false, false),
+            irq_line: None,
         }
     }
 
-    /// Registers a device on the bus; devices are sorted by base address for lookup.
+    /// Makes `tick` report the levels published on `line` (a hart's private bus in an SMP
+    /// system, whose interrupt sources live on the uncore's bus).
+    pub fn attach_irq_line(&mut self, line: Arc<IrqLine>) {
+        self.irq_line = Some(line);
+    }
+
+    /// Iterates over the registered devices in address order.
+    pub fn devices(&self) -> impl Iterator<Item = &(dyn Device + Send + Sync)> {
+        self.devices.iter().map(AsRef::as_ref)
+    }
+
+    /// Registers a device on the bus; devices are sorted by base address and the region table
+    /// and RAM fast path are rebuilt.
     ///
     /// # Arguments
     ///
@@ -76,9 +173,14 @@ impl Bus {
         self.devices.sort_by_key(|d| d.address_range().0);
         self.ram_idx = self.devices.iter().position(|d| d.name() == "DRAM");
         self.uart_idx = self.devices.iter().position(|d| d.name() == "UART0");
-        self.htif_idx = self.devices.iter().position(|d| d.name() == "HTIF");
         self.clint_idx = self.devices.iter().position(|d| d.name() == "CLINT");
-        self.last_device_idx = 0;
+        self.plic_idx = self.devices.iter_mut().position(|d| d.as_plic_mut().is_some());
+        self.regions = build_regions(&self.devices);
+        self.ram = self.ram_window();
+        // Indices shifted; every device is re-evaluated on the next tick.
+        let slot = DeviceSlot { synced: self.now, due: self.now, irq: false };
+        self.slots = vec![slot; self.devices.len()];
+        self.dirty = true;
     }
 
     /// Returns the number of cycles to transfer the given number of bytes on this bus.
@@ -126,57 +228,98 @@ impl Bus {
     ///
     /// `true` if some device's range contains `paddr`.
     pub fn is_valid_address(&self, paddr: PhysAddr) -> bool {
-        let raw = paddr.val();
-        if let Some(idx) = self.ram_idx {
-            let (start, size) = self.devices[idx].address_range();
-            if raw >= start && raw < start + size {
-                return true;
-            }
-        }
-        for dev in &self.devices {
-            let (start, size) = dev.address_range();
-            if raw >= start && raw < start + size {
-                return true;
-            }
-        }
-        false
+        self.locate(paddr.val()).is_some()
     }
 
-    /// Advances all devices by one tick and updates PLIC; returns IRQ flags.
+    /// Advances the bus by one cycle and returns IRQ flags.
+    ///
+    /// Devices are not ticked individually: unless a device deadline is due or an MMIO access
+    /// happened since the last call, this only bumps the cycle counter and returns the cached
+    /// flags. Otherwise every device is advanced to the current cycle, the IRQ lines are
+    /// collected, and the PLIC is re-evaluated.
     ///
     /// # Returns
     ///
     /// (`timer_irq`, `msip`, `meip`, `seip`) for machine timer, machine software,
     /// machine external, and supervisor external interrupts.
     pub fn tick(&mut self) -> (bool, bool, bool, bool) {
-        let mut timer_irq = false;
-        let mut active_irqs = 0u64;
+        if let Some(line) = &self.irq_line {
+            self.now += 1;
+            return line.get();
+        }
+        self.tick_by(1)
+    }
 
-        for i in 0..self.devices.len() {
-            let dev = &mut self.devices[i];
-            if dev.tick() {
-                if let Some(id) = dev.get_irq_id()
-                    && id.val() < 64
-                {
-                    active_irqs |= 1 << id.val();
-                }
-                if dev.name() == "CLINT" {
-                    timer_irq = true;
-                }
-            }
+    /// Advances the bus by `cycles` cycles at once; returns hart 0's IRQ flags.
+    ///
+    /// `tick_by(0)` re-evaluates the devices after an MMIO access without advancing time.
+    pub fn tick_by(&mut self, cycles: u64) -> (bool, bool, bool, bool) {
+        self.now += cycles;
+        if self.now < self.next_due && !self.dirty {
+            return self.irq_flags;
         }
+        self.dirty = false;
 
-        // Query MSIP separately — it is independent of the timer comparison.
-        let msip = self
-            .clint_idx
-            .and_then(|idx| self.devices[idx].as_clint_mut())
-            .is_some_and(|clint| clint.msip_pending());
+        let mut active_irqs = 0u64;
+        let mut next_due = u64::MAX;
+        for (dev, slot) in self.devices.iter_mut().zip(&mut self.slots) {
+            if self.now > slot.synced {
+                slot.irq = dev.advance(self.now - slot.synced);
+                slot.synced = self.now;
+            }
+            slot.due = dev.next_event().map_or(u64::MAX, |n| self.now.saturating_add(n));
+            next_due = next_due.min(slot.due);
+            if slot.irq
+                && let Some(id) = dev.get_irq_id()
+                && id.val() < 64
+            {
+                active_irqs |= 1 << id.val();
+            }
+        }
+        self.next_due = next_due;
 
-        let (meip, seip) = self.find_plic().map_or((false, false), |plic| {
-            plic.update_irqs(active_irqs);
-            plic.check_interrupts()
+        let (timer_irq, msip) = self.clint_idx.map_or((false, false), |idx| {
+            let msip = self.devices[idx].as_clint_mut().is_some_and(|c| c.msip_pending());
+            (self.slots[idx].irq, msip)
         });
 
+        let (meip, seip) = self.plic_idx.and_then(|idx| self.devices[idx].as_plic_mut()).map_or(
+            (false, false),
+            |plic| {
+                plic.update_irqs(active_irqs);
+                plic.check_interrupts()
+            },
+        );
+
+        self.irq_flags = (timer_irq, msip, meip, seip);
+        self.irq_flags
+    }
+
+    /// Number of following [`Self::tick`] calls guaranteed to return the cached IRQ flags.
+    ///
+    /// Zero after an MMIO access (devices must be re-evaluated) and for a hart whose
+    /// interrupts come from an SMP IRQ line. Advancing that many cycles with
+    /// [`Self::tick_by`] is indistinguishable from ticking through them.
+    pub const fn quiet_cycles(&self) -> u64 {
+        if self.dirty || self.irq_line.is_some() {
+            return 0;
+        }
+        self.next_due.saturating_sub(self.now).saturating_sub(1)
+    }
+
+    /// Returns (`timer_irq`, `msip`, `meip`, `seip`) for `hart` as of the last evaluation.
+    ///
+    /// Reads the per-hart CLINT and PLIC state; used by the SMP uncore to publish each hart's
+    /// interrupt line.
+    pub fn hart_irqs(&mut self, hart: usize) -> (bool, bool, bool, bool) {
+        let (timer_irq, msip) = self
+            .clint_idx
+            .and_then(|idx| self.devices[idx].as_clint_mut())
+            .map_or((false, false), |c| (c.hart_timer_pending(hart), c.hart_msip_pending(hart)));
+        let (meip, seip) = self
+            .plic_idx
+            .and_then(|idx| self.devices[idx].as_plic_mut())
+            .map_or((false, false), |plic| plic.hart_interrupts(hart));
         (timer_irq, msip, meip, seip)
     }
 
@@ -212,93 +355,200 @@ impl Bus {
         None
     }
 
-    fn find_plic(&mut self) -> Option<&mut crate::soc::devices::Plic> {
-        for dev in &mut self.devices {
-            if let Some(plic) = dev.as_plic_mut() {
-                return Some(plic);
-            }
-        }
-        None
+    /// Returns the DRAM backing buffer if a RAM device is registered.
+    ///
+    /// Used by checkpoint save/restore to scan and remap RAM pages.
+    pub fn ram_buffer(&mut self) -> Option<&DramBuffer> {
+        let idx = self.ram_idx?;
+        self.devices[idx].as_memory_mut().map(|mem| mem.buffer())
+    }
+
+    /// Returns the CLINT, brought up to the current cycle, if one is registered.
+    ///
+    /// Used by checkpoint save/restore for the timer state.
+    pub fn clint_mut(&mut self) -> Option<&mut Clint> {
+        let idx = self.clint_idx?;
+        self.touch(idx);
+        self.devices[idx].as_clint_mut()
+    }
+
+    /// Returns the name of the first device holding state a checkpoint would lose
+    /// (see [`Device::has_unsaved_state`]).
+    pub fn unsaved_device(&self) -> Option<&str> {
+        self.devices.iter().find(|d| d.has_unsaved_state()).map(|d| d.name())
     }
 
     fn find_device(
         &mut self,
         paddr: PhysAddr,
     ) -> Option<(&mut Box<dyn Device + Send + Sync>, u64)> {
-        let raw = paddr.val();
-        // HTIF sits inside the RAM range so must be checked before any RAM
-        // fast-path (last_device_idx cache or ram_idx shortcut).
-        if let Some(idx) = self.htif_idx {
-            let (start, size) = self.devices[idx].address_range();
-            if raw >= start && raw < start + size {
-                self.last_device_idx = idx;
-                return Some((&mut self.devices[idx], raw - start));
-            }
+        let (idx, offset) = self.locate(paddr.val())?;
+        if Some(idx) != self.ram_idx {
+            self.touch(idx);
         }
+        Some((&mut self.devices[idx], offset))
+    }
 
-        if self.last_device_idx < self.devices.len() {
-            let (start, size) = self.devices[self.last_device_idx].address_range();
-            if raw >= start && raw < start + size {
-                return Some((&mut self.devices[self.last_device_idx], raw - start));
-            }
+    /// Brings an MMIO device up to the current cycle before it is accessed and schedules a
+    /// re-evaluation, since the access may change its state or IRQ line.
+    fn touch(&mut self, idx: usize) {
+        let slot = &mut self.slots[idx];
+        if self.now > slot.synced {
+            slot.irq = self.devices[idx].advance(self.now - slot.synced);
+            slot.synced = self.now;
         }
+        self.dirty = true;
+    }
 
-        if let Some(idx) = self.ram_idx {
-            let (start, size) = self.devices[idx].address_range();
-            if raw >= start && raw < start + size {
-                self.last_device_idx = idx;
-                return Some((&mut self.devices[idx], raw - start));
-            }
-        }
+    /// Returns the index of the device claiming `raw` and the device-relative offset.
+    fn locate(&self, raw: u64) -> Option<(usize, u64)> {
+        let i = self.regions.partition_point(|r| r.start <= raw).checked_sub(1)?;
+        let region = &self.regions[i];
+        (raw < region.end).then_some((region.idx, raw - region.base))
+    }
 
-        for (i, dev) in self.devices.iter_mut().enumerate() {
-            let (start, size) = dev.address_range();
-            if raw >= start && raw < start + size {
-                self.last_device_idx = i;
-                return Some((dev, raw - start));
-            }
-        }
-        None
+    /// Builds the RAM fast-path window, excluding any devices nested inside RAM.
+    fn ram_window(&mut self) -> Option<RamWindow> {
+        let idx = self.ram_idx?;
+        let (base, size) = self.devices[idx].address_range();
+        let end = base.saturating_add(size);
+        let hole = self
+            .devices
+            .iter()
+            .enumerate()
+            .filter(|&(i, _)| i != idx)
+            .map(|(_, d)| d.address_range())
+            .filter(|&(start, len)| start < end && start.saturating_add(len) > base)
+            .fold((u64::MAX, 0), |(lo, hi), (start, len)| {
+                (lo.min(start), hi.max(start.saturating_add(len)))
+            });
+        let buffer = self.devices[idx].as_memory_mut()?.shared_buffer();
+        Some(RamWindow { buffer, base, size, hole })
     }
 
     /// Reads one byte at the given physical address; returns 0 if no device claims the address.
+    #[inline]
     pub fn read_u8(&mut self, paddr: PhysAddr) -> u8 {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 1)
+        {
+            return ram.buffer.read_u8(offset);
+        }
         if let Some((dev, offset)) = self.find_device(paddr) { dev.read_u8(offset) } else { 0 }
     }
     /// Reads two bytes (little-endian) at the given physical address; returns 0 if unclaimed.
+    #[inline]
     pub fn read_u16(&mut self, paddr: PhysAddr) -> u16 {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 2)
+        {
+            return ram.buffer.read_u16(offset);
+        }
         if let Some((dev, offset)) = self.find_device(paddr) { dev.read_u16(offset) } else { 0 }
     }
     /// Reads four bytes (little-endian) at the given physical address; returns 0 if unclaimed.
+    #[inline]
     pub fn read_u32(&mut self, paddr: PhysAddr) -> u32 {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 4)
+        {
+            return ram.buffer.read_u32(offset);
+        }
         if let Some((dev, offset)) = self.find_device(paddr) { dev.read_u32(offset) } else { 0 }
     }
     /// Reads eight bytes (little-endian) at the given physical address; returns 0 if unclaimed.
+    #[inline]
     pub fn read_u64(&mut self, paddr: PhysAddr) -> u64 {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 8)
+        {
+            return ram.buffer.read_u64(offset);
+        }
         if let Some((dev, offset)) = self.find_device(paddr) { dev.read_u64(offset) } else { 0 }
     }
     /// Writes one byte at the given physical address; no-op if no device claims it.
+    #[inline]
     pub fn write_u8(&mut self, paddr: PhysAddr, val: u8) {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 1)
+        {
+            ram.buffer.write_u8(offset, val);
+            return;
+        }
         if let Some((dev, offset)) = self.find_device(paddr) {
             dev.write_u8(offset, val);
         }
     }
     /// Writes two bytes (little-endian) at the given physical address; no-op if unclaimed.
+    #[inline]
     pub fn write_u16(&mut self, paddr: PhysAddr, val: u16) {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 2)
+        {
+            ram.buffer.write_u16(offset, val);
+            return;
+        }
         if let Some((dev, offset)) = self.find_device(paddr) {
             dev.write_u16(offset, val);
         }
     }
     /// Writes four bytes (little-endian) at the given physical address; no-op if unclaimed.
+    #[inline]
     pub fn write_u32(&mut self, paddr: PhysAddr, val: u32) {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 4)
+        {
+            ram.buffer.write_u32(offset, val);
+            return;
+        }
         if let Some((dev, offset)) = self.find_device(paddr) {
             dev.write_u32(offset, val);
         }
     }
     /// Writes eight bytes (little-endian) at the given physical address; no-op if unclaimed.
+    #[inline]
     pub fn write_u64(&mut self, paddr: PhysAddr, val: u64) {
+        if let Some(ram) = &self.ram
+            && let Some(offset) = ram.offset(paddr.val(), 8)
+        {
+            ram.buffer.write_u64(offset, val);
+            return;
+        }
         if let Some((dev, offset)) = self.find_device(paddr) {
             dev.write_u64(offset, val);
         }
     }
 }
+
+/// Builds the sorted, non-overlapping region table for `devices`.
+///
+/// Each elementary interval between device boundaries goes to the smallest device covering it,
+/// so a device nested inside another (HTIF inside RAM) shadows that part of its parent.
+fn build_regions(devices: &[Box<dyn Device + Send + Sync>]) -> Vec<Region> {
+    let ranges: Vec<(u64, u64)> = devices
+        .iter()
+        .map(|d| {
+            let (start, size) = d.address_range();
+            (start, start.saturating_add(size))
+        })
+        .collect();
+    let mut bounds: Vec<u64> = ranges.iter().flat_map(|&r| <[u64; 2]>::from(r)).collect();
+    bounds.sort_unstable();
+    bounds.dedup();
+
+    let mut regions: Vec<Region> = Vec::new();
+    for w in bounds.windows(2) {
+        let (lo, hi) = (w[0], w[1]);
+        let Some(idx) = (0..ranges.len())
+            .filter(|&i| ranges[i].0 <= lo && ranges[i].1 >= hi)
+            .min_by_key(|&i| ranges[i].1 - ranges[i].0)
+        else {
+            continue;
+        };
+        match regions.last_mut() {
+            Some(last) if last.idx == idx && last.end == lo => last.end = hi,
+            _ => regions.push(Region { start: lo, end: hi, idx, base: ranges[idx].0 }),
+        }
+    }
+    regions
+}
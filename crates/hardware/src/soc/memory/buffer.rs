@@ -4,9 +4,40 @@
 //! It supports lazy allocation via `mmap` on Unix systems to optimize host memory usage
 //! and startup time. It provides interior mutability to allow shared access between
 //! the CPU (via the Memory device) and DMA-capable devices (like VirtIO).
+//!
+//! On Linux the mapping can be backed by huge pages (transparent or explicit, see
+//! [`HugePages`]) so random guest accesses do not thrash the host TLB, and placed on
+//! the NUMA node of the thread that creates it. [`DramBuffer::touched_pages`] reads
+//! the host page table to find the pages the guest has used, so checkpoints of a
+//! large, mostly idle RAM scan only its working set.
 
+use crate::config::HugePages;
+use std::io::{Read, Seek, SeekFrom};
 use std::ops::{Index, IndexMut};
 use std::slice;
+use std::sync::{Mutex, PoisonError};
+
+/// Size of an explicit huge page (`MAP_HUGETLB | MAP_HUGE_2MB`).
+#[cfg(target_os = "linux")]
+const HUGE_PAGE_SIZE: usize = 2 << 20;
+
+/// `MAP_HUGE_2MB`: log2 of the huge page size in the `MAP_HUGE_SHIFT` bits.
+#[cfg(target_os = "linux")]
+const MAP_HUGE_2MB: libc::c_int = 21 << 26;
+
+/// `MPOL_PREFERRED`: allocate on the given node, falling back to others when full.
+#[cfg(target_os = "linux")]
+const MPOL_PREFERRED: libc::c_long = 1;
+
+/// Nodes representable in the `mbind` node mask.
+#[cfg(target_os = "linux")]
+const MAX_NUMA_NODES: usize = 1024;
+
+/// `/proc/self/pagemap` entry bits: page present in RAM, page swapped out.
+#[cfg(target_os = "linux")]
+const PAGEMAP_PRESENT: u64 = 1 << 63;
+#[cfg(target_os = "linux")]
+const PAGEMAP_SWAPPED: u64 = 1 << 62;
 
 /// A simplified wrapper around a raw memory buffer.
 ///
@@ -17,6 +48,16 @@ pub struct DramBuffer {
     ptr: *mut u8,
     size: usize,
     is_mmap: bool,
+    /// Bytes mapped: `size`, rounded up to the huge page size for explicit huge pages.
+    map_len: usize,
+    /// Huge pages actually in use: explicit (hugetlbfs) pages cannot be remapped
+    /// per 4 KiB page; transparent ones are requested again after a remap.
+    huge_pages: HugePages,
+    /// Bind new pages to the NUMA node of the creating thread.
+    numa_local: bool,
+    /// Byte ranges currently mapped from a checkpoint file. Their pages may hold
+    /// data without appearing in the host page table until first read.
+    file_runs: Mutex<Vec<(usize, usize)>>,
 }
 
 unsafe impl Send for DramBuffer {}
@@ -27,6 +68,7 @@ impl std::fmt::Debug for DramBuffer {
         f.debug_struct("DramBuffer")
             .field("size", &self.size)
             .field("is_mmap", &self.is_mmap)
+            .field("huge_pages", &self.huge_pages)
             .finish_non_exhaustive()
     }
 }
@@ -48,12 +90,55 @@ impl DramBuffer {
     ///
     /// Panics if `mmap` fails on Unix.
     pub fn new(size: usize) -> Self {
+        Self::with_backing(size, HugePages::Off, false)
+    }
+
+    /// Creates a DRAM buffer with the given host backing.
+    ///
+    /// `huge_pages` selects transparent (`madvise(MADV_HUGEPAGE)`) or explicit
+    /// (`MAP_HUGETLB`, 2 MiB) huge pages. Explicit huge pages fall back to
+    /// transparent ones when the host has none reserved. With `numa_local`,
+    /// pages are preferentially allocated on the NUMA node of the calling
+    /// thread wherever they are first touched. Both are hints: they are
+    /// ignored off Linux or when the host does not support them.
+    ///
+    /// # Panics
+    ///
+    /// Panics if `mmap` fails on Unix.
+    pub fn with_backing(size: usize, huge_pages: HugePages, numa_local: bool) -> Self {
         #[cfg(unix)]
         {
-            use std::ptr;
+            #[cfg(target_os = "linux")]
+            if huge_pages == HugePages::Explicit && size > 0 {
+                let map_len = size.next_multiple_of(HUGE_PAGE_SIZE);
+                let ptr = unsafe {
+                    libc::mmap(
+                        std::ptr::null_mut(),
+                        map_len,
+                        libc::PROT_READ | libc::PROT_WRITE,
+                        libc::MAP_PRIVATE | libc::MAP_ANONYMOUS | libc::MAP_HUGETLB | MAP_HUGE_2MB,
+                        -1,
+                        0,
+                    )
+                };
+                if ptr != libc::MAP_FAILED {
+                    let buf = Self {
+                        ptr: ptr.cast(),
+                        size,
+                        is_mmap: true,
+                        map_len,
+                        huge_pages,
+                        numa_local,
+                        file_runs: Mutex::new(Vec::new()),
+                    };
+                    buf.advise();
+                    return buf;
+                }
+            }
+
             let ptr = unsafe {
                 libc::mmap(
-                    ptr::null_mut(),
+                    std::ptr::null_mut(),
                     size,
                     libc::PROT_READ | libc::PROT_WRITE,
                     libc::MAP_PRIVATE | libc::MAP_ANONYMOUS,
@@ -64,18 +149,82 @@ impl DramBuffer {
 
             assert!(ptr != libc::MAP_FAILED, "Failed to mmap DRAM buffer of size {size}");
 
-            Self { ptr: ptr as *mut u8, size, is_mmap: true }
+            let buf = Self {
+                ptr: ptr.cast(),
+                size,
+                is_mmap: true,
+                map_len: size,
+                huge_pages: if huge_pages == HugePages::Off {
+                    HugePages::Off
+                } else {
+                    HugePages::Transparent
+                },
+                numa_local,
+                file_runs: Mutex::new(Vec::new()),
+            };
+            buf.advise();
+            buf
         }
 
         #[cfg(not(unix))]
         {
+            let _ = (huge_pages, numa_local);
             let mut vec = vec![0u8; size];
             let ptr = vec.as_mut_ptr();
             std::mem::forget(vec);
-            Self { ptr, size, is_mmap: false }
+            Self {
+                ptr,
+                size,
+                is_mmap: false,
+                map_len: size,
+                huge_pages: HugePages::Off,
+                numa_local: false,
+                file_runs: Mutex::new(Vec::new()),
+            }
+        }
+    }
+
+    /// Applies the huge-page and NUMA hints to the whole anonymous mapping.
+    ///
+    /// Failures are ignored: the buffer works the same without either.
+    fn advise(&self) {
+        #[cfg(target_os = "linux")]
+        unsafe {
+            if self.huge_pages == HugePages::Transparent {
+                let _ = libc::madvise(self.ptr.cast(), self.map_len, libc::MADV_HUGEPAGE);
+            }
+            if self.numa_local {
+                let (mut cpu, mut node) = (0u32, 0u32);
+                let found = libc::syscall(
+                    libc::SYS_getcpu,
+                    &raw mut cpu,
+                    &raw mut node,
+                    std::ptr::null_mut::<libc::c_void>(),
+                ) == 0;
+                let node = node as usize;
+                if found && node < MAX_NUMA_NODES {
+                    const BITS: usize = libc::c_ulong::BITS as usize;
+                    let mut mask = [0 as libc::c_ulong; MAX_NUMA_NODES / BITS];
+                    mask[node / BITS] |= 1 << (node % BITS);
+                    let _ = libc::syscall(
+                        libc::SYS_mbind,
+                        self.ptr,
+                        self.map_len,
+                        MPOL_PREFERRED,
+                        mask.as_ptr(),
+                        MAX_NUMA_NODES + 1,
+                        0,
+                    );
+                }
+            }
         }
     }
 
+    /// Returns the huge pages backing the buffer, after any fallback.
+    pub const fn huge_pages(&self) -> HugePages {
+        self.huge_pages
+    }
+
     /// Returns the size of the buffer in bytes.
     pub const fn len(&self) -> usize {
         self.size
@@ -118,6 +267,72 @@ impl DramBuffer {
         }
     }
 
+    /// Reads a little-endian `u16` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 2` is out of bounds.
+    #[inline]
+    pub fn read_u16(&self, offset: usize) -> u16 {
+        assert!(offset + 2 <= self.size, "DRAM read out of bounds");
+        u16::from_le(unsafe { self.ptr.add(offset).cast::<u16>().read_unaligned() })
+    }
+
+    /// Reads a little-endian `u32` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 4` is out of bounds.
+    #[inline]
+    pub fn read_u32(&self, offset: usize) -> u32 {
+        assert!(offset + 4 <= self.size, "DRAM read out of bounds");
+        u32::from_le(unsafe { self.ptr.add(offset).cast::<u32>().read_unaligned() })
+    }
+
+    /// Reads a little-endian `u64` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 8` is out of bounds.
+    #[inline]
+    pub fn read_u64(&self, offset: usize) -> u64 {
+        assert!(offset + 8 <= self.size, "DRAM read out of bounds");
+        u64::from_le(unsafe { self.ptr.add(offset).cast::<u64>().read_unaligned() })
+    }
+
+    /// Writes a little-endian `u16` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 2` is out of bounds.
+    #[inline]
+    pub fn write_u16(&self, offset: usize, val: u16) {
+        assert!(offset + 2 <= self.size, "DRAM write out of bounds");
+        unsafe { self.ptr.add(offset).cast::<u16>().write_unaligned(val.to_le()) }
+    }
+
+    /// Writes a little-endian `u32` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 4` is out of bounds.
+    #[inline]
+    pub fn write_u32(&self, offset: usize, val: u32) {
+        assert!(offset + 4 <= self.size, "DRAM write out of bounds");
+        unsafe { self.ptr.add(offset).cast::<u32>().write_unaligned(val.to_le()) }
+    }
+
+    /// Writes a little-endian `u64` (any alignment).
+    ///
+    /// # Panics
+    ///
+    /// Panics if `offset + 8` is out of bounds.
+    #[inline]
+    pub fn write_u64(&self, offset: usize, val: u64) {
+        assert!(offset + 8 <= self.size, "DRAM write out of bounds");
+        unsafe { self.ptr.add(offset).cast::<u64>().write_unaligned(val.to_le()) }
+    }
+
     /// Reads a slice of memory safely.
     ///
     /// # Panics
@@ -142,6 +357,185 @@ impl DramBuffer {
     }
 }
 
+impl DramBuffer {
+    /// Replaces the whole buffer with the given pages of a checkpoint file.
+    ///
+    /// `pages` lists page numbers (in units of `page_size`) in ascending
+    /// order; page `pages[i]` is stored at `data_offset + i * page_size` in
+    /// `file`. Every other page reads as zero afterwards.
+    ///
+    /// On Unix, when the buffer is `mmap`ed and `page_size` is a multiple of
+    /// the host page size, the pages are mapped copy-on-write straight from
+    /// the file (`MAP_PRIVATE | MAP_FIXED`), so restore cost is independent
+    /// of RAM size and untouched pages are never read. Otherwise the pages
+    /// are copied in.
+    ///
+    /// # Errors
+    ///
+    /// Returns an [`InvalidData`](std::io::ErrorKind::InvalidData) error if
+    /// a page lies outside the buffer or `pages` is not strictly ascending,
+    /// and an I/O error if the file cannot be mapped or read.
+    pub fn restore_pages(
+        &self,
+        file: &std::fs::File,
+        data_offset: u64,
+        pages: &[u64],
+        page_size: usize,
+    ) -> std::io::Result<()> {
+        // Bounding every index by the page count (rather than multiplying it
+        // out) keeps a corrupt index from wrapping into RAM, and ascending
+        // order keeps the run grouping below from overflowing.
+        let page_count = self.size.div_ceil(page_size) as u64;
+        if pages.iter().any(|&p| p >= page_count) || pages.windows(2).any(|w| w[0] >= w[1]) {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidData,
+                "checkpoint page outside RAM or out of order",
+            ));
+        }
+
+        // Group pages that are contiguous both in RAM and in the file.
+        let mut runs: Vec<(u64, u64, usize)> = Vec::new(); // (first page, file index, count)
+        for (i, &page) in pages.iter().enumerate() {
+            match runs.last_mut() {
+                Some((first, _, count)) if *first + *count as u64 == page => *count += 1,
+                _ => runs.push((page, i as u64, 1)),
+            }
+        }
+
+        #[cfg(unix)]
+        if self.is_mmap && self.can_map(page_size) {
+            return self.map_runs(file, data_offset, &runs, page_size);
+        }
+
+        self.file_runs.lock().unwrap_or_else(PoisonError::into_inner).clear();
+        unsafe { std::ptr::write_bytes(self.ptr, 0, self.size) };
+        let mut file = file;
+        for &(first, index, count) in &runs {
+            let _ = file.seek(SeekFrom::Start(data_offset + index * page_size as u64))?;
+            // The last page may be partial when the RAM size is not page-aligned.
+            let offset = first as usize * page_size;
+            let len = (count * page_size).min(self.size - offset);
+            let dest = unsafe { slice::from_raw_parts_mut(self.ptr.add(offset), len) };
+            file.read_exact(dest)?;
+        }
+        Ok(())
+    }
+
+    /// Returns the `page_size` pages that may hold non-zero data, in ascending order.
+    ///
+    /// On Linux, host pages the guest never touched are absent from the host
+    /// page table (`/proc/self/pagemap`), so they are skipped without being
+    /// read; pages still mapped from a checkpoint file are always included.
+    /// Elsewhere, or if the page table cannot be read, every page is returned.
+    /// Callers must still check returned pages for zeros.
+    pub fn touched_pages(&self, page_size: usize) -> Vec<u64> {
+        let pages = self.size.div_ceil(page_size);
+        #[cfg(target_os = "linux")]
+        if self.is_mmap
+            && let Some(mut touched) = self.resident_pages(page_size)
+        {
+            let runs = self.file_runs.lock().unwrap_or_else(PoisonError::into_inner).clone();
+            for (offset, len) in runs {
+                let end = (offset + len).div_ceil(page_size).min(pages);
+                for page in &mut touched[offset / page_size..end] {
+                    *page = true;
+                }
+            }
+            return (0..pages as u64).filter(|&p| touched[p as usize]).collect();
+        }
+        (0..pages as u64).collect()
+    }
+
+    /// Marks each `page_size` page with a present or swapped host page.
+    #[cfg(target_os = "linux")]
+    fn resident_pages(&self, page_size: usize) -> Option<Vec<bool>> {
+        use std::os::unix::fs::FileExt;
+
+        let host = usize::try_from(unsafe { libc::sysconf(libc::_SC_PAGESIZE) }).ok()?;
+        if host == 0 || !page_size.is_multiple_of(host) {
+            return None;
+        }
+        let pagemap = std::fs::File::open("/proc/self/pagemap").ok()?;
+        let first = self.ptr as usize / host;
+        let count = self.size.div_ceil(host);
+        let mut touched = vec![false; self.size.div_ceil(page_size)];
+        let mut entries = vec![0u8; 8 * count.min(1 << 16)];
+        let mut done = 0;
+        while done < count {
+            let n = (count - done).min(entries.len() / 8);
+            let bytes = &mut entries[..8 * n];
+            pagemap.read_exact_at(bytes, 8 * (first + done) as u64).ok()?;
+            for (i, e) in bytes.chunks_exact(8).enumerate() {
+                let entry = u64::from_le_bytes([e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7]]);
+                if entry & (PAGEMAP_PRESENT | PAGEMAP_SWAPPED) != 0 {
+                    touched[(done + i) * host / page_size] = true;
+                }
+            }
+            done += n;
+        }
+        Some(touched)
+    }
+
+    /// Returns true if `page_size` chunks can be remapped on this host.
+    #[cfg(unix)]
+    fn can_map(&self, page_size: usize) -> bool {
+        let host = unsafe { libc::sysconf(libc::_SC_PAGESIZE) };
+        self.huge_pages != HugePages::Explicit
+            && host > 0
+            && page_size.is_multiple_of(host as usize)
+            && self.size.is_multiple_of(host as usize)
+    }
+
+    /// Maps `runs` of `file` over the buffer, after resetting it to zero pages.
+    #[cfg(unix)]
+    fn map_runs(
+        &self,
+        file: &std::fs::File,
+        data_offset: u64,
+        runs: &[(u64, u64, usize)],
+        page_size: usize,
+    ) -> std::io::Result<()> {
+        use std::os::unix::io::AsRawFd;
+
+        // A fresh anonymous mapping discards the old contents in O(1).
+        let ptr = unsafe {
+            libc::mmap(
+                self.ptr.cast(),
+                self.size,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_PRIVATE | libc::MAP_ANONYMOUS | libc::MAP_FIXED,
+                -1,
+                0,
+            )
+        };
+        if ptr == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error());
+        }
+        // The new mapping starts without the old one's hints.
+        self.advise();
+
+        let mut file_runs = Vec::with_capacity(runs.len());
+        for &(first, index, count) in runs {
+            let ptr = unsafe {
+                libc::mmap(
+                    self.ptr.add(first as usize * page_size).cast(),
+                    count * page_size,
+                    libc::PROT_READ | libc::PROT_WRITE,
+                    libc::MAP_PRIVATE | libc::MAP_FIXED,
+                    file.as_raw_fd(),
+                    (data_offset + index * page_size as u64) as libc::off_t,
+                )
+            };
+            if ptr == libc::MAP_FAILED {
+                return Err(std::io::Error::last_os_error());
+            }
+            file_runs.push((first as usize * page_size, count * page_size));
+        }
+        *self.file_runs.lock().unwrap_or_else(PoisonError::into_inner) = file_runs;
+        Ok(())
+    }
+}
+
 impl Drop for DramBuffer {
     /// Deallocates the DRAM buffer.
     ///
@@ -151,7 +545,7 @@ impl Drop for DramBuffer {
         if self.is_mmap {
             #[cfg(unix)]
             unsafe {
-                let _ = libc::munmap(self.ptr as *mut _, self.size);
+                let _ = libc::munmap(self.ptr as *mut _, self.map_len);
             }
         } else {
             #[cfg(not(unix))]
@@ -5,6 +5,8 @@
 //! 2. **DramController:** Multi-bank, row-buffer-aware latency with CAS, RAS,
 //!    precharge, tRRD, and periodic refresh for realistic DRAM timing.
 //!
+//! The queued, multi-channel FR-FCFS controller lives in [`super::frfcfs`].
+//!
 //! Controllers are `Send + Sync` for use with the Python bindings and multi-threaded simulation.
 
 /// Trait for memory controller implementations that report access latency in cycles.
@@ -23,6 +25,13 @@ pub trait MemoryController: Send + Sync {
     ///
     /// Latency in simulation cycles.
     fn access_latency(&mut self, addr: u64, current_cycle: u64) -> u64;
+
+    /// Accepts the write-back of a dirty line evicted from the last-level cache.
+    ///
+    /// Write-backs never stall the core; controllers that model write traffic
+    /// queue them and charge their bank and bus time to later reads. The
+    /// default ignores them, as the latency-only controllers always have.
+    fn write_back(&mut self, _addr: u64, _current_cycle: u64) {}
 }
 
 /// Fixed-latency memory controller; every access takes the same number of cycles.
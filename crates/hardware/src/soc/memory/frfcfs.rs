@@ -0,0 +1,434 @@
+//! FR-FCFS Transaction-Queue DRAM Controller.
+//!
+//! Models a multi-channel, multi-rank DRAM subsystem with a read queue and a
+//! write queue per channel:
+//! 1. **Address interleaving:** Consecutive 64-byte lines alternate between
+//!    channels; within a channel the row-sized blocks are spread across every
+//!    bank of every rank (row : rank : bank : column).
+//! 2. **Reads:** Timed when they arrive, against the bank, rank (tRRD) and
+//!    data-bus state left by earlier traffic. Requests to different banks and
+//!    channels overlap, so MSHR-level parallelism shortens the critical path.
+//!    A full read queue delays the arrival until the oldest read returns.
+//! 3. **Writes:** Dirty write-backs are buffered instead of timed. The queue
+//!    is scheduled first-ready, first-come-first-served: a write to an open
+//!    row goes before older writes that would need an activation. Writes are
+//!    issued into idle bus time ahead of later reads, and in a burst once the
+//!    queue reaches the high watermark (draining to the low watermark), which
+//!    is the only time write traffic delays reads.
+//! 4. **Bus turnaround and refresh:** A read following a write on the data bus
+//!    pays `t_wtr`; each channel refreshes every `t_refi` cycles.
+//!
+//! Reads keep arrival order relative to each other; the synchronous
+//! [`MemoryController`] interface owes the core a latency as soon as a read
+//! arrives, so a later read cannot overtake it.
+
+use std::cmp::Reverse;
+use std::collections::{BinaryHeap, VecDeque};
+
+use super::controller::{DramConfig, MemoryController};
+
+/// Byte size of one burst (a cache line), the channel interleaving granule.
+const LINE_SHIFT: u32 = 6;
+
+/// Configuration parameters for constructing an [`FrFcfsController`].
+#[derive(Clone, Copy, Debug)]
+pub struct FrFcfsConfig {
+    /// Per-bank DRAM timing; `num_banks` is the bank count of each rank.
+    pub dram: DramConfig,
+    /// Independent channels (each with its own queues and data bus).
+    pub channels: usize,
+    /// Ranks per channel (sharing the channel's data bus).
+    pub ranks: usize,
+    /// Outstanding reads each channel can hold.
+    pub read_queue_size: usize,
+    /// Buffered writes each channel can hold.
+    pub write_queue_size: usize,
+    /// Write-queue occupancy that starts a write drain.
+    pub write_high_watermark: usize,
+    /// Write-queue occupancy at which a drain stops.
+    pub write_low_watermark: usize,
+    /// Data-bus cycles per burst.
+    pub t_burst: u64,
+    /// Write-to-read bus turnaround in cycles.
+    pub t_wtr: u64,
+}
+
+/// Counters kept by the [`FrFcfsController`].
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct FrFcfsStats {
+    /// Read transactions served.
+    pub reads: u64,
+    /// Write transactions issued to the banks.
+    pub writes: u64,
+    /// Transactions that found their row open.
+    pub row_hits: u64,
+    /// Transactions that needed an activation (with or without precharge).
+    pub row_misses: u64,
+    /// Write drains started by the high watermark.
+    pub write_drains: u64,
+    /// Cycles reads waited for a read-queue slot.
+    pub read_queue_stall_cycles: u64,
+}
+
+/// Where an address lands in the DRAM array.
+#[derive(Clone, Copy, Debug)]
+struct Location {
+    /// Channel index.
+    channel: usize,
+    /// Flat bank index within the channel (`rank * banks_per_rank + bank`).
+    bank: usize,
+    /// Rank index within the channel.
+    rank: usize,
+    /// Row within the bank.
+    row: u64,
+}
+
+/// A buffered write.
+#[derive(Clone, Copy, Debug)]
+struct QueuedWrite {
+    /// Destination of the write.
+    loc: Location,
+    /// Cycle the write entered the queue.
+    arrival: u64,
+}
+
+/// Row-buffer state of one bank.
+#[derive(Clone, Copy, Debug, Default)]
+struct Bank {
+    /// Currently open row, or `None` if the bank is precharged.
+    open_row: Option<u64>,
+    /// Earliest cycle the bank accepts its next command.
+    ready: u64,
+}
+
+/// Per-channel state.
+#[derive(Debug)]
+struct Channel {
+    /// Banks of every rank, rank-major.
+    banks: Vec<Bank>,
+    /// Last activation per rank (for tRRD).
+    last_activate: Vec<Option<u64>>,
+    /// Cycle the data bus becomes free.
+    bus_free: u64,
+    /// Whether the last burst on the bus was a write.
+    bus_wrote: bool,
+    /// Completion cycles of outstanding reads (min-heap).
+    reads: BinaryHeap<Reverse<u64>>,
+    /// Buffered writes, oldest first.
+    writes: VecDeque<QueuedWrite>,
+    /// Next cycle at which an auto-refresh fires.
+    next_refresh: u64,
+}
+
+/// DRAM controller with per-channel read/write queues and FR-FCFS write
+/// scheduling. See the module documentation for the timing model.
+#[derive(Debug)]
+pub struct FrFcfsController {
+    cfg: FrFcfsConfig,
+    channels: Vec<Channel>,
+    banks_per_rank: usize,
+    row_shift: u32,
+    stats: FrFcfsStats,
+}
+
+impl FrFcfsController {
+    /// Creates a controller from an [`FrFcfsConfig`].
+    ///
+    /// Zero-sized channel, rank, bank and queue counts are raised to 1 and
+    /// the watermarks are clamped to `low <= high <= write_queue_size`.
+    pub fn new(cfg: FrFcfsConfig) -> Self {
+        debug_assert!(
+            cfg.dram.row_size_bytes.is_power_of_two(),
+            "row_size_bytes must be a power of two"
+        );
+        let mut cfg = cfg;
+        cfg.channels = cfg.channels.max(1);
+        cfg.ranks = cfg.ranks.max(1);
+        cfg.dram.num_banks = cfg.dram.num_banks.max(1);
+        cfg.read_queue_size = cfg.read_queue_size.max(1);
+        cfg.write_queue_size = cfg.write_queue_size.max(1);
+        cfg.write_high_watermark = cfg.write_high_watermark.clamp(1, cfg.write_queue_size);
+        cfg.write_low_watermark = cfg.write_low_watermark.min(cfg.write_high_watermark - 1);
+
+        let banks_per_rank = cfg.dram.num_banks;
+        let next_refresh = if cfg.dram.t_refi > 0 { cfg.dram.t_refi } else { u64::MAX };
+        let channels = (0..cfg.channels)
+            .map(|_| Channel {
+                banks: vec![Bank::default(); banks_per_rank * cfg.ranks],
+                last_activate: vec![None; cfg.ranks],
+                bus_free: 0,
+                bus_wrote: false,
+                reads: BinaryHeap::with_capacity(cfg.read_queue_size),
+                writes: VecDeque::with_capacity(cfg.write_queue_size),
+                next_refresh,
+            })
+            .collect();
+
+        Self {
+            cfg,
+            channels,
+            banks_per_rank,
+            row_shift: cfg.dram.row_size_bytes.trailing_zeros(),
+            stats: FrFcfsStats::default(),
+        }
+    }
+
+    /// Returns the controller's counters.
+    pub const fn stats(&self) -> FrFcfsStats {
+        self.stats
+    }
+
+    /// Returns the number of writes buffered across all channels.
+    pub fn queued_writes(&self) -> usize {
+        self.channels.iter().map(|c| c.writes.len()).sum()
+    }
+
+    /// Maps a physical address to its channel, bank and row.
+    const fn locate(&self, addr: u64) -> Location {
+        let channels = self.cfg.channels as u64;
+        let line = addr >> LINE_SHIFT;
+        let channel = (line % channels) as usize;
+        let local = ((line / channels) << LINE_SHIFT) | (addr & ((1 << LINE_SHIFT) - 1));
+        let block = local >> self.row_shift;
+        let banks = (self.banks_per_rank * self.cfg.ranks) as u64;
+        let bank = (block % banks) as usize;
+        Location { channel, bank, rank: bank / self.banks_per_rank, row: block / banks }
+    }
+
+    /// Applies every refresh due by `cycle` on channel `ch` and returns the
+    /// earliest cycle a new command may start.
+    fn refresh(&mut self, ch: usize, cycle: u64) -> u64 {
+        let t_refi = self.cfg.dram.t_refi;
+        let t_rfc = self.cfg.dram.t_rfc;
+        let channel = &mut self.channels[ch];
+        let mut effective = cycle;
+        while t_refi > 0 && effective >= channel.next_refresh {
+            let refresh_end = channel.next_refresh + t_rfc;
+            for bank in &mut channel.banks {
+                bank.ready = bank.ready.max(refresh_end);
+                bank.open_row = None;
+            }
+            channel.next_refresh += t_refi;
+            effective = effective.max(refresh_end);
+        }
+        effective
+    }
+
+    /// Issues one transaction no earlier than `at` and returns the cycle its
+    /// data burst starts.
+    fn issue(&mut self, loc: Location, at: u64, is_write: bool) -> u64 {
+        let FrFcfsConfig { dram, t_burst, t_wtr, .. } = self.cfg;
+        let channel = &mut self.channels[loc.channel];
+        let bank = &mut channel.banks[loc.bank];
+        let mut start = at.max(bank.ready);
+
+        let column = if bank.open_row == Some(loc.row) {
+            self.stats.row_hits += 1;
+            start
+        } else {
+            self.stats.row_misses += 1;
+            if bank.open_row.is_some() {
+                start += dram.t_pre;
+            }
+            if let Some(last) = channel.last_activate[loc.rank] {
+                start = start.max(last + dram.t_rrd);
+            }
+            channel.last_activate[loc.rank] = Some(start);
+            bank.open_row = Some(loc.row);
+            start + dram.t_ras
+        };
+
+        let turnaround = if channel.bus_wrote && !is_write { t_wtr } else { 0 };
+        let data = (column + dram.t_cas).max(channel.bus_free + turnaround);
+        channel.bus_free = data + t_burst;
+        channel.bus_wrote = is_write;
+        bank.ready = column + t_burst;
+        data
+    }
+
+    /// Index of the write FR-FCFS schedules next on channel `ch`: the oldest
+    /// row hit, else the oldest write.
+    fn pick_write(&self, ch: usize) -> usize {
+        let channel = &self.channels[ch];
+        channel
+            .writes
+            .iter()
+            .position(|w| channel.banks[w.loc.bank].open_row == Some(w.loc.row))
+            .unwrap_or(0)
+    }
+
+    /// Issues the next FR-FCFS write on channel `ch`, no earlier than `at`.
+    fn issue_write(&mut self, ch: usize, at: u64) {
+        let idx = self.pick_write(ch);
+        if let Some(write) = self.channels[ch].writes.remove(idx) {
+            self.stats.writes += 1;
+            let _ = self.issue(write.loc, at.max(write.arrival), true);
+        }
+    }
+
+    /// Issues queued writes that can start before `cycle`, filling idle bus
+    /// time without delaying requests that arrive at `cycle`.
+    fn issue_idle_writes(&mut self, ch: usize, cycle: u64) {
+        while !self.channels[ch].writes.is_empty() {
+            let channel = &self.channels[ch];
+            let write = channel.writes[self.pick_write(ch)];
+            let start =
+                write.arrival.max(channel.banks[write.loc.bank].ready).max(channel.bus_free);
+            if start >= cycle {
+                break;
+            }
+            self.issue_write(ch, start);
+        }
+    }
+
+    /// Drains channel `ch` down to the low watermark starting at `cycle`.
+    fn drain_writes(&mut self, ch: usize, cycle: u64) {
+        self.stats.write_drains += 1;
+        while self.channels[ch].writes.len() > self.cfg.write_low_watermark {
+            self.issue_write(ch, cycle);
+        }
+    }
+}
+
+impl MemoryController for FrFcfsController {
+    fn access_latency(&mut self, addr: u64, current_cycle: u64) -> u64 {
+        let loc = self.locate(addr);
+        let ch = loc.channel;
+        let mut arrival = self.refresh(ch, current_cycle);
+
+        // A full read queue admits the read once the oldest one returns.
+        let capacity = self.cfg.read_queue_size;
+        let reads = &mut self.channels[ch].reads;
+        while reads.peek().is_some_and(|&Reverse(done)| done <= arrival) {
+            let _ = reads.pop();
+        }
+        if reads.len() >= capacity
+            && let Some(Reverse(done)) = reads.pop()
+        {
+            self.stats.read_queue_stall_cycles += done.saturating_sub(arrival);
+            arrival = arrival.max(done);
+        }
+
+        self.issue_idle_writes(ch, arrival);
+        self.stats.reads += 1;
+        let data = self.issue(loc, arrival, false);
+        self.channels[ch].reads.push(Reverse(data + self.cfg.t_burst));
+        data - current_cycle
+    }
+
+    fn write_back(&mut self, addr: u64, current_cycle: u64) {
+        let loc = self.locate(addr);
+        let ch = loc.channel;
+        let arrival = self.refresh(ch, current_cycle);
+        self.issue_idle_writes(ch, arrival);
+        self.channels[ch].writes.push_back(QueuedWrite { loc, arrival });
+        if self.channels[ch].writes.len() >= self.cfg.write_high_watermark {
+            self.drain_writes(ch, arrival);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    const T_CAS: u64 = 5;
+    const T_RAS: u64 = 10;
+    const T_PRE: u64 = 8;
+    const T_BURST: u64 = 4;
+
+    /// 2 channels, 1 rank, 4 banks, 2 KiB rows, refresh disabled.
+    fn config() -> FrFcfsConfig {
+        FrFcfsConfig {
+            dram: DramConfig {
+                t_cas: T_CAS,
+                t_ras: T_RAS,
+                t_pre: T_PRE,
+                t_rrd: 0,
+                num_banks: 4,
+                row_size_bytes: 2048,
+                t_refi: 0,
+                t_rfc: 0,
+            },
+            channels: 2,
+            ranks: 1,
+            read_queue_size: 8,
+            write_queue_size: 8,
+            write_high_watermark: 4,
+            write_low_watermark: 1,
+            t_burst: T_BURST,
+            t_wtr: 6,
+        }
+    }
+
+    #[test]
+    fn test_lines_interleave_across_channels() {
+        let ctrl = FrFcfsController::new(config());
+        assert_eq!(ctrl.locate(0x00).channel, 0);
+        assert_eq!(ctrl.locate(0x40).channel, 1);
+        assert_eq!(ctrl.locate(0x80).channel, 0);
+        // A channel-local 2 KiB block spans 4 KiB of physical addresses.
+        let (a, b) = (ctrl.locate(0x0), ctrl.locate(0x1000));
+        assert_eq!((a.bank, a.row), (0, 0));
+        assert_eq!((b.bank, b.row), (1, 0));
+    }
+
+    #[test]
+    fn test_parallel_channels_overlap() {
+        let mut ctrl = FrFcfsController::new(config());
+        let cold = T_RAS + T_CAS;
+        assert_eq!(ctrl.access_latency(0x00, 0), cold);
+        // Same cycle, other channel: no queueing behind the first read.
+        assert_eq!(ctrl.access_latency(0x40, 0), cold);
+        // Same channel, same row: row hit, but waits for the data bus.
+        assert_eq!(ctrl.access_latency(0x80, 0), cold + T_BURST);
+        assert_eq!(ctrl.stats().row_hits, 1);
+    }
+
+    #[test]
+    fn test_writes_are_buffered_until_high_watermark() {
+        let mut ctrl = FrFcfsController::new(config());
+        // Keep the bus busy so no write finds idle time.
+        let _ = ctrl.access_latency(0x0, 0);
+        for i in 1..4 {
+            ctrl.write_back(i * 0x2000, 0);
+        }
+        assert_eq!(ctrl.queued_writes(), 3);
+        assert_eq!(ctrl.stats().writes, 0);
+
+        ctrl.write_back(0x8000, 0);
+        assert_eq!(ctrl.queued_writes(), 1, "drained to the low watermark");
+        assert_eq!(ctrl.stats().write_drains, 1);
+    }
+
+    #[test]
+    fn test_row_hit_writes_go_first() {
+        let mut ctrl = FrFcfsController::new(config());
+        let _ = ctrl.access_latency(0x0, 0); // opens bank 0 row 0 on channel 0
+        ctrl.write_back(0x2_0000, 0); // bank 0, another row (older)
+        ctrl.write_back(0x100, 0); // bank 0, open row (younger)
+        assert_eq!(ctrl.pick_write(0), 1);
+    }
+
+    #[test]
+    fn test_idle_time_absorbs_writes() {
+        let mut ctrl = FrFcfsController::new(config());
+        ctrl.write_back(0x0, 0);
+        // Long after the write arrived, the next read finds it already done.
+        let lat = ctrl.access_latency(0x0, 1000);
+        assert_eq!(ctrl.queued_writes(), 0);
+        assert_eq!(lat, T_CAS, "row opened by the write, no turnaround left");
+    }
+
+    #[test]
+    fn test_full_read_queue_delays_arrival() {
+        let mut cfg = config();
+        cfg.read_queue_size = 1;
+        let mut ctrl = FrFcfsController::new(cfg);
+        let first = ctrl.access_latency(0x0, 0);
+        // Other bank: would overlap, but must wait for the single slot.
+        let second = ctrl.access_latency(0x1000, 0);
+        assert!(second >= first + T_BURST);
+        assert!(ctrl.stats().read_queue_stall_cycles > 0);
+    }
+}
@@ -3,7 +3,8 @@
 //! This module implements the main system memory device. It provides:
 //! 1. **Buffer:** Backing storage (e.g., `DramBuffer`) for RAM contents.
 //! 2. **Memory:** Device implementation that maps the buffer at a physical base address.
-//! 3. **Controller:** Latency modeling (simple or DRAM row-buffer) for timing simulation.
+//! 3. **Controller:** Latency modeling (simple, DRAM row-buffer, or queued
+//!    FR-FCFS) for timing simulation.
 
 /// DRAM buffer implementation (e.g., mmap or `Vec`) for raw byte storage.
 pub mod buffer;
@@ -11,6 +12,9 @@ pub mod buffer;
 /// Memory controller implementations for access latency modeling.
 pub mod controller;
 
+/// Multi-channel transaction-queue controller with FR-FCFS scheduling.
+pub mod frfcfs;
+
 use self::buffer::DramBuffer;
 use crate::soc::devices::Device;
 use std::sync::Arc;
@@ -49,6 +53,18 @@ impl Memory {
         }
     }
 
+    /// Returns the underlying DRAM buffer.
+    pub fn buffer(&self) -> &DramBuffer {
+        &self.buffer
+    }
+
+    /// Returns a new shared handle to the underlying DRAM buffer.
+    ///
+    /// Used by the bus for its direct RAM fast path.
+    pub fn shared_buffer(&self) -> Arc<DramBuffer> {
+        Arc::clone(&self.buffer)
+    }
+
     /// Returns a raw mutable pointer to the underlying memory buffer.
     ///
     /// Required for devices like `VirtIO` that perform direct memory access (DMA)
@@ -76,23 +92,17 @@ impl Device for Memory {
 
     /// Reads a half-word (16-bit) from memory (Little Endian).
     fn read_u16(&mut self, offset: u64) -> u16 {
-        let i = offset as usize;
-        let s = self.buffer.read_slice(i, 2);
-        u16::from_le_bytes([s[0], s[1]])
+        self.buffer.read_u16(offset as usize)
     }
 
     /// Reads a word (32-bit) from memory (Little Endian).
     fn read_u32(&mut self, offset: u64) -> u32 {
-        let i = offset as usize;
-        let s = self.buffer.read_slice(i, 4);
-        u32::from_le_bytes([s[0], s[1], s[2], s[3]])
+        self.buffer.read_u32(offset as usize)
     }
 
     /// Reads a double-word (64-bit) from memory (Little Endian).
     fn read_u64(&mut self, offset: u64) -> u64 {
-        let i = offset as usize;
-        let s = self.buffer.read_slice(i, 8);
-        u64::from_le_bytes([s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7]])
+        self.buffer.read_u64(offset as usize)
     }
 
     /// Writes a byte to memory.
@@ -102,17 +112,17 @@ impl Device for Memory {
 
     /// Writes a half-word to memory (Little Endian).
     fn write_u16(&mut self, offset: u64, val: u16) {
-        self.buffer.write_slice(offset as usize, &val.to_le_bytes());
+        self.buffer.write_u16(offset as usize, val);
     }
 
     /// Writes a word to memory (Little Endian).
     fn write_u32(&mut self, offset: u64, val: u32) {
-        self.buffer.write_slice(offset as usize, &val.to_le_bytes());
+        self.buffer.write_u32(offset as usize, val);
     }
 
     /// Writes a double-word to memory (Little Endian).
     fn write_u64(&mut self, offset: u64, val: u64) {
-        self.buffer.write_slice(offset as usize, &val.to_le_bytes());
+        self.buffer.write_u64(offset as usize, val);
     }
 
     /// Writes a slice of bytes to memory.
@@ -19,4 +19,7 @@ pub mod memory;
 /// Device trait definitions for MMIO access.
 pub mod traits;
 
+/// Shared devices, interrupt lines, and atomics for multi-hart systems.
+pub mod uncore;
+
 pub use builder::System;
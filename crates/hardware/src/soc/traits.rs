@@ -3,7 +3,8 @@
 //! This module defines the `Device` trait implemented by all bus-attached components. It provides:
 //! 1. **Identification:** `name` and `address_range` for bus routing.
 //! 2. **Access:** Byte, half, word, and doubleword read/write at device-relative offsets.
-//! 3. **Lifecycle:** Optional `tick` and IRQ reporting for timer and interrupt devices.
+//! 3. **Lifecycle:** Optional `tick` and IRQ reporting for timer and interrupt devices, plus
+//!    `next_event`/`advance` so the bus only runs a device when it has something to do.
 //! 4. **Downcasting:** Optional casts to `Plic`, `Uart`, or `Memory` for device-specific access.
 //!
 //! All implementors must be `Send + Sync` for use with the Python bindings and multi-threaded simulation.
@@ -49,10 +50,33 @@ pub trait Device: Send + Sync {
     fn tick(&mut self) -> bool {
         false
     }
+    /// Advances device state by `cycles` (at least 1) cycles at once and returns the IRQ level,
+    /// exactly as `cycles` consecutive calls to `tick` would.
+    ///
+    /// The bus only lets cycles accumulate for devices whose `next_event` is more than one cycle
+    /// away, so the default (a single `tick`) is exact for any device whose `tick` keeps no
+    /// per-cycle state.
+    fn advance(&mut self, cycles: u64) -> bool {
+        let _ = cycles;
+        self.tick()
+    }
+    /// Returns the number of cycles until `tick` next changes device state on its own, or `None`
+    /// if the state (and IRQ level) only changes through MMIO accesses.
+    ///
+    /// Devices whose `tick` keeps per-cycle state must override this together with `advance`.
+    fn next_event(&self) -> Option<u64> {
+        None
+    }
     /// Returns the IRQ ID for this device if it can raise interrupts (e.g., PLIC line).
     fn get_irq_id(&self) -> Option<IrqId> {
         None
     }
+    /// Returns `true` if the guest has left state in this device that checkpoints do not
+    /// capture (configured registers, queued input, in-flight requests), so saving or
+    /// restoring one would silently lose it.
+    fn has_unsaved_state(&self) -> bool {
+        false
+    }
 
     /// Returns a mutable reference as `Clint` if this device is the CLINT; otherwise `None`.
     fn as_clint_mut(&mut self) -> Option<&mut Clint> {
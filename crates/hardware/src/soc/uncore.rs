@@ -0,0 +1,271 @@
+//! Shared uncore for multi-hart (SMP) systems.
+//!
+//! In an SMP system each hart owns a private `System` whose bus maps RAM directly (the
+//! `DramBuffer` is shared by every hart) and reaches all other devices through an [`MmioPort`]
+//! onto the single [`Uncore`]. It provides:
+//! 1. **Device hub:** The uncore owns the real devices (UART, `VirtIO`, CLINT, PLIC, ...) on its
+//!    own bus behind a mutex; ports forward MMIO accesses to it.
+//! 2. **Interrupt lines:** After every MMIO access and at every quantum boundary the uncore
+//!    publishes each hart's (MTIP, MSIP, MEIP, SEIP) levels on that hart's [`IrqLine`], which
+//!    the hart's bus reads from `tick` without taking the lock.
+//! 3. **Atomic domain:** [`AtomicDomain`] serializes the memory effect of LR/SC and AMOs
+//!    across harts and tracks each hart's reservation.
+
+use super::devices::Device;
+use super::interconnect::Bus;
+use super::memory::buffer::DramBuffer;
+use crate::common::PhysAddr;
+use std::sync::atomic::{AtomicU8, AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard, PoisonError};
+
+/// The uncore as shared between harts.
+pub type SharedUncore = Arc<Mutex<Uncore>>;
+
+/// Locks `mutex`, ignoring poisoning (a panicking hart thread already fails the run).
+pub fn lock<T>(mutex: &Mutex<T>) -> MutexGuard<'_, T> {
+    mutex.lock().unwrap_or_else(PoisonError::into_inner)
+}
+
+/// One hart's interrupt levels, published by the uncore.
+#[derive(Debug, Default)]
+pub struct IrqLine(AtomicU8);
+
+impl IrqLine {
+    const MTIP: u8 = 1 << 0;
+    const MSIP: u8 = 1 << 1;
+    const MEIP: u8 = 1 << 2;
+    const SEIP: u8 = 1 << 3;
+
+    /// Publishes (`timer_irq`, `msip`, `meip`, `seip`).
+    pub fn set(&self, (timer_irq, msip, meip, seip): (bool, bool, bool, bool)) {
+        let bits = (u8::from(timer_irq) * Self::MTIP)
+            | (u8::from(msip) * Self::MSIP)
+            | (u8::from(meip) * Self::MEIP)
+            | (u8::from(seip) * Self::SEIP);
+        self.0.store(bits, Ordering::Release);
+    }
+
+    /// Returns the last published (`timer_irq`, `msip`, `meip`, `seip`).
+    #[inline]
+    pub fn get(&self) -> (bool, bool, bool, bool) {
+        let bits = self.0.load(Ordering::Acquire);
+        (
+            bits & Self::MTIP != 0,
+            bits & Self::MSIP != 0,
+            bits & Self::MEIP != 0,
+            bits & Self::SEIP != 0,
+        )
+    }
+}
+
+/// Devices and interrupt wiring shared by all harts of an SMP system.
+#[derive(Debug)]
+pub struct Uncore {
+    /// Bus holding the shared devices (and RAM, for DMA).
+    pub bus: Bus,
+    /// Backing store of main memory, mapped by every hart's private bus.
+    ram: Arc<DramBuffer>,
+    /// Interrupt line per hart.
+    lines: Vec<Arc<IrqLine>>,
+}
+
+impl Uncore {
+    /// Wraps the device bus of a `harts`-hart system.
+    pub fn new(bus: Bus, ram: Arc<DramBuffer>, harts: usize) -> Self {
+        let lines = (0..harts.max(1)).map(|_| Arc::new(IrqLine::default())).collect();
+        Self { bus, ram, lines }
+    }
+
+    /// Number of harts wired to this uncore.
+    pub const fn harts(&self) -> usize {
+        self.lines.len()
+    }
+
+    /// Shared main-memory buffer.
+    pub fn ram(&self) -> Arc<DramBuffer> {
+        Arc::clone(&self.ram)
+    }
+
+    /// Interrupt line of `hart`, or `None` if out of range.
+    pub fn line(&self, hart: usize) -> Option<Arc<IrqLine>> {
+        self.lines.get(hart).cloned()
+    }
+
+    /// Advances device time by `cycles` and republishes every hart's interrupt line.
+    ///
+    /// `advance(0)` only re-evaluates, e.g. after an MMIO access changed device state.
+    pub fn advance(&mut self, cycles: u64) {
+        let _ = self.bus.tick_by(cycles);
+        for (hart, line) in self.lines.iter().enumerate() {
+            line.set(self.bus.hart_irqs(hart));
+        }
+    }
+}
+
+/// A hart-side window onto one uncore device; forwards every access to the uncore's bus.
+#[derive(Debug)]
+pub struct MmioPort {
+    uncore: SharedUncore,
+    name: String,
+    base: u64,
+    size: u64,
+}
+
+impl MmioPort {
+    /// Creates a port covering `dev`'s address range on `uncore`.
+    pub fn new(uncore: SharedUncore, dev: &dyn Device) -> Self {
+        let (base, size) = dev.address_range();
+        Self { uncore, name: dev.name().to_owned(), base, size }
+    }
+
+    /// Runs `f` on the uncore bus at `offset`, then republishes the interrupt lines since the
+    /// access may have changed device state (MSIP writes, PLIC claims, ...).
+    fn access<R>(&self, offset: u64, f: impl FnOnce(&mut Bus, PhysAddr) -> R) -> R {
+        let mut uncore = lock(&self.uncore);
+        let result = f(&mut uncore.bus, PhysAddr::new(self.base + offset));
+        uncore.advance(0);
+        result
+    }
+}
+
+impl Device for MmioPort {
+    fn name(&self) -> &str {
+        &self.name
+    }
+
+    fn address_range(&self) -> (u64, u64) {
+        (self.base, self.size)
+    }
+
+    fn read_u8(&mut self, offset: u64) -> u8 {
+        self.access(offset, Bus::read_u8)
+    }
+
+    fn read_u16(&mut self, offset: u64) -> u16 {
+        self.access(offset, Bus::read_u16)
+    }
+
+    fn read_u32(&mut self, offset: u64) -> u32 {
+        self.access(offset, Bus::read_u32)
+    }
+
+    fn read_u64(&mut self, offset: u64) -> u64 {
+        self.access(offset, Bus::read_u64)
+    }
+
+    fn write_u8(&mut self, offset: u64, val: u8) {
+        self.access(offset, |bus, addr| bus.write_u8(addr, val));
+    }
+
+    fn write_u16(&mut self, offset: u64, val: u16) {
+        self.access(offset, |bus, addr| bus.write_u16(addr, val));
+    }
+
+    fn write_u32(&mut self, offset: u64, val: u32) {
+        self.access(offset, |bus, addr| bus.write_u32(addr, val));
+    }
+
+    fn write_u64(&mut self, offset: u64, val: u64) {
+        self.access(offset, |bus, addr| bus.write_u64(addr, val));
+    }
+
+    fn write_bytes(&mut self, offset: u64, data: &[u8]) {
+        self.access(offset, |bus, addr| bus.load_binary_at(data, addr));
+    }
+}
+
+/// Reservation value meaning "no reservation held".
+const NO_RESERVATION: u64 = u64::MAX;
+
+/// Serializes atomic memory operations across harts.
+///
+/// The memory effect of every SC and AMO is performed while holding [`Self::lock`], so no two
+/// harts interleave inside one read-modify-write. An SC or AMO invalidates every hart's
+/// reservation on its granule; plain stores do not, so SC additionally checks that memory still
+/// holds the value its LR read.
+#[derive(Debug)]
+pub struct AtomicDomain {
+    lock: Mutex<()>,
+    /// Reserved granule address per hart (`NO_RESERVATION` when none).
+    reservations: Box<[AtomicU64]>,
+}
+
+impl AtomicDomain {
+    /// Creates a domain for `harts` harts with no reservations held.
+    pub fn new(harts: usize) -> Self {
+        let reservations = (0..harts.max(1)).map(|_| AtomicU64::new(NO_RESERVATION)).collect();
+        Self { lock: Mutex::new(()), reservations }
+    }
+
+    /// Acquires the domain lock for one atomic memory operation.
+    pub fn lock(&self) -> MutexGuard<'_, ()> {
+        lock(&self.lock)
+    }
+
+    /// Records that `hart` holds a reservation on `granule`.
+    pub fn reserve(&self, hart: usize, granule: u64) {
+        if let Some(slot) = self.reservations.get(hart) {
+            slot.store(granule, Ordering::Relaxed);
+        }
+    }
+
+    /// Returns whether `hart` still holds its reservation on `granule`.
+    pub fn holds(&self, hart: usize, granule: u64) -> bool {
+        self.reservations.get(hart).is_some_and(|slot| slot.load(Ordering::Relaxed) == granule)
+    }
+
+    /// Drops every hart's reservation on `granule`.
+    pub fn invalidate(&self, granule: u64) {
+        for slot in &self.reservations {
+            let _ = slot.compare_exchange(
+                granule,
+                NO_RESERVATION,
+                Ordering::Relaxed,
+                Ordering::Relaxed,
+            );
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::soc::devices::Clint;
+
+    #[test]
+    fn test_irq_line_round_trip() {
+        let line = IrqLine::default();
+        assert_eq!(line.get(), (false, false, false, false));
+        line.set((true, false, true, false));
+        assert_eq!(line.get(), (true, false, true, false));
+        line.set((false, true, false, true));
+        assert_eq!(line.get(), (false, true, false, true));
+    }
+
+    #[test]
+    fn test_port_write_publishes_ipi() {
+        let mut bus = Bus::new(8, 0);
+        bus.add_device(Box::new(Clint::with_harts(0x200_0000, 1, 2)));
+        let uncore = Arc::new(Mutex::new(Uncore::new(bus, Arc::new(DramBuffer::new(64)), 2)));
+        let line1 = lock(&uncore).line(1).unwrap_or_default();
+        let mut port = MmioPort::new(Arc::clone(&uncore), &Clint::new(0x200_0000, 1));
+
+        // MSIP for hart 1 lives at offset 4.
+        port.write_u32(4, 1);
+        assert!(line1.get().1);
+        assert!(!lock(&uncore).line(0).unwrap_or_default().get().1);
+        assert_eq!(port.read_u32(4), 1);
+    }
+
+    #[test]
+    fn test_sc_or_amo_invalidates_all_harts() {
+        let domain = AtomicDomain::new(3);
+        domain.reserve(0, 0x8000_0040);
+        domain.reserve(1, 0x8000_0040);
+        domain.reserve(2, 0x8000_0080);
+        domain.invalidate(0x8000_0040);
+        assert!(!domain.holds(0, 0x8000_0040));
+        assert!(!domain.holds(1, 0x8000_0040));
+        assert!(domain.holds(2, 0x8000_0080));
+    }
+}
@@ -6,10 +6,13 @@
 //! 3. **Branch prediction:** Lookups, mispredictions, and accuracy.
 //! 4. **Stalls:** Memory, control, and data hazard stall counts.
 //! 5. **Cache hierarchy:** Hit/miss counts for L1-I, L1-D, L2, and L3.
+//! 6. **Host time:** Per-stage host nanoseconds and call counts (with the
+//!    `stage-timing` feature).
 
 use crate::core::pipeline::backend::o3::fu_pool::FU_TYPE_COUNT;
+use crate::core::units::cache::stack_distance::StackDistanceHistogram;
 use std::io::IsTerminal;
-use std::time::Instant;
+use std::time::{Duration, Instant};
 
 /// Simulation statistics structure tracking all performance metrics.
 ///
@@ -18,6 +21,8 @@ use std::time::Instant;
 #[derive(Clone, Debug)]
 pub struct SimStats {
     start_time: Instant,
+    /// Host time the counters were frozen at (set by [`Self::since`]); `None` while live.
+    end_time: Option<Instant>,
     /// Total simulator cycles elapsed.
     pub cycles: u64,
     /// Number of instructions committed (retired).
@@ -45,6 +50,13 @@ pub struct SimStats {
     /// Count of FP divide/sqrt instructions retired.
     pub inst_fp_div_sqrt: u64,
 
+    /// Count of vector (RVV) instructions retired.
+    pub inst_vector: u64,
+    /// Body elements processed by retired vector instructions.
+    pub vector_elements: u64,
+    /// Cache lines touched by retired vector loads and stores.
+    pub vector_mem_lines: u64,
+
     /// Number of committed branch predictions that were correct.
     pub committed_branch_predictions: u64,
     /// Number of committed branch predictions that were wrong (mispredictions).
@@ -74,6 +86,45 @@ pub struct SimStats {
     /// Stall cycles due to data hazards (RAW dependencies).
     pub stalls_data: u64,
 
+    /// Rename issue slots (`width` per frontend cycle); the top-down denominator.
+    pub tma_slots: u64,
+    /// Issue slots whose instruction retired.
+    pub tma_retiring: u64,
+    /// Issue slots lost to misspeculation (squashed plus recovery).
+    pub tma_bad_speculation: u64,
+    /// Issue slots whose instruction was squashed from the ROB or faulted.
+    pub tma_bad_spec_squashed: u64,
+    /// Issue slots lost while the backend recovered from a flush.
+    pub tma_bad_spec_recovery: u64,
+    /// Issue slots the backend had room for but the frontend left empty.
+    pub tma_frontend_bound: u64,
+    /// Frontend-bound slots while fetch waited on an I-cache miss.
+    pub tma_fe_icache: u64,
+    /// Frontend-bound slots while fetch waited on I-TLB translation.
+    pub tma_fe_itlb: u64,
+    /// Frontend-bound slots while refilling after a redirect.
+    pub tma_fe_resteer: u64,
+    /// Frontend-bound slots from partial fetch blocks and pipeline fill.
+    pub tma_fe_bandwidth: u64,
+    /// Issue slots the backend could not accept.
+    pub tma_backend_bound: u64,
+    /// Backend-bound slots waiting on a load/store at the ROB head or a full store buffer.
+    pub tma_be_memory: u64,
+    /// Memory-bound slots with no miss outstanding past L1.
+    pub tma_be_mem_l1: u64,
+    /// Memory-bound slots with a data miss outstanding in L2.
+    pub tma_be_mem_l2: u64,
+    /// Memory-bound slots with a data miss outstanding in L3.
+    pub tma_be_mem_l3: u64,
+    /// Memory-bound slots with a data miss outstanding in DRAM.
+    pub tma_be_mem_dram: u64,
+    /// Backend-bound slots not waiting on memory.
+    pub tma_be_core: u64,
+    /// Core-bound slots in cycles where a ready instruction found no free unit.
+    pub tma_be_core_fu: u64,
+    /// Core-bound slots from execution latency and dependencies.
+    pub tma_be_core_other: u64,
+
     /// Number of traps (exceptions or interrupts) taken.
     pub traps_taken: u64,
 
@@ -81,6 +132,17 @@ pub struct SimStats {
     pub icache_hits: u64,
     /// L1 instruction cache miss count.
     pub icache_misses: u64,
+    /// Fetch target queue entries summed over cycles (average occupancy is
+    /// this over `cycles`).
+    pub ftq_occupancy: u64,
+    /// Cycles the branch predictor could not enqueue because the FTQ was full.
+    pub stalls_ftq_full: u64,
+    /// L1I lines prefetched by fetch-directed prefetching.
+    pub fdip_prefetches: u64,
+    /// Fetches that hit on an FDIP line whose fill had already arrived.
+    pub fdip_useful: u64,
+    /// Fetches that hit on an FDIP line and waited for the rest of its fill.
+    pub fdip_late: u64,
     /// L1 data cache hit count.
     pub dcache_hits: u64,
     /// L1 data cache miss count.
@@ -119,6 +181,25 @@ pub struct SimStats {
     pub mshr_coalesces: u64,
     /// Stalls due to all MSHRs being full.
     pub stalls_mshr_full: u64,
+    /// Cycles summed over L1D MSHR allocations from miss to fill (average
+    /// occupancy is this over `cycles`).
+    pub mshr_occupancy: u64,
+    /// L2 MSHR allocations (L1D misses that missed the L2).
+    pub l2_mshr_allocations: u64,
+    /// L1D misses merged with an in-flight L2 fill of the same line.
+    pub l2_mshr_coalesces: u64,
+    /// Cycles L1D misses waited for a free L2 MSHR.
+    pub stalls_l2_mshr_full: u64,
+    /// Cycles summed over L2 MSHR allocations.
+    pub l2_mshr_occupancy: u64,
+    /// L3 MSHR allocations (L1D misses that missed the L3).
+    pub l3_mshr_allocations: u64,
+    /// L1D misses merged with an in-flight L3 fill of the same line.
+    pub l3_mshr_coalesces: u64,
+    /// Cycles L1D misses waited for a free L3 MSHR.
+    pub stalls_l3_mshr_full: u64,
+    /// Cycles summed over L3 MSHR allocations.
+    pub l3_mshr_occupancy: u64,
     /// Load replays due to speculative wakeup on L1D miss.
     pub load_replays: u64,
 
@@ -127,6 +208,45 @@ pub struct SimStats {
     /// Exclusive policy: L1 evictees installed into L2 (swap).
     pub exclusive_l1_to_l2_swaps: u64,
 
+    /// Coherence: misses to lines another hart's write invalidated.
+    pub coherence_misses: u64,
+    /// Coherence: writes to lines held in S/O that needed an upgrade.
+    pub coherence_upgrades: u64,
+    /// Coherence: other harts' copies this hart's writes invalidated.
+    pub coherence_invalidations_sent: u64,
+    /// Coherence: lines this hart lost to other harts' writes.
+    pub coherence_invalidations_received: u64,
+    /// Coherence: misses served from another hart's cache.
+    pub coherence_transfers: u64,
+    /// Coherence: cycles added to accesses by directory transactions.
+    pub coherence_stall_cycles: u64,
+    /// Coherence: directory requests by number of other harts holding the
+    /// line (0, 1, 2, 3+).
+    pub coherence_sharers: [u64; 4],
+
+    /// Fetch translations that hit the iTLB.
+    pub itlb_hits: u64,
+    /// Fetch translations that missed the iTLB.
+    pub itlb_misses: u64,
+    /// Load/store translations that hit the dTLB.
+    pub dtlb_hits: u64,
+    /// Load/store translations that missed the dTLB.
+    pub dtlb_misses: u64,
+    /// L1 TLB misses served by the shared L2 TLB.
+    pub l2_tlb_hits: u64,
+    /// L1 TLB misses that also missed the L2 TLB.
+    pub l2_tlb_misses: u64,
+    /// TLB hits (L1 or L2) served by a 2 MiB / 1 GiB superpage entry.
+    pub tlb_superpage_hits: u64,
+    /// Hardware page table walks.
+    pub page_walks: u64,
+    /// PTEs read from memory by the page table walker.
+    pub ptw_pte_reads: u64,
+    /// Page walks that resumed below the root from the page-walk cache.
+    pub pwc_hits: u64,
+    /// Page walks that found no page-walk cache entry.
+    pub pwc_misses: u64,
+
     /// Write Combining Buffer: stores coalesced into existing WCB entries.
     pub wcb_coalesces: u64,
     /// Write Combining Buffer: entries drained to L1D.
@@ -157,6 +277,10 @@ pub struct SimStats {
     /// This is the physical cost of rate-limited ROB entry reclamation.
     pub stalls_squash: u64,
 
+    /// Commit stall cycles waiting for a vector queue slot or for the vector
+    /// sources of a vector instruction with a scalar result.
+    pub stalls_vector: u64,
+
     /// Pipeline flushes caused by branch/jump mispredictions.
     pub flushes_branch: u64,
     /// Pipeline flushes caused by serializing instructions (CSR, FENCE.I, MRET/SRET, etc.).
@@ -174,6 +298,158 @@ pub struct SimStats {
     /// Retirement histogram: how many instructions were retired per cycle.
     /// Index 0 = cycles with 0 retires, 1 = 1 retire, 2 = 2 retires, 3 = 3+ retires.
     pub retire_histogram: [u64; 4],
+
+    /// LRU stack-distance histograms of the L1-D access stream, giving the
+    /// miss ratio of every profiled geometry (empty unless
+    /// `cache.stack_distance` is enabled).
+    pub stack_distance: StackDistanceHistogram,
+
+    /// Host time spent in each pipeline stage, the bus, and the cache
+    /// hierarchy (all zero unless built with the `stage-timing` feature).
+    pub stage_times: StageTimes,
+}
+
+/// A pipeline stage (or the bus) timed by the `stage-timing` feature.
+#[derive(Clone, Copy, Debug, PartialEq, Eq)]
+pub enum Stage {
+    /// PC generation, branch prediction, and I-TLB/I-cache lookup.
+    Fetch1,
+    /// Instruction alignment and predecode.
+    Fetch2,
+    /// Decode into control signals.
+    Decode,
+    /// Register renaming and ROB allocation.
+    Rename,
+    /// Issue select.
+    Issue,
+    /// Functional-unit execution.
+    Execute,
+    /// Address translation.
+    Memory1,
+    /// D-cache access and store-buffer forwarding.
+    Memory2,
+    /// Result writeback.
+    Writeback,
+    /// Retirement.
+    Commit,
+    /// `Bus::tick` (devices and interrupts).
+    Bus,
+    /// Cache-hierarchy walks (L1 through DRAM), nested inside the stage
+    /// that made the access and so left out of [`StageTimes::total_ns`].
+    Hierarchy,
+}
+
+impl Stage {
+    /// Number of timed stages.
+    pub const COUNT: usize = 12;
+
+    /// Every stage, in pipeline order.
+    pub const ALL: [Self; Self::COUNT] = [
+        Self::Fetch1,
+        Self::Fetch2,
+        Self::Decode,
+        Self::Rename,
+        Self::Issue,
+        Self::Execute,
+        Self::Memory1,
+        Self::Memory2,
+        Self::Writeback,
+        Self::Commit,
+        Self::Bus,
+        Self::Hierarchy,
+    ];
+
+    /// Lower-case stage name, as used in stats dicts.
+    pub const fn name(self) -> &'static str {
+        match self {
+            Self::Fetch1 => "fetch1",
+            Self::Fetch2 => "fetch2",
+            Self::Decode => "decode",
+            Self::Rename => "rename",
+            Self::Issue => "issue",
+            Self::Execute => "execute",
+            Self::Memory1 => "memory1",
+            Self::Memory2 => "memory2",
+            Self::Writeback => "writeback",
+            Self::Commit => "commit",
+            Self::Bus => "bus",
+            Self::Hierarchy => "hierarchy",
+        }
+    }
+}
+
+/// Host nanoseconds and invocation counts per [`Stage`].
+///
+/// A stage is counted once per call of its stage function: once per cycle
+/// that it runs, except O3 execute, which is called per issued instruction.
+#[derive(Clone, Copy, Debug, Default, PartialEq, Eq)]
+pub struct StageTimes {
+    /// Host nanoseconds spent per stage, indexed by `Stage as usize`.
+    pub ns: [u64; Stage::COUNT],
+    /// Invocations per stage, indexed by `Stage as usize`.
+    pub calls: [u64; Stage::COUNT],
+}
+
+impl StageTimes {
+    /// Returns `true` if no stage was timed.
+    pub fn is_empty(&self) -> bool {
+        self.calls.iter().all(|&c| c == 0)
+    }
+
+    /// Host nanoseconds summed over every stage, excluding the nested
+    /// [`Stage::Hierarchy`] time.
+    pub fn total_ns(&self) -> u64 {
+        self.ns.iter().sum::<u64>() - self.ns[Stage::Hierarchy as usize]
+    }
+
+    /// Returns the time accumulated since `base`, an earlier snapshot.
+    #[must_use]
+    pub fn since(&self, base: &Self) -> Self {
+        let mut delta = *self;
+        for (t, b) in delta.ns.iter_mut().zip(&base.ns) {
+            *t = t.saturating_sub(*b);
+        }
+        for (c, b) in delta.calls.iter_mut().zip(&base.calls) {
+            *c = c.saturating_sub(*b);
+        }
+        delta
+    }
+}
+
+/// Times one stage invocation into a [`StageTimes`].
+///
+/// Without the `stage-timing` feature this is zero-sized and both methods
+/// compile to nothing, so the probes in the pipeline cost nothing.
+#[derive(Clone, Copy, Debug)]
+#[must_use]
+pub struct StageTimer {
+    #[cfg(feature = "stage-timing")]
+    start: Instant,
+}
+
+impl StageTimer {
+    /// Starts timing.
+    #[inline(always)]
+    #[allow(clippy::missing_const_for_fn)]
+    pub fn start() -> Self {
+        Self {
+            #[cfg(feature = "stage-timing")]
+            start: Instant::now(),
+        }
+    }
+
+    /// Charges the time since [`Self::start`] and one call to `stage`.
+    #[inline(always)]
+    #[allow(clippy::missing_const_for_fn)]
+    pub fn stop(self, times: &mut StageTimes, stage: Stage) {
+        #[cfg(feature = "stage-timing")]
+        {
+            times.ns[stage as usize] += self.start.elapsed().as_nanos() as u64;
+            times.calls[stage as usize] += 1;
+        }
+        #[cfg(not(feature = "stage-timing"))]
+        let _ = (times, stage);
+    }
 }
 
 impl Default for SimStats {
@@ -181,6 +457,7 @@ impl Default for SimStats {
     fn default() -> Self {
         Self {
             start_time: Instant::now(),
+            end_time: None,
             cycles: 0,
             instructions_retired: 0,
             inst_load: 0,
@@ -193,6 +470,9 @@ impl Default for SimStats {
             inst_fp_arith: 0,
             inst_fp_fma: 0,
             inst_fp_div_sqrt: 0,
+            inst_vector: 0,
+            vector_elements: 0,
+            vector_mem_lines: 0,
             committed_branch_predictions: 0,
             committed_branch_mispredictions: 0,
             speculative_branch_predictions: 0,
@@ -205,9 +485,33 @@ impl Default for SimStats {
             stalls_mem: 0,
             stalls_control: 0,
             stalls_data: 0,
+            tma_slots: 0,
+            tma_retiring: 0,
+            tma_bad_speculation: 0,
+            tma_bad_spec_squashed: 0,
+            tma_bad_spec_recovery: 0,
+            tma_frontend_bound: 0,
+            tma_fe_icache: 0,
+            tma_fe_itlb: 0,
+            tma_fe_resteer: 0,
+            tma_fe_bandwidth: 0,
+            tma_backend_bound: 0,
+            tma_be_memory: 0,
+            tma_be_mem_l1: 0,
+            tma_be_mem_l2: 0,
+            tma_be_mem_l3: 0,
+            tma_be_mem_dram: 0,
+            tma_be_core: 0,
+            tma_be_core_fu: 0,
+            tma_be_core_other: 0,
             traps_taken: 0,
             icache_hits: 0,
             icache_misses: 0,
+            ftq_occupancy: 0,
+            stalls_ftq_full: 0,
+            fdip_prefetches: 0,
+            fdip_useful: 0,
+            fdip_late: 0,
             dcache_hits: 0,
             dcache_misses: 0,
             l2_hits: 0,
@@ -223,9 +527,36 @@ impl Default for SimStats {
             mshr_allocations: 0,
             mshr_coalesces: 0,
             stalls_mshr_full: 0,
+            mshr_occupancy: 0,
+            l2_mshr_allocations: 0,
+            l2_mshr_coalesces: 0,
+            stalls_l2_mshr_full: 0,
+            l2_mshr_occupancy: 0,
+            l3_mshr_allocations: 0,
+            l3_mshr_coalesces: 0,
+            stalls_l3_mshr_full: 0,
+            l3_mshr_occupancy: 0,
             load_replays: 0,
             inclusion_back_invalidations: 0,
             exclusive_l1_to_l2_swaps: 0,
+            coherence_misses: 0,
+            coherence_upgrades: 0,
+            coherence_invalidations_sent: 0,
+            coherence_invalidations_received: 0,
+            coherence_transfers: 0,
+            coherence_stall_cycles: 0,
+            coherence_sharers: [0; 4],
+            itlb_hits: 0,
+            itlb_misses: 0,
+            dtlb_hits: 0,
+            dtlb_misses: 0,
+            l2_tlb_hits: 0,
+            l2_tlb_misses: 0,
+            tlb_superpage_hits: 0,
+            page_walks: 0,
+            ptw_pte_reads: 0,
+            pwc_hits: 0,
+            pwc_misses: 0,
             wcb_coalesces: 0,
             wcb_drains: 0,
             prefetch_filter_dedup: 0,
@@ -236,6 +567,7 @@ impl Default for SimStats {
             stalls_checkpoint: 0,
             stalls_rename_rebuild: 0,
             stalls_squash: 0,
+            stalls_vector: 0,
             flushes_branch: 0,
             flushes_system: 0,
             mdp_predictions_bypass: 0,
@@ -243,10 +575,177 @@ impl Default for SimStats {
             mdp_predictions_wait_for: 0,
             mdp_violations: 0,
             retire_histogram: [0; 4],
+            stack_distance: StackDistanceHistogram::default(),
+            stage_times: StageTimes::default(),
         }
     }
 }
 
+/// Declares [`SimStats::COUNTERS`], [`SimStats::counters`], and
+/// [`SimStats::counters_mut`] over the scalar counter fields.
+///
+/// Each accessor destructures the struct, naming the non-scalar fields
+/// explicitly, so a field missing from the list is a compile error rather
+/// than a counter silently left out of `since` and the interval recorder.
+macro_rules! scalar_counters {
+    ($($counter:ident),* $(,)?) => {
+        impl SimStats {
+            /// Names of the scalar counters, in [`Self::counters`] order.
+            pub const COUNTERS: &'static [&'static str] = &[$(stringify!($counter)),*];
+
+            /// Number of scalar counters.
+            pub const COUNTER_COUNT: usize = Self::COUNTERS.len();
+
+            /// Values of the scalar counters, in [`Self::COUNTERS`] order.
+            pub const fn counters(&self) -> [u64; Self::COUNTER_COUNT] {
+                let Self {
+                    start_time: _,
+                    end_time: _,
+                    fu_utilization: _,
+                    coherence_sharers: _,
+                    retire_histogram: _,
+                    stack_distance: _,
+                    stage_times: _,
+                    $($counter,)*
+                } = self;
+                [$(*$counter),*]
+            }
+
+            /// The scalar counters, mutably, in [`Self::COUNTERS`] order.
+            pub const fn counters_mut(&mut self) -> [&mut u64; Self::COUNTER_COUNT] {
+                let Self {
+                    start_time: _,
+                    end_time: _,
+                    fu_utilization: _,
+                    coherence_sharers: _,
+                    retire_histogram: _,
+                    stack_distance: _,
+                    stage_times: _,
+                    $($counter,)*
+                } = self;
+                [$($counter),*]
+            }
+        }
+    };
+}
+
+scalar_counters!(
+    cycles,
+    instructions_retired,
+    inst_load,
+    inst_store,
+    inst_branch,
+    inst_alu,
+    inst_system,
+    inst_fp_load,
+    inst_fp_store,
+    inst_fp_arith,
+    inst_fp_fma,
+    inst_fp_div_sqrt,
+    inst_vector,
+    vector_elements,
+    vector_mem_lines,
+    committed_branch_predictions,
+    committed_branch_mispredictions,
+    speculative_branch_predictions,
+    speculative_branch_mispredictions,
+    cycles_user,
+    cycles_kernel,
+    cycles_machine,
+    cycles_wfi,
+    cycles_rob_empty,
+    stalls_mem,
+    stalls_control,
+    stalls_data,
+    tma_slots,
+    tma_retiring,
+    tma_bad_speculation,
+    tma_bad_spec_squashed,
+    tma_bad_spec_recovery,
+    tma_frontend_bound,
+    tma_fe_icache,
+    tma_fe_itlb,
+    tma_fe_resteer,
+    tma_fe_bandwidth,
+    tma_backend_bound,
+    tma_be_memory,
+    tma_be_mem_l1,
+    tma_be_mem_l2,
+    tma_be_mem_l3,
+    tma_be_mem_dram,
+    tma_be_core,
+    tma_be_core_fu,
+    tma_be_core_other,
+    traps_taken,
+    icache_hits,
+    icache_misses,
+    ftq_occupancy,
+    stalls_ftq_full,
+    fdip_prefetches,
+    fdip_useful,
+    fdip_late,
+    dcache_hits,
+    dcache_misses,
+    l2_hits,
+    l2_misses,
+    l3_hits,
+    l3_misses,
+    stalls_fu_structural,
+    misprediction_penalty,
+    stalls_backpressure,
+    mem_ordering_violations,
+    pipeline_flushes,
+    mshr_allocations,
+    mshr_coalesces,
+    stalls_mshr_full,
+    mshr_occupancy,
+    l2_mshr_allocations,
+    l2_mshr_coalesces,
+    stalls_l2_mshr_full,
+    l2_mshr_occupancy,
+    l3_mshr_allocations,
+    l3_mshr_coalesces,
+    stalls_l3_mshr_full,
+    l3_mshr_occupancy,
+    load_replays,
+    inclusion_back_invalidations,
+    exclusive_l1_to_l2_swaps,
+    coherence_misses,
+    coherence_upgrades,
+    coherence_invalidations_sent,
+    coherence_invalidations_received,
+    coherence_transfers,
+    coherence_stall_cycles,
+    itlb_hits,
+    itlb_misses,
+    dtlb_hits,
+    dtlb_misses,
+    l2_tlb_hits,
+    l2_tlb_misses,
+    tlb_superpage_hits,
+    page_walks,
+    ptw_pte_reads,
+    pwc_hits,
+    pwc_misses,
+    wcb_coalesces,
+    wcb_drains,
+    prefetch_filter_dedup,
+    pf_dedup_l1,
+    pf_dedup_l2,
+    pf_dedup_l3,
+    stalls_dispatch,
+    stalls_checkpoint,
+    stalls_rename_rebuild,
+    stalls_squash,
+    stalls_vector,
+    flushes_branch,
+    flushes_system,
+    mdp_predictions_bypass,
+    mdp_predictions_wait_all,
+    mdp_predictions_wait_for,
+    mdp_violations,
+);
+
 /// Section names for selective stats output.
 ///
 /// Valid section identifiers: `"summary"`, `"core"`, `"instruction_mix"`, `"branch"`, `"memory"`.
@@ -254,6 +753,48 @@ impl Default for SimStats {
 pub const STATS_SECTIONS: &[&str] = &["summary", "core", "instruction_mix", "branch", "memory"];
 
 impl SimStats {
+    /// Returns a copy of these statistics to serve as the `base` of
+    /// [`Self::since`], with its host clock restarted now.
+    #[must_use]
+    pub fn snapshot(&self) -> Self {
+        Self { start_time: Instant::now(), end_time: None, ..self.clone() }
+    }
+
+    /// Returns the counters accumulated since `base`, an earlier
+    /// [`snapshot`](Self::snapshot) of these statistics (e.g. taken when a
+    /// region of interest began).
+    ///
+    /// The host time runs from `base` to now and is frozen there, so MIPS
+    /// covers the same span as the counters.
+    #[must_use]
+    pub fn since(&self, base: &Self) -> Self {
+        let mut delta = self.clone();
+        delta.start_time = base.start_time;
+        delta.end_time = Some(Instant::now());
+        let counters = base.counters();
+        for (counter, base) in delta.counters_mut().into_iter().zip(counters) {
+            *counter = counter.saturating_sub(base);
+        }
+        for (counter, base) in delta.fu_utilization.iter_mut().zip(&base.fu_utilization) {
+            *counter = counter.saturating_sub(*base);
+        }
+        for (counter, base) in delta.coherence_sharers.iter_mut().zip(&base.coherence_sharers) {
+            *counter = counter.saturating_sub(*base);
+        }
+        for (counter, base) in delta.retire_histogram.iter_mut().zip(&base.retire_histogram) {
+            *counter = counter.saturating_sub(*base);
+        }
+        delta.stack_distance = delta.stack_distance.since(&base.stack_distance);
+        delta.stage_times = delta.stage_times.since(&base.stage_times);
+        delta
+    }
+
+    /// Host time these statistics cover: since the run (or snapshot) began,
+    /// up to now or to when [`Self::since`] froze them.
+    pub fn elapsed(&self) -> Duration {
+        self.end_time.unwrap_or_else(Instant::now).saturating_duration_since(self.start_time)
+    }
+
     /// Prints only the requested statistics sections to stdout.
     ///
     /// Each element of `sections` should be one of `"summary"`, `"core"`, `"instruction_mix"`,
@@ -277,8 +818,7 @@ impl SimStats {
         let rst = if color { "\x1b[0m" } else { "" };
 
         let want = |s: &str| sections.is_empty() || sections.iter().any(|x| x == s);
-        let duration = self.start_time.elapsed();
-        let seconds = duration.as_secs_f64();
+        let seconds = self.elapsed().as_secs_f64();
         let cyc = if self.cycles == 0 { 1 } else { self.cycles };
         let instr = if self.instructions_retired == 0 { 1 } else { self.instructions_retired };
 
@@ -307,6 +847,9 @@ impl SimStats {
             }
             println!("sim_cpi                  {cpi:.4}");
             println!("sim_mips                 {mips:.2}");
+            if !self.stage_times.is_empty() {
+                self.print_stage_times(cyc);
+            }
             println!("{sep}");
         }
         if want("core") {
@@ -369,6 +912,42 @@ impl SimStats {
             }
             println!("{sep}");
 
+            if self.tma_slots > 0 {
+                let slots = self.tma_slots as f64;
+                let pct = |v: u64| (v as f64 / slots) * 100.0;
+                println!("{bold}TOP-DOWN (issue slots){rst}");
+                println!("  tma.retiring           {:.2}%", pct(self.tma_retiring));
+                println!(
+                    "  tma.bad_speculation    {:.2}% | squashed: {:.2}% | recovery: {:.2}%",
+                    pct(self.tma_bad_speculation),
+                    pct(self.tma_bad_spec_squashed),
+                    pct(self.tma_bad_spec_recovery)
+                );
+                println!(
+                    "  tma.frontend_bound     {:.2}% | icache: {:.2}% | itlb: {:.2}% | resteer: {:.2}% | bandwidth: {:.2}%",
+                    pct(self.tma_frontend_bound),
+                    pct(self.tma_fe_icache),
+                    pct(self.tma_fe_itlb),
+                    pct(self.tma_fe_resteer),
+                    pct(self.tma_fe_bandwidth)
+                );
+                println!(
+                    "  tma.backend_memory     {:.2}% | l1: {:.2}% | l2: {:.2}% | l3: {:.2}% | dram: {:.2}%",
+                    pct(self.tma_be_memory),
+                    pct(self.tma_be_mem_l1),
+                    pct(self.tma_be_mem_l2),
+                    pct(self.tma_be_mem_l3),
+                    pct(self.tma_be_mem_dram)
+                );
+                println!(
+                    "  tma.backend_core       {:.2}% | fu_contention: {:.2}% | other: {:.2}%",
+                    pct(self.tma_be_core),
+                    pct(self.tma_be_core_fu),
+                    pct(self.tma_be_core_other)
+                );
+                println!("{sep}");
+            }
+
             println!("{bold}PRIVILEGE BREAKDOWN{rst}");
             println!(
                 "  cycles.user            {} ({:.2}%)",
@@ -445,6 +1024,13 @@ impl SimStats {
                     (self.stalls_rename_rebuild as f64 / cyc as f64) * 100.0
                 );
             }
+            if self.stalls_vector > 0 {
+                println!(
+                    "  stalls.vector          {} ({:.2}%)",
+                    self.stalls_vector,
+                    (self.stalls_vector as f64 / cyc as f64) * 100.0
+                );
+            }
             println!("{sep}");
         }
         if want("instruction_mix") {
@@ -502,6 +1088,17 @@ impl SimStats {
                     println!("    fp.div_sqrt          {}", self.inst_fp_div_sqrt);
                 }
             }
+            if self.inst_vector > 0 {
+                println!(
+                    "  op.vector              {} ({:.2}%)",
+                    self.inst_vector,
+                    (self.inst_vector as f64 / total_inst) * 100.0
+                );
+                println!("    vector.elements      {}", self.vector_elements);
+                if self.vector_mem_lines > 0 {
+                    println!("    vector.mem_lines     {}", self.vector_mem_lines);
+                }
+            }
             println!("{sep}");
         }
         if want("branch") {
@@ -566,14 +1163,67 @@ impl SimStats {
             };
             println!("{bold}MEMORY HIERARCHY{rst}");
             print_cache("L1-I", self.icache_hits, self.icache_misses);
+            if self.ftq_occupancy > 0 {
+                println!(
+                    "  ftq.avg_occupancy      {:.2} | full_stalls: {}",
+                    self.ftq_occupancy as f64 / cyc as f64,
+                    self.stalls_ftq_full
+                );
+            }
+            if self.fdip_prefetches > 0 {
+                // Coverage: share of would-be L1I misses an FDIP line served.
+                let covered = self.fdip_useful + self.fdip_late;
+                let demand = covered + self.icache_misses;
+                println!(
+                    "  fdip.prefetches        {} | useful: {} | late: {} | coverage: {:.2}%",
+                    self.fdip_prefetches,
+                    self.fdip_useful,
+                    self.fdip_late,
+                    if demand > 0 { covered as f64 / demand as f64 * 100.0 } else { 0.0 }
+                );
+            }
             print_cache("L1-D", self.dcache_hits, self.dcache_misses);
             print_cache("L2", self.l2_hits, self.l2_misses);
             print_cache("L3", self.l3_hits, self.l3_misses);
+            if self.itlb_misses > 0 || self.dtlb_misses > 0 {
+                print_cache("iTLB", self.itlb_hits, self.itlb_misses);
+                print_cache("dTLB", self.dtlb_hits, self.dtlb_misses);
+                print_cache("L2-TLB", self.l2_tlb_hits, self.l2_tlb_misses);
+                println!(
+                    "  ptw.walks              {} | pte_reads: {} | superpage_hits: {}",
+                    self.page_walks, self.ptw_pte_reads, self.tlb_superpage_hits
+                );
+                println!(
+                    "  pwc.hits               {} | misses: {}",
+                    self.pwc_hits, self.pwc_misses
+                );
+            }
             if self.mshr_allocations > 0 || self.mshr_coalesces > 0 {
                 println!(
-                    "  mshr.allocs            {} | coalesces: {} | full_stalls: {}",
-                    self.mshr_allocations, self.mshr_coalesces, self.stalls_mshr_full
+                    "  mshr.allocs            {} | coalesces: {} | full_stalls: {} | avg_occupancy: {:.2}",
+                    self.mshr_allocations,
+                    self.mshr_coalesces,
+                    self.stalls_mshr_full,
+                    self.mshr_occupancy as f64 / cyc as f64
                 );
+                if self.l2_mshr_allocations > 0 || self.l2_mshr_coalesces > 0 {
+                    println!(
+                        "  mshr.l2.allocs         {} | coalesces: {} | full_cycles: {} | avg_occupancy: {:.2}",
+                        self.l2_mshr_allocations,
+                        self.l2_mshr_coalesces,
+                        self.stalls_l2_mshr_full,
+                        self.l2_mshr_occupancy as f64 / cyc as f64
+                    );
+                }
+                if self.l3_mshr_allocations > 0 || self.l3_mshr_coalesces > 0 {
+                    println!(
+                        "  mshr.l3.allocs         {} | coalesces: {} | full_cycles: {} | avg_occupancy: {:.2}",
+                        self.l3_mshr_allocations,
+                        self.l3_mshr_coalesces,
+                        self.stalls_l3_mshr_full,
+                        self.l3_mshr_occupancy as f64 / cyc as f64
+                    );
+                }
                 println!("  load.replays           {}", self.load_replays);
             }
             if self.inclusion_back_invalidations > 0 {
@@ -582,6 +1232,20 @@ impl SimStats {
             if self.exclusive_l1_to_l2_swaps > 0 {
                 println!("  excl.l1_to_l2_swaps    {}", self.exclusive_l1_to_l2_swaps);
             }
+            if self.coherence_sharers.iter().any(|&n| n > 0) {
+                println!(
+                    "  coh.misses             {} | upgrades: {} | transfers: {}",
+                    self.coherence_misses, self.coherence_upgrades, self.coherence_transfers
+                );
+                println!(
+                    "  coh.invalidations      sent: {} | received: {} | stall_cycles: {}",
+                    self.coherence_invalidations_sent,
+                    self.coherence_invalidations_received,
+                    self.coherence_stall_cycles
+                );
+                let [s0, s1, s2, s3] = self.coherence_sharers;
+                println!("  coh.sharers            0: {s0}  1: {s1}  2: {s2}  3+: {s3}");
+            }
             if self.wcb_coalesces > 0 || self.wcb_drains > 0 {
                 println!(
                     "  wcb.coalesces          {} | drains: {}",
@@ -600,10 +1264,65 @@ impl SimStats {
                     );
                 }
             }
+            if !self.stack_distance.is_empty() {
+                println!("{sep}");
+                self.print_miss_ratio_curve(bold, rst);
+            }
         }
         println!("{rule}");
     }
 
+    /// Prints the host time of each stage per simulated cycle and per call.
+    fn print_stage_times(&self, cyc: u64) {
+        let times = &self.stage_times;
+        let total = times.total_ns().max(1);
+        println!("host.stage          ns/cycle    ns/call   share");
+        for stage in Stage::ALL {
+            let (ns, calls) = (times.ns[stage as usize], times.calls[stage as usize]);
+            println!(
+                "  {:<14} {:>10.1} {:>10.1} {:>6.1}%",
+                stage.name(),
+                ns as f64 / cyc as f64,
+                ns as f64 / calls.max(1) as f64,
+                100.0 * ns as f64 / total as f64
+            );
+        }
+    }
+
+    /// Prints the LRU miss ratio of each profiled capacity with power-of-two
+    /// associativities as columns.
+    fn print_miss_ratio_curve(&self, bold: &str, rst: &str) {
+        let sd = &self.stack_distance;
+        let ways: Vec<usize> =
+            (0..usize::BITS).map(|b| 1 << b).take_while(|&w| w <= sd.ways).collect();
+        println!("{bold}MISS RATIO CURVE (LRU, {}-byte lines){rst}", sd.line_bytes);
+        print!("  {:<10}", "capacity");
+        for w in &ways {
+            print!(" {:>8}", format!("{w}-way"));
+        }
+        println!();
+        let max_capacity = sd.sets.last().map_or(0, |&s| s * sd.ways as u64);
+        let mut lines = 1;
+        while lines <= max_capacity {
+            let bytes = lines * sd.line_bytes;
+            let label = match bytes {
+                b if b >= 1 << 20 => format!("{}M", b >> 20),
+                b if b >= 1 << 10 => format!("{}K", b >> 10),
+                b => format!("{b}B"),
+            };
+            print!("  {label:<10}");
+            for &w in &ways {
+                let sets = lines / w as u64;
+                match sd.miss_ratio(sets, w) {
+                    Some(ratio) => print!(" {:>7.2}%", ratio * 100.0),
+                    None => print!(" {:>8}", "-"),
+                }
+            }
+            println!();
+            lines *= 2;
+        }
+    }
+
     /// Prints all statistics sections to stdout.
     ///
     /// Equivalent to `print_sections(&[])`.
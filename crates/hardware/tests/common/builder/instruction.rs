@@ -1,3 +1,8 @@
+use rvsim_core::common::CsrAddr;
+use rvsim_core::isa::privileged::opcodes::{CSRRS, CSRRSI, CSRRW, CSRRWI, OP_SYSTEM};
+use rvsim_core::isa::rv64a::funct3::WIDTH_64;
+use rvsim_core::isa::rv64a::funct5::{AMOADD, LR, SC};
+use rvsim_core::isa::rv64a::opcodes::OP_AMO;
 use rvsim_core::isa::rv64i::opcodes::*;
 
 pub struct InstructionBuilder {
@@ -374,6 +379,65 @@ impl InstructionBuilder {
         self.addi(0, 0, 0)
     }
 
+    /// JAL x0, 0: spins on itself, parking the core at the end of a program.
+    pub fn spin(self) -> Self {
+        self.jal(0, 0)
+    }
+
+    // --- A Extension (no ordering bits) ---
+
+    pub fn amoadd_d(self, rd: u32, rs1: u32, rs2: u32) -> Self {
+        self.amo_d(AMOADD, rd, rs1, rs2)
+    }
+
+    pub fn lr_d(self, rd: u32, rs1: u32) -> Self {
+        self.amo_d(LR, rd, rs1, 0)
+    }
+
+    pub fn sc_d(self, rd: u32, rs1: u32, rs2: u32) -> Self {
+        self.amo_d(SC, rd, rs1, rs2)
+    }
+
+    /// Doubleword AMO: `funct5` sits above the `aq`/`rl` bits in `funct7`.
+    fn amo_d(mut self, funct5: u32, rd: u32, rs1: u32, rs2: u32) -> Self {
+        self.opcode = OP_AMO;
+        self.rd = rd;
+        self.rs1 = rs1;
+        self.rs2 = rs2;
+        self.funct3 = WIDTH_64;
+        self.funct7 = funct5 << 2;
+        self
+    }
+
+    // --- Zicsr ---
+
+    pub fn csrrw(self, rd: u32, csr: CsrAddr, rs1: u32) -> Self {
+        self.csr_op(CSRRW, rd, csr, rs1)
+    }
+
+    pub fn csrrs(self, rd: u32, csr: CsrAddr, rs1: u32) -> Self {
+        self.csr_op(CSRRS, rd, csr, rs1)
+    }
+
+    pub fn csrrwi(self, rd: u32, csr: CsrAddr, uimm: u32) -> Self {
+        self.csr_op(CSRRWI, rd, csr, uimm)
+    }
+
+    pub fn csrrsi(self, rd: u32, csr: CsrAddr, uimm: u32) -> Self {
+        self.csr_op(CSRRSI, rd, csr, uimm)
+    }
+
+    /// CSR access: the CSR address is the I-type immediate, and `rs1` holds
+    /// the register or the 5-bit immediate operand.
+    fn csr_op(mut self, funct3: u32, rd: u32, csr: CsrAddr, rs1: u32) -> Self {
+        self.opcode = OP_SYSTEM;
+        self.rd = rd;
+        self.rs1 = rs1;
+        self.funct3 = funct3;
+        self.imm = csr.as_u32() as i32;
+        self
+    }
+
     pub fn build(self) -> u32 {
         let opcode = self.opcode & 0x7F;
         let rd = (self.rd & 0x1F) << 7;
@@ -383,11 +447,11 @@ impl InstructionBuilder {
         let funct7 = (self.funct7 & 0x7F) << 25;
 
         match opcode {
-            OP_REG | OP_REG_32 => {
+            OP_REG | OP_REG_32 | OP_AMO => {
                 // R-type: funct7 | rs2 | rs1 | funct3 | rd | opcode
                 funct7 | rs2 | rs1 | funct3 | rd | opcode
             }
-            OP_IMM | OP_IMM_32 | OP_LOAD | OP_JALR => {
+            OP_IMM | OP_IMM_32 | OP_LOAD | OP_JALR | OP_SYSTEM => {
                 // I-type: imm[11:0] | rs1 | funct3 | rd | opcode
                 let imm_val = (self.imm as u32) & 0xFFF;
                 (imm_val << 20) | rs1 | funct3 | rd | opcode
@@ -3,11 +3,55 @@ use rvsim_core::Simulator;
 use rvsim_core::common::{PhysAddr, RegIdx};
 use rvsim_core::config::Config;
 use rvsim_core::core::Cpu;
+use rvsim_core::core::pipeline::engine::BackendType;
 use rvsim_core::soc::System;
 use rvsim_core::soc::interconnect::Bus;
+use rvsim_core::stats::SimStats;
 use std::sync::Arc;
 use std::sync::atomic::AtomicU64;
 
+/// Start of RAM in the default configuration.
+pub const RAM_BASE: u64 = 0x8000_0000;
+/// Size of the mock RAM mapped by [`TestContext::with_program`].
+pub const MEM_SIZE: usize = 0x4000;
+/// Scratch data in that RAM, clear of the test program.
+pub const DATA: u64 = RAM_BASE + 0x2000;
+/// CLINT `mtimecmp` register of hart 0 in the default system.
+pub const MTIMECMP: u64 = 0x0200_4000;
+/// CLINT `mtime` register in the default system.
+pub const MTIME: u64 = 0x0200_BFF8;
+
+/// Default configuration with `backend` selected.
+pub fn backend_config(backend: BackendType) -> Config {
+    let mut config = Config::default();
+    config.pipeline.backend = backend;
+    config
+}
+
+/// Builds a simulator on the full default system (CLINT, UART, DRAM), loads
+/// each `(address, code)` segment, sets `regs`, and starts at the first
+/// segment.
+pub fn system_sim(config: &Config, segments: &[(u64, Vec<u32>)], regs: &[(u8, u64)]) -> Simulator {
+    let mut system = System::new(config, "");
+    for (addr, code) in segments {
+        let bytes: Vec<u8> = code.iter().flat_map(|i| i.to_le_bytes()).collect();
+        system.load_binary_at(&bytes, PhysAddr::new(*addr));
+    }
+    let mut sim = Simulator::new(system, config);
+    sim.cpu.pc = segments.first().map_or(RAM_BASE, |&(addr, _)| addr);
+    for &(reg, val) in regs {
+        sim.cpu.regs.write(RegIdx::new(reg), val);
+    }
+    sim.sync_arch_regs();
+    sim
+}
+
+/// Every `SimStats` counter, rendered for comparison (host times are dropped).
+pub fn counters(stats: &SimStats) -> String {
+    let all = format!("{stats:?}");
+    all[all.find(" cycles:").unwrap()..].to_string()
+}
+
 pub struct TestContext {
     pub sim: Simulator,
 }
@@ -20,18 +64,24 @@ impl Default for TestContext {
 
 impl TestContext {
     pub fn new() -> Self {
+        Self::with_config(&Config::default())
+    }
+
+    /// Build a context from an explicit configuration (e.g. fast-forward settings).
+    pub fn with_config(config: &Config) -> Self {
         let _ = env_logger::builder().is_test(true).try_init();
 
-        let config = Config::default();
         let bus = Bus::new(8, 0);
 
         let system = System {
             bus,
             mem_controller: Box::new(MockMemoryController::new(1)),
             exit_request: Arc::new(AtomicU64::new(u64::MAX)),
+            uncore: None,
+            hart: 0,
         };
 
-        let mut sim = Simulator::new(system, &config);
+        let mut sim = Simulator::new(system, config);
 
         // In tests, bypass the expensive simulate_memory_access path.
         // The default cache_base == ram_base (0x8000_0000), which routes all
@@ -54,6 +104,12 @@ impl TestContext {
         &mut self.sim.cpu
     }
 
+    /// Build a context with `MEM_SIZE` bytes of mock RAM at `RAM_BASE` and
+    /// `program` loaded at its start.
+    pub fn with_program(config: &Config, program: &[u32]) -> Self {
+        Self::with_config(config).with_memory(MEM_SIZE, RAM_BASE).load_program(RAM_BASE, program)
+    }
+
     pub fn with_memory(mut self, size: usize, base: u64) -> Self {
         let mem = MockMemory::new(size, base);
         self.sim.cpu.bus.bus.add_device(Box::new(mem));
@@ -2,9 +2,12 @@
 //!
 //! Tests for address translation, cache simulation, and memory access.
 
-use rvsim_core::common::{AccessType, VirtAddr};
+use rvsim_core::common::{AccessType, PhysAddr, VirtAddr};
 use rvsim_core::config::Config;
 use rvsim_core::core::Cpu;
+use rvsim_core::core::cpu::memory::L1dAccess;
+use rvsim_core::core::pipeline::rob::RobTag;
+use rvsim_core::core::units::cache::mshr::MshrWaiter;
 
 fn create_test_cpu() -> Cpu {
     let config = Config::default();
@@ -444,3 +447,64 @@ fn test_cache_disabled_no_stats_update() {
     assert_eq!(cpu.stats.icache_hits, initial_icache_hits);
     assert_eq!(cpu.stats.dcache_hits, initial_dcache_hits);
 }
+
+/// A CPU with an 8-MSHR L1D in front of an L2 with `l2_mshrs` MSHRs.
+fn mshr_cpu(l2_mshrs: usize) -> Cpu {
+    let mut config = Config::default();
+    config.cache.l1_d.enabled = true;
+    config.cache.l1_d.mshr_count = 8;
+    config.cache.l2.enabled = true;
+    config.cache.l2.size_bytes = 64 * 1024;
+    config.cache.l2.latency = 10;
+    config.cache.l2.mshr_count = l2_mshrs;
+    let system = rvsim_core::soc::System::new(&config, "");
+    Cpu::new(system, &config)
+}
+
+/// Issues an L1D read of `addr` at machine cycle `now`, returning its latency.
+fn l1d_read(cpu: &mut Cpu, addr: u64, now: u64) -> u64 {
+    cpu.stats.cycles = now;
+    let waiter = || MshrWaiter { rob_tag: RobTag(0), parked_entry: None };
+    match cpu.access_l1d_nonblocking(PhysAddr::new(addr), AccessType::Read, 0, 8, now, waiter) {
+        L1dAccess::Hit { latency } | L1dAccess::Miss { latency, .. } => latency,
+    }
+}
+
+#[test]
+fn test_l2_mshrs_limit_memory_level_parallelism() {
+    let lines: Vec<u64> = (0..4).map(|i| 0x8001_0000 + i * 0x1000).collect();
+    let mut free = mshr_cpu(0);
+    let unbounded: Vec<u64> = lines.iter().map(|&a| l1d_read(&mut free, a, 0)).collect();
+    let mut cpu = mshr_cpu(2);
+    let bounded: Vec<u64> = lines.iter().map(|&a| l1d_read(&mut cpu, a, 0)).collect();
+
+    assert_eq!(bounded[..2], unbounded[..2], "two misses fit in the L2 MSHRs");
+    assert!(bounded[2] > unbounded[2] && bounded[3] > unbounded[3], "{bounded:?}");
+    let waited: u64 = bounded.iter().zip(&unbounded).map(|(b, u)| b - u).sum();
+    assert_eq!(cpu.stats.stalls_l2_mshr_full, waited);
+    assert_eq!(cpu.stats.l2_mshr_allocations, 4);
+    assert_eq!(free.stats.l2_mshr_allocations, 0, "no L2 MSHRs configured");
+    assert!(cpu.l2_mshrs.active_count() <= 2);
+}
+
+#[test]
+fn test_l2_mshr_merges_a_refetch_after_flush() {
+    let mut cpu = mshr_cpu(4);
+    let first = l1d_read(&mut cpu, 0x8001_0000, 0);
+    cpu.flush_mshrs();
+
+    // The L1D miss is gone but the L2 fill is still in flight.
+    let again = l1d_read(&mut cpu, 0x8001_0000, 5);
+    assert_eq!(again, first - 5);
+    assert_eq!(cpu.stats.l2_mshr_coalesces, 1);
+    assert_eq!(cpu.stats.l2_mshr_allocations, 1);
+}
+
+#[test]
+fn test_l1d_coalesced_miss_does_not_reach_l2_mshrs() {
+    let mut cpu = mshr_cpu(4);
+    let _ = l1d_read(&mut cpu, 0x8001_0000, 0);
+    let _ = l1d_read(&mut cpu, 0x8001_0008, 1);
+    assert_eq!(cpu.stats.mshr_coalesces, 1);
+    assert_eq!((cpu.stats.l2_mshr_allocations, cpu.stats.l2_mshr_coalesces), (1, 0));
+}
@@ -0,0 +1,107 @@
+//! Decoupled Frontend Tests — Fetch Target Queue and FDIP.
+//!
+//! Runs instruction streams much larger than one I-cache line with a cold
+//! L1I, comparing the coupled frontend against a decoupled one whose
+//! branch predictor runs ahead and prefetches the lines it predicts.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{TestContext, backend_config};
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::engine::BackendType;
+
+/// Straight-line instructions fetched before the final spin.
+const STRAIGHT_LINE: usize = 512;
+
+/// `STRAIGHT_LINE` increments of x10 followed by a spin.
+fn straight_line_program() -> Vec<u32> {
+    let mut prog = vec![InstructionBuilder::new().addi(10, 10, 1).build(); STRAIGHT_LINE];
+    prog.push(InstructionBuilder::new().spin().build());
+    prog
+}
+
+fn config(backend: BackendType, ftq_depth: usize, fdip: bool) -> Config {
+    let mut config = backend_config(backend);
+    config.pipeline.ftq.depth = ftq_depth;
+    config.pipeline.ftq.fdip = fdip;
+    config.cache.l1_i.enabled = true;
+    config
+}
+
+/// Runs `program` until x10 reaches `target`; returns the context and cycles taken.
+fn run_until(config: &Config, program: &[u32], target: u64) -> (TestContext, u64) {
+    let mut tc = TestContext::with_program(config, program);
+    for cycle in 1..=100_000 {
+        tc.run(1);
+        if tc.get_reg(10) == target {
+            return (tc, cycle);
+        }
+    }
+    panic!("x10 = {} after 100000 cycles, expected {target}", tc.get_reg(10));
+}
+
+#[test]
+fn coupled_frontend_leaves_ftq_idle() {
+    let (tc, _) = run_until(
+        &config(BackendType::InOrder, 0, true),
+        &straight_line_program(),
+        STRAIGHT_LINE as u64,
+    );
+    let stats = &tc.cpu().stats;
+    assert_eq!(stats.ftq_occupancy, 0);
+    assert_eq!(stats.fdip_prefetches, 0);
+    assert!(stats.icache_misses > 0);
+}
+
+#[test]
+fn fdip_hides_icache_misses() {
+    for backend in [BackendType::InOrder, BackendType::OutOfOrder] {
+        let program = straight_line_program();
+        let target = STRAIGHT_LINE as u64;
+        let (coupled, coupled_cycles) = run_until(&config(backend, 0, true), &program, target);
+        let (ftq, ftq_cycles) = run_until(&config(backend, 16, true), &program, target);
+
+        assert!(
+            ftq_cycles < coupled_cycles,
+            "{backend:?}: FDIP took {ftq_cycles} cycles, coupled {coupled_cycles}"
+        );
+        let stats = &ftq.cpu().stats;
+        assert!(stats.fdip_prefetches > 0);
+        assert!(stats.fdip_useful + stats.fdip_late > 0, "prefetched lines were demanded");
+        assert!(stats.icache_misses < coupled.cpu().stats.icache_misses);
+        assert!(stats.ftq_occupancy > 0);
+    }
+}
+
+#[test]
+fn ftq_without_fdip_only_decouples_prediction() {
+    let (tc, _) = run_until(
+        &config(BackendType::InOrder, 8, false),
+        &straight_line_program(),
+        STRAIGHT_LINE as u64,
+    );
+    let stats = &tc.cpu().stats;
+    assert_eq!(stats.fdip_prefetches, 0);
+    assert!(stats.ftq_occupancy > 0);
+    assert!(stats.stalls_ftq_full > 0, "the predictor fills the queue during misses");
+}
+
+#[test]
+fn mispredicted_branches_flush_the_ftq() {
+    // A counted loop: x10 += 1 until it equals x11, then fall through to a
+    // marker write. The loop exit mispredicts and must squash queued blocks.
+    let nop = InstructionBuilder::new().nop().build();
+    let program = [
+        InstructionBuilder::new().addi(11, 0, 50).build(), //  0: x11 = 50
+        InstructionBuilder::new().addi(10, 10, 1).build(), //  4: x10 += 1
+        nop,                                               //  8
+        InstructionBuilder::new().bne(10, 11, -8).build(), // 12: loop to 4
+        InstructionBuilder::new().addi(12, 0, 7).build(),  // 16: x12 = 7
+        InstructionBuilder::new().spin().build(),          // 20
+    ];
+    for backend in [BackendType::InOrder, BackendType::OutOfOrder] {
+        let (mut tc, _) = run_until(&config(backend, 8, true), &program, 50);
+        tc.run(100);
+        assert_eq!(tc.get_reg(10), 50, "{backend:?}: no wrong-path increments commit");
+        assert_eq!(tc.get_reg(12), 7, "{backend:?}: loop exit reaches the marker");
+    }
+}
@@ -0,0 +1,98 @@
+//! Pipeline History Tests.
+//!
+//! The history ring keeps the last N cycles at a fixed capacity, and each
+//! record matches the pipeline snapshot of the same cycle.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{DATA, TestContext, backend_config};
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::core::pipeline::history::{Latch, PipelineHistory};
+
+/// Sums 64 doublewords in a loop, then spins.
+fn program() -> Vec<u32> {
+    vec![
+        InstructionBuilder::new().addi(1, 0, 64).build(),
+        InstructionBuilder::new().ld(6, 5, 0).build(),
+        InstructionBuilder::new().add(10, 10, 6).build(),
+        InstructionBuilder::new().addi(5, 5, 8).build(),
+        InstructionBuilder::new().addi(1, 1, -1).build(),
+        InstructionBuilder::new().bne(1, 0, -16).build(),
+        InstructionBuilder::new().spin().build(),
+    ]
+}
+
+fn context(backend: BackendType, width: usize) -> TestContext {
+    let mut config = backend_config(backend);
+    config.pipeline.width = width;
+    let mut tc = TestContext::with_program(&config, &program());
+    tc.set_reg(5, DATA);
+    tc.sim.sync_arch_regs();
+    tc
+}
+
+#[test]
+fn ring_keeps_the_last_cycles_and_truncates_to_width() {
+    let mut history = PipelineHistory::new(4, 2);
+    for cycle in 1..=10 {
+        let mut frame = history.push(cycle);
+        for i in 0..3 {
+            frame.push(Latch::Mem2Wb, cycle * 16 + i, 0x13, 1);
+        }
+        frame.push_issue(cycle, 0x13, 2, true);
+    }
+
+    assert_eq!((history.len(), history.capacity()), (4, 4));
+    let cycles: Vec<u64> = history.iter().map(|r| r.frame.cycle).collect();
+    assert_eq!(cycles, [7, 8, 9, 10]);
+    let oldest = history.get(0).unwrap();
+    let pcs: Vec<u64> = oldest.latch(Latch::Mem2Wb).iter().map(|s| s.pc).collect();
+    assert_eq!(pcs, [7 * 16, 7 * 16 + 1]);
+    assert!(oldest.latch(Latch::Fetch1Fetch2).is_empty());
+    assert!(oldest.issue_waiting(0) && !oldest.issue_waiting(1));
+    assert!(history.get(4).is_none());
+    assert_eq!(history.find(9).map(|r| r.frame.cycle), Some(9));
+    assert!(history.find(6).is_none(), "overwritten");
+
+    history.clear();
+    assert!(history.is_empty());
+}
+
+#[test]
+fn records_match_the_snapshot_of_each_cycle() {
+    for backend in [BackendType::InOrder, BackendType::OutOfOrder] {
+        let width = 2;
+        let mut tc = context(backend, width);
+        tc.sim.record_history(16);
+        for _ in 0..200 {
+            tc.run(1);
+            let snap = tc.sim.pipeline.snapshot(width);
+            let history = tc.sim.history.as_ref().unwrap();
+            let record = history.get(history.len() - 1).unwrap();
+            assert_eq!(record.frame.cycle, tc.cpu().stats.cycles);
+
+            let snapshot_pcs = [
+                (Latch::Fetch1Fetch2, snap.fetch1_fetch2.iter().map(|e| e.pc).collect()),
+                (Latch::Fetch2Decode, snap.fetch2_decode.iter().map(|e| e.pc).collect()),
+                (Latch::DecodeRename, snap.decode_rename.iter().map(|e| e.pc).collect()),
+                (Latch::RenameIssue, snap.rename_issue.iter().map(|e| e.pc).collect()),
+                (Latch::IssueQueue, snap.issue_queue.iter().map(|e| e.pc).collect()),
+                (Latch::ExecuteMem1, snap.execute_mem1.iter().map(|e| e.pc).collect()),
+                (Latch::Mem1Mem2, snap.mem1_mem2.iter().map(|e| e.pc).collect()),
+                (Latch::Mem2Wb, snap.mem2_wb.iter().map(|e| e.pc).collect::<Vec<u64>>()),
+            ];
+            for (latch, mut expected) in snapshot_pcs {
+                expected.truncate(width);
+                let pcs: Vec<u64> = record.latch(latch).iter().map(|s| s.pc).collect();
+                assert_eq!(pcs, expected, "{backend:?} {}", latch.name());
+            }
+            assert_eq!(record.frame.issue_queue_len as usize, snap.issue_queue.len());
+            assert_eq!(
+                (record.frame.fetch1_stall, record.frame.fetch2_stall, record.frame.mem1_stall),
+                (snap.fetch1_stall, snap.fetch2_stall, snap.mem1_stall)
+            );
+        }
+        let history = tc.sim.history.as_ref().unwrap();
+        assert_eq!(history.len(), 16, "{backend:?}");
+        assert!(tc.cpu().stats.instructions_retired > 50, "{backend:?} did not run the loop");
+    }
+}
@@ -1 +1,5 @@
+pub mod ftq;
 pub mod hazards;
+pub mod history;
+pub mod tma;
+pub mod widths;
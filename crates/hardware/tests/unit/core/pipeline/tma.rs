@@ -0,0 +1,126 @@
+//! Top-Down Slot Accounting Tests.
+//!
+//! Runs small kernels on both backends and checks that every rename slot
+//! lands in exactly one top-down category, and that each kernel's
+//! bottleneck shows up in the category it should.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{DATA, RAM_BASE, TestContext, backend_config};
+use rvsim_core::common::PhysAddr;
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::stats::SimStats;
+
+const BACKENDS: [BackendType; 2] = [BackendType::InOrder, BackendType::OutOfOrder];
+
+fn run(config: &Config, program: &[u32], cycles: u64) -> TestContext {
+    let mut tc = TestContext::with_program(config, program);
+    tc.set_reg(5, DATA);
+    tc.sim.sync_arch_regs();
+    tc.run(cycles);
+    tc
+}
+
+/// Issued + recovery + frontend + backend covers every slot, and each
+/// level-two breakdown sums to its parent.
+fn assert_slots_partition(stats: &SimStats) {
+    let issued = stats.tma_retiring + stats.tma_bad_spec_squashed;
+    let width = stats.tma_slots;
+    assert!(width > 0);
+    assert!(
+        issued + stats.tma_bad_spec_recovery + stats.tma_frontend_bound + stats.tma_backend_bound
+            <= width,
+        "categories exceed the slot count"
+    );
+    assert_eq!(
+        stats.tma_bad_speculation,
+        stats.tma_bad_spec_squashed + stats.tma_bad_spec_recovery
+    );
+    assert_eq!(
+        stats.tma_frontend_bound,
+        stats.tma_fe_icache + stats.tma_fe_itlb + stats.tma_fe_resteer + stats.tma_fe_bandwidth
+    );
+    assert_eq!(stats.tma_backend_bound, stats.tma_be_memory + stats.tma_be_core);
+    assert_eq!(
+        stats.tma_be_memory,
+        stats.tma_be_mem_l1 + stats.tma_be_mem_l2 + stats.tma_be_mem_l3 + stats.tma_be_mem_dram
+    );
+    assert_eq!(stats.tma_be_core, stats.tma_be_core_fu + stats.tma_be_core_other);
+    assert_eq!(stats.tma_retiring, stats.instructions_retired);
+}
+
+/// Counts x1 down from 40; the loop exit mispredicts.
+fn loop_program() -> Vec<u32> {
+    vec![
+        InstructionBuilder::new().addi(1, 0, 40).build(),
+        InstructionBuilder::new().addi(11, 11, 1).build(),
+        InstructionBuilder::new().addi(1, 1, -1).build(),
+        InstructionBuilder::new().bne(1, 0, -8).build(),
+        InstructionBuilder::new().spin().build(),
+    ]
+}
+
+#[test]
+fn slots_partition_on_both_backends() {
+    for backend in BACKENDS {
+        let tc = run(&backend_config(backend), &loop_program(), 2000);
+        assert_eq!(tc.get_reg(11), 40, "{backend:?}");
+        assert_slots_partition(&tc.cpu().stats);
+    }
+}
+
+#[test]
+fn mispredicted_branches_count_as_bad_speculation() {
+    for backend in BACKENDS {
+        let tc = run(&backend_config(backend), &loop_program(), 2000);
+        let stats = &tc.cpu().stats;
+        assert!(stats.committed_branch_mispredictions > 0, "{backend:?}");
+        assert!(stats.tma_bad_speculation > 0, "{backend:?}");
+        assert!(stats.tma_fe_resteer > 0, "{backend:?}: refill after each redirect");
+    }
+}
+
+#[test]
+fn cold_icache_is_frontend_bound() {
+    let program: Vec<u32> = (0..256)
+        .map(|_| InstructionBuilder::new().addi(10, 10, 1).build())
+        .chain([InstructionBuilder::new().spin().build()])
+        .collect();
+    for backend in BACKENDS {
+        let mut config = backend_config(backend);
+        config.cache.l1_i.enabled = true;
+        let tc = run(&config, &program, 3000);
+        assert_eq!(tc.get_reg(10), 256, "{backend:?}");
+        let stats = &tc.cpu().stats;
+        assert_slots_partition(stats);
+        assert!(stats.tma_fe_icache > 0, "{backend:?}");
+    }
+}
+
+#[test]
+fn pointer_chase_is_dram_bound() {
+    // Each load's address comes from the previous one, through lines that
+    // miss a cold L1D with no L2/L3 behind it.
+    const HOPS: u64 = 16;
+    let mut program = vec![InstructionBuilder::new().ld(5, 5, 0).build(); HOPS as usize];
+    program.push(InstructionBuilder::new().spin().build());
+    for backend in BACKENDS {
+        let mut config = backend_config(backend);
+        config.cache.l1_d.enabled = true;
+        let mut tc = TestContext::with_program(&config, &program);
+        tc.cpu_mut().cache_base = RAM_BASE;
+        for hop in 0..HOPS {
+            let node = DATA + hop * 64;
+            tc.cpu_mut().bus.bus.write_u64(PhysAddr::new(node), node + 64);
+        }
+        tc.set_reg(5, DATA);
+        tc.sim.sync_arch_regs();
+        tc.run(5000);
+
+        assert_eq!(tc.get_reg(5), DATA + HOPS * 64, "{backend:?}");
+        let stats = &tc.cpu().stats;
+        assert_slots_partition(stats);
+        assert!(stats.tma_be_memory > 0, "{backend:?}");
+        assert!(stats.tma_be_mem_dram > 0, "{backend:?}");
+    }
+}
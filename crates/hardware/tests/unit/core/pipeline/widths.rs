@@ -0,0 +1,79 @@
+//! Width-Specialized Pipeline Tests.
+//!
+//! A pipeline instantiated for a fixed width must behave exactly like the
+//! runtime-width fallback configured with the same width, on both backends.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{DATA, TestContext, backend_config};
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::backend::inorder::InOrderEngine;
+use rvsim_core::core::pipeline::backend::o3::O3Engine;
+use rvsim_core::core::pipeline::engine::{
+    BackendType, Pipeline, PipelineDispatch, SPECIALIZED_WIDTHS, SpecializedPipeline,
+};
+
+/// Walks 32 doublewords: loads, dependent adds, stores, and a loop branch
+/// whose exit mispredicts.
+fn program() -> Vec<u32> {
+    vec![
+        InstructionBuilder::new().addi(1, 0, 32).build(),
+        InstructionBuilder::new().ld(6, 5, 0).build(),
+        InstructionBuilder::new().add(10, 10, 6).build(),
+        InstructionBuilder::new().addi(6, 10, 3).build(),
+        InstructionBuilder::new().sd(5, 6, 8).build(),
+        InstructionBuilder::new().addi(5, 5, 8).build(),
+        InstructionBuilder::new().addi(1, 1, -1).build(),
+        InstructionBuilder::new().bne(1, 0, -24).build(),
+        InstructionBuilder::new().spin().build(),
+    ]
+}
+
+/// Runs the program, on the runtime-width pipeline when `fallback` is set,
+/// and returns the cycle count, retired instructions, TMA slots, and `x10`.
+fn run(backend: BackendType, width: usize, fallback: bool) -> (u64, u64, u64, u64) {
+    let mut config = backend_config(backend);
+    config.pipeline.width = width;
+    let mut tc = TestContext::with_program(&config, &program());
+    if fallback {
+        tc.sim.pipeline = match backend {
+            BackendType::InOrder => PipelineDispatch::InOrder(SpecializedPipeline::Any(Box::new(
+                Pipeline::new(&config, InOrderEngine::new(&config)),
+            ))),
+            BackendType::OutOfOrder => PipelineDispatch::OutOfOrder(SpecializedPipeline::Any(
+                Box::new(Pipeline::new(&config, O3Engine::new(&config))),
+            )),
+        };
+    }
+    tc.set_reg(5, DATA);
+    tc.sim.sync_arch_regs();
+    tc.run(3000);
+    let stats = &tc.cpu().stats;
+    (stats.cycles, stats.instructions_retired, stats.tma_slots, tc.get_reg(10))
+}
+
+#[test]
+fn configured_width_selects_its_specialization() {
+    for (width, expected) in [(1, 1), (2, 2), (3, 0), (4, 4), (8, 8), (16, 0)] {
+        let mut config = Config::default();
+        config.pipeline.width = width;
+        let selected = match SpecializedPipeline::new(&config, InOrderEngine::new(&config)) {
+            SpecializedPipeline::W1(_) => 1,
+            SpecializedPipeline::W2(_) => 2,
+            SpecializedPipeline::W4(_) => 4,
+            SpecializedPipeline::W8(_) => 8,
+            SpecializedPipeline::Any(_) => 0,
+        };
+        assert_eq!(selected, expected, "width {width}");
+    }
+}
+
+#[test]
+fn specialized_pipelines_match_runtime_width() {
+    for backend in [BackendType::InOrder, BackendType::OutOfOrder] {
+        for width in SPECIALIZED_WIDTHS {
+            let specialized = run(backend, width, false);
+            assert_eq!(specialized, run(backend, width, true), "{backend:?} width {width}");
+            assert!(specialized.1 > 200, "{backend:?} width {width} did not run the loop");
+        }
+    }
+}
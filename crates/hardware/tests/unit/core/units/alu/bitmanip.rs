@@ -0,0 +1,201 @@
+//! ALU Bit-Manipulation Tests (Zba, Zbb, Zbs).
+//!
+//! Deterministic test vectors for the bit-manipulation operations, covering
+//! the word (`.uw` / W-suffix) variants and the bit-index masking, followed
+//! by short programs that exercise decode of each encoding group through
+//! both pipeline backends.
+//!
+//! Reference: RISC-V Bit-Manipulation ISA-extensions, Version 1.0.0.
+
+use crate::common::harness::TestContext;
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::core::pipeline::signals::AluOp;
+use rvsim_core::core::units::alu::Alu;
+
+// ─── Helpers ─────────────────────────────────────────────────────────────────
+
+fn alu(op: AluOp, a: u64, b: u64, is32: bool) -> u64 {
+    Alu::execute(op, a, b, 0, is32)
+}
+
+const fn r_type(opcode: u32, funct7: u32, funct3: u32, rd: u32, rs1: u32, rs2: u32) -> u32 {
+    (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode
+}
+
+const fn i_type(opcode: u32, imm12: u32, funct3: u32, rd: u32, rs1: u32) -> u32 {
+    (imm12 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode
+}
+
+const OP_IMM: u32 = 0x13;
+const OP_IMM_32: u32 = 0x1B;
+const OP_REG: u32 = 0x33;
+const OP_REG_32: u32 = 0x3B;
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  Zba: address generation
+// ═════════════════════════════════════════════════════════════════════════════
+
+#[test]
+fn shadd_scales_first_operand() {
+    assert_eq!(alu(AluOp::Sh1Add, 5, 100, false), 110);
+    assert_eq!(alu(AluOp::Sh2Add, 5, 100, false), 120);
+    assert_eq!(alu(AluOp::Sh3Add, 5, 100, false), 140);
+}
+
+#[test]
+fn shadd_uw_zero_extends_index() {
+    // The upper word of the index is discarded before scaling.
+    let idx = 0xFFFF_FFFF_0000_0002;
+    assert_eq!(alu(AluOp::Sh3Add, idx, 0x1000, true), 0x1010);
+    assert_eq!(alu(AluOp::Sh3Add, idx, 0x1000, false), 0xFFFF_FFF8_0000_1010);
+}
+
+#[test]
+fn add_uw_and_slli_uw() {
+    assert_eq!(alu(AluOp::AddUw, 0xFFFF_FFFF_FFFF_FFFF, 1, true), 0x1_0000_0000);
+    assert_eq!(alu(AluOp::SllUw, 0xABCD_0000_8000_0001, 4, true), 0x8_0000_0010);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  Zbb: basic bit manipulation
+// ═════════════════════════════════════════════════════════════════════════════
+
+#[test]
+fn logic_with_negate() {
+    let a = 0xF0F0_F0F0_F0F0_F0F0;
+    let b = 0xFF00_FF00_FF00_FF00;
+    assert_eq!(alu(AluOp::Andn, a, b, false), 0x00F0_00F0_00F0_00F0);
+    assert_eq!(alu(AluOp::Orn, a, b, false), 0xF0FF_F0FF_F0FF_F0FF);
+    assert_eq!(alu(AluOp::Xnor, a, b, false), 0xF00F_F00F_F00F_F00F);
+}
+
+#[test]
+fn counts_full_and_word() {
+    assert_eq!(alu(AluOp::Clz, 0, 0, false), 64);
+    assert_eq!(alu(AluOp::Clz, 1 << 40, 0, false), 23);
+    assert_eq!(alu(AluOp::Clz, 1 << 40, 0, true), 32, "clzw ignores the upper word");
+    assert_eq!(alu(AluOp::Ctz, 0, 0, false), 64);
+    assert_eq!(alu(AluOp::Ctz, 1 << 40, 0, true), 32);
+    assert_eq!(alu(AluOp::Ctz, 0x80, 0, false), 7);
+    assert_eq!(alu(AluOp::Cpop, u64::MAX, 0, false), 64);
+    assert_eq!(alu(AluOp::Cpop, u64::MAX, 0, true), 32);
+}
+
+#[test]
+fn min_max_signedness() {
+    let neg = (-5i64) as u64;
+    assert_eq!(alu(AluOp::Max, neg, 3, false), 3);
+    assert_eq!(alu(AluOp::Maxu, neg, 3, false), neg);
+    assert_eq!(alu(AluOp::Min, neg, 3, false), neg);
+    assert_eq!(alu(AluOp::Minu, neg, 3, false), 3);
+}
+
+#[test]
+fn sign_and_zero_extension() {
+    assert_eq!(alu(AluOp::SextB, 0x1234_5680, 0, false), 0xFFFF_FFFF_FFFF_FF80);
+    assert_eq!(alu(AluOp::SextH, 0x1234_8001, 0, false), 0xFFFF_FFFF_FFFF_8001);
+    assert_eq!(alu(AluOp::ZextH, 0xFFFF_FFFF_FFFF_8001, 0, true), 0x8001);
+}
+
+#[test]
+fn rotates_full_and_word() {
+    assert_eq!(alu(AluOp::Rol, 0x8000_0000_0000_0001, 1, false), 3);
+    assert_eq!(alu(AluOp::Ror, 3, 1, false), 0x8000_0000_0000_0001);
+    assert_eq!(alu(AluOp::Ror, 3, 65, false), 0x8000_0000_0000_0001, "amount masked to 6 bits");
+    // rolw/rorw operate on the low word and sign-extend.
+    assert_eq!(alu(AluOp::Rol, 0x4000_0000, 1, true), 0xFFFF_FFFF_8000_0000);
+    assert_eq!(alu(AluOp::Ror, 0xFFFF_FFFF_0000_0001, 1, true), 0xFFFF_FFFF_8000_0000);
+}
+
+#[test]
+fn orc_b_and_rev8() {
+    assert_eq!(alu(AluOp::OrcB, 0x0001_0000_8000_0100, 0, false), 0x00FF_0000_FF00_FF00);
+    assert_eq!(alu(AluOp::Rev8, 0x0102_0304_0506_0708, 0, false), 0x0807_0605_0403_0201);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  Zbs: single-bit operations
+// ═════════════════════════════════════════════════════════════════════════════
+
+#[test]
+fn single_bit_ops() {
+    let x = 0xF0;
+    assert_eq!(alu(AluOp::Bset, x, 0, false), 0xF1);
+    assert_eq!(alu(AluOp::Bclr, x, 4, false), 0xE0);
+    assert_eq!(alu(AluOp::Binv, x, 63, false), 0x8000_0000_0000_00F0);
+    assert_eq!(alu(AluOp::Bext, x, 7, false), 1);
+    assert_eq!(alu(AluOp::Bext, x, 8, false), 0);
+    // The bit index is taken modulo XLEN.
+    assert_eq!(alu(AluOp::Bset, 0, 64 + 3, false), 8);
+}
+
+// ═════════════════════════════════════════════════════════════════════════════
+//  Decode and execute through the pipeline
+// ═════════════════════════════════════════════════════════════════════════════
+
+const BASE_ADDR: u64 = 0x8000_0000;
+
+/// One instruction from each encoding group; results land in x10..x23.
+fn program() -> Vec<u32> {
+    vec![
+        r_type(OP_REG, 0b0010000, 0b110, 10, 1, 2), // sh3add  x10, x1, x2
+        r_type(OP_REG_32, 0b0010000, 0b010, 11, 3, 2), // sh1add.uw x11, x3, x2
+        r_type(OP_REG_32, 0b0000100, 0b000, 12, 3, 2), // add.uw  x12, x3, x2
+        r_type(OP_REG, 0b0100000, 0b111, 13, 3, 1), // andn    x13, x3, x1
+        r_type(OP_REG, 0b0000101, 0b110, 14, 4, 1), // max     x14, x4, x1
+        r_type(OP_REG_32, 0b0110000, 0b001, 15, 3, 1), // rolw    x15, x3, x1
+        r_type(OP_REG, 0b0100100, 0b101, 16, 2, 5), // bext    x16, x2, x5
+        i_type(OP_IMM, 0x600, 0b001, 17, 2),        // clz     x17, x2
+        i_type(OP_IMM, 0x602, 0b001, 18, 3),        // cpop    x18, x3
+        i_type(OP_IMM, 0x6B8, 0b101, 19, 2),        // rev8    x19, x2
+        i_type(OP_IMM, (0b001010 << 6) | 40, 0b001, 20, 0), // bseti x20, x0, 40
+        i_type(OP_IMM, (0b011000 << 6) | 8, 0b101, 21, 2), // rori  x21, x2, 8
+        i_type(OP_IMM_32, 0x602, 0b001, 22, 3),     // cpopw   x22, x3
+        r_type(OP_REG_32, 0b0000100, 0b100, 23, 4, 0), // zext.h  x23, x4
+        0x6F,                                       // jal x0, 0
+    ]
+}
+
+fn run(backend: BackendType) -> TestContext {
+    let mut config = Config::default();
+    config.pipeline.backend = backend;
+    let mut tc = TestContext::with_config(&config)
+        .with_memory(0x1000, BASE_ADDR)
+        .load_program(BASE_ADDR, &program());
+    tc.set_reg(1, 3);
+    tc.set_reg(2, 0x0000_1234);
+    tc.set_reg(3, 0xFFFF_FFFF_0000_00FF);
+    tc.set_reg(4, (-7i64) as u64);
+    tc.set_reg(5, 2);
+    tc.sim.sync_arch_regs();
+    tc.run(300);
+    tc
+}
+
+fn assert_results(tc: &TestContext) {
+    assert_eq!(tc.get_reg(10), (3 << 3) + 0x1234, "sh3add");
+    assert_eq!(tc.get_reg(11), (0xFF << 1) + 0x1234, "sh1add.uw");
+    assert_eq!(tc.get_reg(12), 0xFF + 0x1234, "add.uw");
+    assert_eq!(tc.get_reg(13), 0xFFFF_FFFF_0000_00FC, "andn");
+    assert_eq!(tc.get_reg(14), 3, "max");
+    assert_eq!(tc.get_reg(15), 0x7F8, "rolw");
+    assert_eq!(tc.get_reg(16), 1, "bext");
+    assert_eq!(tc.get_reg(17), 51, "clz");
+    assert_eq!(tc.get_reg(18), 40, "cpop");
+    assert_eq!(tc.get_reg(19), 0x3412_0000_0000_0000, "rev8");
+    assert_eq!(tc.get_reg(20), 1 << 40, "bseti");
+    assert_eq!(tc.get_reg(21), 0x3400_0000_0000_0012, "rori");
+    assert_eq!(tc.get_reg(22), 8, "cpopw");
+    assert_eq!(tc.get_reg(23), 0xFFF9, "zext.h");
+}
+
+#[test]
+fn inorder_decodes_and_executes_bitmanip() {
+    assert_results(&run(BackendType::InOrder));
+}
+
+#[test]
+fn o3_decodes_and_executes_bitmanip() {
+    assert_results(&run(BackendType::OutOfOrder));
+}
@@ -1,3 +1,4 @@
 pub mod arithmetic;
 pub mod logic;
 pub mod shifts;
+pub mod bitmanip;
@@ -11,7 +11,7 @@
 use rvsim_core::config::{
     CacheConfig, Prefetcher as PrefetcherType, ReplacementPolicy as PolicyType,
 };
-use rvsim_core::core::units::cache::CacheSim;
+use rvsim_core::core::units::cache::{AccessBuffers, CacheSim};
 
 // ──────────────────────────────────────────────────────────
 // Helper: build a simple test cache
@@ -348,3 +348,72 @@ fn different_line_size_128b() {
     let (hit, _) = cache.access(0x200 + 128, false, NEXT_LEVEL_LATENCY);
     assert!(!hit, "Different 128-byte line should miss");
 }
+
+// ══════════════════════════════════════════════════════════
+// Tracked Access Buffers
+// ══════════════════════════════════════════════════════════
+
+/// A conflict miss reports its victim in the caller's buffer, and the next
+/// access clears the buffer instead of accumulating stale evictions.
+#[test]
+fn tracked_split_reuses_caller_buffers() {
+    let mut cache = CacheSim::new(&test_config());
+    let mut buf = AccessBuffers::default();
+
+    // Set 0 holds tags 0 and 1; tag 2 evicts the LRU line (0x0000).
+    let _ = cache.access_tracked_split(0x0000, true, NEXT_LEVEL_LATENCY, &mut buf);
+    let _ = cache.access_tracked_split(0x0080, false, NEXT_LEVEL_LATENCY, &mut buf);
+    let (hit, _) = cache.access_tracked_split(0x0100, false, NEXT_LEVEL_LATENCY, &mut buf);
+    assert!(!hit);
+    assert_eq!(buf.evictions.len(), 1);
+    assert_eq!(buf.evictions[0].addr, 0x0000);
+    assert!(buf.evictions[0].dirty);
+
+    let (hit, _) = cache.access_tracked_split(0x0100, false, NEXT_LEVEL_LATENCY, &mut buf);
+    assert!(hit);
+    assert!(buf.evictions.is_empty());
+    assert!(buf.prefetches.is_empty());
+}
+
+/// `access_tracked` installs prefetches and appends their evictions.
+#[test]
+fn tracked_access_installs_prefetches() {
+    let config = CacheConfig { prefetcher: PrefetcherType::NextLine, ..test_config() };
+    let mut cache = CacheSim::new(&config);
+    let mut buf = AccessBuffers::default();
+
+    let _ = cache.access_tracked(0x1000, false, NEXT_LEVEL_LATENCY, &mut buf);
+    assert_eq!(buf.prefetches, [0x1040]);
+    assert!(cache.contains(0x1040));
+}
+
+/// `reset` empties the cache and restarts replacement state as a fresh
+/// cache would, and a changed geometry rebuilds it.
+#[test]
+fn reset_matches_fresh_cache() {
+    let config = test_config();
+    let mut cache = CacheSim::new(&config);
+    // Make 0x0000 the MRU line of set 0, so a stale LRU stack would evict 0x0080.
+    let _ = cache.access(0x0080, true, NEXT_LEVEL_LATENCY);
+    let _ = cache.access(0x0000, false, NEXT_LEVEL_LATENCY);
+
+    cache.reset(&config);
+    assert!(!cache.contains(0x0000));
+    assert!(!cache.contains(0x0080));
+
+    let mut fresh = CacheSim::new(&config);
+    for addr in [0x0000, 0x0080, 0x0100, 0x0000] {
+        assert_eq!(
+            cache.access(addr, false, NEXT_LEVEL_LATENCY),
+            fresh.access(addr, false, NEXT_LEVEL_LATENCY),
+            "{addr:#x}"
+        );
+    }
+
+    let wider = CacheConfig { ways: 4, size_bytes: 512, ..config };
+    cache.reset(&wider);
+    for addr in [0x0000, 0x0080, 0x0100, 0x0180] {
+        let _ = cache.access(addr, false, NEXT_LEVEL_LATENCY);
+    }
+    assert!(cache.contains(0x0000), "four ways per set after the rebuild");
+}
@@ -1,2 +1,3 @@
 pub mod cache_sim;
 pub mod policies;
+pub mod stack_distance;
@@ -374,3 +374,24 @@ fn random_not_stuck() {
         seen.len()
     );
 }
+
+// ══════════════════════════════════════════════════════════
+// 6. Enum Dispatch
+// ══════════════════════════════════════════════════════════
+
+/// `Policy` forwards to the concrete policy selected by the config enum.
+#[test]
+fn policy_enum_matches_concrete_policy() {
+    use rvsim_core::config::ReplacementPolicy as PolicyType;
+    use rvsim_core::core::units::cache::policies::Policy;
+
+    let mut wrapped = Policy::new(PolicyType::Lru, 2, 4);
+    let mut concrete = LruPolicy::new(2, 4);
+    for (set, way) in [(0, 1), (0, 3), (1, 2), (0, 0), (1, 0)] {
+        wrapped.update(set, way);
+        concrete.update(set, way);
+        assert_eq!(wrapped.get_victim(0), concrete.get_victim(0));
+        assert_eq!(wrapped.get_victim(1), concrete.get_victim(1));
+    }
+    assert!(matches!(Policy::new(PolicyType::Plru, 1, 4), Policy::Plru(_)));
+}
@@ -0,0 +1,105 @@
+//! Stack-Distance Profiler Unit Tests.
+//!
+//! Verifies that one pass of the stack-distance profiler predicts the
+//! miss counts of LRU `CacheSim`s of every geometry it covers, and that
+//! sampled set counts stay close to the exact miss ratio.
+
+use rvsim_core::config::{CacheConfig, Prefetcher, ReplacementPolicy, StackDistanceConfig};
+use rvsim_core::core::units::cache::CacheSim;
+use rvsim_core::core::units::cache::stack_distance::{
+    StackDistanceHistogram, StackDistanceProfiler,
+};
+
+const LINE: u64 = 64;
+
+/// A mix of strided sweeps and hot lines over 64 KiB (xorshift-driven).
+fn access_stream() -> Vec<(u64, bool)> {
+    let mut state = 0x2545_F491_4F6C_DD1D_u64;
+    let mut next = move || {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        state
+    };
+    (0..20_000_u64)
+        .map(|i| {
+            let r = next();
+            let addr = match r % 4 {
+                0 => (i * 8) % 16_384,
+                1 => (r >> 8) % 65_536,
+                2 => ((r >> 8) % 32) * LINE,
+                _ => 0x4000 + (i * 72) % 8_192,
+            };
+            (addr, r & 0x10 != 0)
+        })
+        .collect()
+}
+
+fn lru(size_bytes: usize, ways: usize) -> CacheSim {
+    CacheSim::new(&CacheConfig {
+        enabled: true,
+        size_bytes,
+        line_bytes: LINE as usize,
+        ways,
+        policy: ReplacementPolicy::Lru,
+        latency: 1,
+        prefetcher: Prefetcher::None,
+        prefetch_table_size: 64,
+        prefetch_degree: 1,
+        mshr_count: 0,
+    })
+}
+
+fn profile(sampled_sets: usize) -> StackDistanceHistogram {
+    let mut profiler = StackDistanceProfiler::new(&StackDistanceConfig {
+        enabled: true,
+        line_bytes: LINE as usize,
+        max_sets: 256,
+        max_ways: 16,
+        sampled_sets,
+    });
+    let mut hist = StackDistanceHistogram::default();
+    for (addr, _) in access_stream() {
+        profiler.access(addr, &mut hist);
+    }
+    hist
+}
+
+/// Every profiled geometry matches a dedicated LRU simulation exactly.
+#[test]
+fn unsampled_profile_matches_lru_cachesim() {
+    let hist = profile(256);
+    let stream = access_stream();
+    for sets in [1, 4, 32, 256] {
+        for ways in [1, 2, 4, 8, 16] {
+            let mut cache = lru(sets * ways * LINE as usize, ways);
+            let hits = stream.iter().filter(|&&(addr, write)| cache.access(addr, write, 0).0);
+            let hits = hits.count() as u64;
+            assert_eq!(hist.accesses(sets as u64), Some(stream.len() as u64));
+            assert_eq!(hist.hits(sets as u64, ways), Some(hits), "{sets} sets x {ways} ways");
+        }
+    }
+}
+
+/// Sampling 16 of 256 sets estimates the miss ratio of the whole cache.
+#[test]
+fn sampled_profile_approximates_the_exact_one() {
+    let exact = profile(256);
+    let sampled = profile(16);
+    assert_eq!(sampled.accesses(16), exact.accesses(16), "16 sets are not sampled");
+    assert!(sampled.accesses(256).unwrap() < exact.accesses(256).unwrap() / 4);
+    for ways in [1, 4, 16] {
+        let (e, s) = (exact.miss_ratio(256, ways).unwrap(), sampled.miss_ratio(256, ways).unwrap());
+        assert!((e - s).abs() < 0.1, "{ways} ways: exact {e:.3}, sampled {s:.3}");
+    }
+}
+
+/// Miss ratios never rise with associativity at a fixed set count.
+#[test]
+fn miss_ratio_is_monotonic_in_ways() {
+    let hist = profile(256);
+    for sets in [1, 8, 64] {
+        let ratios: Vec<f64> = (1..=16).map(|w| hist.miss_ratio(sets, w).unwrap()).collect();
+        assert!(ratios.windows(2).all(|w| w[1] <= w[0]), "{sets} sets: {ratios:?}");
+    }
+}
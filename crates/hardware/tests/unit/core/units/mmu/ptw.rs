@@ -7,9 +7,11 @@
 //! - Accessed/Dirty bit updates
 //! - Canonical address checks
 //! - Bare mode bypass
+//! - Page-walk cache and superpage TLB entries
 
 use crate::common::harness::TestContext;
 use rvsim_core::common::{AccessType, PhysAddr, Trap, VirtAddr};
+use rvsim_core::config::MemoryConfig;
 use rvsim_core::core::arch::csr::{self, Csrs};
 use rvsim_core::core::arch::mode::PrivilegeMode;
 use rvsim_core::core::units::mmu::Mmu;
@@ -408,3 +410,96 @@ fn non_canonical_address_faults() {
     // Non-canonical address is unmapped in the virtual address space → PageFault
     assert!(matches!(res.trap, Some(Trap::LoadPageFault(_))), "Trap: {:?}", res.trap);
 }
+
+// ══════════════════════════════════════════════════════════
+// 8. Page-Walk Cache and Superpage Entries
+// ══════════════════════════════════════════════════════════
+
+/// MMU with one-entry 4 KiB TLBs, so every new page misses both levels.
+fn setup_cached_mmu(superpage_entries: usize, pwc_size: usize) -> (Mmu, Csrs, TestContext) {
+    let (_, csrs, tc) = setup_mmu();
+    let config = MemoryConfig {
+        tlb_size: 1,
+        l2_tlb_size: 1,
+        l2_tlb_ways: 1,
+        tlb_superpage_entries: superpage_entries,
+        l2_tlb_superpage_entries: superpage_entries,
+        page_walk_cache_size: pwc_size,
+        software_ad_bits: false,
+        ..MemoryConfig::default()
+    };
+    (Mmu::from_config(&config), csrs, tc)
+}
+
+#[test]
+fn page_walk_cache_skips_upper_levels() {
+    let (mut mmu, csrs, mut tc) = setup_cached_mmu(0, 4);
+    let bus = &mut tc.cpu_mut().bus.bus;
+
+    // Two 4 KiB pages in the same 2 MiB region: VPN[2]=1, VPN[1]=0, VPN[0]=1/2.
+    let l1_table_ppn = ROOT_PPN + 1;
+    let l0_table_ppn = ROOT_PPN + 2;
+    write_pte(bus, ROOT_PPN, 1, make_pte(l1_table_ppn, 0));
+    write_pte(bus, l1_table_ppn, 0, make_pte(l0_table_ppn, 0));
+    write_pte(bus, l0_table_ppn, 1, make_pte(ROOT_PPN + 10, R | W | A | D));
+    write_pte(bus, l0_table_ppn, 2, make_pte(ROOT_PPN + 11, R | W | A | D));
+
+    let first = mmu.translate(
+        VirtAddr::new(0x4000_1000),
+        AccessType::Read,
+        PrivilegeMode::Supervisor,
+        &csrs,
+        bus,
+    );
+    assert!(first.trap.is_none(), "Trap: {:?}", first.trap);
+    assert_eq!((mmu.stats.pte_reads, mmu.stats.pwc_misses), (3, 1));
+
+    let second = mmu.translate(
+        VirtAddr::new(0x4000_2008),
+        AccessType::Read,
+        PrivilegeMode::Supervisor,
+        &csrs,
+        bus,
+    );
+    assert!(second.trap.is_none(), "Trap: {:?}", second.trap);
+    assert_eq!(second.paddr.val(), ((ROOT_PPN + 11) << 12) | 0x8);
+    assert_eq!(mmu.stats.pte_reads, 4, "only the leaf PTE is read");
+    assert_eq!(mmu.stats.pwc_hits, 1);
+    assert!(second.cycles < first.cycles);
+
+    // After a full flush the walk starts from the root again.
+    mmu.flush_all();
+    let third = mmu.translate(
+        VirtAddr::new(0x4000_2008),
+        AccessType::Read,
+        PrivilegeMode::Supervisor,
+        &csrs,
+        bus,
+    );
+    assert!(third.trap.is_none(), "Trap: {:?}", third.trap);
+    assert_eq!(mmu.stats.pte_reads, 7);
+    assert_eq!(mmu.stats.page_walks, 3);
+}
+
+#[test]
+fn megapage_walk_fills_superpage_entry() {
+    let (mut mmu, csrs, mut tc) = setup_cached_mmu(2, 0);
+    let bus = &mut tc.cpu_mut().bus.bus;
+
+    // VPN[2]=1, VPN[1]=1 -> 2 MiB leaf.
+    let l1_table_ppn = ROOT_PPN + 1;
+    let target_ppn = ROOT_PPN + 0x200;
+    write_pte(bus, ROOT_PPN, 1, make_pte(l1_table_ppn, 0));
+    write_pte(bus, l1_table_ppn, 1, make_pte(target_ppn, R | W | A | D));
+
+    // Touch every 4 KiB page of the megapage: only the first one walks.
+    for page in 0..512u64 {
+        let vaddr = VirtAddr::new(0x4020_0000 + (page << 12) + 0x10);
+        let res = mmu.translate(vaddr, AccessType::Read, PrivilegeMode::Supervisor, &csrs, bus);
+        assert!(res.trap.is_none(), "Trap: {:?}", res.trap);
+        assert_eq!(res.paddr.val(), ((target_ppn + page) << 12) | 0x10);
+    }
+    assert_eq!(mmu.stats.page_walks, 1);
+    assert_eq!(mmu.stats.dtlb_hits, 511);
+    assert_eq!(mmu.stats.superpage_hits, 511);
+}
@@ -7,9 +7,10 @@
 //! - Capacity and full associativity (or lack thereof - TLB is direct mapped)
 //! - Flushing
 //! - ASID tagging and global bit behavior
+//! - Superpage entries (one entry covers every 4 KiB page of a 2 MiB page)
 
 use rvsim_core::common::{Asid, Ppn, Vpn};
-use rvsim_core::core::units::mmu::tlb::{Tlb, TlbHit};
+use rvsim_core::core::units::mmu::tlb::{L2Tlb, Tlb, TlbHit};
 
 // ══════════════════════════════════════════════════════════
 // Helpers
@@ -258,3 +259,85 @@ fn flush_vaddr_asid_preserves_global() {
         "Global entry should survive vaddr+ASID flush"
     );
 }
+
+// ══════════════════════════════════════════════════════════
+// 5. Superpages
+// ══════════════════════════════════════════════════════════
+
+/// First VPN of the 2 MiB megapage at VPN 0x400 (maps to PPN 0x8_0000).
+const MEGA_VPN: u64 = 0x400;
+const MEGA_PPN: u64 = 0x8_0000;
+
+#[test]
+fn megapage_entry_covers_every_4k_page() {
+    let mut tlb = Tlb::with_superpages(4, 2);
+    // Walk of the page at offset 0x123 inside the megapage.
+    tlb.insert_page(
+        Vpn::new(MEGA_VPN + 0x123),
+        Ppn::new(MEGA_PPN + 0x123),
+        PTE_V | PTE_R,
+        Asid::new(0),
+        1,
+    );
+
+    for offset in [0, 0x7, 0x123, 0x1FF] {
+        match tlb.lookup(Vpn::new(MEGA_VPN + offset), Asid::new(0)) {
+            Some(TlbHit { ppn, level, .. }) => {
+                assert_eq!(ppn, Ppn::new(MEGA_PPN + offset));
+                assert_eq!(level, 1);
+            }
+            None => panic!("offset {offset:#x} should hit the megapage entry"),
+        }
+    }
+    assert_eq!(tlb.lookup(Vpn::new(MEGA_VPN + 0x200), Asid::new(0)), None);
+}
+
+#[test]
+fn superpage_without_array_caches_single_page() {
+    let mut tlb = Tlb::new(4);
+    tlb.insert_page(Vpn::new(MEGA_VPN + 1), Ppn::new(MEGA_PPN + 1), PTE_V | PTE_R, Asid::new(0), 1);
+
+    let hit = tlb.lookup(Vpn::new(MEGA_VPN + 1), Asid::new(0)).unwrap();
+    assert_eq!((hit.ppn, hit.level), (Ppn::new(MEGA_PPN + 1), 0));
+    assert_eq!(tlb.lookup(Vpn::new(MEGA_VPN + 2), Asid::new(0)), None);
+}
+
+#[test]
+fn superpage_flushes() {
+    let mut tlb = Tlb::with_superpages(4, 2);
+    let insert = |tlb: &mut Tlb, vpn: u64, pte: u64| {
+        tlb.insert_page(Vpn::new(vpn), Ppn::new(MEGA_PPN), pte, Asid::new(1), 1);
+    };
+
+    insert(&mut tlb, MEGA_VPN, PTE_V | PTE_R);
+    tlb.flush_vaddr(Vpn::new(MEGA_VPN + 0x40));
+    assert_eq!(tlb.lookup(Vpn::new(MEGA_VPN), Asid::new(1)), None, "any covered page flushes it");
+
+    insert(&mut tlb, MEGA_VPN, PTE_V | PTE_R);
+    tlb.flush_asid(Asid::new(2));
+    assert!(tlb.lookup(Vpn::new(MEGA_VPN), Asid::new(1)).is_some());
+    tlb.flush_asid(Asid::new(1));
+    assert_eq!(tlb.lookup(Vpn::new(MEGA_VPN), Asid::new(1)), None);
+
+    insert(&mut tlb, MEGA_VPN, PTE_V | PTE_R | PTE_G);
+    tlb.flush_vaddr_asid(Vpn::new(MEGA_VPN + 1), Asid::new(1));
+    assert!(tlb.lookup(Vpn::new(MEGA_VPN), Asid::new(3)).is_some(), "global entry survives");
+    tlb.flush();
+    assert_eq!(tlb.lookup(Vpn::new(MEGA_VPN), Asid::new(3)), None);
+}
+
+#[test]
+fn l2_tlb_superpage_hit_reports_level() {
+    let mut l2 = L2Tlb::with_superpages(16, 4, 4, 2);
+    // 1 GiB gigapage at VPN 0x4_0000.
+    l2.insert_page(Vpn::new(0x4_0000), Ppn::new(0x4_0000), PTE_V | PTE_R | PTE_X, Asid::new(0), 2);
+
+    let (hit, pte, _) = l2.lookup(Vpn::new(0x4_1234), Asid::new(0)).unwrap();
+    assert_eq!((hit.ppn, hit.level), (Ppn::new(0x4_1234), 2));
+    assert_eq!(pte & (PTE_R | PTE_X), PTE_R | PTE_X);
+
+    // Promoting to an L1 TLB keeps the mapping a single superpage entry.
+    let mut l1 = Tlb::with_superpages(4, 2);
+    l1.insert_page(Vpn::new(0x4_1234), hit.ppn, pte, Asid::new(0), hit.level);
+    assert_eq!(l1.lookup(Vpn::new(0x5_FFFF), Asid::new(0)).unwrap().ppn, Ppn::new(0x5_FFFF));
+}
@@ -5,3 +5,4 @@ pub mod fpu;
 pub mod lsu;
 pub mod mmu;
 pub mod prefetch;
+pub mod vpu;
@@ -0,0 +1,179 @@
+//! # Vector Unit Tests
+//!
+//! Runs short RVV programs on the functional engine and on both pipeline
+//! backends, checking that each produces the same architectural result and
+//! that vector instructions are illegal when the extension is disabled.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, TestContext, backend_config};
+use rvsim_core::common::PhysAddr;
+use rvsim_core::config::{Config, FastForwardConfig};
+use rvsim_core::core::pipeline::engine::BackendType;
+
+const SRC_A: u64 = RAM_BASE + 0x800;
+const SRC_B: u64 = RAM_BASE + 0x810;
+const DST: u64 = RAM_BASE + 0x820;
+
+/// `vsetvli rd, rs1, e32, m1, tu, mu`.
+const fn vsetvli_e32(rd: u32, rs1: u32) -> u32 {
+    (0b010_000 << 20) | (rs1 << 15) | (0b111 << 12) | (rd << 7) | 0x57
+}
+
+/// `vle32.v vd, (rs1)`.
+const fn vle32(vd: u32, rs1: u32) -> u32 {
+    (1 << 25) | (rs1 << 15) | (0b110 << 12) | (vd << 7) | 0x07
+}
+
+/// `vlse32.v vd, (rs1), rs2`.
+const fn vlse32(vd: u32, rs1: u32, rs2: u32) -> u32 {
+    (0b10 << 26) | (1 << 25) | (rs2 << 20) | (rs1 << 15) | (0b110 << 12) | (vd << 7) | 0x07
+}
+
+/// `vse32.v vs3, (rs1)`.
+const fn vse32(vs3: u32, rs1: u32) -> u32 {
+    (1 << 25) | (rs1 << 15) | (0b110 << 12) | (vs3 << 7) | 0x27
+}
+
+/// `vadd.vv vd, vs2, vs1`.
+const fn vadd_vv(vd: u32, vs2: u32, vs1: u32) -> u32 {
+    (1 << 25) | (vs2 << 20) | (vs1 << 15) | (vd << 7) | 0x57
+}
+
+/// `vmv.x.s rd, vs2`.
+const fn vmv_x_s(rd: u32, vs2: u32) -> u32 {
+    (0b010000 << 26) | (1 << 25) | (vs2 << 20) | (0b010 << 12) | (rd << 7) | 0x57
+}
+
+fn spin() -> u32 {
+    InstructionBuilder::new().spin().build()
+}
+
+/// Adds two 4-element vectors and stores the sum.
+///
+/// Final state: x10 = 4 (vl), x11 = 11 (element 0 of the sum),
+/// mem[DST..DST+16] = [11, 22, 33, 44].
+fn add_program() -> Vec<u32> {
+    vec![
+        vsetvli_e32(10, 8), //  0: vl = min(x8, VLMAX)
+        vle32(1, 5),        //  4: v1 = a
+        vle32(2, 6),        //  8: v2 = b
+        vadd_vv(3, 1, 2),   // 12: v3 = v1 + v2
+        vse32(3, 7),        // 16: dst = v3
+        vmv_x_s(11, 3),     // 20: x11 = v3[0]
+        spin(),             // 24
+    ]
+}
+
+fn vector_config(backend: BackendType) -> Config {
+    let mut config = backend_config(backend);
+    config.pipeline.vector.enabled = true;
+    config.pipeline.vector.vlen = 128;
+    config
+}
+
+fn ctx(config: &Config, program: &[u32]) -> TestContext {
+    let mut tc = TestContext::with_program(config, program);
+    for i in 0..4u32 {
+        let off = u64::from(i) * 4;
+        tc.cpu_mut().bus.bus.write_u32(PhysAddr::new(SRC_A + off), i + 1);
+        tc.cpu_mut().bus.bus.write_u32(PhysAddr::new(SRC_B + off), (i + 1) * 10);
+    }
+    tc.set_reg(5, SRC_A);
+    tc.set_reg(6, SRC_B);
+    tc.set_reg(7, DST);
+    tc.set_reg(8, 4);
+    tc.sim.sync_arch_regs();
+    tc
+}
+
+fn stored(tc: &mut TestContext, idx: u64) -> u32 {
+    tc.cpu_mut().bus.bus.read_u32(PhysAddr::new(DST + idx * 4))
+}
+
+fn assert_add_result(tc: &mut TestContext) {
+    assert_eq!(tc.get_reg(10), 4, "vl");
+    assert_eq!(tc.get_reg(11), 11, "vmv.x.s");
+    let sums: Vec<u32> = (0..4).map(|i| stored(tc, i)).collect();
+    assert_eq!(sums, [11, 22, 33, 44]);
+}
+
+#[test]
+fn functional_engine_executes_vector_add() {
+    let mut config = vector_config(BackendType::InOrder);
+    config.general.fast_forward =
+        FastForwardConfig { enabled: true, ..FastForwardConfig::default() };
+    let mut tc = ctx(&config, &add_program());
+
+    tc.run(50);
+
+    assert_add_result(&mut tc);
+    assert_eq!(tc.cpu().stats.inst_vector, 6);
+}
+
+#[test]
+fn inorder_pipeline_executes_vector_add() {
+    let mut tc = ctx(&vector_config(BackendType::InOrder), &add_program());
+
+    tc.run(300);
+
+    assert_add_result(&mut tc);
+    let stats = &tc.cpu().stats;
+    assert_eq!(stats.inst_vector, 6);
+    // Two loads, one add, one store, and one vmv.x.s of four elements each.
+    assert!(stats.vector_elements >= 16);
+}
+
+#[test]
+fn o3_pipeline_executes_vector_add() {
+    let mut tc = ctx(&vector_config(BackendType::OutOfOrder), &add_program());
+
+    tc.run(300);
+
+    assert_add_result(&mut tc);
+    assert_eq!(tc.cpu().stats.inst_vector, 6);
+}
+
+#[test]
+fn vsetvli_clamps_to_vlmax() {
+    // VLEN = 128 holds four 32-bit elements.
+    let mut tc = ctx(&vector_config(BackendType::InOrder), &[vsetvli_e32(10, 8), spin()]);
+    tc.set_reg(8, 100);
+    tc.sim.sync_arch_regs();
+
+    tc.run(50);
+
+    assert_eq!(tc.get_reg(10), 4);
+    assert_eq!(tc.cpu().vector.vl, 4);
+}
+
+#[test]
+fn strided_load_gathers_every_other_word() {
+    // Load a[0], b[0] (stride 16) into v1 and store them contiguously.
+    let program = [vsetvli_e32(10, 8), vlse32(1, 5, 9), vse32(1, 7), spin()];
+    let mut tc = ctx(&vector_config(BackendType::OutOfOrder), &program);
+    tc.set_reg(8, 2);
+    tc.set_reg(9, SRC_B - SRC_A);
+    tc.sim.sync_arch_regs();
+
+    tc.run(300);
+
+    assert_eq!(stored(&mut tc, 0), 1);
+    assert_eq!(stored(&mut tc, 1), 10);
+    assert_eq!(stored(&mut tc, 2), 0, "tail element past vl is not stored");
+}
+
+#[test]
+fn vector_instructions_are_illegal_when_disabled() {
+    let mut config = vector_config(BackendType::InOrder);
+    config.pipeline.vector.enabled = false;
+    let mut tc = ctx(&config, &add_program());
+    tc.set_reg(10, 0xAAAA);
+    tc.sim.sync_arch_regs();
+
+    tc.run(50);
+
+    // Traps are fatal in direct mode: the first vsetvli stops the run.
+    assert!(tc.cpu().exit_code.is_some(), "illegal instruction");
+    assert_eq!(tc.get_reg(10), 0xAAAA, "vsetvli must not write rd");
+    assert_eq!(stored(&mut tc, 0), 0);
+}
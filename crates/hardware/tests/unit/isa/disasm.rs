@@ -2,7 +2,7 @@
 //!
 //! Verifies that the disassembler correctly converts common instruction
 //! encodings to human-readable mnemonics for RV64I, RV64M, RV64A,
-//! RV64F/D, and privileged instructions.
+//! RV64F/D, RVV, Zba/Zbb/Zbs, and privileged instructions.
 
 use rvsim_core::isa::disasm::disassemble;
 
@@ -279,3 +279,62 @@ fn disasm_unknown() {
     let text = disassemble(0x0000_0000);
     assert!(text.contains("unknown"), "Expected 'unknown' for all-zeroes, got '{}'", text);
 }
+
+// ══════════════════════════════════════════════════════════
+// RVV: Configuration, Arithmetic, Memory
+// ══════════════════════════════════════════════════════════
+
+#[test]
+fn disasm_vsetvli() {
+    // vsetvli a0, a1, e32, m1, ta, ma
+    let text = disassemble((0b1101_0000 << 20) | (11 << 15) | (0b111 << 12) | (10 << 7) | 0x57);
+    assert_eq!(text, "vsetvli a0, a1, e32, m1, ta, ma");
+}
+
+#[test]
+fn disasm_vadd_vv() {
+    // vadd.vv v3, v1, v2 (unmasked)
+    let text = disassemble((1 << 25) | (1 << 20) | (2 << 15) | (3 << 7) | 0x57);
+    assert_eq!(text, "vadd.vv v3, v1, v2");
+}
+
+#[test]
+fn disasm_vle32() {
+    // vle32.v v1, (t0)
+    let text = disassemble((1 << 25) | (5 << 15) | (0b110 << 12) | (1 << 7) | 0x07);
+    assert!(text.starts_with("vle32.v v1"), "Expected 'vle32.v', got '{}'", text);
+}
+
+// ══════════════════════════════════════════════════════════
+// Zba / Zbb / Zbs
+// ══════════════════════════════════════════════════════════
+
+#[test]
+fn disasm_bitmanip_reg() {
+    // sh1add a0, a1, a2
+    assert_eq!(disassemble(0x20C5_A533), "sh1add a0, a1, a2");
+    // andn a0, a1, a2
+    assert_eq!(disassemble(0x40C5_F533), "andn a0, a1, a2");
+    // add.uw a0, a1, a2
+    assert_eq!(disassemble(0x08C5_853B), "add.uw a0, a1, a2");
+    // zext.h a0, a1
+    assert_eq!(disassemble(0x0805_C53B), "zext.h a0, a1");
+    // bclr a0, a1, a2
+    assert_eq!(disassemble(0x48C5_9533), "bclr a0, a1, a2");
+}
+
+#[test]
+fn disasm_bitmanip_imm() {
+    // clz a0, a1
+    assert_eq!(disassemble(0x6005_9513), "clz a0, a1");
+    // rev8 a0, a1
+    assert_eq!(disassemble(0x6B85_D513), "rev8 a0, a1");
+    // rori a0, a1, 8
+    assert_eq!(disassemble(0x6085_D513), "rori a0, a1, 8");
+    // bseti a0, a1, 40
+    assert_eq!(disassemble(0x2A85_9513), "bseti a0, a1, 40");
+    // slli.uw a0, a1, 3
+    assert_eq!(disassemble(0x0835_951B), "slli.uw a0, a1, 3");
+    // Base shifts are unaffected.
+    assert_eq!(disassemble(0x4035_D513), "srai a0, a1, 3");
+}
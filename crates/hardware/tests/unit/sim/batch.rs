@@ -0,0 +1,74 @@
+//! # Batch Run Loop Tests
+//!
+//! Verifies `Simulator::run_batch`: cycle and instruction limits, guest
+//! exit, and the cross-thread stop flag.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::TestContext;
+use rvsim_core::config::Config;
+use rvsim_core::sim::simulator::{BatchExit, RunLimits};
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// An endless loop of `addi x1, x1, 1`.
+fn counting_loop() -> TestContext {
+    let program = [
+        InstructionBuilder::new().addi(1, 1, 1).build(),
+        InstructionBuilder::new().jal(0, -4).build(),
+    ];
+    TestContext::with_program(&Config::default(), &program)
+}
+
+#[test]
+fn cycle_limit_runs_exact_cycles() {
+    let mut tc = counting_loop();
+    let stop = AtomicBool::new(false);
+    let start = tc.sim.cpu.stats.cycles;
+    let limits = RunLimits { cycles: Some(10_000), instructions: None };
+    assert_eq!(tc.sim.run_batch(limits, &stop).unwrap(), BatchExit::Limit);
+    assert_eq!(tc.sim.cpu.stats.cycles - start, 10_000);
+}
+
+#[test]
+fn zero_cycle_limit_does_nothing() {
+    let mut tc = counting_loop();
+    let stop = AtomicBool::new(false);
+    let limits = RunLimits { cycles: Some(0), instructions: None };
+    assert_eq!(tc.sim.run_batch(limits, &stop).unwrap(), BatchExit::Limit);
+    assert_eq!(tc.get_reg(1), 0);
+}
+
+#[test]
+fn instruction_limit_stops_at_retirement_count() {
+    let mut tc = counting_loop();
+    let stop = AtomicBool::new(false);
+    let start = tc.sim.cpu.stats.instructions_retired;
+    let limits = RunLimits { cycles: Some(100_000), instructions: Some(500) };
+    assert_eq!(tc.sim.run_batch(limits, &stop).unwrap(), BatchExit::Limit);
+    let retired = tc.sim.cpu.stats.instructions_retired - start;
+    // A superscalar commit may overshoot by less than one commit group.
+    assert!((500..500 + 8).contains(&retired), "retired {retired}");
+}
+
+#[test]
+fn raised_flag_stops_before_running() {
+    let mut tc = counting_loop();
+    let stop = AtomicBool::new(true);
+    assert_eq!(tc.sim.run_batch(RunLimits::default(), &stop).unwrap(), BatchExit::Stopped);
+    assert!(stop.load(Ordering::Relaxed), "the flag is left for the caller to clear");
+    assert_eq!(tc.get_reg(1), 0);
+}
+
+#[test]
+fn flag_raised_from_another_thread_stops_an_unbounded_run() {
+    let mut tc = counting_loop();
+    let stop = AtomicBool::new(false);
+    let exit = std::thread::scope(|s| {
+        let _ = s.spawn(|| {
+            std::thread::sleep(std::time::Duration::from_millis(20));
+            stop.store(true, Ordering::Relaxed);
+        });
+        tc.sim.run_batch(RunLimits::default(), &stop)
+    });
+    assert_eq!(exit.unwrap(), BatchExit::Stopped);
+    assert!(tc.sim.cpu.stats.cycles > 0);
+}
@@ -0,0 +1,131 @@
+//! # Branch-Trace Replay Tests
+//!
+//! Verifies that commit streams every retired branch and jump to a branch
+//! trace, that the functional engine captures the same trace as the
+//! detailed pipeline, and that replaying it scores each predictor config
+//! independently and in config order.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, backend_config, system_sim};
+use rvsim_core::common::RegIdx;
+use rvsim_core::config::{BranchPredictor, Config};
+use rvsim_core::core::cpu::branchtrace::{BranchKind, BranchRecord, BranchTraceReader};
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::sim::replay::replay_branch_trace;
+
+const ITERATIONS: u64 = 200;
+const SPIN_PC: u64 = RAM_BASE + 28;
+
+/// A loop with an alternating branch and a call to a leaf function.
+fn loop_program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().addi(7, 0, 0).build(),   //  0
+        b().addi(7, 7, 1).build(),   //  4: loop: x7 += 1
+        b().andi(8, 7, 1).build(),   //  8
+        b().beq(8, 0, 8).build(),    // 12: taken on even x7
+        b().addi(9, 9, 1).build(),   // 16
+        b().jal(1, 16).build(),      // 20: call leaf
+        b().bne(7, 6, -20).build(),  // 24: until x7 == ITERATIONS
+        b().jal(0, 0).build(),       // 28: spin
+        b().addi(0, 0, 0).build(),   // 32
+        b().addi(10, 10, 1).build(), // 36: leaf
+        b().jalr(0, 1, 0).build(),   // 40: ret
+    ]
+}
+
+/// Runs the loop to its spin while capturing its branch trace to `path`.
+fn capture(config: &Config, path: &str) -> Vec<BranchRecord> {
+    let mut sim = system_sim(config, &[(RAM_BASE, loop_program())], &[(6, ITERATIONS)]);
+
+    sim.cpu.open_branch_trace(path).unwrap();
+    assert_eq!(sim.run(20_000).unwrap(), None);
+    assert_eq!(sim.cpu.regs.read(RegIdx::new(10)), ITERATIONS, "the loop finished");
+    let written = sim.cpu.close_branch_trace().unwrap();
+
+    let mut reader = BranchTraceReader::open(path).unwrap();
+    let mut records = Vec::new();
+    while let Some(rec) = reader.next_record().unwrap() {
+        records.push(rec);
+    }
+    assert_eq!(records.len() as u64, written);
+    // Drop the spin, whose trip count depends on the cycle budget.
+    records.retain(|rec| rec.pc != SPIN_PC);
+    records
+}
+
+#[test]
+fn commit_traces_every_retired_control_transfer() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("loop.btr").display().to_string();
+    let records = capture(&backend_config(BackendType::InOrder), &path);
+
+    assert_eq!(records.len() as u64, 4 * ITERATIONS);
+    let count = |kind| records.iter().filter(|rec| rec.kind == kind).count() as u64;
+    assert_eq!(count(BranchKind::Conditional), 2 * ITERATIONS);
+    assert_eq!(count(BranchKind::Call), ITERATIONS);
+    assert_eq!(count(BranchKind::Return), ITERATIONS);
+    let taken = records.iter().filter(|rec| rec.target.is_some()).count() as u64;
+    // Half the beqs, all but the last bne, and every call and return.
+    assert_eq!(taken, ITERATIONS / 2 + (ITERATIONS - 1) + 2 * ITERATIONS);
+    assert!(records.iter().all(|rec| !rec.compressed));
+}
+
+#[test]
+fn functional_and_out_of_order_capture_the_in_order_trace() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("loop.btr").display().to_string();
+    let in_order = capture(&backend_config(BackendType::InOrder), &path);
+
+    let o3 = capture(&backend_config(BackendType::OutOfOrder), &path);
+    assert_eq!(o3, in_order);
+
+    let mut functional = backend_config(BackendType::InOrder);
+    functional.general.fast_forward.enabled = true;
+    assert_eq!(capture(&functional, &path), in_order);
+}
+
+#[test]
+fn replay_scores_each_predictor_in_config_order() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("loop.btr").display().to_string();
+    let _ = capture(&backend_config(BackendType::InOrder), &path);
+
+    let predictors = [BranchPredictor::Static, BranchPredictor::Tage, BranchPredictor::Static];
+    let configs: Vec<Config> = predictors
+        .iter()
+        .map(|&bp| {
+            let mut config = backend_config(BackendType::InOrder);
+            config.pipeline.branch_predictor = bp;
+            config
+        })
+        .collect();
+    let stats = replay_branch_trace(&configs, &path).unwrap();
+    assert_eq!(stats.len(), 3);
+
+    for s in &stats {
+        assert!(s.inst_branch >= 4 * ITERATIONS);
+        assert_eq!(
+            s.committed_branch_predictions + s.committed_branch_mispredictions,
+            2 * ITERATIONS
+        );
+    }
+    // Static predicts not-taken: every taken conditional branch misses.
+    assert_eq!(stats[0].committed_branch_mispredictions, ITERATIONS / 2 + ITERATIONS - 1);
+    assert_eq!(stats[2].committed_branch_mispredictions, stats[0].committed_branch_mispredictions);
+    assert!(
+        stats[1].committed_branch_mispredictions < stats[0].committed_branch_mispredictions / 4,
+        "TAGE learns the loop: {} vs {}",
+        stats[1].committed_branch_mispredictions,
+        stats[0].committed_branch_mispredictions
+    );
+}
+
+#[test]
+fn replay_rejects_a_non_trace_file() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("not-a-trace");
+    std::fs::write(&path, b"RVSIMMTR\x01\0\0\0").unwrap();
+    let err = replay_branch_trace(&[Config::default()], &path.display().to_string()).unwrap_err();
+    assert!(err.to_string().contains("branch trace"), "{err}");
+}
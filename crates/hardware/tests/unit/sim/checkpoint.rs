@@ -0,0 +1,69 @@
+//! # Checkpoint Tests
+//!
+//! Verifies that a checkpoint whose RAM page list has been corrupted is
+//! rejected before any page is restored.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{DATA, RAM_BASE, system_sim};
+use rvsim_core::common::SimError;
+use rvsim_core::config::Config;
+use std::fs;
+
+/// Header words before the CSRs: 13 fixed words, then 32 GPRs and 32 FPRs.
+const WORDS_BEFORE_CSRS: usize = 13 + 64;
+/// Header word holding the CSR count.
+const CSR_COUNT_WORD: usize = 8;
+
+/// Stores to `DATA`, then spins: RAM holds the code page and one data page.
+fn store_program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().addi(6, 0, 7).build(), // 0
+        b().sd(5, 6, 0).build(),   // 4: mem[DATA] = 7
+        b().jal(0, 0).build(),     // 8: spin
+    ]
+}
+
+fn config() -> Config {
+    let mut config = Config::default();
+    config.general.fast_forward.enabled = true;
+    config
+}
+
+/// Saves a checkpoint after the store; returns its bytes and the byte
+/// offset of its page list.
+fn saved_checkpoint(path: &std::path::Path) -> (Vec<u8>, usize) {
+    let mut sim = system_sim(&config(), &[(RAM_BASE, store_program())], &[(5, DATA)]);
+    assert_eq!(sim.run(100).unwrap(), None);
+    sim.save_checkpoint(path).unwrap();
+    let bytes = fs::read(path).unwrap();
+    let word = |i: usize| u64::from_le_bytes(bytes[16 + 8 * i..24 + 8 * i].try_into().unwrap());
+    assert_eq!(word(2), 2, "code and data pages are saved");
+    let pages = 16 + 8 * (WORDS_BEFORE_CSRS + word(CSR_COUNT_WORD) as usize);
+    (bytes, pages)
+}
+
+#[test]
+fn corrupt_page_indices_are_rejected() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("ckpt.bin");
+    let (good, pages) = saved_checkpoint(&path);
+
+    let patch = |entry: usize, page: u64| {
+        let mut bytes = good.clone();
+        let at = pages + 8 * entry;
+        bytes[at..at + 8].copy_from_slice(&page.to_le_bytes());
+        bytes
+    };
+    for (what, bytes) in [
+        ("index wrapping to page 0", patch(0, 1 << 52)),
+        ("index past RAM", patch(1, u64::MAX)),
+        ("duplicate index", patch(1, 0)),
+        ("descending indices", patch(0, 3)),
+    ] {
+        fs::write(&path, bytes).unwrap();
+        let mut sim = system_sim(&config(), &[(RAM_BASE, store_program())], &[]);
+        let err = sim.restore_checkpoint(&path).unwrap_err();
+        assert!(matches!(err, SimError::InvalidCheckpoint { .. }), "{what}: {err}");
+    }
+}
@@ -0,0 +1,154 @@
+//! # Translated-Block Tier Tests
+//!
+//! Verifies that running hot blocks from the functional engine's
+//! translated-block tier leaves the architectural state, device time, and
+//! counters exactly as the interpreter would, across timer interrupts,
+//! self-modifying stores, fast-forward switchover, and batch limits.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{MTIME, MTIMECMP, RAM_BASE, counters, system_sim};
+use rvsim_core::Simulator;
+use rvsim_core::common::{PhysAddr, RegIdx};
+use rvsim_core::config::Config;
+use rvsim_core::core::arch::csr;
+use rvsim_core::isa::privileged::opcodes::MRET;
+use rvsim_core::sim::simulator::{BatchExit, ExecMode, RunLimits};
+use std::sync::atomic::AtomicBool;
+
+const HANDLER: u64 = RAM_BASE + 0x100;
+const DATA: u64 = RAM_BASE + 0x800;
+
+/// Accumulates into memory while the machine timer interrupts every 37 ticks.
+///
+/// Final state: x9 = x10, x14 = interrupts taken, mem[DATA] = sum of 1..=x10.
+fn interrupted_loop() -> Vec<(u64, Vec<u32>)> {
+    let b = InstructionBuilder::new;
+    let main = vec![
+        b().csrrw(0, csr::MTVEC, 12).build(),   //  0: mtvec = x12
+        b().csrrs(0, csr::MIE, 8).build(),      //  4: mie |= x8
+        b().sd(5, 6, 0).build(),                //  8: mtimecmp = x6
+        b().csrrsi(0, csr::MSTATUS, 8).build(), // 12: set mstatus.MIE
+        b().addi(9, 9, 1).build(),              // 16: loop: x9 += 1
+        b().ld(13, 11, 0).build(),              // 20
+        b().add(13, 13, 9).build(),             // 24
+        b().sd(11, 13, 0).build(),              // 28: mem[DATA] += x9
+        b().bne(9, 10, -16).build(),            // 32: until x9 == x10
+        b().jal(0, 0).build(),                  // 36: spin
+    ];
+    let handler = vec![
+        b().addi(14, 14, 1).build(), // x14 += 1
+        b().add(6, 6, 7).build(),    // x6 += 37
+        b().sd(5, 6, 0).build(),     // mtimecmp = x6
+        MRET,
+    ];
+    vec![(RAM_BASE, main), (HANDLER, handler)]
+}
+
+/// Patches its own hot loop after 100 iterations, without a `fence.i`.
+///
+/// The first 100 passes add 1 to x15, the remaining 200 add 2: x15 = 500.
+fn self_modifying_loop() -> Vec<(u64, Vec<u32>)> {
+    let b = InstructionBuilder::new;
+    let main = vec![
+        b().addi(15, 15, 1).build(), //  0: loop: patched to x15 += 2
+        b().addi(9, 9, 1).build(),   //  4
+        b().bne(9, 16, 8).build(),   //  8: skip the patch unless x9 == 100
+        b().sw(18, 17, 0).build(),   // 12: mem[loop] = x17
+        b().bne(9, 10, -16).build(), // 16: until x9 == 300
+        b().jal(0, 0).build(),       // 20: spin
+    ];
+    vec![(RAM_BASE, main)]
+}
+
+fn functional(dbt: bool) -> Config {
+    let mut config = Config::default();
+    config.general.direct_mode = false;
+    config.general.fast_forward.enabled = true;
+    config.general.fast_forward.dbt = dbt;
+    config
+}
+
+fn interrupted(config: &Config) -> Simulator {
+    let regs =
+        [(5, MTIMECMP), (6, 37), (7, 37), (8, 1 << 7), (10, 2_000), (11, DATA), (12, HANDLER)];
+    system_sim(config, &interrupted_loop(), &regs)
+}
+
+/// Every `SimStats` counter except the I-TLB ones, rendered for comparison.
+///
+/// The host start time is dropped; the tier does one fetch translation per
+/// block, so I-TLB lookups legitimately differ.
+fn block_counters(sim: &Simulator) -> String {
+    let mut stats = sim.cpu.stats.clone();
+    stats.itlb_hits = 0;
+    stats.itlb_misses = 0;
+    counters(&stats)
+}
+
+fn assert_same_state(translated: &mut Simulator, interpreted: &mut Simulator) {
+    assert_eq!(block_counters(translated), block_counters(interpreted));
+    assert_eq!(translated.cpu.pc, interpreted.cpu.pc);
+    for reg in 0..32u8 {
+        let reg = RegIdx::new(reg);
+        assert_eq!(translated.cpu.regs.read(reg), interpreted.cpu.regs.read(reg), "{reg:?}");
+    }
+    for addr in [DATA, MTIME] {
+        let addr = PhysAddr::new(addr);
+        assert_eq!(translated.cpu.bus.bus.read_u64(addr), interpreted.cpu.bus.bus.read_u64(addr));
+    }
+}
+
+#[test]
+fn translated_blocks_match_interpreter_across_interrupts() {
+    let mut interpreted = interrupted(&functional(false));
+    let mut translated = interrupted(&functional(true));
+    assert_eq!(interpreted.run(20_000).unwrap(), None);
+    assert_eq!(translated.run(20_000).unwrap(), None);
+
+    assert_eq!(translated.cpu.regs.read(RegIdx::new(9)), 2_000, "loop finished");
+    assert_eq!(translated.cpu.bus.bus.read_u64(PhysAddr::new(DATA)), 2_000 * 2_001 / 2);
+    assert!(translated.cpu.regs.read(RegIdx::new(14)) > 10, "timer interrupts were taken");
+    assert!(translated.cpu.blocks.translated() > 0);
+    assert_eq!(interpreted.cpu.blocks.translated(), 0);
+    assert_same_state(&mut translated, &mut interpreted);
+}
+
+#[test]
+fn self_modifying_store_retranslates_block() {
+    let patched = InstructionBuilder::new().addi(15, 15, 2).build();
+    let regs = [(10, 300), (16, 100), (17, u64::from(patched)), (18, RAM_BASE)];
+    let mut interpreted = system_sim(&functional(false), &self_modifying_loop(), &regs);
+    let mut translated = system_sim(&functional(true), &self_modifying_loop(), &regs);
+    assert_eq!(interpreted.run(5_000).unwrap(), None);
+    assert_eq!(translated.run(5_000).unwrap(), None);
+
+    assert_eq!(translated.cpu.regs.read(RegIdx::new(15)), 500);
+    assert!(translated.cpu.blocks.translated() > translated.cpu.blocks.block_count() as u64);
+    assert_same_state(&mut translated, &mut interpreted);
+}
+
+#[test]
+fn switchover_happens_at_the_same_instruction() {
+    let config = |dbt| {
+        let mut config = functional(dbt);
+        config.general.fast_forward.until_instructions = Some(3_001);
+        config
+    };
+    let mut interpreted = interrupted(&config(false));
+    let mut translated = interrupted(&config(true));
+    assert_eq!(interpreted.run(20_000).unwrap(), None);
+    assert_eq!(translated.run(20_000).unwrap(), None);
+
+    assert_eq!(translated.mode, ExecMode::Detailed);
+    assert_same_state(&mut translated, &mut interpreted);
+}
+
+#[test]
+fn batch_instruction_limit_is_exact() {
+    let mut sim = interrupted(&functional(true));
+    let stop = AtomicBool::new(false);
+    let limits = RunLimits { cycles: None, instructions: Some(4_321) };
+    assert_eq!(sim.run_batch(limits, &stop).unwrap(), BatchExit::Limit);
+    assert_eq!(sim.cpu.stats.instructions_retired, 4_321);
+    assert!(sim.cpu.blocks.translated() > 0);
+}
@@ -0,0 +1,224 @@
+//! # Functional Fast-Forward Tests
+//!
+//! Verifies that the functional engine produces the same architectural
+//! state as the detailed pipeline and that each switchover trigger
+//! (PC, instruction count, marker CSR) hands control to the pipeline.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{DATA, RAM_BASE, TestContext};
+use rvsim_core::common::PhysAddr;
+use rvsim_core::config::{Config, FastForwardConfig};
+use rvsim_core::core::arch::csr::CSR_SIM_MARKER;
+use rvsim_core::sim::simulator::ExecMode;
+
+/// Sums 10..=1 in a loop, stores/reloads the result, then spins.
+///
+/// Final state: x2 = 55, x3 = 55, x4 = 56, mem[DATA] = 55.
+fn sum_program() -> Vec<u32> {
+    vec![
+        InstructionBuilder::new().addi(1, 0, 10).build(), //  0: x1 = 10
+        InstructionBuilder::new().addi(2, 0, 0).build(),  //  4: x2 = 0
+        InstructionBuilder::new().add(2, 2, 1).build(),   //  8: loop: x2 += x1
+        InstructionBuilder::new().addi(1, 1, -1).build(), // 12: x1 -= 1
+        InstructionBuilder::new().bne(1, 0, -8).build(),  // 16: bne x1, x0, loop
+        InstructionBuilder::new().sd(5, 2, 0).build(),    // 20: mem[x5] = x2
+        InstructionBuilder::new().ld(3, 5, 0).build(),    // 24: x3 = mem[x5]
+        InstructionBuilder::new().addi(4, 3, 1).build(),  // 28: x4 = x3 + 1
+        InstructionBuilder::new().jal(0, 0).build(),      // 32: spin
+    ]
+}
+
+fn ctx(fast_forward: FastForwardConfig, program: &[u32]) -> TestContext {
+    let mut config = Config::default();
+    config.general.fast_forward = fast_forward;
+    ctx_with(&config, program)
+}
+
+fn ctx_with(config: &Config, program: &[u32]) -> TestContext {
+    let mut tc = TestContext::with_program(config, program);
+    tc.set_reg(5, DATA);
+    tc
+}
+
+fn assert_sum_result(tc: &mut TestContext) {
+    assert_eq!(tc.get_reg(1), 0);
+    assert_eq!(tc.get_reg(2), 55);
+    assert_eq!(tc.get_reg(3), 55);
+    assert_eq!(tc.get_reg(4), 56);
+    assert_eq!(tc.cpu_mut().bus.bus.read_u64(PhysAddr::new(DATA)), 55);
+}
+
+#[test]
+fn default_config_runs_detailed() {
+    let tc = ctx(FastForwardConfig::default(), &sum_program());
+    assert_eq!(tc.sim.mode, ExecMode::Detailed);
+}
+
+#[test]
+fn functional_without_trigger_stays_functional() {
+    let ff = FastForwardConfig { enabled: true, ..FastForwardConfig::default() };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(100);
+
+    assert_eq!(tc.sim.mode, ExecMode::Functional);
+    assert_sum_result(&mut tc);
+    // 2 setup + 10 * 3 loop + 3 tail instructions before the spin.
+    assert!(tc.cpu().stats.instructions_retired >= 35);
+}
+
+#[test]
+fn functional_retires_one_instruction_per_cycle() {
+    let ff = FastForwardConfig { enabled: true, ..FastForwardConfig::default() };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(10);
+
+    assert_eq!(tc.cpu().stats.cycles, 10);
+    assert_eq!(tc.cpu().stats.instructions_retired, 10);
+}
+
+#[test]
+fn functional_matches_detailed() {
+    let mut detailed = ctx(FastForwardConfig::default(), &sum_program());
+    let ff = FastForwardConfig { enabled: true, ..FastForwardConfig::default() };
+    let mut functional = ctx(ff, &sum_program());
+
+    detailed.run(400);
+    functional.run(400);
+
+    assert_sum_result(&mut detailed);
+    for reg in 0..32 {
+        assert_eq!(detailed.get_reg(reg), functional.get_reg(reg), "x{reg} differs");
+    }
+}
+
+#[test]
+fn switches_to_detailed_at_pc() {
+    let ff = FastForwardConfig {
+        enabled: true,
+        until_pc: Some(RAM_BASE + 20),
+        ..FastForwardConfig::default()
+    };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(400);
+
+    assert_eq!(tc.sim.mode, ExecMode::Detailed);
+    assert_sum_result(&mut tc);
+}
+
+#[test]
+fn switches_to_detailed_after_instruction_count() {
+    let ff = FastForwardConfig {
+        enabled: true,
+        until_instructions: Some(5),
+        ..FastForwardConfig::default()
+    };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(5);
+    assert_eq!(tc.sim.mode, ExecMode::Functional);
+    assert_eq!(tc.cpu().stats.instructions_retired, 5);
+
+    tc.run(400);
+    assert_eq!(tc.sim.mode, ExecMode::Detailed);
+    assert_sum_result(&mut tc);
+}
+
+#[test]
+fn switches_to_detailed_on_marker_write() {
+    // Insert the marker write after the first setup instruction.
+    let mut program = sum_program();
+    program.insert(1, InstructionBuilder::new().csrrwi(0, CSR_SIM_MARKER, 1).build());
+
+    let ff =
+        FastForwardConfig { enabled: true, until_marker: true, ..FastForwardConfig::default() };
+    let mut tc = ctx(ff, &program);
+
+    tc.run(2);
+    assert_eq!(tc.sim.mode, ExecMode::Functional);
+    assert_eq!(tc.cpu().sim_marker, Some(1));
+
+    tc.run(1);
+    assert_eq!(tc.sim.mode, ExecMode::Detailed);
+    assert!(tc.cpu().sim_marker.is_none());
+
+    tc.run(400);
+    assert_sum_result(&mut tc);
+}
+
+/// Functional mode with L1I/L1D enabled.
+fn cached_config(warm: bool) -> Config {
+    let mut config = Config::default();
+    config.general.fast_forward =
+        FastForwardConfig { enabled: true, warm, ..FastForwardConfig::default() };
+    config.cache.l1_i.enabled = true;
+    config.cache.l1_d.enabled = true;
+    config
+}
+
+#[test]
+fn functional_warming_trains_caches() {
+    let mut tc = ctx_with(&cached_config(true), &sum_program());
+    tc.cpu_mut().cache_base = RAM_BASE;
+
+    tc.run(100);
+
+    let stats = &tc.cpu().stats;
+    assert!(stats.icache_hits + stats.icache_misses > 0);
+    assert!(stats.dcache_hits + stats.dcache_misses > 0);
+    assert!(tc.cpu().l1_i_cache.contains(RAM_BASE));
+    assert!(tc.cpu().l1_d_cache.contains(DATA));
+    assert_sum_result(&mut tc);
+}
+
+#[test]
+fn functional_without_warming_leaves_caches_cold() {
+    let mut tc = ctx_with(&cached_config(false), &sum_program());
+    tc.cpu_mut().cache_base = RAM_BASE;
+
+    tc.run(100);
+
+    let stats = &tc.cpu().stats;
+    assert_eq!(stats.icache_hits + stats.icache_misses, 0);
+    assert_eq!(stats.dcache_hits + stats.dcache_misses, 0);
+}
+
+#[test]
+fn functional_warming_trains_branch_predictor() {
+    use rvsim_core::core::units::bru::BranchPredictor;
+
+    let ff = FastForwardConfig { enabled: true, warm: true, ..FastForwardConfig::default() };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(100);
+
+    // The loop-closing BNE at +16 was taken nine times.
+    assert_eq!(tc.cpu().branch_predictor.predict_btb(RAM_BASE + 16), Some(RAM_BASE + 8));
+    // The spin JAL at +32 was learned by the BTB.
+    assert_eq!(tc.cpu().branch_predictor.predict_btb(RAM_BASE + 32), Some(RAM_BASE + 32));
+}
+
+#[test]
+fn functional_collects_basic_block_vectors() {
+    let ff =
+        FastForwardConfig { enabled: true, bbv_interval: Some(10), ..FastForwardConfig::default() };
+    let mut tc = ctx(ff, &sum_program());
+
+    tc.run(100);
+
+    let retired = tc.cpu().stats.instructions_retired;
+    let bbv = tc.sim.bbv.as_mut().unwrap();
+    bbv.flush();
+    // Block 1 = setup + first iteration (5), block 2 = loop body from +8 (3 each).
+    assert_eq!(bbv.intervals()[0], vec![(1, 5), (2, 6)]);
+    let total: u64 = bbv.intervals().iter().flatten().map(|&(_, n)| n).sum();
+    assert_eq!(total, retired);
+}
+
+#[test]
+fn detailed_run_has_no_bbv_profiler() {
+    let tc = ctx(FastForwardConfig::default(), &sum_program());
+    assert!(tc.sim.bbv.is_none());
+}
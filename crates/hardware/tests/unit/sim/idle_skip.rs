@@ -0,0 +1,104 @@
+//! # WFI Idle-Skip Tests
+//!
+//! Verifies that skipping WFI idle time to the next device event leaves
+//! every counter, `mtime`, and the architectural state exactly as ticking
+//! through it would, on both backends and in the functional engine.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{MTIME, MTIMECMP, RAM_BASE, counters, system_sim};
+use rvsim_core::Simulator;
+use rvsim_core::common::{PhysAddr, RegIdx};
+use rvsim_core::config::Config;
+use rvsim_core::core::arch::csr;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::isa::privileged::opcodes::WFI;
+
+/// Sleeps on the machine timer five times, 40 `mtime` ticks apart, then spins.
+///
+/// Interrupts stay globally disabled (`mstatus.MIE` = 0), so each timer
+/// wakes the WFI without trapping.
+fn sleep_program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().csrrs(0, csr::MIE, 8).build(), //  0: mie |= x8
+        b().sd(5, 6, 0).build(),           //  4: loop: mtimecmp = x6
+        WFI,                               //  8
+        b().add(6, 6, 7).build(),          // 12: x6 += 40
+        b().addi(9, 9, 1).build(),         // 16: x9 += 1
+        b().bne(9, 10, -16).build(),       // 20: until x9 == 5
+        b().jal(0, 0).build(),             // 24: spin
+    ]
+}
+
+fn sim(backend: BackendType, fast_forward: bool, idle_skip: bool) -> Simulator {
+    let mut config = Config::default();
+    config.pipeline.backend = backend;
+    config.general.fast_forward.enabled = fast_forward;
+    config.general.idle_skip = idle_skip;
+    let regs = [(5, MTIMECMP), (6, 40), (7, 40), (8, 1 << 7), (10, 5)];
+    system_sim(&config, &[(RAM_BASE, sleep_program())], &regs)
+}
+
+fn mtime(sim: &mut Simulator) -> u64 {
+    sim.cpu.bus.bus.read_u64(PhysAddr::new(MTIME))
+}
+
+fn assert_skip_matches_ticking(backend: BackendType, fast_forward: bool) {
+    let mut ticked = sim(backend, fast_forward, false);
+    let mut skipped = sim(backend, fast_forward, true);
+    assert_eq!(ticked.run(3_000).unwrap(), None);
+    assert_eq!(skipped.run(3_000).unwrap(), None);
+
+    assert_eq!(skipped.cpu.regs.read(RegIdx::new(9)), 5, "all five sleeps completed");
+    assert!(skipped.cpu.stats.cycles_wfi > 1_000);
+    assert_eq!(counters(&skipped.cpu.stats), counters(&ticked.cpu.stats));
+    assert_eq!(skipped.cpu.pc, ticked.cpu.pc);
+    assert_eq!(mtime(&mut skipped), mtime(&mut ticked));
+}
+
+#[test]
+fn in_order_skip_matches_ticking() {
+    assert_skip_matches_ticking(BackendType::InOrder, false);
+}
+
+#[test]
+fn out_of_order_skip_matches_ticking() {
+    assert_skip_matches_ticking(BackendType::OutOfOrder, false);
+}
+
+#[test]
+fn functional_skip_matches_ticking() {
+    assert_skip_matches_ticking(BackendType::InOrder, true);
+}
+
+#[test]
+fn sleep_takes_a_handful_of_real_ticks() {
+    for (backend, fast_forward) in [
+        (BackendType::InOrder, true),
+        (BackendType::InOrder, false),
+        (BackendType::OutOfOrder, false),
+    ] {
+        let mut sim = sim(backend, fast_forward, true);
+        let mut ticks = 0;
+        while sim.cpu.regs.read(RegIdx::new(9)) < 2 {
+            sim.tick().unwrap();
+            ticks += 1;
+            let _ = sim.skip_idle(u64::MAX);
+        }
+        // 800 cycles asleep: only the UART stdin polls, the timer deadlines,
+        // and the instructions around them are simulated.
+        assert!(sim.cpu.stats.cycles_wfi > 700, "{backend:?}");
+        assert!(ticks < 150, "{backend:?}: {ticks} ticks");
+        assert_eq!(mtime(&mut sim), sim.cpu.stats.cycles / 10);
+    }
+}
+
+#[test]
+fn disabled_skip_does_nothing() {
+    let mut sim = sim(BackendType::InOrder, true, false);
+    while !sim.cpu.wfi_waiting {
+        sim.tick().unwrap();
+    }
+    sim.tick().unwrap();
+    assert_eq!(sim.skip_idle(u64::MAX), 0);
+}
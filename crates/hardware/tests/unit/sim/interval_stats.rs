@@ -0,0 +1,45 @@
+//! # Interval Statistics Tests
+//!
+//! Verifies that interval rows recorded from a running simulation sum back
+//! to the counters of the whole run and stamp each interval's end cycle.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::TestContext;
+use rvsim_core::config::Config;
+use rvsim_core::sim::interval_stats::{IntervalStatsWriter, IntervalTable};
+use rvsim_core::sim::simulator::RunLimits;
+use rvsim_core::stats::SimStats;
+use std::sync::atomic::AtomicBool;
+
+#[test]
+fn interval_rows_sum_to_the_run() {
+    let b = InstructionBuilder::new;
+    let program = [b().addi(1, 1, 1).build(), b().jal(0, -4).build()];
+    let mut tc = TestContext::with_program(&Config::default(), &program);
+    let stop = AtomicBool::new(false);
+    let limits = RunLimits { cycles: Some(1_000), instructions: None };
+    let _ = tc.sim.run_batch(limits, &stop).unwrap();
+    let start = tc.sim.cpu.stats.clone();
+
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("run.ist").display().to_string();
+    let mut writer = IntervalStatsWriter::create(&path, &start).unwrap();
+    for _ in 0..5 {
+        let _ = tc.sim.run_batch(limits, &stop).unwrap();
+        writer.record(&tc.sim.cpu.stats).unwrap();
+    }
+    assert_eq!(writer.rows(), 5);
+    let _ = writer.finish().unwrap();
+
+    let table = IntervalTable::open(&path).unwrap();
+    assert_eq!(table.len(), 5);
+    let end = &tc.sim.cpu.stats;
+    let cycles: Vec<u64> = (1..=5).map(|i| start.cycles + i * 1_000).collect();
+    assert_eq!(table.column("cycle"), Some(cycles));
+    let run = end.since(&start).counters();
+    for (name, total) in SimStats::COUNTERS.iter().zip(run) {
+        let sum: u64 = table.column(name).unwrap().iter().sum();
+        assert_eq!(sum, total, "{name}");
+    }
+    assert!(run[1] > 0, "instructions retired while recording");
+}
@@ -1,7 +1,45 @@
 //! # Simulation Unit Tests
 //!
 //! This module contains unit tests for simulation-related functionality,
-//! including binary loading and system initialization.
+//! including binary loading, system initialization, functional
+//! fast-forward and its translated-block tier, multi-hart execution,
+//! checkpoint validation, the batch run loop, WFI idle skipping,
+//! region-of-interest markers, streaming interval statistics, cache-only
+//! memory-trace replay, branch-trace replay, and the batched test-suite
+//! runner.
 
 /// Tests for binary loader and kernel setup.
 pub mod loader;
+
+/// Tests for functional fast-forward and switchover to the detailed pipeline.
+pub mod fast_forward;
+
+/// Tests for the functional engine's translated-block tier.
+pub mod dbt;
+
+/// Tests for multi-hart (SMP) systems.
+pub mod smp;
+
+/// Tests for rejecting corrupt checkpoints.
+pub mod checkpoint;
+
+/// Tests for the batch run loop and its stop flag.
+pub mod batch;
+
+/// Tests for skipping WFI idle time to the next device event.
+pub mod idle_skip;
+
+/// Tests for the guest's region-of-interest markers.
+pub mod roi;
+
+/// Tests for capturing memory-access traces and replaying them.
+pub mod replay;
+
+/// Tests for capturing branch traces and replaying them against predictors.
+pub mod branch_replay;
+
+/// Tests for streaming interval statistics to a file.
+pub mod interval_stats;
+
+/// Tests for the batched, in-process test-suite runner.
+pub mod suite;
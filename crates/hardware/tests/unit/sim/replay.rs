@@ -0,0 +1,166 @@
+//! # Memory-Trace Replay Tests
+//!
+//! Verifies that a memory-access trace captured from a full run replays
+//! through the cache hierarchy alone with the same cache counters, for
+//! blocking and MSHR-backed in-order configs and across a functional-warming
+//! switchover, that a different geometry replays to its own counters, and
+//! that one replay profiles the stack distances of every geometry.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, system_sim};
+use rvsim_core::Simulator;
+use rvsim_core::common::RegIdx;
+use rvsim_core::config::{Config, Prefetcher};
+use rvsim_core::sim::replay::replay_mem_trace;
+use rvsim_core::stats::SimStats;
+
+const DATA: u64 = RAM_BASE + 0x1_0000;
+const ARRAY_BYTES: u64 = 4096;
+
+/// Three passes of a read-modify-write sweep over a 4 KiB array.
+fn sweep_program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().addi(5, 10, 0).build(),  //  0: outer: p = DATA
+        b().ld(8, 5, 0).build(),     //  4: inner: x8 = *p
+        b().add(9, 9, 8).build(),    //  8
+        b().sd(5, 9, 0).build(),     // 12: *p = x9
+        b().addi(5, 5, 8).build(),   // 16
+        b().bne(5, 6, -16).build(),  // 20: until p == DATA + 4 KiB
+        b().addi(7, 7, 1).build(),   // 24
+        b().bne(7, 11, -28).build(), // 28: until x7 == 3
+        b().jal(0, 0).build(),       // 32: spin
+    ]
+}
+
+/// In-order pipeline with a 1 KiB L1D, an 8 KiB L2 with a next-line
+/// prefetcher, and `mshrs` L1D MSHRs.
+fn config(mshrs: usize) -> Config {
+    let mut config = Config::default();
+    let cache = &mut config.cache;
+    cache.l1_i.enabled = true;
+    cache.l1_i.size_bytes = 4096;
+    cache.l1_d.enabled = true;
+    cache.l1_d.size_bytes = 1024;
+    cache.l1_d.ways = 2;
+    cache.l1_d.mshr_count = mshrs;
+    cache.l2.enabled = true;
+    cache.l2.size_bytes = 8192;
+    cache.l2.ways = 4;
+    cache.l2.latency = 8;
+    cache.l2.prefetcher = Prefetcher::NextLine;
+    config
+}
+
+fn sim(config: &Config) -> Simulator {
+    let regs = [(10, DATA), (6, DATA + ARRAY_BYTES), (11, 3)];
+    system_sim(config, &[(RAM_BASE, sweep_program())], &regs)
+}
+
+/// Runs the sweep to completion while capturing its trace to `path`.
+fn capture(config: &Config, path: &str) -> SimStats {
+    let mut sim = sim(config);
+    sim.cpu.open_mem_trace(path).unwrap();
+    assert_eq!(sim.run(60_000).unwrap(), None);
+    assert_eq!(sim.cpu.regs.read(RegIdx::new(7)), 3, "the sweep finished");
+    assert!(sim.cpu.close_mem_trace().unwrap() > 3 * 512);
+    sim.cpu.stats.clone()
+}
+
+fn cache_counters(s: &SimStats) -> [(&'static str, u64); 15] {
+    [
+        ("icache_hits", s.icache_hits),
+        ("icache_misses", s.icache_misses),
+        ("dcache_hits", s.dcache_hits),
+        ("dcache_misses", s.dcache_misses),
+        ("l2_hits", s.l2_hits),
+        ("l2_misses", s.l2_misses),
+        ("l3_hits", s.l3_hits),
+        ("l3_misses", s.l3_misses),
+        ("mshr_allocations", s.mshr_allocations),
+        ("mshr_coalesces", s.mshr_coalesces),
+        ("inclusion_back_invalidations", s.inclusion_back_invalidations),
+        ("exclusive_l1_to_l2_swaps", s.exclusive_l1_to_l2_swaps),
+        ("pf_dedup_l1", s.pf_dedup_l1),
+        ("pf_dedup_l2", s.pf_dedup_l2),
+        ("pf_dedup_l3", s.pf_dedup_l3),
+    ]
+}
+
+fn assert_replay_matches(config: &Config) {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("sweep.mtr").display().to_string();
+    let full = capture(config, &path);
+    let replayed = replay_mem_trace(config, &path).unwrap();
+
+    assert!(full.dcache_misses > 0 && full.l2_hits > 0, "the sweep exercised the hierarchy");
+    assert_eq!(cache_counters(&replayed), cache_counters(&full));
+    assert_eq!(replayed.instructions_retired, 0, "nothing was executed");
+}
+
+#[test]
+fn replay_matches_blocking_in_order_run() {
+    assert_replay_matches(&config(0));
+}
+
+#[test]
+fn replay_matches_mshr_in_order_run() {
+    let config = config(4);
+    assert_replay_matches(&config);
+}
+
+#[test]
+fn replay_matches_run_with_functional_warming() {
+    let mut config = config(4);
+    config.general.fast_forward.enabled = true;
+    config.general.fast_forward.warm = true;
+    config.general.fast_forward.until_instructions = Some(2_000);
+    assert_replay_matches(&config);
+}
+
+#[test]
+fn replay_under_another_geometry() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("sweep.mtr").display().to_string();
+    let small = config(4);
+    let full = capture(&small, &path);
+
+    let mut large = small.clone();
+    large.cache.l1_d.size_bytes = 8192;
+    let replayed = replay_mem_trace(&large, &path).unwrap();
+    assert_eq!(
+        replayed.dcache_hits + replayed.dcache_misses,
+        full.dcache_hits + full.dcache_misses,
+        "the same accesses were replayed"
+    );
+    assert!(replayed.dcache_misses < full.dcache_misses / 2, "the array fits in 8 KiB");
+}
+
+#[test]
+fn replay_rejects_a_non_trace_file() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("not-a-trace");
+    std::fs::write(&path, b"RVSIMCKP\x02\0\0\0").unwrap();
+    let err = replay_mem_trace(&config(0), &path.display().to_string()).unwrap_err();
+    assert!(err.to_string().contains("not an rvsim memory trace"), "{err}");
+}
+
+#[test]
+fn replay_profiles_stack_distances_in_one_pass() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("sweep.mtr").display().to_string();
+    let mut config = config(0);
+    config.cache.stack_distance.enabled = true;
+    config.cache.stack_distance.max_sets = 64;
+    config.cache.stack_distance.max_ways = 8;
+    let full = capture(&config, &path);
+    let replayed = replay_mem_trace(&config, &path).unwrap();
+
+    assert_eq!(replayed.stack_distance, full.stack_distance);
+    let sd = &replayed.stack_distance;
+    // The 1 KiB, 2-way L1D has eight sets of 64-byte lines.
+    assert_eq!(sd.accesses(8), Some(full.dcache_hits + full.dcache_misses));
+    assert_eq!(sd.hits(8, 2), Some(full.dcache_hits));
+    // The 4 KiB array fits in 64 lines: only its cold misses remain.
+    assert_eq!(sd.accesses(8).unwrap() - sd.hits(8, 8).unwrap(), ARRAY_BYTES / 64);
+}
@@ -0,0 +1,159 @@
+//! # Region-of-Interest Tests
+//!
+//! Verifies that the `roi_begin`/`roi_end` markers from `bench.h` scope and
+//! freeze the reported statistics without disturbing the machine clock or
+//! run limits, move the region into the detailed pipeline and back, and
+//! save a checkpoint.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, system_sim};
+use rvsim_core::Simulator;
+use rvsim_core::common::{PhysAddr, RegIdx};
+use rvsim_core::config::Config;
+use rvsim_core::core::arch::csr::CSR_SIM_MARKER;
+use rvsim_core::sim::simulator::{BatchExit, ExecMode, RunLimits};
+use rvsim_core::soc::System;
+use std::sync::atomic::AtomicBool;
+use std::time::Duration;
+
+const DATA: u64 = RAM_BASE + 0x800;
+
+/// `csrrwi x0, 0x8FE, imm` — write `imm` to the simulation marker CSR.
+fn marker(imm: u32) -> u32 {
+    InstructionBuilder::new().csrrwi(0, CSR_SIM_MARKER, imm).build()
+}
+
+/// Instructions retired from just after `roi_begin` through `roi_end`.
+const ROI_INSTRUCTIONS: u64 = 10 * 3 + 1;
+
+/// Three setup instructions, a ten-pass store loop inside the ROI, then two
+/// more before spinning.
+///
+/// Final state: x1 = 2, x7 = 10, x3 = 2, mem[DATA] = 10.
+fn roi_program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().addi(1, 0, 0).build(), //  0
+        b().addi(1, 1, 1).build(), //  4
+        b().addi(1, 1, 1).build(), //  8
+        marker(1),                 // 12: roi_begin()
+        b().addi(7, 7, 1).build(), // 16: loop: x7 += 1
+        b().sd(5, 7, 0).build(),   // 20: mem[DATA] = x7
+        b().bne(7, 6, -8).build(), // 24: until x7 == 10
+        marker(2),                 // 28: roi_end()
+        b().addi(3, 0, 1).build(), // 32
+        b().addi(3, 3, 1).build(), // 36
+        b().jal(0, 0).build(),     // 40: spin
+    ]
+}
+
+fn sim(config: &Config) -> Simulator {
+    system_sim(config, &[(RAM_BASE, roi_program())], &[(5, DATA), (6, 10)])
+}
+
+fn config(fast_forward: bool) -> Config {
+    let mut config = Config::default();
+    config.general.fast_forward.enabled = fast_forward;
+    config.general.roi.stats = true;
+    config
+}
+
+fn assert_program_finished(sim: &mut Simulator) {
+    for (reg, val) in [(1, 2), (7, 10), (3, 2)] {
+        assert_eq!(sim.cpu.regs.read(RegIdx::new(reg)), val, "x{reg}");
+    }
+    assert_eq!(sim.cpu.bus.bus.read_u64(PhysAddr::new(DATA)), 10);
+}
+
+#[test]
+fn stats_cover_only_the_region() {
+    for fast_forward in [false, true] {
+        let mut sim = sim(&config(fast_forward));
+        assert_eq!(sim.run(2_000).unwrap(), None);
+
+        assert_program_finished(&mut sim);
+        let roi = sim.stats();
+        assert_eq!(roi.instructions_retired, ROI_INSTRUCTIONS, "fast_forward={fast_forward}");
+        assert_eq!(roi.inst_store, 10);
+        assert_eq!(roi.inst_system, 1, "only roi_end, not roi_begin");
+        // The live counters, and with them the clock, were never reset.
+        assert!(sim.cpu.stats.instructions_retired > 4 + ROI_INSTRUCTIONS + 2);
+        assert_eq!(sim.cpu.stats.cycles, 2_000);
+    }
+}
+
+#[test]
+fn host_time_covers_only_the_region() {
+    let mut sim = sim(&config(false));
+    // Host time spent before `roi_begin` must not count towards the region.
+    std::thread::sleep(Duration::from_millis(20));
+    assert_eq!(sim.run(2_000).unwrap(), None);
+
+    let roi = sim.stats().elapsed();
+    assert!(roi < sim.cpu.stats.elapsed(), "ROI {roi:?} vs run {:?}", sim.cpu.stats.elapsed());
+    assert!(roi < Duration::from_millis(20), "ROI {roi:?} includes time before roi_begin");
+    // The region's clock stopped at `roi_end`.
+    std::thread::sleep(Duration::from_millis(5));
+    assert_eq!(sim.stats().elapsed(), roi);
+}
+
+#[test]
+fn region_runs_in_the_detailed_pipeline() {
+    let mut config = config(true);
+    config.general.roi.detailed = true;
+    let mut sim = sim(&config);
+
+    while sim.cpu.pc != RAM_BASE + 16 {
+        sim.tick().unwrap();
+    }
+    assert_eq!(sim.mode, ExecMode::Detailed);
+    assert_eq!(sim.stats().instructions_retired, 0);
+
+    assert_eq!(sim.run(2_000).unwrap(), None);
+    assert_eq!(sim.mode, ExecMode::Functional);
+    assert_program_finished(&mut sim);
+    let roi = sim.stats();
+    assert_eq!(roi.instructions_retired, ROI_INSTRUCTIONS);
+    assert!(roi.cycles > roi.instructions_retired, "the ROI was timed by the pipeline");
+}
+
+#[test]
+fn roi_begin_saves_a_checkpoint() {
+    let dir = tempfile::tempdir().unwrap();
+    let path = dir.path().join("roi.ckpt");
+    let mut config = Config::default();
+    config.general.fast_forward.enabled = true;
+    config.general.roi.checkpoint = Some(path.display().to_string());
+    let mut sim = sim(&config);
+    assert_eq!(sim.run(2_000).unwrap(), None);
+    assert_program_finished(&mut sim);
+
+    let mut resumed = Simulator::new(System::new(&config, ""), &Config::default());
+    resumed.restore_checkpoint(&path).unwrap();
+    assert_eq!(resumed.cpu.pc, RAM_BASE + 16, "resumes inside the ROI");
+    assert_eq!(resumed.cpu.regs.read(RegIdx::new(1)), 2);
+    assert_eq!(resumed.cpu.regs.read(RegIdx::new(7)), 0);
+    assert_eq!(resumed.run(2_000).unwrap(), None);
+    assert_program_finished(&mut resumed);
+}
+
+#[test]
+fn markers_are_left_alone_without_roi_options() {
+    let mut sim = sim(&Config::default());
+    assert_eq!(sim.run(2_000).unwrap(), None);
+
+    assert_program_finished(&mut sim);
+    assert_eq!(sim.cpu.sim_marker, Some(2));
+    assert_eq!(sim.stats().instructions_retired, sim.cpu.stats.instructions_retired);
+}
+
+#[test]
+fn instruction_limits_count_from_the_start() {
+    let mut sim = sim(&config(true));
+    let stop = AtomicBool::new(false);
+    let limits = RunLimits { cycles: None, instructions: Some(20) };
+    assert_eq!(sim.run_batch(limits, &stop).unwrap(), BatchExit::Limit);
+
+    assert_eq!(sim.cpu.stats.instructions_retired, 20);
+    assert_eq!(sim.stats().instructions_retired, 16);
+}
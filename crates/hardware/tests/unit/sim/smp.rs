@@ -0,0 +1,129 @@
+//! # Multi-Hart (SMP) Tests
+//!
+//! Verifies that secondary harts boot from hart 0's state with their own
+//! hart id, that atomics on shared memory are not lost between harts in
+//! both the lockstep and threaded run loops, that contended lines move
+//! between the harts' private caches through the coherence directory, and
+//! that the generated device tree describes every hart.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, system_sim};
+use rvsim_core::common::{PhysAddr, RegIdx};
+use rvsim_core::config::Config;
+use rvsim_core::core::arch::csr;
+use rvsim_core::sim::dtb::generate_dtb;
+use rvsim_core::sim::simulator::Simulator;
+use rvsim_core::soc::System;
+
+const COUNTER: u64 = RAM_BASE + 0x1000;
+const ITERATIONS: i32 = 10;
+
+/// Each hart adds 2 to the shared counter `ITERATIONS` times: once with an
+/// AMO and once with an LR/SC retry loop. x5 = counter address, x6 = 1.
+fn program() -> Vec<u32> {
+    let b = InstructionBuilder::new;
+    vec![
+        b().csrrs(11, csr::MHARTID, 0).build(), //  0: x11 = mhartid
+        b().addi(7, 0, ITERATIONS).build(),     //  4: x7 = iterations
+        b().amoadd_d(0, 5, 6).build(),          //  8: outer: amoadd.d x0, x6, (x5)
+        b().lr_d(28, 5).build(),                // 12: retry: lr.d x28, (x5)
+        b().addi(28, 28, 1).build(),            // 16
+        b().sc_d(29, 5, 28).build(),            // 20: sc.d x29, x28, (x5)
+        b().bne(29, 0, -12).build(),            // 24: bne x29, x0, retry
+        b().addi(7, 7, -1).build(),             // 28
+        b().bne(7, 0, -24).build(),             // 32: bne x7, x0, outer
+        b().jal(0, 0).build(),                  // 36: spin
+    ]
+}
+
+fn smp_config(harts: usize) -> Config {
+    let mut config = Config::default();
+    config.system.harts = harts;
+    config.memory.ram_size = 0x10_0000;
+    config
+}
+
+fn smp_sim(harts: usize) -> Simulator {
+    smp_sim_with(&smp_config(harts))
+}
+
+fn smp_sim_with(config: &Config) -> Simulator {
+    system_sim(config, &[(RAM_BASE, program())], &[(5, COUNTER), (6, 1)])
+}
+
+fn counter(sim: &mut Simulator) -> u64 {
+    sim.cpu.bus.bus.read_u64(PhysAddr::new(COUNTER))
+}
+
+#[test]
+fn single_hart_system_has_no_secondaries() {
+    let config = smp_config(1);
+    let sim = Simulator::new(System::new(&config, ""), &config);
+    assert!(sim.smp.is_none());
+    assert!(sim.cpu.bus.uncore.is_none());
+}
+
+#[test]
+fn secondaries_boot_with_own_hart_id() {
+    let mut sim = smp_sim(3);
+    let smp = sim.smp.as_ref().unwrap();
+    assert_eq!(smp.harts.len(), 2);
+    for (h, hart) in smp.harts.iter().enumerate() {
+        assert_eq!(hart.cpu.pc, RAM_BASE);
+        assert_eq!(hart.cpu.regs.read(RegIdx::new(10)), h as u64 + 1, "a0 holds the hart id");
+    }
+
+    for _ in 0..200 {
+        sim.tick().unwrap();
+    }
+    assert_eq!(sim.cpu.regs.read(RegIdx::new(11)), 0);
+    let smp = sim.smp.as_ref().unwrap();
+    assert_eq!(smp.harts[0].cpu.regs.read(RegIdx::new(11)), 1);
+    assert_eq!(smp.harts[1].cpu.regs.read(RegIdx::new(11)), 2);
+}
+
+#[test]
+fn lockstep_atomics_are_not_lost() {
+    let mut sim = smp_sim(2);
+    for _ in 0..20_000 {
+        sim.tick().unwrap();
+    }
+    assert_eq!(counter(&mut sim), 2 * 2 * ITERATIONS as u64);
+}
+
+#[test]
+fn threaded_atomics_are_not_lost() {
+    let mut sim = smp_sim(4);
+    assert_eq!(sim.run(20_000).unwrap(), None);
+    assert_eq!(counter(&mut sim), 4 * 2 * ITERATIONS as u64);
+    let smp = sim.smp.as_ref().unwrap();
+    assert!(smp.harts.iter().all(|h| h.cpu.stats.cycles == sim.cpu.stats.cycles));
+}
+
+#[test]
+fn contended_line_is_kept_coherent() {
+    let mut config = smp_config(2);
+    config.cache.l1_d.enabled = true;
+    let mut sim = smp_sim_with(&config);
+    for _ in 0..20_000 {
+        sim.tick().unwrap();
+    }
+    assert_eq!(counter(&mut sim), 2 * 2 * ITERATIONS as u64);
+
+    let peer = &sim.smp.as_ref().unwrap().harts[0].cpu.stats;
+    for stats in [&sim.cpu.stats, peer] {
+        assert!(stats.coherence_invalidations_sent > 0);
+        assert!(stats.coherence_invalidations_received > 0);
+        assert!(stats.coherence_misses > 0);
+        assert!(stats.coherence_sharers[1] > 0, "the other hart held the line");
+        assert!(stats.coherence_stall_cycles > 0);
+    }
+}
+
+#[test]
+fn dtb_describes_every_hart() {
+    let dtb = generate_dtb(&smp_config(4));
+    let contains = |name: &str| dtb.windows(name.len()).any(|w| w == name.as_bytes());
+    assert!(contains("cpu@3"));
+    assert!(!contains("cpu@4"));
+}
@@ -0,0 +1,171 @@
+//! # Batched Test-Suite Runner Tests
+//!
+//! Verifies `run_suite`: outcomes for every configuration and test in
+//! order, HTIF exit codes and signatures, limits, invalid images, and that
+//! a reused simulator behaves exactly like a freshly built one.
+
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::{RAM_BASE, backend_config};
+use rvsim_core::common::SimError;
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::sim::simulator::{BatchExit, RunLimits};
+use rvsim_core::sim::suite::run_suite;
+
+/// Offset of `begin_signature` from the load address.
+const SIG_OFFSET: u64 = 0x1000;
+/// Signature length in bytes.
+const SIG_LEN: u64 = 8;
+/// Offset of `tohost` from the load address.
+const TOHOST_OFFSET: u64 = 0x1100;
+/// Bytes the loadable segment spans (code, then zero-filled data).
+const SEGMENT_SIZE: u64 = 0x1200;
+
+const LIMITS: RunLimits = RunLimits { cycles: Some(100_000), instructions: None };
+
+/// Builds a minimal RV64 ELF: one `PT_LOAD` segment at `RAM_BASE` holding
+/// `code`, and `tohost`, `begin_signature`, and `end_signature` symbols.
+fn elf(code: &[u32]) -> Vec<u8> {
+    const EHDR: usize = 64;
+    const PHDR: usize = 56;
+    const SHDR: usize = 64;
+    const SYM: usize = 24;
+
+    let text: Vec<u8> = code.iter().flat_map(|w| w.to_le_bytes()).collect();
+    let strtab = b"\0tohost\0begin_signature\0end_signature\0";
+    let shstrtab = b"\0.symtab\0.strtab\0.shstrtab\0";
+    let symbols = [
+        (1u32, RAM_BASE + TOHOST_OFFSET),
+        (8, RAM_BASE + SIG_OFFSET),
+        (24, RAM_BASE + SIG_OFFSET + SIG_LEN),
+    ];
+
+    let text_off = EHDR + PHDR;
+    let symtab_off = (text_off + text.len()).next_multiple_of(8);
+    let symtab_len = SYM * (symbols.len() + 1);
+    let strtab_off = symtab_off + symtab_len;
+    let shstrtab_off = strtab_off + strtab.len();
+    let shdr_off = (shstrtab_off + shstrtab.len()).next_multiple_of(8);
+
+    let mut out = Vec::new();
+    let u16 = |out: &mut Vec<u8>, v: u16| out.extend_from_slice(&v.to_le_bytes());
+    let u32 = |out: &mut Vec<u8>, v: u32| out.extend_from_slice(&v.to_le_bytes());
+    let u64 = |out: &mut Vec<u8>, v: u64| out.extend_from_slice(&v.to_le_bytes());
+
+    // ELF header: 64-bit, little-endian, executable, RISC-V.
+    out.extend_from_slice(b"\x7fELF\x02\x01\x01\0\0\0\0\0\0\0\0\0");
+    u16(&mut out, 2);
+    u16(&mut out, 243);
+    u32(&mut out, 1);
+    u64(&mut out, RAM_BASE);
+    u64(&mut out, EHDR as u64);
+    u64(&mut out, shdr_off as u64);
+    u32(&mut out, 0);
+    for v in [EHDR, PHDR, 1, SHDR, 4, 3] {
+        u16(&mut out, v as u16);
+    }
+
+    // Program header: the code, zero-filled up to SEGMENT_SIZE.
+    u32(&mut out, 1);
+    u32(&mut out, 7);
+    for v in [text_off as u64, RAM_BASE, RAM_BASE, text.len() as u64, SEGMENT_SIZE, 8] {
+        u64(&mut out, v);
+    }
+    out.extend_from_slice(&text);
+    out.resize(symtab_off, 0);
+
+    // Symbol table: the null symbol, then global absolute symbols.
+    out.resize(out.len() + SYM, 0);
+    for (name, value) in symbols {
+        u32(&mut out, name);
+        out.extend_from_slice(&[0x10, 0]);
+        u16(&mut out, 0xfff1);
+        u64(&mut out, value);
+        u64(&mut out, 0);
+    }
+    out.extend_from_slice(strtab);
+    out.extend_from_slice(shstrtab);
+    out.resize(shdr_off, 0);
+
+    // Section headers: null, .symtab, .strtab, .shstrtab.
+    out.resize(out.len() + SHDR, 0);
+    let sections = [
+        (1, 2, symtab_off, symtab_len, 2, 1, SYM),
+        (9, 3, strtab_off, strtab.len(), 0, 0, 0),
+        (17, 3, shstrtab_off, shstrtab.len(), 0, 0, 0),
+    ];
+    for (name, kind, offset, size, link, info, entsize) in sections {
+        u32(&mut out, name);
+        u32(&mut out, kind);
+        for v in [0, 0, offset as u64, size as u64] {
+            u64(&mut out, v);
+        }
+        u32(&mut out, link);
+        u32(&mut out, info);
+        u64(&mut out, 1);
+        u64(&mut out, entsize as u64);
+    }
+    out
+}
+
+/// Stores `value` as the signature word, then exits with `code` through HTIF.
+fn signing_test(value: i32, code: i32) -> Vec<u8> {
+    elf(&[
+        InstructionBuilder::new().auipc(5, 1).build(),
+        InstructionBuilder::new().addi(6, 0, value).build(),
+        InstructionBuilder::new().sw(5, 6, 0).build(),
+        InstructionBuilder::new().addi(7, 5, (TOHOST_OFFSET - SIG_OFFSET) as i32).build(),
+        InstructionBuilder::new().addi(8, 0, (code << 1) | 1).build(),
+        InstructionBuilder::new().sd(7, 8, 0).build(),
+        InstructionBuilder::new().jal(0, 0).build(),
+    ])
+}
+
+#[test]
+fn outcomes_cover_every_config_and_test_in_order() {
+    let configs = [backend_config(BackendType::InOrder), backend_config(BackendType::OutOfOrder)];
+    let tests = [signing_test(7, 0), signing_test(-1, 1), signing_test(42, 2)];
+    let outcomes = run_suite(&configs, &tests, LIMITS, 2);
+
+    assert_eq!(outcomes.len(), 6);
+    for (i, outcome) in outcomes.iter().enumerate() {
+        assert_eq!((outcome.config, outcome.test), (i / 3, i % 3));
+        assert_eq!(outcome.result.as_ref().ok(), Some(&BatchExit::Exited(outcome.test as u64)));
+        assert!(outcome.instructions >= 6);
+        let value = [7i32, -1, 42][outcome.test];
+        let mut signature = value.to_le_bytes().to_vec();
+        signature.resize(SIG_LEN as usize, 0);
+        assert_eq!(outcome.signature.as_deref(), Some(signature.as_slice()));
+    }
+}
+
+#[test]
+fn reused_simulator_matches_fresh_one() {
+    // One worker runs the same test three times; with caches enabled any
+    // state left over from the previous run would change the cycle count.
+    let mut config = backend_config(BackendType::OutOfOrder);
+    config.cache.l1_i.enabled = true;
+    config.cache.l1_d.enabled = true;
+    config.cache.l2.enabled = true;
+    let test = signing_test(1, 0);
+    let outcomes = run_suite(&[config], &[&test, &test, &test], LIMITS, 1);
+
+    let first = &outcomes[0];
+    assert!(matches!(first.result, Ok(BatchExit::Exited(0))));
+    for outcome in &outcomes[1..] {
+        assert_eq!(outcome.cycles, first.cycles);
+        assert_eq!(outcome.instructions, first.instructions);
+    }
+}
+
+#[test]
+fn limit_and_invalid_image_are_reported_per_test() {
+    let spin = elf(&[InstructionBuilder::new().jal(0, 0).build()]);
+    let junk = b"not an elf".to_vec();
+    let outcomes = run_suite(&[Config::default()], &[spin, junk], LIMITS, 0);
+
+    assert!(matches!(outcomes[0].result, Ok(BatchExit::Limit)));
+    assert_eq!(outcomes[0].cycles, 100_000);
+    assert_eq!(outcomes[0].signature.as_deref(), Some([0; SIG_LEN as usize].as_slice()));
+    assert!(matches!(outcomes[1].result, Err(SimError::InvalidElf)));
+}
@@ -131,3 +131,50 @@ fn clint_unrecognized_offset_returns_zero() {
     assert_eq!(clint.read_u64(0x1000), 0);
     assert_eq!(clint.read_u32(0x1000), 0);
 }
+
+#[test]
+fn clint_advance_matches_repeated_ticks() {
+    let mut ticked = Clint::new(0, 7);
+    let mut advanced = Clint::new(0, 7);
+    ticked.write_u64(0x4000, 40);
+    advanced.write_u64(0x4000, 40);
+
+    let mut irq = false;
+    for _ in 0..300 {
+        irq = ticked.tick();
+    }
+    assert_eq!(advanced.advance(300), irq);
+    assert_eq!(advanced.read_u64(0xBFF8), ticked.read_u64(0xBFF8));
+}
+
+#[test]
+fn clint_next_event_is_cycles_until_mtimecmp() {
+    let mut clint = Clint::new(0, 3);
+    assert!(clint.next_event().is_some_and(|n| n > u64::from(u32::MAX)));
+
+    clint.write_u64(0x4000, 2);
+    let _ = clint.tick();
+    assert_eq!(clint.next_event(), Some(5));
+    for _ in 0..4 {
+        assert!(!clint.tick());
+    }
+    assert!(clint.tick());
+    assert_eq!(clint.next_event(), None);
+}
+
+#[test]
+fn clint_per_hart_registers() {
+    let mut clint = Clint::with_harts(0, 1, 2);
+    // Hart 1: MSIP at 0x4, MTIMECMP at 0x4008
+    clint.write_u32(0x4, 1);
+    clint.write_u64(0x4008, 3);
+    assert!(clint.hart_msip_pending(1));
+    assert!(!clint.hart_msip_pending(0));
+
+    for _ in 0..3 {
+        let _ = clint.tick();
+    }
+    assert!(clint.hart_timer_pending(1));
+    assert!(!clint.hart_timer_pending(0), "hart 0 MTIMECMP is still u64::MAX");
+    assert_eq!(clint.read_u64(0x4000), u64::MAX);
+}
@@ -157,6 +157,52 @@ fn multiple_devices_routed_correctly() {
     assert_eq!(bus.read_u32(PhysAddr::new(0x2000)), 0xBBBB);
 }
 
+#[test]
+fn device_nested_in_ram_shadows_it() {
+    use rvsim_core::soc::devices::Htif;
+    use std::sync::atomic::{AtomicU64, Ordering};
+
+    let mut bus = make_bus_with_ram(4096, 0x8000_0000);
+    let exit = Arc::new(AtomicU64::new(u64::MAX));
+    bus.add_device(Box::new(Htif::new(0x8000_0800, Arc::clone(&exit))));
+
+    bus.write_u64(PhysAddr::new(0x8000_0800), 1);
+    assert_eq!(exit.load(Ordering::Relaxed), 0, "tohost write must reach HTIF, not RAM");
+
+    // RAM on both sides of the nested device is still reachable.
+    bus.write_u64(PhysAddr::new(0x8000_07F8), 0x1111);
+    bus.write_u64(PhysAddr::new(0x8000_0810), 0x2222);
+    assert_eq!(bus.read_u64(PhysAddr::new(0x8000_07F8)), 0x1111);
+    assert_eq!(bus.read_u64(PhysAddr::new(0x8000_0810)), 0x2222);
+    assert_eq!(bus.read_u64(PhysAddr::new(0x8000_0808)), 0, "fromhost reads come from HTIF");
+    assert_eq!(
+        bus.get_ram_info().map(|(_, base, end)| (base, end)),
+        Some((0x8000_0000, 0x8000_1000))
+    );
+}
+
+#[test]
+fn gap_between_devices_is_unmapped() {
+    let mut bus = Bus::new(8, 0);
+    bus.add_device(Box::new(Memory::new(Arc::new(DramBuffer::new(256)), 0x1000)));
+    bus.add_device(Box::new(Memory::new(Arc::new(DramBuffer::new(256)), 0x3000)));
+
+    assert!(bus.is_valid_address(PhysAddr::new(0x10FF)));
+    assert!(!bus.is_valid_address(PhysAddr::new(0x1100)));
+    assert!(!bus.is_valid_address(PhysAddr::new(0x2FFF)));
+    assert!(bus.is_valid_address(PhysAddr::new(0x3000)));
+    assert_eq!(bus.read_u32(PhysAddr::new(0x2000)), 0);
+}
+
+#[test]
+fn unaligned_ram_access_round_trips() {
+    let mut bus = make_bus_with_ram(4096, 0x8000_0000);
+    bus.write_u64(PhysAddr::new(0x8000_0003), 0x0102_0304_0506_0708);
+    assert_eq!(bus.read_u64(PhysAddr::new(0x8000_0003)), 0x0102_0304_0506_0708);
+    assert_eq!(bus.read_u8(PhysAddr::new(0x8000_0003)), 0x08);
+    assert_eq!(bus.read_u16(PhysAddr::new(0x8000_0009)), 0x0102);
+}
+
 // ══════════════════════════════════════════════════════════
 // 7. RAM info
 // ══════════════════════════════════════════════════════════
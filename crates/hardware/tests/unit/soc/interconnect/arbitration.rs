@@ -44,3 +44,50 @@ fn bus_last_device_cache_hit() {
     bus.write_u32(PhysAddr::new(0x8000_0004), 0x5678);
     assert_eq!(bus.read_u32(PhysAddr::new(0x8000_0004)), 0x5678);
 }
+
+#[test]
+fn bus_idle_ticks_keep_mtime_exact() {
+    let mut bus = Bus::new(8, 0);
+    bus.add_device(Box::new(Clint::new(0x200_0000, 10)));
+
+    for _ in 0..1234 {
+        let _ = bus.tick();
+    }
+
+    // The CLINT is not ticked while idle; it is caught up on access.
+    assert_eq!(bus.read_u64(PhysAddr::new(0x200_0000 + 0xBFF8)), 123);
+}
+
+#[test]
+fn bus_timer_fires_on_exact_cycle_with_divider() {
+    let mut bus = Bus::new(8, 0);
+    bus.add_device(Box::new(Clint::new(0x200_0000, 4)));
+    for _ in 0..3 {
+        let _ = bus.tick();
+    }
+    // mtime = 0 with 3 cycles into the divider; mtimecmp = 2 is 5 cycles away.
+    bus.write_u64(PhysAddr::new(0x200_0000 + 0x4000), 2);
+
+    for cycle in 1..5 {
+        assert!(!bus.tick().0, "timer fired early at cycle {cycle}");
+    }
+    assert!(bus.tick().0);
+    assert!(bus.tick().0, "timer stays pending until mtimecmp is rewritten");
+
+    bus.write_u64(PhysAddr::new(0x200_0000 + 0x4000), u64::MAX);
+    assert!(!bus.tick().0);
+}
+
+#[test]
+fn bus_msip_write_is_seen_on_next_tick() {
+    let mut bus = Bus::new(8, 0);
+    bus.add_device(Box::new(Clint::new(0x200_0000, 1)));
+    assert!(!bus.tick().1);
+
+    bus.write_u32(PhysAddr::new(0x200_0000), 1);
+    assert!(bus.tick().1);
+    assert!(bus.tick().1);
+
+    bus.write_u32(PhysAddr::new(0x200_0000), 0);
+    assert!(!bus.tick().1);
+}
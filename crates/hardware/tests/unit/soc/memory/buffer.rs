@@ -1,8 +1,10 @@
 //! DRAM Buffer Unit Tests.
 //!
 //! Verifies allocation, read/write at byte and slice level,
-//! indexing, and boundary checks.
+//! indexing, boundary checks, host backing options, and touched-page
+//! tracking.
 
+use rvsim_core::config::HugePages;
 use rvsim_core::soc::memory::buffer::DramBuffer;
 
 // ══════════════════════════════════════════════════════════
@@ -133,3 +135,41 @@ fn buffer_overwrite_slice() {
     buf.write_slice(0, &[5, 6, 7, 8]);
     assert_eq!(buf.read_slice(0, 4), &[5, 6, 7, 8]);
 }
+
+// ══════════════════════════════════════════════════════════
+// 8. Host backing and touched pages
+// ══════════════════════════════════════════════════════════
+
+#[test]
+fn buffer_huge_page_backings_read_and_write() {
+    for huge_pages in [HugePages::Off, HugePages::Transparent, HugePages::Explicit] {
+        let size = 4 << 20;
+        let buf = DramBuffer::with_backing(size, huge_pages, true);
+        assert_eq!(buf.len(), size);
+        // Explicit pages fall back to transparent ones when none are reserved.
+        assert_eq!(buf.huge_pages() == HugePages::Off, huge_pages == HugePages::Off);
+        assert_eq!(buf.read_u64(size - 8), 0, "{huge_pages:?}");
+        buf.write_u64(size - 8, 0x1234_5678);
+        assert_eq!(buf.read_u64(size - 8), 0x1234_5678, "{huge_pages:?}");
+    }
+}
+
+#[test]
+fn buffer_touched_pages_cover_writes() {
+    let buf = DramBuffer::new(64 << 20);
+    buf.write_u8(0x1000, 1);
+    buf.write_u8(0x30_0000 + 5, 2);
+    let touched = buf.touched_pages(4096);
+    assert!(touched.contains(&1));
+    assert!(touched.contains(&0x300));
+    assert!(touched.windows(2).all(|w| w[0] < w[1]), "ascending");
+}
+
+#[cfg(target_os = "linux")]
+#[test]
+fn buffer_untouched_pages_are_skipped() {
+    let buf = DramBuffer::new(64 << 20);
+    buf.write_u8(0x1000, 1);
+    // Only the written page (plus any a transparent huge page brings in).
+    assert!(buf.touched_pages(4096).len() <= 512);
+}
@@ -1,11 +1,13 @@
 //! Memory Controller Unit Tests.
 //!
-//! Verifies SimpleController (fixed latency) and DramController
-//! (multi-bank, row-buffer-aware, refresh-capable DRAM timing).
+//! Verifies SimpleController (fixed latency), DramController
+//! (multi-bank, row-buffer-aware, refresh-capable DRAM timing), and the
+//! queued multi-channel FrFcfsController.
 
 use rvsim_core::soc::memory::controller::{
     DramConfig, DramController, MemoryController, SimpleController,
 };
+use rvsim_core::soc::memory::frfcfs::{FrFcfsConfig, FrFcfsController};
 
 /// Helper: create a DramController with refresh disabled for simpler timing tests.
 /// 8 banks, 2048-byte rows, t_cas=5, t_ras=10, t_pre=8, t_rrd=4.
@@ -317,3 +319,66 @@ fn dram_trrd_not_applied_to_row_hits() {
     assert_eq!(ctrl.access_latency(addr(0, 0) + 8, 200), 5);
     assert_eq!(ctrl.access_latency(addr(1, 0) + 8, 200), 5);
 }
+
+#[test]
+fn dram_ignores_write_backs() {
+    let mut ctrl = dram_default();
+    let cold = ctrl.access_latency(addr(0, 0), 0);
+    ctrl.write_back(addr(0, 1), 0);
+    // The write-back neither closed the open row nor occupied the bank.
+    assert_eq!(ctrl.access_latency(addr(0, 0), cold + 100), 5);
+}
+
+// ══════════════════════════════════════════════════════════
+// 10. FrFcfsController
+// ══════════════════════════════════════════════════════════
+
+fn frfcfs(channels: usize) -> FrFcfsController {
+    FrFcfsController::new(FrFcfsConfig {
+        dram: DramConfig {
+            t_cas: 5,
+            t_ras: 10,
+            t_pre: 8,
+            t_rrd: 0,
+            num_banks: 8,
+            row_size_bytes: 2048,
+            t_refi: 0,
+            t_rfc: 0,
+        },
+        channels,
+        ranks: 1,
+        read_queue_size: 16,
+        write_queue_size: 16,
+        write_high_watermark: 8,
+        write_low_watermark: 2,
+        t_burst: 4,
+        t_wtr: 6,
+    })
+}
+
+#[test]
+fn frfcfs_streaming_reads_scale_with_channels() {
+    // 64 back-to-back line reads issued in the same cycle (MSHR burst).
+    let finish = |channels: usize| {
+        let mut ctrl = frfcfs(channels);
+        (0..64u64).map(|i| ctrl.access_latency(i * 64, 0)).max().unwrap()
+    };
+    let one = finish(1);
+    let two = finish(2);
+    assert!(two < one, "two channels ({two}) should beat one ({one})");
+}
+
+#[test]
+fn frfcfs_write_drain_delays_following_read() {
+    let mut quiet = frfcfs(1);
+    let mut busy = frfcfs(1);
+    let _ = quiet.access_latency(0x0, 0);
+    let _ = busy.access_latency(0x0, 0);
+    // Enough conflicting write-backs to cross the high watermark.
+    for i in 1..=8u64 {
+        busy.write_back(i * 0x4000, 0);
+    }
+    assert_eq!(busy.stats().write_drains, 1);
+    assert_eq!(busy.queued_writes(), 2);
+    assert!(busy.access_latency(0x40, 1) > quiet.access_latency(0x40, 1));
+}
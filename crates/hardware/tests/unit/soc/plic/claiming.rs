@@ -47,3 +47,18 @@ fn plic_tick_no_interrupt() {
     plic.update_irqs(0);
     assert!(!plic.tick());
 }
+
+#[test]
+fn plic_routes_contexts_to_harts() {
+    let mut plic = Plic::with_harts(0, 2);
+    // Source 5, priority 2
+    plic.write_u32(20, 2);
+    // Enable source 5 for context 2 (hart 1, machine)
+    plic.write_u32(0x2000 + 2 * 0x80, 1 << 5);
+
+    plic.update_irqs(1 << 5);
+    let _ = plic.check_interrupts();
+    assert_eq!(plic.hart_interrupts(0), (false, false));
+    assert_eq!(plic.hart_interrupts(1), (true, false));
+    assert_eq!(plic.read_u32(0x200000 + 2 * 0x1000 + 4), 5, "hart 1 claims source 5");
+}
@@ -1,2 +1,3 @@
 pub mod disk_operations;
 pub mod queue_descriptors;
+pub mod request_timing;
@@ -25,6 +25,27 @@ fn test_stats_clone() {
     assert_eq!(cloned.instructions_retired, 50);
 }
 
+#[test]
+fn test_stats_since_counts_from_the_snapshot() {
+    let mut stats = SimStats::default();
+    stats.cycles = 100;
+    stats.dcache_misses = 7;
+    stats.retire_histogram = [1, 2, 3, 4];
+    let base = stats.clone();
+
+    stats.cycles = 250;
+    stats.dcache_misses = 9;
+    stats.retire_histogram = [1, 5, 3, 10];
+    let delta = stats.since(&base);
+    assert_eq!(delta.cycles, 150);
+    assert_eq!(delta.dcache_misses, 2);
+    assert_eq!(delta.instructions_retired, 0);
+    assert_eq!(delta.retire_histogram, [0, 3, 0, 6]);
+
+    // A snapshot from a later point saturates rather than wrapping.
+    assert_eq!(base.since(&stats).cycles, 0);
+}
+
 #[test]
 fn test_stats_print_all_sections() {
     let mut stats = SimStats::default();
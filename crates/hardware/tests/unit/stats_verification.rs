@@ -1,9 +1,14 @@
 //! SimStats unit tests.
 //!
 //! Verifies default initialization, field mutation, and derived metric
-//! computation for the simulation statistics structure.
+//! computation for the simulation statistics structure, and that the
+//! per-stage host timers run only with the `stage-timing` feature.
 
-use rvsim_core::stats::SimStats;
+use crate::common::builder::instruction::InstructionBuilder;
+use crate::common::harness::TestContext;
+use rvsim_core::config::Config;
+use rvsim_core::core::pipeline::engine::BackendType;
+use rvsim_core::stats::{SimStats, Stage};
 
 #[test]
 fn default_stats_all_zero() {
@@ -155,3 +160,49 @@ fn stats_sections_constant_available() {
     assert!(STATS_SECTIONS.contains(&"memory"));
     assert_eq!(STATS_SECTIONS.len(), 5);
 }
+
+#[test]
+fn stage_times_since_subtracts_a_snapshot() {
+    let mut stats = SimStats::default();
+    stats.stage_times.ns[Stage::Commit as usize] = 500;
+    stats.stage_times.calls[Stage::Commit as usize] = 5;
+    let base = stats.clone();
+    stats.stage_times.ns[Stage::Commit as usize] = 800;
+    stats.stage_times.calls[Stage::Commit as usize] = 7;
+
+    let delta = stats.since(&base);
+    assert_eq!(delta.stage_times.ns[Stage::Commit as usize], 300);
+    assert_eq!(delta.stage_times.calls[Stage::Commit as usize], 2);
+    assert_eq!(delta.stage_times.total_ns(), 300);
+}
+
+#[test]
+fn stage_times_total_excludes_nested_hierarchy_time() {
+    let mut times = SimStats::default().stage_times;
+    times.ns[Stage::Memory2 as usize] = 400;
+    times.ns[Stage::Hierarchy as usize] = 150;
+    assert_eq!(times.total_ns(), 400);
+}
+
+#[test]
+fn stage_timers_follow_the_build_feature() {
+    let program: Vec<u32> =
+        (0..16).map(|_| InstructionBuilder::new().addi(1, 1, 1).build()).collect();
+    let mut config = Config::default();
+    config.pipeline.backend = BackendType::OutOfOrder;
+    config.cache.l1_i.enabled = true;
+    let mut tc = TestContext::with_config(&config)
+        .with_memory(0x1000, 0x8000_0000)
+        .load_program(0x8000_0000, &program);
+    tc.run(40);
+
+    let times = tc.cpu().stats.stage_times;
+    if cfg!(feature = "stage-timing") {
+        for stage in Stage::ALL {
+            assert!(times.calls[stage as usize] > 0, "{} was timed", stage.name());
+        }
+        assert_eq!(times.calls[Stage::Bus as usize], tc.cpu().stats.cycles);
+    } else {
+        assert!(times.is_empty(), "timers compile away without stage-timing");
+    }
+}
@@ -105,6 +105,7 @@ int main() {
   for (int i = 0; i < data_len; i++)
     data[i] = i & 0xFF;
 
+  roi_begin();
   unsigned long start = read_cycles();
 
   for (int i = 0; i < data_len; i += 16) {
@@ -112,6 +113,7 @@ int main() {
   }
 
   unsigned long end = read_cycles();
+  roi_end();
   printf("Benchmark Cycles: %lu\n", end - start);
 
   printf("Output[0]: %x\n", data[0]);
@@ -60,9 +60,11 @@ int main() {
   printf("LZ77 Compression Benchmark\n");
   init_data();
 
+  roi_begin();
   unsigned long start = read_cycles();
   int comp_size = lz77_compress(input, INPUT_SIZE, output);
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   printf("Original: %d, Compressed: %d\n", INPUT_SIZE, comp_size);
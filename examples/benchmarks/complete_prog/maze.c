@@ -213,9 +213,11 @@ int main() {
   printf("Generating Maze...\n");
   generate_maze(grid);
 
+  roi_begin();
   unsigned long start = read_cycles();
   solve_astar(grid);
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
 
@@ -80,9 +80,11 @@ int main(void) {
 
   printf("Starting Merge Sort...\n");
 
+  roi_begin();
   unsigned long start = read_cycles();
   merge_sort(arr, 0, SIZE - 1);
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
 
@@ -62,9 +62,11 @@ int main(void) {
 
   printf("Starting Quick Sort...\n");
 
+  roi_begin();
   unsigned long start = read_cycles();
   quick_sort(arr, 0, SIZE - 1);
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
 
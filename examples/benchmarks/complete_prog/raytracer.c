@@ -75,6 +75,7 @@ int main() {
 
   printf("Rendering Scene...\n");
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int y = 0; y < h; y++) {
     for (int x = 0; x < w; x++) {
@@ -118,6 +119,7 @@ int main() {
     putchar('\n');
   }
   unsigned long end = read_cycles();
+  roi_end();
   printf("Benchmark Cycles: %lu\n", end - start);
 
   printf("Done.\n");
@@ -56,12 +56,14 @@ int main() {
   printf("Sobel Edge Detection (64x64)\n");
   init_image();
 
+  roi_begin();
   unsigned long start = read_cycles();
   // Run multiple passes to make the benchmark last longer
   for (int i = 0; i < 10; i++) {
     sobel_filter();
   }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
 
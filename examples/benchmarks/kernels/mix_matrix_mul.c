@@ -13,12 +13,14 @@ int main() {
     }
   }
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < N; i++)
     for (int j = 0; j < N; j++)
       for (int k = 0; k < N; k++)
         C[i][j] += A[i][k] * B[k][j];
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -9,6 +9,7 @@ int main() {
   for (int i = 0; i < N; i++)
     arr[i] = N - i;
 
+  roi_begin();
   unsigned long start = read_cycles();
   // Bubble sort
   for (int i = 0; i < N - 1; i++)
@@ -19,6 +20,7 @@ int main() {
         arr[j + 1] = t;
       }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -4,10 +4,12 @@
 int main() {
   volatile long a = 3;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < 10000; i++)
     a = a * 12345;
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
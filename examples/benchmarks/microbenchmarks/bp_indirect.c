@@ -4,6 +4,7 @@
 int main() {
   volatile int sum = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < 10000; i++) {
     switch (i % 4) {
@@ -22,6 +23,7 @@ int main() {
     }
   }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
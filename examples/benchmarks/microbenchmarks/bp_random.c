@@ -6,6 +6,7 @@ static unsigned long seed = 123;
 int main() {
   volatile int sum = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < 10000; i++) {
     seed = seed * 1103515245 + 12345;
@@ -13,6 +14,7 @@ int main() {
       sum++;
   }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
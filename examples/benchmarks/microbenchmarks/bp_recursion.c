@@ -8,9 +8,11 @@ int recurse(int n) {
 }
 
 int main() {
+  roi_begin();
   unsigned long start = read_cycles();
   recurse(1000);
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
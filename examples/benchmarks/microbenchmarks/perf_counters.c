@@ -7,11 +7,13 @@ int main() {
   // Workload
   volatile int k = 0;
 
+  roi_begin();
   start = read_cycles();
   for (int i = 0; i < 10000; i++) {
     k += i;
   }
   end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -6,12 +6,14 @@ long val = 10;
 int main() {
   volatile long res = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < 5000; i++) {
     // Load val, immediately use it. Should stall 1 cycle.
     res += val;
   }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -11,10 +11,12 @@ int main() {
 
   volatile long sum = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < SIZE; i++)
     sum += data[i]; // Linear Read
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
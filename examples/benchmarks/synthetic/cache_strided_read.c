@@ -12,10 +12,12 @@ int main() {
 
   volatile long sum = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < SIZE; i += STRIDE)
     sum += data[i];
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
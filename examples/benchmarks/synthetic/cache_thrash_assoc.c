@@ -12,6 +12,7 @@ int main() {
 
   volatile long sum = 0;
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int iter = 0; iter < 100; iter++) {
     for (int i = 0; i < WAYS; i++) {
@@ -19,6 +20,7 @@ int main() {
     }
   }
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
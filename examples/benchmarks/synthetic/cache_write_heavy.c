@@ -5,11 +5,13 @@
 long data[SIZE];
 
 int main() {
+  roi_begin();
   unsigned long start = read_cycles();
   for (int k = 0; k < 100; k++)
     for (int i = 0; i < SIZE; i++)
       data[i] += 1;
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -16,10 +16,12 @@ int main() {
 
   struct Node *curr = &pool[0];
 
+  roi_begin();
   unsigned long start = read_cycles();
   for (int i = 0; i < 100000; i++)
     curr = curr->next;
   unsigned long end = read_cycles();
+  roi_end();
 
   printf("Benchmark Cycles: %lu\n", end - start);
   return 0;
@@ -4,20 +4,33 @@ rvsim simulator Python API.
 A Python-first interface to the cycle-accurate RISC-V simulator:
 1. **Configuration:** ``Config``, ``Cache``, ``BranchPredictor``, ``MemDepPredictor``, etc.
 2. **Execution:** ``Cpu``, ``Simulator``.
-3. **Experiments:** ``Environment``, ``Result``.
+3. **Experiments:** ``Environment``, ``Result``, ``SimPoint``, ``Sampling``.
 4. **Statistics:** ``Stats``, ``Table``.
 5. **ISA:** ``reg``, ``csr``, ``Disassemble``.
-6. **Pipeline:** ``PipelineSnapshot`` (from ``cpu.pipeline_snapshot()``).
+6. **Pipeline:** ``PipelineSnapshot`` (from ``cpu.pipeline_snapshot()``) and
+   ``PipelineHistory`` / ``PipelineFrame`` (from ``cpu.pipeline_history()``).
+7. **Sweeps:** ``Sweep``, ``SweepResults``, and the executors that run them
+   (``LocalExecutor``, ``SSHExecutor``, ``SlurmExecutor``, ``RayExecutor``).
+8. **Test suites:** ``run_suite``, ``TestOutcome``.
 """
 
 from importlib.metadata import version as _metadata_version
 
+from .cluster import (
+    CommandExecutor,
+    Executor,
+    LocalExecutor,
+    RayExecutor,
+    SlurmExecutor,
+    SSHExecutor,
+)
 from .config import Config
-from .experiment import Environment, Result
+from .experiment import Environment, Result, Sampling, SimPoint
 from .isa import Disassemble, csr, reg
 from .objects import Cpu, Instruction, Simulator
-from .pipeline import PipelineSnapshot
-from .stats import Stats, Table
+from .pipeline import PipelineFrame, PipelineHistory, PipelineSnapshot
+from .stats import IntervalStats, Stats, Table
+from .suite import TestOutcome, run_suite
 from .sweep import Sweep, SweepResults
 from .types import (
     Backend,
@@ -39,12 +52,14 @@ import sys as _sys
 
 _rvsim_dict = _sys.modules[__name__].__dict__
 for _name in (
+    "cluster",
     "config",
     "experiment",
     "isa",
     "objects",
     "pipeline",
     "stats",
+    "suite",
     "sweep",
     "types",
     "_core",
@@ -76,13 +91,26 @@ __all__ = [
     "Simulator",
     "Instruction",
     "PipelineSnapshot",
+    "PipelineHistory",
+    "PipelineFrame",
     "Environment",
     "Result",
+    "SimPoint",
+    "Sampling",
     "Stats",
+    "IntervalStats",
     "Table",
     "reg",
     "csr",
     "Disassemble",
     "Sweep",
     "SweepResults",
+    "Executor",
+    "LocalExecutor",
+    "CommandExecutor",
+    "SSHExecutor",
+    "SlurmExecutor",
+    "RayExecutor",
+    "run_suite",
+    "TestOutcome",
 ]
@@ -0,0 +1,11 @@
+"""Pipe worker for ``rvsim.cluster`` executors (``python -m rvsim._worker``).
+
+Kept out of ``rvsim.cluster`` itself: the package imports that module, so
+running it with ``-m`` would execute a second copy whose ``Input`` and
+``Output`` classes differ from the ones the coordinator pickles.
+"""
+
+from rvsim.cluster import _serve
+
+if __name__ == "__main__":
+    _serve()
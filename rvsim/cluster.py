@@ -0,0 +1,523 @@
+"""
+Executor backends for ``Sweep``: local processes, SSH hosts, Slurm, or Ray.
+
+``Sweep.run(executor=...)`` hands its jobs to an :class:`Executor`, which
+yields each job's result as it finishes. Scheduling order, result streaming,
+and aggregation into ``SweepResults`` all stay in ``Sweep``, so every
+backend produces the same results as the local one.
+
+Jobs name the files they read (binaries, checkpoints, traces) as
+:class:`Input` and the files they write as :class:`Output`. The remote
+backends ship inputs by content: each worker keeps a cache of files named
+by SHA-256 digest, which persists across sweeps, and a file is sent to a
+worker only if its cache lacks it. Outputs are copied back to their path
+on the submitting machine when the job finishes, so a checkpoint written
+on one node can be sent to any other.
+
+:class:`SSHExecutor` and :class:`SlurmExecutor` start ``python -m
+rvsim._worker`` workers over ``ssh`` or ``srun`` and talk to them over the
+command's stdin and stdout; any other launcher works through
+:class:`CommandExecutor`. Workers need rvsim installed, but no shared
+filesystem. A job whose worker fails is retried on another one.
+"""
+
+from __future__ import annotations
+
+import hashlib
+import os
+import pickle
+import queue
+import shlex
+import subprocess
+import sys
+import tempfile
+import threading
+import traceback
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from dataclasses import dataclass
+from typing import Any, Callable, Dict, Iterator, List, Optional, Sequence, Tuple
+
+__all__ = [
+    "Executor",
+    "LocalExecutor",
+    "CommandExecutor",
+    "SSHExecutor",
+    "SlurmExecutor",
+    "RayExecutor",
+    "Input",
+    "Output",
+]
+
+# Worker command, for launchers that run it on another machine.
+_WORKER = "-m rvsim._worker"
+
+
+@dataclass(frozen=True)
+class Input:
+    """A file a job reads, shipped to remote workers by content."""
+
+    path: str
+
+
+@dataclass(frozen=True)
+class Output:
+    """A file a job writes, copied back to *path* on the submitting machine."""
+
+    path: str
+
+
+def _replace(obj: Any, fn: Callable[[Any], Any]) -> Any:
+    """Apply *fn* to each :class:`Input` / :class:`Output` in a job's args."""
+    if isinstance(obj, (Input, Output)):
+        return fn(obj)
+    if isinstance(obj, tuple):
+        return tuple(_replace(x, fn) for x in obj)
+    return obj
+
+
+def _files(obj: Any, kind: type) -> List[Any]:
+    """The :class:`Input`s or :class:`Output`s in a job's args."""
+    found: List[Any] = []
+    _replace(obj, lambda f: found.append(f) if isinstance(f, kind) else None)
+    return found
+
+
+def _local_path(f: Any) -> str:
+    return f.path
+
+
+def _call_local(fn: Callable[[tuple], Any], args: tuple) -> Any:
+    """Run a job whose files are on this machine."""
+    return fn(_replace(args, _local_path))
+
+
+class Executor:
+    """Runs sweep jobs and yields ``(args, result)`` as each job finishes.
+
+    ``initializer(*initargs)`` runs in each worker before its first job of
+    every ``map`` call, even when the executor reuses workers across calls.
+    Jobs are taken in the order given, each by the next idle worker.
+    """
+
+    def map(
+        self,
+        fn: Callable[[tuple], Any],
+        work: Sequence[tuple],
+        initializer: Callable[..., None],
+        initargs: tuple,
+    ) -> Iterator[Tuple[tuple, Any]]:
+        raise NotImplementedError
+
+
+class LocalExecutor(Executor):
+    """Worker processes on this machine (the default).
+
+    Args:
+        max_workers: Max parallel workers. ``None`` = number of CPUs.
+        parallel: ``False`` runs every job in this process, in order.
+    """
+
+    def __init__(self, max_workers: Optional[int] = None, parallel: bool = True):
+        self.max_workers = max_workers
+        self.parallel = parallel
+
+    def map(self, fn, work, initializer, initargs):
+        if not self.parallel or len(work) <= 1:
+            initializer(*initargs)
+            for args in work:
+                yield args, _call_local(fn, args)
+            return
+        with ProcessPoolExecutor(
+            max_workers=self.max_workers,
+            initializer=initializer,
+            initargs=initargs,
+        ) as pool:
+            futures = {pool.submit(_call_local, fn, args): args for args in work}
+            for future in as_completed(futures):
+                yield futures[future], future.result()
+
+
+def _write_outputs(outputs: Dict[str, bytes]) -> None:
+    """Write a remote job's output files to their paths on this machine."""
+    for path, data in outputs.items():
+        parent = os.path.dirname(path)
+        if parent:
+            os.makedirs(parent, exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(data)
+
+
+# ── Pipe workers (SSH, Slurm, any command) ───────────────────────────────────
+
+
+class _Digests:
+    """SHA-256 of local files, recomputed only when a file changes."""
+
+    def __init__(self):
+        self._cache: Dict[str, Tuple[int, int, str]] = {}
+        self._lock = threading.Lock()
+
+    def __call__(self, path: str) -> str:
+        st = os.stat(path)
+        with self._lock:
+            hit = self._cache.get(path)
+        if hit is not None and hit[:2] == (st.st_mtime_ns, st.st_size):
+            return hit[2]
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for chunk in iter(lambda: f.read(1 << 20), b""):
+                h.update(chunk)
+        digest = h.hexdigest()
+        with self._lock:
+            self._cache[path] = (st.st_mtime_ns, st.st_size, digest)
+        return digest
+
+
+class _WorkerLost(Exception):
+    """The worker process exited or its pipe broke."""
+
+
+class _Worker:
+    """Coordinator side of one pipe worker."""
+
+    def __init__(self, command: Sequence[str], initializer, initargs):
+        self.command = list(command)
+        self.proc = subprocess.Popen(
+            self.command, stdin=subprocess.PIPE, stdout=subprocess.PIPE
+        )
+        self._send(("init", initializer, initargs))
+        # Digests already in the worker's file cache.
+        self.has = set(self._recv())
+
+    def _send(self, msg: tuple) -> None:
+        try:
+            pickle.dump(msg, self.proc.stdin, protocol=pickle.HIGHEST_PROTOCOL)
+            self.proc.stdin.flush()
+        except (BrokenPipeError, OSError) as e:
+            raise _WorkerLost(str(e)) from e
+
+    def _recv(self) -> Any:
+        try:
+            return pickle.load(self.proc.stdout)
+        except (EOFError, pickle.UnpicklingError, OSError) as e:
+            raise _WorkerLost(f"{' '.join(self.command)}: {e}") from e
+
+    def run(self, fn, args: tuple, digest: _Digests) -> Any:
+        inputs = {}
+        for f in _files(args, Input):
+            d = digest(f.path)
+            inputs[f.path] = d
+            if d not in self.has:
+                with open(f.path, "rb") as fh:
+                    self._send(("put", d, fh.read()))
+                self.has.add(d)
+        self._send(("job", fn, args, inputs))
+        status, payload, outputs = self._recv()
+        if status == "error":
+            raise RuntimeError(payload)
+        _write_outputs(outputs)
+        return payload
+
+    def close(self) -> None:
+        try:
+            self._send(("exit",))
+        except _WorkerLost:
+            pass
+        try:
+            self.proc.stdin.close()
+        except OSError:
+            pass
+        try:
+            self.proc.wait(timeout=10)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+
+
+class CommandExecutor(Executor):
+    """Pipe workers started by arbitrary commands.
+
+    Each command must start ``python -m rvsim._worker`` (on any machine)
+    with its stdin and stdout connected to this process. One worker runs
+    one job at a time, so list a command once per slot.
+
+    Args:
+        commands: One argv list per worker.
+        retries: Times a job is retried when its worker dies or it raises.
+            A dead worker is dropped; the sweep fails only when none remain
+            or a job exhausts its retries.
+    """
+
+    def __init__(self, commands: Sequence[Sequence[str]], retries: int = 2):
+        if not commands:
+            raise ValueError("CommandExecutor needs at least one worker command")
+        self.commands = [list(c) for c in commands]
+        self.retries = retries
+        self._digest = _Digests()
+
+    def map(self, fn, work, initializer, initargs):
+        todo: "queue.Queue[Optional[Tuple[tuple, int]]]" = queue.Queue()
+        for args in work:
+            todo.put((args, 0))
+        done: "queue.Queue[Tuple[str, Any, Any]]" = queue.Queue()
+
+        def serve(command: List[str]) -> None:
+            try:
+                worker = _Worker(command, initializer, initargs)
+            except (_WorkerLost, OSError) as e:
+                done.put(("lost", None, e))
+                return
+            try:
+                while True:
+                    item = todo.get()
+                    if item is None:
+                        return
+                    args, attempt = item
+                    try:
+                        result = worker.run(fn, args, self._digest)
+                    except (_WorkerLost, RuntimeError) as e:
+                        if attempt < self.retries:
+                            todo.put((args, attempt + 1))
+                        else:
+                            done.put(("failed", args, e))
+                        if isinstance(e, _WorkerLost):
+                            done.put(("lost", None, e))
+                            return
+                        continue
+                    done.put(("ok", args, result))
+            finally:
+                worker.close()
+
+        threads = [
+            threading.Thread(target=serve, args=(c,), daemon=True)
+            for c in self.commands
+        ]
+        for t in threads:
+            t.start()
+        remaining = len(work)
+        alive = len(threads)
+        try:
+            while remaining > 0:
+                status, args, payload = done.get()
+                if status == "ok":
+                    remaining -= 1
+                    yield args, payload
+                elif status == "failed":
+                    raise RuntimeError(
+                        f"sweep job {args!r} failed after {self.retries + 1} attempts"
+                    ) from payload
+                else:
+                    alive -= 1
+                    if alive == 0:
+                        raise RuntimeError("all sweep workers were lost") from payload
+        finally:
+            # Idle workers exit at once; busy ones after their current job.
+            for _ in threads:
+                todo.put(None)
+        for t in threads:
+            t.join()
+
+
+class SSHExecutor(CommandExecutor):
+    """Pipe workers on remote hosts over ``ssh``.
+
+    Args:
+        hosts: Host names (``user@host`` works). Repeat a host to run
+            several workers on it, e.g. ``["node1"] * 32``.
+        python: Python interpreter with rvsim installed on the hosts.
+        ssh: The ssh command and its options.
+        retries: See :class:`CommandExecutor`.
+    """
+
+    def __init__(
+        self,
+        hosts: Sequence[str],
+        python: str = "python3",
+        ssh: Sequence[str] = ("ssh", "-o", "BatchMode=yes"),
+        retries: int = 2,
+    ):
+        super().__init__(
+            [[*ssh, host, f"{shlex.quote(python)} {_WORKER}"] for host in hosts],
+            retries=retries,
+        )
+
+
+class SlurmExecutor(CommandExecutor):
+    """Pipe workers as Slurm job steps, one ``srun`` task per worker.
+
+    Run from inside an allocation (``salloc`` or an ``sbatch`` script);
+    each worker is a single-task step scheduled onto the allocation's nodes.
+
+    Args:
+        workers: Number of workers (usually the allocation's task count).
+        python: Python interpreter with rvsim installed on the nodes.
+        srun_args: Extra ``srun`` options, e.g. ``["--mem=4G"]``.
+        retries: See :class:`CommandExecutor`.
+    """
+
+    def __init__(
+        self,
+        workers: int,
+        python: str = "python3",
+        srun_args: Sequence[str] = (),
+        retries: int = 2,
+    ):
+        command = [
+            "srun", "--ntasks=1", "--nodes=1", "--exclusive", "--quiet",
+            *srun_args, python, *_WORKER.split(),
+        ]  # fmt: skip
+        super().__init__([command] * workers, retries=retries)
+
+
+class RayExecutor(Executor):
+    """Ray tasks on an existing Ray cluster (requires ``ray``).
+
+    Input files go into the Ray object store once per content digest;
+    each node keeps them in its worker file cache. Ray retries a task whose
+    worker dies, up to *retries* times.
+
+    Args:
+        address: Ray cluster address; ``None`` uses ``ray.init()`` defaults.
+        retries: Task retries on worker failure.
+    """
+
+    def __init__(self, address: Optional[str] = None, retries: int = 2):
+        self.address = address
+        self.retries = retries
+        self._digest = _Digests()
+
+    def map(self, fn, work, initializer, initargs):
+        try:
+            import ray
+        except ImportError as e:
+            raise ImportError("RayExecutor requires the 'ray' package") from e
+        if not ray.is_initialized():
+            ray.init(address=self.address)
+        task = ray.remote(max_retries=self.retries)(_ray_job)
+        init = ray.put((initializer, initargs))
+        # Ray reuses worker processes across map calls, so workers key their
+        # installed state on the initializer call rather than running it once.
+        init_digest = hashlib.sha256(
+            pickle.dumps((initializer, initargs), protocol=pickle.HIGHEST_PROTOCOL)
+        ).hexdigest()
+        blobs: Dict[str, Any] = {}
+        pending = {}
+        for args in work:
+            inputs = {}
+            for f in _files(args, Input):
+                d = self._digest(f.path)
+                inputs[f.path] = d
+                if d not in blobs:
+                    with open(f.path, "rb") as fh:
+                        blobs[d] = ray.put(fh.read())
+            refs = {d: blobs[d] for d in inputs.values()}
+            pending[task.remote(init_digest, init, fn, args, inputs, refs)] = args
+        while pending:
+            [ready], _ = ray.wait(list(pending), num_returns=1)
+            args = pending.pop(ready)
+            result, outputs = ray.get(ready)
+            _write_outputs(outputs)
+            yield args, result
+
+
+# ── Worker side ──────────────────────────────────────────────────────────────
+
+
+def _cache_dir() -> str:
+    root = os.environ.get("RVSIM_CACHE_DIR") or os.path.join(
+        os.path.expanduser("~"), ".cache", "rvsim"
+    )
+    path = os.path.join(root, "blobs")
+    os.makedirs(path, exist_ok=True)
+    return path
+
+
+def _store(cache: str, digest: str, data: bytes) -> None:
+    """Write a blob atomically, so a crashed worker never leaves a partial one."""
+    path = os.path.join(cache, digest)
+    if os.path.exists(path):
+        return
+    fd, tmp = tempfile.mkstemp(dir=cache)
+    with os.fdopen(fd, "wb") as f:
+        f.write(data)
+    os.replace(tmp, path)
+
+
+def _run_cached(
+    fn: Callable[[tuple], Any], args: tuple, inputs: Dict[str, str], cache: str
+) -> Tuple[Any, Dict[str, bytes]]:
+    """Run a job with inputs from the file cache and return its outputs' bytes."""
+    with tempfile.TemporaryDirectory(prefix="rvsim-job-") as scratch:
+        local: Dict[str, str] = {}
+
+        def resolve(f: Any) -> str:
+            if isinstance(f, Input):
+                return os.path.join(cache, inputs[f.path])
+            path = os.path.join(scratch, f"{len(local)}-{os.path.basename(f.path)}")
+            local[f.path] = path
+            return path
+
+        result = fn(_replace(args, resolve))
+        outputs = {}
+        for path, tmp in local.items():
+            with open(tmp, "rb") as fh:
+                outputs[path] = fh.read()
+    return result, outputs
+
+
+# Digest of the ``(initializer, initargs)`` last run in this Ray worker.
+_RAY_INIT_DIGEST: Optional[str] = None
+
+
+def _ray_job(init_digest, init, fn, args, inputs, refs):
+    """Ray task body: fill the node's file cache, then run the job."""
+    import ray
+
+    global _RAY_INIT_DIGEST
+    if _RAY_INIT_DIGEST != init_digest:
+        initializer, initargs = init
+        initializer(*initargs)
+        _RAY_INIT_DIGEST = init_digest
+    cache = _cache_dir()
+    for d, ref in refs.items():
+        if not os.path.exists(os.path.join(cache, d)):
+            _store(cache, d, ray.get(ref))
+    return _run_cached(fn, args, inputs, cache)
+
+
+def _serve() -> None:
+    """Pipe worker loop (``python -m rvsim._worker``)."""
+    # The simulated program's console writes to fd 1; keep it off the
+    # protocol stream.
+    out = os.fdopen(os.dup(1), "wb")
+    os.dup2(2, 1)
+    inp = sys.stdin.buffer
+    cache = _cache_dir()
+
+    def send(msg: Any) -> None:
+        pickle.dump(msg, out, protocol=pickle.HIGHEST_PROTOCOL)
+        out.flush()
+
+    while True:
+        try:
+            msg = pickle.load(inp)
+        except EOFError:
+            return
+        kind = msg[0]
+        if kind == "init":
+            _, initializer, initargs = msg
+            initializer(*initargs)
+            send(os.listdir(cache))
+        elif kind == "put":
+            _, digest, data = msg
+            _store(cache, digest, data)
+        elif kind == "job":
+            _, fn, args, inputs = msg
+            try:
+                result, outputs = _run_cached(fn, args, inputs, cache)
+            except Exception:
+                send(("error", traceback.format_exc(), {}))
+            else:
+                send(("ok", result, outputs))
+        elif kind == "exit":
+            return
+
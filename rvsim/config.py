@@ -56,6 +56,19 @@ class Config:
         btb_size: int = 4096,
         btb_ways: int = 4,
         ras_size: int = 32,
+        # Decoupled frontend
+        ftq_depth: int = 0,
+        fdip: bool = True,
+        # Vector unit (RVV 1.0)
+        vector: bool = False,
+        vlen: int = 128,
+        vector_lanes: int = 2,
+        vector_alu_latency: int = 2,
+        vector_mul_latency: int = 4,
+        vector_fp_latency: int = 4,
+        vector_div_latency: int = 20,
+        vector_queue_depth: int = 8,
+        vector_phys_regs: int = 32,
         # Caches (None = disabled)
         l1i=Cache("32KB", ways=4, latency=1, prefetcher=Prefetcher.NextLine(degree=1)),
         l1d=Cache(
@@ -68,6 +81,12 @@ class Config:
         l3: Optional[Cache] = None,
         inclusion_policy: Any = Cache.NINE(),
         wcb_entries: int = 0,
+        # Stack-distance profiling of the L1-D access stream (miss-ratio curves)
+        stack_distance: bool = False,
+        stack_distance_line_bytes: int = 64,
+        stack_distance_max_sets: int = 16384,
+        stack_distance_max_ways: int = 16,
+        stack_distance_sampled_sets: int = 1024,
         # Memory
         ram_size="256MB",
         memory_controller=None,
@@ -75,11 +94,37 @@ class Config:
         l2_tlb_size: int = 512,
         l2_tlb_ways: int = 4,
         l2_tlb_latency: int = 4,
+        tlb_superpage_entries: int = 8,
+        l2_tlb_superpage_entries: int = 16,
+        page_walk_cache_size: int = 16,
         software_ad_bits: bool = True,
         misaligned_access_trap: bool = False,
+        # Host backing of guest RAM (Linux; speed only, no effect on results)
+        huge_pages: str = "off",
+        numa_local: bool = False,
         # General
         trace: bool = False,
         initial_sp: Optional[int] = None,
+        idle_skip: bool = True,
+        # Fast-forward (functional engine until a trigger fires)
+        fast_forward: bool = False,
+        fast_forward_pc: Optional[int] = None,
+        fast_forward_insts: Optional[int] = None,
+        fast_forward_marker: bool = False,
+        fast_forward_warm: bool = False,
+        fast_forward_dbt: bool = False,
+        bbv_interval: Optional[int] = None,
+        # Region of interest (roi_begin/roi_end markers from bench.h)
+        roi_stats: bool = False,
+        roi_detailed: bool = False,
+        roi_checkpoint: Optional[str] = None,
+        # Multi-hart (SMP)
+        harts: int = 1,
+        smp_quantum: int = 1000,
+        coherence_protocol: str = "MESI",
+        coherence_upgrade_latency: int = 10,
+        coherence_invalidation_latency: int = 20,
+        coherence_transfer_latency: int = 40,
         # System (advanced)
         ram_base: int = 0x8000_0000,
         uart_base: int = 0x1000_0000,
@@ -92,6 +137,10 @@ class Config:
         clint_divider: int = 10,
         uart_to_stderr: bool = False,
         uart_quiet: bool = False,
+        disk_write_through: bool = False,
+        disk_latency: int = 0,
+        disk_bytes_per_cycle: int = 0,
+        disk_queue_depth: int = 1,
     ):
         # Pipeline
         self.width = width
@@ -102,6 +151,21 @@ class Config:
         self.btb_ways = btb_ways
         self.ras_size = ras_size
 
+        # Decoupled frontend
+        self.ftq_depth = ftq_depth
+        self.fdip = fdip
+
+        # Vector unit
+        self.vector = vector
+        self.vlen = vlen
+        self.vector_lanes = vector_lanes
+        self.vector_alu_latency = vector_alu_latency
+        self.vector_mul_latency = vector_mul_latency
+        self.vector_fp_latency = vector_fp_latency
+        self.vector_div_latency = vector_div_latency
+        self.vector_queue_depth = vector_queue_depth
+        self.vector_phys_regs = vector_phys_regs
+
         # Caches
         self.l1i = l1i
         self.l1d = l1d
@@ -109,6 +173,11 @@ class Config:
         self.l3 = l3
         self.inclusion_policy = inclusion_policy
         self.wcb_entries = wcb_entries
+        self.stack_distance = stack_distance
+        self.stack_distance_line_bytes = stack_distance_line_bytes
+        self.stack_distance_max_sets = stack_distance_max_sets
+        self.stack_distance_max_ways = stack_distance_max_ways
+        self.stack_distance_sampled_sets = stack_distance_sampled_sets
 
         # Memory
         self.ram_size = _parse_size(ram_size)
@@ -121,12 +190,32 @@ class Config:
         self.l2_tlb_size = l2_tlb_size
         self.l2_tlb_ways = l2_tlb_ways
         self.l2_tlb_latency = l2_tlb_latency
+        self.tlb_superpage_entries = tlb_superpage_entries
+        self.l2_tlb_superpage_entries = l2_tlb_superpage_entries
+        self.page_walk_cache_size = page_walk_cache_size
         self.software_ad_bits = software_ad_bits
         self.misaligned_access_trap = misaligned_access_trap
+        self.huge_pages = huge_pages
+        self.numa_local = numa_local
 
         # General
         self.trace = trace
         self.initial_sp = initial_sp
+        self.idle_skip = idle_skip
+
+        # Fast-forward
+        self.fast_forward = fast_forward
+        self.fast_forward_pc = fast_forward_pc
+        self.fast_forward_insts = fast_forward_insts
+        self.fast_forward_marker = fast_forward_marker
+        self.fast_forward_warm = fast_forward_warm
+        self.fast_forward_dbt = fast_forward_dbt
+        self.bbv_interval = bbv_interval
+
+        # Region of interest
+        self.roi_stats = roi_stats
+        self.roi_detailed = roi_detailed
+        self.roi_checkpoint = roi_checkpoint
 
         # System
         self.ram_base = ram_base
@@ -137,9 +226,19 @@ class Config:
         self.kernel_offset = kernel_offset
         self.bus_width = bus_width
         self.bus_latency = bus_latency
+        self.harts = harts
+        self.smp_quantum = smp_quantum
+        self.coherence_protocol = coherence_protocol
+        self.coherence_upgrade_latency = coherence_upgrade_latency
+        self.coherence_invalidation_latency = coherence_invalidation_latency
+        self.coherence_transfer_latency = coherence_transfer_latency
         self.clint_divider = clint_divider
         self.uart_to_stderr = uart_to_stderr
         self.uart_quiet = uart_quiet
+        self.disk_write_through = disk_write_through
+        self.disk_latency = disk_latency
+        self.disk_bytes_per_cycle = disk_bytes_per_cycle
+        self.disk_queue_depth = disk_queue_depth
 
     def to_dict(self) -> Dict[str, Any]:
         """Produce the nested dict expected by the Rust backend."""
@@ -162,22 +261,54 @@ class Config:
             btb_size=self.btb_size,
             btb_ways=self.btb_ways,
             ras_size=self.ras_size,
+            ftq_depth=self.ftq_depth,
+            fdip=self.fdip,
+            vector=self.vector,
+            vlen=self.vlen,
+            vector_lanes=self.vector_lanes,
+            vector_alu_latency=self.vector_alu_latency,
+            vector_mul_latency=self.vector_mul_latency,
+            vector_fp_latency=self.vector_fp_latency,
+            vector_div_latency=self.vector_div_latency,
+            vector_queue_depth=self.vector_queue_depth,
+            vector_phys_regs=self.vector_phys_regs,
             l1i=self.l1i,
             l1d=self.l1d,
             l2=self.l2,
             l3=self.l3,
             inclusion_policy=self.inclusion_policy,
             wcb_entries=self.wcb_entries,
+            stack_distance=self.stack_distance,
+            stack_distance_line_bytes=self.stack_distance_line_bytes,
+            stack_distance_max_sets=self.stack_distance_max_sets,
+            stack_distance_max_ways=self.stack_distance_max_ways,
+            stack_distance_sampled_sets=self.stack_distance_sampled_sets,
             ram_size=self.ram_size,
             memory_controller=self.memory_controller,
             tlb_size=self.tlb_size,
             l2_tlb_size=self.l2_tlb_size,
             l2_tlb_ways=self.l2_tlb_ways,
             l2_tlb_latency=self.l2_tlb_latency,
+            tlb_superpage_entries=self.tlb_superpage_entries,
+            l2_tlb_superpage_entries=self.l2_tlb_superpage_entries,
+            page_walk_cache_size=self.page_walk_cache_size,
             software_ad_bits=self.software_ad_bits,
             misaligned_access_trap=self.misaligned_access_trap,
+            huge_pages=self.huge_pages,
+            numa_local=self.numa_local,
             trace=self.trace,
             initial_sp=self.initial_sp,
+            idle_skip=self.idle_skip,
+            fast_forward=self.fast_forward,
+            fast_forward_pc=self.fast_forward_pc,
+            fast_forward_insts=self.fast_forward_insts,
+            fast_forward_marker=self.fast_forward_marker,
+            fast_forward_warm=self.fast_forward_warm,
+            fast_forward_dbt=self.fast_forward_dbt,
+            bbv_interval=self.bbv_interval,
+            roi_stats=self.roi_stats,
+            roi_detailed=self.roi_detailed,
+            roi_checkpoint=self.roi_checkpoint,
             ram_base=self.ram_base,
             uart_base=self.uart_base,
             disk_base=self.disk_base,
@@ -186,9 +317,19 @@ class Config:
             kernel_offset=self.kernel_offset,
             bus_width=self.bus_width,
             bus_latency=self.bus_latency,
+            harts=self.harts,
+            smp_quantum=self.smp_quantum,
+            coherence_protocol=self.coherence_protocol,
+            coherence_upgrade_latency=self.coherence_upgrade_latency,
+            coherence_invalidation_latency=self.coherence_invalidation_latency,
+            coherence_transfer_latency=self.coherence_transfer_latency,
             clint_divider=self.clint_divider,
             uart_to_stderr=self.uart_to_stderr,
             uart_quiet=self.uart_quiet,
+            disk_write_through=self.disk_write_through,
+            disk_latency=self.disk_latency,
+            disk_bytes_per_cycle=self.disk_bytes_per_cycle,
+            disk_queue_depth=self.disk_queue_depth,
         )
         unknown = set(kwargs) - set(fields)
         if unknown:
@@ -394,6 +535,8 @@ def _mc_name(mc) -> str:
         return "Simple"
     if isinstance(mc, MemoryController.DRAM):
         return "Dram"
+    if isinstance(mc, MemoryController.FRFCFS):
+        return "FrFcfs"
     raise TypeError(f"Unknown memory controller type: {type(mc)}")
 
 
@@ -429,6 +572,10 @@ def _fu_config_to_dict(fc: Fu) -> dict:
         "branch_latency": 1,
         "num_mem": 0,
         "mem_latency": 1,
+        # One vector port unless configured, so pools written before the
+        # vector unit existed still issue vector instructions.
+        "num_vector": 1,
+        "vector_latency": 1,
     }
     for u in fc.units:
         if isinstance(u, Fu.IntAlu):
@@ -458,6 +605,9 @@ def _fu_config_to_dict(fc: Fu) -> dict:
         elif isinstance(u, Fu.Mem):
             d["num_mem"] = u.count
             d["mem_latency"] = u.latency
+        elif isinstance(u, Fu.Vector):
+            d["num_vector"] = u.count
+            d["vector_latency"] = u.latency
         else:
             raise TypeError(f"Unknown Fu type: {type(u)}")
     return d
@@ -538,9 +688,36 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         "trace_instructions": cfg.trace,
         "start_pc": _START_PC_DEFAULT,
         "direct_mode": True,
+        "idle_skip": cfg.idle_skip,
     }
     if cfg.initial_sp is not None:
         general["initial_sp"] = cfg.initial_sp
+    # Any trigger implies fast-forward; fast_forward=True alone stays functional.
+    # BBV profiling only runs in the functional engine, so it implies it too,
+    # as does running only the region of interest in detail.
+    ff_enabled = (
+        cfg.fast_forward
+        or cfg.fast_forward_pc is not None
+        or cfg.fast_forward_insts is not None
+        or cfg.fast_forward_marker
+        or cfg.bbv_interval is not None
+        or cfg.roi_detailed
+    )
+    if ff_enabled:
+        general["fast_forward"] = {
+            "enabled": True,
+            "until_pc": cfg.fast_forward_pc,
+            "until_instructions": cfg.fast_forward_insts,
+            "until_marker": cfg.fast_forward_marker,
+            "warm": cfg.fast_forward_warm,
+            "dbt": cfg.fast_forward_dbt,
+            "bbv_interval": cfg.bbv_interval,
+        }
+    general["roi"] = {
+        "stats": cfg.roi_stats,
+        "detailed": cfg.roi_detailed,
+        "checkpoint": cfg.roi_checkpoint,
+    }
 
     # System
     system = {
@@ -552,10 +729,16 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         "kernel_offset": cfg.kernel_offset,
         "bus_width": cfg.bus_width,
         "bus_latency": cfg.bus_latency,
+        "harts": cfg.harts,
+        "smp_quantum": cfg.smp_quantum,
         "clint_divider": cfg.clint_divider,
         "uart_to_stderr": cfg.uart_to_stderr,
         "uart_quiet": cfg.uart_quiet,
         "tohost_addr": 0,
+        "disk_write_through": cfg.disk_write_through,
+        "disk_latency": cfg.disk_latency,
+        "disk_bytes_per_cycle": cfg.disk_bytes_per_cycle,
+        "disk_queue_depth": cfg.disk_queue_depth,
     }
 
     # Memory — merge controller-specific params
@@ -567,11 +750,16 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         "l2_tlb_size": cfg.l2_tlb_size,
         "l2_tlb_ways": cfg.l2_tlb_ways,
         "l2_tlb_latency": cfg.l2_tlb_latency,
+        "tlb_superpage_entries": cfg.tlb_superpage_entries,
+        "l2_tlb_superpage_entries": cfg.l2_tlb_superpage_entries,
+        "page_walk_cache_size": cfg.page_walk_cache_size,
         "software_ad_bits": cfg.software_ad_bits,
         "misaligned_access_trap": cfg.misaligned_access_trap,
+        "huge_pages": cfg.huge_pages.lower(),
+        "numa_local": cfg.numa_local,
     }
     # Always emit DRAM timing keys (Rust expects them)
-    if isinstance(mc, MemoryController.DRAM):
+    if isinstance(mc, (MemoryController.DRAM, MemoryController.FRFCFS)):
         memory["t_cas"] = mc.t_cas
         memory["t_ras"] = mc.t_ras
         memory["t_pre"] = mc.t_pre
@@ -581,6 +769,15 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         memory["t_ras"] = 14
         memory["t_pre"] = 14
         memory["row_miss_latency"] = 120
+    if isinstance(mc, MemoryController.FRFCFS):
+        memory["channels"] = mc.channels
+        memory["ranks"] = mc.ranks
+        memory["read_queue_size"] = mc.read_queue_size
+        memory["write_queue_size"] = mc.write_queue_size
+        memory["write_high_watermark"] = mc.write_high_watermark
+        memory["write_low_watermark"] = mc.write_low_watermark
+        memory["t_burst"] = mc.t_burst
+        memory["t_wtr"] = mc.t_wtr
 
     # Caches
     cache = {
@@ -598,6 +795,19 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         ),
         "inclusion_policy": _inclusion_policy_name(cfg.inclusion_policy),
         "wcb_entries": cfg.wcb_entries,
+        "coherence": {
+            "protocol": cfg.coherence_protocol.upper(),
+            "upgrade_latency": cfg.coherence_upgrade_latency,
+            "invalidation_latency": cfg.coherence_invalidation_latency,
+            "transfer_latency": cfg.coherence_transfer_latency,
+        },
+        "stack_distance": {
+            "enabled": cfg.stack_distance,
+            "line_bytes": cfg.stack_distance_line_bytes,
+            "max_sets": cfg.stack_distance_max_sets,
+            "max_ways": cfg.stack_distance_max_ways,
+            "sampled_sets": cfg.stack_distance_sampled_sets,
+        },
     }
 
     # Pipeline — always emit all BP sub-configs with defaults
@@ -642,6 +852,18 @@ def _config_to_dict_impl(cfg: Config) -> Dict[str, Any]:
         "ittage": ittage_dict,
         "mem_dep_predictor": _mdp_name(mdp),
         "store_set": store_set_dict,
+        "ftq": {"depth": cfg.ftq_depth, "fdip": cfg.fdip},
+        "vector": {
+            "enabled": cfg.vector,
+            "vlen": cfg.vlen,
+            "lanes": cfg.vector_lanes,
+            "alu_latency": cfg.vector_alu_latency,
+            "mul_latency": cfg.vector_mul_latency,
+            "fp_latency": cfg.vector_fp_latency,
+            "div_latency": cfg.vector_div_latency,
+            "queue_depth": cfg.vector_queue_depth,
+            "phys_regs": cfg.vector_phys_regs,
+        },
         **_backend_to_pipeline_fields(cfg.backend),
     }
 
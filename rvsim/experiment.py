@@ -4,20 +4,101 @@ Reproducible experiment API for RISC-V architecture testing.
 Provides:
 - Environment: Immutable description of a run (binary, config, load address).
 - Result: Structured result with exit code, stats, and wall time.
+- SimPoint / Sampling: SimPoint-style sampled simulation. ``Environment.profile``
+  collects basic-block vectors in the functional engine and picks representative
+  intervals; ``Environment.run_sampled`` simulates only those intervals in
+  detail and reports weighted statistics.
+- Checkpoint fan-out: ``Environment.checkpoint`` fast-forwards once and saves
+  the architectural state; ``Environment.run(checkpoint=...)`` starts any
+  microarchitecture from it.
+- Trace replay: ``Environment.run(mem_trace=...)`` records every cache
+  access of a full run; ``Environment.replay`` drives only the cache
+  hierarchy of any config from that trace. ``Environment.run(branch_trace=...)``
+  records every retired branch; ``Environment.replay_branches`` scores many
+  branch predictors on that trace at once.
 """
 
 from __future__ import annotations
 
+import os
+import threading
 import time
 from dataclasses import dataclass, field
-from typing import Any, Dict, List, Optional, Union
+from typing import Any, Dict, List, Optional, Tuple, Union
 
-__all__ = ["Environment", "Result"]
+__all__ = ["Environment", "Result", "SimPoint", "Sampling"]
 
 from .config import Config, _config_to_dict
 from .stats import Stats, _compare_flat, _compare_matrix
 
-from ._core import Cpu
+from ._core import Cpu, replay_branch_trace, replay_mem_trace
+
+# Binary images read by this process, keyed by path: (mtime_ns, size, bytes).
+_BINARY_CACHE: Dict[str, Tuple[int, int, bytes]] = {}
+
+
+def _read_binary(path: str) -> bytes:
+    """Read *path*, reusing this process's copy while the file is unchanged.
+
+    A sweep worker runs many configs of the same few binaries, so each
+    image is read from disk once per worker rather than once per run.
+    """
+    st = os.stat(path)
+    cached = _BINARY_CACHE.get(path)
+    if cached is not None and cached[:2] == (st.st_mtime_ns, st.st_size):
+        return cached[2]
+    with open(path, "rb") as f:
+        data = f.read()
+    _BINARY_CACHE[path] = (st.st_mtime_ns, st.st_size, data)
+    return data
+
+
+@dataclass(frozen=True)
+class SimPoint:
+    """A representative interval and the fraction of execution it stands for."""
+
+    interval: int
+    """Zero-based interval index (in units of the profiling interval)."""
+
+    weight: float
+    """Fraction of all intervals this point represents (weights sum to 1)."""
+
+    @staticmethod
+    def load(simpoints_path: str, weights_path: str) -> List[SimPoint]:
+        """Read the ``.simpoints`` / ``.weights`` files written by the SimPoint tool.
+
+        Both files hold one ``<value> <cluster_id>`` pair per line.
+        """
+
+        def _read(path: str) -> Dict[int, str]:
+            with open(path) as f:
+                pairs = (line.split() for line in f if line.strip())
+                return {int(cluster): value for value, cluster in pairs}
+
+        intervals = _read(simpoints_path)
+        weights = _read(weights_path)
+        points = [
+            SimPoint(interval=int(intervals[c]), weight=float(weights[c]))
+            for c in intervals
+        ]
+        return sorted(points, key=lambda p: p.interval)
+
+
+@dataclass(frozen=True)
+class Sampling:
+    """Settings for SimPoint-style sampled simulation (see ``Sweep.run``)."""
+
+    interval: int = 100_000_000
+    """Instructions per profiling interval (and per detailed region)."""
+
+    warmup: int = 0
+    """Detailed-mode instructions simulated before each region and discarded."""
+
+    max_k: int = 30
+    """Maximum number of simulation points."""
+
+    warm: bool = True
+    """Train caches and branch predictor while fast-forwarding to each region."""
 
 
 @dataclass
@@ -43,7 +124,14 @@ class Environment:
         return Config().to_dict()
 
     def run(
-        self, quiet: bool = True, limit: Optional[int] = None, progress: int = 0
+        self,
+        quiet: bool = True,
+        limit: Optional[int] = None,
+        progress: int = 0,
+        checkpoint: Optional[str] = None,
+        mem_trace: Optional[str] = None,
+        branch_trace: Optional[str] = None,
+        time_limit: Optional[float] = None,
     ) -> Result:
         """
         Run the simulation and return a :class:`Result`.
@@ -51,6 +139,15 @@ class Environment:
         Args:
             quiet: Suppress exceptions and return error Result instead.
             limit: Max cycles to simulate. ``None`` means unlimited.
+            time_limit: Stop after this many wall-clock seconds. A run cut
+                short by either limit returns ``exit_code == -1`` with the
+                stats gathered so far.
+            checkpoint: Start from this checkpoint (see :meth:`checkpoint`)
+                instead of the program entry. Stats cover only the resumed run.
+            mem_trace: Record every cache-hierarchy access to this file for
+                :meth:`replay`.
+            branch_trace: Record every retired branch and jump to this file
+                for :meth:`replay_branches`.
 
         Example::
 
@@ -61,11 +158,27 @@ class Environment:
         config = self.get_config()
         t0 = time.perf_counter()
         try:
-            with open(self.binary, "rb") as f:
-                elf_data = f.read()
-            cpu = Cpu(config, elf_data=elf_data, disk_path=self.disk)
-            exit_code = cpu.run(limit=limit, progress=progress)
-            if exit_code is None and limit is None:
+            cpu = self._build(config)
+            if checkpoint is not None:
+                cpu.restore(checkpoint)
+            if mem_trace is not None:
+                cpu.open_mem_trace(mem_trace)
+            if branch_trace is not None:
+                cpu.open_branch_trace(branch_trace)
+            timer = None
+            if time_limit is not None:
+                # The run loop releases the GIL, so the timer thread fires
+                # on time and the run stops within one slice.
+                timer = threading.Timer(time_limit, cpu.interrupt_handle().interrupt)
+                timer.start()
+            try:
+                exit_code = cpu.run(limit=limit, progress=progress)
+            finally:
+                if timer is not None:
+                    timer.cancel()
+            cpu.close_mem_trace()
+            cpu.close_branch_trace()
+            if exit_code is None and limit is None and time_limit is None:
                 raise RuntimeError(
                     "CPU run completed without exit code (should not happen without limit)"
                 )
@@ -88,6 +201,270 @@ class Environment:
             binary=self.binary,
         )
 
+    def replay(self, mem_trace: str, quiet: bool = True) -> Result:
+        """
+        Replay a memory trace through this config's cache hierarchy.
+
+        Nothing is executed, so only the cache, prefetch, and MSHR counters
+        are meaningful; ``cycles`` is the captured run's. Replaying under the
+        capturing in-order config reproduces its cache counters exactly;
+        under another geometry the captured access timing is kept.
+
+        Args:
+            mem_trace: Trace recorded by :meth:`run` with ``mem_trace=``.
+            quiet: Suppress exceptions and return error Result instead.
+
+        Example::
+
+            env = Environment(binary="software/bin/benchmarks/qsort.elf")
+            env.run(mem_trace="qsort.mtr")
+            big = Environment(binary=env.binary, config=Config(l1d=Cache("64KB")))
+            print(big.replay("qsort.mtr").stats["dcache_misses"])
+        """
+        t0 = time.perf_counter()
+        try:
+            stats = replay_mem_trace(self.get_config(), mem_trace)
+        except Exception as e:
+            if not quiet:
+                raise
+            return Result(
+                exit_code=-1,
+                stats=Stats({"error": str(e)}),
+                wall_time_sec=time.perf_counter() - t0,
+                binary=self.binary,
+            )
+        return Result(
+            exit_code=0,
+            stats=Stats(stats),
+            wall_time_sec=time.perf_counter() - t0,
+            binary=self.binary,
+        )
+
+    def replay_branches(
+        self,
+        branch_trace: str,
+        configs: Dict[str, Union[Config, Dict[str, Any]]],
+        quiet: bool = True,
+    ) -> Dict[str, Result]:
+        """
+        Score the branch predictor of each config on a branch trace.
+
+        Only the predictors run, one per host thread, so a whole predictor
+        sweep costs about one pass over the trace. Retired branches do not
+        depend on the predictor or core model, so one trace serves any
+        config. ``inst_branch`` counts the traced branches and jumps, and
+        ``branch_accuracy_pct`` and ``branch_mispredictions`` score the
+        conditional branches as a full run does.
+
+        Args:
+            branch_trace: Trace recorded by :meth:`run` with ``branch_trace=``.
+            configs: Name to config for each predictor to score.
+            quiet: Suppress exceptions and return error Results instead.
+
+        Example::
+
+            env = Environment(binary="software/bin/benchmarks/qsort.elf")
+            env.run(branch_trace="qsort.btr")
+            results = env.replay_branches("qsort.btr", {
+                "gshare": Config(branch_predictor=BranchPredictor.GShare()),
+                "tage": Config(branch_predictor=BranchPredictor.TAGE()),
+            })
+            print(results["tage"].stats["branch_accuracy_pct"])
+        """
+        t0 = time.perf_counter()
+        try:
+            dicts = [_config_to_dict(c) for c in configs.values()]
+            all_stats = replay_branch_trace(dicts, branch_trace)
+        except Exception as e:
+            if not quiet:
+                raise
+            wall = time.perf_counter() - t0
+            return {
+                name: Result(
+                    exit_code=-1,
+                    stats=Stats({"error": str(e)}),
+                    wall_time_sec=wall,
+                    binary=self.binary,
+                )
+                for name in configs
+            }
+        wall = time.perf_counter() - t0
+        return {
+            name: Result(exit_code=0, stats=Stats(stats), wall_time_sec=wall, binary=self.binary)
+            for name, stats in zip(configs, all_stats)
+        }
+
+    def checkpoint(self, path: str, instructions: int) -> None:
+        """
+        Fast-forward *instructions* in the functional engine and save a checkpoint.
+
+        The checkpoint holds only architectural state, so it can be restored
+        into any single-hart config with the same RAM layout. RAM is mapped
+        copy-on-write on restore, so many workers resuming from one checkpoint
+        share its pages instead of each holding a private copy.
+
+        Raises:
+            RuntimeError: If the program exits before *instructions* retire,
+                or the system cannot be checkpointed (more than one hart, or
+                a PLIC, UART, or VirtIO disk the guest has configured).
+
+        Example::
+
+            env = Environment(binary="software/bin/benchmarks/qsort.elf")
+            env.checkpoint("qsort.ckpt", 50_000_000)
+            result = env.run(checkpoint="qsort.ckpt", limit=10_000_000)
+        """
+        config = self.get_config()
+        general = config.setdefault("general", {})
+        general["fast_forward"] = {"enabled": True}
+        cpu = self._build(config)
+        exit_code = cpu.run_instructions(instructions)
+        if exit_code is not None:
+            raise RuntimeError(
+                f"program exited with code {exit_code} before the checkpoint"
+            )
+        cpu.save(path)
+
+    def profile(
+        self,
+        interval: int = 100_000_000,
+        *,
+        max_k: int = 30,
+        bbv_path: Optional[str] = None,
+        limit: Optional[int] = None,
+        seed: int = 42,
+    ) -> List[SimPoint]:
+        """
+        Profile the whole program in the functional engine and pick simulation points.
+
+        Args:
+            interval: Instructions per basic-block-vector interval.
+            max_k: Maximum number of simulation points.
+            bbv_path: Also write the vectors to this SimPoint ``.bb`` file.
+            limit: Max cycles to profile. ``None`` means run to exit.
+            seed: Seed for the random projection and k-means.
+
+        Example::
+
+            env = Environment(binary="software/bin/benchmarks/qsort.elf")
+            points = env.profile(interval=10_000_000, bbv_path="qsort.bb")
+            result = env.run_sampled(points, interval=10_000_000)
+            print(result.stats["ipc"])
+        """
+        config = self.get_config()
+        general = config.setdefault("general", {})
+        general["fast_forward"] = {"enabled": True, "bbv_interval": interval}
+        cpu = self._build(config)
+        cpu.run(limit=limit)
+        if bbv_path is not None:
+            cpu.write_bbv(bbv_path)
+        return [SimPoint(i, w) for i, w in cpu.simpoints(max_k=max_k, seed=seed)]
+
+    def run_sampled(
+        self,
+        simpoints: List[SimPoint],
+        interval: int = 100_000_000,
+        *,
+        warmup: int = 0,
+        warm: bool = True,
+        quiet: bool = True,
+    ) -> Result:
+        """
+        Simulate only the given intervals in detail and return weighted stats.
+
+        Each point gets a fresh CPU that fast-forwards functionally to the
+        start of its interval (minus *warmup*), runs *warmup* detailed
+        instructions, then measures *interval* instructions. Counters in the
+        returned stats are the weighted average per interval; ``ipc`` and
+        ``cpi`` are derived from the weighted CPI, as SimPoint prescribes.
+
+        Args:
+            simpoints: Points from :meth:`profile` or :meth:`SimPoint.load`.
+            interval: Instructions per interval (must match the profile).
+            warmup: Detailed instructions simulated and discarded before each region.
+            warm: Train caches and predictor while fast-forwarding.
+            quiet: Suppress exceptions and return error Result instead.
+        """
+        t0 = time.perf_counter()
+        regions: List[Tuple[float, Dict[str, Any]]] = []
+        try:
+            for point in simpoints:
+                delta = self._run_region(point, interval, warmup, warm)
+                if delta is not None:
+                    regions.append((point.weight, delta))
+            if not regions:
+                raise RuntimeError(
+                    "program exited before reaching any simulation point"
+                )
+        except Exception as e:
+            if not quiet:
+                raise
+            return Result(
+                exit_code=-1,
+                stats=Stats({"error": str(e)}),
+                wall_time_sec=time.perf_counter() - t0,
+                binary=self.binary,
+            )
+        return Result(
+            exit_code=0,
+            stats=Stats(_weighted_stats(regions)),
+            wall_time_sec=time.perf_counter() - t0,
+            binary=self.binary,
+        )
+
+    def _run_region(
+        self, point: SimPoint, interval: int, warmup: int, warm: bool
+    ) -> Optional[Dict[str, Any]]:
+        """Measure one interval; ``None`` if the program exits before it starts."""
+        start = point.interval * interval
+        detail_start = max(0, start - warmup)
+        config = self.get_config()
+        general = config.setdefault("general", {})
+        general["fast_forward"] = {
+            "enabled": True,
+            "until_instructions": detail_start,
+            "warm": warm,
+        }
+        cpu = self._build(config)
+        if cpu.run_instructions(detail_start) is not None:
+            return None
+        if cpu.run_instructions(start - detail_start) is not None:
+            return None
+        before = cpu.stats
+        cpu.run_instructions(interval)
+        after = cpu.stats
+        return {
+            k: after[k] - before[k]
+            for k, v in after.items()
+            if isinstance(v, int) and not isinstance(v, bool)
+        }
+
+    def _build(self, config: Dict[str, Any]) -> Cpu:
+        return Cpu(config, elf_data=_read_binary(self.binary), disk_path=self.disk)
+
+
+def _weighted_stats(regions: List[Tuple[float, Dict[str, Any]]]) -> Dict[str, Any]:
+    """Combine per-region counter deltas using normalized SimPoint weights."""
+    total_weight = sum(w for w, _ in regions) or 1.0
+    out: Dict[str, Any] = {}
+    cpi = 0.0
+    for weight, delta in regions:
+        w = weight / total_weight
+        for k, v in delta.items():
+            out[k] = out.get(k, 0.0) + w * v
+        insts = delta.get("instructions_retired", 0)
+        cpi += w * (delta.get("cycles", 0) / insts if insts else 0.0)
+    out["cpi"] = cpi
+    out["ipc"] = 1.0 / cpi if cpi > 0 else 0.0
+    total_bp = out.get("branch_predictions", 0.0) + out.get(
+        "branch_mispredictions", 0.0
+    )
+    out["branch_accuracy_pct"] = (
+        100.0 * out.get("branch_predictions", 0.0) / total_bp if total_bp else 0.0
+    )
+    out["simpoints"] = len(regions)
+    return out
+
 
 @dataclass
 class Result:
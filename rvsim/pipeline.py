@@ -9,8 +9,20 @@ contents as a Gantt-style diagram::
     snap = cpu.pipeline_snapshot()
     snap.visualize()        # print to stdout
     text = snap.render()    # get as string
+
+``cpu.record_pipeline_history(cycles)`` keeps the last *cycles* cycles in a
+preallocated native ring, and ``cpu.pipeline_history()`` returns a live
+:class:`PipelineHistory` over it. Indexing copies out one
+:class:`PipelineFrame`, which renders the same way, so the cycles around a
+mispredict or a stall can be replayed without re-simulating::
+
+    cpu.record_pipeline_history(100_000)
+    cpu.run(limit=1_000_000)
+    history = cpu.pipeline_history()
+    for i in range(-5, 0):
+        history[i].visualize()
 """
 
-from ._core import PipelineSnapshot
+from ._core import PipelineFrame, PipelineHistory, PipelineSnapshot
 
-__all__ = ["PipelineSnapshot"]
+__all__ = ["PipelineFrame", "PipelineHistory", "PipelineSnapshot"]
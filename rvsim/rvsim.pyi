@@ -1,6 +1,6 @@
 """Type stubs for rvsim."""
 
-from typing import Any, Dict, List, Optional, Union
+from typing import Any, Dict, List, Optional, Sequence, Union
 
 # ── pipeline.py ───────────────────────────────────────────────────────────────
 
@@ -32,6 +32,50 @@ class PipelineSnapshot:
         """Print the pipeline diagram to stdout."""
         ...
 
+class PipelineFrame:
+    """One recorded cycle of a :class:`PipelineHistory`.
+
+    Latch attributes hold ``{pc, raw, asm}`` slot dicts, plus ``rob_tag``
+    from ``rename_issue`` on and ``ready`` in ``issue_queue``.
+    """
+
+    cycle: int
+    width: int
+    fetch1_fetch2: List[Dict[str, Any]]
+    fetch2_decode: List[Dict[str, Any]]
+    decode_rename: List[Dict[str, Any]]
+    rename_issue: List[Dict[str, Any]]
+    issue_queue: List[Dict[str, Any]]
+    execute_mem1: List[Dict[str, Any]]
+    mem1_mem2: List[Dict[str, Any]]
+    mem2_wb: List[Dict[str, Any]]
+    issue_queue_len: int
+    fetch1_stall: int
+    fetch2_stall: int
+    mem1_stall: int
+
+    def render(self) -> str:
+        """Return the pipeline diagram of this cycle as a string."""
+        ...
+
+    def visualize(self) -> None:
+        """Print the pipeline diagram of this cycle to stdout."""
+        ...
+
+class PipelineHistory:
+    """Live view of the last N recorded cycles, oldest first.
+
+    Obtained via ``cpu.pipeline_history()`` after ``cpu.record_pipeline_history()``.
+    """
+
+    capacity: int
+
+    def __len__(self) -> int: ...
+    def __getitem__(self, i: int) -> PipelineFrame: ...
+    def at(self, cycle: int) -> Optional[PipelineFrame]:
+        """The record of *cycle* (a ``stats["cycles"]`` value), if still held."""
+        ...
+
 # ── types.py ─────────────────────────────────────────────────────────────────
 
 class BranchPredictor:
@@ -109,6 +153,35 @@ class MemoryController:
             row_miss_latency: int = 120,
         ) -> None: ...
 
+    class FRFCFS:
+        t_cas: int
+        t_ras: int
+        t_pre: int
+        row_miss_latency: int
+        channels: int
+        ranks: int
+        read_queue_size: int
+        write_queue_size: int
+        write_high_watermark: int
+        write_low_watermark: int
+        t_burst: int
+        t_wtr: int
+        def __init__(
+            self,
+            t_cas: int = 14,
+            t_ras: int = 14,
+            t_pre: int = 14,
+            row_miss_latency: int = 120,
+            channels: int = 1,
+            ranks: int = 1,
+            read_queue_size: int = 32,
+            write_queue_size: int = 32,
+            write_high_watermark: int = 24,
+            write_low_watermark: int = 8,
+            t_burst: int = 4,
+            t_wtr: int = 8,
+        ) -> None: ...
+
 class Fu:
     class IntAlu:
         count: int
@@ -155,6 +228,11 @@ class Fu:
         latency: int
         def __init__(self, count: int = 2, latency: int = 1) -> None: ...
 
+    class Vector:
+        count: int
+        latency: int
+        def __init__(self, count: int = 1, latency: int = 1) -> None: ...
+
     units: List[Any]
     def __init__(self, units: Optional[List[Any]] = None) -> None: ...
 
@@ -211,6 +289,13 @@ class Config:
     backend: Any
     btb_size: int
     ras_size: int
+    ftq_depth: int
+    fdip: bool
+    vector: bool
+    vlen: int
+    vector_lanes: int
+    vector_queue_depth: int
+    vector_phys_regs: int
     l1i: Optional[Cache]
     l1d: Optional[Cache]
     l2: Optional[Cache]
@@ -218,8 +303,21 @@ class Config:
     ram_size: int
     memory_controller: Any
     tlb_size: int
+    huge_pages: str
+    numa_local: bool
     trace: bool
     initial_sp: Optional[int]
+    idle_skip: bool
+    fast_forward: bool
+    fast_forward_pc: Optional[int]
+    fast_forward_insts: Optional[int]
+    fast_forward_marker: bool
+    fast_forward_warm: bool
+    fast_forward_dbt: bool
+    bbv_interval: Optional[int]
+    roi_stats: bool
+    roi_detailed: bool
+    roi_checkpoint: Optional[str]
     ram_base: int
     uart_base: int
     disk_base: int
@@ -238,6 +336,17 @@ class Config:
         backend: Any = None,
         btb_size: int = 4096,
         ras_size: int = 32,
+        ftq_depth: int = 0,
+        fdip: bool = True,
+        vector: bool = False,
+        vlen: int = 128,
+        vector_lanes: int = 2,
+        vector_alu_latency: int = 2,
+        vector_mul_latency: int = 4,
+        vector_fp_latency: int = 4,
+        vector_div_latency: int = 20,
+        vector_queue_depth: int = 8,
+        vector_phys_regs: int = 32,
         l1i: Optional[Cache] = None,
         l1d: Optional[Cache] = None,
         l2: Optional[Cache] = None,
@@ -245,8 +354,21 @@ class Config:
         ram_size: str | int = "256MB",
         memory_controller: Any = None,
         tlb_size: int = 32,
+        huge_pages: str = "off",
+        numa_local: bool = False,
         trace: bool = False,
         initial_sp: Optional[int] = None,
+        idle_skip: bool = True,
+        fast_forward: bool = False,
+        fast_forward_pc: Optional[int] = None,
+        fast_forward_insts: Optional[int] = None,
+        fast_forward_marker: bool = False,
+        fast_forward_warm: bool = False,
+        fast_forward_dbt: bool = False,
+        bbv_interval: Optional[int] = None,
+        roi_stats: bool = False,
+        roi_detailed: bool = False,
+        roi_checkpoint: Optional[str] = None,
         ram_base: int = 0x8000_0000,
         uart_base: int = 0x1000_0000,
         disk_base: int = 0x9000_0000,
@@ -268,6 +390,8 @@ class Stats(dict):
     def __init__(self, data: Dict[str, Any]) -> None: ...
     def query(self, pattern: str) -> Stats: ...
     def compare(self, other: Stats) -> None: ...
+    def mrc(self, ways: Optional[int] = None) -> list[tuple[int, int, int, float]]: ...
+    def stage_times(self) -> list[tuple[str, int, int, float, float]]: ...
     @staticmethod
     def tabulate(rows: Dict[str, Stats], *, title: str = "") -> Table: ...
 
@@ -316,6 +440,7 @@ class Cpu:
     def mem64(self) -> Memory: ...
     @property
     def pc_trace(self) -> list[tuple[int, int]]: ...
+    def interrupt_handle(self) -> InterruptHandle: ...
     def step(self, max_cycles: int = 100_000) -> Optional[Instruction]: ...
     def run(
         self,
@@ -324,6 +449,16 @@ class Cpu:
         stats_sections: Optional[list[str]] = None,
     ) -> Optional[int]: ...
     def sample(self, every: int, limit: Optional[int] = None) -> list[dict]: ...
+    def record_intervals(
+        self, path: str, every: int, limit: Optional[int] = None
+    ) -> int: ...
+    def run_instructions(
+        self, count: int, limit: Optional[int] = None
+    ) -> Optional[int]: ...
+    @property
+    def mode(self) -> str: ...
+    def write_bbv(self, path: str) -> None: ...
+    def simpoints(self, max_k: int = 30, seed: int = 42) -> list[tuple[int, float]]: ...
     def run_until(
         self,
         predicate: Any = None,
@@ -335,8 +470,17 @@ class Cpu:
     ) -> Optional[int]: ...
     def tick(self) -> None: ...
     def pipeline_snapshot(self) -> PipelineSnapshot: ...
+    def record_pipeline_history(self, cycles: int = 100_000) -> None: ...
+    def pipeline_history(self) -> Optional[PipelineHistory]: ...
     def save(self, path: str) -> None: ...
     def restore(self, path: str) -> None: ...
+    def open_mem_trace(self, path: str) -> None: ...
+    def close_mem_trace(self) -> int: ...
+    def open_branch_trace(self, path: str) -> None: ...
+    def close_branch_trace(self) -> int: ...
+
+class InterruptHandle:
+    def interrupt(self) -> None: ...
 
 class Registers:
     def __getitem__(self, idx: int) -> int: ...
@@ -380,9 +524,62 @@ class Environment:
     ) -> None: ...
     def get_config(self) -> Dict[str, Any]: ...
     def run(
-        self, quiet: bool = True, limit: Optional[int] = None, progress: int = 0
+        self,
+        quiet: bool = True,
+        limit: Optional[int] = None,
+        progress: int = 0,
+        checkpoint: Optional[str] = None,
+        mem_trace: Optional[str] = None,
+        branch_trace: Optional[str] = None,
+        time_limit: Optional[float] = None,
+    ) -> Result: ...
+    def replay(self, mem_trace: str, quiet: bool = True) -> Result: ...
+    def replay_branches(
+        self,
+        branch_trace: str,
+        configs: Dict[str, Union[Config, Dict[str, Any]]],
+        quiet: bool = True,
+    ) -> Dict[str, Result]: ...
+    def checkpoint(self, path: str, instructions: int) -> None: ...
+    def profile(
+        self,
+        interval: int = 100_000_000,
+        *,
+        max_k: int = 30,
+        bbv_path: Optional[str] = None,
+        limit: Optional[int] = None,
+        seed: int = 42,
+    ) -> List[SimPoint]: ...
+    def run_sampled(
+        self,
+        simpoints: List[SimPoint],
+        interval: int = 100_000_000,
+        *,
+        warmup: int = 0,
+        warm: bool = True,
+        quiet: bool = True,
     ) -> Result: ...
 
+class SimPoint:
+    interval: int
+    weight: float
+    def __init__(self, interval: int, weight: float) -> None: ...
+    @staticmethod
+    def load(simpoints_path: str, weights_path: str) -> List[SimPoint]: ...
+
+class Sampling:
+    interval: int
+    warmup: int
+    max_k: int
+    warm: bool
+    def __init__(
+        self,
+        interval: int = 100_000_000,
+        warmup: int = 0,
+        max_k: int = 30,
+        warm: bool = True,
+    ) -> None: ...
+
 class Result:
     exit_code: int
     stats: Stats
@@ -407,6 +604,28 @@ class Result:
         col_header: str = "",
     ) -> None: ...
 
+# ── suite.py ─────────────────────────────────────────────────────────────────
+
+class TestOutcome:
+    config: str
+    binary: str
+    exit_code: Optional[int]
+    cycles: int
+    instructions: int
+    signature: Optional[bytes]
+    error: Optional[str]
+    @property
+    def passed(self) -> bool: ...
+    def signature_hex(self, granularity: int = 16) -> Optional[str]: ...
+
+def run_suite(
+    binaries: Sequence[str],
+    configs: Dict[str, Union[Config, Dict[str, Any]]],
+    *,
+    limit: Optional[int] = None,
+    threads: int = 0,
+) -> List[TestOutcome]: ...
+
 # ── isa.py ───────────────────────────────────────────────────────────────────
 
 class _RegLookup:
@@ -2,18 +2,22 @@
 Simulation statistics container with pattern-based querying and comparison.
 
 Provides ``Stats`` (dict subclass) with ``.query(pattern)`` for filtering,
-``.compare(other)`` for two-way comparison, and ``.tabulate()`` for multi-run
-tables.
+``.compare(other)`` for two-way comparison, ``.tabulate()`` for multi-run
+tables, ``.mrc()`` for the miss-ratio curve of a stack-distance profile, and
+``.stage_times()`` for the host time of each pipeline stage, and
+``IntervalStats`` for the per-interval rows of ``Cpu.record_intervals()``.
 """
 
 from __future__ import annotations
 
 import math
+import mmap
 import re
+import struct
 import sys
-from typing import Any, Dict, List, Optional, Sequence, Union
+from typing import Any, Dict, List, Optional, Sequence, Tuple, Union
 
-__all__ = ["Stats", "Table"]
+__all__ = ["IntervalStats", "Stats", "Table"]
 
 
 class Stats(dict):
@@ -24,6 +28,9 @@ class Stats(dict):
     cycles, instructions_retired, ipc, icache_hits, icache_misses, dcache_hits,
     dcache_misses, l2_hits, l2_misses, l3_hits, l3_misses, stalls_mem, stalls_control,
     stalls_data, branch_predictions, branch_mispredictions, branch_accuracy_pct, etc.
+    With ``Config(stack_distance=True)`` the ``stack_distance`` key holds the
+    profile behind :meth:`mrc`. A build with the ``stage-timing`` feature adds
+    ``host_ns_<stage>`` and ``host_calls_<stage>`` for :meth:`stage_times`.
 
     Example::
 
@@ -52,6 +59,79 @@ class Stats(dict):
 
         return Stats(matches)
 
+    def mrc(self, ways: Optional[int] = None) -> List[Tuple[int, int, int, float]]:
+        """LRU miss-ratio curve from the stack-distance profile.
+
+        Requires a run with ``Config(stack_distance=True)``, which profiles
+        every power-of-two set count and associativity of the L1-D access
+        stream in one pass (sampled above ``stack_distance_sampled_sets``).
+
+        Args:
+            ways: Keep only this associativity (default: every one profiled).
+
+        Returns:
+            ``(size_bytes, sets, ways, miss_ratio)`` tuples sorted by size,
+            then associativity.
+
+        Raises:
+            ValueError: If the run kept no stack-distance profile.
+        """
+        profile = self.get("stack_distance")
+        if profile is None:
+            raise ValueError(
+                "no stack-distance profile; run with Config(stack_distance=True)"
+            )
+        line = profile["line_bytes"]
+        curve = []
+        for sets, accesses, hits in zip(
+            profile["sets"], profile["accesses"], profile["hits"]
+        ):
+            hit = 0
+            for w, depth_hits in enumerate(hits, start=1):
+                hit += depth_hits
+                if ways is not None and w != ways:
+                    continue
+                ratio = 1.0 - hit / accesses if accesses else 0.0
+                curve.append((sets * w * line, sets, w, ratio))
+        curve.sort(key=lambda p: (p[0], p[2]))
+        return curve
+
+    def stage_times(self) -> List[Tuple[str, int, int, float, float]]:
+        """Host time spent in each pipeline stage, ``Bus::tick``, and the
+        cache hierarchy.
+
+        Requires a build with the ``stage-timing`` Cargo feature (e.g.
+        ``maturin develop --features stage-timing``).
+
+        Returns:
+            ``(stage, host_ns, calls, ns_per_cycle, share)`` tuples in
+            pipeline order, where *share* is the fraction of the total timed
+            host time. The ``hierarchy`` time is also counted in the stages
+            that accessed the caches, so it is left out of the total.
+
+        Raises:
+            ValueError: If the stats carry no stage timings.
+        """
+        stages = [k[len("host_ns_"):] for k in self if k.startswith("host_ns_")]
+        if not stages:
+            raise ValueError(
+                "no stage timings; build rvsim with the stage-timing feature"
+            )
+        cycles = max(self.get("cycles", 0), 1)
+        total = max(
+            sum(self[f"host_ns_{s}"] for s in stages if s != "hierarchy"), 1
+        )
+        return [
+            (
+                s,
+                self[f"host_ns_{s}"],
+                self[f"host_calls_{s}"],
+                self[f"host_ns_{s}"] / cycles,
+                self[f"host_ns_{s}"] / total,
+            )
+            for s in stages
+        ]
+
     @staticmethod
     def tabulate(rows: Dict[str, Stats], *, title: str = "") -> Table:
         """Build a comparison table from labeled :class:`Stats` objects.
@@ -85,7 +165,11 @@ class Stats(dict):
 
     def compare(self, other: Stats) -> None:
         """Print a two-column comparison table (self vs other) to stdout."""
-        all_keys = sorted(set(self) | set(other))
+        all_keys = sorted(
+            k
+            for k in set(self) | set(other)
+            if not isinstance(self.get(k, other.get(k)), dict)
+        )
         if not all_keys:
             print("(no stats to compare)")
             return
@@ -108,10 +192,10 @@ class Stats(dict):
             )
 
     def __repr__(self) -> str:
-        if not self:
+        items = sorted((k, v) for k, v in self.items() if not isinstance(v, dict))
+        if not items:
             return "Stats({})"
-        items = sorted(self.items())
-        key_w = max(len(k) for k in self.keys())
+        key_w = max(len(k) for k, _ in items)
         val_w = max(len(_fmt(v)) for _, v in items)
 
         is_tty = hasattr(sys.stdout, "isatty") and sys.stdout.isatty()
@@ -138,6 +222,111 @@ class Stats(dict):
 # ── Formatting helpers ───────────────────────────────────────────────────────
 
 
+class IntervalStats:
+    """
+    Per-interval counter deltas written by ``Cpu.record_intervals()``.
+
+    The file is memory-mapped, and each column is a strided ``memoryview``
+    of ``uint64`` over the mapping, so nothing is copied until it is read;
+    ``numpy.asarray(iv["dcache_misses"])`` wraps a column directly. The
+    ``cycle`` column holds the machine cycle at the end of each interval;
+    every other column holds the change of that counter over the interval.
+    Rows appended by a run still in progress are not visible until the file
+    is reopened.
+
+    Example::
+
+        cpu.record_intervals("run.ist", every=100_000)
+        with IntervalStats("run.ist") as iv:
+            misses = iv["dcache_misses"]
+            print(max(misses), iv.row(0)["ipc"])
+    """
+
+    MAGIC = b"RVSIMIST"
+    VERSION = 1
+
+    def __init__(self, path: str):
+        self.path = path
+        with open(path, "rb") as f:
+            preamble = f.read(24)
+            if len(preamble) < 24 or preamble[:8] != self.MAGIC:
+                raise ValueError(f"{path}: not an rvsim interval statistics file")
+            version, ncols, header_len = struct.unpack_from("<IIQ", preamble, 8)
+            if version != self.VERSION:
+                raise ValueError(
+                    f"{path}: unsupported interval statistics version {version}"
+                )
+            names = f.read(header_len - 24).rstrip(b"\0").decode().split("\n")
+            if len(names) != ncols:
+                raise ValueError(f"{path}: malformed interval statistics header")
+            self.columns: List[str] = names
+            self._index = {name: i for i, name in enumerate(names)}
+            size = f.seek(0, 2)
+            self._rows = (size - header_len) // (8 * ncols)
+            if self._rows:
+                self._map: Optional[mmap.mmap] = mmap.mmap(
+                    f.fileno(), 0, access=mmap.ACCESS_READ
+                )
+                start = header_len
+                view = memoryview(self._map)[start : start + 8 * ncols * self._rows]
+                self._values = view.cast("Q")
+                if sys.byteorder != "little":
+                    swapped = bytearray(view)
+                    for i in range(0, len(swapped), 8):
+                        swapped[i : i + 8] = swapped[i : i + 8][::-1]
+                    self._values = memoryview(bytes(swapped)).cast("Q")
+            else:
+                self._map = None
+                self._values = memoryview(b"").cast("Q")
+
+    def __len__(self) -> int:
+        return self._rows
+
+    def __getitem__(self, name: str) -> memoryview:
+        """Column *name* as a ``uint64`` view, one element per interval."""
+        try:
+            j = self._index[name]
+        except KeyError:
+            raise KeyError(f"no interval column {name!r}") from None
+        return self._values[j :: len(self.columns)]
+
+    def row(self, i: int) -> Stats:
+        """Interval *i* as a :class:`Stats`, with ``ipc`` over the interval."""
+        if not -self._rows <= i < self._rows:
+            raise IndexError(f"interval {i} out of range")
+        i %= self._rows
+        n = len(self.columns)
+        data: Dict[str, Any] = dict(
+            zip(self.columns, self._values[i * n : (i + 1) * n].tolist())
+        )
+        cycles = data.get("cycles", 0)
+        data["ipc"] = data.get("instructions_retired", 0) / cycles if cycles else 0.0
+        return Stats(data)
+
+    def close(self) -> None:
+        """Release the mapping.
+
+        A mapping still viewed by a column taken from it is left for the
+        garbage collector to unmap once the last view goes away.
+        """
+        self._values.release()
+        if self._map is not None:
+            try:
+                self._map.close()
+            except BufferError:
+                pass
+            self._map = None
+
+    def __enter__(self) -> IntervalStats:
+        return self
+
+    def __exit__(self, *exc: Any) -> None:
+        self.close()
+
+    def __repr__(self) -> str:
+        return f"IntervalStats({self.path!r}, {self._rows} intervals, {len(self.columns)} columns)"
+
+
 def _fmt(v) -> str:
     if isinstance(v, float):
         return f"{v:.4f}"
@@ -174,6 +363,25 @@ _COUNT_METRICS = {
     "stalls_mem",
     "stalls_control",
     "stalls_data",
+    "tma_slots",
+    "tma_retiring",
+    "tma_bad_speculation",
+    "tma_bad_spec_squashed",
+    "tma_bad_spec_recovery",
+    "tma_frontend_bound",
+    "tma_fe_icache",
+    "tma_fe_itlb",
+    "tma_fe_resteer",
+    "tma_fe_bandwidth",
+    "tma_backend_bound",
+    "tma_be_memory",
+    "tma_be_mem_l1",
+    "tma_be_mem_l2",
+    "tma_be_mem_l3",
+    "tma_be_mem_dram",
+    "tma_be_core",
+    "tma_be_core_fu",
+    "tma_be_core_other",
     "stalls_fu_structural",
     "stalls_backpressure",
     "misprediction_penalty",
@@ -181,6 +389,11 @@ _COUNT_METRICS = {
     "mem_ordering_violations",
     "icache_hits",
     "icache_misses",
+    "ftq_occupancy",
+    "stalls_ftq_full",
+    "fdip_prefetches",
+    "fdip_useful",
+    "fdip_late",
     "dcache_hits",
     "dcache_misses",
     "l2_hits",
@@ -204,6 +417,10 @@ _COUNT_METRICS = {
     "inst_fp_arith",
     "inst_fp_fma",
     "inst_fp_div_sqrt",
+    "inst_vector",
+    "vector_elements",
+    "vector_mem_lines",
+    "stalls_vector",
 }
 
 
@@ -0,0 +1,114 @@
+"""
+In-process batched test-suite runs.
+
+``run_suite`` runs every test ELF (riscv-tests, torture tests, arch tests)
+under every config in one call. The whole batch runs in Rust on a pool of
+host threads with the GIL released, and each thread reuses one simulator,
+reset between tests, so a suite of thousands of short tests costs neither
+a ``Simulator`` build per test nor a Python round trip per run.
+
+Example::
+
+    outcomes = run_suite(glob.glob("rv64ui-p-*"), {
+        "inorder": Config(backend=Backend.InOrder()),
+        "o3": Config(backend=Backend.OutOfOrder()),
+    }, limit=500_000)
+    failed = [o for o in outcomes if not o.passed]
+"""
+
+from __future__ import annotations
+
+from dataclasses import dataclass
+from typing import Any, Dict, List, Optional, Sequence, Union
+
+__all__ = ["TestOutcome", "run_suite"]
+
+from .config import Config, _config_to_dict
+from .experiment import _read_binary
+
+from ._core import run_suite as _run_suite
+
+
+@dataclass(frozen=True)
+class TestOutcome:
+    """Result of one test binary under one config."""
+
+    config: str
+    """Name of the config the test ran under."""
+
+    binary: str
+    """Path to the test binary."""
+
+    exit_code: Optional[int]
+    """HTIF exit code (0 = pass), or None if the cycle limit was reached or the run failed."""
+
+    cycles: int
+    """Cycles simulated."""
+
+    instructions: int
+    """Instructions retired."""
+
+    signature: Optional[bytes]
+    """Memory between the ``begin_signature`` and ``end_signature`` symbols, if both exist."""
+
+    error: Optional[str] = None
+    """Simulator error message, if the run failed."""
+
+    @property
+    def passed(self) -> bool:
+        """True if the test exited with code 0."""
+        return self.exit_code == 0
+
+    def signature_hex(self, granularity: int = 16) -> Optional[str]:
+        """Format the signature as Spike's ``+signature=`` file does.
+
+        One line per *granularity* bytes, each printed as a little-endian
+        hex number (most significant byte first).
+        """
+        if self.signature is None:
+            return None
+        sig = self.signature
+        lines = [
+            sig[i : i + granularity][::-1].hex().rjust(2 * granularity, "0")
+            for i in range(0, len(sig), granularity)
+        ]
+        return "\n".join(lines)
+
+
+def run_suite(
+    binaries: Sequence[str],
+    configs: Dict[str, Union[Config, Dict[str, Any]]],
+    *,
+    limit: Optional[int] = None,
+    threads: int = 0,
+) -> List[TestOutcome]:
+    """
+    Run every binary under every config in this process.
+
+    Each test boots as ``Simulator().config(cfg).binary(path)`` does and
+    runs until it exits through HTIF or reaches *limit* cycles.
+
+    Args:
+        binaries: Paths to bare-metal test ELFs.
+        configs: Name to config for each configuration to test.
+        limit: Cycle limit per test (None for no limit).
+        threads: Host threads to run on (0 for one per available CPU).
+
+    Returns:
+        One outcome per (config, binary), ordered by config, then binary.
+    """
+    names = list(configs)
+    dicts = [_config_to_dict(configs[name]) for name in names]
+    images = [_read_binary(path) for path in binaries]
+    return [
+        TestOutcome(
+            config=names[raw["config"]],
+            binary=binaries[raw["test"]],
+            exit_code=raw["exit_code"],
+            cycles=raw["cycles"],
+            instructions=raw["instructions"],
+            signature=raw["signature"],
+            error=raw["error"],
+        )
+        for raw in _run_suite(dicts, images, limit, threads)
+    ]
@@ -2,28 +2,145 @@
 Parallel multi-config x multi-binary sweep runner.
 
 Provides ``Sweep`` for running multiple configurations against multiple binaries
-across CPU cores and collecting structured results.
+across CPU cores and collecting structured results, optionally with SimPoint
+sampling (each binary is profiled once; every config then simulates only the
+chosen intervals), checkpoint fan-out (each binary is fast-forwarded once;
+every config then resumes from the shared checkpoint), or trace replay (each
+binary runs once recording its memory accesses; every config then replays
+the trace through its own cache hierarchy).
+
+Jobs are dispatched one at a time to whichever worker is idle, longest
+first, so a few long runs do not leave the other cores idle at the end.
+Each worker receives the configs once and reuses each binary image it has
+read. With ``results_path`` every result is appended to a JSON-lines file
+as it completes, and a rerun skips the jobs already recorded there. Jobs
+run on local processes by default, or on other machines through an
+executor from :mod:`rvsim.cluster`.
 """
 
 from __future__ import annotations
 
+import copy
+import json
 import os
-from concurrent.futures import ProcessPoolExecutor
+import tempfile
 from dataclasses import dataclass, field
-from typing import Any, Dict, List, Optional, Union
+from typing import Any, Callable, Dict, List, Optional, Tuple, Union
 
 __all__ = ["Sweep", "SweepResults"]
 
-from .config import Config
-from .experiment import Environment, Result
+from .cluster import Executor, Input, LocalExecutor, Output
+from .config import Config, _config_to_dict
+from .experiment import Environment, Result, Sampling, SimPoint
+from .stats import Stats
+
+# Config dicts by name, installed once per worker process by ``_init_worker``.
+_CONFIGS: Dict[str, Dict[str, Any]] = {}
+
+
+def _init_worker(configs: Dict[str, Dict[str, Any]]) -> None:
+    """Worker initializer: receive the sweep's configs once."""
+    _CONFIGS.clear()
+    _CONFIGS.update(configs)
 
 
-def _run_one(args: tuple) -> tuple:
+def _config(name: str) -> Dict[str, Any]:
+    """A private copy of a worker config (runs may add keys to it)."""
+    return copy.deepcopy(_CONFIGS[name])
+
+
+def _run_one(args: tuple) -> Result:
     """Worker function for parallel execution. Must be top-level for pickling."""
-    binary, config_name, config, limit = args
-    env = Environment(binary=binary, config=config)
-    result = env.run(quiet=True, limit=limit)
-    return (binary, config_name, result)
+    binary, config_name, limit, time_limit, sampling, points, checkpoint = args
+    env = Environment(binary=binary, config=_config(config_name))
+    if sampling is None:
+        result = env.run(
+            quiet=True, limit=limit, checkpoint=checkpoint, time_limit=time_limit
+        )
+    else:
+        result = env.run_sampled(
+            points,
+            sampling.interval,
+            warmup=sampling.warmup,
+            warm=sampling.warm,
+            quiet=True,
+        )
+    return result
+
+
+def _profile_one(args: tuple) -> List[SimPoint]:
+    """Worker: collect BBVs for one binary and pick its simulation points."""
+    binary, config_name, sampling, limit = args
+    env = Environment(binary=binary, config=_config(config_name))
+    return env.profile(sampling.interval, max_k=sampling.max_k, limit=limit)
+
+
+def _checkpoint_one(args: tuple) -> None:
+    """Worker: fast-forward one binary and save its checkpoint."""
+    binary, config_name, boot, path = args
+    Environment(binary=binary, config=_config(config_name)).checkpoint(path, boot)
+
+
+def _capture_one(args: tuple) -> None:
+    """Worker: run one binary in full and record its memory trace."""
+    binary, config_name, limit, path = args
+    Environment(binary=binary, config=_config(config_name)).run(
+        quiet=False, limit=limit, mem_trace=path
+    )
+
+
+def _replay_one(args: tuple) -> Result:
+    """Worker: replay one binary's memory trace under one config."""
+    binary, config_name, path = args
+    return Environment(binary=binary, config=_config(config_name)).replay(path)
+
+
+def _load_results(path: str) -> Dict[Tuple[str, str], Result]:
+    """Read the results a previous sweep streamed to *path*.
+
+    A line torn by a crash mid-write is skipped; its job simply reruns.
+    """
+    done: Dict[Tuple[str, str], Result] = {}
+    if not os.path.exists(path):
+        return done
+    with open(path) as f:
+        for line in f:
+            try:
+                rec = json.loads(line)
+            except json.JSONDecodeError:
+                continue
+            done[(rec["binary"], rec["config"])] = Result(
+                exit_code=rec["exit_code"],
+                stats=Stats(rec["stats"]),
+                wall_time_sec=rec["wall_time_sec"],
+                binary=rec["binary"],
+            )
+    return done
+
+
+class _ResultLog:
+    """Appends each completed job to a JSON-lines file as it finishes."""
+
+    def __init__(self, path: str):
+        torn = False
+        if os.path.exists(path) and os.path.getsize(path) > 0:
+            with open(path, "rb") as f:
+                f.seek(-1, os.SEEK_END)
+                torn = f.read(1) != b"\n"
+        self._f = open(path, "a")
+        # Terminate a line torn by an earlier crash so the next record
+        # starts on its own line.
+        if torn:
+            self._f.write("\n")
+
+    def write(self, config_name: str, result: Result) -> None:
+        rec = {"config": config_name, **result.to_dict()}
+        self._f.write(json.dumps(rec) + "\n")
+        self._f.flush()
+        os.fsync(self._f.fileno())
+
+    def close(self) -> None:
+        self._f.close()
 
 
 @dataclass
@@ -72,6 +189,34 @@ class Sweep:
         ).run(parallel=True, limit=100_000_000)
 
         results.compare()
+
+    With ``sampling=Sampling(...)`` each binary is profiled once in the
+    functional engine and every config simulates only the selected
+    SimPoint intervals in detail (``limit`` then bounds profiling only).
+
+    With ``boot=N`` each binary is fast-forwarded ``N`` instructions once and
+    checkpointed; every config then resumes from that checkpoint, so an 8x8
+    sweep boots 8 times instead of 64. Workers map the checkpoint's RAM
+    copy-on-write, so memory use stays flat as the worker count grows.
+    Checkpoints hold one hart and no PLIC, UART, or VirtIO state, so this is
+    limited to single-hart bare-metal workloads: every config must have
+    ``harts=1``, and a binary that configures those devices before the
+    checkpoint fails its boot job with ``RuntimeError``.
+
+    With ``replay=True`` each binary runs once in full under the first config
+    while its cache accesses are recorded; every config then replays that
+    trace through its own cache hierarchy without executing anything. Only
+    the cache counters are meaningful, and they ignore how a different
+    geometry would have shifted the program's timing.
+
+    With ``results_path`` each result is appended to that JSON-lines file
+    as soon as its job finishes (one object per line: ``config`` plus the
+    fields of :meth:`Result.to_dict`). Rerunning the same sweep with the
+    same path loads the recorded results and runs only the missing jobs, so
+    a crash or interrupt loses at most the jobs in flight.
+
+    With ``executor=SSHExecutor(hosts)`` (or ``SlurmExecutor``,
+    ``RayExecutor``) the jobs run on other machines; see :mod:`rvsim.cluster`.
     """
 
     def __init__(
@@ -88,6 +233,14 @@ class Sweep:
         parallel: bool = True,
         limit: Optional[int] = None,
         max_workers: Optional[int] = None,
+        sampling: Optional[Sampling] = None,
+        boot: Optional[int] = None,
+        checkpoint_dir: Optional[str] = None,
+        replay: bool = False,
+        trace_dir: Optional[str] = None,
+        time_limit: Optional[float] = None,
+        results_path: Optional[str] = None,
+        executor: Optional[Executor] = None,
     ) -> SweepResults:
         """Execute all (binary, config) combinations.
 
@@ -95,29 +248,237 @@ class Sweep:
             parallel: Use multiple processes. ``False`` runs sequentially.
             limit: Maximum cycles per run. ``None`` = unlimited.
             max_workers: Max parallel workers. ``None`` = number of CPUs.
+            sampling: Run SimPoint-sampled simulation instead of full runs.
+            boot: Instructions to fast-forward once per binary before fanning
+                out to every config. Stats then cover only the resumed run.
+                Single-hart bare-metal workloads only (see above).
+            checkpoint_dir: Keep the ``boot`` checkpoints here instead of a
+                temporary directory.
+            replay: Capture each binary's memory trace once and replay it
+                under every config (cache counters only).
+            trace_dir: Keep the ``replay`` traces here instead of a
+                temporary directory.
+            time_limit: Maximum wall-clock seconds per run; a run stopped
+                by it keeps its partial stats with ``exit_code == -1``.
+                Not supported with ``sampling`` or ``replay``.
+            results_path: Stream each result to this JSON-lines file as it
+                completes, and skip jobs it already records.
+            executor: Where jobs run (see :mod:`rvsim.cluster`), e.g. an
+                ``SSHExecutor`` or ``SlurmExecutor``. ``None`` uses local
+                processes per ``parallel`` and ``max_workers``, which are
+                otherwise ignored.
 
         Returns:
             :class:`SweepResults` with per-binary, per-config results.
         """
-        # Build work items
-        work: List[tuple] = []
-        for binary in self.binaries:
-            for config_name, config in self.configs.items():
-                work.append((binary, config_name, config, limit))
+        if boot is not None and sampling is not None:
+            raise ValueError("boot and sampling cannot be combined")
+        if time_limit is not None and (sampling is not None or replay):
+            raise ValueError(
+                "time_limit cannot be combined with sampling or replay"
+            )
+        if replay and (boot is not None or sampling is not None):
+            raise ValueError("replay cannot be combined with boot or sampling")
 
-        # Execute
-        if parallel and len(work) > 1:
-            with ProcessPoolExecutor(max_workers=max_workers) as pool:
-                raw_results = list(pool.map(_run_one, work))
-        else:
-            raw_results = [_run_one(w) for w in work]
+        done = _load_results(results_path) if results_path is not None else {}
+        log = _ResultLog(results_path) if results_path is not None else None
+        if executor is None:
+            executor = LocalExecutor(max_workers=max_workers, parallel=parallel)
+        runner = _Runner(self, executor, done, log)
+        try:
+            if replay:
+                if trace_dir is not None:
+                    os.makedirs(trace_dir, exist_ok=True)
+                    return runner.replayed(limit, trace_dir)
+                with tempfile.TemporaryDirectory(prefix="rvsim-mtr-") as tmp:
+                    return runner.replayed(limit, tmp)
+            if boot is None:
+                return runner.full(limit, time_limit, sampling, {})
+            if checkpoint_dir is not None:
+                os.makedirs(checkpoint_dir, exist_ok=True)
+                return runner.booted(limit, time_limit, boot, checkpoint_dir)
+            with tempfile.TemporaryDirectory(prefix="rvsim-ckpt-") as tmp:
+                return runner.booted(limit, time_limit, boot, tmp)
+        finally:
+            if log is not None:
+                log.close()
 
-        # Organise into nested dict
-        data: Dict[str, Dict[str, Result]] = {}
-        for binary, config_name, result in raw_results:
-            bin_key = os.path.basename(binary)
-            if bin_key not in data:
-                data[bin_key] = {}
-            data[bin_key][config_name] = result
 
+class _Runner:
+    """Schedules one :meth:`Sweep.run` call's jobs onto an executor."""
+
+    def __init__(
+        self,
+        sweep: Sweep,
+        executor: Executor,
+        done: Dict[Tuple[str, str], Result],
+        log: Optional[_ResultLog],
+    ):
+        self.binaries = sweep.binaries
+        self.config_names = list(sweep.configs)
+        # Converted once here and shipped to each worker once, rather than
+        # rebuilt and pickled for every job.
+        self.config_dicts = {
+            name: _config_to_dict(cfg) for name, cfg in sweep.configs.items()
+        }
+        self.executor = executor
+        self.done = done
+        self.log = log
+
+    @property
+    def first_config(self) -> str:
+        # Architectural behaviour does not depend on the microarchitecture,
+        # so any config can profile, boot, or trace a binary.
+        return self.config_names[0]
+
+    def pending(self) -> List[Tuple[str, str]]:
+        """(binary, config) jobs not yet recorded, longest expected first."""
+        jobs = [
+            (b, c)
+            for b in self.binaries
+            for c in self.config_names
+            if (b, c) not in self.done
+        ]
+        return sorted(jobs, key=lambda job: self._cost(job[0]), reverse=True)
+
+    def pending_binaries(self) -> List[str]:
+        """Binaries with at least one pending job, longest expected first."""
+        return list(dict.fromkeys(b for b, _ in self.pending()))
+
+    def _cost(self, binary: str) -> Tuple[float, int]:
+        """Sort key estimating the run time of *binary*.
+
+        The longest wall time already recorded for it comes first (binaries
+        a resumed sweep has timed sort by that), then its file size.
+        """
+        times = [r.wall_time_sec for (b, _), r in self.done.items() if b == binary]
+        try:
+            size = os.path.getsize(binary)
+        except OSError:
+            size = 0
+        return (max(times, default=0.0), size)
+
+    def _path(self, directory: str, binary: str, ext: str) -> str:
+        return os.path.join(directory, f"{self.binaries.index(binary)}.{ext}")
+
+    def booted(
+        self,
+        limit: Optional[int],
+        time_limit: Optional[float],
+        boot: int,
+        directory: str,
+    ) -> SweepResults:
+        smp = [
+            name
+            for name, cfg in self.config_dicts.items()
+            if cfg.get("system", {}).get("harts", 1) != 1
+        ]
+        if smp:
+            raise ValueError(
+                f"boot needs single-hart configs (checkpoints hold one hart): {smp}"
+            )
+        boot_work = [
+            (
+                Input(b),
+                self.first_config,
+                boot,
+                Output(self._path(directory, b, "ckpt")),
+            )
+            for b in self.pending_binaries()
+        ]
+        checkpoints = {
+            args[0].path: args[3].path
+            for args, _ in self.map(_checkpoint_one, boot_work)
+        }
+        return self.full(limit, time_limit, None, checkpoints)
+
+    def replayed(self, limit: Optional[int], directory: str) -> SweepResults:
+        # One full run per binary records the access stream; the cache-only
+        # replays under every config reuse it.
+        capture_work = [
+            (
+                Input(b),
+                self.first_config,
+                limit,
+                Output(self._path(directory, b, "mtr")),
+            )
+            for b in self.pending_binaries()
+        ]
+        traces = {
+            args[0].path: args[3].path
+            for args, _ in self.map(_capture_one, capture_work)
+        }
+        work = [(Input(b), c, Input(traces[b])) for b, c in self.pending()]
+        return self.collect(self.map(_replay_one, work, self._record))
+
+    def full(
+        self,
+        limit: Optional[int],
+        time_limit: Optional[float],
+        sampling: Optional[Sampling],
+        checkpoints: Dict[str, str],
+    ) -> SweepResults:
+        # Pick simulation points once per binary.
+        points: Dict[str, List[SimPoint]] = {}
+        if sampling is not None:
+            profile_work = [
+                (Input(b), self.first_config, sampling, limit)
+                for b in self.pending_binaries()
+            ]
+            points = {
+                args[0].path: pts for args, pts in self.map(_profile_one, profile_work)
+            }
+
+        work = [
+            (
+                Input(b),
+                c,
+                limit,
+                time_limit,
+                sampling,
+                points.get(b),
+                Input(checkpoints[b]) if b in checkpoints else None,
+            )
+            for b, c in self.pending()
+        ]
+        return self.collect(self.map(_run_one, work, self._record))
+
+    def _record(self, args: tuple, result: Result) -> None:
+        if self.log is not None:
+            self.log.write(args[1], result)
+
+    def collect(self, raw_results: List[Tuple[tuple, Result]]) -> SweepResults:
+        """Merge recorded and new results, in sweep order."""
+        by_job = dict(self.done)
+        for args, result in raw_results:
+            by_job[(args[0].path, args[1])] = result
+        data: Dict[str, Dict[str, Result]] = {}
+        for binary in self.binaries:
+            for config_name in self.config_names:
+                result = by_job.get((binary, config_name))
+                if result is not None:
+                    data.setdefault(os.path.basename(binary), {})[config_name] = result
         return SweepResults(data=data)
+
+    def map(
+        self,
+        fn: Callable[[tuple], Any],
+        work: List[tuple],
+        on_result: Optional[Callable[[tuple, Any], None]] = None,
+    ) -> List[Tuple[tuple, Any]]:
+        """Run *fn* over *work*, calling *on_result* as each item finishes.
+
+        Items are handed out in order and each idle worker takes the next
+        one, so with the longest jobs first the tail stays short.
+        """
+        results: List[Tuple[tuple, Any]] = []
+        for args, result in self.executor.map(
+            fn, work, _init_worker, (self.config_dicts,)
+        ):
+            if isinstance(result, Result):
+                # A remote worker saw its cached copy of the binary.
+                result.binary = args[0].path
+            if on_result is not None:
+                on_result(args, result)
+            results.append((args, result))
+        return results
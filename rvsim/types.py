@@ -345,6 +345,49 @@ class MemoryController:
                 f"t_pre={self.t_pre}, row_miss_latency={self.row_miss_latency})"
             )
 
+    class FRFCFS:
+        """Transaction-queue DRAM controller with FR-FCFS write scheduling.
+
+        Uses the DRAM row-buffer timing plus per-channel read/write queues,
+        write-drain watermarks, and cache-line channel interleaving.
+        """
+
+        def __init__(
+            self,
+            t_cas: int = 14,
+            t_ras: int = 14,
+            t_pre: int = 14,
+            row_miss_latency: int = 120,
+            channels: int = 1,
+            ranks: int = 1,
+            read_queue_size: int = 32,
+            write_queue_size: int = 32,
+            write_high_watermark: int = 24,
+            write_low_watermark: int = 8,
+            t_burst: int = 4,
+            t_wtr: int = 8,
+        ):
+            self.t_cas = t_cas
+            self.t_ras = t_ras
+            self.t_pre = t_pre
+            self.row_miss_latency = row_miss_latency
+            self.channels = channels
+            self.ranks = ranks
+            self.read_queue_size = read_queue_size
+            self.write_queue_size = write_queue_size
+            self.write_high_watermark = write_high_watermark
+            self.write_low_watermark = write_low_watermark
+            self.t_burst = t_burst
+            self.t_wtr = t_wtr
+
+        def __repr__(self) -> str:
+            return (
+                f"MemoryController.FRFCFS(t_cas={self.t_cas}, t_ras={self.t_ras}, "
+                f"t_pre={self.t_pre}, channels={self.channels}, ranks={self.ranks}, "
+                f"read_queue_size={self.read_queue_size}, "
+                f"write_queue_size={self.write_queue_size})"
+            )
+
 
 # ── Functional Units ──────────────────────────────────────────────────────────
 
@@ -366,6 +409,7 @@ class Fu:
             Fu.FpDivSqrt(count=1, latency=21),
             Fu.Branch(count=2, latency=1),
             Fu.Mem(count=2, latency=1),
+            Fu.Vector(count=1, latency=1),
         ])
     """
 
@@ -380,7 +424,7 @@ class Fu:
             return f"Fu.IntAlu(count={self.count}, latency={self.latency})"
 
     class IntMul:
-        """Integer multiplier: mul, mulh, mulhsu, mulhu."""
+        """Integer multiplier: mul, mulh, mulhsu, mulhu, and the clz, ctz, cpop bit counts."""
 
         def __init__(self, count: int = 1, latency: int = 3):
             self.count = count
@@ -459,6 +503,16 @@ class Fu:
         def __repr__(self) -> str:
             return f"Fu.Mem(count={self.count}, latency={self.latency})"
 
+    class Vector:
+        """Vector issue port: hands vector instructions to the vector unit."""
+
+        def __init__(self, count: int = 1, latency: int = 1):
+            self.count = count
+            self.latency = latency
+
+        def __repr__(self) -> str:
+            return f"Fu.Vector(count={self.count}, latency={self.latency})"
+
     # Default pool matching Skylake-class hardware
     _DEFAULTS: "list"
 
@@ -480,6 +534,7 @@ Fu._DEFAULTS = [
     Fu.FpDivSqrt(count=1, latency=21),
     Fu.Branch(count=2, latency=1),
     Fu.Mem(count=2, latency=1),
+    Fu.Vector(count=1, latency=1),
 ]
 
 
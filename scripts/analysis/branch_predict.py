@@ -1,16 +1,24 @@
 #!/usr/bin/env python3
 """Compare branch predictor accuracy and IPC impact at a fixed pipeline width.
 
+By default each program runs once in the functional engine while its retired
+branches are recorded, and every predictor is scored on that trace alone, so
+only accuracy is reported. ``--full`` simulates every predictor in full to
+also measure cycles and IPC.
+
 Usage:
     .venv/bin/python scripts/analysis/branch_predict.py
     .venv/bin/python scripts/analysis/branch_predict.py --width 4
     .venv/bin/python scripts/analysis/branch_predict.py --programs maze qsort --width 2
+    .venv/bin/python scripts/analysis/branch_predict.py --full --width 4
 """
 
 import argparse
+import os
+import tempfile
 import time
 
-from rvsim import BranchPredictor, Config, Sweep
+from rvsim import BranchPredictor, Config, Environment, Sweep, SweepResults
 
 PROGRAMS = ["mandelbrot", "maze", "qsort", "merge_sort"]
 
@@ -29,6 +37,7 @@ def main():
     ap.add_argument("--width", type=int, default=1, help="Pipeline width (default: 1)")
     ap.add_argument("--programs", nargs="+", default=PROGRAMS, help="Programs to run")
     ap.add_argument("--limit", type=int, default=50_000_000, help="Cycle limit")
+    ap.add_argument("--full", action="store_true", help="Simulate every predictor in full instead of replaying")
     args = ap.parse_args()
 
     binaries = [f"software/bin/programs/{p}.elf" for p in args.programs]
@@ -38,21 +47,37 @@ def main():
     }
 
     n_jobs = len(binaries) * len(configs)
+    mode = "full runs" if args.full else f"replays of {len(binaries)} captured traces"
     print(f"Branch predictor comparison: {len(binaries)} binaries x {len(configs)} predictors "
-          f"(w{args.width}, {n_jobs} runs, limit={args.limit:,})")
+          f"(w{args.width}, {n_jobs} {mode}, limit={args.limit:,})")
 
     t0 = time.perf_counter()
-    results = Sweep(binaries=binaries, configs=configs).run(
-        parallel=True, limit=args.limit
-    )
+    if args.full:
+        results = Sweep(binaries=binaries, configs=configs).run(
+            parallel=True, limit=args.limit
+        )
+    else:
+        results = replay_all(binaries, configs, args.limit)
     elapsed = time.perf_counter() - t0
     print(f"Completed in {elapsed:.1f}s\n")
 
-    results.compare(
-        metrics=["cycles", "ipc", "branch_accuracy_pct", "branch_mispredictions", "branch_predictions"],
-        baseline="Static",
-        col_header="predictor",
-    )
+    metrics = ["branch_accuracy_pct", "branch_mispredictions", "branch_predictions"]
+    if args.full:
+        metrics = ["cycles", "ipc", *metrics]
+    results.compare(metrics=metrics, baseline="Static", col_header="predictor")
+
+
+def replay_all(binaries, configs, limit):
+    """Capture each program's branch trace once and score every predictor on it."""
+    capture = Config(uart_quiet=True, fast_forward=True)
+    data = {}
+    with tempfile.TemporaryDirectory(prefix="rvsim-btr-") as tmp:
+        for binary in binaries:
+            env = Environment(binary=binary, config=capture)
+            trace = os.path.join(tmp, os.path.basename(binary) + ".btr")
+            env.run(quiet=False, limit=limit, branch_trace=trace)
+            data[os.path.basename(binary)] = env.replay_branches(trace, configs, quiet=False)
+    return SweepResults(data=data)
 
 
 if __name__ == "__main__":
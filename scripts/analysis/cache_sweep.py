@@ -1,16 +1,26 @@
 #!/usr/bin/env python3
 """Sweep L1 D-cache size and measure miss rate / IPC impact.
 
+By default each program runs once while its memory accesses are recorded,
+and every size replays that trace through the cache hierarchy alone, so only
+cache counters are reported. ``--full`` simulates every size in full to also
+measure cycles and IPC. ``--mrc`` instead runs each program once with the
+stack-distance profiler and prints its LRU miss-ratio curve over the sizes,
+with no per-size simulation at all.
+
 Usage:
     .venv/bin/python scripts/analysis/cache_sweep.py
     .venv/bin/python scripts/analysis/cache_sweep.py --sizes 1KB 2KB 4KB 8KB 16KB 32KB
     .venv/bin/python scripts/analysis/cache_sweep.py --programs qsort --ways 1 2 4
+    .venv/bin/python scripts/analysis/cache_sweep.py --full
+    .venv/bin/python scripts/analysis/cache_sweep.py --mrc --ways 8
 """
 
 import argparse
 import time
 
 from rvsim import Cache, Config, Sweep
+from rvsim.types import _parse_size
 
 PROGRAMS = ["mandelbrot", "maze", "qsort", "merge_sort"]
 SIZES = ["1KB", "2KB", "4KB", "8KB", "16KB", "32KB"]
@@ -22,31 +32,70 @@ def main():
     ap.add_argument("--ways", type=int, default=4, help="Cache associativity (default: 4)")
     ap.add_argument("--programs", nargs="+", default=PROGRAMS, help="Programs to run")
     ap.add_argument("--limit", type=int, default=50_000_000, help="Cycle limit")
+    ap.add_argument("--full", action="store_true", help="Simulate every size in full instead of replaying")
+    ap.add_argument("--mrc", action="store_true", help="Print one-pass LRU miss-ratio curves instead")
     args = ap.parse_args()
 
     binaries = [f"software/bin/programs/{p}.elf" for p in args.programs]
+    if args.mrc:
+        miss_ratio_curves(args, binaries)
+        return
     configs = {
         size: Config(uart_quiet=True, l1d=Cache(size=size, ways=args.ways, mshr_count=8))
         for size in args.sizes
     }
 
     n_jobs = len(binaries) * len(configs)
+    mode = "full runs" if args.full else f"replays of {len(binaries)} captured runs"
     print(f"D-cache sweep: {len(binaries)} binaries x {len(configs)} sizes "
-          f"({args.ways}-way, {n_jobs} runs, limit={args.limit:,})")
+          f"({args.ways}-way, {n_jobs} {mode}, limit={args.limit:,})")
 
     t0 = time.perf_counter()
     results = Sweep(binaries=binaries, configs=configs).run(
-        parallel=True, limit=args.limit
+        parallel=True, limit=args.limit, replay=not args.full
     )
     elapsed = time.perf_counter() - t0
     print(f"Completed in {elapsed:.1f}s\n")
 
+    metrics = ["dcache_hits", "dcache_misses", "l2_hits", "l2_misses"]
+    if args.full:
+        metrics = ["cycles", "ipc", "dcache_hits", "dcache_misses"]
     results.compare(
-        metrics=["cycles", "ipc", "dcache_hits", "dcache_misses"],
+        metrics=metrics,
         baseline=args.sizes[0],
         col_header="L1D size",
     )
 
 
+def miss_ratio_curves(args, binaries):
+    """Profile each program once and tabulate its miss ratio per size."""
+    config = Config(
+        uart_quiet=True,
+        l1d=Cache(size=args.sizes[0], ways=args.ways, mshr_count=8),
+        stack_distance=True,
+        stack_distance_max_ways=max(args.ways, 16),
+    )
+    print(f"D-cache MRC: {len(binaries)} profiled runs "
+          f"({args.ways}-way LRU, limit={args.limit:,})")
+
+    t0 = time.perf_counter()
+    results = Sweep(binaries=binaries, configs={"profile": config}).run(
+        parallel=True, limit=args.limit
+    )
+    print(f"Completed in {time.perf_counter() - t0:.1f}s\n")
+
+    curves = {}
+    for program, runs in results.data.items():
+        curve = runs["profile"].stats.mrc(ways=args.ways)
+        curves[program.removesuffix(".elf")] = {size: ratio for size, _, _, ratio in curve}
+
+    width = max(8, *(len(p) for p in curves))
+    print(f"{'L1D size':<10}" + "".join(f"  {p:>{width}}" for p in curves))
+    for size in args.sizes:
+        row = [curves[p].get(_parse_size(size)) for p in curves]
+        cells = ("—" if r is None else f"{100 * r:.2f}%" for r in row)
+        print(f"{size:<10}" + "".join(f"  {c:>{width}}" for c in cells))
+
+
 if __name__ == "__main__":
     main()
@@ -1,6 +1,10 @@
 #!/usr/bin/env python3
 """Show pipeline stall breakdown (memory, control, data) across configurations.
 
+Alongside the coarse stall counters, the top-down columns give the share
+of rename slots that were frontend bound, bad speculation, and backend
+bound (memory-bound part separately).
+
 Usage:
     .venv/bin/python scripts/analysis/stall_breakdown.py
     .venv/bin/python scripts/analysis/stall_breakdown.py --widths 1 2 4
@@ -34,12 +38,17 @@ def main():
                 config = Config(branch_predictor=bp_cls(), uart_quiet=True, width=width)
                 result = Environment(binary=binary, config=config).run(quiet=True, limit=args.limit)
                 s = result.stats
+                slots = s.get("tma_slots", 0) or 1
                 rows[label] = Stats({
                     "cycles": s["cycles"],
                     "ipc": s["ipc"],
                     "stalls_mem": s["stalls_mem"],
                     "stalls_ctrl": s["stalls_control"],
                     "stalls_data": s["stalls_data"],
+                    "fe_bound_pct": 100.0 * s.get("tma_frontend_bound", 0) / slots,
+                    "bad_spec_pct": 100.0 * s.get("tma_bad_speculation", 0) / slots,
+                    "be_bound_pct": 100.0 * s.get("tma_backend_bound", 0) / slots,
+                    "be_mem_pct": 100.0 * s.get("tma_be_memory", 0) / slots,
                 })
         print(Stats.tabulate(rows, title=program))
         print()
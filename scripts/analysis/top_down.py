@@ -45,51 +45,65 @@ CONFIGS = {
 
 def analyze_top_down(stats, width):
     """
-    Compute Top-Down metrics using Slot-based accounting.
-    
-    Total Slots = Cycles * Pipeline Width
-    
-    Categories:
-    1. Retiring: Actual instructions retired.
-    2. Bad Speculation: Slots wasted due to branch misprediction recovery.
-       - Approximated as 'stalls_control' cycles * width.
-    3. Backend Bound: Slots wasted due to backend resource/data stalls.
-       - Approximated as 'stalls_mem' + 'stalls_data' cycles * width.
-    4. Frontend Bound: The remaining empty slots.
-       - Represents fetch bubbles, I-cache misses, or just vertical waste
-         (retiring 1 instr/cycle on a 3-wide machine due to dependencies).
+    Compute Top-Down metrics using slot-based accounting.
+
+    The simulator attributes every rename slot natively (the ``tma_*``
+    stats): retiring and squashed slots are counted at commit and on ROB
+    flushes, idle slots at the rename/dispatch boundary. Those counters are
+    used when present, with their level-2 breakdowns.
+
+    Older builds without them fall back to an approximation from the
+    coarse stall counters:
+
+    1. Retiring: instructions retired.
+    2. Bad Speculation: 'stalls_control' cycles * width.
+    3. Backend Bound: 'stalls_mem' + 'stalls_data' cycles * width.
+    4. Frontend Bound: the remaining empty slots.
     """
+    slots = stats.get("tma_slots", 0)
+    if slots:
+        pct = lambda key: (stats.get(key, 0) / slots) * 100.0
+        return {
+            "Retiring": pct("tma_retiring"),
+            "Bad Speculation": pct("tma_bad_speculation"),
+            "Backend Bound": pct("tma_backend_bound"),
+            "Frontend Bound": pct("tma_frontend_bound"),
+            "IPC": stats.get("ipc", 0.0),
+            "breakdown": {
+                "Bad Speculation": {
+                    "squashed": pct("tma_bad_spec_squashed"),
+                    "recovery": pct("tma_bad_spec_recovery"),
+                },
+                "Frontend Bound": {
+                    "I-cache": pct("tma_fe_icache"),
+                    "I-TLB": pct("tma_fe_itlb"),
+                    "resteer": pct("tma_fe_resteer"),
+                    "bandwidth": pct("tma_fe_bandwidth"),
+                },
+                "Backend Bound": {
+                    "memory L1": pct("tma_be_mem_l1"),
+                    "memory L2": pct("tma_be_mem_l2"),
+                    "memory L3": pct("tma_be_mem_l3"),
+                    "memory DRAM": pct("tma_be_mem_dram"),
+                    "core FU/port": pct("tma_be_core_fu"),
+                    "core other": pct("tma_be_core_other"),
+                },
+            },
+        }
+
     cycles = stats.get("cycles", 1)
     retired = stats.get("instructions_retired", 0)
-    
-    # Stall cycles (assumed to be full-pipeline stalls where 0 insts retire)
     s_mem = stats.get("stalls_mem", 0)
     s_data = stats.get("stalls_data", 0)
     s_ctrl = stats.get("stalls_control", 0)
-    
+
     total_slots = cycles * width
     if total_slots == 0: return {}
 
-    # 1. Retiring
-    # Exact count of useful slots filled
     slots_retiring = retired
-    
-    # 2. Bad Speculation
-    # 'stalls_control' are cycles lost to flushing/recovery. 
-    # All slots in these cycles are wasted.
     slots_bad_spec = s_ctrl * width
-    
-    # 3. Backend Bound
-    # Cycles where backend structures (ROB, LSQ, RS) were full or waiting.
     slots_backend = (s_mem + s_data) * width
-    
-    # 4. Frontend Bound (and vertical waste)
-    # The remainder. This catches:
-    # - I-Cache misses (fetch bubbles)
-    # - Dependency chains (only retiring 1 uOp instead of 'width')
-    # - Fetch bandwidth limitations
-    slots_frontend = total_slots - slots_retiring - slots_bad_spec - slots_backend
-    slots_frontend = max(0, slots_frontend)
+    slots_frontend = max(0, total_slots - slots_retiring - slots_bad_spec - slots_backend)
 
     return {
         "Retiring": (slots_retiring / total_slots) * 100.0,
@@ -97,6 +111,7 @@ def analyze_top_down(stats, width):
         "Backend Bound": (slots_backend / total_slots) * 100.0,
         "Frontend Bound": (slots_frontend / total_slots) * 100.0,
         "IPC": stats.get("ipc", 0.0),
+        "breakdown": {},
     }
 
 def main():
@@ -138,10 +153,15 @@ def main():
     print(f"  \033[31mBad Speculation:\033[0m  {metrics['Bad Speculation']:5.1f}%")
     print(f"  \033[33mBackend Bound:\033[0m    {metrics['Backend Bound']:5.1f}%")
     print(f"  \033[36mFrontend Bound:\033[0m   {metrics['Frontend Bound']:5.1f}%")
+    for category, parts in metrics["breakdown"].items():
+        print(f" {category}:")
+        for name, value in parts.items():
+            print(f"    {name:<16} {value:5.1f}%")
     print("="*40)
     
     # Suggestions based on bottleneck
-    bottleneck = max(metrics, key=lambda k: metrics[k] if k != "IPC" else -1)
+    categories = ("Retiring", "Bad Speculation", "Backend Bound", "Frontend Bound")
+    bottleneck = max(categories, key=lambda k: metrics[k])
     print(f"\nMain Bottleneck: {bottleneck}")
     if bottleneck == "Bad Speculation":
         print(" -> Suggestion: Improve Branch Predictor (larger history/tables).")
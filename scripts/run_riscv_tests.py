@@ -2,14 +2,13 @@
 """Run riscv-tests ISA compliance suite against rvsim.
 
 Tests a large variety of pipeline, cache, FU, and memory configurations.
+Each pipeline's tests run in-process on all host CPUs via ``run_suite``.
 
 Usage (from repo root):
     rvsim --script scripts/run_riscv_tests.py
 """
 
-import contextlib
 import glob
-import io
 import os
 import sys
 
@@ -23,7 +22,7 @@ from rvsim import (
     MemoryController,
     Prefetcher,
     ReplacementPolicy,
-    Simulator,
+    run_suite,
 )
 
 ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
@@ -357,32 +356,15 @@ def find_tests():
     return tests
 
 
-def run_test(path: str, cfg: Config) -> int:
-    """Run a single test ELF with the given config. Returns exit code (0 = pass)."""
-    sim = Simulator().config(cfg).binary(path)
-    # Mute per-test simulator output (HTIF messages, trace, debug prints).
-    with (
-        contextlib.redirect_stdout(io.StringIO()),
-        contextlib.redirect_stderr(io.StringIO()),
-    ):
-        return sim.run(limit=CYCLE_LIMIT, stats_sections=None)
-
-
 def run_pipeline(label: str, cfg: Config, tests: list) -> tuple[int, list]:
-    """Run all tests for one pipeline. Returns (passed, failed_list)."""
-    passed = 0
-    failed = []
-
-    for path in tests:
-        name = os.path.basename(path)
-        rc = run_test(path, cfg)
-
-        if rc == 0:
-            passed += 1
-        else:
-            failed.append((name, rc))
-
-    return passed, failed
+    """Run all tests for one pipeline in-process. Returns (passed, failed_list)."""
+    outcomes = run_suite(tests, {label: cfg}, limit=CYCLE_LIMIT)
+    failed = [
+        (os.path.basename(o.binary), o.exit_code if o.error is None else o.error)
+        for o in outcomes
+        if not o.passed
+    ]
+    return len(outcomes) - len(failed), failed
 
 
 def main():
@@ -15,4 +15,12 @@ static inline unsigned long read_instret(void) {
   return insts;
 }
 
+// Marks the start of the region of interest (writes 1 to the simulator marker
+// CSR 0x8FE); with `general.roi.stats` set the simulator's stats count from here
+static inline void roi_begin(void) { asm volatile("csrwi 0x8fe, 1" ::: "memory"); }
+
+// Marks the end of the region of interest (writes 2 to the simulator marker
+// CSR 0x8FE); with `general.roi.stats` set the simulator's stats stop here
+static inline void roi_end(void) { asm volatile("csrwi 0x8fe, 2" ::: "memory"); }
+
 #endif
@@ -16,11 +16,39 @@ char getchar(void) {
   return *(volatile char *)UART_BASE;
 }
 
-void puts(const char *s) {
+// Buffered output: printf and puts format into obuf and write the UART in
+// one batch when the buffer fills or the call returns, instead of a call
+// per character.
+#define OBUF_SIZE 128
+
+static char obuf[OBUF_SIZE];
+static int olen = 0;
+
+static void flush_out(void) {
+  volatile unsigned char *thr = (volatile unsigned char *)UART_BASE;
+  for (int i = 0; i < olen; i++) {
+    *thr = (unsigned char)obuf[i];
+  }
+  olen = 0;
+}
+
+static inline void emit(char c) {
+  obuf[olen++] = c;
+  if (olen == OBUF_SIZE) {
+    flush_out();
+  }
+}
+
+static void emit_str(const char *s) {
   while (*s) {
-    putchar(*s++);
+    emit(*s++);
   }
-  putchar('\n');
+}
+
+void puts(const char *s) {
+  emit_str(s);
+  emit('\n');
+  flush_out();
 }
 
 // Helper for numbers
@@ -30,12 +58,12 @@ static void print_num(long long n, int base, int sign) {
   unsigned long long u = n;
 
   if (sign && (n < 0)) {
-    putchar('-');
+    emit('-');
     u = -n;
   }
 
   if (u == 0) {
-    putchar('0');
+    emit('0');
     return;
   }
 
@@ -46,13 +74,13 @@ static void print_num(long long n, int base, int sign) {
   }
 
   while (i-- > 0) {
-    putchar(buf[i]);
+    emit(buf[i]);
   }
 }
 
 static void print_double(double v, int precision) {
   if (v < 0) {
-    putchar('-');
+    emit('-');
     v = -v;
   }
 
@@ -61,13 +89,13 @@ static void print_double(double v, int precision) {
 
   // Print Integer part
   print_num(int_part, 10, 0);
-  putchar('.');
+  emit('.');
 
   // Print Fractional part
   while (precision-- > 0) {
     remainder *= 10.0;
     int digit = (int)remainder;
-    putchar(digit + '0');
+    emit(digit + '0');
     remainder -= digit;
   }
 }
@@ -79,7 +107,7 @@ void printf(const char *fmt, ...) {
 
   for (const char *p = fmt; *p; p++) {
     if (*p != '%') {
-      putchar(*p);
+      emit(*p);
       continue;
     }
 
@@ -99,15 +127,14 @@ void printf(const char *fmt, ...) {
     switch (*p) {
     case 'c': {
       int c = va_arg(args, int);
-      putchar(c);
+      emit(c);
       break;
     }
     case 's': {
       const char *s = va_arg(args, const char *);
       if (!s)
         s = "(null)";
-      while (*s)
-        putchar(*s++);
+      emit_str(s);
       break;
     }
     case 'd': {
@@ -146,20 +173,21 @@ void printf(const char *fmt, ...) {
       break;
     }
     case '%': {
-      putchar('%');
+      emit('%');
       break;
     }
     default: {
-      putchar('%');
+      emit('%');
       if (is_long)
-        putchar('l');
-      putchar(*p);
+        emit('l');
+      emit(*p);
       break;
     }
     }
   }
 
   va_end(args);
+  flush_out();
 }
 
 int gets(char *buf, int max_len) {
@@ -186,6 +214,32 @@ int strcmp(const char *s1, const char *s2) {
   return *(const unsigned char *)s1 - *(const unsigned char *)s2;
 }
 
+// 64-bit word that may alias any object
+typedef unsigned long __attribute__((may_alias)) word_t;
+
+// Word-at-a-time: a word holds a zero byte iff (v - 0x01..) & ~v & 0x80..
+// is non-zero. Aligned word loads never cross into an unmapped page.
+unsigned long strlen(const char *s) {
+  const char *p = s;
+  while (((unsigned long)p & 7) != 0) {
+    if (*p == '\0') {
+      return p - s;
+    }
+    p++;
+  }
+
+  const word_t *w = (const word_t *)p;
+  while (((*w - 0x0101010101010101UL) & ~*w & 0x8080808080808080UL) == 0) {
+    w++;
+  }
+
+  p = (const char *)w;
+  while (*p) {
+    p++;
+  }
+  return p - s;
+}
+
 int atoi(const char *str) {
   int res = 0;
   while (*str >= '0' && *str <= '9') {
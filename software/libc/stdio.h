@@ -14,6 +14,7 @@ void putchar(char c);
 
 int gets(char *buf, int max_len);
 int strcmp(const char *s1, const char *s2);
+unsigned long strlen(const char *s);
 int atoi(const char *str);
 
 #endif
@@ -5,16 +5,26 @@
 extern char _end;
 
 struct header {
-  size_t size;
+  size_t size; // Usable bytes after the header
   struct header *next;
 };
 
-// Alignment must be a power of 2
-#define ALIGN_SIZE 8
+// Alignment must be a power of 2 (16 keeps payloads aligned for any type)
+#define ALIGN_SIZE 16
 #define ALIGN(x) (((x) + (ALIGN_SIZE - 1)) & ~(ALIGN_SIZE - 1))
 #define BLOCK_SIZE sizeof(struct header)
 
-static struct header *free_list = NULL;
+// Size classes: class k holds payloads of up to (MIN_CLASS << k) bytes.
+// Larger requests fall back to a first-fit list of big blocks.
+#define MIN_CLASS 16
+#define NUM_CLASSES 8
+#define MAX_CLASS (MIN_CLASS << (NUM_CLASSES - 1))
+
+// Bytes carved from sbrk at a time when a class list runs dry
+#define REFILL_BYTES 4096
+
+static struct header *class_list[NUM_CLASSES];
+static struct header *big_list = NULL;
 static char *heap_top = NULL;
 
 static void *sbrk(long increment) {
@@ -38,45 +48,69 @@ static void *sbrk(long increment) {
   return (void *)old_top;
 }
 
-void free(void *ptr) {
-  if (!ptr)
-    return;
+static int size_class(size_t size) {
+  int k = 0;
+  while (((size_t)MIN_CLASS << k) < size) {
+    k++;
+  }
+  return k;
+}
 
-  // Point back to the header
-  struct header *block = (struct header *)ptr - 1;
+// Carves as many class-k blocks as fit in REFILL_BYTES (at least one) from
+// the top of the heap onto the class list.
+static int refill(int k) {
+  size_t cap = (size_t)MIN_CLASS << k;
+  size_t stride = cap + BLOCK_SIZE;
+  size_t count = REFILL_BYTES / stride;
+  if (count == 0) {
+    count = 1;
+  }
 
-  block->next = free_list;
-  free_list = block;
-}
+  char *chunk = (char *)sbrk(stride * count);
+  if (chunk == (void *)-1) {
+    // Fall back to a single block if the full chunk does not fit
+    count = 1;
+    chunk = (char *)sbrk(stride);
+    if (chunk == (void *)-1) {
+      return 0;
+    }
+  }
 
-void *malloc(size_t size) {
-  if (size == 0)
-    return NULL;
+  for (size_t i = 0; i < count; i++) {
+    struct header *block = (struct header *)(chunk + i * stride);
+    block->size = cap;
+    block->next = class_list[k];
+    class_list[k] = block;
+  }
+  return 1;
+}
 
-  size_t total_size = ALIGN(size + BLOCK_SIZE);
+static void *big_alloc(size_t size) {
+  size_t cap = ALIGN(size);
 
   struct header *prev = NULL;
-  struct header *curr = free_list;
+  struct header *curr = big_list;
 
   while (curr) {
-    if (curr->size >= total_size) {
-      if (curr->size >= total_size + BLOCK_SIZE + ALIGN_SIZE) {
-        struct header *remaining = (struct header *)((char *)curr + total_size);
-        remaining->size = curr->size - total_size;
+    if (curr->size >= cap) {
+      if (curr->size >= cap + BLOCK_SIZE + MAX_CLASS) {
+        // Split; the remainder stays big enough to serve a big request
+        struct header *remaining = (struct header *)((char *)(curr + 1) + cap);
+        remaining->size = curr->size - cap - BLOCK_SIZE;
         remaining->next = curr->next;
 
-        curr->size = total_size;
+        curr->size = cap;
 
         if (prev) {
           prev->next = remaining;
         } else {
-          free_list = remaining;
+          big_list = remaining;
         }
       } else {
         if (prev) {
           prev->next = curr->next;
         } else {
-          free_list = curr->next;
+          big_list = curr->next;
         }
       }
 
@@ -86,13 +120,128 @@ void *malloc(size_t size) {
     curr = curr->next;
   }
 
-  struct header *block = (struct header *)sbrk(total_size);
+  struct header *block = (struct header *)sbrk(cap + BLOCK_SIZE);
   if (block == (void *)-1) {
-    printf("malloc: Out of memory! (Request: %d bytes)\n", (int)size);
     return NULL;
   }
 
-  block->size = total_size;
+  block->size = cap;
 
   return (void *)(block + 1);
 }
+
+void free(void *ptr) {
+  if (!ptr)
+    return;
+
+  // Point back to the header
+  struct header *block = (struct header *)ptr - 1;
+
+  if (block->size <= MAX_CLASS) {
+    int k = size_class(block->size);
+    block->next = class_list[k];
+    class_list[k] = block;
+  } else {
+    block->next = big_list;
+    big_list = block;
+  }
+}
+
+void *malloc(size_t size) {
+  if (size == 0)
+    return NULL;
+
+  void *ptr;
+  if (size <= MAX_CLASS) {
+    int k = size_class(size);
+    if (!class_list[k] && !refill(k)) {
+      ptr = NULL;
+    } else {
+      struct header *block = class_list[k];
+      class_list[k] = block->next;
+      ptr = (void *)(block + 1);
+    }
+  } else {
+    ptr = big_alloc(size);
+  }
+
+  if (!ptr) {
+    printf("malloc: Out of memory! (Request: %d bytes)\n", (int)size);
+  }
+  return ptr;
+}
+
+// The mem* routines below must not be turned back into calls to themselves
+#define NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+// 64-bit word that may alias any object
+typedef unsigned long __attribute__((may_alias)) word_t;
+
+NO_LIBCALL void *memcpy(void *dst, const void *src, size_t n) {
+  unsigned char *d = (unsigned char *)dst;
+  const unsigned char *s = (const unsigned char *)src;
+
+  // Word copies need both pointers to share their alignment
+  if ((((unsigned long)d ^ (unsigned long)s) & 7) == 0) {
+    while (n > 0 && ((unsigned long)d & 7) != 0) {
+      *d++ = *s++;
+      n--;
+    }
+
+    word_t *dw = (word_t *)d;
+    const word_t *sw = (const word_t *)s;
+    while (n >= 32) {
+      unsigned long a = sw[0], b = sw[1], c = sw[2], e = sw[3];
+      dw[0] = a;
+      dw[1] = b;
+      dw[2] = c;
+      dw[3] = e;
+      dw += 4;
+      sw += 4;
+      n -= 32;
+    }
+    while (n >= 8) {
+      *dw++ = *sw++;
+      n -= 8;
+    }
+    d = (unsigned char *)dw;
+    s = (const unsigned char *)sw;
+  }
+
+  while (n > 0) {
+    *d++ = *s++;
+    n--;
+  }
+  return dst;
+}
+
+NO_LIBCALL void *memset(void *dst, int c, size_t n) {
+  unsigned char *d = (unsigned char *)dst;
+
+  while (n > 0 && ((unsigned long)d & 7) != 0) {
+    *d++ = (unsigned char)c;
+    n--;
+  }
+
+  unsigned long v = (unsigned char)c * 0x0101010101010101UL;
+  word_t *dw = (word_t *)d;
+  while (n >= 32) {
+    dw[0] = v;
+    dw[1] = v;
+    dw[2] = v;
+    dw[3] = v;
+    dw += 4;
+    n -= 32;
+  }
+  while (n >= 8) {
+    *dw++ = v;
+    n -= 8;
+  }
+
+  d = (unsigned char *)dw;
+  while (n > 0) {
+    *d++ = (unsigned char)c;
+    n--;
+  }
+  return dst;
+}
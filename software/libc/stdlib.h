@@ -8,4 +8,7 @@ typedef unsigned long size_t;
 void *malloc(size_t size);
 void free(void *ptr);
 
+void *memcpy(void *dst, const void *src, size_t n);
+void *memset(void *dst, int c, size_t n);
+
 #endif
@@ -4,8 +4,8 @@
 For each generated .S file:
   1. Assemble + link using the riscv-tests environment
   2. Run on Spike (golden reference) — extract signature
-  3. Run on rvsim — extract signature
-  4. Compare signatures; report mismatches
+  3. Run on rvsim — extract signature (all tests in one in-process batch)
+  4. Compare exit codes and signatures; report mismatches
 
 Usage (from repo root):
     python software/torture/run.py                    # generate + build + run
@@ -15,13 +15,11 @@ Usage (from repo root):
 """
 
 import argparse
-import contextlib
-import io
 import os
-import struct
 import subprocess
 import sys
 import tempfile
+from concurrent.futures import ThreadPoolExecutor
 
 REPO_ROOT = os.path.dirname(os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 TORTURE_DIR = os.path.dirname(os.path.abspath(__file__))
@@ -69,73 +67,35 @@ def assemble_test(src_path, elf_path):
     return True
 
 
-def get_signature_addr(elf_path):
-    """Get the address of begin_signature from the ELF symbol table."""
-    result = subprocess.run(
-        [READELF, "-s", elf_path], capture_output=True, text=True
-    )
-    for line in result.stdout.splitlines():
-        if "begin_signature" in line:
-            parts = line.split()
-            # readelf format: Num Value Size Type Bind Vis Ndx Name
-            for p in parts:
-                try:
-                    addr = int(p, 16)
-                    if addr > 0x80000000:
-                        return addr
-                except ValueError:
-                    continue
-    return None
-
-
 def run_spike(elf_path):
-    """Run test on Spike, return (exit_code, signature_bytes)."""
-    sig_addr = get_signature_addr(elf_path)
-
-    # Run Spike
-    result = subprocess.run(
-        [SPIKE, "--isa=rv64gc", elf_path],
-        capture_output=True, text=True, timeout=30,
-    )
-
-    if sig_addr is None:
-        return result.returncode, None
-
-    # Extract signature from Spike's memory by running spike with
-    # --dump-dts and signature dump. Since Spike doesn't directly dump
-    # memory regions, we use a different approach: run spike interactively
-    # to dump registers, or use the ELF + spike log.
-    # Actually, the simplest approach: use spike's +signature flag if available,
-    # or just check exit code and compare register dumps via a different method.
-
-    # Alternative: use spike's built-in signature dumping
+    """Run test on Spike, return (exit_code, signature_text)."""
     with tempfile.NamedTemporaryFile(suffix=".sig", delete=False) as sigf:
         sig_path = sigf.name
 
-    result2 = subprocess.run(
-        [SPIKE, "--isa=rv64gc", f"+signature={sig_path}", elf_path],
-        capture_output=True, text=True, timeout=30,
-    )
-
-    sig_data = None
-    if os.path.exists(sig_path):
-        try:
-            with open(sig_path, "r") as f:
-                sig_data = f.read().strip()
-        except Exception:
-            pass
+    try:
+        result = subprocess.run(
+            [SPIKE, "--isa=rv64gc", f"+signature={sig_path}", elf_path],
+            capture_output=True, text=True, timeout=30,
+        )
+    except subprocess.TimeoutExpired:
         os.unlink(sig_path)
+        return -1, None
 
-    return result2.returncode, sig_data
+    sig_data = None
+    try:
+        with open(sig_path, "r") as f:
+            sig_data = f.read().strip() or None
+    except OSError:
+        pass
+    os.unlink(sig_path)
 
+    return result.returncode, sig_data
 
-def run_rvsim(elf_path, config_name="default"):
-    """Run test on rvsim, return (exit_code, signature_bytes)."""
-    sig_addr = get_signature_addr(elf_path)
 
-    # Import rvsim
+def rvsim_config(config_name="default"):
+    """Return the rvsim pipeline config named *config_name*."""
     sys.path.insert(0, REPO_ROOT)
-    from rvsim import Backend, Config, Simulator
+    from rvsim import Backend, Config
 
     from rvsim import (
         BranchPredictor, Cache, Fu, MemoryController,
@@ -200,25 +160,28 @@ def run_rvsim(elf_path, config_name="default"):
         ),
     }
 
-    cfg = configs.get(config_name, configs["default"])
+    return configs.get(config_name, configs["default"])
 
-    sim = Simulator().config(cfg).binary(elf_path)
-    with (
-        contextlib.redirect_stdout(io.StringIO()),
-        contextlib.redirect_stderr(io.StringIO()),
-    ):
-        rc = sim.run(limit=500_000, stats_sections=None)
 
-    # TODO: extract signature from simulator memory if API supports it
-    return rc, None
+def run_rvsim(elf_paths, config_name="default", threads=0):
+    """Run all tests on rvsim in-process, return [(exit_code, signature_text)]."""
+    from rvsim import run_suite
+
+    outcomes = run_suite(
+        elf_paths, {config_name: rvsim_config(config_name)},
+        limit=500_000, threads=threads,
+    )
+    return [(o.exit_code, o.signature_hex()) for o in outcomes]
 
 
-def compare_exit_codes(spike_rc, rvsim_rc):
-    """Compare exit codes. Both should be 0 (PASS)."""
+def compare(spike_rc, spike_sig, rvsim_rc, rvsim_sig):
+    """Compare exit codes (both should be 0) and, when both exist, signatures."""
     if spike_rc != 0:
         return "SPIKE_FAIL"
     if rvsim_rc != 0:
         return "RVSIM_FAIL"
+    if spike_sig is not None and rvsim_sig is not None and spike_sig != rvsim_sig:
+        return "SIG_MISMATCH"
     return "PASS"
 
 
@@ -240,7 +203,10 @@ def main():
     ap.add_argument(
         "--branch-pct", type=int, default=15, help="Percentage of branch blocks"
     )
-    ap.add_argument("--jobs", "-j", type=int, default=1, help="Parallel jobs (build only)")
+    ap.add_argument(
+        "--jobs", "-j", type=int, default=os.cpu_count() or 1,
+        help="Parallel Spike runs and rvsim threads",
+    )
     args = ap.parse_args()
 
     os.makedirs(BUILD_DIR, exist_ok=True)
@@ -293,23 +259,21 @@ def main():
     print(f"[torture] Running {len(elfs)} tests (config={args.config})...")
     print()
 
-    # Step 3: Run
+    # Step 3: Run Spike in parallel, and all rvsim runs in one in-process batch
+    paths = [elf_path for _, elf_path in elfs]
+    with ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        spike_results = list(pool.map(run_spike, paths))
+    rvsim_results = run_rvsim(paths, args.config, threads=args.jobs)
+
     passed = 0
     failed = []
     spike_failed = []
 
     for i, (name, elf_path) in enumerate(elfs):
-        # Run Spike
-        try:
-            spike_rc, spike_sig = run_spike(elf_path)
-        except subprocess.TimeoutExpired:
-            spike_rc = -1
-            spike_sig = None
-
-        # Run rvsim
-        rvsim_rc, rvsim_sig = run_rvsim(elf_path, args.config)
+        spike_rc, spike_sig = spike_results[i]
+        rvsim_rc, rvsim_sig = rvsim_results[i]
 
-        status = compare_exit_codes(spike_rc, rvsim_rc)
+        status = compare(spike_rc, spike_sig, rvsim_rc, rvsim_sig)
 
         if status == "PASS":
             passed += 1
@@ -317,7 +281,7 @@ def main():
             # Test itself is broken (Spike also fails) — skip
             spike_failed.append(name)
         else:
-            failed.append((name, spike_rc, rvsim_rc))
+            failed.append((name, spike_rc, rvsim_rc, status))
             if args.keep_failing:
                 import shutil
                 shutil.copy2(elf_path, os.path.join(FAIL_DIR, name))
@@ -343,8 +307,8 @@ def main():
 
     if failed:
         print(f"\n=== {len(failed)} Failures ===")
-        for name, spike_rc, rvsim_rc in failed:
-            print(f"  {name}  (spike={spike_rc}, rvsim={rvsim_rc})")
+        for name, spike_rc, rvsim_rc, status in failed:
+            print(f"  {name}  {status} (spike={spike_rc}, rvsim={rvsim_rc})")
         if args.keep_failing:
             print(f"\nFailing ELFs + sources saved to: {FAIL_DIR}")
         return 1